@@ -19,9 +19,20 @@ FILE
     bundled into "groups" for more general storage.
 
     The groups are stored in an array of pointers to store each group in an
-    element. Each "atomic group" node contains a link to a hash table to
-    manage the atoms in each group.  The allowed "atomic groups" are stored
-    in an enum (called group_t) in atom_priv.h.
+    element. Each "atomic group" node holds an array of slots, one per atom,
+    which grows by pages as atoms are registered.  The allowed "atomic
+    groups" are stored in an enum (called group_t) in atom_priv.h.
+
+    An atom is made of its group, the index of its slot and the generation
+    of the slot, which is bumped each time the slot is freed.  Looking an
+    atom up is an index into its group, and an atom that has been removed
+    no longer matches its slot, even once the slot is reused.  Freed slots
+    are queued and only reused once enough of them are waiting, so that the
+    same atom comes back as seldom as possible.
+
+    Looking atoms up takes no lock: in the thread-safe build the slots are
+    read and written with H4_ATOMIC_*, and the pages never move until the
+    group is destroyed.  The routines that change a group hold its mutex.
 
 */
 
@@ -36,50 +47,55 @@ FILE
 #define GROUP_BITS 4
 #define GROUP_MASK 0x0F
 
-/* # of bits to use for the Atom index in each atom (change if MAXGROUP > 16) */
-#define ATOM_BITS 28
-#define ATOM_MASK 0x0FFFFFFF
+/* # of bits of the slot index and of the slot generation in each atom */
+#define SLOT_BITS 20
+#define SLOT_MASK 0x000FFFFF
+#define GEN_BITS  8
+#define GEN_MASK  0xFF
 
-/* Map an atom to a Group number */
-#define ATOM_TO_GROUP(a) ((group_t)((((atom_t)(a)) >> ((sizeof(atom_t) * 8) - GROUP_BITS)) & GROUP_MASK))
+/* Slots are allocated by pages of ATOM_PAGE_SIZE; a group has at most ATOM_NPAGES pages */
+#define ATOM_PAGE_BITS 10
+#define ATOM_PAGE_SIZE (1U << ATOM_PAGE_BITS)
+#define ATOM_NPAGES    (1U << (SLOT_BITS - ATOM_PAGE_BITS))
 
-/* Map an atom to a hash location (assumes s is a power of 2 and smaller than the ATOM_MASK constant) */
-#define ATOM_TO_LOC(a, s) ((uint32_t)(a) & ((s)-1))
+/* Freed slots are only reused once there are this many of them */
+#define ATOM_MIN_FREE 1024
 
-/* Combine a Group number and an atom index into an atom */
-#define MAKE_ATOM(g, i)                                                                                      \
-    ((((atom_t)(g)&GROUP_MASK) << ((sizeof(atom_t) * 8) - GROUP_BITS)) | ((atom_t)(i)&ATOM_MASK))
+/* Map an atom to a Group number */
+#define ATOM_TO_GROUP(a) ((group_t)((((atom_t)(a)) >> ((sizeof(atom_t) * 8) - GROUP_BITS)) & GROUP_MASK))
 
-/* # of previous atoms cached, change HAatom_object & SWAP_CACHE if this changes */
-#define ATOM_CACHE_SIZE 4
+/* Map an atom to the index of its slot */
+#define ATOM_TO_SLOT(a) ((unsigned)(a)&SLOT_MASK)
 
-/* Swap cache elements using XOR operator. Ugly but fast... */
-#define SWAP_CACHE(i, j)                                                                                     \
-    atom_id_cache[i] ^= atom_id_cache[j],                                                                    \
-        atom_obj_cache[i] = (void *)((intptr_t)atom_obj_cache[j] ^ (intptr_t)atom_obj_cache[i]),             \
-        atom_id_cache[j] ^= atom_id_cache[i],                                                                \
-        atom_obj_cache[j] = (void *)((intptr_t)atom_obj_cache[i] ^ (intptr_t)atom_obj_cache[j]),             \
-        atom_id_cache[i] ^= atom_id_cache[j],                                                                \
-        atom_obj_cache[i] = (void *)((intptr_t)atom_obj_cache[i] ^ (intptr_t)atom_obj_cache[j])
+/* Combine a Group number, a slot generation and a slot index into an atom */
+#define MAKE_ATOM(g, n, i)                                                                                   \
+    ((((atom_t)(g)&GROUP_MASK) << ((sizeof(atom_t) * 8) - GROUP_BITS)) |                                     \
+     (((atom_t)(n)&GEN_MASK) << SLOT_BITS) | ((atom_t)(i)&SLOT_MASK))
 
 /********************
  * Private typedefs *
  ********************/
 
-/* Atom information structure used */
-typedef struct atom_info_struct_tag {
-    atom_t                       id;      /* atom ID for this info */
-    void                       **obj_ptr; /* pointer associated with the atom */
-    struct atom_info_struct_tag *next;    /* link to next atom (in case of hash-clash) */
-} atom_info_t;
+/* Slot holding an atom */
+typedef struct atom_slot_tag {
+    atom_t   id;        /* atom in the slot, FAIL when the slot is free */
+    unsigned gen;       /* generation of the next atom of the slot */
+    unsigned next_free; /* next slot in the free queue */
+    void    *obj_ptr;   /* pointer associated with the atom */
+} atom_slot_t;
 
 /* Atom group structure used */
 typedef struct atom_group_struct_tag {
     unsigned      count;     /* # of times this group has been initialized */
-    unsigned      hash_size; /* size of the hash table to store the atoms in */
     unsigned      atoms;     /* current number of atoms held */
-    unsigned      nextid;    /* atom ID to use for the next atom */
-    atom_info_t **atom_list; /* pointer to an array of ptrs to atoms */
+    unsigned      nslots;    /* # of slots used so far, the next new slot */
+    unsigned      nfree;     /* # of slots in the free queue */
+    unsigned      free_head; /* oldest free slot, reused first */
+    unsigned      free_tail; /* last slot freed */
+    atom_slot_t **pages;     /* ATOM_NPAGES pointers to pages of slots */
+#ifdef H4_HAVE_THREADSAFE
+    pthread_mutex_t lock; /* held while the group is changed */
+#endif
 } atom_group_t;
 
 /********************
@@ -89,30 +105,20 @@ typedef struct atom_group_struct_tag {
 /* Array of pointers to atomic groups */
 static atom_group_t *atom_group_list[MAXGROUP] = {NULL};
 
-/* Pointer to the atom node free list */
-static atom_info_t *atom_free_list = NULL;
-
-/* Atom cache arrays
- *
- * One of the arrays holds the atoms and the other holds the objects the
- * atoms point to. These MUST be kept in sync!
- */
-static atom_t atom_id_cache[ATOM_CACHE_SIZE]  = {-1, -1, -1, -1};
-static void  *atom_obj_cache[ATOM_CACHE_SIZE] = {NULL, NULL, NULL, NULL};
+#ifdef H4_HAVE_THREADSAFE
+/* Serializes the creation and destruction of the groups */
+static pthread_mutex_t atom_group_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 /*******************************
  * Private function prototypes *
  *******************************/
 
-static void *HAIatom_object(atom_t atm);
-
-static atom_info_t *HAIfind_atom(atom_t atm);
-
-static atom_info_t *HAIget_atom_node(void);
+static int HAIinit_group(group_t grp, unsigned hash_size);
 
-static void HAIrelease_atom_node(atom_info_t *atm);
+static int HAIdestroy_group(group_t grp);
 
-static void HAIfree_atom_list(atom_info_t *info);
+static atom_slot_t *HAIfind_slot(atom_t atm);
 
 /******************************************************************************
  NAME
@@ -121,8 +127,9 @@ static void HAIfree_atom_list(atom_info_t *info);
  DESCRIPTION
     Creates a global atomic group to store atoms in.  If the group has already
     been initialized, this routine just increments the count of # of
-    initializations and returns without trying to change the size of the hash
-    table.
+    initializations and returns.  The slots of the group are allocated as
+    atoms are registered; hash_size, which must be a power of 2, is only
+    checked.
 
  RETURNS
     Returns SUCCEED if successful and FAIL otherwise
@@ -131,6 +138,28 @@ int
 HAinit_group(group_t  grp,      /* IN: Group to initialize */
              unsigned hash_size /* IN: Minimum hash table size to use for group */
 )
+{
+    int ret_value;
+
+    H4_MUTEX_LOCK(&atom_group_lock);
+    ret_value = HAIinit_group(grp, hash_size);
+    H4_MUTEX_UNLOCK(&atom_group_lock);
+
+    return ret_value;
+} /* end HAinit_group() */
+
+/******************************************************************************
+ NAME
+     HAIinit_group - Initialize an atomic group
+
+ DESCRIPTION
+    Does the work of HAinit_group(), under the lock of the groups.
+
+ RETURNS
+    Returns SUCCEED if successful and FAIL otherwise
+*******************************************************************************/
+static int
+HAIinit_group(group_t grp, unsigned hash_size)
 {
     atom_group_t *grp_ptr   = NULL; /* ptr to the atomic group */
     int           ret_value = SUCCEED;
@@ -143,14 +172,14 @@ HAinit_group(group_t  grp,      /* IN: Group to initialize */
     if ((hash_size & (hash_size - 1)) != 0)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* Assertion necessary for faster pointer swapping */
-    assert(sizeof(hdf_pint_t) == sizeof(void *));
-
     if (atom_group_list[grp] == NULL) {
         /* Allocate the group information */
         grp_ptr = (atom_group_t *)calloc(1, sizeof(atom_group_t));
         if (grp_ptr == NULL)
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
+#ifdef H4_HAVE_THREADSAFE
+        pthread_mutex_init(&grp_ptr->lock, NULL);
+#endif
         atom_group_list[grp] = grp_ptr;
     }
     else /* Get the pointer to the existing group */
@@ -158,10 +187,10 @@ HAinit_group(group_t  grp,      /* IN: Group to initialize */
 
     if (grp_ptr->count == 0) {
         /* Initialize the atom group structure */
-        grp_ptr->hash_size = hash_size;
-        grp_ptr->atoms     = 0;
-        grp_ptr->nextid    = 0;
-        if ((grp_ptr->atom_list = (atom_info_t **)calloc(hash_size, sizeof(atom_info_t *))) == NULL)
+        grp_ptr->atoms  = 0;
+        grp_ptr->nslots = 0;
+        grp_ptr->nfree  = 0;
+        if ((grp_ptr->pages = (atom_slot_t **)calloc(ATOM_NPAGES, sizeof(atom_slot_t *))) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
     }
 
@@ -169,17 +198,8 @@ HAinit_group(group_t  grp,      /* IN: Group to initialize */
     grp_ptr->count++;
 
 done:
-    /* Error condition cleanup */
-    if (ret_value == FAIL) {
-        if (grp_ptr != NULL) {
-            if (grp_ptr->atom_list != NULL)
-                free(grp_ptr->atom_list);
-            free(grp_ptr);
-        }
-    }
-
     return ret_value;
-} /* end HAinit_group() */
+} /* end HAIinit_group() */
 
 /******************************************************************************
  NAME
@@ -197,6 +217,28 @@ done:
 int
 HAdestroy_group(group_t grp /* IN: Group to destroy */
 )
+{
+    int ret_value;
+
+    H4_MUTEX_LOCK(&atom_group_lock);
+    ret_value = HAIdestroy_group(grp);
+    H4_MUTEX_UNLOCK(&atom_group_lock);
+
+    return ret_value;
+} /* end HAdestroy_group() */
+
+/******************************************************************************
+ NAME
+     HAIdestroy_group - Destroy an atomic group
+
+ DESCRIPTION
+    Does the work of HAdestroy_group(), under the lock of the groups.
+
+ RETURNS
+    Returns SUCCEED if successful and FAIL otherwise
+*******************************************************************************/
+static int
+HAIdestroy_group(group_t grp)
 {
     atom_group_t *grp_ptr   = NULL; /* ptr to the atomic group */
     int           ret_value = SUCCEED;
@@ -211,19 +253,15 @@ HAdestroy_group(group_t grp /* IN: Group to destroy */
 
     /* Decrement the number of users of the atomic group */
     if ((--(grp_ptr->count)) == 0) {
-        for (unsigned u = 0; u < ATOM_CACHE_SIZE; u++) {
-            if (ATOM_TO_GROUP(atom_id_cache[u]) == grp) {
-                atom_id_cache[u]  = -1;
-                atom_obj_cache[u] = NULL;
-            }
-        }
-        free(grp_ptr->atom_list);
-        grp_ptr->atom_list = NULL;
+        for (unsigned u = 0; u < ATOM_NPAGES; u++)
+            free(grp_ptr->pages[u]);
+        free(grp_ptr->pages);
+        grp_ptr->pages = NULL;
     }
 
 done:
     return ret_value;
-} /* end HAdestroy_group() */
+} /* end HAIdestroy_group() */
 
 /******************************************************************************
  NAME
@@ -233,9 +271,9 @@ done:
     Registers an object in a group and returns an atom for it.  This routine
     does _not_ check for unique-ness of the objects, if you register an object
     twice, you will get two different atoms for it.  This routine does make
-    certain that each atom in a group is unique.  Atoms are created by getting
-    a unique number for the group the atom is in and incorporating the group
-    into the atom which is returned to the user.
+    certain that each atom in a group is unique.  Atoms are created by taking
+    a free slot of the group and incorporating the group, the slot and the
+    slot's generation into the atom which is returned to the user.
 
  RETURNS
     Returns atom if successful and FAIL otherwise
@@ -246,9 +284,10 @@ HAregister_atom(group_t grp,   /* IN: Group to register the object in */
 )
 {
     atom_group_t *grp_ptr = NULL; /* ptr to the atomic group */
-    atom_info_t  *atm_ptr = NULL; /* ptr to the new atom */
-    atom_t        atm_id;         /* new atom ID */
-    unsigned      hash_loc;       /* new item's hash table location */
+    atom_slot_t  *slot    = NULL; /* slot of the new atom */
+    atom_slot_t  *page    = NULL; /* page of the slot */
+    unsigned      idx     = 0;    /* index of the slot */
+    atom_t        atm_id  = FAIL; /* new atom ID */
     atom_t        ret_value = SUCCEED;
 
     HEclear();
@@ -259,26 +298,43 @@ HAregister_atom(group_t grp,   /* IN: Group to register the object in */
     if (grp_ptr == NULL || grp_ptr->count <= 0)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-    if ((atm_ptr = HAIget_atom_node()) == NULL)
-        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    H4_MUTEX_LOCK(&grp_ptr->lock);
 
-    /* Create the atom & it's ID */
-    atm_id           = MAKE_ATOM(grp, grp_ptr->nextid);
-    atm_ptr->id      = atm_id;
-    atm_ptr->obj_ptr = object;
-    atm_ptr->next    = NULL;
+    /* Reuse the oldest free slot once enough are waiting, or if there is no new one left */
+    if (grp_ptr->nfree >= ATOM_MIN_FREE || (grp_ptr->nfree > 0 && grp_ptr->nslots == (1U << SLOT_BITS))) {
+        idx  = grp_ptr->free_head;
+        slot = &grp_ptr->pages[idx >> ATOM_PAGE_BITS][idx & (ATOM_PAGE_SIZE - 1)];
+        grp_ptr->free_head = slot->next_free;
+        grp_ptr->nfree--;
+    }
+    else if (grp_ptr->nslots < (1U << SLOT_BITS)) {
+        idx  = grp_ptr->nslots;
+        page = grp_ptr->pages[idx >> ATOM_PAGE_BITS];
+        if (page == NULL) {
+            if ((page = (atom_slot_t *)calloc(ATOM_PAGE_SIZE, sizeof(atom_slot_t))) != NULL) {
+                for (unsigned u = 0; u < ATOM_PAGE_SIZE; u++)
+                    page[u].id = FAIL;
+                H4_ATOMIC_STORE(&grp_ptr->pages[idx >> ATOM_PAGE_BITS], page);
+            }
+        }
+        if (page != NULL) {
+            slot = &page[idx & (ATOM_PAGE_SIZE - 1)];
+            grp_ptr->nslots++;
+        }
+    }
 
-    /* Simple mod operation to find hash bucket */
-    hash_loc = grp_ptr->nextid % grp_ptr->hash_size;
+    if (slot != NULL) {
+        /* The object must be in place before the atom shows up */
+        atm_id = MAKE_ATOM(grp, slot->gen, idx);
+        H4_ATOMIC_STORE(&slot->obj_ptr, object);
+        H4_ATOMIC_STORE(&slot->id, atm_id);
+        grp_ptr->atoms++;
+    }
 
-    /* Hash bucket already contains linked list nodes, prepend to front */
-    if (grp_ptr->atom_list[hash_loc] != NULL)
-        atm_ptr->next = grp_ptr->atom_list[hash_loc];
+    H4_MUTEX_UNLOCK(&grp_ptr->lock);
 
-    /* Insert into the group */
-    grp_ptr->atom_list[hash_loc] = atm_ptr;
-    grp_ptr->atoms++;
-    grp_ptr->nextid++;
+    if (slot == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
     ret_value = atm_id;
 
@@ -291,9 +347,8 @@ done:
      HAatom_object - Returns to the object ptr for the atom
 
  DESCRIPTION
-    Retrieves the object ptr which is associated with the atom. This call
-    first checks the atom cache and reverts to the general lookup if that
-    fails.
+    Retrieves the object ptr which is associated with the atom.  The atom
+    indexes its slot directly, and no lock is taken.
 
  RETURNS
     Returns object ptr if successful and NULL otherwise
@@ -301,50 +356,16 @@ done:
 void *
 HAatom_object(atom_t atm)
 {
-    /* This unmaintainable mess was converted from a public macro in atom.h and
-     * should be cleaned up and merged with HAIatom_object()
-     */
-
-    /* Note! This is hardwired to the atom cache size being 4 */
-
-    /* Checks if the atom is in the cache, moving items around as it goes. If
-     * the atom is not found, it does a general lookup via HAIatom_object()
-     * and returns that.
-     */
-    return (atom_id_cache[0] == atm   ? atom_obj_cache[0]
-            : atom_id_cache[1] == atm ? (SWAP_CACHE(0, 1), atom_obj_cache[0])
-            : atom_id_cache[2] == atm ? (SWAP_CACHE(1, 2), atom_obj_cache[1])
-            : atom_id_cache[3] == atm ? (SWAP_CACHE(2, 3), atom_obj_cache[2])
-                                      : HAIatom_object(atm));
-}
-
-/******************************************************************************
- NAME
-     HAIatom_object - Returns to the object ptr for the atom
-
- DESCRIPTION
-    Retrieves the object ptr which is associated with the atom without using
-    the atom cache.
-
- RETURNS
-    Returns object ptr if successful and NULL otherwise
-*******************************************************************************/
-static void *
-HAIatom_object(atom_t atm /* IN: Atom to retrieve object for */
-)
-{
-    atom_info_t *atm_ptr   = NULL; /* ptr to the new atom */
+    atom_slot_t *slot      = NULL; /* slot of the atom */
     void        *ret_value = NULL;
 
-    HEclear();
-
-    /* General lookup of the atom */
-    if ((atm_ptr = HAIfind_atom(atm)) == NULL)
+    if ((slot = HAIfind_slot(atm)) == NULL)
         HGOTO_ERROR(DFE_INTERNAL, NULL);
 
-    /* Check if we've found the correct atom */
-    if (atm_ptr != NULL)
-        ret_value = atm_ptr->obj_ptr;
+    /* The slot may be freed and reused meanwhile: check it still holds the atom */
+    ret_value = H4_ATOMIC_LOAD(&slot->obj_ptr);
+    if (H4_ATOMIC_LOAD(&slot->id) != atm)
+        HGOTO_ERROR(DFE_INTERNAL, NULL);
 
 done:
     return ret_value;
@@ -380,7 +401,8 @@ done:
      HAremove_atom - Removes an atom from a group
 
  DESCRIPTION
-    Removes an atom from a group.
+    Removes an atom from a group.  Its slot gets a new generation and goes
+    to the end of the free queue.
 
  RETURNS
     Returns atom's object if successful and NULL otherwise
@@ -390,63 +412,48 @@ HAremove_atom(atom_t atm /* IN: Atom to remove */
 )
 {
     atom_group_t *grp_ptr = NULL; /* ptr to the atomic group */
-    atom_info_t  *curr_atm;       /* ptr to the current atom */
-    atom_info_t  *last_atm;       /* ptr to the last atom */
-    group_t       grp;            /* atom's atomic group */
-    unsigned      hash_loc;       /* atom's hash table location */
+    atom_slot_t  *slot    = NULL;  /* slot of the atom */
+    unsigned      idx;             /* index of the slot */
+    int           found   = FALSE; /* whether the atom was still in its slot */
     void         *ret_value = NULL;
 
     HEclear();
 
-    grp = ATOM_TO_GROUP(atm);
-    if (grp <= BADGROUP || grp >= MAXGROUP)
-        HGOTO_ERROR(DFE_ARGS, NULL);
-
-    grp_ptr = atom_group_list[grp];
-    if (grp_ptr == NULL || grp_ptr->count <= 0)
+    if ((slot = HAIfind_slot(atm)) == NULL)
         HGOTO_ERROR(DFE_INTERNAL, NULL);
+    grp_ptr = atom_group_list[ATOM_TO_GROUP(atm)];
+    idx     = ATOM_TO_SLOT(atm);
 
-    /* Get the hash bucket in which the atom is located */
-    hash_loc = ATOM_TO_LOC(atm, grp_ptr->hash_size);
-    curr_atm = grp_ptr->atom_list[hash_loc];
-    if (curr_atm == NULL)
-        HGOTO_ERROR(DFE_INTERNAL, NULL);
+    H4_MUTEX_LOCK(&grp_ptr->lock);
 
-    /* Iterate through the linked list to find the atom */
-    last_atm = NULL;
-    while (curr_atm != NULL) {
-        if (curr_atm->id == atm)
-            break;
-        last_atm = curr_atm;
-        curr_atm = curr_atm->next;
-    }
+    if (slot->id == atm) {
+        found     = TRUE;
+        ret_value = slot->obj_ptr;
 
-    if (curr_atm != NULL) {
-        if (last_atm == NULL) {
-            /* Atom is the first in the list */
-            grp_ptr->atom_list[hash_loc] = curr_atm->next;
-        }
+        /* Free the slot, then forget the object */
+        H4_ATOMIC_STORE(&slot->id, FAIL);
+        H4_ATOMIC_STORE(&slot->obj_ptr, NULL);
+        slot->gen = (slot->gen + 1) & GEN_MASK;
+
+        /* Queue the slot */
+        slot->next_free = idx;
+        if (grp_ptr->nfree == 0)
+            grp_ptr->free_head = idx;
         else
-            last_atm->next = curr_atm->next;
-        ret_value = curr_atm->obj_ptr;
-        HAIrelease_atom_node(curr_atm);
-    }
-    else /* Couldn't find the atom in the proper place */
-        HGOTO_ERROR(DFE_INTERNAL, NULL);
+            grp_ptr->pages[grp_ptr->free_tail >> ATOM_PAGE_BITS][grp_ptr->free_tail & (ATOM_PAGE_SIZE - 1)]
+                .next_free = idx;
+        grp_ptr->free_tail = idx;
+        grp_ptr->nfree++;
 
-    /* Delete object from cache (assumes only be a single instance of the
-     * atom can be stored in the cache)
-     */
-    for (unsigned u = 0; u < ATOM_CACHE_SIZE; u++) {
-        if (atom_id_cache[u] == atm) {
-            atom_id_cache[u]  = -1;
-            atom_obj_cache[u] = NULL;
-            break;
-        }
+        /* Decrement the number of atoms in the group */
+        (grp_ptr->atoms)--;
     }
 
-    /* Decrement the number of atoms in the group */
-    (grp_ptr->atoms)--;
+    H4_MUTEX_UNLOCK(&grp_ptr->lock);
+
+    /* Couldn't find the atom in the proper place */
+    if (!found)
+        HGOTO_ERROR(DFE_INTERNAL, NULL);
 
 done:
     return ret_value;
@@ -472,7 +479,7 @@ HAsearch_atom(group_t         grp,  /* IN: Group to search for the object in */
 )
 {
     atom_group_t *grp_ptr   = NULL; /* ptr to the atomic group */
-    atom_info_t  *atm_ptr   = NULL; /* ptr to the new atom */
+    atom_slot_t  *slot      = NULL; /* slot being looked at */
     void         *ret_value = NULL;
 
     HEclear();
@@ -483,41 +490,45 @@ HAsearch_atom(group_t         grp,  /* IN: Group to search for the object in */
     if (grp_ptr == NULL || grp_ptr->count <= 0)
         HGOTO_ERROR(DFE_INTERNAL, NULL);
 
-    /* Start at the beginning of the array */
-    for (unsigned u = 0; u < grp_ptr->hash_size; u++) {
-        atm_ptr = grp_ptr->atom_list[u];
-        while (atm_ptr != NULL) {
-            if ((*func)(atm_ptr->obj_ptr, key))
-                HGOTO_DONE(atm_ptr->obj_ptr); /* found the item we are looking for */
-            atm_ptr = atm_ptr->next;
+    /* Keep the objects from being removed while they are compared */
+    H4_MUTEX_LOCK(&grp_ptr->lock);
+
+    /* Start at the first slot */
+    for (unsigned u = 0; u < grp_ptr->nslots; u++) {
+        slot = &grp_ptr->pages[u >> ATOM_PAGE_BITS][u & (ATOM_PAGE_SIZE - 1)];
+        if (slot->id != FAIL && (*func)(slot->obj_ptr, key)) {
+            ret_value = slot->obj_ptr; /* found the item we are looking for */
+            break;
         }
     }
 
+    H4_MUTEX_UNLOCK(&grp_ptr->lock);
+
 done:
     return ret_value;
 } /* end HAsearch_atom() */
 
 /******************************************************************************
  NAME
-     HAIfind_atom - Finds a atom in a group
+     HAIfind_slot - Finds the slot of an atom
 
  DESCRIPTION
-    Retrieves the atom ptr which is associated with the atom.
+    Retrieves the slot which the atom indexes.  The slot holds the atom
+    unless the atom has been removed; the caller checks it.
 
  RETURNS
-    Returns atom ptr if successful and NULL otherwise
+    Returns slot ptr if successful and NULL otherwise
 *******************************************************************************/
-static atom_info_t *
-HAIfind_atom(atom_t atm /* IN: Atom to retrieve atom for */
+static atom_slot_t *
+HAIfind_slot(atom_t atm /* IN: Atom to retrieve slot for */
 )
 {
     atom_group_t *grp_ptr = NULL; /* ptr to the atomic group */
-    atom_info_t  *atm_ptr = NULL; /* ptr to the new atom */
+    atom_slot_t  *page    = NULL; /* page of the slot */
     group_t       grp;            /* atom's atomic group */
-    unsigned      hash_loc;       /* atom's hash table location */
-    atom_info_t  *ret_value = NULL;
+    unsigned      idx;            /* atom's slot */
+    atom_slot_t  *ret_value = NULL;
 
-    HEclear();
     grp = ATOM_TO_GROUP(atm);
     if (grp <= BADGROUP || grp >= MAXGROUP)
         HGOTO_ERROR(DFE_ARGS, NULL);
@@ -526,98 +537,16 @@ HAIfind_atom(atom_t atm /* IN: Atom to retrieve atom for */
     if (grp_ptr == NULL || grp_ptr->count <= 0)
         HGOTO_ERROR(DFE_INTERNAL, NULL);
 
-    /* Get the location in which the atom is located */
-    hash_loc = ATOM_TO_LOC(atm, grp_ptr->hash_size);
-    atm_ptr  = grp_ptr->atom_list[hash_loc];
-    if (atm_ptr == NULL)
+    idx  = ATOM_TO_SLOT(atm);
+    page = H4_ATOMIC_LOAD(&grp_ptr->pages[idx >> ATOM_PAGE_BITS]);
+    if (page == NULL || H4_ATOMIC_LOAD(&page[idx & (ATOM_PAGE_SIZE - 1)].id) != atm)
         HGOTO_ERROR(DFE_INTERNAL, NULL);
 
-    while (atm_ptr != NULL) {
-        if (atm_ptr->id == atm)
-            break;
-        atm_ptr = atm_ptr->next;
-    }
-
-    if (atm_ptr) {
-        /* if found, add it to the end of the cached list */
-        atom_id_cache[ATOM_CACHE_SIZE - 1]  = atm;
-        atom_obj_cache[ATOM_CACHE_SIZE - 1] = atm_ptr->obj_ptr;
-    }
-
-    ret_value = atm_ptr;
+    ret_value = &page[idx & (ATOM_PAGE_SIZE - 1)];
 
 done:
     return ret_value;
-} /* end HAIfind_atom() */
-
-/******************************************************************************
- NAME
-     HAIget_atom_node - Gets an atom node
-
- DESCRIPTION
-    Either gets an atom node from the free list (if there is one available)
-    or allocate a node.
-
- RETURNS
-    Returns atom ptr if successful and NULL otherwise
-*******************************************************************************/
-static atom_info_t *
-HAIget_atom_node(void)
-{
-    atom_info_t *ret_value = NULL;
-
-    HEclear();
-    if (atom_free_list != NULL) {
-        ret_value      = atom_free_list;
-        atom_free_list = atom_free_list->next;
-    }
-    else {
-        if ((ret_value = (atom_info_t *)malloc(sizeof(atom_info_t))) == NULL)
-            HGOTO_ERROR(DFE_NOSPACE, NULL);
-    }
-
-done:
-    memset(ret_value, 0, sizeof(atom_info_t));
-    return ret_value;
-} /* end HAIget_atom_node() */
-
-/******************************************************************************
- NAME
-     HAIrelease_atom_node - Releases an atom node
-
- DESCRIPTION
-    Puts an atom node into the free list
-
- RETURNS
-    No return value
-*******************************************************************************/
-static void
-HAIrelease_atom_node(atom_info_t *atm)
-{
-    /* Insert the atom at the beginning of the free list */
-    atm->next      = atom_free_list;
-    atom_free_list = atm;
-} /* end HAIrelease_atom_node() */
-
-/*--------------------------------------------------------------------------
- NAME
-    HAIfree_atom_list
-
- PURPOSE
-    Free a linked list of atoms
---------------------------------------------------------------------------*/
-static void
-HAIfree_atom_list(atom_info_t *info)
-{
-    atom_info_t *curr = info;
-    atom_info_t *next = NULL;
-
-    while (curr != NULL) {
-        next = curr->next;
-        free(curr);
-        curr = next;
-    }
-}
+} /* end HAIfind_slot() */
 
 /*--------------------------------------------------------------------------
  NAME
@@ -633,19 +562,22 @@ HAIfree_atom_list(atom_info_t *info)
 int
 HAshutdown(void)
 {
-    /* Release the free list */
-    HAIfree_atom_list(atom_free_list);
-
     /* Free the atom groups */
     for (int i = 0; i < (int)MAXGROUP; i++) {
         if (atom_group_list[i] != NULL) {
-            free(atom_group_list[i]->atom_list);
+            if (atom_group_list[i]->pages != NULL) {
+                for (unsigned u = 0; u < ATOM_NPAGES; u++)
+                    free(atom_group_list[i]->pages[u]);
+                free(atom_group_list[i]->pages);
+            }
+#ifdef H4_HAVE_THREADSAFE
+            pthread_mutex_destroy(&atom_group_list[i]->lock);
+#endif
             free(atom_group_list[i]);
         }
     }
 
     /* Don't leave stale global data around */
-    atom_free_list = NULL;
     memset(atom_group_list, 0, sizeof(atom_group_t *) * MAXGROUP);
 
     return SUCCEED;
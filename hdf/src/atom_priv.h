@@ -55,7 +55,8 @@ extern "C" {
  DESCRIPTION
     Creates an atomic group to store atoms in.  If the group has already been
     initialized, this routine just increments the count of # of initializations
-    and returns without trying to change the size of the hash table.
+    and returns.  The group grows as atoms are registered; hash_size must be a
+    power of 2 but does not limit it.
 
  RETURNS
     Returns SUCCEED if successful and FAIL otherwise
@@ -90,9 +91,9 @@ HDFLIBAPI int HAdestroy_group(group_t grp /* IN: Group to destroy */
     Registers an object in a group and returns an atom for it.  This routine
     does _not_ check for unique-ness of the objects, if you register an object
     twice, you will get two different atoms for it.  This routine does make
-    certain that each atom in a group is unique.  Atoms are created by getting
-    a unique number for the group the atom is in and incorporating the group
-    into the atom which is returned to the user.
+    certain that each atom in a group is unique.  Atoms are created by taking
+    a free slot of the group the atom is in and incorporating the group, the
+    slot and the slot's generation into the atom which is returned to the user.
 
  RETURNS
     Returns atom if successful and FAIL otherwise
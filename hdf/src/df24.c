@@ -67,6 +67,8 @@ static int32 last_ydim = 0; /* .....gheesh......... */
 int
 DF24getdims(const char *filename, int32 *pxdim, int32 *pydim, int *pil)
 {
+    H4_API_ENTER;
+
     int ncomps;
     int ret_value = SUCCEED;
 
@@ -101,6 +103,8 @@ done:
 int
 DF24reqil(int il)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFGRIreqil(il, IMAGE));
@@ -132,6 +136,8 @@ DF24reqil(int il)
 int
 DF24getimage(const char *filename, void *image, int32 xdim, int32 ydim)
 {
+    H4_API_ENTER;
+
     int    il;
     int32  tx, ty;
     int    compressed, has_pal;
@@ -181,6 +187,8 @@ done:
 int
 DF24setdims(int32 xdim, int32 ydim)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     dimsset   = 1;
@@ -207,6 +215,8 @@ DF24setdims(int32 xdim, int32 ydim)
 int
 DF24setil(int il)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFGRIsetil(il, IMAGE));
@@ -237,6 +247,8 @@ DF24setil(int il)
 int
 DF24setcompress(int32 type, comp_info *cinfo)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFGRsetcompress(type, cinfo));
@@ -262,6 +274,8 @@ DF24setcompress(int32 type, comp_info *cinfo)
 int
 DF24restart(void)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFGRIrestart());
@@ -292,6 +306,8 @@ DF24restart(void)
 int
 DF24addimage(const char *filename, const void *image, int32 xdim, int32 ydim)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* 0 == C */
@@ -328,6 +344,8 @@ done:
 int
 DF24putimage(const char *filename, const void *image, int32 xdim, int32 ydim)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* 0 == C */
@@ -359,6 +377,8 @@ done:
 int
 DF24nimages(const char *filename)
 {
+    H4_API_ENTER;
+
     int32  file_id;
     int32  group_id;           /* group ID for looking at RIG's */
     uint16 elt_tag, elt_ref;   /* tag/ref of items in a RIG */
@@ -435,6 +455,8 @@ done:
 int
 DF24readref(const char *filename, uint16 ref)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFGRreadref(filename, ref));
@@ -459,6 +481,8 @@ DF24readref(const char *filename, uint16 ref)
 uint16
 DF24lastref(void)
 {
+    H4_API_ENTER;
+
     uint16 ret_value;
 
     ret_value = (DFGRIlastref());
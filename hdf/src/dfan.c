@@ -103,6 +103,8 @@ static int   DFANIstart(void);
 int32
 DFANgetlablen(const char *filename, uint16 tag, uint16 ref)
 {
+    H4_API_ENTER;
+
     int32 ret_value;
 
     ret_value = (DFANIgetannlen(filename, tag, ref, DFAN_LABEL));
@@ -135,6 +137,8 @@ DFANgetlablen(const char *filename, uint16 tag, uint16 ref)
 int
 DFANgetlabel(const char *filename, uint16 tag, uint16 ref, char *label, int32 maxlen)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFANIgetann(filename, tag, ref, (uint8 *)label, maxlen, DFAN_LABEL, 0));
@@ -164,6 +168,8 @@ DFANgetlabel(const char *filename, uint16 tag, uint16 ref, char *label, int32 ma
 int32
 DFANgetdesclen(const char *filename, uint16 tag, uint16 ref)
 {
+    H4_API_ENTER;
+
     int32 ret_value;
 
     ret_value = (DFANIgetannlen(filename, tag, ref, DFAN_DESC));
@@ -198,6 +204,8 @@ DFANgetdesclen(const char *filename, uint16 tag, uint16 ref)
 int
 DFANgetdesc(const char *filename, uint16 tag, uint16 ref, char *desc, int32 maxlen)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFANIgetann(filename, tag, ref, (uint8 *)desc, maxlen, DFAN_DESC, 0));
@@ -234,6 +242,8 @@ DFANgetdesc(const char *filename, uint16 tag, uint16 ref, char *desc, int32 maxl
 int32
 DFANgetfidlen(int32 file_id, int isfirst)
 {
+    H4_API_ENTER;
+
     int32 ret_value;
 
     ret_value = (DFANIgetfannlen(file_id, DFAN_LABEL, isfirst));
@@ -265,6 +275,8 @@ DFANgetfidlen(int32 file_id, int isfirst)
 int32
 DFANgetfid(int32 file_id, char *label, int32 maxlen, int isfirst)
 {
+    H4_API_ENTER;
+
     int32 ret_value;
 
     ret_value = (DFANIgetfann(file_id, label, maxlen, DFAN_LABEL, isfirst));
@@ -297,6 +309,8 @@ DFANgetfid(int32 file_id, char *label, int32 maxlen, int isfirst)
 int32
 DFANgetfdslen(int32 file_id, int isfirst)
 {
+    H4_API_ENTER;
+
     int32 ret_value;
 
     ret_value = (DFANIgetfannlen(file_id, DFAN_DESC, isfirst));
@@ -328,6 +342,8 @@ DFANgetfdslen(int32 file_id, int isfirst)
 int32
 DFANgetfds(int32 file_id, char *desc, int32 maxlen, int isfirst)
 {
+    H4_API_ENTER;
+
     int32 ret_value;
 
     ret_value = (DFANIgetfann(file_id, desc, maxlen, DFAN_DESC, isfirst));
@@ -362,6 +378,8 @@ DFANgetfds(int32 file_id, char *desc, int32 maxlen, int isfirst)
 int
 DFANputlabel(const char *filename, uint16 tag, uint16 ref, char *label)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFANIputann(filename, tag, ref, (uint8 *)label, (int32)strlen(label), DFAN_LABEL));
@@ -395,6 +413,8 @@ DFANputlabel(const char *filename, uint16 tag, uint16 ref, char *label)
 int
 DFANputdesc(const char *filename, uint16 tag, uint16 ref, char *desc, int32 desclen)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFANIputann(filename, tag, ref, (uint8 *)desc, desclen, DFAN_DESC));
@@ -425,6 +445,8 @@ DFANputdesc(const char *filename, uint16 tag, uint16 ref, char *desc, int32 desc
 int
 DFANaddfid(int32 file_id, char *id)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFANIaddfann(file_id, id, (int32)strlen(id), DFAN_LABEL));
@@ -454,6 +476,8 @@ DFANaddfid(int32 file_id, char *id)
 int
 DFANaddfds(int32 file_id, char *desc, int32 desclen)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFANIaddfann(file_id, desc, desclen, DFAN_DESC));
@@ -483,6 +507,8 @@ DFANaddfds(int32 file_id, char *desc, int32 desclen)
 uint16
 DFANlastref(void)
 {
+    H4_API_ENTER;
+
     uint16 ret_value;
 
     ret_value = (Lastref);
@@ -524,6 +550,8 @@ int
 DFANlablist(const char *filename, uint16 tag, uint16 reflist[], char *labellist, int listsize, int maxlen,
             int startpos)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFANIlablist(filename, tag, reflist, (uint8 *)labellist, listsize, maxlen, startpos, 0));
@@ -550,6 +578,8 @@ DFANlablist(const char *filename, uint16 tag, uint16 reflist[], char *labellist,
 int
 DFANclear(void)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = DFANIclear();
@@ -61,6 +61,8 @@ int
 DFputcomp(int32 file_id, uint16 tag, uint16 ref, const uint8 *image, int32 xdim, int32 ydim, uint8 *palette,
           uint8 *newpal, int16 scheme, comp_info *cinfo)
 {
+    H4_API_ENTER;
+
     uint8       *buffer;   /* buffer to hold compressed image */
     const uint8 *in;       /* pointer to input for compression */
     uint8       *out;      /* pointer to space for compressed output */
@@ -177,6 +179,8 @@ DFputcomp(int32 file_id, uint16 tag, uint16 ref, const uint8 *image, int32 xdim,
 int
 DFgetcomp(int32 file_id, uint16 tag, uint16 ref, uint8 *image, int32 xdim, int32 ydim, uint16 scheme)
 {
+    H4_API_ENTER;
+
     uint8 *buffer;
     uint8 *in;
     uint8 *out;
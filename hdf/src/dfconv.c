@@ -38,6 +38,7 @@
                       routines
     DFKisnative     - Checks whether number type is native mode
     DFKislitend     - Checks whether number type is little-endian mode
+    DFKiscopyNT     - Checks whether converting number type is a plain copy
     DFconvert       - provide compatibility with 3.0 routines
 
  Private functions:
@@ -80,10 +81,10 @@ extern int   DFconvert(uint8 *source, uint8 *dest, int ntype, int sourcetype, in
 /*
  **  Conversion Routine Pointer Definitions
  */
-static int (*DFKnumin)(void *source, void *dest, uint32 num_elm, uint32 source_stride,
-                       uint32 dest_stride)  = DFKInoset;
-static int (*DFKnumout)(void *source, void *dest, uint32 num_elm, uint32 source_stride,
-                        uint32 dest_stride) = DFKInoset;
+static H4_THREAD_LOCAL int (*DFKnumin)(void *source, void *dest, uint32 num_elm, uint32 source_stride,
+                                       uint32 dest_stride)  = DFKInoset;
+static H4_THREAD_LOCAL int (*DFKnumout)(void *source, void *dest, uint32 num_elm, uint32 source_stride,
+                                        uint32 dest_stride) = DFKInoset;
 
 /************************************************************
  * If the programmer forgot to call DFKsetntype, then let
@@ -109,8 +110,8 @@ DFKInoset(void *source, void *dest, uint32 num_elm, uint32 source_stride, uint32
  * Routines that depend on the above information
  *****************************************************************************/
 
-static int32 g_ntype = DFNT_NONE; /* Holds current number type. */
-                                  /* Initially not set.         */
+static H4_THREAD_LOCAL int32 g_ntype = DFNT_NONE; /* Holds current number type. */
+                                                  /* Initially not set.         */
 
 /************************************************************
  * DFKqueryNT()
@@ -119,6 +120,8 @@ static int32 g_ntype = DFNT_NONE; /* Holds current number type. */
 int32
 DFKqueryNT(void)
 {
+    H4_API_ENTER;
+
     return g_ntype;
 }
 
@@ -200,6 +203,8 @@ DFKNTsize(int32 number_type)
 int
 DFKsetNT(int32 ntype)
 {
+    H4_API_ENTER;
+
     HEclear();
 
     g_ntype = ntype;
@@ -332,6 +337,8 @@ DFKsetcustom(int (*DFKcustin)(void * /* source */, void * /* dest */, uint32 /*
              int (*DFKcustout)(void * /* source */, void * /* dest */, uint32 /* num_elm */,
                                uint32 /* source_stride */, uint32 /* dest_stride */))
 {
+    H4_API_ENTER;
+
     DFKnumin  = DFKcustin;
     DFKnumout = DFKcustout;
     DFKsetNT(DFNT_CUSTOM); /* Keep HDF from getting confused */
@@ -370,6 +377,72 @@ DFKislitendNT(int32 numbertype)
     return (DFNT_LITEND & numbertype) > 0 ? 1 : 0;
 }
 
+/*------------------------------------------------------------------
+ * Name:    DFKiscopyNT
+ * Purpose: Determine whether converting a number type is a plain
+ *          copy on this machine
+ * Inputs:  numbertype: number type of the data in the file
+ * Returns: 1 if true, 0 if false
+ * Users:   SD and GR readers and writers, to move data straight
+ *          between the file and the user's buffer
+ * Method:  Checks whether DFKsetNT would pick one of the native
+ *          copy routines for the number type
+ * Remarks: Custom and unknown number types are never copies
+ *------------------------------------------------------------------*/
+
+int32
+DFKiscopyNT(int32 numbertype)
+{
+    switch (numbertype) {
+        case DFNT_CHAR8:
+        case DFNT_UCHAR8:
+        case DFNT_INT8:
+        case DFNT_UINT8:
+            return UI8_IN == DFKnb1b;
+        case DFNT_INT16:
+        case DFNT_UINT16:
+            return SI16_IN == DFKnb2b;
+        case DFNT_INT32:
+        case DFNT_UINT32:
+            return SI32_IN == DFKnb4b;
+        case DFNT_FLOAT32:
+            return F32_IN == DFKnb4b;
+        case DFNT_FLOAT64:
+            return F64_IN == DFKnb8b;
+
+        case DFNT_NCHAR:
+        case DFNT_NINT8:
+        case DFNT_NUCHAR:
+        case DFNT_NUINT8:
+        case DFNT_NINT16:
+        case DFNT_NUINT16:
+        case DFNT_NINT32:
+        case DFNT_NUINT32:
+        case DFNT_NFLOAT32:
+        case DFNT_NFLOAT64:
+            return 1;
+
+        case DFNT_LCHAR:
+        case DFNT_LINT8:
+        case DFNT_LUCHAR:
+        case DFNT_LUINT8:
+            return LUI8_IN == DFKnb1b;
+        case DFNT_LINT16:
+        case DFNT_LUINT16:
+            return LSI16_IN == DFKnb2b;
+        case DFNT_LINT32:
+        case DFNT_LUINT32:
+            return LSI32_IN == DFKnb4b;
+        case DFNT_LFLOAT32:
+            return LF32_IN == DFKnb4b;
+        case DFNT_LFLOAT64:
+            return LF64_IN == DFKnb8b;
+
+        default:
+            return 0;
+    }
+}
+
 /************************************************************
  * DFconvert()
  *
@@ -390,6 +463,8 @@ DFKislitendNT(int32 numbertype)
 int
 DFconvert(uint8 *source, uint8 *dest, int ntype, int sourcetype, int desttype, int32 size)
 {
+    H4_API_ENTER;
+
     uint32 num_elm;
 
     HEclear();
@@ -485,6 +560,8 @@ int32
 DFKconvert(void *source, void *dest, int32 ntype, int32 num_elm, int16 acc_mode, int32 source_stride,
            int32 dest_stride)
 {
+    H4_API_ENTER;
+
     int ret;
 
     /* Check args (minimally) */
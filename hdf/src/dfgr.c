@@ -156,6 +156,8 @@ static int DFGRIstart(void);
 int
 DFGRgetlutdims(const char *filename, int32 *pxdim, int32 *pydim, int *pncomps, int *pil)
 {
+    H4_API_ENTER;
+
     return DFGRIgetdims(filename, pxdim, pydim, pncomps, pil, LUT);
 }
 
@@ -172,6 +174,8 @@ DFGRgetlutdims(const char *filename, int32 *pxdim, int32 *pydim, int *pncomps, i
 int
 DFGRreqlutil(int il)
 {
+    H4_API_ENTER;
+
     return DFGRIreqil(il, LUT);
 }
 
@@ -190,6 +194,8 @@ DFGRreqlutil(int il)
 int
 DFGRgetlut(const char *filename, void *lut, int32 xdim, int32 ydim)
 {
+    H4_API_ENTER;
+
     int    compressed, has_pal;
     uint16 compr_type;
     /* 0 == C */
@@ -213,6 +219,8 @@ DFGRgetlut(const char *filename, void *lut, int32 xdim, int32 ydim)
 int
 DFGRgetimdims(const char *filename, int32 *pxdim, int32 *pydim, int *pncomps, int *pil)
 {
+    H4_API_ENTER;
+
     return DFGRIgetdims(filename, pxdim, pydim, pncomps, pil, IMAGE);
 }
 
@@ -229,6 +237,8 @@ DFGRgetimdims(const char *filename, int32 *pxdim, int32 *pydim, int *pncomps, in
 int
 DFGRreqimil(int il)
 {
+    H4_API_ENTER;
+
     return DFGRIreqil(il, IMAGE);
 }
 
@@ -247,6 +257,8 @@ DFGRreqimil(int il)
 int
 DFGRgetimage(const char *filename, void *image, int32 xdim, int32 ydim)
 {
+    H4_API_ENTER;
+
     int    compressed, has_pal;
     uint16 compr_type;
     /* 0 == C */
@@ -267,6 +279,8 @@ DFGRgetimage(const char *filename, void *image, int32 xdim, int32 ydim)
 int
 DFGRsetcompress(int32 scheme, comp_info *cinfo)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     HEclear();
@@ -310,6 +324,8 @@ done:
 int
 DFGRsetlutdims(int32 xdim, int32 ydim, int ncomps, int il)
 {
+    H4_API_ENTER;
+
     if (DFGRIsetil(il, LUT) < 0)
         return FAIL;
     return DFGRIsetdims(xdim, ydim, ncomps, LUT);
@@ -329,6 +345,8 @@ DFGRsetlutdims(int32 xdim, int32 ydim, int ncomps, int il)
 int
 DFGRsetlut(void *lut, int32 xdim, int32 ydim)
 {
+    H4_API_ENTER;
+
     /* 0 == C, 0 == no newfile */
     return DFGRIaddimlut((const char *)NULL, lut, xdim, ydim, LUT, 0, 0);
 }
@@ -348,6 +366,8 @@ DFGRsetlut(void *lut, int32 xdim, int32 ydim)
 int
 DFGRaddlut(const char *filename, void *lut, int32 xdim, int32 ydim)
 {
+    H4_API_ENTER;
+
     /* 0 == C, 0 == no new file */
     return DFGRIaddimlut(filename, lut, xdim, ydim, LUT, 0, 0);
 }
@@ -367,6 +387,8 @@ DFGRaddlut(const char *filename, void *lut, int32 xdim, int32 ydim)
 int
 DFGRsetimdims(int32 xdim, int32 ydim, int ncomps, int il)
 {
+    H4_API_ENTER;
+
     if (DFGRIsetil(il, IMAGE) < 0)
         return FAIL;
     return DFGRIsetdims(xdim, ydim, ncomps, IMAGE);
@@ -387,6 +409,8 @@ DFGRsetimdims(int32 xdim, int32 ydim, int ncomps, int il)
 int
 DFGRaddimage(const char *filename, void *image, int32 xdim, int32 ydim)
 {
+    H4_API_ENTER;
+
     /* 0 == C, 0 == not new file */
     return DFGRIaddimlut(filename, image, xdim, ydim, IMAGE, 0, 0);
 }
@@ -394,6 +418,8 @@ DFGRaddimage(const char *filename, void *image, int32 xdim, int32 ydim)
 int
 DFGRputimage(const char *filename, void *image, int32 xdim, int32 ydim)
 {
+    H4_API_ENTER;
+
     /* 0 == C, 1 == new file */
     return DFGRIaddimlut(filename, image, xdim, ydim, IMAGE, 0, 1);
 }
@@ -412,6 +438,8 @@ DFGRputimage(const char *filename, void *image, int32 xdim, int32 ydim)
 int
 DFGRreadref(const char *filename, uint16 ref)
 {
+    H4_API_ENTER;
+
     int   ret_value = SUCCEED;
     int32 file_id   = (-1);
 
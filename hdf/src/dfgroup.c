@@ -78,6 +78,8 @@ setgroupREC(DIlist_ptr list_rec)
 int32
 DFdiread(int32 file_id, uint16 tag, uint16 ref)
 {
+    H4_API_ENTER;
+
     DIlist_ptr new_list;
     int32      length;
 
@@ -129,6 +131,8 @@ DFdiread(int32 file_id, uint16 tag, uint16 ref)
 int
 DFdiget(int32 list, uint16 *ptag, uint16 *pref)
 {
+    H4_API_ENTER;
+
     uint8     *p;
     DIlist_ptr list_rec;
 
@@ -165,6 +169,8 @@ DFdiget(int32 list, uint16 *ptag, uint16 *pref)
 int
 DFdinobj(int32 list)
 {
+    H4_API_ENTER;
+
     DIlist_ptr list_rec;
 
     list_rec = GID2REC(list);
@@ -190,6 +196,8 @@ DFdinobj(int32 list)
 int32
 DFdisetup(int maxsize)
 {
+    H4_API_ENTER;
+
     DIlist_ptr new_list;
 
     new_list = (DIlist_ptr)malloc((uint32)sizeof(DIlist));
@@ -222,6 +230,8 @@ DFdisetup(int maxsize)
 int
 DFdiput(int32 list, uint16 tag, uint16 ref)
 {
+    H4_API_ENTER;
+
     uint8     *p;
     DIlist_ptr list_rec;
 
@@ -254,6 +264,8 @@ DFdiput(int32 list, uint16 tag, uint16 ref)
 int
 DFdiwrite(int32 file_id, int32 list, uint16 tag, uint16 ref)
 {
+    H4_API_ENTER;
+
     int32      ret; /* return value */
     DIlist_ptr list_rec;
 
@@ -298,6 +310,8 @@ DFdiwrite(int32 file_id, int32 list, uint16 tag, uint16 ref)
 void
 DFdifree(int32 groupID)
 {
+    H4_API_ENTER;
+
     DIlist_ptr list_rec;
 
     list_rec = GID2REC(groupID);
@@ -23,6 +23,10 @@
     DFKsb8b -  Byte swapping for 64 bit floats
 
  Remarks:
+    Contiguous items (strides of 0 or of the item size) are swapped with
+    SSSE3 or AVX2 shuffles when the CPU has them, and a word at a time
+    otherwise.  Swapping in place takes the same path.
+
     These files used to be in dfconv.c, but it got a little too huge,
     so I broke them out into separate files. - Q
 
@@ -51,6 +55,141 @@
 /* NUMBER CONVERSION ROUTINES FOR BYTE SWAPPING                              */
 /*****************************************************************************/
 
+/* Vector kernels for contiguous data, picked at run time on x86 */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DFK_SWAP_X86
+#include <immintrin.h>
+
+/* A kernel swaps the leading whole vectors of nbytes bytes and returns the
+   number of bytes it swapped.  'width' is 0, 1 or 2 for 2, 4 or 8 byte items. */
+typedef size_t (*swap_kernel_t)(uint8 *dest, const uint8 *source, size_t nbytes, int width);
+
+/* pshufb masks reversing the bytes of each 2, 4 and 8 byte item of a 16 byte lane */
+static const uint8 swap_mask[3][16] = {{1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+                                       {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12},
+                                       {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8}};
+
+static swap_kernel_t swap_kernel = NULL; /* set on the first swap, with H4_ATOMIC_* */
+
+static size_t
+DFKIswap_none(uint8 *dest, const uint8 *source, size_t nbytes, int width)
+{
+    (void)dest;
+    (void)source;
+    (void)nbytes;
+    (void)width;
+    return 0;
+}
+
+__attribute__((target("ssse3"))) static size_t
+DFKIswap_ssse3(uint8 *dest, const uint8 *source, size_t nbytes, int width)
+{
+    __m128i mask = _mm_loadu_si128((const __m128i *)(const void *)swap_mask[width]);
+    size_t  i;
+
+    for (i = 0; i + 16 <= nbytes; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(source + i));
+
+        _mm_storeu_si128((__m128i *)(void *)(dest + i), _mm_shuffle_epi8(v, mask));
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) static size_t
+DFKIswap_avx2(uint8 *dest, const uint8 *source, size_t nbytes, int width)
+{
+    __m128i mask  = _mm_loadu_si128((const __m128i *)(const void *)swap_mask[width]);
+    __m256i mask2 = _mm256_broadcastsi128_si256(mask);
+    size_t  i;
+
+    /* both vectors are loaded before either is stored, so in place works */
+    for (i = 0; i + 64 <= nbytes; i += 64) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)(const void *)(source + i));
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)(const void *)(source + i + 32));
+
+        _mm256_storeu_si256((__m256i *)(void *)(dest + i), _mm256_shuffle_epi8(v0, mask2));
+        _mm256_storeu_si256((__m256i *)(void *)(dest + i + 32), _mm256_shuffle_epi8(v1, mask2));
+    }
+    for (; i + 16 <= nbytes; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(source + i));
+
+        _mm_storeu_si128((__m128i *)(void *)(dest + i), _mm_shuffle_epi8(v, mask));
+    }
+    return i;
+}
+
+/* Pick the widest kernel the CPU supports */
+static swap_kernel_t
+DFKIswap_select(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return DFKIswap_avx2;
+    if (__builtin_cpu_supports("ssse3"))
+        return DFKIswap_ssse3;
+    return DFKIswap_none;
+}
+#endif /* x86 */
+
+/************************************************************/
+/* DFKIswap_contig()                                        */
+/* -->Byte swapping for contiguous 2, 4 or 8 byte items.    */
+/*    'source' and 'dest' may be the same buffer.           */
+/************************************************************/
+static void
+DFKIswap_contig(uint8 *dest, const uint8 *source, uint32 num_elm, int size)
+{
+    size_t nbytes = (size_t)num_elm * (size_t)size;
+    size_t i      = 0;
+
+#ifdef DFK_SWAP_X86
+    swap_kernel_t kernel = H4_ATOMIC_LOAD(&swap_kernel);
+
+    /* threads swapping at the same time all pick the same kernel */
+    if (kernel == NULL) {
+        kernel = DFKIswap_select();
+        H4_ATOMIC_STORE(&swap_kernel, kernel);
+    }
+    i = kernel(dest, source, nbytes, size == 2 ? 0 : (size == 4 ? 1 : 2));
+#endif
+
+    /* Whatever is left is swapped one item at a time; each item is read
+       before it is written */
+    switch (size) {
+        case 2:
+            for (; i < nbytes; i += 2) {
+                uint16 v;
+
+                memcpy(&v, source + i, 2);
+                v = (uint16)((v << 8) | (v >> 8));
+                memcpy(dest + i, &v, 2);
+            }
+            break;
+
+        case 4:
+            for (; i < nbytes; i += 4) {
+                uint32 v;
+
+                memcpy(&v, source + i, 4);
+                v = (v << 24) | ((v << 8) & 0x00ff0000U) | ((v >> 8) & 0x0000ff00U) | (v >> 24);
+                memcpy(dest + i, &v, 4);
+            }
+            break;
+
+        default:
+            for (; i < nbytes; i += 8) {
+                uint64_t v;
+
+                memcpy(&v, source + i, 8);
+                v = ((v & 0x00000000ffffffffULL) << 32) | (v >> 32);
+                v = ((v & 0x0000ffff0000ffffULL) << 16) | ((v >> 16) & 0x0000ffff0000ffffULL);
+                v = ((v & 0x00ff00ff00ff00ffULL) << 8) | ((v >> 8) & 0x00ff00ff00ff00ffULL);
+                memcpy(dest + i, &v, 8);
+            }
+            break;
+    }
+}
+
 /************************************************************/
 /* DFKsb2b()                                                */
 /* -->Byte swapping for 2 byte data items                   */
@@ -73,7 +212,7 @@ DFKsb2b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
     }
 
     /* Determine if faster array processing is appropriate */
-    if (source_stride == 0 && dest_stride == 0)
+    if ((source_stride == 0 || source_stride == 2) && (dest_stride == 0 || dest_stride == 2))
         fast_processing = 1;
 
     /* Determine if the conversion should be inplace */
@@ -81,26 +220,8 @@ DFKsb2b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
         in_place = 1;
 
     if (fast_processing) {
-        if (!in_place) {
-            for (i = 0; i < num_elm; i++) {
-                dest[0] = source[1];
-                dest[1] = source[0];
-                dest += 2;
-                source += 2;
-            }
-            return 0;
-        }
-        else {
-            for (i = 0; i < num_elm; i++) {
-                buf[0]  = source[1];
-                buf[1]  = source[0];
-                dest[0] = buf[0];
-                dest[1] = buf[1];
-                dest += 2;
-                source += 2;
-            }
-            return 0;
-        }
+        DFKIswap_contig(dest, source, num_elm, 2);
+        return 0;
     }
 
     /* Generic stride processing */
@@ -145,7 +266,7 @@ DFKsb4b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
     }
 
     /* Determine if faster array processing is appropriate */
-    if (source_stride == 0 && dest_stride == 0)
+    if ((source_stride == 0 || source_stride == 4) && (dest_stride == 0 || dest_stride == 4))
         fast_processing = 1;
 
     /* Determine if the conversion should be inplace */
@@ -153,32 +274,8 @@ DFKsb4b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
         in_place = 1;
 
     if (fast_processing) {
-        if (!in_place) {
-            for (i = 0; i < num_elm; i++) {
-                dest[0] = source[3];
-                dest[1] = source[2];
-                dest[2] = source[1];
-                dest[3] = source[0];
-                dest += 4;
-                source += 4;
-            }
-            return 0;
-        }
-        else {
-            for (i = 0; i < num_elm; i++) {
-                buf[0]  = source[3];
-                buf[1]  = source[2];
-                buf[2]  = source[1];
-                buf[3]  = source[0];
-                dest[0] = buf[0];
-                dest[1] = buf[1];
-                dest[2] = buf[2];
-                dest[3] = buf[3];
-                dest += 4;
-                source += 4;
-            }
-            return 0;
-        }
+        DFKIswap_contig(dest, source, num_elm, 4);
+        return 0;
     }
 
     /* Generic stride processing */
@@ -229,7 +326,7 @@ DFKsb8b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
     }
 
     /* Determine if faster array processing is appropriate */
-    if (source_stride == 0 && dest_stride == 0)
+    if ((source_stride == 0 || source_stride == 8) && (dest_stride == 0 || dest_stride == 8))
         fast_processing = 1;
 
     /* Determine if the conversion should be inplace */
@@ -237,44 +334,8 @@ DFKsb8b(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stri
         in_place = 1;
 
     if (fast_processing) {
-        if (!in_place) {
-            for (i = 0; i < num_elm; i++) {
-                dest[0] = source[7];
-                dest[1] = source[6];
-                dest[2] = source[5];
-                dest[3] = source[4];
-                dest[4] = source[3];
-                dest[5] = source[2];
-                dest[6] = source[1];
-                dest[7] = source[0];
-                dest += 8;
-                source += 8;
-            }
-            return 0;
-        }
-        else {
-            for (i = 0; i < num_elm; i++) {
-                buf[0]  = source[7];
-                buf[1]  = source[6];
-                buf[2]  = source[5];
-                buf[3]  = source[4];
-                buf[4]  = source[3];
-                buf[5]  = source[2];
-                buf[6]  = source[1];
-                buf[7]  = source[0];
-                dest[0] = buf[0];
-                dest[1] = buf[1];
-                dest[2] = buf[2];
-                dest[3] = buf[3];
-                dest[4] = buf[4];
-                dest[5] = buf[5];
-                dest[6] = buf[6];
-                dest[7] = buf[7];
-                dest += 8;
-                source += 8;
-            }
-            return 0;
-        }
+        DFKIswap_contig(dest, source, num_elm, 8);
+        return 0;
     }
 
     /* Generic stride processing */
@@ -59,6 +59,8 @@ static int32 DFPIopen(const char *filename, int acc_mode);
 int
 DFPgetpal(const char *filename, void *palette)
 {
+    H4_API_ENTER;
+
     int32 file_id;
     int32 aid;
     int32 length;
@@ -150,6 +152,8 @@ done:
 int
 DFPputpal(const char *filename, const void *palette, int overwrite, const char *filemode)
 {
+    H4_API_ENTER;
+
     int32 file_id;
     int   ret_value = SUCCEED;
 
@@ -210,6 +214,8 @@ done:
 int
 DFPaddpal(const char *filename, const void *palette)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFPputpal(filename, palette, 0, "a"));
@@ -235,6 +241,8 @@ DFPaddpal(const char *filename, const void *palette)
 int
 DFPnpals(const char *filename)
 {
+    H4_API_ENTER;
+
     int32  file_id;
     int    curr_pal;           /* current palette count */
     int32  nip8, nlut;         /* number of IP8s & number of LUTs */
@@ -338,6 +346,8 @@ done:
 int
 DFPreadref(const char *filename, uint16 ref)
 {
+    H4_API_ENTER;
+
     int32 file_id;
     int32 aid;
     int   ret_value = SUCCEED;
@@ -385,6 +395,8 @@ done:
 int
 DFPwriteref(const char *filename, uint16 ref)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     (void)filename;
@@ -412,6 +424,8 @@ DFPwriteref(const char *filename, uint16 ref)
 int
 DFPrestart(void)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     Lastfile[0] = '\0';
@@ -437,6 +451,8 @@ DFPrestart(void)
 uint16
 DFPlastref(void)
 {
+    H4_API_ENTER;
+
     uint16 ret_value;
 
     ret_value = Lastref;
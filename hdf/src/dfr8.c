@@ -161,6 +161,8 @@ static int DFR8Istart(void);
 int
 DFR8setcompress(int32 type, comp_info *cinfo)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* Perform global, one-time initialization */
@@ -214,6 +216,8 @@ done:
 int
 DFR8getdims(const char *filename, int32 *pxdim, int32 *pydim, int *pispal)
 {
+    H4_API_ENTER;
+
     int32 file_id   = (-1);
     int   ret_value = SUCCEED;
 
@@ -277,6 +281,8 @@ done:
 int
 DFR8getimage(const char *filename, uint8 *image, int32 xdim, int32 ydim, uint8 *pal)
 {
+    H4_API_ENTER;
+
     int32 file_id   = (-1);
     int   ret_value = SUCCEED;
 
@@ -367,6 +373,8 @@ done:
 int
 DFR8setpalette(uint8 *pal)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* Perform global, one-time initialization */
@@ -588,6 +596,8 @@ done:
 int
 DFR8putimage(const char *filename, const void *image, int32 xdim, int32 ydim, uint16 compress)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     /* Perform global, one-time initialization */
@@ -627,6 +637,8 @@ done:
 int
 DFR8addimage(const char *filename, const void *image, int32 xdim, int32 ydim, uint16 compress)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     /* Perform global, one-time initialization */
@@ -871,6 +883,8 @@ done:
 int
 DFR8nimages(const char *filename)
 {
+    H4_API_ENTER;
+
     int32  file_id;
     int32  group_id;           /* group ID for looking at RIG's */
     uint16 elt_tag, elt_ref;   /* tag/ref of items in a RIG */
@@ -1031,6 +1045,8 @@ done:
 int
 DFR8readref(const char *filename, uint16 ref)
 {
+    H4_API_ENTER;
+
     int32 file_id = (-1);
     int32 aid;
     int   ret_value = SUCCEED;
@@ -1084,6 +1100,8 @@ done:
 int
 DFR8writeref(const char *filename, uint16 ref)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     (void)filename;
@@ -1119,6 +1137,8 @@ done:
 int
 DFR8restart(void)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* Perform global, one-time initialization */
@@ -1150,6 +1170,8 @@ done:
 uint16
 DFR8lastref(void)
 {
+    H4_API_ENTER;
+
     uint16 ret_value;
 
     /* Perform global, one-time initialization */
@@ -1176,6 +1198,8 @@ done:
 int
 DFR8getpalref(uint16 *pal_ref)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     HEclear();
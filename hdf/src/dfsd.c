@@ -234,6 +234,8 @@ static int DFSDIstart(void);
 int
 DFSDgetdims(const char *filename, int *prank, int32 sizes[], int maxrank)
 {
+    H4_API_ENTER;
+
     int   i;
     int32 file_id;
     int   ret_value = SUCCEED;
@@ -296,6 +298,8 @@ done:
 int
 DFSDgetdatastrs(char *label, char *unit, char *format, char *coordsys)
 {
+    H4_API_ENTER;
+
     int32 luf;
     char *lufp;
     int   ret_value = SUCCEED;
@@ -359,6 +363,8 @@ done:
 int
 DFSDgetdimstrs(int dim, char *label, char *unit, char *format)
 {
+    H4_API_ENTER;
+
     int   luf;
     int   rdim;
     char *lufp;
@@ -423,6 +429,8 @@ done:
 int
 DFSDgetdatalen(int *llabel, int *lunit, int *lformat, int *lcoordsys)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     HEclear(); /* Clear error stack */
@@ -464,6 +472,8 @@ done:
 int
 DFSDgetdimlen(int dim, int *llabel, int *lunit, int *lformat)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     HEclear(); /* Clear error stack */
@@ -507,6 +517,8 @@ done:
 int
 DFSDgetdimscale(int dim, int32 maxsize, void *scale)
 {
+    H4_API_ENTER;
+
     uint32 dimsize;
     int32  numtype;
     int32  localNTsize;
@@ -581,6 +593,8 @@ done:
 int
 DFSDgetrange(void *pmax, void *pmin)
 {
+    H4_API_ENTER;
+
     int32  numtype;
     uint32 localNTsize;
     uint8 *p1, *p2;
@@ -652,6 +666,8 @@ done:
 int
 DFSDgetdata(const char *filename, int rank, int32 maxsizes[], void *data)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFSDIgetdata(filename, rank, maxsizes, data, 0)); /* 0 == C */
@@ -681,6 +697,8 @@ DFSDgetdata(const char *filename, int rank, int32 maxsizes[], void *data)
 int
 DFSDsetlengths(int maxlen_label, int maxlen_unit, int maxlen_format, int maxlen_coordsys)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* Perform global, one-time initialization */
@@ -722,6 +740,8 @@ done:
 int
 DFSDsetdims(int rank, int32 dimsizes[])
 {
+    H4_API_ENTER;
+
     int i;
     int ret_value = SUCCEED;
 
@@ -799,6 +819,8 @@ done:
 int
 DFSDsetdatastrs(const char *label, const char *unit, const char *format, const char *coordsys)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFSDIsetdatastrs(label, unit, format, coordsys));
@@ -899,6 +921,8 @@ done:
 int
 DFSDsetdimstrs(int dim, const char *label, const char *unit, const char *format)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFSDIsetdimstrs(dim, label, unit, format));
@@ -1004,6 +1028,8 @@ done:
 int
 DFSDsetdimscale(int dim, int32 dimsize, void *scale)
 {
+    H4_API_ENTER;
+
     int32  i;
     int    rdim;
     int32  numtype;
@@ -1117,6 +1143,8 @@ done:
 int
 DFSDsetrange(void *maxi, void *mini)
 {
+    H4_API_ENTER;
+
     int32  numtype;
     uint32 localNTsize;
     int    i;
@@ -1175,6 +1203,8 @@ done:
 int
 DFSDputdata(const char *filename, int rank, int32 dimsizes[], void *data)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     /* 0, 0 specify create mode, C style array (row major) */
@@ -1210,6 +1240,8 @@ DESCRIPTION
 int
 DFSDadddata(const char *filename, int rank, int32 dimsizes[], void *data)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     /* 1, 0 specifies append mode, C style array (row major) */
@@ -1232,6 +1264,8 @@ DFSDadddata(const char *filename, int rank, int32 dimsizes[], void *data)
 int
 DFSDrestart(void)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* Perform global, one-time initialization */
@@ -1265,6 +1299,8 @@ done:
 int32
 DFSDndatasets(char *filename)
 {
+    H4_API_ENTER;
+
     int32 file_id;
     int32 nsdgs     = 0;
     int32 ret_value = SUCCEED;
@@ -1306,6 +1342,8 @@ done:
 int
 DFSDclear(void)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* Perform global, one-time initialization */
@@ -1339,6 +1377,8 @@ done:
 uint16
 DFSDlastref(void)
 {
+    H4_API_ENTER;
+
     uint16 ret_value;
 
     /* Perform global, one-time initialization */
@@ -1375,6 +1415,8 @@ done:
 int
 DFSDreadref(char *filename, uint16 ref)
 {
+    H4_API_ENTER;
+
     int32 file_id;
     int32 aid;
     int   ret_value = SUCCEED;
@@ -1443,6 +1485,8 @@ done:
 int
 DFSDgetslice(const char *filename, int32 winst[], int32 windims[], void *data, int32 dims[])
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFSDIgetslice(filename, winst, windims, data, dims, 0));
@@ -1473,6 +1517,8 @@ DFSDgetslice(const char *filename, int32 winst[], int32 windims[], void *data, i
 int
 DFSDstartslice(const char *filename)
 {
+    H4_API_ENTER;
+
     int   i;
     int32 size;
     int   ret_value = SUCCEED;
@@ -1556,6 +1602,8 @@ done:
 int
 DFSDputslice(int32 winend[], void *data, int32 dims[])
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFSDIputslice(winend, data, dims, 0));
@@ -1585,6 +1633,8 @@ DFSDputslice(int32 winend[], void *data, int32 dims[])
 int
 DFSDendslice(void)
 {
+    H4_API_ENTER;
+
     int ret_value;
 
     ret_value = (DFSDIendslice(0));
@@ -1621,6 +1671,8 @@ DFSDendslice(void)
 int
 DFSDsetNT(int32 numbertype)
 {
+    H4_API_ENTER;
+
     uint8 outNT;
     int   ret_value = SUCCEED;
 
@@ -1724,6 +1776,8 @@ done:
 int
 DFSDgetNT(int32 *pnumbertype)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     HEclear();
@@ -1765,6 +1819,8 @@ done:
 int
 DFSDpre32sdg(char *filename, uint16 ref, int *ispre32)
 {
+    H4_API_ENTER;
+
     uint32    num;
     int32     file_id;
     int       found = 0;
@@ -4173,6 +4229,8 @@ done:
 int
 DFSDgetcal(float64 *pcal, float64 *pcal_err, float64 *pioff, float64 *pioff_err, int32 *cal_nt)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     HEclear();
@@ -4241,6 +4299,8 @@ done:
 int
 DFSDsetcal(float64 cal, float64 cal_err, float64 ioff, float64 ioff_err, int32 cal_nt)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     HEclear();
@@ -4280,6 +4340,8 @@ done:
 int
 DFSDwriteref(const char *filename, uint16 ref)
 {
+    H4_API_ENTER;
+
     int32 file_id;
     int32 aid;
     int   ret_value = SUCCEED;
@@ -4349,6 +4411,8 @@ done:
 int
 DFSDsetfillvalue(void *fill_value)
 {
+    H4_API_ENTER;
+
     int32  numtype;     /* current number type  */
     uint32 localNTsize; /* size of this NT on as it is on this machine  */
     int    ret_value = SUCCEED;
@@ -4401,6 +4465,8 @@ done:
 int
 DFSDgetfillvalue(void *fill_value)
 {
+    H4_API_ENTER;
+
     int32  numtype;     /* current number type  */
     uint32 localNTsize; /* size of this NT on as it is on this machine  */
     int    ret_value = SUCCEED;
@@ -4468,6 +4534,8 @@ int
 DFSDreadslab(const char *filename, int32 start[], int32 slab_size[], int32 stride[], void *buffer,
              int32 buffer_size[])
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     (void)stride;
@@ -4496,6 +4564,8 @@ DFSDreadslab(const char *filename, int32 start[], int32 slab_size[], int32 strid
 int
 DFSDstartslab(const char *filename)
 {
+    H4_API_ENTER;
+
     int32  i;
     int32  sdg_size;
     int32  localNTsize;
@@ -4650,6 +4720,8 @@ done:
 int
 DFSDwriteslab(int32 start[], int32 stride[], int32 count[], void *data)
 {
+    H4_API_ENTER;
+
     int   rank; /* number of dimensions in data[] */
     int32 i;    /* temporary loop index */
 
@@ -4914,6 +4986,8 @@ done:
 int
 DFSDendslab(void)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* Clear error stack */
@@ -100,6 +100,8 @@ static int DFIcheck(DF *dfile);
 DF *
 DFopen(char *name, int acc_mode, int ndds)
 {
+    H4_API_ENTER;
+
     if (DFIcheck(DFlist) == 0) {
         DFerror = DFE_TOOMANY;
         return NULL;
@@ -141,6 +143,8 @@ DFopen(char *name, int acc_mode, int ndds)
 int
 DFclose(DF *dfile)
 {
+    H4_API_ENTER;
+
     int ret;
 
     if (DFIcheck(dfile) != 0) {
@@ -199,6 +203,8 @@ DFclose(DF *dfile)
 int
 DFdescriptors(DF *dfile, DFdesc ptr[], int begin, int num)
 {
+    H4_API_ENTER;
+
     int   i, ret;
     int32 aid;
 
@@ -260,6 +266,8 @@ DFdescriptors(DF *dfile, DFdesc ptr[], int begin, int num)
 int
 DFnumber(DF *dfile, uint16 tag)
 {
+    H4_API_ENTER;
+
     int num;
 
     if (DFIcheck(dfile) != 0) {
@@ -293,6 +301,8 @@ DFnumber(DF *dfile, uint16 tag)
 int
 DFsetfind(DF *dfile, uint16 tag, uint16 ref)
 {
+    H4_API_ENTER;
+
     if (DFIcheck(dfile) != 0) {
         DFerror = DFE_NOTOPEN;
         return -1;
@@ -327,6 +337,8 @@ DFsetfind(DF *dfile, uint16 tag, uint16 ref)
 int
 DFfind(DF *dfile, DFdesc *ptr)
 {
+    H4_API_ENTER;
+
     int ret;
 
     if (DFIcheck(dfile) != 0) {
@@ -383,6 +395,8 @@ DFfind(DF *dfile, DFdesc *ptr)
 int
 DFaccess(DF *dfile, uint16 tag, uint16 ref, char *acc_mode)
 {
+    H4_API_ENTER;
+
     int accmode;
     /*
        DFdle *ptr;
@@ -494,6 +508,8 @@ DFIclearacc(void)
 int
 DFstart(DF *dfile, uint16 tag, uint16 ref, char *acc_mode)
 {
+    H4_API_ENTER;
+
     return DFaccess(dfile, tag, ref, acc_mode);
 }
 
@@ -518,6 +534,8 @@ DFstart(DF *dfile, uint16 tag, uint16 ref, char *acc_mode)
 int32
 DFread(DF *dfile, char *ptr, int32 len)
 {
+    H4_API_ENTER;
+
     int32 ret;
 
     if (DFIcheck(dfile) != 0) {
@@ -567,6 +585,8 @@ DFread(DF *dfile, char *ptr, int32 len)
 int32
 DFseek(DF *dfile, int32 offset)
 {
+    H4_API_ENTER;
+
     int ret;
 
     if (DFIcheck(dfile) != 0) {
@@ -620,6 +640,8 @@ DFseek(DF *dfile, int32 offset)
 int32
 DFwrite(DF *dfile, char *ptr, int32 len)
 {
+    H4_API_ENTER;
+
     int32 size, ret, newlen;
 
     if (DFIcheck(dfile) != 0) {
@@ -693,6 +715,8 @@ DFwrite(DF *dfile, char *ptr, int32 len)
 int
 DFupdate(DF *dfile)
 {
+    H4_API_ENTER;
+
     if (DFIcheck(dfile) != 0) {
         DFerror = DFE_NOTOPEN;
         return -1;
@@ -724,6 +748,8 @@ DFupdate(DF *dfile)
 int
 DFstat(DF *dfile, DFdata *dfinfo)
 {
+    H4_API_ENTER;
+
     (void)dfinfo;
 
     if (DFIcheck(dfile) != 0) {
@@ -758,6 +784,8 @@ DFstat(DF *dfile, DFdata *dfinfo)
 int32
 DFgetelement(DF *dfile, uint16 tag, uint16 ref, char *ptr)
 {
+    H4_API_ENTER;
+
     if (DFIcheck(dfile) != 0) {
         DFerror = DFE_NOTOPEN;
         return -1;
@@ -795,6 +823,8 @@ DFgetelement(DF *dfile, uint16 tag, uint16 ref, char *ptr)
 int32
 DFputelement(DF *dfile, uint16 tag, uint16 ref, char *ptr, int32 len)
 {
+    H4_API_ENTER;
+
     if (DFIcheck(dfile) != 0) {
         DFerror = DFE_NOTOPEN;
         return -1;
@@ -832,6 +862,8 @@ DFputelement(DF *dfile, uint16 tag, uint16 ref, char *ptr, int32 len)
 int
 DFdup(DF *dfile, uint16 itag, uint16 iref, uint16 otag, uint16 oref)
 {
+    H4_API_ENTER;
+
     if (DFIcheck(dfile) != 0) {
         DFerror = DFE_NOTOPEN;
         return -1;
@@ -868,6 +900,8 @@ DFdup(DF *dfile, uint16 itag, uint16 iref, uint16 otag, uint16 oref)
 int
 DFdel(DF *dfile, uint16 tag, uint16 ref)
 {
+    H4_API_ENTER;
+
     if (DFIcheck(dfile) != 0) {
         DFerror = DFE_NOTOPEN;
         return -1;
@@ -901,6 +935,8 @@ DFdel(DF *dfile, uint16 tag, uint16 ref)
 uint16
 DFnewref(DF *dfile)
 {
+    H4_API_ENTER;
+
     uint16 ret;
 
     if (DFIcheck(dfile) != 0) {
@@ -937,6 +973,8 @@ DFnewref(DF *dfile)
 int
 DFishdf(char *filename)
 {
+    H4_API_ENTER;
+
     int32 dummy;
 
     DFerror = DFE_NONE;
@@ -969,6 +1007,8 @@ DFishdf(char *filename)
 int
 DFerrno(void)
 {
+    H4_API_ENTER;
+
     return DFerror;
 }
 
@@ -107,6 +107,8 @@ DFUfptoimage(int32 hdim, int32 vdim, float32 max, float32 min, float32 *hscale,
              float32 *data, uint8 *palette, char *outfile, int ct_method, int32 hres, int32 vres,
              int compress)
 {
+    H4_API_ENTER;
+
     Input  in;
     Output out;
 
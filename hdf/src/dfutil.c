@@ -42,6 +42,8 @@
 uint16
 DFfindnextref(int32 file_id, uint16 tag, uint16 lref)
 {
+    H4_API_ENTER;
+
     uint16 newtag = DFTAG_NULL, newref = DFTAG_NULL;
     int32  aid;
 
@@ -0,0 +1,360 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    hasync.c
+ * Purpose: Asynchronous reads
+ *
+ * Reads are queued in the order they are submitted and taken by a few I/O
+ * threads, started when there is work for them.  A read is not started
+ * while an earlier read of the same file is running, so that the reads
+ * of a file, and their callbacks, complete in the order they were
+ * submitted; reads of different files overlap.  The callback of a read
+ * runs on the I/O thread, right after the read, with the errors of the
+ * read on that thread's error stack.
+ *
+ * Without the thread-safe library the I/O threads could not call the
+ * library, and reads run in the thread that submits them.
+ *
+ * Invokes: pthreads
+ * Contents:
+ *   HASsubmit        - queue a read
+ *   HASPshutdown     - wait for the reads and stop the I/O threads
+ *   Hasyncwait       - wait for all the reads submitted
+ *   Hsetasyncthreads - set the number of I/O threads
+ *---------------------------------------------------------------------------*/
+
+#include "hdf_priv.h"
+#include "hasync_priv.h"
+#include "hthread_priv.h"
+
+#ifdef H4_HAVE_THREADSAFE
+#include <pthread.h>
+
+/* A queued read */
+typedef struct has_request_t {
+    int32                 file_id;  /* reads of a file run one at a time */
+    int32                 id;       /* ID handed to the callback */
+    has_read_func_t       read;     /* the read */
+    void                 *args;     /* its arguments, freed when it is done */
+    hdf_asyncfunc_t       callback; /* called when the read is done */
+    void                 *ctx;      /* handed to the callback */
+    struct has_request_t *next;
+} has_request_t;
+
+static pthread_mutex_t has_lock = PTHREAD_MUTEX_INITIALIZER; /* protects everything below */
+static pthread_cond_t  has_work = PTHREAD_COND_INITIALIZER;  /* a read can start or the threads stop */
+static pthread_cond_t  has_idle = PTHREAD_COND_INITIALIZER;  /* no read queued or running */
+
+static has_request_t *has_head = NULL; /* queued reads, oldest first */
+static has_request_t *has_tail = NULL;
+static int            has_nqueued  = 0;
+static int            has_nrunning = 0;
+static int32          has_running[HTH_MAX_THREADS]; /* files of the running reads */
+static pthread_t      has_threads[HTH_MAX_THREADS];
+static int            has_nthreads   = 0;
+static int            has_maxthreads = HAS_DEFAULT_THREADS;
+static int            has_stop       = FALSE;
+
+static H4_THREAD_LOCAL int has_io_thread = FALSE; /* whether this thread is an I/O thread */
+
+/* Unlink req, which follows prev (NULL for the head), from the queue.
+   Called with the lock held. */
+static void
+HASIunlink(has_request_t *req, has_request_t *prev)
+{
+    if (prev == NULL)
+        has_head = req->next;
+    else
+        prev->next = req->next;
+    if (has_tail == req)
+        has_tail = prev;
+    has_nqueued--;
+}
+
+/* Take the oldest read whose file is not being read, NULL if none.
+   Called with the lock held. */
+static has_request_t *
+HASItake(void)
+{
+    has_request_t *req  = NULL;
+    has_request_t *prev = NULL;
+    int            i;
+
+    for (req = has_head; req != NULL; prev = req, req = req->next) {
+        for (i = 0; i < has_nrunning; i++)
+            if (has_running[i] == req->file_id)
+                break;
+        if (i == has_nrunning)
+            break;
+    }
+    if (req == NULL)
+        return NULL;
+
+    HASIunlink(req, prev);
+    has_running[has_nrunning++] = req->file_id;
+
+    return req;
+}
+
+/* Body of the I/O threads */
+static void *
+HASIthread(void *arg)
+{
+    has_request_t *req = NULL;
+    int            status;
+    int            i;
+
+    (void)arg;
+    has_io_thread = TRUE;
+
+    pthread_mutex_lock(&has_lock);
+    while (!has_stop) {
+        if ((req = HASItake()) == NULL) {
+            pthread_cond_wait(&has_work, &has_lock);
+            continue;
+        }
+        pthread_mutex_unlock(&has_lock);
+
+        status = req->read(req->args);
+        req->callback(req->id, status, req->ctx);
+
+        pthread_mutex_lock(&has_lock);
+        for (i = 0; has_running[i] != req->file_id; i++)
+            ;
+        has_running[i] = has_running[--has_nrunning];
+        free(req->args);
+        free(req);
+
+        /* a read of that file may start now */
+        pthread_cond_broadcast(&has_work);
+        if (has_nqueued == 0 && has_nrunning == 0)
+            pthread_cond_broadcast(&has_idle);
+    }
+    pthread_mutex_unlock(&has_lock);
+
+    return NULL;
+}
+
+/* Wait until no read is queued or running.  Called with the lock held. */
+static void
+HASIwait_idle(void)
+{
+    while (has_nqueued > 0 || has_nrunning > 0)
+        pthread_cond_wait(&has_idle, &has_lock);
+}
+
+/* Stop the I/O threads, which must be idle.  Called with the lock held. */
+static void
+HASIstop_threads(void)
+{
+    int i;
+
+    has_stop = TRUE;
+    pthread_cond_broadcast(&has_work);
+    pthread_mutex_unlock(&has_lock);
+    for (i = 0; i < has_nthreads; i++)
+        pthread_join(has_threads[i], NULL);
+    pthread_mutex_lock(&has_lock);
+    has_nthreads = 0;
+    has_stop     = FALSE;
+
+    /* reads submitted meanwhile by other threads */
+    while (has_nthreads < has_maxthreads && has_nthreads < has_nqueued &&
+           pthread_create(&has_threads[has_nthreads], NULL, HASIthread, NULL) == 0)
+        has_nthreads++;
+}
+#endif /* H4_HAVE_THREADSAFE */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HASsubmit -- queue a read
+ USAGE
+    int HASsubmit(file_id, id, read, args, callback, ctx)
+        int32 file_id;              IN: file read, to keep its reads in order
+        int32 id;                   IN: ID handed to the callback
+        has_read_func_t read;       IN: the read
+        void *args;                 IN: its arguments, allocated with malloc
+        hdf_asyncfunc_t callback;   IN: called when the read is done
+        void *ctx;                  IN: handed to the callback
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Calls read(args), then callback(id, status, ctx) with what the read
+    returned, and frees args, which it owns from now on, even if it
+    fails.  In the thread-safe library this happens on an I/O thread,
+    after the reads of file_id submitted before; otherwise, or if no I/O
+    thread can be started, it happens before HASsubmit returns.
+--------------------------------------------------------------------------*/
+int
+HASsubmit(int32 file_id, int32 id, has_read_func_t read, void *args, hdf_asyncfunc_t callback, void *ctx)
+{
+#ifdef H4_HAVE_THREADSAFE
+    has_request_t *req  = NULL;
+    has_request_t *prev = NULL;
+#endif
+    int status;
+    int ret_value = SUCCEED;
+
+    if (read == NULL || callback == NULL) {
+        free(args);
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+#ifdef H4_HAVE_THREADSAFE
+    if ((req = (has_request_t *)malloc(sizeof(has_request_t))) == NULL) {
+        free(args);
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    }
+    req->file_id  = file_id;
+    req->id       = id;
+    req->read     = read;
+    req->args     = args;
+    req->callback = callback;
+    req->ctx      = ctx;
+    req->next     = NULL;
+
+    pthread_mutex_lock(&has_lock);
+    prev = has_tail;
+    if (has_tail == NULL)
+        has_head = req;
+    else
+        has_tail->next = req;
+    has_tail = req;
+    has_nqueued++;
+
+    /* one more thread if all of them are busy */
+    if (has_nthreads < has_maxthreads && has_nthreads < has_nqueued + has_nrunning &&
+        pthread_create(&has_threads[has_nthreads], NULL, HASIthread, NULL) == 0)
+        has_nthreads++;
+
+    if (has_nthreads > 0) {
+        pthread_cond_signal(&has_work);
+        pthread_mutex_unlock(&has_lock);
+        HGOTO_DONE(SUCCEED);
+    }
+
+    /* no thread to run it: run it here, and leave the other reads queued */
+    HASIunlink(req, prev);
+    pthread_mutex_unlock(&has_lock);
+    free(req);
+#else
+    (void)file_id;
+#endif
+
+    status = read(args);
+    callback(id, status, ctx);
+    free(args);
+
+done:
+    return ret_value;
+} /* HASsubmit */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HASPshutdown -- wait for the reads and stop the I/O threads
+ USAGE
+    void HASPshutdown()
+ RETURNS
+    Nothing
+ DESCRIPTION
+    Called by HPend() before the files are closed.
+--------------------------------------------------------------------------*/
+void
+HASPshutdown(void)
+{
+#ifdef H4_HAVE_THREADSAFE
+    if (has_io_thread)
+        return;
+
+    pthread_mutex_lock(&has_lock);
+    HASIwait_idle();
+    if (has_nthreads > 0)
+        HASIstop_threads();
+    pthread_mutex_unlock(&has_lock);
+#endif
+} /* HASPshutdown */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hasyncwait -- wait for all the reads submitted
+ USAGE
+    int Hasyncwait()
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Returns when every read submitted by SDreaddata_async or
+    GRreadimage_async, from any thread, is done and its callback has
+    returned.  Call it before ending access to the data sets or images
+    being read, or before using the buffers they are read into.  It
+    fails when called from a callback.
+--------------------------------------------------------------------------*/
+int
+Hasyncwait(void)
+{
+    int ret_value = SUCCEED;
+
+    HEclear();
+
+#ifdef H4_HAVE_THREADSAFE
+    if (has_io_thread)
+        HGOTO_ERROR(DFE_BADCALL, FAIL);
+
+    pthread_mutex_lock(&has_lock);
+    HASIwait_idle();
+    pthread_mutex_unlock(&has_lock);
+
+done:
+#endif
+    return ret_value;
+} /* Hasyncwait */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Hsetasyncthreads -- set the number of I/O threads
+ USAGE
+    int Hsetasyncthreads(nthreads)
+        int nthreads;       IN: most I/O threads to run
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Waits for the reads submitted, like Hasyncwait, and stops the I/O
+    threads; the next reads start up to nthreads of them, at most 64.
+    The default is 4.  Reads of one file never run at the same time, so
+    more threads help when reading more files.  Without the thread-safe
+    library there are no I/O threads and this only checks nthreads.
+--------------------------------------------------------------------------*/
+int
+Hsetasyncthreads(int nthreads)
+{
+    int ret_value = SUCCEED;
+
+    HEclear();
+
+    if (nthreads < 1)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+#ifdef H4_HAVE_THREADSAFE
+    if (has_io_thread)
+        HGOTO_ERROR(DFE_BADCALL, FAIL);
+
+    pthread_mutex_lock(&has_lock);
+    HASIwait_idle();
+    if (has_nthreads > 0)
+        HASIstop_threads();
+    has_maxthreads = nthreads < HTH_MAX_THREADS ? nthreads : HTH_MAX_THREADS;
+    pthread_mutex_unlock(&has_lock);
+#endif
+
+done:
+    return ret_value;
+} /* Hsetasyncthreads */
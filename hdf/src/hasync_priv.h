@@ -0,0 +1,48 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    hasync_priv.h
+ * Purpose: Asynchronous reads
+ * Dependencies: hdf_priv.h
+ * Contents: The *_async routines check their arguments, copy them and hand
+ *           a read to HASsubmit().  In the thread-safe library the read
+ *           runs later on one of the I/O threads, which call the public
+ *           routines like any other thread of the application.  Otherwise
+ *           HASsubmit() runs it at once.
+ *---------------------------------------------------------------------------*/
+
+#ifndef H4_HASYNC_PRIV_H
+#define H4_HASYNC_PRIV_H
+
+#include "hdf_priv.h"
+
+/* I/O threads started by default */
+#define HAS_DEFAULT_THREADS 4
+
+/* A read: returns SUCCEED/FAIL and leaves its errors on the error stack */
+typedef int (*has_read_func_t)(void *args);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+HDFLIBAPI int HASsubmit(int32 file_id, int32 id, has_read_func_t read, void *args, hdf_asyncfunc_t callback,
+                        void *ctx);
+
+HDFLIBAPI void HASPshutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H4_HASYNC_PRIV_H */
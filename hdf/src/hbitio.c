@@ -91,6 +91,8 @@ static int HIbitstart(void);
 int32
 Hstartbitread(int32 file_id, uint16 tag, uint16 ref)
 {
+    H4_API_ENTER;
+
     int32            aid;         /* Access ID for the bit-level routines to use */
     struct bitrec_t *bitfile_rec; /* Pointer to the bitfile record */
     int32            ret_value;   /* return bit ID */
@@ -167,6 +169,8 @@ Hstartbitread(int32 file_id, uint16 tag, uint16 ref)
 int32
 Hstartbitwrite(int32 file_id, uint16 tag, uint16 ref, int32 length)
 {
+    H4_API_ENTER;
+
     bitrec_t *bitfile_rec; /* access record */
     int32     aid;         /* Access ID for the bit-level routines to use */
     int       exists;      /* whether dataset exists already */
@@ -248,6 +252,8 @@ Hstartbitwrite(int32 file_id, uint16 tag, uint16 ref, int32 length)
 int
 Hbitappendable(int32 bitid)
 {
+    H4_API_ENTER;
+
     bitrec_t *bitfile_rec; /* access record */
 
     /* clear error stack and check validity of file id */
@@ -290,9 +296,11 @@ Hbitappendable(int32 bitid)
 int
 Hbitwrite(int32 bitid, int count, uint32 data)
 {
-    static int32     last_bit_id = (-1);  /* the bit ID of the last bitfile_record accessed */
-    static bitrec_t *bitfile_rec = NULL;  /* access record */
-    int              orig_count  = count; /* keep track of orig, number of bits to output */
+    H4_API_ENTER;
+
+    static H4_THREAD_LOCAL int32     last_bit_id = (-1);  /* the bit ID of the last bitfile_record accessed */
+    static H4_THREAD_LOCAL bitrec_t *bitfile_rec = NULL;  /* access record */
+    int                              orig_count  = count; /* keep track of orig, number of bits to output */
 
     /* clear error stack and check validity of file id */
     HEclear();
@@ -420,12 +428,14 @@ Hbitwrite(int32 bitid, int count, uint32 data)
 int
 Hbitread(int32 bitid, int count, uint32 *data)
 {
-    static int32     last_bit_id = (-1); /* the bit ID of the last bitfile_record accessed */
-    static bitrec_t *bitfile_rec = NULL; /* access record */
-    uint32           l;
-    uint32           b = 0;      /* bits to return */
-    int              orig_count; /* the original number of bits to read in */
-    int32            n;
+    H4_API_ENTER;
+
+    static H4_THREAD_LOCAL int32     last_bit_id = (-1); /* the bit ID of the last bitfile_record accessed */
+    static H4_THREAD_LOCAL bitrec_t *bitfile_rec = NULL; /* access record */
+    uint32                           l;
+    uint32                           b = 0;      /* bits to return */
+    int                              orig_count; /* the original number of bits to read in */
+    int32                            n;
 
     /* clear error stack and check validity of file id */
     HEclear();
@@ -544,6 +554,8 @@ REVISION LOG
 int
 Hbitseek(int32 bitid, int32 byte_offset, int bit_offset)
 {
+    H4_API_ENTER;
+
     bitrec_t *bitfile_rec; /* access record */
     int32     seek_pos;    /* position of block to seek to */
     int32     read_size;   /* number of bytes to read into buffer */
@@ -629,6 +641,8 @@ Hbitseek(int32 bitid, int32 byte_offset, int bit_offset)
 int
 Hgetbit(int32 bitid)
 {
+    H4_API_ENTER;
+
     uint32 data;
 
     if (Hbitread(bitid, 1, &data) == FAIL)
@@ -664,6 +678,8 @@ Hgetbit(int32 bitid)
 int32
 Hendbitaccess(int32 bitfile_id, int flushbit)
 {
+    H4_API_ENTER;
+
     bitrec_t *bitfile_rec; /* bitfile record */
 
     /* check validity of access id */
@@ -706,13 +722,14 @@ HIbitstart(void)
 {
     int ret_value = SUCCEED;
 
-    /* Don't call this routine again... */
-    library_terminate = TRUE;
-
     /* Create the file ID and access ID groups */
     if (HAinit_group(BITIDGROUP, 16) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
+    /* Don't call this routine again; set last, as readers of different
+       files may get here at the same time in the thread-safe build */
+    library_terminate = TRUE;
+
 done:
     return ret_value;
 } /* end HIbitstart() */
@@ -193,6 +193,8 @@ DESCRIPTION
 int32
 HLcreate(int32 file_id, uint16 tag, uint16 ref, int32 block_length, int32 number_blocks)
 {
+    H4_API_ENTER;
+
     filerec_t  *file_rec;                  /* file record */
     accrec_t   *access_rec = NULL;         /* access record */
     int32       dd_aid;                    /* AID for writing the special info */
@@ -379,6 +381,8 @@ DESCRIPTION
 int
 HLconvert(int32 aid, int32 block_length, int32 number_blocks)
 {
+    H4_API_ENTER;
+
     filerec_t  *file_rec;                               /* file record */
     accrec_t   *access_rec = NULL;                      /* access record */
     linkinfo_t *info;                                   /* information for the linked blocks elt */
@@ -552,6 +556,8 @@ DESCRIPTION
 int
 HDinqblockinfo(int32 aid, int32 *length, int32 *first_length, int32 *block_length, int32 *number_blocks)
 {
+    H4_API_ENTER;
+
     accrec_t *arec;
     int       ret_value = SUCCEED;
 
@@ -761,6 +767,8 @@ HLgetdatainfo(int32 file_id, uint8 *buf, /* IN: special header info */
               int32   *offsetarray,      /* OUT: array to hold offsets */
               int32   *lengtharray)        /* OUT: array to hold lengths */
 {
+    H4_API_ENTER;
+
     link_t  *link_info = NULL; /* link information, to get block ref#s*/
     unsigned num_data_blocks;  /* number of blocks that actually have data */
     uint16   link_ref;         /* ref# pointing to a block table */
@@ -1713,6 +1721,8 @@ HLsetblockinfo(int32 aid,        /* access record id */
                int32 block_size, /* length to be used for each linked-block */
                int32 num_blocks) /* number of blocks the element will have */
 {
+    H4_API_ENTER;
+
     accrec_t *access_rec; /* access record */
     int       ret_value = SUCCEED;
 
@@ -1780,6 +1790,8 @@ HLgetblockinfo(int32  aid,        /* access record id */
                int32 *block_size, /* length being used for each linked-block */
                int32 *num_blocks) /* number of blocks the element will have */
 {
+    H4_API_ENTER;
+
     accrec_t *access_rec; /* access record */
     int       ret_value = SUCCEED;
 
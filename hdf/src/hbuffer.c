@@ -95,6 +95,8 @@ FORTRAN
 int
 HBconvert(int32 aid)
 {
+    H4_API_ENTER;
+
     accrec_t  *access_rec = NULL;  /* access element record */
     accrec_t  *new_access_rec;     /* newly created access record */
     accrec_t  *tmp_access_rec;     /* temp. access record */
@@ -198,7 +198,11 @@ EXPORTED ROUTINES
    HMCcreate       -- create a chunked element
    HMCwriteChunk   -- write out the specified chunk to a chunked element
    HMCreadChunk    -- read the specified chunk from a chunked element
+   HMCreadChunkRaw -- read the specified chunk as it is stored
+   HMCwriteChunkRaw -- write the specified chunk, already encoded
    HMCsetMaxcache  -- maximum number of chunks to cache
+   HMCsetreadthreads -- number of threads decoding chunks on reads
+   HMCsetwritethreads -- number of threads encoding chunks on writes
    HMCPcloseAID    -- close file but keep AID active (For Hnextread())
 
    Library Private
@@ -209,6 +213,7 @@ EXPORTED ROUTINES
    HMCPchunkread   -- read a single chunk out of a chunked element
    HMCPread        -- read some data out of a chunked element
    HMCPchunkwrite  -- write out a single chunk to a chunked element
+   HMCPchunkwritev -- write out several chunks to a chunked element
    HMCPwrite       -- write out some data to a chunked element
    HMCPinquire     -- Hinquire for chunked element
    HMCPendacess    -- close a chunked element AID
@@ -241,6 +246,7 @@ LOCAL ROUTINES
    Common Routine
    -------------
    HMCIstaccess -- set up AID to access a chunked element
+   HMCIprefetch -- decode the next chunks of a read on the read threads
 
    AUTHOR
    -------
@@ -260,7 +266,9 @@ LOCAL ROUTINES
 
 #include "tbbt_priv.h"
 #include "mcache_priv.h"
+#include "hthread_priv.h"
 #include "hcomp.h"
+#include "zlib.h"
 
 /* Define class, class version and name(partial) for chunk table i.e. Vdata */
 #define _HDF_CHK_TBL_NAME "_HDF_CHK_TBL_" /* 13 bytes */
@@ -343,8 +351,26 @@ typedef struct chunkinfo_t {
                                      i.e. CHUNK_REC's read/written/modified */
     MCACHE *chk_cache;            /* chunk cache */
     int32   num_recs;             /* number of Table(Vdata) records */
+
+    hthread_pool_t *read_pool;  /* threads decoding chunks on reads, NULL if none */
+    hthread_pool_t *write_pool; /* threads encoding chunks on writes, NULL if none */
 } chunkinfo_t;
 
+/* Chunks decoded ahead by HMCIprefetch(), or encoded together by
+   HMCPchunkwritev(), per thread */
+#define HMC_CHUNKS_PER_THREAD 4
+
+/* A chunk decoded or encoded on a thread */
+typedef struct chunk_task_struct {
+    int32  chunk_num; /* chunk number */
+    uint8 *cdata;     /* chunk as stored, compressed */
+    int32  clen;      /* length of 'cdata' */
+    uint8 *udata;     /* chunk data, not compressed */
+    int32  ulen;      /* length of 'udata', the size of the chunk */
+    int    level;     /* deflate level, when encoding */
+    int    ok;        /* TRUE if the chunk was decoded or encoded */
+} CHUNK_TASK;
+
 /* private functions */
 static int32 HMCIstaccess(accrec_t *access_rec, /* IN: access record to fill in */
                           int16     acc_mode /* IN: access mode */);
@@ -375,6 +401,11 @@ static int32 HMCPchunkwrite(void       *cookie,    /* IN: access record to mess
                             int32       chunk_num, /* IN: chunk number */
                             const void *datap /* IN: buffer for data */);
 
+static int32 HMCPchunkwritev(void        *cookie,     /* IN: access record to mess with */
+                             int32        nchunks,    /* IN: number of chunks */
+                             const int32 *chunk_nums, /* IN: chunk numbers */
+                             void       **datap /* IN: buffers for data */);
+
 static int32 HMCPwrite(accrec_t   *access_rec, /* IN: access record to mess with */
                        int32       length,     /* IN: number of bytes to write */
                        const void *data /* IN: buffer for data */);
@@ -937,6 +968,8 @@ HMCIstaccess(accrec_t *access_rec, /* IN: access record to fill in */
         info->comp_sp_tag_header   = NULL;
         info->comp_sp_tag_head_len = 0;
         info->num_recs             = 0; /* zero records to start with */
+        info->read_pool            = NULL;
+        info->write_pool           = NULL;
 
         /* read the special info structure from the file */
         if ((dd_aid = Hstartaccess(access_rec->file_id, data_tag, data_ref, DFACC_READ)) == FAIL)
@@ -1206,7 +1239,10 @@ HMCIstaccess(accrec_t *access_rec, /* IN: access record to fill in */
         for (i = 1; i < info->ndims; i++) {
             chunks_needed *= info->ddims[i].num_chunks;
         }
-        if ((info->chk_cache = mcache_open(&access_rec->file_id,               /* cache key */
+        /* the caches of all chunked elements of the file share one pool */
+        if (file_rec->chunk_pool == NULL && (file_rec->chunk_pool = mcache_pool_create()) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if ((info->chk_cache = mcache_open(file_rec->chunk_pool,               /* cache pool */
                                            access_aid,                         /* object id */
                                            (info->chunk_size * info->nt_size), /* chunk size */
                                            chunks_needed,                      /* maxcache */
@@ -1332,6 +1368,8 @@ HMCcreate(int32 file_id,       /* IN: file to put chunked element in */
           HCHUNK_DEF *chk_array /* IN: structure describing chunk distribution
                                   can be an array? but we only handle 1 level */ )
 {
+    H4_API_ENTER;
+
     filerec_t   *file_rec    = NULL;      /* file record */
     accrec_t    *access_rec  = NULL;      /* access record */
     int32        dd_aid      = FAIL;      /* AID for writing the special info */
@@ -1418,6 +1456,8 @@ HMCcreate(int32 file_id,       /* IN: file to put chunked element in */
     info->ddims                = NULL;
     info->chk_tree             = NULL;
     info->chk_cache            = NULL;
+    info->read_pool            = NULL;
+    info->write_pool           = NULL;
     info->num_recs             = 0;            /* zero Vdata records to start */
     info->fill_val_len         = fill_val_len; /* length of fill value */
     /* allocate space for fill value */
@@ -1709,7 +1749,10 @@ HMCcreate(int32 file_id,       /* IN: file to put chunked element in */
         chunks_needed *= info->ddims[i].num_chunks;
     }
     /* create chunk cache */
-    if ((info->chk_cache = mcache_open(&access_rec->file_id,               /* cache key */
+    /* the caches of all chunked elements of the file share one pool */
+    if (file_rec->chunk_pool == NULL && (file_rec->chunk_pool = mcache_pool_create()) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((info->chk_cache = mcache_open(file_rec->chunk_pool,               /* cache pool */
                                        access_aid,                         /* object id */
                                        (info->chunk_size * info->nt_size), /* chunk size */
                                        chunks_needed,                      /* maxcache */
@@ -1793,6 +1836,8 @@ HMCgetcompress(accrec_t     *access_rec, /* IN: access record */
                comp_coder_t *comp_type,  /* OUT: compression type */
                comp_info    *c_info)        /* OUT: retrieved compression info */
 {
+    H4_API_ENTER;
+
     chunkinfo_t *info = NULL; /* chunked element information record */
     model_info   m_info;      /* modeling information - dummy */
     comp_model_t model_type;  /* modeling type - dummy */
@@ -1837,6 +1882,8 @@ int
 HMCgetcomptype(int32         dd_aid,    /* IN: access id of header info */
                comp_coder_t *comp_type) /* OUT: compression type */
 {
+    H4_API_ENTER;
+
     uint8 *bufp;                      /* pointer to buffer */
     uint8  version;                   /* Version of this Chunked element */
     int32  flag;                      /* flag for multiply specialness ...*/
@@ -1962,6 +2009,8 @@ HMCgetdatainfo(int32 file_id, uint16 tag, uint16 ref, int32 *chk_coord, /* IN: c
                int32   *offsetarray, /* OUT: array to hold offsets */
                int32   *lengtharray)   /* OUT: array to hold lengths */
 {
+    H4_API_ENTER;
+
     uint16       comp_ref = 0;    /* ref# of compressed data */
     chunkinfo_t *chkinfo  = NULL; /* chunked element information */
     atom_t       ddid     = FAIL; /* description record access id */
@@ -2177,6 +2226,8 @@ HMCgetdatasize(int32 file_id, uint8 *p, /* IN: access id of header info */
                int32 *comp_size,        /* OUT: size of compressed data */
                int32 *orig_size)        /* OUT: size of uncompression type */
 {
+    H4_API_ENTER;
+
     uint16       comp_ref = 0;                   /* ref# of compressed data */
     char         vsname[VSNAMELENMAX + 1];       /* Vdata name */
     char         v_class[VSNAMELENMAX + 1] = ""; /* Vdata class for comparison */
@@ -2414,6 +2465,8 @@ HMCsetMaxcache(int32 access_id, /* IN: access aid to mess with */
                int32 maxcache,  /* IN: max number of pages to cache */
                int32 flags /* IN: flags = 0, HMC_PAGEALL */)
 {
+    H4_API_ENTER;
+
     accrec_t    *access_rec = NULL; /* access record */
     chunkinfo_t *info       = NULL; /* chunked element information record */
     int32        ret_value  = SUCCEED;
@@ -2442,6 +2495,142 @@ done:
     return ret_value;
 } /* HMCsetMaxcache() */
 
+/* -------------------------------- HMCIset_pool -------------------------------
+NAME
+   HMCIset_pool - replace a pool of threads of a chunked element
+
+DESCRIPTION
+   Replaces '*pool' with a pool of 'nthreads' threads if the element is
+   compressed with deflate and threads can be had, else with NULL.
+
+RETURNS
+   SUCCEED/FAIL
+--------------------------------------------------------------------------- */
+static int
+HMCIset_pool(chunkinfo_t     *info, /* IN: chunked element information record */
+             hthread_pool_t **pool, /* IN/OUT: pool to replace */
+             int              nthreads /* IN: number of threads */)
+{
+    int ret_value = SUCCEED;
+
+    HTHpool_destroy(*pool);
+    *pool = NULL;
+
+    /* only chunks compressed with deflate are coded on the threads */
+    if (nthreads > 1 && (info->flag & 0xff) == SPECIAL_COMP && info->comp_type == COMP_CODE_DEFLATE &&
+        info->model_type == COMP_MODEL_STDIO) {
+        if ((*pool = HTHpool_create(nthreads)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+        /* no threads to be had */
+        if (HTHpool_nthreads(*pool) < 2) {
+            HTHpool_destroy(*pool);
+            *pool = NULL;
+        }
+    }
+
+done:
+    return ret_value;
+} /* HMCIset_pool() */
+
+/*--------------------------------------------------------------------------
+NAME
+     HMCsetreadthreads - number of threads decoding chunks on reads
+
+DESCRIPTION
+     When a read of an element compressed with deflate needs a chunk that
+     is not cached, the chunks the rest of the read needs are read as they
+     are stored and decoded on 'nthreads' threads, then put in the chunk
+     cache.  0 or 1 go back to decoding each chunk when it is needed.
+
+     The number of chunks decoded ahead is limited by 'maxcache', see
+     HMCsetMaxcache().  The setting is ignored for elements not compressed
+     with deflate, and when the library is built without threads.
+
+RETURNS
+     SUCCEED/FAIL
+--------------------------------------------------------------------------- */
+int
+HMCsetreadthreads(int32 access_id, /* IN: access aid to mess with */
+                  int   nthreads /* IN: number of threads, 0 or 1 for none */)
+{
+    H4_API_ENTER;
+
+    accrec_t    *access_rec = NULL; /* access record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    int          ret_value  = SUCCEED;
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || nthreads < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if (access_rec->special != SPECIAL_CHUNKED || access_rec->special_info == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    info = (chunkinfo_t *)(access_rec->special_info);
+
+    ret_value = HMCIset_pool(info, &info->read_pool, nthreads);
+
+done:
+    return ret_value;
+} /* HMCsetreadthreads() */
+
+/*--------------------------------------------------------------------------
+NAME
+     HMCsetwritethreads - number of threads encoding chunks on writes
+
+DESCRIPTION
+     Modified chunks of an element compressed with deflate are written out
+     of the chunk cache several at a time: they are encoded on 'nthreads'
+     threads, then written in order by the calling thread.  This happens
+     when the element is closed, and when a modified chunk has to leave
+     the cache, which also writes the modified chunks in the older half of
+     the cache.  0 or 1 go back to encoding each chunk when it is written.
+
+     The chunks are stored exactly as they are without threads, though
+     not necessarily at the same place in the file.  The setting is
+     ignored for elements not compressed with deflate, and when the library
+     is built without threads.
+
+RETURNS
+     SUCCEED/FAIL
+--------------------------------------------------------------------------- */
+int
+HMCsetwritethreads(int32 access_id, /* IN: access aid to mess with */
+                   int   nthreads /* IN: number of threads, 0 or 1 for none */)
+{
+    H4_API_ENTER;
+
+    accrec_t    *access_rec = NULL; /* access record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    int          ret_value  = SUCCEED;
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || nthreads < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if (access_rec->special != SPECIAL_CHUNKED || access_rec->special_info == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    info = (chunkinfo_t *)(access_rec->special_info);
+
+    if (HMCIset_pool(info, &info->write_pool, nthreads) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    if (info->write_pool != NULL)
+        mcache_filter_batch(info->chk_cache, HMCPchunkwritev,
+                            HTHpool_nthreads(info->write_pool) * HMC_CHUNKS_PER_THREAD);
+    else
+        mcache_filter_batch(info->chk_cache, NULL, 1);
+
+done:
+    return ret_value;
+} /* HMCsetwritethreads() */
+
 /* ------------------------------ HMCPstread -------------------------------
 NAME
    HMCPstread -- open an access record of chunked element for reading
@@ -2665,6 +2854,8 @@ HMCreadChunk(int32  access_id, /* IN: access aid to mess with */
              int32 *origin,    /* IN: origin of chunk to read */
              void  *datap /* IN: buffer for data */)
 {
+    H4_API_ENTER;
+
     accrec_t    *access_rec = NULL; /* access record */
     filerec_t   *file_rec   = NULL; /* file record */
     chunkinfo_t *info       = NULL; /* chunked element information record */
@@ -2759,6 +2950,201 @@ done:
     return ret_value;
 } /* HMCreadChunk() */
 
+/* ------------------------------- HMCIinflate_chunk ---------------------------
+NAME
+   HMCIinflate_chunk - decode a chunk compressed with deflate
+
+DESCRIPTION
+   Task of the read threads, see HMCIprefetch().  It runs on any thread,
+   so it only uses zlib: a chunk that does not decode to exactly its size
+   is left for HMCPread() to read as usual.
+
+RETURNS
+   Nothing, sets 'ok' in the chunk
+--------------------------------------------------------------------------- */
+static void
+HMCIinflate_chunk(void *arg, /* IN: array of chunks */
+                  int   task /* IN: chunk to decode */)
+{
+    CHUNK_TASK *pf = (CHUNK_TASK *)arg + task;
+    z_stream    zs;
+
+    pf->ok = FALSE;
+
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit(&zs) != Z_OK)
+        return;
+
+    zs.next_in   = pf->cdata;
+    zs.avail_in  = (uInt)pf->clen;
+    zs.next_out  = pf->udata;
+    zs.avail_out = (uInt)pf->ulen;
+    if (inflate(&zs, Z_FINISH) == Z_STREAM_END && zs.total_out == (uLong)pf->ulen)
+        pf->ok = TRUE;
+
+    inflateEnd(&zs);
+} /* HMCIinflate_chunk() */
+
+/* ------------------------------- HMCIprefetch --------------------------------
+NAME
+   HMCIprefetch - decode the next chunks of a read on the read threads
+
+DESCRIPTION
+   Walks the rest of a read the way HMCPread() does, from the position
+   'posn' in the element for 'length' bytes, and picks the chunks it
+   needs that are not cached, up to HMC_CHUNKS_PER_THREAD per read
+   thread and never more than the cache holds.
+
+   The chunks compressed with deflate are read as they are stored by this
+   thread, decoded on the read threads, and put in the chunk cache, and
+   the chunks never written are filled in the cache.  The others (chunks
+   compressed another way or that could not be decoded) are left for
+   HMCPread() to read through the cache one at a time, which also reports
+   any error reading them.
+
+RETURNS
+   SUCCEED/FAIL
+--------------------------------------------------------------------------- */
+static int
+HMCIprefetch(accrec_t *access_rec, /* IN: access record of the read */
+             int32     posn,       /* IN: position of the read in the element */
+             int32     length /* IN: number of bytes left to read */)
+{
+    chunkinfo_t *info          = (chunkinfo_t *)(access_rec->special_info);
+    CHUNK_TASK  *pf            = NULL; /* chunks picked */
+    int32       *chunk_indices = NULL; /* chunk indices of the walk */
+    int32       *pos_chunk     = NULL; /* position in chunk of the walk */
+    int32        page_size     = info->chunk_size * info->nt_size;
+    int32        max_chunks    = 0; /* chunks that can be picked */
+    int32        npicked       = 0; /* chunks picked */
+    int32        nread         = 0; /* chunks read, at the start of 'pf' */
+    int32        walked        = 0; /* bytes of the read walked */
+    int32        chunk_num     = 0;
+    int32        chunk_size    = 0;
+    int32        i, j;
+    int          ret_value = SUCCEED;
+
+    max_chunks = HTHpool_nthreads(info->read_pool) * HMC_CHUNKS_PER_THREAD;
+    if (max_chunks > mcache_get_maxcache(info->chk_cache))
+        max_chunks = mcache_get_maxcache(info->chk_cache);
+    if (max_chunks < 2)
+        HGOTO_DONE(SUCCEED);
+
+    if ((pf = (CHUNK_TASK *)calloc((size_t)max_chunks, sizeof(CHUNK_TASK))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((chunk_indices = (int32 *)malloc((size_t)info->ndims * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((pos_chunk = (int32 *)malloc((size_t)info->ndims * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* walk the read, picking each missing chunk once */
+    update_chunk_indices_seek(posn, info->ndims, info->nt_size, chunk_indices, pos_chunk, info->ddims);
+    while (walked < length && npicked < max_chunks) {
+        calculate_chunk_num(&chunk_num, info->ndims, chunk_indices, info->ddims);
+        calculate_chunk_for_chunk(&chunk_size, info->ndims, info->nt_size, length, walked, chunk_indices,
+                                  pos_chunk, info->ddims);
+
+        if (!mcache_incache(info->chk_cache, chunk_num + 1)) {
+            for (i = 0; i < npicked; i++)
+                if (pf[i].chunk_num == chunk_num)
+                    break;
+            if (i == npicked)
+                pf[npicked++].chunk_num = chunk_num;
+        }
+
+        walked += chunk_size;
+        posn += chunk_size;
+        update_chunk_indices_seek(posn, info->ndims, info->nt_size, chunk_indices, pos_chunk, info->ddims);
+    }
+
+    /* read the chunks compressed with deflate as they are stored */
+    for (i = 0; i < npicked; i++) {
+        TBBT_NODE   *entry = NULL;
+        CHUNK_REC   *chk_rec;
+        comp_model_t model_type;
+        comp_coder_t coder_type;
+        uint16       comp_ref;
+        int32        orig_size;
+        int32        clen;
+
+        chunk_num = pf[i].chunk_num;
+        if ((entry = tbbtdfind(info->chk_tree, &chunk_num, NULL)) == NULL ||
+            ((CHUNK_REC *)entry->data)->chk_tag == DFTAG_NULL) {
+            void *chk_data = NULL;
+
+            /* never written: cache the fill values now, so that the read
+               does not come back here for each of these chunks */
+            if ((chk_data = mcache_get(info->chk_cache, chunk_num + 1, 0)) == NULL)
+                HE_REPORT_GOTO("failed to find chunk record", FAIL);
+            if (mcache_put(info->chk_cache, chk_data, 0) == FAIL)
+                HE_REPORT_GOTO("failed to put chunk back in cache", FAIL);
+            continue;
+        }
+        chk_rec = (CHUNK_REC *)entry->data;
+        if (BASETAG(chk_rec->chk_tag) != DFTAG_CHUNK)
+            continue;
+
+        if (HCPgetcompref(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, &model_type, &coder_type,
+                          &comp_ref, &orig_size) == FAIL)
+            continue;
+        if (coder_type != COMP_CODE_DEFLATE || model_type != COMP_MODEL_STDIO || comp_ref == 0 ||
+            orig_size != page_size)
+            continue;
+        if ((clen = Hlength(access_rec->file_id, DFTAG_COMPRESSED, comp_ref)) <= 0)
+            continue;
+
+        /* 'pf[nread]' is this chunk or one that was skipped */
+        pf[nread].chunk_num = chunk_num;
+        pf[nread].clen      = clen;
+        pf[nread].ulen      = page_size;
+        if ((pf[nread].cdata = (uint8 *)malloc((size_t)clen)) == NULL ||
+            (pf[nread].udata = (uint8 *)malloc((size_t)page_size)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (Hgetelement(access_rec->file_id, DFTAG_COMPRESSED, comp_ref, pf[nread].cdata) != clen) {
+            free(pf[nread].cdata);
+            free(pf[nread].udata);
+            pf[nread].cdata = pf[nread].udata = NULL;
+            continue;
+        }
+        nread++;
+    }
+
+    if (nread == 0)
+        HGOTO_DONE(SUCCEED);
+
+    if (HTHpool_run(info->read_pool, HMCIinflate_chunk, pf, (int)nread) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* put the decoded chunks in the cache */
+    for (j = 0; j < nread; j++) {
+        void *chk_data = NULL;
+
+        if (!pf[j].ok)
+            continue;
+
+        if ((chk_data = mcache_get(info->chk_cache, pf[j].chunk_num + 1, MCACHE_NOREAD)) == NULL)
+            HE_REPORT_GOTO("failed to find chunk record", FAIL);
+
+        memcpy(chk_data, pf[j].udata, (size_t)page_size);
+
+        if (mcache_put(info->chk_cache, chk_data, 0) == FAIL)
+            HE_REPORT_GOTO("failed to put chunk back in cache", FAIL);
+    }
+
+done:
+    if (pf != NULL) {
+        for (i = 0; i < max_chunks; i++) {
+            free(pf[i].cdata);
+            free(pf[i].udata);
+        }
+        free(pf);
+    }
+    free(chunk_indices);
+    free(pos_chunk);
+
+    return ret_value;
+} /* HMCIprefetch() */
+
 /* ------------------------------- HMCPread --------------------------------
 NAME
    HMCPread - read data from a chunked element
@@ -2767,7 +3153,9 @@ DESCRIPTION
    Read in some data from a chunked element.
 
    Data is obtained from the cache which takes care of reading
-   in the proper chunks to satisfy the request.
+   in the proper chunks to satisfy the request.  With read threads
+   (see HMCsetreadthreads()) the missing chunks are decoded ahead
+   by HMCIprefetch().
 
 RETURNS
    The number of bytes read or FAIL on error
@@ -2826,6 +3214,11 @@ HMCPread(accrec_t *access_rec, /* IN: access record to mess with */
         calculate_chunk_for_chunk(&chunk_size, info->ndims, info->nt_size, read_len, bytes_read,
                                   info->seek_chunk_indices, info->seek_pos_chunk, info->ddims);
 
+        /* decode this chunk and the next ones on the read threads */
+        if (info->read_pool != NULL && !mcache_incache(info->chk_cache, chunk_num + 1))
+            if (HMCIprefetch(access_rec, relative_posn, read_len - bytes_read) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
         /* would be nice to get Chunk record from TBBT based on chunk number
            and then get chunk data base on chunk vdata number but
            currently the chunk calculations return chunk
@@ -2881,6 +3274,64 @@ done:
     return ret_value;
 } /* HMCPread  */
 
+/* -------------------------------- HMCInew_chunk --------------------------------
+NAME
+   HMCInew_chunk -- add a chunk to the chunk table
+
+DESCRIPTION
+   Gives a chunk that is not in the file yet its tag/ref and adds its
+   record to the chunk table.  The chunk element itself is written by
+   the caller.
+
+RETURNS
+   SUCCEED/FAIL
+---------------------------------------------------------------------------*/
+static int
+HMCInew_chunk(accrec_t  *access_rec, /* IN: access record to mess with */
+              CHUNK_REC *chkptr /* IN/OUT: chunk record in TBBT */)
+{
+    chunkinfo_t *info      = (chunkinfo_t *)(access_rec->special_info);
+    uint8       *v_data    = NULL; /* chunk table record i.e Vdata record */
+    uint8       *pntr      = NULL;
+    int          ret_value = SUCCEED;
+    int          k; /* loop index */
+
+    /* Allocate space for a single Chunk record in Vdata */
+    if ((v_data = malloc(((size_t)info->ndims * sizeof(int32)) + (2 * sizeof(uint16)))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* Initialize chunk record */
+    chkptr->chk_tag = DFTAG_CHUNK;
+    chkptr->chk_ref = Htagnewref(access_rec->file_id, DFTAG_CHUNK);
+
+    if (chkptr->chk_ref == 0) {
+        /* out of ref numbers -- extremely fatal  */
+        HGOTO_ERROR(DFE_NOREF, FAIL);
+    }
+    /* Copy origin first to vdata record*/
+    pntr = v_data;
+    for (k = 0; k < info->ndims; k++) {
+        memcpy(pntr, &chkptr->origin[k], sizeof(int32));
+        pntr += sizeof(int32);
+    }
+
+    /* Copy tag next */
+    memcpy(pntr, &chkptr->chk_tag, sizeof(uint16));
+    pntr += sizeof(uint16);
+
+    /* Copy ref last */
+    memcpy(pntr, &chkptr->chk_ref, sizeof(uint16));
+
+    /* Add to Vdata i.e. chunk table */
+    if (VSwrite(info->aid, v_data, 1, FULL_INTERLACE) == FAIL)
+        HGOTO_ERROR(DFE_VSWRITE, FAIL);
+
+done:
+    free(v_data);
+
+    return ret_value;
+} /* HMCInew_chunk() */
+
 /* ------------------------------- HMCPchunkwrite -------------------------------
 NAME
    HMCPchunkwrite -- write out chunk
@@ -2905,14 +3356,11 @@ HMCPchunkwrite(void       *cookie,    /* IN: access record to mess with */
     chunkinfo_t *info          = NULL;               /* chunked element information record */
     CHUNK_REC   *chk_rec       = NULL;               /* current chunk */
     TBBT_NODE   *entry         = NULL;               /* node off of  chunk tree */
-    uint8       *v_data        = NULL;               /* chunk table record i.e Vdata record */
-    CHUNK_REC   *chkptr        = NULL;               /* Chunk record to inserted in TBBT  */
     const void  *bptr          = NULL;               /* data buffer pointer */
     int32        chk_id        = FAIL;               /* chunkd access id */
     int32        bytes_written = 0;                  /* total #bytes written by HMCIwrite */
     int32        write_len     = 0;                  /* nbytes to write next */
     int32        ret_value     = SUCCEED;
-    int          k; /* loop index */
 
     /* Check args */
     if (access_rec == NULL)
@@ -2932,41 +3380,9 @@ HMCPchunkwrite(void       *cookie,    /* IN: access record to mess with */
 
     /* Check to see if already created in chunk table */
     if (chk_rec->chk_tag == DFTAG_NULL) { /* does not exists in Vdata table and in file but does in TBBT */
-        uint8 *pntr = NULL;
-
-        chkptr = chk_rec;
         /* so create a new Vdata record */
-        /* Allocate space for a single Chunk record in Vdata */
-        if (v_data == NULL) {
-            if ((v_data = malloc(((size_t)info->ndims * sizeof(int32)) + (2 * sizeof(uint16)))) == NULL)
-                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-        }
-
-        /* Initialize chunk record */
-        chkptr->chk_tag = DFTAG_CHUNK;
-        chkptr->chk_ref = Htagnewref(access_rec->file_id, DFTAG_CHUNK);
-
-        if (chkptr->chk_ref == 0) {
-            /* out of ref numbers -- extremely fatal  */
-            HGOTO_ERROR(DFE_NOREF, FAIL);
-        }
-        /* Copy origin first to vdata record*/
-        pntr = v_data;
-        for (k = 0; k < info->ndims; k++) {
-            memcpy(pntr, &chkptr->origin[k], sizeof(int32));
-            pntr += sizeof(int32);
-        }
-
-        /* Copy tag next */
-        memcpy(pntr, &chkptr->chk_tag, sizeof(uint16));
-        pntr += sizeof(uint16);
-
-        /* Copy ref last */
-        memcpy(pntr, &chkptr->chk_ref, sizeof(uint16));
-
-        /* Add to Vdata i.e. chunk table */
-        if (VSwrite(info->aid, v_data, 1, FULL_INTERLACE) == FAIL)
-            HGOTO_ERROR(DFE_VSWRITE, FAIL);
+        if (HMCInew_chunk(access_rec, chk_rec) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
         /* Create compressed chunk if set
            else start write access on element */
@@ -3010,11 +3426,133 @@ done:
             Hendaccess(chk_id);
     }
 
-    free(v_data);
-
     return ret_value;
 } /* HMCPchunkwrite() */
 
+/* ------------------------------ HMCIdeflate_chunk ------------------------------
+NAME
+   HMCIdeflate_chunk -- encode a chunk with deflate
+
+DESCRIPTION
+   Task run on the write threads by HMCPchunkwritev(): compresses the
+   chunk into 'cdata', as HCPcdeflate_write() would.  Only calls zlib.
+
+RETURNS
+   Nothing, sets 'ok' in the task
+---------------------------------------------------------------------------*/
+static void
+HMCIdeflate_chunk(void *arg, /* IN: array of tasks */
+                  int   task /* IN: task to run */)
+{
+    CHUNK_TASK *ct = (CHUNK_TASK *)arg + task;
+    z_stream    zs;
+
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit(&zs, ct->level) != Z_OK)
+        return;
+
+    zs.next_in   = ct->udata;
+    zs.avail_in  = (uInt)ct->ulen;
+    zs.next_out  = ct->cdata;
+    zs.avail_out = (uInt)ct->clen;
+    if (deflate(&zs, Z_FINISH) == Z_STREAM_END) {
+        ct->clen = (int32)zs.total_out;
+        ct->ok   = TRUE;
+    }
+    deflateEnd(&zs);
+} /* HMCIdeflate_chunk() */
+
+/* ------------------------------- HMCPchunkwritev -------------------------------
+NAME
+   HMCPchunkwritev -- write out several chunks
+
+DESCRIPTION
+   Write whole chunks of a chunked element compressed with deflate given
+   the chunk numbers.  The chunks are encoded on the write threads, then
+   written one after the other by the calling thread.  A chunk that could
+   not be encoded is written by HMCPchunkwrite().
+
+   This is used as the 'page-out-chunks' routine for the cache once
+   HMCsetwritethreads() is called.  Only the cache should call this routine.
+
+RETURNS
+   The number of bytes written or FAIL on error
+---------------------------------------------------------------------------*/
+static int32
+HMCPchunkwritev(void        *cookie,     /* IN: access record to mess with */
+                int32        nchunks,    /* IN: number of chunks */
+                const int32 *chunk_nums, /* IN: chunk numbers */
+                void       **datap /* IN: buffers for data */)
+{
+    accrec_t    *access_rec    = (accrec_t *)cookie; /* access record */
+    chunkinfo_t *info          = NULL;               /* chunked element information record */
+    CHUNK_TASK  *ct            = NULL;               /* chunks to encode */
+    int32        chunk_len     = 0;                  /* size of a chunk in bytes */
+    int32        bytes_written = 0;                  /* total #bytes written */
+    int32        i;
+    int32        ret_value = SUCCEED;
+
+    /* Check args */
+    if (access_rec == NULL || nchunks < 1 || chunk_nums == NULL || datap == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    info      = (chunkinfo_t *)(access_rec->special_info);
+    chunk_len = info->chunk_size * info->nt_size;
+
+    if ((ct = (CHUNK_TASK *)calloc((size_t)nchunks, sizeof(CHUNK_TASK))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < nchunks; i++) {
+        ct[i].chunk_num = chunk_nums[i];
+        ct[i].udata     = (uint8 *)datap[i];
+        ct[i].ulen      = chunk_len;
+        ct[i].level     = info->cinfo->deflate.level;
+        ct[i].clen      = (int32)compressBound((uLong)chunk_len);
+        if ((ct[i].cdata = (uint8 *)malloc((size_t)ct[i].clen)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    }
+
+    if (HTHpool_run(info->write_pool, HMCIdeflate_chunk, ct, (int)nchunks) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* write the chunks in order, the library is not safe to call from the threads */
+    for (i = 0; i < nchunks; i++) {
+        TBBT_NODE *entry   = NULL; /* node off of chunk tree */
+        CHUNK_REC *chk_rec = NULL; /* current chunk */
+
+        if (!ct[i].ok) {
+            if (HMCPchunkwrite(access_rec, ct[i].chunk_num, ct[i].udata) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+            bytes_written += chunk_len;
+            continue;
+        }
+
+        if ((entry = tbbtdfind(info->chk_tree, &ct[i].chunk_num, NULL)) == NULL)
+            HE_REPORT_GOTO("failed to find chunk record", FAIL);
+        chk_rec = (CHUNK_REC *)entry->data;
+
+        /* not in the chunk table yet */
+        if (chk_rec->chk_tag == DFTAG_NULL && HMCInew_chunk(access_rec, chk_rec) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+        if (HCPwrite_encoded(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, info->model_type,
+                             info->minfo, info->comp_type, info->cinfo, chunk_len, ct[i].cdata,
+                             ct[i].clen) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        bytes_written += chunk_len;
+    }
+
+    ret_value = bytes_written;
+
+done:
+    if (ct != NULL) {
+        for (i = 0; i < nchunks; i++)
+            free(ct[i].cdata);
+        free(ct);
+    }
+
+    return ret_value;
+} /* HMCPchunkwritev() */
+
 /* ------------------------------- HMCwriteChunk ---------------------------
 NAME
    HMCwriteChunk -- write out a whole chunk
@@ -3036,6 +3574,8 @@ HMCwriteChunk(int32       access_id, /* IN: access aid to mess with */
               int32      *origin,    /* IN: origin of chunk to write */
               const void *datap /* IN: buffer for data */)
 {
+    H4_API_ENTER;
+
     accrec_t    *access_rec = NULL;  /* access record */
     filerec_t   *file_rec   = NULL;  /* file record */
     chunkinfo_t *info       = NULL;  /* chunked element information record */
@@ -3185,6 +3725,281 @@ done:
     return ret_value;
 } /* HMCwriteChunk */
 
+/* ------------------------------ HMCIget_chunk_rec ------------------------------
+NAME
+   HMCIget_chunk_rec -- find or add the record of a chunk
+
+DESCRIPTION
+   Finds the record of the chunk at 'origin' in the TBBT, adding one that
+   is not in the chunk table yet if there is none, like HMCwriteChunk().
+
+RETURNS
+   SUCCEED/FAIL
+---------------------------------------------------------------------------*/
+static int
+HMCIget_chunk_rec(chunkinfo_t *info,      /* IN: chunked element information record */
+                  const int32 *origin,    /* IN: origin of the chunk */
+                  int32        chunk_num, /* IN: chunk number */
+                  CHUNK_REC  **chk_rec /* OUT: chunk record */)
+{
+    TBBT_NODE *entry     = NULL; /* node off of chunk tree */
+    CHUNK_REC *chkptr    = NULL; /* Chunk record to inserted in TBBT  */
+    int32     *chk_key   = NULL; /* Chunk record key for insertion in TBBT */
+    int        ret_value = SUCCEED;
+    int        k; /* loop index */
+
+    if ((entry = tbbtdfind(info->chk_tree, &chunk_num, NULL)) != NULL) {
+        *chk_rec = (CHUNK_REC *)entry->data;
+        HGOTO_DONE(SUCCEED);
+    }
+
+    /* Allocate space for a chunk record, its origin and its key */
+    if ((chkptr = (CHUNK_REC *)malloc(sizeof(CHUNK_REC))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((chkptr->origin = (int32 *)malloc((size_t)info->ndims * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((chk_key = (int32 *)malloc(sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* Initialize chunk record, not in the file yet */
+    chkptr->chk_tag = DFTAG_NULL;
+    chkptr->chk_ref = 0;
+    for (k = 0; k < info->ndims; k++)
+        chkptr->origin[k] = origin[k];
+
+    /* set chunk record number to next Vdata record number */
+    chkptr->chk_vnum = info->num_recs++;
+
+    /* add to TBBT tree based on chunk number as the key */
+    chkptr->chunk_number = *chk_key = chunk_num;
+    tbbtdins(info->chk_tree, chkptr, chk_key);
+
+    *chk_rec = chkptr;
+
+done:
+    if (ret_value == FAIL) { /* Error condition cleanup */
+        if (chkptr != NULL) {
+            free(chkptr->origin);
+            free(chkptr);
+        }
+        free(chk_key);
+    }
+
+    return ret_value;
+} /* HMCIget_chunk_rec() */
+
+/* ------------------------------ HMCreadChunkRaw ---------------------------
+NAME
+   HMCreadChunkRaw -- read a whole chunk as it is stored
+
+DESCRIPTION
+   Reads the chunk at 'origin' without decoding it: the compressed bytes
+   of a compressed chunk, the bytes of the chunk in the file's number
+   format otherwise.  'comp_type' and 'c_info', if not NULL, get the
+   compression of the chunk, COMP_CODE_NONE if it is not compressed.
+
+   A chunk that was changed in the chunk cache is written out first.  A
+   chunk that has never been written has no bytes, it reads as the fill
+   value, and gets the compression of the element.  With 'datap' NULL
+   only the size of the chunk is returned.
+
+RETURNS
+   The number of bytes of the chunk, 0 if it has never been written, or
+   FAIL on error, including a 'buf_size' too small for the chunk
+---------------------------------------------------------------------------*/
+int32
+HMCreadChunkRaw(int32         access_id, /* IN: access aid to mess with */
+                int32        *origin,    /* IN: origin of chunk to read */
+                comp_coder_t *comp_type, /* OUT: compression type of the chunk */
+                comp_info    *c_info,    /* OUT: compression info of the chunk */
+                int32         buf_size,  /* IN: size of 'datap' */
+                void         *datap /* OUT: buffer for the chunk as stored */)
+{
+    H4_API_ENTER;
+
+    accrec_t    *access_rec = NULL; /* access record */
+    filerec_t   *file_rec   = NULL; /* file record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    TBBT_NODE   *entry      = NULL; /* node off of chunk tree */
+    CHUNK_REC   *chk_rec    = NULL; /* chunk record */
+    comp_model_t model_type;        /* modeling type of the chunk */
+    comp_coder_t coder_type;        /* compression type of the chunk */
+    uint16       data_tag, data_ref; /* element holding the bytes of the chunk */
+    uint16       comp_ref = 0;       /* ref of the compressed data */
+    int32        orig_size;          /* size of the chunk once decoded */
+    int32        len       = 0;      /* bytes of the chunk */
+    int32        chunk_num = -1;     /* chunk number */
+    int32        ret_value = SUCCEED;
+    int          i;
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || origin == NULL || (datap != NULL && buf_size < 0))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* validate file records */
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* can read from this file? */
+    if (!(file_rec->access & DFACC_READ))
+        HGOTO_ERROR(DFE_DENIED, FAIL);
+
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if (access_rec->special != SPECIAL_CHUNKED)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    info = (chunkinfo_t *)(access_rec->special_info);
+
+    for (i = 0; i < info->ndims; i++)
+        if (origin[i] < 0 || origin[i] >= info->ddims[i].num_chunks)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+    calculate_chunk_num(&chunk_num, info->ndims, origin, info->ddims);
+
+    /* the copy in the file must be up to date */
+    if (mcache_incache(info->chk_cache, chunk_num + 1) && mcache_sync(info->chk_cache) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+    /* a chunk that was never written has the compression of the element */
+    coder_type = COMP_CODE_NONE;
+    if ((info->flag & 0xff) == SPECIAL_COMP) {
+        coder_type = info->comp_type;
+        if (c_info != NULL)
+            memcpy(c_info, info->cinfo, sizeof(comp_info));
+    }
+
+    if ((entry = tbbtdfind(info->chk_tree, &chunk_num, NULL)) != NULL)
+        chk_rec = (CHUNK_REC *)entry->data;
+
+    /* written chunk, find the bytes to read */
+    if (chk_rec != NULL && chk_rec->chk_tag != DFTAG_NULL) {
+        if (HCPgetcompref(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, &model_type, &coder_type,
+                          &comp_ref, &orig_size) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+        if (comp_ref != 0) { /* compressed, the bytes are in their own element */
+            data_tag = DFTAG_COMPRESSED;
+            data_ref = comp_ref;
+            if (c_info != NULL && HCPgetcompinfo(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref,
+                                                 &coder_type, c_info) == FAIL)
+                HGOTO_ERROR(DFE_COMPINFO, FAIL);
+        }
+        else {
+            data_tag = chk_rec->chk_tag;
+            data_ref = chk_rec->chk_ref;
+        }
+
+        if ((len = Hlength(access_rec->file_id, data_tag, data_ref)) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+        if (datap != NULL) {
+            if (len > buf_size)
+                HGOTO_ERROR(DFE_ARGS, FAIL);
+            if (Hgetelement(access_rec->file_id, data_tag, data_ref, datap) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+        }
+    }
+
+    if (comp_type != NULL)
+        *comp_type = coder_type;
+
+    ret_value = len;
+
+done:
+    return ret_value;
+} /* HMCreadChunkRaw() */
+
+/* ------------------------------ HMCwriteChunkRaw ---------------------------
+NAME
+   HMCwriteChunkRaw -- write a whole chunk that is already encoded
+
+DESCRIPTION
+   Writes the chunk at 'origin' from bytes encoded as the element stores
+   its chunks, such as those read by HMCreadChunkRaw() from an element
+   with the same chunk sizes, number type and compression.  'comp_type'
+   must be the compression type of the element, COMP_CODE_NONE if it is
+   not compressed, in which case 'len' must be the size of a chunk.  The
+   bytes are not checked otherwise.
+
+   The chunk replaces any copy of it in the file or in the chunk cache.
+
+RETURNS
+   SUCCEED/FAIL
+---------------------------------------------------------------------------*/
+int
+HMCwriteChunkRaw(int32        access_id, /* IN: access aid to mess with */
+                 int32       *origin,    /* IN: origin of chunk to write */
+                 comp_coder_t comp_type, /* IN: compression type of the data */
+                 int32        len,       /* IN: size of the data */
+                 const void  *datap /* IN: chunk as stored */)
+{
+    H4_API_ENTER;
+
+    accrec_t    *access_rec = NULL; /* access record */
+    filerec_t   *file_rec   = NULL; /* file record */
+    chunkinfo_t *info       = NULL; /* chunked element information record */
+    CHUNK_REC   *chk_rec    = NULL; /* chunk record */
+    int          compressed;        /* whether the element is compressed */
+    int32        chunk_len;         /* size of a chunk in bytes */
+    int32        chunk_num = -1;    /* chunk number */
+    int          ret_value = SUCCEED;
+    int          i;
+
+    /* Check args */
+    access_rec = HAatom_object(access_id);
+    if (access_rec == NULL || origin == NULL || datap == NULL || len <= 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* validate file records */
+    file_rec = HAatom_object(access_rec->file_id);
+    if (BADFREC(file_rec))
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* can write in this file? */
+    if (!(file_rec->access & DFACC_WRITE))
+        HGOTO_ERROR(DFE_DENIED, FAIL);
+
+    /* since this routine can be called by the user,
+       need to check if this access id is special CHUNKED */
+    if (access_rec->special != SPECIAL_CHUNKED)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    info      = (chunkinfo_t *)(access_rec->special_info);
+    chunk_len = info->chunk_size * info->nt_size;
+
+    /* the bytes must be encoded as the element stores its chunks */
+    compressed = (info->flag & 0xff) == SPECIAL_COMP;
+    if (comp_type != (compressed ? info->comp_type : COMP_CODE_NONE))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (!compressed && len != chunk_len)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    for (i = 0; i < info->ndims; i++)
+        if (origin[i] < 0 || origin[i] >= info->ddims[i].num_chunks)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+    calculate_chunk_num(&chunk_num, info->ndims, origin, info->ddims);
+
+    /* what the cache holds is replaced */
+    if (mcache_discard(info->chk_cache, chunk_num + 1) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    if (HMCIget_chunk_rec(info, origin, chunk_num, &chk_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (chk_rec->chk_tag == DFTAG_NULL && HMCInew_chunk(access_rec, chk_rec) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    if (compressed) {
+        if (HCPwrite_encoded(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, info->model_type,
+                             info->minfo, info->comp_type, info->cinfo, chunk_len, datap, len) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    }
+    else if (Hputelement(access_rec->file_id, chk_rec->chk_tag, chk_rec->chk_ref, datap, len) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+done:
+    return ret_value;
+} /* HMCwriteChunkRaw() */
+
 /* ------------------------------- HMCPwrite -------------------------------
 NAME
    HMCPwrite -- write out some data to a chunked element
@@ -3428,6 +4243,8 @@ HMCPcloseAID(accrec_t *access_rec /* IN:  access record of file to close */)
         free(info->comp_sp_tag_header);
         free(info->cinfo);
         free(info->minfo);
+        HTHpool_destroy(info->read_pool);
+        HTHpool_destroy(info->write_pool);
 
         free(info);
         access_rec->special_info = NULL;
@@ -94,6 +94,12 @@ HDFLIBAPI int32 HMCsetMaxcache(int32 access_id, /* IN: access aid to mess with *
                                int32 maxcache,  /* IN: max number of pages to cache */
                                int32 flags /* IN: flags = 0, HMC_PAGEALL */);
 
+HDFLIBAPI int HMCsetreadthreads(int32 access_id, /* IN: access aid to mess with */
+                                int   nthreads /* IN: number of threads, 0 or 1 for none */);
+
+HDFLIBAPI int HMCsetwritethreads(int32 access_id, /* IN: access aid to mess with */
+                                 int   nthreads /* IN: number of threads, 0 or 1 for none */);
+
 HDFLIBAPI int32 HMCwriteChunk(int32       access_id, /* IN: access aid to mess with */
                               int32      *origin,    /* IN: origin of chunk to write */
                               const void *datap /* IN: buffer for data */);
@@ -102,6 +108,19 @@ HDFLIBAPI int32 HMCreadChunk(int32  access_id, /* IN: access aid to mess with */
                              int32 *origin,    /* IN: origin of chunk to read */
                              void  *datap /* IN: buffer for data */);
 
+HDFLIBAPI int32 HMCreadChunkRaw(int32         access_id, /* IN: access aid to mess with */
+                                int32        *origin,    /* IN: origin of chunk to read */
+                                comp_coder_t *comp_type, /* OUT: compression type of the chunk */
+                                comp_info    *c_info,    /* OUT: compression info of the chunk */
+                                int32         buf_size,  /* IN: size of 'datap' */
+                                void         *datap /* OUT: buffer for the chunk as stored */);
+
+HDFLIBAPI int HMCwriteChunkRaw(int32        access_id, /* IN: access aid to mess with */
+                               int32       *origin,    /* IN: origin of chunk to write */
+                               comp_coder_t comp_type, /* IN: compression type of the data */
+                               int32        len,       /* IN: size of the data */
+                               const void  *datap /* IN: chunk as stored */);
+
 HDFLIBAPI int32 HMCPcloseAID(accrec_t *access_rec /* IN:  access record of file to close */);
 
 HDFLIBAPI int32 HMCPgetnumrecs /* has to be here because used in hfile.c */
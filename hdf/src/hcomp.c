@@ -647,6 +647,8 @@ int32
 HCcreate(int32 file_id, uint16 tag, uint16 ref, comp_model_t model_type, model_info *m_info,
          comp_coder_t coder_type, comp_info *c_info)
 {
+    H4_API_ENTER;
+
     filerec_t  *file_rec;          /* file record */
     accrec_t   *access_rec = NULL; /* access element record */
     compinfo_t *info       = NULL; /* special element information */
@@ -1304,6 +1306,7 @@ int
 HCget_config_info(comp_coder_t coder_type, /* IN: compression type */
                   uint32      *compression_config_info)
 {
+    H4_API_ENTER;
 
     *compression_config_info = 0;
 
@@ -1585,3 +1588,162 @@ done:
 
     return ret_value;
 } /* HCPgetdatasize */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPgetcompref -- Locate the compressed data of an element
+ USAGE
+    int HCPgetcompref(file_id, data_tag, data_ref, model_type, coder_type, comp_ref, orig_size)
+        int32 file_id;              IN: file id
+        uint16 data_tag;            IN: tag of the element
+        uint16 data_ref;            IN: ref of element
+        comp_model_t *model_type;   OUT: modeling type
+        comp_coder_t *coder_type;   OUT: compression type
+        uint16 *comp_ref;           OUT: ref# of the compressed data
+        int32 *orig_size;           OUT: size of non-compressed data
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Decodes the special info header of a compressed element, so that its
+    compressed bytes can be read as they are stored, with Hgetelement on
+    (DFTAG_COMPRESSED, comp_ref), and decoded by the caller.  comp_ref is 0
+    if no data has been written.  Elements that are not compressed are
+    reported with COMP_CODE_NONE.
+--------------------------------------------------------------------------*/
+int
+HCPgetcompref(int32 file_id, uint16 data_tag, uint16 data_ref, /* IN: tag/ref of element */
+              comp_model_t *model_type,                        /* OUT: modeling type */
+              comp_coder_t *coder_type,                        /* OUT: compression type */
+              uint16       *comp_ref,                          /* OUT: ref# of compressed data */
+              int32        *orig_size)                         /* OUT: size of non-compressed data */
+{
+    uint8     *local_ptbuf = NULL, *p;
+    uint16     sp_tag;          /* special tag */
+    uint16     header_version;  /* version of the compression header */
+    atom_t     data_id = FAIL;  /* dd ID of the element */
+    model_info m_info;          /* modeling information - dummy */
+    comp_info  c_info;          /* compression information - dummy */
+    filerec_t *file_rec;        /* file record */
+    int        ret_value = SUCCEED;
+
+    /* convert file id to file rec and check for validity */
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec) || model_type == NULL || coder_type == NULL || comp_ref == NULL ||
+        orig_size == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    *model_type = COMP_MODEL_STDIO;
+    *coder_type = COMP_CODE_NONE;
+    *comp_ref   = 0;
+    *orig_size  = 0;
+
+    /* get access element from tag/ref */
+    if ((data_id = HTPselect(file_rec, data_tag, data_ref)) == FAIL)
+        HGOTO_ERROR(DFE_CANTACCESS, FAIL);
+
+    /* only a special element can be compressed */
+    if (HTPis_special(data_id) == TRUE) {
+        if (HPread_drec(file_id, data_id, &local_ptbuf) <= 0)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+        p = local_ptbuf;
+        UINT16DECODE(p, sp_tag);
+        if (sp_tag == SPECIAL_COMP) {
+            UINT16DECODE(p, header_version);
+            INT32DECODE(p, *orig_size);
+            UINT16DECODE(p, *comp_ref);
+            (void)header_version;
+
+            if (HCPdecode_header(p, model_type, &m_info, coder_type, &c_info) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        }
+    }
+
+done:
+    if (data_id != FAIL)
+        if (HTPendaccess(data_id) == FAIL)
+            HERROR(DFE_CANTENDACCESS);
+    free(local_ptbuf);
+
+    return ret_value;
+} /* HCPgetcompref */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HCPwrite_encoded -- Store data that is already compressed
+ USAGE
+    int HCPwrite_encoded(file_id, tag, ref, model_type, m_info, coder_type, c_info,
+                         length, data, data_len)
+        int32 file_id;              IN: file id
+        uint16 tag, ref;            IN: tag/ref of the element
+        comp_model_t model_type;    IN: modeling type the data was encoded with
+        model_info *m_info;         IN: modeling information
+        comp_coder_t coder_type;    IN: compression type the data was encoded with
+        comp_info *c_info;          IN: compression information
+        int32 length;               IN: size of the data once decoded
+        const void *data;           IN: encoded data
+        int32 data_len;             IN: size of the encoded data
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Writes a compressed element made of 'data', which must be exactly what
+    HCcreate followed by a single Hwrite of the decoded data would store:
+    the encoded data goes into its own DFTAG_COMPRESSED element, and the
+    special info header describes it.  This lets the encoding be done
+    elsewhere, such as on another thread.  An element that already has
+    that tag/ref is replaced.
+--------------------------------------------------------------------------*/
+int
+HCPwrite_encoded(int32 file_id, uint16 tag, uint16 ref, comp_model_t model_type, model_info *m_info,
+                 comp_coder_t coder_type, comp_info *c_info, int32 length, const void *data, int32 data_len)
+{
+    filerec_t *file_rec;       /* file record */
+    compinfo_t info;           /* fields of the special info header */
+    atom_t     data_id = FAIL; /* dd ID of an existing element */
+    uint16     special_tag;    /* special version of tag */
+    int        ret_value = SUCCEED;
+
+    /* validate args */
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec) || SPECIALTAG(tag) || (special_tag = MKSPECIALTAG(tag)) == DFTAG_NULL ||
+        length < 0 || data == NULL || data_len <= 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* check for access permission */
+    if (!(file_rec->access & DFACC_WRITE))
+        HGOTO_ERROR(DFE_DENIED, FAIL);
+
+    /* replace an existing element, along with its compressed data */
+    if ((data_id = HTPselect(file_rec, tag, ref)) != FAIL) {
+        comp_model_t old_model;
+        comp_coder_t old_coder;
+        uint16       old_ref;
+        int32        old_len;
+
+        if (HTPendaccess(data_id) == FAIL)
+            HGOTO_ERROR(DFE_CANTENDACCESS, FAIL);
+        if (HCPgetcompref(file_id, tag, ref, &old_model, &old_coder, &old_ref, &old_len) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        if (old_ref != 0 && Hdeldd(file_id, DFTAG_COMPRESSED, old_ref) == FAIL)
+            HGOTO_ERROR(DFE_CANTDELDD, FAIL);
+        if (Hdeldd(file_id, tag, ref) == FAIL)
+            HGOTO_ERROR(DFE_CANTDELDD, FAIL);
+    }
+
+    /* the encoded data */
+    info.length           = length;
+    info.comp_ref         = Htagnewref(file_id, DFTAG_COMPRESSED);
+    info.minfo.model_type = model_type;
+    info.cinfo.coder_type = coder_type;
+    if (info.comp_ref == 0)
+        HGOTO_ERROR(DFE_NOREF, FAIL);
+    if (Hputelement(file_id, DFTAG_COMPRESSED, info.comp_ref, data, data_len) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+    /* and the header pointing to it */
+    if (HCIwrite_header(file_id, &info, special_tag, ref, c_info, m_info) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+done:
+    return ret_value;
+} /* HCPwrite_encoded */
@@ -105,6 +105,8 @@ int
 HDgetdatainfo(int32 file_id, uint16 tag, uint16 ref, int32 *chk_coord, unsigned start_block,
               unsigned info_count, int32 *offsetarray, int32 *lengtharray)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec;                            /* file record */
     uint16     sp_tag;                              /* special tag */
     uint16     comp_ref = 0;                        /* ref for compressed data or comp header */
@@ -341,6 +343,8 @@ done:
 int
 VSgetdatainfo(int32 vsid, unsigned start_block, unsigned info_count, int32 *offsetarray, int32 *lengtharray)
 {
+    H4_API_ENTER;
+
     vsinstance_t *vs_inst = NULL;
     VDATA        *vs      = NULL;
     accrec_t     *access_rec;
@@ -371,6 +375,10 @@ VSgetdatainfo(int32 vsid, unsigned start_block, unsigned info_count, int32 *offs
     if (vs == NULL)
         HGOTO_ERROR(DFE_BADPTR, FAIL);
 
+    /* The records appended last may still be in the buffer of the vdata */
+    if (VSPflush(vs) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
     /* Get access record of the vdata */
     access_rec = HAatom_object(vs->aid);
     if (access_rec == (accrec_t *)NULL)
@@ -463,6 +471,8 @@ done:
 int
 Vgetattdatainfo(int32 vgid, int attrindex, int32 *offset, int32 *length)
 {
+    H4_API_ENTER;
+
     VGROUP       *vg;
     vg_attr_t    *vg_alist;
     vginstance_t *vg_inst;
@@ -562,6 +572,8 @@ done:
 int
 VSgetattdatainfo(int32 vsid, int32 findex, int attrindex, int32 *offset, int32 *length)
 {
+    H4_API_ENTER;
+
     VDATA        *vs;
     vs_attr_t    *vs_alist;
     vsinstance_t *vs_inst;
@@ -667,6 +679,8 @@ done:
 int
 GRgetattdatainfo(int32 id, int32 attrindex, int32 *offset, int32 *length)
 {
+    H4_API_ENTER;
+
     int32      hdf_file_id;         /* file id */
     int32      attr_vsid;           /* id of vdata that stores the attribute */
     group_t    id_group = BADGROUP; /* temporary group of id */
@@ -791,6 +805,8 @@ TODO
 int
 GRgetdatainfo(int32 riid, unsigned start_block, unsigned info_count, int32 *offsetarray, int32 *lengtharray)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr;      /* ptr to the image to work with */
     int32      hdf_file_id; /* short cut for file id */
     int32      length = 0;
@@ -890,6 +906,8 @@ DESCRIPTION
 int
 GRgetpalinfo(int32 gr_id, unsigned pal_count, hdf_ddinfo_t *palinfo_array)
 {
+    H4_API_ENTER;
+
     gr_info_t *gr_ptr;
     int32      file_id;
     int32      aid = FAIL;
@@ -997,6 +1015,8 @@ ANgetdatainfo(int32  ann_id, /* IN: annotation id */
               int32 *offset, /* OUT: buffer for offset */
               int32 *length) /* OUT: buffer for length */
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec = NULL; /* file record pointer */
     ANnode    *ann_node = NULL;
     int32      file_id  = FAIL;
@@ -104,6 +104,9 @@ typedef enum {
                               /* location in the DD list (useful for continued */
                               /* searching ala findfirst/findnext) */
 
+/* Hopen only: map the whole file into memory, for read-only access */
+#define DFACC_MMAP 0x40
+
 /* External Element File access mode */
 /* #define DFACC_CREATE 4	is for creating new external element file */
 #define DFACC_OLD 1 /* for accessing existing ext. element file */
@@ -177,6 +180,9 @@ typedef int32 HFILEID;
 
 typedef int (*hdf_termfunc_t)(void); /* termination function typedef */
 
+/* completion callback of the asynchronous reads */
+typedef void (*hdf_asyncfunc_t)(int32 id, int status, void *ctx);
+
 /* .................................................................. */
 
 /* API adapter header (defines HDFPUBLIC, etc.) */
@@ -21,13 +21,17 @@
 /* I/O library constants */
 #define UNIXUNBUFIO 1
 #define UNIXBUFIO   2
+#define UNIXPOSIO   3
 
-/* The library always uses UNIXBUFIO */
-#define FILELIB UNIXBUFIO
+/* The library uses UNIXPOSIO where pread()/pwrite() are available and
+ * UNIXBUFIO everywhere else. The choice is made in hfile_priv.h, since
+ * it depends on h4config.h, which is pulled in by hdf.h below.
+ */
 
 /* Common library headers */
 #include "hdf.h"
 #include "herr_priv.h"
+#include "hts_priv.h"
 
 /*--------------------------------------------------------------------------*/
 /*                              MT/NT constants                             */
@@ -99,6 +103,9 @@
 #ifdef H4_HAVE_SYS_TIME_H
 #include <sys/time.h>
 #endif
+#ifdef H4_HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 
 /* MSDN docs say that sys/types.h has to come before sys/stat */
 #ifdef H4_HAVE_SYS_TYPES_H
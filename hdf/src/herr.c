@@ -24,6 +24,7 @@ EXPORTED ROUTINES
   HEreport -- give a more detailed error description
   HEprint  -- print values from the error stack
   HEvalue  -- return a error off of the error stack
+  HEPkeep  -- keep the error stack through calls that clear it
  */
 
 #include "hdf_priv.h"
@@ -33,8 +34,12 @@ EXPORTED ROUTINES
  */
 #include <stdarg.h>
 
-/* always points to the next available slot; the last error record is in slot (top-1) */
-static int32 error_top = 0;
+/* always points to the next available slot; the last error record is in slot (top-1).
+   In a thread-safe build each thread has its own stack. */
+static H4_THREAD_LOCAL int32 error_top = 0;
+
+/* While positive, HEclear() leaves the stack alone (see HEPkeep) */
+static H4_THREAD_LOCAL int error_keep = 0;
 
 /* We use a stack to hold the errors plus we keep track of the function,
    file and line where the error occurs. */
@@ -238,7 +243,7 @@ static const struct error_messages_t error_messages[] = {
 };
 
 /* pointer to the structure to hold error messages */
-static error_t *error_stack = NULL;
+static H4_THREAD_LOCAL error_t *error_stack = NULL;
 
 #ifndef DEFAULT_MESG
 #define DEFAULT_MESG "Unknown error"
@@ -291,7 +296,7 @@ DESCRIPTION
 void
 HEclear(void)
 {
-    if (!error_top)
+    if (!error_top || error_keep > 0)
         goto done;
 
     /* error_top == 0 means no error in stack */
@@ -305,6 +310,26 @@ done:
     return;
 } /* HEclear */
 
+/*--------------------------------------------------------------------------
+NAME
+   HEPkeep -- keep the error stack through calls that clear it
+USAGE
+   void HEPkeep(keep)
+   int keep;                IN: TRUE to start keeping it, FALSE to stop
+RETURNS
+   NONE
+DESCRIPTION
+   Between HEPkeep(TRUE) and HEPkeep(FALSE), HEclear() does nothing, so
+   that the public routines called while cleaning up after an error do
+   not remove it; the errors they report are pushed on top.  Calls may
+   nest.
+---------------------------------------------------------------------------*/
+void
+HEPkeep(int keep)
+{
+    error_keep += keep ? 1 : -1;
+} /* HEPkeep */
+
 /*-------------------------------------------------------------------------
 NAME
    HEpush -- push an error onto the stack
@@ -339,6 +364,7 @@ HEpush(hdf_err_code_t error_code, const char *function_name, const char *file_na
         }
         for (i = 0; i < ERR_STACK_SZ; i++)
             error_stack[i].desc = NULL;
+        H4_FREE_AT_THREAD_EXIT(&error_stack);
     }
 
     /* if stack is full, discard error */
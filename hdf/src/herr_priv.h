@@ -122,4 +122,14 @@
         goto done;                                                                                           \
     } while (0)
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+HDFLIBAPI void HEPkeep(int keep);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* H4_HERR_PRIV_H */
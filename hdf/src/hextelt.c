@@ -99,6 +99,9 @@ static char *HDFEXTCREATEDIR = NULL;
 static char *extdir          = NULL;
 static char *HDFEXTDIR       = NULL;
 static int   extdir_changed  = FALSE;
+#ifdef H4_HAVE_THREADSAFE
+static pthread_mutex_t extenv_lock = PTHREAD_MUTEX_INITIALIZER; /* first reading of the environment */
+#endif
 
 /* extinfo_t -- external elt information structure */
 
@@ -177,6 +180,8 @@ MODIFICATION
 int32
 HXcreate(int32 file_id, uint16 tag, uint16 ref, const char *extern_file_name, int32 offset, int32 start_len)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec;                       /* file record */
     accrec_t  *access_rec = NULL;              /* access element record */
     int32      dd_aid;                         /* AID for writing the special info */
@@ -1085,6 +1090,8 @@ FORTRAN
 int
 HXsetcreatedir(const char *dir)
 {
+    H4_API_ENTER;
+
     char *pt;
     int   ret_value = SUCCEED;
 
@@ -1126,6 +1133,8 @@ FORTRAN
 int
 HXsetdir(const char *newdir)
 {
+    H4_API_ENTER;
+
     char *pt        = NULL;
     int   ret_value = SUCCEED;
 
@@ -1192,11 +1201,13 @@ HXIbuildfilename(const char *ext_fname, const int acc_mode)
     char       *ret_value = NULL; /* FAIL */
 
     /* initialize HDFEXTDIR and HDFCREATEDIR if invoked the first time */
+    H4_MUTEX_LOCK(&extenv_lock);
     if (firstinvoked) {
         firstinvoked    = 0;
         HDFEXTCREATEDIR = getenv("HDFEXTCREATEDIR");
         HDFEXTDIR       = getenv("HDFEXTDIR");
     }
+    H4_MUTEX_UNLOCK(&extenv_lock);
 
     if (!ext_fname)
         HGOTO_ERROR(DFE_ARGS, NULL);
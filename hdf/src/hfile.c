@@ -64,6 +64,8 @@
    Htrunc      -- truncate a dataset to a length
    Hsync       -- sync file with memory
    Hcache      -- set low-level caching for a file
+   Hsetnddshint -- set the expected number of DDs in files to be opened
+   Hsetchunkcachebudget -- limit the memory used by the chunk caches of a file
    HDvalidfid  -- check if a file ID is valid
    HDerr       --  Closes a file and return FAIL.
    Hsetacceesstype -- set the I/O access type (serial, parallel, ...)
@@ -99,6 +101,7 @@
 
    LOCAL ROUTINES
    HIextend_file   -- extend file to current length
+   HIendaccess     -- dispose of an access element
    HIget_function_table -- create special function table
    HIgetspinfo          -- return special info
    HIunlock             -- unlock a previously locked file record
@@ -115,12 +118,16 @@
 #include "hdf_priv.h"
 #include "hfile_priv.h"
 #include "hfile_atexit_priv.h"
+#include "hasync_priv.h"
 
 /*--------------------- Locally defined Globals -----------------------------*/
 
 /* The default state of the file DD caching */
 static int default_cache = TRUE;
 
+/* The expected number of DDs in a file being opened (0 for no hint) */
+static int32 default_ndds_hint = 0;
+
 /* Whether we've installed the library termination function yet for this interface */
 static int library_terminate = FALSE;
 
@@ -136,6 +143,9 @@ static int install_atexit = TRUE;
 
 /* Pointer to the access record node free list */
 static accrec_t *accrec_free_list = NULL;
+#ifdef H4_HAVE_THREADSAFE
+static pthread_mutex_t accrec_free_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 #ifdef DISKBLOCK_DEBUG
 const uint8 diskblock_header[4] = {0xde, 0xad, 0xbe, 0xef};
@@ -162,6 +172,7 @@ extern funclist_t comp_funcs;
 /* Functions for accessing chunked data elements.
    For definition of the chunked data element, see hchunk.c. */
 #include "hchunks_priv.h"
+#include "mcache_priv.h"
 
 /* Functions for accessing buffered data elements.
    For definition of the buffered data element, see hbuffer.c. */
@@ -207,6 +218,12 @@ static int HIcheckfileversion(int32 file_id);
 
 static int HIsync(filerec_t *file_rec);
 
+static int HIendaccess(int32 access_id);
+
+static void HIfile_mmap(filerec_t *file_rec);
+
+static void HIfile_munmap(filerec_t *file_rec);
+
 static int HIstart(void);
 
 /*--------------------------------------------------------------------------
@@ -216,7 +233,8 @@ USAGE
    int32 Hopen(path, access, ndds)
    char *path;             IN: Name of file to be opened.
    int access;             IN: DFACC_READ, DFACC_WRITE, DFACC_CREATE
-                                or any bitwise-or of the above.
+                                or any bitwise-or of the above,
+                                optionally with DFACC_MMAP.
    int16 ndds;             IN: Number of dds in a block if this
                                 file needs to be created.
 RETURNS
@@ -233,6 +251,12 @@ DESCRIPTION
    implied even if it is not set.  DFACC_CREATE implies
    DFACC_WRITE.
 
+   DFACC_MMAP may be or-ed with DFACC_READ to map the whole file
+   into memory and serve all reads from the mapping; it cannot be
+   combined with DFACC_WRITE or DFACC_CREATE.  It is a hint: if the
+   file cannot be mapped, or is already open, it is read normally.
+   Reopening the file for writing drops the mapping.
+
    If the file is already opened and access is DFACC_CREATE:
    error DFE_ALROPEN.
    If the file is already opened, the requested access contains
@@ -250,16 +274,27 @@ DESCRIPTION
 int32
 Hopen(const char *path, int acc_mode, int16 ndds)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec  = NULL; /* File record */
     int        vtag      = 0;    /* write version tag? */
     int32      fid       = FAIL; /* File ID */
+    int        use_mmap  = FALSE; /* map the file into memory? */
     int32      ret_value = SUCCEED;
 
     /* Clear errors and check args and all the boring stuff. */
     HEclear();
-    if (!path || ((acc_mode & DFACC_ALL) != acc_mode))
+    if (!path || ((acc_mode & (DFACC_ALL | DFACC_MMAP)) != acc_mode))
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    /* A mapping is read-only, so DFACC_MMAP only goes with DFACC_READ */
+    if (acc_mode & DFACC_MMAP) {
+        if (acc_mode & (DFACC_WRITE | DFACC_CREATE))
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        use_mmap = TRUE;
+        acc_mode &= ~DFACC_MMAP;
+    }
+
     /* Perform global, one-time initialization */
     if (library_terminate == FALSE)
         if (HIstart() == FAIL)
@@ -287,6 +322,9 @@ Hopen(const char *path, int acc_mode, int16 ndds)
             if (HIsync(file_rec) == FAIL)
                 HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
+            /* The file is about to change, so stop reading from the mapping */
+            HIfile_munmap(file_rec);
+
             f = (hdf_file_t)HI_OPEN(file_rec->path, acc_mode);
             if (OPENERR(f))
                 HGOTO_ERROR(DFE_DENIED, FAIL);
@@ -300,6 +338,7 @@ Hopen(const char *path, int acc_mode, int16 ndds)
             file_rec->file      = f;
             file_rec->f_cur_off = 0;
             file_rec->last_op   = H4_OP_UNKNOWN;
+            file_rec->access |= DFACC_WRITE;
         }
 
         /* There is now one more open to this file. */
@@ -332,8 +371,14 @@ Hopen(const char *path, int acc_mode, int16 ndds)
 
                 file_rec->f_cur_off = 0;
                 file_rec->last_op   = H4_OP_UNKNOWN;
+
+                /* Map the file if asked to; if that fails, plain reads are used */
+                if (use_mmap)
+                    HIfile_mmap(file_rec);
+
                 /* Read in all the relevant data descriptor records. */
-                if (HTPstart(file_rec) == FAIL) {
+                if (HTPstart(file_rec, H4_ATOMIC_LOAD(&default_ndds_hint)) == FAIL) {
+                    HIfile_munmap(file_rec);
                     HI_CLOSE(file_rec->file);
                     HGOTO_ERROR(DFE_BADOPEN, FAIL);
                 }
@@ -425,6 +470,8 @@ DESCRIPTION
 int
 Hclose(int32 file_id)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec; /* file record pointer */
     int        ret_value = SUCCEED;
 
@@ -456,6 +503,7 @@ Hclose(int32 file_id)
 
         /* otherwise, nothing should still be using this file, close it */
         /* ignore any close error */
+        HIfile_munmap(file_rec);
         HI_CLOSE(file_rec->file);
 
         if (HTPend(file_rec) == FAIL)
@@ -497,6 +545,8 @@ REVISION LOG
 int
 Hexist(int32 file_id, uint16 search_tag, uint16 search_ref)
 {
+    H4_API_ENTER;
+
     uint16 find_tag = 0, find_ref = 0;
     int32  find_offset, find_length;
     int    ret_value;
@@ -536,6 +586,8 @@ int
 Hinquire(int32 access_id, int32 *pfile_id, uint16 *ptag, uint16 *pref, int32 *plength, int32 *poffset,
          int32 *pposn, int16 *paccess, int16 *pspecial)
 {
+    H4_API_ENTER;
+
     accrec_t *access_rec; /* access record */
     int       ret_value = SUCCEED;
 
@@ -585,6 +637,8 @@ done:
 int
 Hfidinquire(int32 file_id, char **fname, int *faccess, int *attach)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec;
     int        ret_value = SUCCEED;
 
@@ -625,6 +679,8 @@ DESCRIPTION
 int32
 Hstartread(int32 file_id, uint16 tag, uint16 ref)
 {
+    H4_API_ENTER;
+
     int32 ret; /* AID to return */
     int32 ret_value = SUCCEED;
 
@@ -667,6 +723,8 @@ DF_END _not_ supported yet!
 int
 Hnextread(int32 access_id, uint16 tag, uint16 ref, int origin)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec;                 /* file record */
     accrec_t  *access_rec;               /* access record */
     uint16     new_tag = 0, new_ref = 0; /* new tag & ref to access */
@@ -795,6 +853,8 @@ DESCRIPTION
 int32
 Hstartwrite(int32 file_id, uint16 tag, uint16 ref, int32 length)
 {
+    H4_API_ENTER;
+
     accrec_t *access_rec; /* access record */
     int32     ret;        /* AID to return */
     int32     ret_value = SUCCEED;
@@ -841,6 +901,8 @@ DESCRIPTION
 int32
 Hstartaccess(int32 file_id, uint16 tag, uint16 ref, uint32 flags)
 {
+    H4_API_ENTER;
+
     int        ddnew      = FALSE;       /* is the dd a new one? */
     filerec_t *file_rec   = NULL;        /* file record */
     accrec_t  *access_rec = NULL;        /* access record */
@@ -983,6 +1045,8 @@ DESCRIPTION
 int
 Hsetlength(int32 aid, int32 length)
 {
+    H4_API_ENTER;
+
     accrec_t  *access_rec; /* access record */
     filerec_t *file_rec;   /* file record */
     int32      offset;     /* offset of this data element in file */
@@ -1035,6 +1099,8 @@ DESCRIPTION
 int
 Happendable(int32 aid)
 {
+    H4_API_ENTER;
+
     accrec_t *access_rec; /* access record */
     int       ret_value = SUCCEED;
 
@@ -1122,6 +1188,8 @@ DESCRIPTION
 int
 Hseek(int32 access_id, int32 offset, int origin)
 {
+    H4_API_ENTER;
+
     accrec_t  *access_rec;          /* access record */
     int        old_offset = offset; /* save for later potential use */
     filerec_t *file_rec;            /* file record */
@@ -1209,6 +1277,8 @@ DESCRIPTION
 int32
 Htell(int32 access_id)
 {
+    H4_API_ENTER;
+
     accrec_t *access_rec; /* access record */
     int32     ret_value = SUCCEED;
 
@@ -1246,6 +1316,8 @@ DESCRIPTION
 int32
 Hread(int32 access_id, int32 length, void *data)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec;   /* file record */
     accrec_t  *access_rec; /* access record */
     int32      data_len;   /* length of the data we are checking */
@@ -1281,17 +1353,13 @@ Hread(int32 access_id, int32 length, void *data)
     if (HTPinquire(access_rec->ddid, NULL, NULL, &data_off, &data_len) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-    /* seek to position to start reading and read in data */
-    if (HPseek(file_rec, access_rec->posn + data_off) == FAIL)
-        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-
     /* length == 0 means to read to end of element, */
     /* if read length exceeds length of elt, read till end of elt */
     if (length == 0 || length + access_rec->posn > data_len)
         length = data_len - access_rec->posn;
 
-    /* read in data */
-    if (HP_read(file_rec, data, length) == FAIL)
+    /* read in data from the current position in the element */
+    if (HPread_at(file_rec, access_rec->posn + data_off, data, length) == FAIL)
         HGOTO_ERROR(DFE_READERROR, FAIL);
 
     /* move the position of the access record */
@@ -1326,6 +1394,8 @@ DESCRIPTION
 int32
 Hwrite(int32 access_id, int32 length, const void *data)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec = NULL; /* file record */
     accrec_t  *access_rec;      /* access record */
     int32      data_len;        /* length of the data we are checking */
@@ -1391,16 +1461,13 @@ Hwrite(int32 access_id, int32 length, const void *data)
             HGOTO_ERROR(DFE_INTERNAL, FAIL);
     } /* end if */
 
-    /* seek and write data */
-    if (HPseek(file_rec, access_rec->posn + data_off) == FAIL)
-        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-
-    if (HP_write(file_rec, data, length) == FAIL)
+    /* write data at the current position in the element */
+    if (HPwrite_at(file_rec, access_rec->posn + data_off, data, length) == FAIL)
         HGOTO_ERROR(DFE_WRITEERROR, FAIL);
 
     /* update end of file pointer? */
-    if (file_rec->f_cur_off > file_rec->f_end_off)
-        file_rec->f_end_off = file_rec->f_cur_off;
+    if (access_rec->posn + data_off + length > file_rec->f_end_off)
+        file_rec->f_end_off = access_rec->posn + data_off + length;
 
     /* update position of access in elt */
     access_rec->posn += length;
@@ -1429,6 +1496,8 @@ DESCRIPTION
 int
 HDgetc(int32 access_id)
 {
+    H4_API_ENTER;
+
     uint8 c         = (uint8)FAIL; /* character read in */
     int   ret_value = SUCCEED;
 
@@ -1460,6 +1529,8 @@ DESCRIPTION
 int
 HDputc(uint8 c, int32 access_id)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     if (Hwrite(access_id, 1, &c) == FAIL)
@@ -1490,13 +1561,59 @@ DESCRIPTION
 --------------------------------------------------------------------------*/
 int
 Hendaccess(int32 access_id)
+{
+    H4_API_ENTER;
+
+    /* clear error stack */
+    HEclear();
+
+    return HIendaccess(access_id);
+} /* Hendaccess */
+
+/*--------------------------------------------------------------------------
+NAME
+   HPendaccess -- dispose of an access element, keeping the error stack
+USAGE
+   int HPendaccess(access_id)
+   int32 access_id;          IN: id of access element to dispose of
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Hendaccess without clearing the error stack, for the routines that
+   end an access while cleaning up after an error; the routines it calls
+   do not clear it either (see HEPkeep).
+--------------------------------------------------------------------------*/
+int
+HPendaccess(int32 access_id)
+{
+    int ret_value;
+
+    HEPkeep(TRUE);
+    ret_value = HIendaccess(access_id);
+    HEPkeep(FALSE);
+
+    return ret_value;
+} /* HPendaccess */
+
+/*--------------------------------------------------------------------------
+NAME
+   HIendaccess -- dispose of an access element
+USAGE
+   int HIendaccess(access_id)
+   int32 access_id;          IN: id of access element to dispose of
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   The work of Hendaccess and HPendaccess.
+--------------------------------------------------------------------------*/
+static int
+HIendaccess(int32 access_id)
 {
     filerec_t *file_rec;          /* file record */
     accrec_t  *access_rec = NULL; /* access record */
     int        ret_value  = SUCCEED;
 
-    /* clear error stack and check validity of access id */
-    HEclear();
+    /* check validity of access id */
     if ((access_rec = HAremove_atom(access_id)) == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
@@ -1525,7 +1642,7 @@ done:
     }
 
     return ret_value;
-} /* Hendaccess */
+} /* HIendaccess */
 
 /*--------------------------------------------------------------------------
 NAME
@@ -1548,6 +1665,8 @@ DESCRIPTION
 int32
 Hgetelement(int32 file_id, uint16 tag, uint16 ref, uint8 *data)
 {
+    H4_API_ENTER;
+
     int32 access_id = FAIL; /* access record id */
     int32 length;           /* length of this elt */
     int32 ret_value = SUCCEED;
@@ -1598,6 +1717,8 @@ DESCRIPTION
 int32
 Hputelement(int32 file_id, uint16 tag, uint16 ref, const uint8 *data, int32 length)
 {
+    H4_API_ENTER;
+
     int32 access_id = FAIL; /* access record id */
     int32 ret_value = SUCCEED;
 
@@ -1645,6 +1766,8 @@ DESCRIPTION
 int32
 Hlength(int32 file_id, uint16 tag, uint16 ref)
 {
+    H4_API_ENTER;
+
     int32 access_id;        /* access record id */
     int32 length    = FAIL; /* length of elt inquired */
     int32 ret_value = SUCCEED;
@@ -1695,6 +1818,8 @@ DESCRIPTION
 int32
 Hoffset(int32 file_id, uint16 tag, uint16 ref)
 {
+    H4_API_ENTER;
+
     int32 access_id;        /* access record id */
     int32 offset    = FAIL; /* offset of elt inquired */
     int32 ret_value = SUCCEED;
@@ -1737,6 +1862,8 @@ DESCRIPTION
 int
 Hishdf(const char *filename)
 {
+    H4_API_ENTER;
+
     int        ret;
     hdf_file_t fp;
     int        ret_value = TRUE;
@@ -1776,6 +1903,8 @@ DESCRIPTION
 int32
 Htrunc(int32 aid, int32 trunc_len)
 {
+    H4_API_ENTER;
+
     accrec_t *access_rec; /* access record */
     int32     data_len;   /* length of the data we are checking */
     int32     data_off;   /* offset of the data we are checking */
@@ -1874,6 +2003,8 @@ NOTE
 int
 Hsync(int32 file_id)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec; /* file record */
     int        ret_value = SUCCEED;
 
@@ -1907,6 +2038,8 @@ DESCRIPTION
 int
 Hcache(int32 file_id, int cache_on)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec; /* file record */
     int        ret_value = SUCCEED;
 
@@ -1932,6 +2065,84 @@ done:
     return ret_value;
 } /* Hcache */
 
+/*--------------------------------------------------------------------------
+NAME
+   Hsetnddshint -- set the expected number of DDs in files to be opened
+USAGE
+   int Hsetnddshint(ndds)
+           int32 ndds;              IN: expected number of DDs, 0 for none
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Tells Hopen (and SDstart, which calls it) roughly how many data
+   descriptors the existing files opened after this call contain, so
+   the in-memory index of the DD list can be sized for them up front
+   instead of growing while the DD blocks are read in.  The hint only
+   affects performance; files with more or fewer DDs open normally.
+   A value of 0 turns the hint off.
+--------------------------------------------------------------------------*/
+int
+Hsetnddshint(int32 ndds)
+{
+    H4_API_ENTER;
+
+    int ret_value = SUCCEED;
+
+    HEclear();
+    if (ndds < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    H4_ATOMIC_STORE(&default_ndds_hint, ndds);
+
+done:
+    return ret_value;
+} /* Hsetnddshint */
+
+/*--------------------------------------------------------------------------
+NAME
+   Hsetchunkcachebudget -- limit the memory used by the chunk caches of a file
+USAGE
+   int Hsetchunkcachebudget(file_id, bytes)
+           int32 file_id;           IN: id of file
+           int32 bytes;             IN: max bytes of cached chunks, 0 for no limit
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   The chunk caches of all the chunked elements of a file share one
+   least-recently-used list of chunks.  This call limits the number of
+   bytes held by all of them together.  When a cache needs room for a
+   chunk and the limit has been reached, the least recently used chunk
+   of any element of the file is written out (if modified) and dropped.
+   The number of chunks each element may cache (HMCsetMaxcache,
+   SDsetchunkcache) still applies within the budget.
+
+   Lowering the budget below what is currently cached drops chunks right
+   away.  The budget lasts until the file is closed for the last time.
+   A value of 0 removes the limit, which is the default.
+--------------------------------------------------------------------------*/
+int
+Hsetchunkcachebudget(int32 file_id, int32 bytes)
+{
+    H4_API_ENTER;
+
+    filerec_t *file_rec;
+    int        ret_value = SUCCEED;
+
+    HEclear();
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec) || bytes < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (file_rec->chunk_pool == NULL && (file_rec->chunk_pool = mcache_pool_create()) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    if (mcache_pool_set_budget(file_rec->chunk_pool, bytes) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+done:
+    return ret_value;
+} /* Hsetchunkcachebudget */
+
 /*--------------------------------------------------------------------------
 NAME
    HDvalidfid -- check if a file ID is valid
@@ -1947,6 +2158,8 @@ DESCRIPTION
 int
 HDvalidfid(int32 file_id)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec;
     int        ret_value = TRUE;
 
@@ -1987,6 +2200,8 @@ DESCRIPTION
 int
 Hsetaccesstype(int32 access_id, unsigned accesstype)
 {
+    H4_API_ENTER;
+
     accrec_t *access_rec; /* access record */
     int       ret_value = SUCCEED;
 
@@ -2146,6 +2361,9 @@ done:
 void
 HPend(void)
 {
+    /* Finish the asynchronous reads while the files are still open */
+    HASPshutdown();
+
     /* Shutdown the file ID atom group */
     HAdestroy_group(FIDGROUP);
 
@@ -2222,9 +2440,7 @@ HIget_function_table(accrec_t *access_rec)
     if (HTPinquire(access_rec->ddid, NULL, NULL, &data_off, NULL) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, NULL);
 
-    if (HPseek(file_rec, data_off) == FAIL)
-        HGOTO_ERROR(DFE_SEEKERROR, NULL);
-    if (HP_read(file_rec, lbuf, (int)2) == FAIL)
+    if (HPread_at(file_rec, data_off, lbuf, (int)2) == FAIL)
         HGOTO_ERROR(DFE_READERROR, NULL);
 
     /* using special code, look up function table in associative table */
@@ -2416,6 +2632,8 @@ done:
 int
 Hgetlibversion(uint32 *majorv, uint32 *minorv, uint32 *releasev, char *string)
 {
+    H4_API_ENTER;
+
     HEclear();
 
     *majorv   = LIBVER_MAJOR;
@@ -2448,6 +2666,8 @@ Hgetlibversion(uint32 *majorv, uint32 *minorv, uint32 *releasev, char *string)
 int
 Hgetfileversion(int32 file_id, uint32 *majorv, uint32 *minorv, uint32 *release, char *string)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec;
     int        ret_value = SUCCEED;
 
@@ -2553,6 +2773,8 @@ HIget_filerec_node(const char *path)
         if ((ret_value->path = (char *)strdup(path)) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, NULL);
 
+        ret_value->file = HI_NOFILE;
+
         /* Initialize annotation stuff */
         ret_value->an_tree[AN_DATA_LABEL] = NULL;
         ret_value->an_tree[AN_DATA_DESC]  = NULL;
@@ -2562,6 +2784,10 @@ HIget_filerec_node(const char *path)
         ret_value->an_num[AN_DATA_DESC]   = -1;
         ret_value->an_num[AN_FILE_LABEL]  = -1;
         ret_value->an_num[AN_FILE_DESC]   = -1;
+
+#ifdef H4_HAVE_THREADSAFE
+        pthread_mutex_init(&ret_value->lock, NULL);
+#endif
     } /* end if */
 
 done:
@@ -2584,10 +2810,16 @@ static int
 HIrelease_filerec_node(filerec_t *file_rec)
 {
     /* Close file if it's opened */
-    if (file_rec->file != NULL)
+    HIfile_munmap(file_rec);
+    if (!OPENERR(file_rec->file))
         HI_CLOSE(file_rec->file);
 
     /* Free all the components of the file record */
+    if (file_rec->chunk_pool != NULL)
+        mcache_pool_close(file_rec->chunk_pool);
+#ifdef H4_HAVE_THREADSAFE
+    pthread_mutex_destroy(&file_rec->lock);
+#endif
     free(file_rec->path);
     free(file_rec);
 
@@ -2750,14 +2982,17 @@ HIget_access_rec(void)
     HEclear();
 
     /* Grab from free list if possible */
+    H4_MUTEX_LOCK(&accrec_free_lock);
     if (accrec_free_list != NULL) {
         ret_value        = accrec_free_list;
         accrec_free_list = accrec_free_list->next;
     } /* end if */
-    else {
+    H4_MUTEX_UNLOCK(&accrec_free_lock);
+
+    if (ret_value == NULL) {
         if ((ret_value = (accrec_t *)malloc(sizeof(accrec_t))) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, NULL);
-    } /* end else */
+    } /* end if */
 
     /* Initialize to zeros */
     memset(ret_value, 0, sizeof(accrec_t));
@@ -2781,8 +3016,10 @@ void
 HIrelease_accrec_node(accrec_t *acc)
 {
     /* Insert the atom at the beginning of the free list */
+    H4_MUTEX_LOCK(&accrec_free_lock);
     acc->next        = accrec_free_list;
     accrec_free_list = acc;
+    H4_MUTEX_UNLOCK(&accrec_free_lock);
 } /* end HIrelease_accrec_node() */
 
 /*--------------------------------------------------------------------------
@@ -3019,6 +3256,8 @@ HPfreediskblock(filerec_t *file_rec, int32 block_off, int32 block_size)
 int32
 HDget_special_info(int32 access_id, sp_info_block_t *info_block)
 {
+    H4_API_ENTER;
+
     accrec_t *access_rec; /* access record */
     int32     ret_value = FAIL;
 
@@ -3059,6 +3298,8 @@ done:
 int32
 HDset_special_info(int32 access_id, sp_info_block_t *info_block)
 {
+    H4_API_ENTER;
+
     accrec_t *access_rec; /* access record */
     int32     ret_value = FAIL;
 
@@ -3122,6 +3363,8 @@ static uint32 read_force_seek  = 0;
 void
 Hdumpseek(void)
 {
+    H4_API_ENTER;
+
     printf("Seeks taken=%lu\n", (unsigned long)seek_taken);
     printf("Seeks avoided=%lu\n", (unsigned long)seek_avoided);
     printf("# of times write forced a seek=%lu\n", (unsigned long)write_force_seek);
@@ -3142,7 +3385,8 @@ Hdumpseek(void)
  RETURNS
     Returns SUCCEED/FAIL
  DESCRIPTION
-    Function to wrap around HI_READ
+    Function to wrap around HI_READ.  If the file is memory mapped the
+    data is copied out of the mapping instead.
  GLOBAL VARIABLES
  COMMENTS, BUGS, ASSUMPTIONS
     Should only be called by HDF low-level routines
@@ -3154,6 +3398,21 @@ HP_read(filerec_t *file_rec, void *buf, int32 bytes)
 {
     int ret_value = SUCCEED;
 
+    if (file_rec->map_base != NULL) {
+        const uint8 *p = HPmap_ptr(file_rec, file_rec->f_cur_off, bytes);
+
+        if (p == NULL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        memcpy(buf, p, (size_t)bytes);
+        file_rec->f_cur_off += bytes;
+        HGOTO_DONE(SUCCEED);
+    }
+
+#if (FILELIB == UNIXPOSIO)
+    if (HI_PREAD(file_rec->file, buf, bytes, file_rec->f_cur_off) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+    file_rec->f_cur_off += bytes;
+#else
     /* Check for switching file access operations */
     if (file_rec->last_op == H4_OP_WRITE || file_rec->last_op == H4_OP_UNKNOWN) {
 #ifdef HFILE_SEEKINFO
@@ -3168,6 +3427,8 @@ HP_read(filerec_t *file_rec, void *buf, int32 bytes)
         HGOTO_ERROR(DFE_READERROR, FAIL);
     file_rec->f_cur_off += bytes;
     file_rec->last_op = H4_OP_READ;
+#endif /* FILELIB == UNIXPOSIO */
+
 done:
     return ret_value;
 } /* end HP_read() */
@@ -3184,7 +3445,9 @@ done:
  RETURNS
     Returns SUCCEED/FAIL
  DESCRIPTION
-    Function to wrap around HI_SEEK
+    Function to wrap around HI_SEEK.  With positional I/O (UNIXPOSIO) this
+    only records the offset for the next HP_read/HP_write; no system call
+    is made.  The same is true of a memory mapped file.
  GLOBAL VARIABLES
  COMMENTS, BUGS, ASSUMPTIONS
     Should only be called by HDF low-level routines
@@ -3194,8 +3457,18 @@ done:
 int
 HPseek(filerec_t *file_rec, int32 offset)
 {
+#if (FILELIB == UNIXPOSIO)
+    /* Just remember where the next transfer starts */
+    file_rec->f_cur_off = offset;
+    return SUCCEED;
+#else
     int ret_value = SUCCEED;
 
+    if (file_rec->map_base != NULL) {
+        file_rec->f_cur_off = offset;
+        HGOTO_DONE(SUCCEED);
+    }
+
 #ifdef HFILE_SEEKINFO
     printf("%s: file_rec=%p, last_offset=%ld, offset=%ld, last_op=%d", __func__, file_rec,
            (long)file_rec->f_cur_off, (long)offset, (int)file_rec->last_op);
@@ -3219,6 +3492,7 @@ HPseek(filerec_t *file_rec, int32 offset)
 
 done:
     return ret_value;
+#endif /* FILELIB == UNIXPOSIO */
 } /* end HPseek() */
 
 /*--------------------------------------------------------------------------
@@ -3246,6 +3520,11 @@ HP_write(filerec_t *file_rec, const void *buf, int32 bytes)
 {
     int ret_value = SUCCEED;
 
+#if (FILELIB == UNIXPOSIO)
+    if (HI_PWRITE(file_rec->file, buf, bytes, file_rec->f_cur_off) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+    file_rec->f_cur_off += bytes;
+#else
     /* Check for switching file access operations */
     if (file_rec->last_op == H4_OP_READ || file_rec->last_op == H4_OP_UNKNOWN) {
 #ifdef HFILE_SEEKINFO
@@ -3260,11 +3539,203 @@ HP_write(filerec_t *file_rec, const void *buf, int32 bytes)
         HGOTO_ERROR(DFE_WRITEERROR, FAIL);
     file_rec->f_cur_off += bytes;
     file_rec->last_op = H4_OP_WRITE;
+#endif /* FILELIB == UNIXPOSIO */
 
 done:
     return ret_value;
 } /* end HP_write() */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HPread_at
+ PURPOSE
+    Read from a given offset in an HDF file.
+ USAGE
+    int HPread_at(file_rec,offset,buf,bytes)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+        int32 offset;           IN: offset in the file to read from
+        void * buf;             IN: Pointer to the buffer to read data into
+        int32 bytes;            IN: # of bytes to read
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    Same as HPseek followed by HP_read.  With positional I/O (UNIXPOSIO)
+    this is a single system call and the file record's position is left
+    alone, so the record is not modified at all.  A memory mapped file is
+    read with a plain copy out of the mapping.
+ COMMENTS, BUGS, ASSUMPTIONS
+    Should only be called by HDF low-level routines
+--------------------------------------------------------------------------*/
+int
+HPread_at(filerec_t *file_rec, int32 offset, void *buf, int32 bytes)
+{
+    int ret_value = SUCCEED;
+
+    if (file_rec->map_base != NULL) {
+        const uint8 *p = HPmap_ptr(file_rec, offset, bytes);
+
+        if (p == NULL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        memcpy(buf, p, (size_t)bytes);
+        HGOTO_DONE(SUCCEED);
+    }
+
+#if (FILELIB == UNIXPOSIO)
+    if (HI_PREAD(file_rec->file, buf, bytes, offset) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+#else
+    if (HPseek(file_rec, offset) == FAIL)
+        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+    if (HP_read(file_rec, buf, bytes) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+#endif /* FILELIB == UNIXPOSIO */
+
+done:
+    return ret_value;
+} /* end HPread_at() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HPwrite_at
+ PURPOSE
+    Write to a given offset in an HDF file.
+ USAGE
+    int HPwrite_at(file_rec,offset,buf,bytes)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+        int32 offset;           IN: offset in the file to write to
+        void * buf;             IN: Pointer to the buffer to write
+        int32 bytes;            IN: # of bytes to write
+ RETURNS
+    Returns SUCCEED/FAIL
+ DESCRIPTION
+    Same as HPseek followed by HP_write.  With positional I/O (UNIXPOSIO)
+    this is a single system call and the file record's position is left
+    alone.
+ COMMENTS, BUGS, ASSUMPTIONS
+    Should only be called by HDF low-level routines
+--------------------------------------------------------------------------*/
+int
+HPwrite_at(filerec_t *file_rec, int32 offset, const void *buf, int32 bytes)
+{
+    int ret_value = SUCCEED;
+
+#if (FILELIB == UNIXPOSIO)
+    if (HI_PWRITE(file_rec->file, buf, bytes, offset) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+#else
+    if (HPseek(file_rec, offset) == FAIL)
+        HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+    if (HP_write(file_rec, buf, bytes) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+#endif /* FILELIB == UNIXPOSIO */
+
+done:
+    return ret_value;
+} /* end HPwrite_at() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HPmap_ptr
+ PURPOSE
+    Get a pointer into the memory mapping of an HDF file.
+ USAGE
+    const uint8 *HPmap_ptr(file_rec,offset,bytes)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+        int32 offset;           IN: offset in the file
+        int32 bytes;            IN: # of bytes the caller wants to look at
+ RETURNS
+    Returns a pointer to the data at 'offset', or NULL if the file is not
+    memory mapped or the range is not entirely inside the mapping.
+ DESCRIPTION
+    Lets low-level routines decode file data in place, without copying it
+    into a buffer first.  The pointer stays valid until the file is closed
+    or reopened for writing.
+ COMMENTS, BUGS, ASSUMPTIONS
+    Should only be called by HDF low-level routines
+--------------------------------------------------------------------------*/
+const uint8 *
+HPmap_ptr(filerec_t *file_rec, int32 offset, int32 bytes)
+{
+    if (file_rec->map_base == NULL || offset < 0 || bytes < 0)
+        return NULL;
+    if ((size_t)offset > file_rec->map_len || (size_t)bytes > file_rec->map_len - (size_t)offset)
+        return NULL;
+    return file_rec->map_base + offset;
+} /* end HPmap_ptr() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HIfile_mmap
+ PURPOSE
+    Map an open HDF file into memory for reading.
+ USAGE
+    void HIfile_mmap(file_rec)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+ RETURNS
+    Nothing.  If the file can't be mapped (no mmap on this platform, an
+    empty or too large file, or mmap failing), map_base is left NULL and
+    the file is read through the normal I/O calls.
+ DESCRIPTION
+    Used by Hopen for DFACC_MMAP.  The whole file is mapped private and
+    read-only; afterwards HP_read/HPread_at copy straight out of the
+    mapping and HPseek makes no system call.
+--------------------------------------------------------------------------*/
+static void
+HIfile_mmap(filerec_t *file_rec)
+{
+#if defined(H4_HAVE_MMAP) && defined(H4_HAVE_SYS_MMAN_H)
+    struct stat sb;
+    void       *base;
+
+    if (file_rec->map_base != NULL)
+        return;
+
+    if (fstat(HI_FILENO(file_rec->file), &sb) != 0)
+        return;
+
+    /* Offsets in an HDF file are int32, don't bother with larger files */
+    if (sb.st_size <= 0 || sb.st_size > (off_t)INT32_MAX)
+        return;
+
+    base = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, HI_FILENO(file_rec->file), (off_t)0);
+    if (base == MAP_FAILED)
+        return;
+
+    file_rec->map_base = (uint8 *)base;
+    file_rec->map_len  = (size_t)sb.st_size;
+#else
+    (void)file_rec;
+#endif
+} /* end HIfile_mmap() */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HIfile_munmap
+ PURPOSE
+    Remove the memory mapping of an HDF file, if there is one.
+ USAGE
+    void HIfile_munmap(file_rec)
+        filerec_t * file_rec;   IN: Pointer to the HDF file record
+ RETURNS
+    Nothing.
+ DESCRIPTION
+    After this, reads go through the normal I/O calls again, starting
+    from the file record's current offset.
+--------------------------------------------------------------------------*/
+static void
+HIfile_munmap(filerec_t *file_rec)
+{
+    if (file_rec->map_base == NULL)
+        return;
+
+#if defined(H4_HAVE_MMAP) && defined(H4_HAVE_SYS_MMAN_H)
+    munmap(file_rec->map_base, file_rec->map_len);
+#endif
+    file_rec->map_base = NULL;
+    file_rec->map_len  = 0;
+    file_rec->last_op  = H4_OP_UNKNOWN;
+} /* end HIfile_munmap() */
+
 /*--------------------------------------------------------------------------
  NAME
     HDread_drec -- reads a description record
@@ -3349,6 +3820,8 @@ done:
 int32
 HDcheck_empty(int32 file_id, uint16 tag, uint16 ref, int *emptySDS /* TRUE if data element is empty */)
 {
+    H4_API_ENTER;
+
     int32      length;         /* length of the element's data */
     atom_t     data_id = FAIL; /* dd ID of existing regular element */
     filerec_t *file_rec;       /* file record pointer */
@@ -3481,6 +3954,8 @@ DESCRIPTION
 int
 Hgetntinfo(const int32 numbertype, hdf_ntinfo_t *nt_info)
 {
+    H4_API_ENTER;
+
     /* Clear error stack */
     HEclear();
 
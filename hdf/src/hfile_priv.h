@@ -25,7 +25,6 @@
 #include "tbbt_priv.h"
 #include "bitvect_priv.h"
 #include "atom_priv.h"
-#include "dynarray_priv.h"
 
 /* Magic cookie for HDF data files */
 #define MAGICLEN 4                  /* length */
@@ -53,11 +52,16 @@
 #endif
 
 /* -------------------------- File I/O Functions -------------------------- */
-/* FILELIB -- file library to use for file access: 1 stdio, 2 fcntl
-   default to stdio library i.e. UNIX buffered I/O */
+/* FILELIB -- file library to use for file access: 1 fcntl, 2 stdio,
+   3 positional fcntl (pread/pwrite). Default to positional I/O when the
+   platform has it, else to the stdio library i.e. UNIX buffered I/O */
 
 #ifndef FILELIB
-#define FILELIB UNIXBUFIO /* UNIX buffered I/O is the default */
+#if defined(H4_HAVE_PREAD) && defined(H4_HAVE_PWRITE)
+#define FILELIB UNIXPOSIO /* UNIX positional I/O */
+#else
+#define FILELIB UNIXBUFIO /* UNIX buffered I/O */
+#endif
 #endif
 
 #if (FILELIB == UNIXBUFIO)
@@ -75,6 +79,8 @@ typedef FILE *hdf_file_t;
 #define HI_SEEKEND(f)     (fseek((f), (long)0, SEEK_END) == 0 ? SUCCEED : FAIL)
 #define HI_TELL(f)        (ftell(f))
 #define OPENERR(f)        ((f) == (FILE *)NULL)
+#define HI_NOFILE         ((FILE *)NULL)
+#define HI_FILENO(f)      (fileno(f))
 #endif /* FILELIB == UNIXBUFIO */
 
 #if (FILELIB == UNIXUNBUFIO)
@@ -90,8 +96,34 @@ typedef int hdf_file_t;
 #define HI_SEEKEND(f)     (lseek((f), (off_t)0, SEEK_END) != (-1) ? SUCCEED : FAIL)
 #define HI_TELL(f)        (lseek((f), (off_t)0, SEEK_CUR))
 #define OPENERR(f)        (f < 0)
+#define HI_NOFILE         (-1)
+#define HI_FILENO(f)      (f)
 #endif /* FILELIB == UNIXUNBUFIO */
 
+#if (FILELIB == UNIXPOSIO)
+/* using UNIX positional file I/O routines to access files. HDF files are
+   only accessed through HI_PREAD/HI_PWRITE, which take the offset of each
+   transfer and share no file position, so the H-layer never needs to seek.
+   The sequential routines are kept for external elements and such. */
+typedef int hdf_file_t;
+#define HI_OPEN(p, a)     (((a)&DFACC_WRITE) ? open((p), O_RDWR) : open((p), O_RDONLY))
+#define HI_CREATE(p)      (open((p), O_RDWR | O_CREAT | O_TRUNC, 0666))
+#define HI_CLOSE(f)       (((f = ((close(f) == 0) ? -1 : f)) == -1) ? SUCCEED : FAIL)
+#define HI_FLUSH(f)       (SUCCEED)
+#define HI_READ(f, b, n)  (((ssize_t)(n) == read((f), (char *)(b), (size_t)(n))) ? SUCCEED : FAIL)
+#define HI_WRITE(f, b, n) (((ssize_t)(n) == write((f), (const char *)(b), (size_t)(n))) ? SUCCEED : FAIL)
+#define HI_PREAD(f, b, n, o)                                                                                 \
+    (((ssize_t)(n) == pread((f), (void *)(b), (size_t)(n), (off_t)(o))) ? SUCCEED : FAIL)
+#define HI_PWRITE(f, b, n, o)                                                                                \
+    (((ssize_t)(n) == pwrite((f), (const void *)(b), (size_t)(n), (off_t)(o))) ? SUCCEED : FAIL)
+#define HI_SEEK(f, o)   (lseek((f), (off_t)(o), SEEK_SET) != (-1) ? SUCCEED : FAIL)
+#define HI_SEEKEND(f)   (lseek((f), (off_t)0, SEEK_END) != (-1) ? SUCCEED : FAIL)
+#define HI_TELL(f)      (lseek((f), (off_t)0, SEEK_CUR))
+#define OPENERR(f)      (f < 0)
+#define HI_NOFILE       (-1)
+#define HI_FILENO(f)    (f)
+#endif /* FILELIB == UNIXPOSIO */
+
 /* ----------------------- Internal Data Structures ----------------------- */
 /* The internal structure used to keep track of the files opened: an
    array of filerec_t structures, each has a linked list of ddblock_t.
@@ -184,6 +216,7 @@ typedef struct dd_t {
     int32             length; /* length of data element */
     int32             offset; /* byte offset of data element from */
     struct ddblock_t *blk;    /* Pointer to the block this dd is in */
+    struct dd_t      *hnext;  /* next dd in the same DD hash bucket */
 } /* beginning of file */
 dd_t;
 
@@ -212,8 +245,7 @@ typedef struct ddblock_t {
 typedef struct tag_info_str {
     uint16 tag; /* tag value for this node */
     /* Needs to be first in this structure */
-    bv_ptr   b; /* bit-vector to keep track of which refs are used */
-    dynarr_p d; /* dynarray of the refs for this tag */
+    bv_ptr b; /* bit-vector to keep track of which refs are used */
 } tag_info;
 
 /* For determining what the last file operation was */
@@ -235,10 +267,16 @@ typedef struct filerec_t {
     int        version_set; /* version tag stuff */
     version_t  version;     /* file version info */
 
-    /* Seek caching info */
+    /* Seek caching info. With UNIXPOSIO, f_cur_off is only the position
+       used by the next HP_read/HP_write and last_op is not used. */
     int32    f_cur_off; /* Current location in the file */
     fileop_t last_op;   /* the last file operation performed */
 
+    /* Memory mapped file (DFACC_MMAP). When map_base is set, reads are
+       served from the mapping and never touch 'file'. */
+    uint8 *map_base; /* start of the mapping, NULL if not mapped */
+    size_t map_len;  /* length of the mapping */
+
     /* DD block caching info */
     int   cache;     /* boolean: whether caching is on */
     int   dirty;     /* boolean: if dd list needs to be flushed */
@@ -255,12 +293,25 @@ typedef struct filerec_t {
     /* tag tree for file */
     TBBT_TREE *tag_tree; /* TBBT of the tags in the file */
 
+    /* DD hash for file, indexed by (base tag, ref) */
+    struct dd_t **dd_hash;       /* buckets, chained through dd_t.hnext */
+    unsigned      dd_hash_bits;  /* log2 of the number of buckets */
+    unsigned      dd_hash_count; /* number of DDs in the hash */
+
+    /* pages shared by the chunk caches of all chunked elements */
+    struct MCACHE_POOL *chunk_pool; /* NULL until a chunked element is accessed */
+
     /* annotation stuff for file */
     int        an_num[4];  /* Holds number of annotations found of each type */
     TBBT_TREE *an_tree[4]; /* tbbt trees for each type of annotation in file
                             * i.e. file/data labels and descriptions.
                             * This is done for faster searching of annotations
                             * of a particular type. */
+
+#ifdef H4_HAVE_THREADSAFE
+    /* held by the routines that read the file in parallel with others */
+    pthread_mutex_t lock;
+#endif
 } filerec_t;
 
 /* bits for filerec_t 'dirty' flag */
@@ -432,12 +483,20 @@ HDFLIBAPI int32 HDget_special_info(int32 access_id, sp_info_block_t *info_block)
 
 HDFLIBAPI int32 HDset_special_info(int32 access_id, sp_info_block_t *info_block);
 
+HDFLIBAPI int HPendaccess(int32 access_id);
+
 HDFLIBAPI int HP_read(filerec_t *file_rec, void *buf, int32 bytes);
 
 HDFLIBAPI int HPseek(filerec_t *file_rec, int32 offset);
 
 HDFLIBAPI int HP_write(filerec_t *file_rec, const void *buf, int32 bytes);
 
+HDFLIBAPI int HPread_at(filerec_t *file_rec, int32 offset, void *buf, int32 bytes);
+
+HDFLIBAPI int HPwrite_at(filerec_t *file_rec, int32 offset, const void *buf, int32 bytes);
+
+HDFLIBAPI const uint8 *HPmap_ptr(filerec_t *file_rec, int32 offset, int32 bytes);
+
 HDFLIBAPI int32 HPread_drec(int32 file_id, atom_t data_id, uint8 **drec_buf);
 
 HDFLIBAPI int tagcompare(void *k1, void *k2, int cmparg);
@@ -587,7 +646,8 @@ HDFLIBAPI int32 HRPinfo(accrec_t *access_rec, sp_info_block_t *info_block);
     Returns SUCCEED if successful and FAIL otherwise
 
 *******************************************************************************/
-int HTPstart(filerec_t *file_rec /* IN:  File record to store info in */
+int HTPstart(filerec_t *file_rec, /* IN: File record to store info in */
+             int32      ndds_hint /* IN: expected # of DDs in the file, 0 if unknown */
 );
 
 /******************************************************************************
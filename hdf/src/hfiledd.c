@@ -29,8 +29,11 @@ DESIGN
     are designed for faster access to certain manipulations of the DD list.
     The tag_tree is a tbbt of the tags contained within the file.  Each
     node of the tag_tree has a link to a bit-vector for keeping track of the
-    refs used for that tag and a link to a dynamic array pointers into the
-    DD list for each ref # used.
+    refs used for that tag.  The DD hash is a chained hash table of pointers
+    into the DD list, keyed by (base tag, ref), which makes looking up a
+    specific tag/ref pair a constant time operation no matter how many DDs
+    the file has.  Searches with wildcards still walk the DD list, since
+    they must return the DDs in the order they are in the file.
 
 BUGS/LIMITATIONS
 
@@ -46,6 +49,7 @@ EXPORTED ROUTINES
   Developer-level routines
     HDcheck_tagref - Checks to see if tag/ref is in DD list i.e. created already
     HDreuse_tagref - reuse a data descriptor preserving tag/refw(assumes DD exists)
+    HDdd_checksum  - Compute a checksum of the DD list
 
   Tag/ref functions:
     HTPcreate   - Create (& attach to) a tag/ref pair (inserts into DD list also)
@@ -68,6 +72,11 @@ LOCAL ROUTINES
     HTIcount_dd     - counts the dd's of a certain type in file
     HTIregister_tag_ref     - insert a ref into the tag tree for a file
     HTIunregister_tag_ref   - remove a ref from the tag tree for a file
+    HTIread_dd_bytes - read part of the DD list for HTPstart
+    HTIhash_init    - create the DD hash for a file
+    HTIhash_find    - look up a tag/ref in the DD hash
+    HTIhash_insert  - add a DD to the DD hash
+    HTIhash_remove  - remove a DD from the DD hash
 
 OLD ROUTINES
     HIlookup_dd             - find the dd record for an element
@@ -101,11 +110,35 @@ static int HTIregister_tag_ref(filerec_t *file_rec, dd_t *dd);
 
 static int HTIunregister_tag_ref(filerec_t *file_rec, dd_t *dd_ptr);
 
+static int HTIhash_init(filerec_t *file_rec, int32 nentries);
+
+static dd_t *HTIhash_find(filerec_t *file_rec, uint16 tag, uint16 ref);
+
+static int HTIhash_insert(filerec_t *file_rec, dd_t *dd_ptr);
+
+static void HTIhash_remove(filerec_t *file_rec, dd_t *dd_ptr);
+
+/* Buffer holding a piece of the file while HTPstart reads the DD blocks */
+typedef struct dd_window_t {
+    uint8 *buf;       /* the bytes read */
+    size_t buf_size;  /* size of the allocated buffer */
+    int32  off;       /* file offset of buf[0] */
+    int32  len;       /* # of valid bytes in buf */
+    int32  file_size; /* size of the file, 0 if unknown */
+} dd_window_t;
+
+static const uint8 *HTIread_dd_bytes(filerec_t *file_rec, dd_window_t *win, int32 off, int32 len,
+                                     int32 ahead);
+
 /* Local definitions */
-/* The initial size of a ref dynarray */
-#define REF_DYNARRAY_START 64
-/* The increment of a ref dynarray */
-#define REF_DYNARRAY_INCR 256
+/* log2 of the initial and maximum number of buckets in the DD hash */
+#define DD_HASH_START_BITS 8
+#define DD_HASH_MAX_BITS   24
+/* Most bytes HTPstart reads past a DD block hoping to find the next one */
+#define DD_READ_AHEAD_MAX 65536
+/* Bucket for a base tag/ref pair (Fibonacci hashing of the 32-bit tag/ref) */
+#define DD_HASH_BUCKET(bits, tag, ref)                                                                       \
+    ((unsigned)(((((uint32)(tag) << 16) | (uint32)(ref)) * (uint32)2654435761U) >> (32 - (bits))))
 /* macros to encode and decode a DD */
 #define DDENCODE(p, tag, ref, offset, length)                                                                \
     {                                                                                                        \
@@ -132,18 +165,25 @@ static int HTIunregister_tag_ref(filerec_t *file_rec, dd_t *dd_ptr);
     file and HTPend should be called when finished with the DD list (i.e.
     when the file is being closed).
 
+    Each DD block is read along with its header in a single read, which
+    also takes in the next block if it happens to follow right after, so
+    a file whose DD blocks are contiguous is read with one I/O call.  If
+    the file is memory mapped, the DDs are decoded from the mapping.
+
  RETURNS
     Returns SUCCEED if successful and FAIL otherwise
 
 *******************************************************************************/
 int
-HTPstart(filerec_t *file_rec /* IN:  File record to store info in */
+HTPstart(filerec_t *file_rec, /* IN: File record to store info in */
+         int32      ndds_hint /* IN: expected # of DDs in the file, 0 if unknown */
 )
 {
-    uint8   *tbuf      = NULL; /* temporary buffer */
-    unsigned tbuf_size = 0;    /* temporary buffer size */
-    int32    end_off   = 0;    /* offset of the end of the file */
-    int      ret_value = SUCCEED;
+    dd_window_t win;                  /* file data read so far */
+    int32       end_off   = 0;        /* offset of the end of the file */
+    int         prev_ndds = DEF_NDDS; /* # of DDs in the previous block */
+    int32       read_ahead;           /* # of bytes to read past a block */
+    int         ret_value = SUCCEED;
 
     HEclear();
     /* Alloc start of linked list of ddblocks. */
@@ -167,36 +207,48 @@ HTPstart(filerec_t *file_rec /* IN:  File record to store info in */
     /* Initialize the tag tree */
     file_rec->tag_tree = tbbtdmake(tagcompare, sizeof(uint16), TBBT_FAST_UINT16_COMPARE);
 
+    /* Initialize the DD hash */
+    if (HTIhash_init(file_rec, ndds_hint) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
     /* Initialize the DD atom group (trying 256 hash currently, feel free to change */
     if (HAinit_group(DDGROUP, 256) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
+    /* Nothing read yet.  The size of the file limits how far ahead we read. */
+    memset(&win, 0, sizeof(win));
+    read_ahead = NDDS_SZ + OFFSET_SZ + DEF_NDDS * DD_SZ;
+#ifdef H4_HAVE_SYS_STAT_H
+    if (file_rec->map_base == NULL) {
+        struct stat sb;
+
+        if (fstat(HI_FILENO(file_rec->file), &sb) == 0 && sb.st_size <= (off_t)INT32_MAX)
+            win.file_size = (int32)sb.st_size;
+    }
+#endif
+
     /* Read in the dd's one at a time and determine the max ref in the file
              at the same time. */
     file_rec->maxref = 0;
     for (;;) {
-        ddblock_t *ddcurr;                      /* ptr to the current DD block */
-        dd_t      *curr_dd_ptr;                 /* pointer to the current DD being read in */
-        uint8      ddhead[NDDS_SZ + OFFSET_SZ]; /* storage for the DD header */
-        uint8     *p;                           /* Temporary buffer pointer. */
-        int        ndds;                        /* number of DDs in a block */
-        int        i;                           /* Temporary integer */
+        ddblock_t   *ddcurr;      /* ptr to the current DD block */
+        dd_t        *curr_dd_ptr; /* pointer to the current DD being read in */
+        const uint8 *p;           /* Temporary buffer pointer. */
+        int          ndds;        /* number of DDs in a block */
+        int          i;           /* Temporary integer */
 
         /* Get a short-cut for the current DD block being read-in */
         ddcurr = file_rec->ddlast;
 
-        /* Go to the beginning of the DD block */
-        if (HPseek(file_rec, ddcurr->myoffset) == FAIL)
-            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
-
         /* Read in the start of this dd block.
            Read data consists of ndds (number of dd's in this block) and
-           offset (offset to the next ddblock). */
-        if (HP_read(file_rec, ddhead, NDDS_SZ + OFFSET_SZ) == FAIL)
+           offset (offset to the next ddblock).  Guess that the block is
+           as big as the last one and get its dd's in the same read. */
+        if ((p = HTIread_dd_bytes(file_rec, &win, ddcurr->myoffset, NDDS_SZ + OFFSET_SZ,
+                                  prev_ndds * DD_SZ + read_ahead)) == NULL)
             HGOTO_ERROR(DFE_READERROR, FAIL);
 
         /* Decode the numbers. */
-        p = &ddhead[0];
         INT16DECODE(p, ddcurr->ndds);
         ndds = (int)ddcurr->ndds;
         if (ndds <= 0) /* validity check */
@@ -214,24 +266,25 @@ HTPstart(filerec_t *file_rec /* IN:  File record to store info in */
         if (ddcurr->ddlist == (dd_t *)NULL)
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
-        /* Allocate memory for the temporary buffer also */
-        if (tbuf == NULL || ((unsigned)ndds * DD_SZ) > tbuf_size) {
-            free(tbuf);
-            tbuf_size = (unsigned)ndds * DD_SZ;
-            tbuf      = (uint8 *)malloc(tbuf_size);
-            if (tbuf == (uint8 *)NULL)
-                HGOTO_ERROR(DFE_NOSPACE, FAIL);
-        } /* end if */
-
         /* Index of current dd in ddlist of this ddblock is 0. */
         curr_dd_ptr = ddcurr->ddlist;
 
-        /* Read in a chunk of dd's from the file. */
-        if (HP_read(file_rec, tbuf, ndds * DD_SZ) == FAIL)
+        /* Get the chunk of dd's, usually already read in with the header.
+           Also read ahead in case the next block follows this one. */
+        if ((p = HTIread_dd_bytes(file_rec, &win, ddcurr->myoffset + NDDS_SZ + OFFSET_SZ, ndds * DD_SZ,
+                                  read_ahead)) == NULL)
             HGOTO_ERROR(DFE_READERROR, FAIL);
+        prev_ndds = ndds;
+
+        /* While the blocks are back to back, read further ahead each time */
+        if (ddcurr->nextoffset == ddcurr->myoffset + (NDDS_SZ + OFFSET_SZ) + (ndds * DD_SZ)) {
+            if (read_ahead < DD_READ_AHEAD_MAX)
+                read_ahead *= 2;
+        }
+        else
+            read_ahead = NDDS_SZ + OFFSET_SZ + ndds * DD_SZ;
 
         /* decode the dd's */
-        p = tbuf;
         for (i = 0; i < ndds; i++, curr_dd_ptr++) {
             DDDECODE(p, curr_dd_ptr->tag, curr_dd_ptr->ref, curr_dd_ptr->offset, curr_dd_ptr->length);
             curr_dd_ptr->blk = ddcurr;
@@ -280,7 +333,7 @@ HTPstart(filerec_t *file_rec /* IN:  File record to store info in */
     file_rec->f_end_off = end_off;
 
 done:
-    free(tbuf);
+    free(win.buf);
 
     return ret_value;
 } /* end HTPstart() */
@@ -381,6 +434,10 @@ HTPinit(filerec_t *file_rec, /* IN: File record to store info in */
     /* Initialize the tag tree */
     file_rec->tag_tree = tbbtdmake(tagcompare, sizeof(uint16), TBBT_FAST_UINT16_COMPARE);
 
+    /* Initialize the DD hash */
+    if (HTIhash_init(file_rec, 0) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
     /* Initialize the DD atom group (trying 256 hash currently, feel free to change */
     if (HAinit_group(DDGROUP, 256) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
@@ -500,6 +557,12 @@ HTPend(filerec_t *file_rec /* IN:  File record to store info in */
     /* Chuck the tag info tree too */
     tbbtdfree(file_rec->tag_tree, tagdestroynode, NULL);
 
+    /* And the DD hash (the DDs themselves went with the blocks) */
+    free(file_rec->dd_hash);
+    file_rec->dd_hash       = NULL;
+    file_rec->dd_hash_bits  = 0;
+    file_rec->dd_hash_count = 0;
+
     /* Shutdown the DD atom group */
     if (HAdestroy_group(DDGROUP) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
@@ -558,7 +621,7 @@ HTPcreate(filerec_t *file_rec, /* IN: File record to store info in */
     if (HTIupdate_dd(file_rec, dd_ptr) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-    /* Mark off the ref # as 'used' in the tag tree & add to dynarray of refs */
+    /* Mark off the ref # as 'used' in the tag tree & add to the DD hash */
     if (HTIregister_tag_ref(file_rec, dd_ptr) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
@@ -588,22 +651,15 @@ HTPselect(filerec_t *file_rec, /* IN: File record to store info in */
           uint16     ref       /* IN: ref to select */
 )
 {
-    dd_t      *dd_ptr;                   /* ptr to the DD info for the tag/ref */
-    tag_info **tip_ptr;                  /* ptr to the ptr to the info for a tag */
-    tag_info  *tinfo_ptr;                /* pointer to the info for a tag */
-    uint16     base_tag  = BASETAG(tag); /* corresponding base tag (if the tag is special) */
-    atom_t     ret_value = SUCCEED;
+    dd_t  *dd_ptr; /* ptr to the DD info for the tag/ref */
+    atom_t ret_value = SUCCEED;
 
     HEclear();
     if (file_rec == NULL || (tag == DFTAG_NULL || tag == DFTAG_WILDCARD) || ref == DFREF_WILDCARD)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* Try to find the regular tag in the tag info tree */
-    if ((tip_ptr = (tag_info **)tbbtdfind(file_rec->tag_tree, (void *)&base_tag, NULL)) == NULL)
-        HGOTO_DONE(FAIL); /* Not an error, we just didn't find the object */
-
-    tinfo_ptr = *tip_ptr; /* get the pointer to the tag info */
-    if ((dd_ptr = DAget_elem(tinfo_ptr->d, (int)ref)) == NULL)
+    /* Look the tag/ref up in the DD hash */
+    if ((dd_ptr = HTIhash_find(file_rec, tag, ref)) == NULL)
         HGOTO_DONE(FAIL); /* Not an error, we just didn't find the object */
 
     /* Get the atom to return */
@@ -681,7 +737,7 @@ HTPdelete(atom_t ddid /* IN: DD id to delete */
     if (HTIupdate_dd(file_rec, dd_ptr) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-    /* Remove the ref # as 'used' in the tag tree & delete from dynarray of refs */
+    /* Remove the ref # as 'used' in the tag tree & delete from the DD hash */
     if (HTIunregister_tag_ref(file_rec, dd_ptr) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
@@ -834,6 +890,8 @@ Hdupdd(int32  file_id, /* IN: File ID the tag/refs are in */
        uint16 old_ref  /* IN: Ref of old tag/ref */
 )
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec; /* file record */
     atom_t     old_dd;   /* The DD id for the old DD */
     atom_t     new_dd;   /* The DD id for the new DD */
@@ -893,6 +951,8 @@ Hnumber(int32  file_id, /* IN: File ID the tag/refs are in */
         uint16 tag      /* IN: Tag to count */
 )
 {
+    H4_API_ENTER;
+
     unsigned   all_cnt;
     unsigned   real_cnt;
     filerec_t *file_rec; /* file record */
@@ -932,6 +992,8 @@ done:
 uint16
 Hnewref(int32 file_id /* IN: File ID the tag/refs are in */)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec; /* file record */
     uint16     ref;      /* the new ref */
     uint16     ret_value = DFREF_NONE;
@@ -982,6 +1044,8 @@ uint16
 Htagnewref(int32  file_id, /* IN: File ID the tag/refs are in */
            uint16 tag /* IN: Tag to search for a new ref for */)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec;                 /* file record */
     tag_info  *tinfo_ptr;                /* pointer to the info for a tag */
     tag_info **tip_ptr;                  /* ptr to the ptr to the info for a tag */
@@ -1038,6 +1102,8 @@ Hfind(int32   file_id,    /* IN: file ID to search in */
                           /*  DF_BACKWARD searches backward from the current location */
 )
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec; /* file record */
     dd_t      *dd_ptr;   /* ptr to current ddlist searched */
     int        ret_value = SUCCEED;
@@ -1091,11 +1157,9 @@ HDcheck_tagref(int32  file_id, /* IN: id of file */
                uint16 tag,     /* IN: Tag to check */
                uint16 ref /* IN: ref to check */)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec  = NULL; /* file record */
-    dd_t      *dd_ptr    = NULL; /* ptr to the DD info for the tag/ref */
-    tag_info **tip_ptr   = NULL; /* ptr to the ptr to the info for a tag */
-    tag_info  *tinfo_ptr = NULL; /* pointer to the info for a tag */
-    uint16     base_tag;         /* corresponding base tag (if the tag is special) */
     int        ret_value = 1;    /* default tag/ref exists  */
 
     /* clear error stack */
@@ -1106,14 +1170,8 @@ HDcheck_tagref(int32  file_id, /* IN: id of file */
     if (file_rec == NULL || (tag == DFTAG_NULL || tag == DFTAG_WILDCARD) || ref == DFREF_WILDCARD)
         HGOTO_ERROR(DFE_ARGS, -1);
 
-    base_tag = BASETAG(tag);
-
-    /* Try to find the regular tag in the tag info tree */
-    if ((tip_ptr = (tag_info **)tbbtdfind(file_rec->tag_tree, (void *)&base_tag, NULL)) == NULL)
-        HGOTO_DONE(0); /* Not an error, we just didn't find the object */
-
-    tinfo_ptr = *tip_ptr; /* get the pointer to the tag info */
-    if ((dd_ptr = DAget_elem(tinfo_ptr->d, (int)ref)) == NULL)
+    /* Look the tag/ref up in the DD hash */
+    if (HTIhash_find(file_rec, tag, ref) == NULL)
         HGOTO_DONE(0); /* Not an error, we just didn't find the object */
 
     /* found if we reach here*/
@@ -1150,6 +1208,8 @@ HDreuse_tagref(int32  file_id, /* IN: id of file */
                uint16 tag,     /* IN: tag of data descriptor to reuse */
                uint16 ref /* IN: ref of data descriptor to reuse */)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec = NULL; /* file record */
     atom_t     ddid;            /* ID for the DD */
     int        ret_value = SUCCEED;
@@ -1176,7 +1236,7 @@ HDreuse_tagref(int32  file_id, /* IN: id of file */
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
     /* We leave the ref # as 'used' in the tag tree and
-       don't delete from dynarray of refs. */
+       don't delete from the DD hash. */
 
     /* Remove DD from atom group since it should get re-created in Hstartaccess().
        This could be handled better if Hstartaccess() was revamped
@@ -1210,6 +1270,8 @@ DESCRIPTION
 int
 Hdeldd(int32 file_id, uint16 tag, uint16 ref)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec; /* file record */
     atom_t     ddid;     /* ID for the DD */
     int        ret_value = SUCCEED;
@@ -1232,6 +1294,75 @@ done:
     return ret_value;
 } /* end Hdeldd */
 
+/*--------------------------------------------------------------------------
+NAME
+   HDdd_checksum -- compute a checksum of the DD list
+USAGE
+   int HDdd_checksum(file_id, skip_tag, ndds, checksum)
+   int32 file_id;            IN: id of file
+   uint16 skip_tag;          IN: tag of DDs to leave out of the checksum
+   int32 *ndds;              OUT: number of DDs counted
+   uint32 *checksum;         OUT: checksum of the DDs counted
+RETURNS
+   returns SUCCEED (0) if successful, FAIL (-1) otherwise
+DESCRIPTION
+   Walks the in-memory DD list and computes a 32-bit FNV-1a checksum of
+   the tag, ref, offset and length of every DD in it, in file order.
+   Empty DDs and DDs with tag skip_tag are left out.  No I/O is done.
+
+   Since any element that is created, deleted, moved or resized changes
+   its DD, two checksums that match mean that, very likely, nothing in
+   the file has been added, removed or reallocated between them.  This is
+   used to validate data that is derived from the rest of the file and
+   cached in it, the cache itself being the skipped tag.
+
+--------------------------------------------------------------------------*/
+int
+HDdd_checksum(int32 file_id, uint16 skip_tag, int32 *ndds, uint32 *checksum)
+{
+    H4_API_ENTER;
+
+    filerec_t *file_rec; /* file record */
+    ddblock_t *block;    /* DD block being walked */
+    uint32     hash      = 2166136261U;
+    int32      count     = 0;
+    int        ret_value = SUCCEED;
+
+    /* clear error stack and check validity of file record id */
+    HEclear();
+    file_rec = HAatom_object(file_id);
+    if (BADFREC(file_rec) || ndds == NULL || checksum == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    for (block = file_rec->ddhead; block != NULL; block = block->next) {
+        dd_t *dd_ptr = block->ddlist;
+        int   i;
+
+        for (i = 0; i < block->ndds; i++, dd_ptr++) {
+            uint32 fields[3];
+            int    j;
+
+            if (dd_ptr->tag == DFTAG_NULL || dd_ptr->tag == skip_tag)
+                continue;
+
+            fields[0] = ((uint32)dd_ptr->tag << 16) | (uint32)dd_ptr->ref;
+            fields[1] = (uint32)dd_ptr->offset;
+            fields[2] = (uint32)dd_ptr->length;
+            for (j = 0; j < 12; j++) {
+                hash ^= (fields[j / 4] >> (8 * (j % 4))) & 0xff;
+                hash *= 16777619U;
+            }
+            count++;
+        }
+    }
+
+    *ndds     = count;
+    *checksum = hash;
+
+done:
+    return ret_value;
+} /* end HDdd_checksum */
+
 #ifdef DD_DEBUG
 /*--------------------------------------------------------------------------
  NAME
@@ -1295,18 +1426,6 @@ HTPdump_dds(int32 file_id, FILE *fout)
                 tinfo_ptr = (tag_info *)*t; /* get actual pointer to the tag info */
                 fprintf(fout, "Tag: %u\n", tinfo_ptr->tag);
 
-                /* Dump the ref # dynarray */
-                if ((size = DAsize_array(tinfo_ptr->d)) != FAIL) {
-                    void *elem;
-
-                    fprintf(fout, "dynarray size=%d\n", size);
-                    for (i = 0; i < size; i++) {
-                        elem = DAget_elem(tinfo_ptr->d, i);
-                        if (elem != NULL)
-                            fprintf(fout, "dynarray[%d]=%p\n", i, elem);
-                    } /* end for */
-                }     /* end if */
-
                 /* Dump the ref # bit-vector */
                 if ((size = bv_size(tinfo_ptr->b)) != FAIL) {
                     int bit;
@@ -1329,6 +1448,9 @@ HTPdump_dds(int32 file_id, FILE *fout)
             fprintf(fout, "No nodes in tag tree\n");
     } /* End of tag node dumping */
 
+    /* Dump the DD hash */
+    fprintf(fout, "DD hash: %u buckets, %u DDs\n", 1U << file_rec->dd_hash_bits, file_rec->dd_hash_count);
+
 done:
     return ret_value;
 } /* HTPdump_dds */
@@ -1488,23 +1610,24 @@ HTIfind_dd(filerec_t *file_rec, uint16 look_tag, uint16 look_ref, dd_t **pdd, in
 
     if (look_tag != DFTAG_WILDCARD &&
         look_ref != DFTAG_WILDCARD) { /* easy to optimize case, looking for a specific tag/ref pair */
-        tag_info **tip_ptr;           /* ptr to the ptr to the info for a tag */
-        tag_info  *tinfo_ptr;         /* pointer to the info for a tag */
-        dd_t      *dd_ptr;            /* ptr to the DD info for a tag/ref */
-        uint16     base_tag = BASETAG(look_tag); /* corresponding base tag (if the tag is special) */
-
-        /* Try to find the regular tag in the tag info tree */
-        if ((tip_ptr = (tag_info **)tbbtdfind(file_rec->tag_tree, (void *)&base_tag, NULL)) == NULL)
-            HGOTO_DONE(FAIL); /* Not an error, we just didn't find the object */
+        dd_t *dd_ptr;                 /* ptr to the DD info for a tag/ref */
 
-        tinfo_ptr = *tip_ptr; /* get the pointer to the tag info */
-        if ((dd_ptr = DAget_elem(tinfo_ptr->d, (int)look_ref)) == NULL)
+        /* Look the tag/ref up in the DD hash */
+        if ((dd_ptr = HTIhash_find(file_rec, look_tag, look_ref)) == NULL)
             HGOTO_DONE(FAIL); /* Not an error, we just didn't find the object */
 
         *pdd = dd_ptr;
         HGOTO_DONE(SUCCEED);
     }                                  /* end if */
     else {                             /* handle wildcards, etc. */
+        if (look_tag != DFTAG_WILDCARD && look_tag != DFTAG_NULL) {
+            uint16 base_tag = BASETAG(look_tag); /* corresponding base tag (if the tag is special) */
+
+            /* Don't walk the whole DD list for a tag that isn't in the file */
+            if (tbbtdfind(file_rec->tag_tree, (void *)&base_tag, NULL) == NULL)
+                HGOTO_DONE(FAIL); /* Not an error, we just didn't find the object */
+        }                          /* end if */
+
         if (direction == DF_FORWARD) { /* search forward through the DD list */
             if (*pdd == NULL) {
                 block = file_rec->ddhead;
@@ -1910,10 +2033,6 @@ HTIregister_tag_ref(filerec_t *file_rec, dd_t *dd_ptr)
         /* Yes, this is a kludge due to ref # zero not being used -QAK */
         if (bv_set(tinfo_ptr->b, 0, BV_TRUE) == FAIL)
             HGOTO_ERROR(DFE_BVSET, FAIL);
-
-        /* Take care of the dynarray */
-        if ((tinfo_ptr->d = DAcreate_array(REF_DYNARRAY_START, REF_DYNARRAY_INCR)) == NULL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
     }                /* end if */
     else {           /* found an existing tag */
         int ref_bit; /* bit of the ref # in the tag info */
@@ -1929,17 +2048,11 @@ HTIregister_tag_ref(filerec_t *file_rec, dd_t *dd_ptr)
     if (bv_set(tinfo_ptr->b, (int)dd_ptr->ref, BV_TRUE) == FAIL)
         HGOTO_ERROR(DFE_BVSET, FAIL);
 
-    /* Insert the DD info into the dynarray for later use */
-    if (DAset_elem(tinfo_ptr->d, (int)dd_ptr->ref, (void *)dd_ptr) == FAIL)
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    /* Insert the DD info into the DD hash for later use */
+    if (HTIhash_insert(file_rec, dd_ptr) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
 done:
-    if (ret_value == FAIL) { /* Error condition cleanup */
-
-        if ((tinfo_ptr != NULL) && (tinfo_ptr->d != NULL))
-            DAdestroy_array(tinfo_ptr->d, 0);
-    }
-
     return ret_value;
 } /* HTIregister_tag_ref */
 
@@ -1980,9 +2093,8 @@ HTIunregister_tag_ref(filerec_t *file_rec, dd_t *dd_ptr)
         if (bv_set(tinfo_ptr->b, (int)dd_ptr->ref, BV_FALSE) == FAIL)
             HGOTO_ERROR(DFE_BVSET, FAIL);
 
-        /* Delete the DD info from the tag tree */
-        if (DAdel_elem(tinfo_ptr->d, (int)dd_ptr->ref) == NULL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        /* Delete the DD info from the DD hash */
+        HTIhash_remove(file_rec, dd_ptr);
 
         /* Delete the tag/ref from the file */
         dd_ptr->tag = DFTAG_NULL;
@@ -1992,6 +2104,219 @@ done:
     return ret_value;
 } /* HTIunregister_tag_ref */
 
+/*--------------------------------------------------------------------------
+ NAME
+    HTIhash_init -- create the DD hash for a file
+ USAGE
+    int HTIhash_init(file_rec, nentries)
+        filerec_t  * file_rec;        IN: file record
+        int32 nentries;               IN: expected # of DDs, 0 if unknown
+ RETURNS
+    returns SUCCEED (0) if successful and FAIL (-1) if failed.
+ DESCRIPTION
+    Allocates an empty DD hash with at least one bucket per expected DD.
+    The hash doubles in size as DDs are added to it, so the expected
+    number is only a hint.
+
+--------------------------------------------------------------------------*/
+static int
+HTIhash_init(filerec_t *file_rec, int32 nentries)
+{
+    unsigned bits      = DD_HASH_START_BITS;
+    int      ret_value = SUCCEED;
+
+    while (bits < DD_HASH_MAX_BITS && ((int32)1 << bits) < nentries)
+        bits++;
+
+    file_rec->dd_hash = (dd_t **)calloc((size_t)1 << bits, sizeof(dd_t *));
+    if (file_rec->dd_hash == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    file_rec->dd_hash_bits  = bits;
+    file_rec->dd_hash_count = 0;
+
+done:
+    return ret_value;
+} /* HTIhash_init */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTIhash_find -- look up a tag/ref in the DD hash
+ USAGE
+    dd_t *HTIhash_find(file_rec, tag, ref)
+        filerec_t  * file_rec;        IN: file record
+        uint16 tag;                   IN: tag to look for (special or not)
+        uint16 ref;                   IN: ref to look for
+ RETURNS
+    returns a pointer to the DD in the DD list or NULL if there is none.
+ DESCRIPTION
+    The special and regular versions of a tag are the same object, so the
+    lookup is done on the base tag.
+
+--------------------------------------------------------------------------*/
+static dd_t *
+HTIhash_find(filerec_t *file_rec, uint16 tag, uint16 ref)
+{
+    uint16 base_tag = BASETAG(tag);
+    dd_t  *dd_ptr;
+
+    dd_ptr = file_rec->dd_hash[DD_HASH_BUCKET(file_rec->dd_hash_bits, base_tag, ref)];
+    for (; dd_ptr != NULL; dd_ptr = dd_ptr->hnext)
+        if (dd_ptr->ref == ref && BASETAG(dd_ptr->tag) == base_tag)
+            break;
+
+    return dd_ptr;
+} /* HTIhash_find */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTIhash_insert -- add a DD to the DD hash
+ USAGE
+    int HTIhash_insert(file_rec, dd_ptr)
+        filerec_t  * file_rec;        IN: file record
+        dd_t  *dd_ptr;                IN: DD to add
+ RETURNS
+    returns SUCCEED (0) if successful and FAIL (-1) if failed.
+ DESCRIPTION
+    The caller makes sure the tag/ref is not in the hash already.  When
+    there are more DDs than buckets the number of buckets is doubled.
+
+--------------------------------------------------------------------------*/
+static int
+HTIhash_insert(filerec_t *file_rec, dd_t *dd_ptr)
+{
+    unsigned bucket;
+    int      ret_value = SUCCEED;
+
+    if (file_rec->dd_hash_count >= (1U << file_rec->dd_hash_bits) &&
+        file_rec->dd_hash_bits < DD_HASH_MAX_BITS) {
+        unsigned new_bits = file_rec->dd_hash_bits + 1;
+        dd_t   **new_hash;
+        unsigned i;
+
+        if ((new_hash = (dd_t **)calloc((size_t)1 << new_bits, sizeof(dd_t *))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+        /* Move every DD over to its bucket in the new table */
+        for (i = 0; i < (1U << file_rec->dd_hash_bits); i++) {
+            dd_t *curr = file_rec->dd_hash[i];
+
+            while (curr != NULL) {
+                dd_t *next = curr->hnext;
+
+                bucket           = DD_HASH_BUCKET(new_bits, BASETAG(curr->tag), curr->ref);
+                curr->hnext      = new_hash[bucket];
+                new_hash[bucket] = curr;
+                curr             = next;
+            } /* end while */
+        }     /* end for */
+
+        free(file_rec->dd_hash);
+        file_rec->dd_hash      = new_hash;
+        file_rec->dd_hash_bits = new_bits;
+    } /* end if */
+
+    bucket                    = DD_HASH_BUCKET(file_rec->dd_hash_bits, BASETAG(dd_ptr->tag), dd_ptr->ref);
+    dd_ptr->hnext             = file_rec->dd_hash[bucket];
+    file_rec->dd_hash[bucket] = dd_ptr;
+    file_rec->dd_hash_count++;
+
+done:
+    return ret_value;
+} /* HTIhash_insert */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTIhash_remove -- remove a DD from the DD hash
+ USAGE
+    void HTIhash_remove(file_rec, dd_ptr)
+        filerec_t  * file_rec;        IN: file record
+        dd_t  *dd_ptr;                IN: DD to remove
+ RETURNS
+    none
+ DESCRIPTION
+    Must be called before the tag of the DD is changed, since the tag is
+    needed to find its bucket.
+
+--------------------------------------------------------------------------*/
+static void
+HTIhash_remove(filerec_t *file_rec, dd_t *dd_ptr)
+{
+    dd_t **pp;
+
+    pp = &file_rec->dd_hash[DD_HASH_BUCKET(file_rec->dd_hash_bits, BASETAG(dd_ptr->tag), dd_ptr->ref)];
+    for (; *pp != NULL; pp = &(*pp)->hnext)
+        if (*pp == dd_ptr) {
+            *pp = dd_ptr->hnext;
+            file_rec->dd_hash_count--;
+            break;
+        } /* end if */
+    dd_ptr->hnext = NULL;
+} /* HTIhash_remove */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTIread_dd_bytes -- read part of the DD list for HTPstart
+ USAGE
+    const uint8 *HTIread_dd_bytes(file_rec, win, off, len, ahead)
+        filerec_t  * file_rec;        IN: file record
+        dd_window_t *win;             IN/OUT: bytes of the file read so far
+        int32 off;                    IN: offset of the bytes wanted
+        int32 len;                    IN: # of bytes wanted
+        int32 ahead;                  IN: # of bytes past them worth reading
+ RETURNS
+    returns a pointer to the bytes or NULL if they could not be read.
+ DESCRIPTION
+    If the bytes are in the memory mapping of the file, or in what the
+    last read brought into the window, no I/O is done.  Otherwise the
+    window is refilled from 'off', reading up to 'ahead' extra bytes
+    (but not past the end of the file) so the next request is likely to
+    be satisfied from it.  A pointer into the window is only good until
+    the next call.
+
+--------------------------------------------------------------------------*/
+static const uint8 *
+HTIread_dd_bytes(filerec_t *file_rec, dd_window_t *win, int32 off, int32 len, int32 ahead)
+{
+    const uint8 *p;
+    int32        nread;
+    const uint8 *ret_value = NULL;
+
+    if ((p = HPmap_ptr(file_rec, off, len)) != NULL)
+        HGOTO_DONE(p);
+
+    if (win->len > 0 && off >= win->off && len <= win->len && off - win->off <= win->len - len)
+        HGOTO_DONE(win->buf + (off - win->off));
+
+    /* Read ahead only as far as the file goes */
+    if (ahead > DD_READ_AHEAD_MAX)
+        ahead = DD_READ_AHEAD_MAX;
+    if (win->file_size <= 0 || off > win->file_size || len > win->file_size - off)
+        ahead = 0;
+    else if (ahead > win->file_size - off - len)
+        ahead = win->file_size - off - len;
+    nread = len + ahead;
+
+    if ((size_t)nread > win->buf_size) {
+        uint8 *new_buf;
+
+        if ((new_buf = (uint8 *)realloc(win->buf, (size_t)nread)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+        win->buf      = new_buf;
+        win->buf_size = (size_t)nread;
+    } /* end if */
+
+    win->len = 0;
+    if (HPread_at(file_rec, off, win->buf, nread) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, NULL);
+    win->off = off;
+    win->len = nread;
+
+    ret_value = win->buf;
+
+done:
+    return ret_value;
+} /* HTIread_dd_bytes */
+
 /* ---------------------------- tagcompare ------------------------- */
 /*
    Compares two tag B-tree keys for equality.  Similar to memcmp.
@@ -2023,7 +2348,5 @@ tagdestroynode(void *n)
 
     if (t->b != NULL)
         bv_delete(t->b);
-    if (t->d != NULL)
-        DAdestroy_array(t->d, 0);
     free(n);
 } /* tagdestroynode */
@@ -145,13 +145,16 @@ DESCRIPTION
 int
 HDflush(int32 file_id)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec;
 
     file_rec = HAatom_object(file_id);
     if (BADFREC(file_rec))
         HRETURN_ERROR(DFE_ARGS, FAIL);
 
-    HI_FLUSH(file_rec->file);
+    if (HI_FLUSH(file_rec->file) == FAIL)
+        HRETURN_ERROR(DFE_WRITEERROR, FAIL);
 
     return SUCCEED;
 } /* HDflush */
@@ -317,6 +320,8 @@ DESCRIPTION
 const char *
 HDfidtoname(int32 file_id)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec;
 
     if ((file_rec = HAatom_object(file_id)) == NULL)
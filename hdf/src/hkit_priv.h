@@ -100,6 +100,7 @@ static const tag_descript_t tag_descriptions[] = {
     {DFTAG_NDG, string(DFTAG_NDG), "Numeric Data Group"},
     {DFTAG_CAL, string(DFTAG_CAL), "Calibration information"},
     {DFTAG_FV, string(DFTAG_FV), "Fill value information"},
+    {DFTAG_SDCAT, string(DFTAG_SDCAT), "SciData catalog"},
 
     /* V Group Tags */
     {DFTAG_VG, string(DFTAG_VG), "Vgroup"},
@@ -258,6 +258,11 @@ changing the class name variable declaration much easier - BMR 4/1/02*/
 #define _HDF_CHK_TBL_CLASS     "_HDF_CHK_TBL_" /* 13 bytes */
 #define _HDF_CHK_TBL_CLASS_VER 0               /* zero version number for class */
 
+/* The class of the vdatas holding the index of a vdata field (see
+   VSbuildindex) is this name followed by the ref of the vdata; their
+   name is that class, a dot and the name of the field. */
+#define _HDF_VSINDEX_CLASS "_HDF_VSINDEX_" /* 13 bytes */
+
 /*
 #define NUM_INTERNAL_VGS    6
 char *INTERNAL_HDF_VGS[] = {_HDF_VARIABLE, _HDF_DIMENSION, _HDF_UDIMENSION,
@@ -109,6 +109,10 @@ HDFLIBAPI int Hsync(int32 file_id);
 
 HDFLIBAPI int Hcache(int32 file_id, int cache_on);
 
+HDFLIBAPI int Hsetnddshint(int32 ndds);
+
+HDFLIBAPI int Hsetchunkcachebudget(int32 file_id, int32 bytes);
+
 HDFLIBAPI int Hgetlibversion(uint32 *majorv, uint32 *minorv, uint32 *releasev, char *string);
 
 HDFLIBAPI int Hgetfileversion(int32 file_id, uint32 *majorv, uint32 *minorv, uint32 *release, char *string);
@@ -139,6 +143,8 @@ HDFLIBAPI int Hgetntinfo(int32 numbertype, hdf_ntinfo_t *nt_info);
 
 HDFLIBAPI int Hishdf(const char *filename);
 
+HDFLIBAPI int Histhreadsafe(void);
+
 HDFLIBAPI int Hfidinquire(int32 file_id, char **fname, int *acc_mode, int *attach);
 
 HDFLIBAPI int Hshutdown(void);
@@ -147,6 +153,13 @@ HDFLIBAPI void HPend(void);
 
 HDFLIBAPI int HDdont_atexit(void);
 
+/*
+ ** from hasync.c
+ */
+HDFLIBAPI int Hasyncwait(void);
+
+HDFLIBAPI int Hsetasyncthreads(int nthreads);
+
 /*
  ** from hfiledd.c
  */
@@ -317,6 +330,25 @@ HDFLIBAPI int Hdeldd(int32  file_id, /* IN: File ID the tag/refs are in */
                      uint16 ref      /* IN: Ref of tag/ref to delete */
 );
 
+/******************************************************************************
+ NAME
+     HDdd_checksum - Compute a checksum of the DD list
+
+ DESCRIPTION
+    Computes a checksum of the tag, ref, offset and length of every DD in
+    the file, leaving out empty DDs and DDs with tag skip_tag, and returns
+    it with the number of DDs it covers.  No I/O is done.
+
+ RETURNS
+    returns SUCCEED (0) if successful, FAIL (-1) otherwise
+
+*******************************************************************************/
+HDFLIBAPI int HDdd_checksum(int32   file_id,  /* IN: File ID the tag/refs are in */
+                            uint16  skip_tag, /* IN: Tag of DDs to leave out */
+                            int32  *ndds,     /* OUT: Number of DDs counted */
+                            uint32 *checksum  /* OUT: Checksum of the DDs counted */
+);
+
 /*
  ** from hdfalloc.c
  */
@@ -376,6 +408,13 @@ HDFLIBAPI int HCPgetcomptype(int32 file_id, uint16 data_tag, uint16 data_ref, co
 HDFLIBAPI int HCPgetdatasize(int32 file_id, uint16 data_tag, uint16 data_ref, int32 *comp_size,
                              int32 *orig_size);
 
+HDFLIBAPI int HCPgetcompref(int32 file_id, uint16 data_tag, uint16 data_ref, comp_model_t *model_type,
+                            comp_coder_t *coder_type, uint16 *comp_ref, int32 *orig_size);
+
+HDFLIBAPI int HCPwrite_encoded(int32 file_id, uint16 tag, uint16 ref, comp_model_t model_type,
+                               model_info *m_info, comp_coder_t coder_type, comp_info *c_info, int32 length,
+                               const void *data, int32 data_len);
+
 HDFPUBLIC int HCget_config_info(comp_coder_t coder_type, uint32 *compression_config_info);
 
 HDFLIBAPI int32 HCPquery_encode_header(comp_model_t model_type, model_info *m_info, comp_coder_t coder_type,
@@ -817,6 +856,8 @@ HDFLIBAPI int32 DFKisnativeNT(int32 numbertype);
 
 HDFLIBAPI int32 DFKislitendNT(int32 numbertype);
 
+HDFLIBAPI int32 DFKiscopyNT(int32 numbertype);
+
 HDFLIBAPI int8 DFKgetPNSC(int32 numbertype, int32 machinetype);
 
 HDFLIBAPI int DFKsetNT(int32 ntype);
@@ -910,6 +951,9 @@ HDFLIBAPI int GRwriteimage(int32 riid, int32 start[2], int32 stride[2], int32 co
 
 HDFLIBAPI int GRreadimage(int32 riid, int32 start[2], int32 stride[2], int32 count[2], void *data);
 
+HDFLIBAPI int GRreadimage_async(int32 riid, int32 start[2], int32 stride[2], int32 count[2], void *data,
+                                hdf_asyncfunc_t callback, void *ctx);
+
 HDFLIBAPI int GRendaccess(int32 riid);
 
 HDFLIBAPI uint16 GRidtoref(int32 riid);
@@ -1327,6 +1371,10 @@ HDFLIBAPI int32 Vfindclass(HFILEID f, const char *vgclass);
 
 HDFLIBAPI int32 VSfindclass(HFILEID f, const char *vsclass);
 
+HDFLIBAPI int32 Vfindmany(HFILEID f, int32 n, const char *const vgnames[], int32 refs[]);
+
+HDFLIBAPI int32 VSfindmany(HFILEID f, int32 n, const char *const vsnames[], int32 refs[]);
+
 HDFLIBAPI int VSofclass(int32 id, const char *vsclass, unsigned start_vd, unsigned array_size,
                         uint16 *refarray);
 
@@ -1524,8 +1572,19 @@ HDFLIBAPI int32 VSseek(int32 vkey, int32 eltpos);
 
 HDFLIBAPI int32 VSread(int32 vkey, uint8 buf[], int32 nelt, int32 interlace);
 
+HDFLIBAPI int32 VSreadcolumns(int32 vkey, int32 nfields, const int32 field_idx[], void *bufs[], int32 start,
+                              int32 nrecs);
+
 HDFLIBAPI int32 VSwrite(int32 vkey, const uint8 buf[], int32 nelt, int32 interlace);
 
+/*
+ ** from vsindex.c
+ */
+HDFLIBAPI int VSbuildindex(int32 vkey, const char *fieldname);
+
+HDFLIBAPI int32 VSselect(int32 vkey, const char *fieldname, float64 lo, float64 hi, int32 recnums[],
+                         int32 maxrecs);
+
 #ifdef __cplusplus
 }
 #endif
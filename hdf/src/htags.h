@@ -102,6 +102,7 @@
                                   /* tag 721 reserved chouck 24-Nov-93 */
 #define DFTAG_CAL   ((uint16)731) /* Calibration information */
 #define DFTAG_FV    ((uint16)732) /* Fill Value information */
+#define DFTAG_SDCAT ((uint16)733) /* SD catalog (cached SD metadata) */
 #define DFTAG_BREQ  ((uint16)799) /* Beginning of required tags   */
 #define DFTAG_SDRAG ((uint16)781) /* List of ragged array line lengths */
 #define DFTAG_EREQ  ((uint16)780) /* Current end of the range   */
@@ -0,0 +1,252 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    hthread.c
+ * Purpose: Pools of worker threads
+ *
+ * A pool of N threads starts N - 1 worker threads; the thread that calls
+ * HTHpool_run() works on the batch too.  The workers sleep between
+ * batches and are stopped by HTHpool_destroy().
+ *
+ * Invokes: pthreads
+ * Contents:
+ *   HTHpool_create   - create a pool of threads
+ *   HTHpool_nthreads - number of threads of a pool
+ *   HTHpool_run      - run a batch of tasks and wait for them
+ *   HTHpool_destroy  - stop the threads and free a pool
+ *---------------------------------------------------------------------------*/
+
+#include "hdf_priv.h"
+#include "hthread_priv.h"
+
+#ifdef H4_HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+struct hthread_pool_t {
+    int nthreads; /* threads working on a batch, including the caller */
+#ifdef H4_HAVE_PTHREAD
+    pthread_t      *workers;  /* the nthreads - 1 worker threads */
+    int             nworkers; /* number of workers started */
+    pthread_mutex_t lock;     /* protects everything below */
+    pthread_cond_t  work;     /* signaled when a batch starts or the pool stops */
+    pthread_cond_t  done;     /* signaled when the last task of a batch is done */
+    hthread_func_t  func;     /* task function of the current batch, NULL if none */
+    void           *arg;      /* argument of the current batch */
+    int             ntasks;   /* number of tasks in the current batch */
+    int             next;     /* next task to hand out */
+    int             ndone;    /* number of tasks finished */
+    int             stop;     /* TRUE when the workers should exit */
+#endif
+};
+
+#ifdef H4_HAVE_PTHREAD
+/* Take tasks of the current batch until there are none left.  Called with
+   the lock held, returns with the lock held. */
+static void
+HTHIrun_tasks(hthread_pool_t *pool)
+{
+    while (pool->func != NULL && pool->next < pool->ntasks) {
+        hthread_func_t func = pool->func;
+        void          *arg  = pool->arg;
+        int            task = pool->next++;
+
+        pthread_mutex_unlock(&pool->lock);
+        func(arg, task);
+        pthread_mutex_lock(&pool->lock);
+
+        if (++pool->ndone == pool->ntasks)
+            pthread_cond_signal(&pool->done);
+    }
+}
+
+/* Body of the worker threads */
+static void *
+HTHIworker(void *arg)
+{
+    hthread_pool_t *pool = (hthread_pool_t *)arg;
+
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stop) {
+        if (pool->func != NULL && pool->next < pool->ntasks)
+            HTHIrun_tasks(pool);
+        else
+            pthread_cond_wait(&pool->work, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+#endif /* H4_HAVE_PTHREAD */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTHpool_create -- create a pool of threads
+ USAGE
+    hthread_pool_t *HTHpool_create(nthreads)
+        int nthreads;       IN: number of threads, including the caller
+ RETURNS
+    The new pool, or NULL on failure
+ DESCRIPTION
+    Starts nthreads - 1 worker threads, at most HTH_MAX_THREADS - 1.
+    Without POSIX threads, or if no worker can be started, the pool has
+    a single thread and runs its tasks in the calling thread.
+--------------------------------------------------------------------------*/
+hthread_pool_t *
+HTHpool_create(int nthreads)
+{
+    hthread_pool_t *pool      = NULL;
+    hthread_pool_t *ret_value = NULL;
+
+    if (nthreads < 1)
+        HGOTO_ERROR(DFE_ARGS, NULL);
+    if (nthreads > HTH_MAX_THREADS)
+        nthreads = HTH_MAX_THREADS;
+
+    if ((pool = (hthread_pool_t *)calloc(1, sizeof(hthread_pool_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, NULL);
+    pool->nthreads = 1;
+
+#ifdef H4_HAVE_PTHREAD
+    if (nthreads > 1) {
+        if ((pool->workers = (pthread_t *)malloc((size_t)(nthreads - 1) * sizeof(pthread_t))) == NULL) {
+            free(pool);
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+        }
+        pthread_mutex_init(&pool->lock, NULL);
+        pthread_cond_init(&pool->work, NULL);
+        pthread_cond_init(&pool->done, NULL);
+
+        /* a pool with fewer workers than asked for still works */
+        while (pool->nworkers < nthreads - 1 &&
+               pthread_create(&pool->workers[pool->nworkers], NULL, HTHIworker, pool) == 0)
+            pool->nworkers++;
+        pool->nthreads = pool->nworkers + 1;
+    }
+#else
+    (void)nthreads;
+#endif
+
+    ret_value = pool;
+
+done:
+    return ret_value;
+} /* HTHpool_create */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTHpool_nthreads -- number of threads of a pool
+ USAGE
+    int HTHpool_nthreads(pool)
+        const hthread_pool_t *pool;     IN: pool
+ RETURNS
+    The number of threads working on a batch, including the caller
+--------------------------------------------------------------------------*/
+int
+HTHpool_nthreads(const hthread_pool_t *pool)
+{
+    return pool != NULL ? pool->nthreads : 1;
+} /* HTHpool_nthreads */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTHpool_run -- run a batch of tasks and wait for them
+ USAGE
+    int HTHpool_run(pool, func, arg, ntasks)
+        hthread_pool_t *pool;   IN: pool
+        hthread_func_t func;    IN: task function
+        void *arg;              IN: argument passed to every task
+        int ntasks;             IN: number of tasks
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Calls func(arg, task) once for every task from 0 to ntasks - 1, in no
+    particular order and on any of the threads of the pool, and returns
+    when all the calls have returned.  Tasks report their own results
+    through 'arg'.  Only one thread may run batches on a pool.
+--------------------------------------------------------------------------*/
+int
+HTHpool_run(hthread_pool_t *pool, hthread_func_t func, void *arg, int ntasks)
+{
+    int ret_value = SUCCEED;
+
+    if (pool == NULL || func == NULL || ntasks < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+#ifdef H4_HAVE_PTHREAD
+    if (pool->nthreads > 1 && ntasks > 1) {
+        pthread_mutex_lock(&pool->lock);
+        pool->func   = func;
+        pool->arg    = arg;
+        pool->ntasks = ntasks;
+        pool->next   = 0;
+        pool->ndone  = 0;
+        pthread_cond_broadcast(&pool->work);
+
+        HTHIrun_tasks(pool);
+        while (pool->ndone < pool->ntasks)
+            pthread_cond_wait(&pool->done, &pool->lock);
+
+        pool->func = NULL;
+        pool->arg  = NULL;
+        pthread_mutex_unlock(&pool->lock);
+    }
+    else
+#endif
+    {
+        int task;
+
+        for (task = 0; task < ntasks; task++)
+            func(arg, task);
+    }
+
+done:
+    return ret_value;
+} /* HTHpool_run */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTHpool_destroy -- stop the threads and free a pool
+ USAGE
+    void HTHpool_destroy(pool)
+        hthread_pool_t *pool;   IN: pool, not running a batch
+ RETURNS
+    Nothing
+--------------------------------------------------------------------------*/
+void
+HTHpool_destroy(hthread_pool_t *pool)
+{
+    if (pool == NULL)
+        return;
+
+#ifdef H4_HAVE_PTHREAD
+    if (pool->workers != NULL) {
+        int i;
+
+        pthread_mutex_lock(&pool->lock);
+        pool->stop = TRUE;
+        pthread_cond_broadcast(&pool->work);
+        pthread_mutex_unlock(&pool->lock);
+
+        for (i = 0; i < pool->nworkers; i++)
+            pthread_join(pool->workers[i], NULL);
+
+        pthread_cond_destroy(&pool->done);
+        pthread_cond_destroy(&pool->work);
+        pthread_mutex_destroy(&pool->lock);
+        free(pool->workers);
+    }
+#endif
+
+    free(pool);
+} /* HTHpool_destroy */
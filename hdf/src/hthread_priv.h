@@ -0,0 +1,54 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    hthread_priv.h
+ * Purpose: Pools of worker threads
+ * Dependencies: hdf_priv.h
+ * Contents: A pool runs a batch of independent tasks on its threads and the
+ *           calling thread, and returns when all of them are done.  Tasks
+ *           must not call into the library: nothing else in it is safe to
+ *           use from more than one thread, including the error stack.
+ *           Without POSIX threads a pool runs its tasks one after the other
+ *           in the calling thread.
+ *---------------------------------------------------------------------------*/
+
+#ifndef H4_HTHREAD_PRIV_H
+#define H4_HTHREAD_PRIV_H
+
+#include "hdf_priv.h"
+
+/* Most threads a pool can have, including the calling thread */
+#define HTH_MAX_THREADS 64
+
+typedef struct hthread_pool_t hthread_pool_t;
+
+/* A task: 'task' runs from 0 to the number of tasks in the batch - 1 */
+typedef void (*hthread_func_t)(void *arg, int task);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+HDFLIBAPI hthread_pool_t *HTHpool_create(int nthreads);
+
+HDFLIBAPI int HTHpool_nthreads(const hthread_pool_t *pool);
+
+HDFLIBAPI int HTHpool_run(hthread_pool_t *pool, hthread_func_t func, void *arg, int ntasks);
+
+HDFLIBAPI void HTHpool_destroy(hthread_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H4_HTHREAD_PRIV_H */
@@ -0,0 +1,267 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    hts.c
+ * Purpose: Thread-safe library mode
+ *
+ * In a thread-safe build, the public routines take the API lock, which
+ * keeps the library state shared by all the threads (open files, atoms,
+ * free lists) from changing under them.  Most routines take it
+ * exclusively and so run one at a time.  The routines that only read a
+ * file share it and lock their file instead: they run in parallel with
+ * the readers of the other files, and the few structures they change
+ * besides their file have locks of their own.  The API lock is
+ * recursive, and a routine called from another one runs under the lock
+ * of its caller.  What each thread needs for itself, its error stack and
+ * scratch buffers, is kept in thread-local storage; the buffers are
+ * freed when their thread exits.
+ *
+ * Invokes: pthreads
+ * Contents:
+ *   Histhreadsafe       - whether the library was built thread-safe
+ *   HTSapi_enter        - take the API lock
+ *   HTSapi_enter_shared - share the API lock
+ *   HTSapi_leave        - release the API lock
+ *   HTSfile_lock        - lock the file of a routine sharing the API lock
+ *   HTSfile_unlock      - unlock it
+ *   HTSfree_at_exit     - free a thread-local buffer when the thread exits
+ *---------------------------------------------------------------------------*/
+
+#include "hdf_priv.h"
+#include "atom_priv.h"
+#include "hfile_priv.h"
+
+#ifdef H4_HAVE_THREADSAFE
+
+/* Most thread-local buffers a thread can register */
+#define HTS_MAX_BUFS 16
+
+/* The thread-local buffers a thread registered */
+typedef struct hts_bufs_t {
+    int    nbufs;
+    void **bufs[HTS_MAX_BUFS];
+} hts_bufs_t;
+
+static pthread_once_t   hts_once = PTHREAD_ONCE_INIT;
+static pthread_rwlock_t hts_lock;
+static pthread_key_t    hts_bufs_key;
+
+/* Lock of the files that have no file record (netCDF files) */
+static pthread_mutex_t hts_nofile_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static H4_THREAD_LOCAL int         hts_depth  = 0;     /* nesting of the public routines */
+static H4_THREAD_LOCAL int         hts_shared = FALSE; /* whether the API lock is shared */
+static H4_THREAD_LOCAL hts_bufs_t *hts_bufs   = NULL;
+
+/* Free the buffers of an exiting thread */
+static void
+HTSIfree_bufs(void *arg)
+{
+    hts_bufs_t *bufs = (hts_bufs_t *)arg;
+    int         i;
+
+    for (i = 0; i < bufs->nbufs; i++) {
+        free(*bufs->bufs[i]);
+        *bufs->bufs[i] = NULL;
+    }
+    free(bufs);
+}
+
+/* Create the lock and the key, once */
+static void
+HTSIinit(void)
+{
+    pthread_rwlock_init(&hts_lock, NULL);
+    pthread_key_create(&hts_bufs_key, HTSIfree_bufs);
+}
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTSapi_enter -- take the API lock
+ USAGE
+    int HTSapi_enter()
+ RETURNS
+    TRUE, to be handed back to HTSapi_leave()
+ DESCRIPTION
+    Used through H4_API_ENTER.  Only the outermost public routine of a
+    thread takes the lock, so public routines may call each other; they
+    then run under the lock of the outermost one, shared or not.
+--------------------------------------------------------------------------*/
+int
+HTSapi_enter(void)
+{
+    if (hts_depth++ == 0) {
+        pthread_once(&hts_once, HTSIinit);
+        pthread_rwlock_wrlock(&hts_lock);
+        hts_shared = FALSE;
+    }
+    return TRUE;
+} /* HTSapi_enter */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTSapi_enter_shared -- share the API lock
+ USAGE
+    int HTSapi_enter_shared()
+ RETURNS
+    TRUE, to be handed back to HTSapi_leave()
+ DESCRIPTION
+    Used through H4_API_ENTER_SHARED, by the routines that only read the
+    file they are given.  Until it is locked with HTSfile_lock(), such a
+    routine may only look up its arguments.
+--------------------------------------------------------------------------*/
+int
+HTSapi_enter_shared(void)
+{
+    if (hts_depth++ == 0) {
+        pthread_once(&hts_once, HTSIinit);
+        pthread_rwlock_rdlock(&hts_lock);
+        hts_shared = TRUE;
+    }
+    return TRUE;
+} /* HTSapi_enter_shared */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTSapi_leave -- release the API lock
+ USAGE
+    void HTSapi_leave(entered)
+        int *entered;       IN: set by HTSapi_enter()
+ RETURNS
+    Nothing
+ DESCRIPTION
+    Called by the compiler when the variable declared by H4_API_ENTER goes
+    out of scope.
+--------------------------------------------------------------------------*/
+void
+HTSapi_leave(int *entered)
+{
+    if (*entered && --hts_depth == 0)
+        pthread_rwlock_unlock(&hts_lock);
+} /* HTSapi_leave */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTSfile_lock -- lock the file of a routine sharing the API lock
+ USAGE
+    void HTSfile_lock(held, file_id)
+        pthread_mutex_t **held;     IN/OUT: the file lock held by the routine
+        int32 file_id;              IN: HDF file ID, or FAIL for a netCDF file
+ RETURNS
+    Nothing
+ DESCRIPTION
+    Used through H4_API_LOCK_FILE.  Does nothing unless the routine is
+    the outermost one of its thread and shares the API lock: otherwise
+    the lock it runs under already keeps the other threads away.  All
+    the netCDF files share one lock.
+--------------------------------------------------------------------------*/
+void
+HTSfile_lock(pthread_mutex_t **held, int32 file_id)
+{
+    filerec_t *file_rec = NULL;
+
+    if (hts_depth != 1 || !hts_shared || *held != NULL)
+        return;
+
+    if (file_id != FAIL)
+        file_rec = HAatom_object(file_id);
+    *held = (file_rec != NULL ? &file_rec->lock : &hts_nofile_lock);
+    pthread_mutex_lock(*held);
+} /* HTSfile_lock */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTSfile_unlock -- unlock the file locked by HTSfile_lock
+ USAGE
+    void HTSfile_unlock(held)
+        pthread_mutex_t **held;     IN: the file lock held by the routine
+ RETURNS
+    Nothing
+ DESCRIPTION
+    Called by the compiler when the variable declared by
+    H4_API_ENTER_SHARED goes out of scope.
+--------------------------------------------------------------------------*/
+void
+HTSfile_unlock(pthread_mutex_t **held)
+{
+    if (*held != NULL)
+        pthread_mutex_unlock(*held);
+} /* HTSfile_unlock */
+
+/*--------------------------------------------------------------------------
+ NAME
+    HTSfree_at_exit -- free a thread-local buffer when the thread exits
+ USAGE
+    int HTSfree_at_exit(bufp)
+        void **bufp;        IN: address of a H4_THREAD_LOCAL pointer
+ RETURNS
+    SUCCEED/FAIL
+ DESCRIPTION
+    Used through H4_FREE_AT_THREAD_EXIT right after the buffer is
+    allocated.  Registering the same pointer again does nothing, so
+    buffers that are reallocated need not be tracked by the caller.
+    The main thread's buffers are left to the *Pshutdown routines.
+--------------------------------------------------------------------------*/
+int
+HTSfree_at_exit(void **bufp)
+{
+    int i;
+    int ret_value = SUCCEED;
+
+    pthread_once(&hts_once, HTSIinit);
+
+    if (hts_bufs == NULL) {
+        if ((hts_bufs = (hts_bufs_t *)calloc(1, sizeof(hts_bufs_t))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (pthread_setspecific(hts_bufs_key, hts_bufs) != 0) {
+            free(hts_bufs);
+            hts_bufs = NULL;
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        }
+    }
+
+    for (i = 0; i < hts_bufs->nbufs; i++)
+        if (hts_bufs->bufs[i] == bufp)
+            HGOTO_DONE(SUCCEED);
+
+    if (hts_bufs->nbufs == HTS_MAX_BUFS)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    hts_bufs->bufs[hts_bufs->nbufs++] = bufp;
+
+done:
+    return ret_value;
+} /* HTSfree_at_exit */
+#endif /* H4_HAVE_THREADSAFE */
+
+/*--------------------------------------------------------------------------
+ NAME
+    Histhreadsafe -- whether the library was built thread-safe
+ USAGE
+    int Histhreadsafe()
+ RETURNS
+    TRUE if the library was configured with --enable-threadsafe,
+    FALSE otherwise
+ DESCRIPTION
+    A thread-safe library may be called from several threads at once.
+    The calls are serialized, except reads of different files, which
+    run in parallel; each thread has its own error stack.
+--------------------------------------------------------------------------*/
+int
+Histhreadsafe(void)
+{
+#ifdef H4_HAVE_THREADSAFE
+    return TRUE;
+#else
+    return FALSE;
+#endif
+} /* Histhreadsafe */
@@ -0,0 +1,105 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*-----------------------------------------------------------------------------
+ * File:    hts_priv.h
+ * Purpose: Thread-safe library mode
+ * Dependencies: hdf.h
+ * Contents: When the library is configured with --enable-threadsafe
+ *           (HDF4_ENABLE_THREADSAFE in CMake), every public routine starts
+ *           with H4_API_ENTER, which takes the API lock exclusively and
+ *           releases it when the routine returns, however it returns.
+ *           Routines that only read a file start with H4_API_ENTER_SHARED
+ *           instead, and call H4_API_LOCK_FILE once they know the file:
+ *           they share the API lock and hold the lock of their file, so
+ *           that threads reading different files run in parallel.  The
+ *           state these routines share across files (atom groups, free
+ *           lists) has its own locks, taken with the H4_MUTEX_* macros,
+ *           or is read without a lock with H4_ATOMIC_*.  The error stack
+ *           and the scratch conversion buffers are H4_THREAD_LOCAL, and
+ *           the buffers are registered with H4_FREE_AT_THREAD_EXIT so that
+ *           they are freed when their thread exits.  In the default build
+ *           all the macros expand to nothing.
+ *---------------------------------------------------------------------------*/
+
+#ifndef H4_HTS_PRIV_H
+#define H4_HTS_PRIV_H
+
+#include "hdf.h"
+
+#ifdef H4_HAVE_THREADSAFE
+#include <pthread.h>
+
+/* Storage class of the per-thread library state */
+#define H4_THREAD_LOCAL __thread
+
+/* Take the API lock until the enclosing function returns */
+#define H4_API_ENTER                                                                                         \
+    int H4_api_entered_ __attribute__((cleanup(HTSapi_leave), unused)) = HTSapi_enter()
+
+/* Share the API lock until the enclosing function returns; the file lock
+   taken by H4_API_LOCK_FILE is released at the same time */
+#define H4_API_ENTER_SHARED                                                                                  \
+    int H4_api_entered_ __attribute__((cleanup(HTSapi_leave), unused)) = HTSapi_enter_shared();             \
+    pthread_mutex_t *H4_api_file_ __attribute__((cleanup(HTSfile_unlock), unused)) = NULL
+
+/* Lock the file of a routine started with H4_API_ENTER_SHARED */
+#define H4_API_LOCK_FILE(file_id) HTSfile_lock(&H4_api_file_, (int32)(file_id))
+
+/* Free the thread-local buffer *bufp, and set it to NULL, when the thread exits */
+#define H4_FREE_AT_THREAD_EXIT(bufp) HTSfree_at_exit((void **)(bufp))
+
+/* Internal locks of the state shared by all the files */
+#define H4_MUTEX_LOCK(m)   pthread_mutex_lock(m)
+#define H4_MUTEX_UNLOCK(m) pthread_mutex_unlock(m)
+
+/* Words read without a lock while other threads may write them */
+#define H4_ATOMIC_LOAD(p)     __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define H4_ATOMIC_STORE(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+
+#else /* H4_HAVE_THREADSAFE */
+
+#define H4_THREAD_LOCAL
+#define H4_API_ENTER                 ((void)0)
+#define H4_API_ENTER_SHARED          ((void)0)
+#define H4_API_LOCK_FILE(file_id)    ((void)0)
+#define H4_FREE_AT_THREAD_EXIT(bufp) ((void)0)
+#define H4_MUTEX_LOCK(m)             ((void)0)
+#define H4_MUTEX_UNLOCK(m)           ((void)0)
+#define H4_ATOMIC_LOAD(p)            (*(p))
+#define H4_ATOMIC_STORE(p, v)        (*(p) = (v))
+
+#endif /* H4_HAVE_THREADSAFE */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef H4_HAVE_THREADSAFE
+HDFLIBAPI int HTSapi_enter(void);
+
+HDFLIBAPI int HTSapi_enter_shared(void);
+
+HDFLIBAPI void HTSapi_leave(int *entered);
+
+HDFLIBAPI void HTSfile_lock(pthread_mutex_t **held, int32 file_id);
+
+HDFLIBAPI void HTSfile_unlock(pthread_mutex_t **held);
+
+HDFLIBAPI int HTSfree_at_exit(void **bufp);
+#endif /* H4_HAVE_THREADSAFE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H4_HTS_PRIV_H */
@@ -57,6 +57,10 @@
 static BKT *mcache_bkt(MCACHE *mp);
 static BKT *mcache_look(MCACHE *mp, int32 pgno);
 static int  mcache_write(MCACHE *mp, BKT *bkt);
+static int  mcache_write_batch(MCACHE *mp, BKT **bps, int32 nbps);
+static int  mcache_write_behind(MCACHE *mp, BKT *bp);
+static int  mcache_evict(BKT *bp);
+static void mcache_free_page(BKT *bp);
 
 /******************************************************************************
 NAME
@@ -146,6 +150,103 @@ mcache_get_pagesize(MCACHE *mp /* IN: MCACHE cookie */)
         return 0;
 } /* mcache_get_pagesize */
 
+/******************************************************************************
+NAME
+   mcache_pool_create -- Create a pool of pages for the caches of a file
+
+DESCRIPTION
+   Create an empty pool, with no limit on the memory held by its pages.
+   Caches are added to the pool by passing it to mcache_open().
+
+RETURNS
+   A pool if successful else NULL
+******************************************************************************/
+MCACHE_POOL *
+mcache_pool_create(void)
+{
+    MCACHE_POOL *pool = NULL;
+
+    if ((pool = (MCACHE_POOL *)calloc(1, sizeof(MCACHE_POOL))) == NULL) {
+        HERROR(DFE_NOSPACE);
+        return NULL;
+    }
+    H4_CIRCLEQ_INIT(&pool->pqh);
+
+    return pool;
+} /* mcache_pool_create() */
+
+/******************************************************************************
+NAME
+   mcache_pool_set_budget -- Limit the memory held by the pages of a pool
+
+DESCRIPTION
+   Sets the maximum number of bytes held by the pages of all the caches
+   in the pool, 0 meaning no limit.  If the pool already holds more than
+   that, the least recently used unpinned pages are written out (if dirty)
+   and freed right away.
+
+   Pages are never freed while pinned, and a cache that needs a page when
+   nothing can be freed grows anyway, so the budget can be exceeded for a
+   short while.
+
+RETURNS
+   RET_SUCCESS if successful and RET_ERROR otherwise
+******************************************************************************/
+int
+mcache_pool_set_budget(MCACHE_POOL *pool, /* IN: pool */
+                       int32        budget /* IN: max bytes of cached pages, 0 for no limit */)
+{
+    BKT *bp        = NULL; /* bucket element */
+    int  ret_value = RET_SUCCESS;
+
+    /* check inputs */
+    if (pool == NULL || budget < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    pool->budget = budget;
+
+    /* Free least recently used pages until under the new budget */
+    while (pool->budget > 0 && pool->used > pool->budget) {
+        for (bp = pool->pqh.cqh_first; bp != (void *)&pool->pqh; bp = bp->pq.cqe_next)
+            if (!(bp->flags & MCACHE_PINNED))
+                break;
+        if (bp == (void *)&pool->pqh)
+            break; /* everything left is pinned */
+
+        if (mcache_evict(bp) == RET_ERROR)
+            HE_REPORT_GOTO("unable to flush a dirty page", FAIL);
+        mcache_free_page(bp);
+    }
+
+done:
+    return ret_value;
+} /* mcache_pool_set_budget() */
+
+/******************************************************************************
+NAME
+   mcache_pool_close -- Free a pool of pages
+
+DESCRIPTION
+   Free a pool.  All the caches using it must have been closed.
+
+RETURNS
+   RET_SUCCESS if successful and RET_ERROR otherwise
+******************************************************************************/
+int
+mcache_pool_close(MCACHE_POOL *pool /* IN: pool with no caches left */)
+{
+    int ret_value = RET_SUCCESS;
+
+    /* check inputs */
+    if (pool == NULL || pool->pqh.cqh_first != (void *)&pool->pqh)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    free(pool);
+
+done:
+    return ret_value;
+} /* mcache_pool_close() */
+
 /******************************************************************************
 NAME
    mcache_open -- Open a memory pool on the given object
@@ -154,21 +255,24 @@ DESCRIPTION
    Initialize a memory pool for object using the given pagesize
    and size of object.
 
+   If 'pool' is not NULL the pages of this cache are also threaded on the
+   lru chain of the pool, and count against the budget of the pool.
+
+   The hash tables are sized from the number of pages in the object, so
+   that looking up a page stays cheap for objects with many pages.
+
    Note for 'flags' input only '0' should be used for now.
 
 RETURNS
    A memory pool cookie if successful else NULL
-
-NOTE:
-      The key string byte for sharing buffers is not implemented.
 ******************************************************************************/
 MCACHE *
-mcache_open(void *key,       /* IN: byte string used as handle to share buffers */
-            int32 object_id, /* IN: object handle */
-            int32 pagesize,  /* IN: chunk size in bytes  */
-            int32 maxcache,  /* IN: maximum number of pages to cache at any time */
-            int32 npages,    /* IN: number of chunks currently in object */
-            int32 flags /* IN: 0= object exists, 1= does not exist  */)
+mcache_open(MCACHE_POOL *pool,      /* IN: pool shared with other caches, or NULL */
+            int32        object_id, /* IN: object handle */
+            int32        pagesize,  /* IN: chunk size in bytes  */
+            int32        maxcache,  /* IN: maximum number of pages to cache at any time */
+            int32        npages,    /* IN: number of chunks currently in object */
+            int32        flags /* IN: 0= object exists, 1= does not exist  */)
 {
     struct _lhqh *lhead     = NULL; /* head of an entry in list hash chain */
     MCACHE       *mp        = NULL; /* MCACHE cookie */
@@ -177,8 +281,6 @@ mcache_open(void *key,       /* IN: byte string used as handle to share buffers
     int           entry; /* index into hash table */
     int32         pageno;
 
-    (void)key;
-
     /* Set the pagesize and max # of pages to cache */
     if (pagesize == 0)
         pagesize = (int32)DEF_PAGESIZE;
@@ -189,8 +291,17 @@ mcache_open(void *key,       /* IN: byte string used as handle to share buffers
     if ((mp = (MCACHE *)calloc(1, sizeof(MCACHE))) == NULL)
         HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
+    /* Size the hash tables from the number of pages */
+    mp->hashsize = HASHSIZE;
+    while (mp->hashsize < npages && mp->hashsize < MAX_HASHSIZE)
+        mp->hashsize <<= 1;
+    if ((mp->hqh = (struct _hqh *)malloc((size_t)mp->hashsize * sizeof(struct _hqh))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((mp->lhqh = (struct _lhqh *)malloc((size_t)mp->hashsize * sizeof(struct _lhqh))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
     H4_CIRCLEQ_INIT(&mp->lqh);
-    for (entry = 0; entry < HASHSIZE; ++entry) {
+    for (entry = 0; entry < mp->hashsize; ++entry) {
         H4_CIRCLEQ_INIT(&mp->hqh[entry]);
         H4_CIRCLEQ_INIT(&mp->lhqh[entry]);
     }
@@ -198,6 +309,7 @@ mcache_open(void *key,       /* IN: byte string used as handle to share buffers
     /* Initialize max # of pages to cache and number of pages in object */
     mp->maxcache = (int32)maxcache;
     mp->npages   = npages;
+    mp->pool     = pool;
 
     /* Set pagesize and object handle and current object size */
     mp->pagesize    = pagesize;
@@ -206,7 +318,7 @@ mcache_open(void *key,       /* IN: byte string used as handle to share buffers
 
     /* Initialize list hash chain */
     for (pageno = 1; pageno <= mp->npages; ++pageno) {
-        lhead = &mp->lhqh[HASHKEY(pageno)];
+        lhead = &mp->lhqh[HASHKEY(mp, pageno)];
         if ((lp = (L_ELEM *)malloc(sizeof(L_ELEM))) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
         lp->pgno = (int32)pageno; /* set page number */
@@ -244,19 +356,26 @@ mcache_open(void *key,       /* IN: byte string used as handle to share buffers
 
 done:
     if (ret_value == RET_ERROR) { /* error cleanup */
-        free(mp);
-        /* free up list elements */
-        for (entry = 0; entry < HASHSIZE; ++entry) {
-            while ((lp = mp->lhqh[entry].cqh_first) != (void *)&mp->lhqh[entry]) {
-                H4_CIRCLEQ_REMOVE(&mp->lhqh[entry], mp->lhqh[entry].cqh_first, hl);
-                free(lp);
+        if (mp != NULL) {
+            /* free up list elements */
+            if (mp->lhqh != NULL) {
+                for (entry = 0; entry < mp->hashsize; ++entry) {
+                    while ((lp = mp->lhqh[entry].cqh_first) != (void *)&mp->lhqh[entry]) {
+                        H4_CIRCLEQ_REMOVE(&mp->lhqh[entry], mp->lhqh[entry].cqh_first, hl);
+                        free(lp);
+                    }
+                } /* end for entry */
             }
-        } /* end for entry */
+            free(mp->hqh);
+            free(mp->lhqh);
+            free(mp);
+        }
 
         mp = NULL; /* return value */
     }
 #ifdef STATISTICS
-    fprintf(stderr, "mcache_open: mp->listalloc=%lu\n", mp->listalloc);
+    if (mp != NULL)
+        fprintf(stderr, "mcache_open: mp->listalloc=%lu\n", mp->listalloc);
 #endif
 
     return mp;
@@ -287,6 +406,33 @@ mcache_filter(MCACHE *mp, /* IN: MCACHE cookie */
     mp->pgcookie = pgcookie;
 } /* mcache_filter() */
 
+/******************************************************************************
+NAME
+   mcache_filter_batch -- Set an output filter for several pages at once.
+
+DESCRIPTION
+   With this filter, mcache_sync() writes the dirty pages up to 'maxbatch'
+   at a time, and a dirty page that has to be evicted is written together
+   with other dirty pages that are likely to be evicted soon, so that the
+   filter can work on several pages at once.  Pages are passed in lru
+   order, with the page numbers 0 based like those of the page out filter
+   set with mcache_filter(), which is still used for single pages.
+   A NULL filter turns this off.
+
+RETURNS
+   Nothing
+
+******************************************************************************/
+void
+mcache_filter_batch(MCACHE *mp, /* IN: MCACHE cookie */
+                    int32 (*pgoutv)(void * /* cookie */, int32 /* npages */, const int32 * /* pgnos */,
+                                    void ** /* pages */), /* IN: page out filter for several pages */
+                    int32 maxbatch /* IN: max pages per call */)
+{
+    mp->pgoutv   = pgoutv;
+    mp->maxbatch = maxbatch > 1 ? maxbatch : 1;
+} /* mcache_filter_batch() */
+
 /******************************************************************************
 NAME
    mcache_get - get a specified page by page number.
@@ -295,13 +441,16 @@ DESCRIPTION
     Get a page specified by 'pgno'. If the page is not cached then
     we need to create a new page. All returned pages are pinned.
 
+    With MCACHE_NOREAD, a page that is not cached is not read in: the
+    caller must fill all of it before putting it back.
+
 RETURNS
    The specified page if successful and NULL otherwise
 ******************************************************************************/
 void *
 mcache_get(MCACHE *mp,   /* IN: MCACHE cookie */
            int32   pgno, /* IN: page number */
-           int32   flags /* IN: XXX not used? */)
+           int32   flags /* IN: 0 or MCACHE_NOREAD */)
 {
     struct _hqh  *head      = NULL; /* head of lru queue */
     struct _lhqh *lhead     = NULL; /* head of an entry in list hash chain */
@@ -310,8 +459,6 @@ mcache_get(MCACHE *mp,   /* IN: MCACHE cookie */
     int           ret_value = RET_SUCCESS;
     int           list_hit; /* hit flag */
 
-    (void)flags;
-
     /* check inputs */
     if (mp == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
@@ -329,26 +476,25 @@ mcache_get(MCACHE *mp,   /* IN: MCACHE cookie */
     if ((bp = mcache_look(mp, pgno)) != NULL) {
         /*
          * Move the page to the head of the hash chain and the tail
-         * of the lru chain.
+         * of the lru chains.
          */
-        head = &mp->hqh[HASHKEY(bp->pgno)];
+        head = &mp->hqh[HASHKEY(mp, bp->pgno)];
         H4_CIRCLEQ_REMOVE(head, bp, hq);
         H4_CIRCLEQ_INSERT_HEAD(head, bp, hq);
         H4_CIRCLEQ_REMOVE(&mp->lqh, bp, q);
         H4_CIRCLEQ_INSERT_TAIL(&mp->lqh, bp, q);
+        if (mp->pool != NULL) {
+            H4_CIRCLEQ_REMOVE(&mp->pool->pqh, bp, pq);
+            H4_CIRCLEQ_INSERT_TAIL(&mp->pool->pqh, bp, pq);
+        }
         /* Return a pinned page. */
         bp->flags |= MCACHE_PINNED;
 
-        /* update this page reference */
-        lhead = &mp->lhqh[HASHKEY(bp->pgno)];
-        for (lp = lhead->cqh_first; lp != (void *)lhead; lp = lp->hl.cqe_next)
-            if (lp->pgno == bp->pgno) { /* hit */
 #ifdef STATISTICS
-                ++mp->listhit;
-                ++lp->elemhit;
+        /* update this page reference */
+        ++mp->listhit;
+        ++bp->lp->elemhit;
 #endif
-                break;
-            } /* end if lp->pgno */
 
         /* we are done */
         ret_value = RET_SUCCESS;
@@ -362,21 +508,20 @@ mcache_get(MCACHE *mp,   /* IN: MCACHE cookie */
 
     /* Check to see if this page has ever been referenced */
     list_hit = 0;
-    lhead    = &mp->lhqh[HASHKEY(pgno)];
+    lhead    = &mp->lhqh[HASHKEY(mp, pgno)];
     for (lp = lhead->cqh_first; lp != (void *)lhead; lp = lp->hl.cqe_next)
-        if (lp->pgno == pgno && lp->eflags != 0) { /* hit */
+        if (lp->pgno == pgno) { /* hit */
 #ifdef STATISTICS
             ++mp->listhit;
             ++lp->elemhit;
 #endif
-            list_hit = 1;
+            list_hit = (lp->eflags != 0);
             break;
         } /* end if lp->pgno */
 
-    /* If there is no hit then we allocate a new element
+    /* If there is no element then we allocate a new one
      *  and insert into hash table */
-    if (!list_hit) { /* NO hit, new list element
-                      * no need to read this page from disk */
+    if (lp == (void *)lhead) {
         if ((lp = (L_ELEM *)malloc(sizeof(L_ELEM))) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, FAIL);
 
@@ -387,9 +532,13 @@ mcache_get(MCACHE *mp,   /* IN: MCACHE cookie */
         lp->elemhit = 1;
 #endif
         H4_CIRCLEQ_INSERT_HEAD(lhead, lp, hl); /* add to list */
-    }                                          /*end if !list_hit */
-    else {                                     /* list hit, need to read page */
-        lp->eflags = ELEM_READ;                /* Indicate we are reading this page */
+    }                                          /* end if new element */
+
+    if (list_hit && (flags & MCACHE_NOREAD)) { /* caller fills the page */
+        lp->eflags = ELEM_READ;
+    }
+    else if (list_hit) {        /* list hit, need to read page */
+        lp->eflags = ELEM_READ; /* Indicate we are reading this page */
 
 #ifdef STATISTICS
         ++mp->pageread;
@@ -401,39 +550,104 @@ mcache_get(MCACHE *mp,   /* IN: MCACHE cookie */
         if (mp->pgin != NULL) { /* Note page numbers in HMCPxxx are 0 based not 1 based */
             if (((mp->pgin)(mp->pgcookie, pgno - 1, bp->page)) == FAIL) {
                 HEreport("mcache_get: error reading chunk=%d\n", (int)pgno - 1);
-                lp        = NULL; /* don't clobber the cache! */
                 ret_value = RET_ERROR;
                 goto done;
             }
         }
         else {
             HEreport("mcache_get: reading fcn not set,chunk=%d\n", (int)pgno - 1);
-            lp        = NULL;
             ret_value = RET_ERROR;
             goto done;
         }
-    } /* end else list hit */
+    } /* end if list hit */
 
     /* Set the page number, pin the page. */
     bp->pgno  = pgno;
+    bp->lp    = lp;
     bp->flags = MCACHE_PINNED;
 
     /*
      * Add the page to the head of the hash chain and the tail
-     * of the lru chain.
+     * of the lru chains.
      */
-    head = &mp->hqh[HASHKEY(bp->pgno)];
+    head = &mp->hqh[HASHKEY(mp, bp->pgno)];
     H4_CIRCLEQ_INSERT_HEAD(head, bp, hq);
     H4_CIRCLEQ_INSERT_TAIL(&mp->lqh, bp, q);
+    if (mp->pool != NULL)
+        H4_CIRCLEQ_INSERT_TAIL(&mp->pool->pqh, bp, pq);
 
 done:
     if (ret_value == RET_ERROR) { /* error cleanup */
-        free(lp);
+        /* the page is not on any queue yet; the list element is
+           left in the list, don't clobber the cache! */
+        if (bp != NULL)
+            mcache_free_page(bp);
         return NULL;
     }
     return bp->page;
 } /* mcache_get() */
 
+/******************************************************************************
+NAME
+   mcache_incache - check whether a page is cached
+
+DESCRIPTION
+    Looks 'pgno' up without reading it in or changing its place in the
+    lru queues.
+
+RETURNS
+   TRUE if the page is cached and FALSE otherwise
+******************************************************************************/
+int
+mcache_incache(MCACHE *mp, /* IN: MCACHE cookie */
+               int32   pgno /* IN: page number */)
+{
+    if (mp == NULL || pgno < 1 || pgno > mp->npages)
+        return FALSE;
+
+    return mcache_look(mp, pgno) != NULL;
+} /* mcache_incache() */
+
+/******************************************************************************
+NAME
+   mcache_discard - drop a page without writing it
+
+DESCRIPTION
+    Takes 'pgno' out of the cache if it is cached, throwing away any
+    changes made to it.  The next mcache_get() reads it in again.  Used
+    when the page has been replaced on disk behind the cache's back.
+
+RETURNS
+   RET_SUCCESS if successful and RET_ERROR otherwise, if the page is pinned
+******************************************************************************/
+int
+mcache_discard(MCACHE *mp, /* IN: MCACHE cookie */
+               int32   pgno /* IN: page number */)
+{
+    BKT *bp        = NULL; /* bucket element */
+    int  ret_value = RET_SUCCESS;
+
+    /* check inputs */
+    if (mp == NULL || pgno < 1 || pgno > mp->npages)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if ((bp = mcache_look(mp, pgno)) == NULL)
+        HGOTO_DONE(RET_SUCCESS);
+    if (bp->flags & MCACHE_PINNED)
+        HE_REPORT_GOTO("attempting to discard a pinned page", FAIL);
+
+    /* Remove from the hash and lru queues, the page is on disk */
+    H4_CIRCLEQ_REMOVE(&mp->hqh[HASHKEY(mp, bp->pgno)], bp, hq);
+    H4_CIRCLEQ_REMOVE(&mp->lqh, bp, q);
+    if (mp->pool != NULL)
+        H4_CIRCLEQ_REMOVE(&mp->pool->pqh, bp, pq);
+    bp->lp->eflags = ELEM_SYNC;
+    mcache_free_page(bp);
+
+done:
+    return ret_value;
+} /* mcache_discard() */
+
 /******************************************************************************
 NAME
    mcache_put -- put a page back into the memory buffer pool
@@ -450,10 +664,8 @@ mcache_put(MCACHE *mp,   /* IN: MCACHE cookie */
            void   *page, /* IN: page to put */
            int32   flags /* IN: flags = 0, MCACHE_DIRTY */)
 {
-    struct _lhqh *lhead     = NULL; /* head of an entry in list hash chain */
-    L_ELEM       *lp        = NULL;
-    BKT          *bp        = NULL; /* bucket element ptr */
-    int           ret_value = RET_SUCCESS;
+    BKT *bp        = NULL; /* bucket element ptr */
+    int  ret_value = RET_SUCCESS;
 
     /* check inputs */
     if (mp == NULL || page == NULL)
@@ -470,16 +682,11 @@ mcache_put(MCACHE *mp,   /* IN: MCACHE cookie */
     bp->flags |= flags & MCACHE_DIRTY;
 
     if (bp->flags & MCACHE_DIRTY) { /* update this page reference */
-        lhead = &mp->lhqh[HASHKEY(bp->pgno)];
-        for (lp = lhead->cqh_first; lp != (void *)lhead; lp = lp->hl.cqe_next)
-            if (lp->pgno == bp->pgno) { /* hit */
 #ifdef STATISTICS
-                ++mp->listhit;
-                ++lp->elemhit;
+        ++mp->listhit;
+        ++bp->lp->elemhit;
 #endif
-                lp->eflags = ELEM_WRITTEN;
-                break;
-            } /* end if lp->pgno */
+        bp->lp->eflags = ELEM_WRITTEN;
     }
 
 done:
@@ -512,16 +719,20 @@ mcache_close(MCACHE *mp /* IN: MCACHE cookie */)
     /* Free up any space allocated to the lru pages. */
     while ((bp = mp->lqh.cqh_first) != (void *)&mp->lqh) {
         H4_CIRCLEQ_REMOVE(&mp->lqh, mp->lqh.cqh_first, q);
-        free(bp);
+        if (mp->pool != NULL)
+            H4_CIRCLEQ_REMOVE(&mp->pool->pqh, bp, pq);
+        mcache_free_page(bp);
     }
 
     /* free up list elements */
-    for (entry = 0; entry < HASHSIZE; ++entry) {
+    for (entry = 0; entry < mp->hashsize; ++entry) {
         while ((lp = mp->lhqh[entry].cqh_first) != (void *)&mp->lhqh[entry]) {
             H4_CIRCLEQ_REMOVE(&mp->lhqh[entry], mp->lhqh[entry].cqh_first, hl);
             free(lp);
         }
     } /* end for entry */
+    free(mp->hqh);
+    free(mp->lhqh);
 
 done:
     if (ret_value == RET_ERROR) { /* error cleanup */
@@ -547,23 +758,42 @@ RETURNS
 int
 mcache_sync(MCACHE *mp /* IN: MCACHE cookie */)
 {
-    BKT *bp        = NULL; /* bucket element */
-    int  ret_value = RET_SUCCESS;
+    BKT  *bp        = NULL; /* bucket element */
+    BKT **bps       = NULL; /* dirty pages to write together */
+    int32 nbps      = 0;    /* number of pages in bps */
+    int   ret_value = RET_SUCCESS;
 
     /* check inputs */
     if (mp == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* Walk the lru chain, flushing any dirty pages to disk. */
-    for (bp = mp->lqh.cqh_first; bp != (void *)&mp->lqh; bp = bp->q.cqe_next) {
-        if (bp->flags & MCACHE_DIRTY && mcache_write(mp, bp) == RET_ERROR)
-            HE_REPORT_GOTO("unable to flush a dirty page", FAIL);
-    } /* end for bp */
+    /* Walk the lru chain, flushing any dirty pages to disk, in batches
+       if there is a filter for them. */
+    if (mp->pgoutv != NULL) {
+        if ((bps = (BKT **)malloc((size_t)mp->maxbatch * sizeof(BKT *))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        for (bp = mp->lqh.cqh_first; bp != (void *)&mp->lqh; bp = bp->q.cqe_next) {
+            if (!(bp->flags & MCACHE_DIRTY))
+                continue;
+            bps[nbps++] = bp;
+            if (nbps == mp->maxbatch) {
+                if (mcache_write_batch(mp, bps, nbps) == RET_ERROR)
+                    HE_REPORT_GOTO("unable to flush dirty pages", FAIL);
+                nbps = 0;
+            }
+        } /* end for bp */
+        if (nbps > 0 && mcache_write_batch(mp, bps, nbps) == RET_ERROR)
+            HE_REPORT_GOTO("unable to flush dirty pages", FAIL);
+    }
+    else {
+        for (bp = mp->lqh.cqh_first; bp != (void *)&mp->lqh; bp = bp->q.cqe_next) {
+            if (bp->flags & MCACHE_DIRTY && mcache_write(mp, bp) == RET_ERROR)
+                HE_REPORT_GOTO("unable to flush a dirty page", FAIL);
+        } /* end for bp */
+    }
 
 done:
-    if (ret_value == RET_ERROR) { /* error cleanup */
-        return ret_value;
-    }
+    free(bps);
 
     return ret_value;
 } /* mcache_sync() */
@@ -587,7 +817,7 @@ NOTE: Note that the size of the page allocated is equal to
 static BKT *
 mcache_bkt(MCACHE *mp /* IN: MCACHE cookie */)
 {
-    struct _hqh *head      = NULL; /* head of hash chain */
+    MCACHE_POOL *pool      = NULL; /* pool of the cache */
     BKT         *bp        = NULL; /* bucket element */
     int          ret_value = RET_SUCCESS;
 
@@ -595,9 +825,29 @@ mcache_bkt(MCACHE *mp /* IN: MCACHE cookie */)
     if (mp == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* If under the max cached, always create a new page. */
-    if ((int32)mp->curcache < (int32)mp->maxcache)
+    /*
+     * If under the max cached, create a new page.  If that would put the
+     * pool over its budget, first free the least recently used unpinned
+     * pages of any cache in the pool; a page of this cache is simply
+     * reused.  If nothing can be freed the pool grows anyway.
+     */
+    if ((int32)mp->curcache < (int32)mp->maxcache) {
+        pool = mp->pool;
+        while (pool != NULL && pool->budget > 0 && pool->used + mp->pagesize > pool->budget) {
+            for (bp = pool->pqh.cqh_first; bp != (void *)&pool->pqh; bp = bp->pq.cqe_next)
+                if (!(bp->flags & MCACHE_PINNED))
+                    break;
+            if (bp == (void *)&pool->pqh)
+                break; /* everything is pinned */
+
+            if (mcache_evict(bp) == RET_ERROR)
+                HE_REPORT_GOTO("unable to flush a dirty page", FAIL);
+            if (bp->mp == mp)
+                goto done; /* reuse it */
+            mcache_free_page(bp);
+        }
         goto new;
+    }
 
     /*
      * If the cache is max'd out, walk the lru list for a buffer we
@@ -606,16 +856,9 @@ mcache_bkt(MCACHE *mp /* IN: MCACHE cookie */)
      * The cache never shrinks.
      */
     for (bp = mp->lqh.cqh_first; bp != (void *)&mp->lqh; bp = bp->q.cqe_next)
-        if (!(bp->flags & MCACHE_PINNED)) { /* Flush if dirty. */
-            if (bp->flags & MCACHE_DIRTY && mcache_write(mp, bp) == RET_ERROR)
+        if (!(bp->flags & MCACHE_PINNED)) {
+            if (mcache_evict(bp) == RET_ERROR)
                 HE_REPORT_GOTO("unable to flush a dirty page", FAIL);
-#ifdef STATISTICS
-            ++mp->pageflush;
-#endif
-            /* Remove from the hash and lru queues. */
-            head = &mp->hqh[HASHKEY(bp->pgno)];
-            H4_CIRCLEQ_REMOVE(head, bp, hq);
-            H4_CIRCLEQ_REMOVE(&mp->lqh, bp, q);
 
             /* done */
             ret_value = RET_SUCCESS;
@@ -632,17 +875,81 @@ mcache_bkt(MCACHE *mp /* IN: MCACHE cookie */)
 
     /* set page ptr past bucket element section */
     bp->page = (char *)bp + sizeof(BKT);
+    bp->mp   = mp;
     ++mp->curcache; /* increase number of cached pages */
+    if (mp->pool != NULL)
+        mp->pool->used += mp->pagesize;
 
 done:
-    if (ret_value == RET_ERROR) { /* error cleanup */
-        free(bp);
+    if (ret_value == RET_ERROR) /* error cleanup */
         return NULL;
-    }
 
     return bp; /* return only the pagesize fragment */
 } /* mcache_bkt() */
 
+/******************************************************************************
+NAME
+   mcache_evict - take an unpinned page out of its cache.
+
+DESCRIPTION
+   Private routine. Write the page to disk if it is dirty and remove it
+   from the hash and lru queues of its cache and pool.  The page itself
+   is kept, and still counts as cached.
+
+RETURNS
+   RET_SUCCESS if successful and RET_ERROR otherwise
+******************************************************************************/
+static int
+mcache_evict(BKT *bp /* IN: bucket element */)
+{
+    MCACHE *mp        = bp->mp; /* cache of the page */
+    int     ret_value = RET_SUCCESS;
+
+    /* Flush if dirty. */
+    if (bp->flags & MCACHE_DIRTY) {
+        if (mp->pgoutv != NULL) {
+            if (mcache_write_behind(mp, bp) == RET_ERROR)
+                HE_REPORT_GOTO("unable to flush a dirty page", FAIL);
+        }
+        else if (mcache_write(mp, bp) == RET_ERROR)
+            HE_REPORT_GOTO("unable to flush a dirty page", FAIL);
+    }
+#ifdef STATISTICS
+    ++mp->pageflush;
+#endif
+
+    /* Remove from the hash and lru queues. */
+    H4_CIRCLEQ_REMOVE(&mp->hqh[HASHKEY(mp, bp->pgno)], bp, hq);
+    H4_CIRCLEQ_REMOVE(&mp->lqh, bp, q);
+    if (mp->pool != NULL)
+        H4_CIRCLEQ_REMOVE(&mp->pool->pqh, bp, pq);
+
+done:
+    return ret_value;
+} /* mcache_evict() */
+
+/******************************************************************************
+NAME
+   mcache_free_page - free a page that is not on any queue.
+
+DESCRIPTION
+   Private routine. Free the page and its bucket element, and update the
+   number of pages in its cache and the bytes used by its pool.
+
+RETURNS
+   Nothing
+******************************************************************************/
+static void
+mcache_free_page(BKT *bp /* IN: bucket element */)
+{
+    MCACHE *mp = bp->mp; /* cache of the page */
+
+    --mp->curcache;
+    if (mp->pool != NULL)
+        mp->pool->used -= mp->pagesize;
+    free(bp);
+} /* mcache_free_page() */
+
 /******************************************************************************
 NAME
    mcache_write - write a page to disk given it's bucket handle.
@@ -657,9 +964,7 @@ static int
 mcache_write(MCACHE *mp, /* IN: MCACHE cookie */
              BKT    *bp /* IN: bucket element */)
 {
-    struct _lhqh *lhead     = NULL; /* head of an entry in list hash chain */
-    L_ELEM       *lp        = NULL;
-    int           ret_value = RET_SUCCESS;
+    int ret_value = RET_SUCCESS;
 
     /* check inputs */
     if (mp == NULL || bp == NULL)
@@ -670,16 +975,11 @@ mcache_write(MCACHE *mp, /* IN: MCACHE cookie */
 #endif
 
     /* update this page reference */
-    lhead = &mp->lhqh[HASHKEY(bp->pgno)];
-    for (lp = lhead->cqh_first; lp != (void *)lhead; lp = lp->hl.cqe_next)
-        if (lp->pgno == bp->pgno) { /* hit */
 #ifdef STATISTICS
-            ++mp->listhit;
-            ++lp->elemhit;
+    ++mp->listhit;
+    ++bp->lp->elemhit;
 #endif
-            lp->eflags = ELEM_SYNC;
-            break;
-        }
+    bp->lp->eflags = ELEM_SYNC;
 
     /* Run page through the user's filter.
        we use this to write the data chunk/page out.
@@ -708,6 +1008,101 @@ done:
     return ret_value;
 } /* mcache_write() */
 
+/******************************************************************************
+NAME
+   mcache_write_batch - write several pages to disk.
+
+DESCRIPTION
+   Private routine. Write the pages 'bps' to disk with the page out
+   filter for several pages.
+
+RETURNS
+   RET_SUCCESS if successful and RET_ERROR otherwise
+******************************************************************************/
+static int
+mcache_write_batch(MCACHE *mp,  /* IN: MCACHE cookie */
+                   BKT   **bps, /* IN: bucket elements */
+                   int32   nbps /* IN: number of bucket elements */)
+{
+    int32 *pgnos     = NULL; /* page numbers, 0 based */
+    void **pages     = NULL; /* pages */
+    int32  i;
+    int    ret_value = RET_SUCCESS;
+
+    if ((pgnos = (int32 *)malloc((size_t)nbps * sizeof(int32))) == NULL ||
+        (pages = (void **)malloc((size_t)nbps * sizeof(void *))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    for (i = 0; i < nbps; i++) {
+#ifdef STATISTICS
+        ++mp->pagewrite;
+        ++mp->listhit;
+        ++bps[i]->lp->elemhit;
+#endif
+        bps[i]->lp->eflags = ELEM_SYNC;
+        pgnos[i]           = bps[i]->pgno - 1;
+        pages[i]           = bps[i]->page;
+    }
+
+    if ((mp->pgoutv)(mp->pgcookie, nbps, pgnos, pages) == FAIL) {
+        HEreport("mcache_write_batch: error writing %d chunks\n", (int)nbps);
+        ret_value = RET_ERROR;
+        goto done;
+    }
+
+    /* mark pages as clean */
+    for (i = 0; i < nbps; i++)
+        bps[i]->flags &= (uint8)~MCACHE_DIRTY;
+
+done:
+    free(pgnos);
+    free(pages);
+
+    return ret_value;
+} /* mcache_write_batch() */
+
+/******************************************************************************
+NAME
+   mcache_write_behind - write a page to disk with the next ones to evict.
+
+DESCRIPTION
+   Private routine. Write the dirty page 'bp' together with the other
+   unpinned dirty pages of the older half of the lru queue, up to
+   'maxbatch' pages.  The pages of the newer half, which the application
+   is probably still working on, are left alone.
+
+RETURNS
+   RET_SUCCESS if successful and RET_ERROR otherwise
+******************************************************************************/
+static int
+mcache_write_behind(MCACHE *mp, /* IN: MCACHE cookie */
+                    BKT    *bp /* IN: dirty bucket element */)
+{
+    BKT **bps       = NULL; /* dirty pages to write together */
+    BKT  *op        = NULL; /* other bucket element */
+    int32 nbps      = 0;    /* number of pages in bps */
+    int32 nscan     = 0;    /* number of pages left to scan */
+    int   ret_value = RET_SUCCESS;
+
+    if ((bps = (BKT **)malloc((size_t)mp->maxbatch * sizeof(BKT *))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    bps[nbps++] = bp;
+    nscan       = (mp->curcache + 1) / 2;
+    for (op = mp->lqh.cqh_first; op != (void *)&mp->lqh && nscan > 0 && nbps < mp->maxbatch;
+         op = op->q.cqe_next, nscan--)
+        if (op != bp && (op->flags & MCACHE_DIRTY) && !(op->flags & MCACHE_PINNED))
+            bps[nbps++] = op;
+
+    if (mcache_write_batch(mp, bps, nbps) == RET_ERROR)
+        HE_REPORT_GOTO("unable to flush dirty pages", FAIL);
+
+done:
+    free(bps);
+
+    return ret_value;
+} /* mcache_write_behind() */
+
 /******************************************************************************
 NAME
    mcache_look - lookup a page in the cache.
@@ -738,7 +1133,7 @@ mcache_look(MCACHE *mp, /* IN: MCACHE cookie */
     }
 
     /* search through hash chain */
-    head = &mp->hqh[HASHKEY(pgno)];
+    head = &mp->hqh[HASHKEY(mp, pgno)];
     for (bp = head->cqh_first; bp != (void *)head; bp = bp->hq.cqe_next)
         if (bp->pgno == pgno) { /* hit....found page in cache */
 #ifdef STATISTICS
@@ -853,7 +1248,7 @@ mcache_stat(MCACHE *mp /* IN: MCACHE cookie */)
         sep    = "";
         cnt    = 0;
         hitcnt = 0;
-        for (entry = 0; entry < HASHSIZE; ++entry) {
+        for (entry = 0; entry < mp->hashsize; ++entry) {
             lhead = &mp->lhqh[entry];
             for (lp = lhead->cqh_first; lp != (void *)lhead; lp = lp->hl.cqe_next) {
                 cnt++;
@@ -63,16 +63,26 @@
 
 /*
  * The memory pool scheme is a simple one.  Each in-memory page is referenced
- * by a bucket which is threaded in up to two (three?) ways.  All active pages
- * are threaded on a hash chain (hashed by page number) and an lru chain.
- * (Inactive pages are threaded on a free chain?).  Each reference to a memory
- * pool is handed an opaque MPOOL cookie which stores all of this information.
+ * by a bucket which is threaded in up to three ways.  All active pages
+ * are threaded on a hash chain (hashed by page number), the lru chain of
+ * their cache and, when the cache belongs to a pool, the lru chain of the
+ * pool.  Each reference to a memory pool is handed an opaque MPOOL cookie
+ * which stores all of this information.
+ *
+ * All the caches of a file share one MCACHE_POOL.  The pool keeps every
+ * cached page of the file in a single lru chain and can put a limit on the
+ * number of bytes held by all of them together (see Hsetchunkcachebudget).
+ * When the limit would be exceeded, the least recently used unpinned page
+ * of any cache in the pool is written out (if dirty) and freed.
  */
 
-/* Current Hash table size. Page numbers start with 1
- * (i.e 0 will denote invalid page number) */
-#define HASHSIZE      128
-#define HASHKEY(pgno) ((pgno - 1) % HASHSIZE)
+/* Hash table sizes.  The tables of a cache are sized from the number of
+ * pages in the object when the cache is opened, rounded up to a power
+ * of 2 and kept between HASHSIZE and MAX_HASHSIZE buckets.  Page numbers
+ * start with 1 (i.e 0 will denote invalid page number) */
+#define HASHSIZE          128
+#define MAX_HASHSIZE      65536
+#define HASHKEY(mp, pgno) (((pgno) - 1) & ((mp)->hashsize - 1))
 
 /* Default pagesize and max # of pages to cache */
 #define DEF_PAGESIZE 8192
@@ -80,12 +90,18 @@
 
 #define MAX_PAGE_NUMBER 0xffffffff /* >= # of pages in a object */
 
+struct MCACHE;
+struct _lelem;
+
 /* The BKT structures are the elements of the queues. */
 typedef struct _bkt {
     H4_CIRCLEQ_ENTRY(_bkt) hq; /* hash queue */
     H4_CIRCLEQ_ENTRY(_bkt) q;  /* lru queue */
-    void *page;                /* page */
-    int32 pgno;                /* page number */
+    H4_CIRCLEQ_ENTRY(_bkt) pq; /* pool lru queue */
+    struct MCACHE *mp;         /* cache this page belongs to */
+    struct _lelem *lp;         /* list element of this page */
+    void          *page;       /* page */
+    int32          pgno;       /* page number */
 #define MCACHE_DIRTY  0x01     /* page needs to be written */
 #define MCACHE_PINNED 0x02     /* page is pinned into memory */
     uint8 flags;               /* flags */
@@ -108,20 +124,38 @@ typedef struct _lelem {
     0x10 /* increase number of pages                                                                         \
         i.e extend object */
 
+#define MCACHE_NOREAD 0x20 /* mcache_get: don't read the page in, the caller fills it */
+
+/* Hash chain heads, allocated per cache */
+H4_CIRCLEQ_HEAD(_hqh, _bkt);
+H4_CIRCLEQ_HEAD(_lhqh, _lelem);
+
+/* Pool of pages shared by all the caches of a file */
+typedef struct MCACHE_POOL {
+    H4_CIRCLEQ_HEAD(_pqh, _bkt) pqh; /* lru queue of the pages of all caches */
+    int32 budget;                    /* max bytes of cached pages, 0 for no limit */
+    int32 used;                      /* bytes of pages currently cached */
+} MCACHE_POOL;
+
 /* Memory pool cache */
 typedef struct MCACHE {
     H4_CIRCLEQ_HEAD(_lqh, _bkt) lqh;                            /* lru queue head */
-    H4_CIRCLEQ_HEAD(_hqh, _bkt) hqh[HASHSIZE];                  /* hash queue array */
-    H4_CIRCLEQ_HEAD(_lhqh, _lelem) lhqh[HASHSIZE];              /* hash of all elements */
-    int32 curcache;                                             /* current num of cached pages */
-    int32 maxcache;                                             /* max number of cached pages */
-    int32 npages;                                               /* number of pages in the object */
-    int32 pagesize;                                             /* cache page size */
-    int32 object_id;                                            /* access ID of object this cache is for */
-    int32 object_size;                                          /* size of object to cache
+    struct _hqh  *hqh;                                          /* hash queue array */
+    struct _lhqh *lhqh;                                         /* hash of all elements */
+    int32         hashsize;                                     /* number of buckets in hqh and lhqh */
+    MCACHE_POOL  *pool;                                         /* pool shared with other caches, or NULL */
+    int32         curcache;                                     /* current num of cached pages */
+    int32         maxcache;                                     /* max number of cached pages */
+    int32         npages;                                       /* number of pages in the object */
+    int32         pagesize;                                     /* cache page size */
+    int32         object_id;                                    /* access ID of object this cache is for */
+    int32         object_size;                                  /* size of object to cache
                                                                    must be multiple of pagesize for now */
     int32 (*pgin)(void *cookie, int32 pgno, void *page);        /* page in conversion routine */
     int32 (*pgout)(void *cookie, int32 pgno, const void *page); /* page out conversion routine*/
+    int32 (*pgoutv)(void *cookie, int32 npages, const int32 *pgnos,
+                    void **pages);                              /* page out of several pages */
+    int32 maxbatch;                                             /* max pages passed to pgoutv */
     void *pgcookie;                                             /* cookie for page in/out routines */
 #ifdef STATISTICS
     int32 listhit;   /* # of list hits */
@@ -142,12 +176,19 @@ typedef struct MCACHE {
 extern "C" {
 #endif
 
-HDFLIBAPI MCACHE *mcache_open(void *key,       /* IN:byte string used as handle to share buffers */
-                              int32 object_id, /* IN: object handle */
-                              int32 pagesize,  /* IN: chunk size in bytes */
-                              int32 maxcache,  /* IN: maximum number of pages to cache at any time */
-                              int32 npages,    /* IN: number of chunks currently in object */
-                              int32 flags /* IN: 0= object exists, 1= does not exist */);
+HDFLIBAPI MCACHE_POOL *mcache_pool_create(void);
+
+HDFLIBAPI int mcache_pool_set_budget(MCACHE_POOL *pool, /* IN: pool */
+                                     int32        budget /* IN: max bytes of cached pages, 0 for no limit */);
+
+HDFLIBAPI int mcache_pool_close(MCACHE_POOL *pool /* IN: pool with no caches left */);
+
+HDFLIBAPI MCACHE *mcache_open(MCACHE_POOL *pool,      /* IN: pool shared with other caches, or NULL */
+                              int32        object_id, /* IN: object handle */
+                              int32        pagesize,  /* IN: chunk size in bytes */
+                              int32        maxcache,  /* IN: maximum number of pages to cache at any time */
+                              int32        npages,    /* IN: number of chunks currently in object */
+                              int32        flags /* IN: 0= object exists, 1= does not exist */);
 
 HDFLIBAPI void mcache_filter(MCACHE *mp,                                          /* IN: MCACHE cookie */
                              int32 (*pgin)(void *cookie, int32 pgno, void *page), /* IN: page in filter */
@@ -155,13 +196,24 @@ HDFLIBAPI void mcache_filter(MCACHE *mp,
                                             const void *page), /* IN: page out filter */
                              void *pgcookie /* IN: filter cookie */);
 
+HDFLIBAPI void mcache_filter_batch(MCACHE *mp, /* IN: MCACHE cookie */
+                                  int32 (*pgoutv)(void *cookie, int32 npages, const int32 *pgnos,
+                                                  void **pages), /* IN: page out filter for several pages */
+                                  int32 maxbatch /* IN: max pages per call */);
+
 HDFLIBAPI void *mcache_new(MCACHE *mp,       /* IN: MCACHE cookie */
                            int32  *pgnoaddr, /* IN/OUT: address of newly create page */
                            int32   flags /* IN:MCACHE_EXTEND or 0 */);
 
 HDFLIBAPI void *mcache_get(MCACHE *mp,   /* IN: MCACHE cookie */
                            int32   pgno, /* IN: page number */
-                           int32   flags /* IN: XXX not used? */);
+                           int32   flags /* IN: 0 or MCACHE_NOREAD */);
+
+HDFLIBAPI int mcache_incache(MCACHE *mp, /* IN: MCACHE cookie */
+                             int32   pgno /* IN: page number */);
+
+HDFLIBAPI int mcache_discard(MCACHE *mp, /* IN: MCACHE cookie */
+                             int32   pgno /* IN: page number */);
 
 HDFLIBAPI int mcache_put(MCACHE *mp,   /* IN: MCACHE cookie */
                          void   *page, /* IN: page to put */
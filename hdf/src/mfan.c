@@ -1136,6 +1136,8 @@ done:
 int32
 ANstart(int32 file_id /* IN: file to start annotation access on*/)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec  = NULL; /* file record pointer */
     int32      ret_value = SUCCEED;
 
@@ -1181,6 +1183,8 @@ ANfileinfo(int32  an_id,        /* IN:  annotation interface id */
            int32 *n_obj_label,  /* OUT: the # of object labels */
            int32 *n_obj_desc /* OUT: the # of object descriptions */)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec  = NULL; /* file record pointer */
     int        ret_value = SUCCEED;
 
@@ -1241,6 +1245,8 @@ done:
 int32
 ANend(int32 an_id /* IN: Annotation ID of file to close */)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec  = NULL; /* file record pointer */
     TBBT_NODE *aentry    = NULL;
     ANentry   *ann_entry = NULL;
@@ -1366,6 +1372,8 @@ ANcreate(int32    an_id,    /* IN: annotation interface ID */
          ann_type type      /* IN: AN_DATA_LABEL for data labels,
                                   AN_DATA_DESC for data descriptions*/)
 {
+    H4_API_ENTER;
+
     int32 ret_value;
 
     ret_value = (ANIcreate(an_id, elem_tag, elem_ref, type));
@@ -1393,6 +1401,8 @@ ANcreatef(int32    an_id,/* IN: annotation interface ID */
           ann_type type  /* IN:  AN_FILE_LABEL for file labels,
                                  AN_FILE_DESC for file descriptions.*/)
 {
+    H4_API_ENTER;
+
     uint16 ann_tag;
     uint16 ann_ref;
     int32  ret_value = SUCCEED;
@@ -1441,6 +1451,8 @@ ANselect(int32    an_id, /* IN: annotation interface ID */
                                 AN_FILE_LABEL for file labels,
                                 AN_FILE_DESC for file descriptions.*/)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec  = NULL; /* file record pointer */
     TBBT_NODE *entry     = NULL;
     ANentry   *ann_entry = NULL;
@@ -1505,6 +1517,8 @@ ANnumann(int32    an_id,  /* IN: annotation interface id */
          uint16 elem_tag, /* IN: tag of item of which this is annotation */
          uint16 elem_ref /* IN: ref of item of which this is annotation */)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* deal with invalid types */
@@ -1544,6 +1558,8 @@ ANannlist(int32    an_id,  /* IN: annotation interface id */
           uint16 elem_ref, /* IN: ref of item of which this is annotation */
           int32  ann_list[] /* OUT: array of ann_id's that match criteria. */)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* deal with invalid types */
@@ -1573,6 +1589,8 @@ done:
 int32
 ANannlen(int32 ann_id /* IN: annotation id */)
 {
+    H4_API_ENTER;
+
     int32 ret_value;
 
     ret_value = ANIannlen(ann_id);
@@ -1599,6 +1617,8 @@ ANwriteann(int32       ann_id, /* IN: annotation id */
            const char *ann,    /* IN: annotation to write */
            int32       annlen /* IN: length of annotation */)
 {
+    H4_API_ENTER;
+
     int32 ret_value;
 
     ret_value = ANIwriteann(ann_id, ann, annlen);
@@ -1625,6 +1645,8 @@ ANreadann(int32 ann_id, /* IN: annotation id (handle) */
           char *ann,    /* OUT: space to return annotation in */
           int32 maxlen /* IN: size of space to return annotation in */)
 {
+    H4_API_ENTER;
+
     int32 ret_value;
 
     ret_value = ANIreadann(ann_id, ann, maxlen);
@@ -1648,6 +1670,8 @@ ANreadann(int32 ann_id, /* IN: annotation id (handle) */
 int
 ANendaccess(int32 ann_id /* IN: annotation id */)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     (void)ann_id;
@@ -1681,6 +1705,8 @@ ANget_tagref(int32    an_id, /* IN: annotation interface ID */
              uint16 *tag,    /* OUT: Tag for annotation */
              uint16 *ref /* OUT: ref for annotation */)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec  = NULL; /* file record pointer */
     TBBT_NODE *entry     = NULL;
     ANentry   *ann_entry = NULL;
@@ -1756,6 +1782,8 @@ ANid2tagref(int32   ann_id, /* IN: annotation id */
             uint16 *tag,    /* OUT: Tag for annotation */
             uint16 *ref /* OUT: ref for annotation */)
 {
+    H4_API_ENTER;
+
     ANnode *ann_node = NULL;
     int32   file_id  = FAIL;
     int32   type;
@@ -1825,6 +1853,8 @@ ANtagref2id(int32  an_id,   /* IN  Annotation interface id */
             uint16 ann_tag, /* IN: Tag for annotation */
             uint16 ann_ref /* IN: ref for annotation */)
 {
+    H4_API_ENTER;
+
     filerec_t *file_rec  = NULL; /* file record pointer */
     TBBT_NODE *entry     = NULL;
     ANentry   *ann_entry = NULL;
@@ -82,6 +82,9 @@ int GRwriteimage(int32 riid,int32 start[2],int32 stride[2],int32 count[2],void *
         dimension support)
 int GRreadimage(int32 riid,int32 start[2],int32 stride[2],int32 count[2],void * data)
     - Read image data from an RI.  Partial reads and subsampling are allowed.
+int GRreadimage_async(int32 riid,int32 start[2],int32 stride[2],int32 count[2],void * data,
+        hdf_asyncfunc_t callback,void * ctx)
+    - Read image data from an RI in the background and call back when done.
 int GRendaccess(int32 riid)
     - End access to an RI.
 
@@ -155,6 +158,7 @@ int GRIil_convert(const void * inbuf,gr_interlace_t inil,void * outbuf,
  */
 
 #include "hdf_priv.h"
+#include "hasync_priv.h"
 #include "mfgr_priv.h"
 
 #ifdef H4_HAVE_LIBSZ /* we have the library */
@@ -1459,6 +1463,8 @@ done:
 int32
 GRstart(int32 hdf_file_id)
 {
+    H4_API_ENTER;
+
     gr_info_t *gr_ptr; /* ptr to the new GR information for a file */
     int32      ret_value = SUCCEED;
 
@@ -1547,6 +1553,8 @@ done:
 int
 GRfileinfo(int32 grid, int32 *n_datasets, int32 *n_attrs)
 {
+    H4_API_ENTER;
+
     gr_info_t *gr_ptr; /* ptr to the GR information for a file */
     int        ret_value = SUCCEED;
 
@@ -1941,6 +1949,8 @@ done:
 int
 GRend(int32 grid)
 {
+    H4_API_ENTER;
+
     int32      hdf_file_id; /* HDF file ID */
     int32      GroupID;     /* VGroup ID for the GR group */
     gr_info_t *gr_ptr;      /* ptr to the GR information for this grid */
@@ -2164,6 +2174,8 @@ done:
 int32
 GRselect(int32 grid, int32 index)
 {
+    H4_API_ENTER;
+
     gr_info_t *gr_ptr; /* ptr to the GR information for this grid */
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     void     **t;      /* temp. ptr to the image found */
@@ -2228,6 +2240,8 @@ done:
 int32
 GRcreate(int32 grid, const char *name, int32 ncomp, int32 nt, int32 il, int32 dimsizes[2])
 {
+    H4_API_ENTER;
+
     int32      GroupID; /* ID of the Vgroup created */
     gr_info_t *gr_ptr;  /* ptr to the GR information for this grid */
     ri_info_t *ri_ptr;  /* ptr to the image to work with */
@@ -2341,6 +2355,8 @@ done:
 int32
 GRnametoindex(int32 grid, const char *name)
 {
+    H4_API_ENTER;
+
     gr_info_t *gr_ptr; /* ptr to the GR information for this grid */
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     void     **t;      /* temp. ptr to the image found */
@@ -2404,6 +2420,8 @@ done:
 int
 GRgetiminfo(int32 riid, char *name, int32 *ncomp, int32 *nt, int32 *il, int32 dimsizes[2], int32 *n_attr)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     int        ret_value = SUCCEED;
 
@@ -2469,6 +2487,8 @@ done:
 int
 GRgetnluts(int32 riid)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     int        ret_value = FAIL;
 
@@ -2531,6 +2551,8 @@ done:
 int
 GRwriteimage(int32 riid, int32 start[2], int32 in_stride[2], int32 count[2], void *data)
 {
+    H4_API_ENTER;
+
     int32      stride[2];           /* pointer to the stride array */
     gr_info_t *gr_ptr;              /* ptr to the GR information for this grid */
     ri_info_t *ri_ptr;              /* ptr to the image to work with */
@@ -2545,7 +2567,6 @@ GRwriteimage(int32 riid, int32 start[2], int32 in_stride[2], int32 count[2], voi
     comp_info    cinfo;
     int          status  = FAIL;
     int          convert = FALSE;          /* true if machine NT != NT to be written */
-    uint8        platnumsubclass;          /* class of this NT for this platform */
     int          new_image        = FALSE; /* whether we are writing a new image out */
     int          switch_interlace = FALSE; /* whether the memory interlace needs to be switched around */
     int          ret_value        = SUCCEED;
@@ -2626,9 +2647,8 @@ GRwriteimage(int32 riid, int32 start[2], int32 in_stride[2], int32 count[2], voi
         (unsigned)(ri_ptr->img_dim.ncomps * DFKNTsize((ri_ptr->img_dim.nt | DFNT_NATIVE) & (~DFNT_LITEND)));
     pixel_disk_size = (unsigned)(ri_ptr->img_dim.ncomps * DFKNTsize(ri_ptr->img_dim.nt));
 
-    /* Get number-type and conversion information */
-    platnumsubclass = (uint8)DFKgetPNSC(ri_ptr->img_dim.nt & (~DFNT_LITEND), DF_MT);
-    convert         = (ri_ptr->img_dim.file_nt_subclass != platnumsubclass) ||
+    /* Get conversion information */
+    convert = !DFKiscopyNT(ri_ptr->img_dim.nt) ||
               (pixel_mem_size != pixel_disk_size); /* is conversion necessary? */
 
     if (convert || switch_interlace == TRUE) { /* convert image data to HDF disk format */
@@ -2950,6 +2970,8 @@ done:
 int
 GRreadimage(int32 riid, int32 start[2], int32 in_stride[2], int32 count[2], void *data)
 {
+    H4_API_ENTER;
+
     int32        hdf_file_id;         /* HDF file ID */
     gr_info_t   *gr_ptr;              /* ptr to the GR information for this grid */
     ri_info_t   *ri_ptr;              /* ptr to the image to work with */
@@ -2961,7 +2983,6 @@ GRreadimage(int32 riid, int32 start[2], int32 in_stride[2], int32 count[2], void
     unsigned     pixel_disk_size;     /* size of a pixel on disk */
     unsigned     pixel_mem_size;      /* size of a pixel in memory */
     int          convert;             /* true if machine NT != NT to be written */
-    uint8        platnumsubclass;     /* class of this NT for this platform */
     uint16       scheme;              /* compression scheme used for JPEG images */
     uint32       comp_config;
     comp_coder_t comp_type;
@@ -3042,10 +3063,9 @@ GRreadimage(int32 riid, int32 start[2], int32 in_stride[2], int32 count[2], void
     pixel_mem_size =
         (unsigned)(ri_ptr->img_dim.ncomps * DFKNTsize((ri_ptr->img_dim.nt | DFNT_NATIVE) & (~DFNT_LITEND)));
 
-    /* Get number-type and conversion information */
-    platnumsubclass = (uint8)DFKgetPNSC(ri_ptr->img_dim.nt & (~DFNT_LITEND), DF_MT);
-    convert         = (pixel_disk_size != pixel_mem_size) ||
-              (ri_ptr->img_dim.file_nt_subclass != platnumsubclass); /* is conversion necessary? */
+    /* Get conversion information */
+    convert = (pixel_disk_size != pixel_mem_size) ||
+              !DFKiscopyNT(ri_ptr->img_dim.nt); /* is conversion necessary? */
 
     /* Check if the image data is in the file */
     if (ri_ptr->img_tag == DFTAG_NULL || ri_ptr->img_ref == DFREF_WILDCARD)
@@ -3180,6 +3200,100 @@ done:
     return ret_value;
 } /* end GRreadimage() */
 
+/* Arguments of a read submitted by GRreadimage_async */
+typedef struct gr_async_read_t {
+    int32 riid;
+    int32 start[2];
+    int32 stride[2];
+    int32 count[2];
+    void *data;
+} gr_async_read_t;
+
+/* Read submitted by GRreadimage_async */
+static int
+GRIread_async(void *args)
+{
+    gr_async_read_t *rd = (gr_async_read_t *)args;
+
+    return GRreadimage(rd->riid, rd->start, rd->stride, rd->count, rd->data);
+}
+
+/*--------------------------------------------------------------------------
+ NAME
+    GRreadimage_async
+
+ PURPOSE
+    Read raster data for an image in the background
+
+ USAGE
+    int GRreadimage_async(riid,start,stride,edge,data,callback,ctx)
+        int32 riid;                 IN: RI ID from GRselect/GRcreate
+        int32 start[2];             IN: as for GRreadimage
+        int32 stride[2];            IN: as for GRreadimage, may be NULL
+        int32 count[2];             IN: as for GRreadimage
+        void * data;                OUT: buffer for the data read
+        hdf_asyncfunc_t callback;   IN: called when the read is done
+        void * ctx;                 IN: handed to the callback
+
+ RETURNS
+    SUCCEED if the read was submitted, FAIL otherwise
+
+ DESCRIPTION
+    Reads like GRreadimage, then calls callback(riid, status, ctx) with
+    what GRreadimage returned; when it is FAIL, the error stack holds the
+    errors of the read while the callback runs.  The arguments are
+    copied, but 'data' must stay valid, and the image accessible, until
+    the callback is called.
+
+ GLOBAL VARIABLES
+ COMMENTS, BUGS, ASSUMPTIONS
+    In the thread-safe library the read and the callback run on an I/O
+    thread, after the reads of the same file submitted before; see
+    Hasyncwait.  Otherwise they run before GRreadimage_async returns.
+
+ EXAMPLES
+ REVISION LOG
+--------------------------------------------------------------------------*/
+int
+GRreadimage_async(int32 riid, int32 start[2], int32 stride[2], int32 count[2], void *data,
+                  hdf_asyncfunc_t callback, void *ctx)
+{
+    H4_API_ENTER_SHARED;
+
+    ri_info_t       *ri_ptr;    /* ptr to the image to work with */
+    gr_async_read_t *rd        = NULL;
+    int              ret_value = SUCCEED;
+
+    /* clear error stack and check validity of args */
+    HEclear();
+
+    if (HAatom_group(riid) != RIIDGROUP || start == NULL || count == NULL || data == NULL || callback == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (NULL == (ri_ptr = (ri_info_t *)HAatom_object(riid)))
+        HGOTO_ERROR(DFE_RINOTFOUND, FAIL);
+
+    /* Submitters of reads of different files run in parallel */
+    H4_API_LOCK_FILE(ri_ptr->gr_ptr->hdf_file_id);
+
+    if ((rd = (gr_async_read_t *)malloc(sizeof(gr_async_read_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    rd->riid         = riid;
+    rd->start[XDIM]  = start[XDIM];
+    rd->start[YDIM]  = start[YDIM];
+    rd->stride[XDIM] = stride != NULL ? stride[XDIM] : 1;
+    rd->stride[YDIM] = stride != NULL ? stride[YDIM] : 1;
+    rd->count[XDIM]  = count[XDIM];
+    rd->count[YDIM]  = count[YDIM];
+    rd->data         = data;
+
+    /* HASsubmit frees rd */
+    if (HASsubmit(ri_ptr->gr_ptr->hdf_file_id, riid, GRIread_async, rd, callback, ctx) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    return ret_value;
+} /* end GRreadimage_async() */
+
 /*--------------------------------------------------------------------------
  NAME
     GRendaccess
@@ -3206,6 +3320,8 @@ done:
 int
 GRendaccess(int32 riid)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     int        ret_value = SUCCEED;
 
@@ -3278,6 +3394,8 @@ done:
 uint16
 GRidtoref(int32 riid)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr;        /* ptr to the image to work with */
     uint16     ret_value = 0; /* FAIL? */
 
@@ -3335,6 +3453,8 @@ done:
 int32
 GRreftoindex(int32 grid, uint16 ref)
 {
+    H4_API_ENTER;
+
     gr_info_t *gr_ptr; /* ptr to the GR information for this grid */
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     void     **t;      /* temp. ptr to the image found */
@@ -3396,6 +3516,8 @@ done:
 int
 GRreqlutil(int32 riid, int il)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     int        ret_value = SUCCEED;
 
@@ -3448,6 +3570,8 @@ done:
 int
 GRreqimageil(int32 riid, int il)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     int        ret_value = SUCCEED;
 
@@ -3498,6 +3622,8 @@ done:
 int32
 GRgetlutid(int32 riid, int32 lut_index)
 {
+    H4_API_ENTER;
+
     int32 ret_value = SUCCEED;
 
     /* clear error stack and check validity of args */
@@ -3540,6 +3666,8 @@ done:
 uint16
 GRluttoref(int32 lutid)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     uint16     ret_value = 0;
 
@@ -3589,6 +3717,8 @@ done:
 int
 GRgetlutinfo(int32 lutid, int32 *ncomp, int32 *nt, int32 *il, int32 *nentries)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     int        ret_value = SUCCEED;
 
@@ -3659,6 +3789,8 @@ done:
 int
 GRwritelut(int32 lutid, int32 ncomps, int32 nt, int32 il, int32 nentries, void *data)
 {
+    H4_API_ENTER;
+
     int32      hdf_file_id; /* file ID from Hopen */
     ri_info_t *ri_ptr;      /* ptr to the image to work with */
     int        ret_value = SUCCEED;
@@ -3741,6 +3873,8 @@ done:
 int
 GRreadlut(int32 lutid, void *data)
 {
+    H4_API_ENTER;
+
     int32      hdf_file_id; /* file ID from Hopen */
     ri_info_t *ri_ptr;      /* ptr to the image to work with */
     int        ret_value = SUCCEED;
@@ -3816,6 +3950,8 @@ done:
 int
 GRsetexternalfile(int32 riid, const char *filename, int32 offset)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr;  /* ptr to the image to work with */
     int32      tmp_aid; /* AID returned from HXcreate() */
     int        ret_value = SUCCEED;
@@ -3892,6 +4028,8 @@ done:
 int
 GRsetaccesstype(int32 riid, unsigned accesstype)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     int        ret_value = SUCCEED;
 
@@ -3939,6 +4077,8 @@ done:
 int
 GRsetup_szip_parms(ri_info_t *ri_ptr, comp_info *c_info, int32 *cdims)
 {
+    H4_API_ENTER;
+
     int32 nt;
     int32 ndims;
     int32 ncomp;
@@ -3983,6 +4123,8 @@ GRsetup_szip_parms(ri_info_t *ri_ptr, comp_info *c_info, int32 *cdims)
 int
 GRsetcompress(int32 riid, comp_coder_t comp_type, comp_info *cinfo)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     comp_info  cinfo_x;
     uint32     comp_config;
@@ -4096,6 +4238,8 @@ done:
 int
 GRgetcompress(int32 riid, comp_coder_t *comp_type, comp_info *cinfo)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     ret_value = GRgetcompinfo(riid, comp_type, cinfo);
@@ -4165,6 +4309,8 @@ done:
 int
 GRgetcomptype(int32 riid, comp_coder_t *comp_type)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     int32      file_id;
     uint16     scheme; /* compression scheme used for old images */
@@ -4242,6 +4388,8 @@ done:
 int
 GRgetcompinfo(int32 riid, comp_coder_t *comp_type, comp_info *cinfo)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr; /* ptr to the image to work with */
     int32      file_id;
     uint16     scheme; /* compression scheme used for JPEG images */
@@ -4328,6 +4476,8 @@ done:
 int
 GRsetattr(int32 id, const char *name, int32 attr_nt, int32 count, const void *data)
 {
+    H4_API_ENTER;
+
     int32      hdf_file_id;       /* HDF file ID from Hopen */
     gr_info_t *gr_ptr;            /* ptr to the GR information for this grid */
     ri_info_t *ri_ptr = NULL;     /* ptr to the image to work with */
@@ -4529,6 +4679,8 @@ done:
 int
 GRattrinfo(int32 id, int32 index, char *name, int32 *attr_nt, int32 *count)
 {
+    H4_API_ENTER;
+
     gr_info_t *gr_ptr;      /* ptr to the GR information for this grid */
     ri_info_t *ri_ptr;      /* ptr to the image to work with */
     void     **t;           /* temp. ptr to the image found */
@@ -4607,6 +4759,8 @@ done:
 int
 GRgetattr(int32 id, int32 index, void *data)
 {
+    H4_API_ENTER;
+
     int32      hdf_file_id; /* HDF file ID from Hopen */
     gr_info_t *gr_ptr;      /* ptr to the GR information for this grid */
     ri_info_t *ri_ptr;      /* ptr to the image to work with */
@@ -4714,6 +4868,8 @@ done:
 int32
 GRfindattr(int32 id, const char *name)
 {
+    H4_API_ENTER;
+
     gr_info_t *gr_ptr;      /* ptr to the GR information for this grid */
     ri_info_t *ri_ptr;      /* ptr to the image to work with */
     void     **t;           /* temp. ptr to the image found */
@@ -5045,6 +5201,8 @@ GRsetchunk(int32         riid,      /* IN: raster access id */
            HDF_CHUNK_DEF chunk_def, /* IN: chunk definition */
            int32         flags /* IN: flags */)
 {
+    H4_API_ENTER;
+
     ri_info_t     *ri_ptr = NULL;     /* ptr to the image to work with */
     HCHUNK_DEF     chunk[1];          /* H-level chunk definition */
     HDF_CHUNK_DEF *cdef = NULL;       /* GR Chunk definition */
@@ -5297,6 +5455,8 @@ GRgetchunkinfo(int32          riid,      /* IN: sds access id */
                HDF_CHUNK_DEF *chunk_def, /* IN/OUT: chunk definition */
                int32         *flags /* IN/OUT: flags */)
 {
+    H4_API_ENTER;
+
     ri_info_t      *ri_ptr = NULL;       /* ptr to the image to work with */
     sp_info_block_t info_block;          /* special info block */
     int16           special;             /* Special code */
@@ -5399,6 +5559,8 @@ GRwritechunk(int32       riid,   /* IN: access aid to GR */
              int32      *origin, /* IN: origin of chunk to write */
              const void *datap /* IN: buffer for data */)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr = NULL;        /* ptr to the image to work with */
     unsigned   pixel_mem_size,       /* size of a pixel in memory */
         pixel_disk_size;             /* size of a pixel on disk */
@@ -5406,7 +5568,6 @@ GRwritechunk(int32       riid,   /* IN: access aid to GR */
     int16           special;         /* Special code */
     int32           csize;           /* physical chunk size */
     sp_info_block_t info_block;      /* special info block */
-    int8            platnumsubclass; /* the machine type of the current platform */
     unsigned        convert;         /* whether to convert or not */
     int             i;
     uint16          scheme; /* compression scheme used for JPEG images */
@@ -5494,10 +5655,7 @@ GRwritechunk(int32       riid,   /* IN: access aid to GR */
                 pixel_disk_size = (unsigned)(ri_ptr->img_dim.ncomps * DFKNTsize(ri_ptr->img_dim.nt));
 
                 /* figure out if data needs to be converted */
-                /* Get number-type and conversion information */
-                if (FAIL == (platnumsubclass = DFKgetPNSC(ri_ptr->img_dim.nt & (~DFNT_LITEND), DF_MT)))
-                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                convert = (ri_ptr->img_dim.file_nt_subclass != platnumsubclass) ||
+                convert = !DFKiscopyNT(ri_ptr->img_dim.nt) ||
                           (pixel_mem_size != pixel_disk_size); /* is conversion necessary? */
 
                 /* check interlace */
@@ -5592,6 +5750,8 @@ GRreadchunk(int32  riid,   /* IN: access aid to GR */
             int32 *origin, /* IN: origin of chunk to write */
             void  *datap /* IN/OUT: buffer for data */)
 {
+    H4_API_ENTER;
+
     ri_info_t      *ri_ptr = NULL;   /* ptr to the image to work with */
     unsigned        pixel_mem_size;  /* size of a pixel in memory */
     unsigned        pixel_disk_size; /* size of a pixel on disk */
@@ -5599,7 +5759,6 @@ GRreadchunk(int32  riid,   /* IN: access aid to GR */
     int16           special;         /* Special code */
     int32           csize;           /* physical chunk size */
     sp_info_block_t info_block;      /* special info block */
-    int8            platnumsubclass; /* the machine type of the current platform */
     unsigned        convert;         /* whether to convert or not */
     int             i;
     uint16          scheme; /* compression scheme used for JPEG images */
@@ -5690,10 +5849,7 @@ GRreadchunk(int32  riid,   /* IN: access aid to GR */
                 pixel_disk_size = (unsigned)(ri_ptr->img_dim.ncomps * DFKNTsize(ri_ptr->img_dim.nt));
 
                 /* figure out if data needs to be converted */
-                /* Get number-type and conversion information */
-                if (FAIL == (platnumsubclass = DFKgetPNSC(ri_ptr->img_dim.nt & (~DFNT_LITEND), DF_MT)))
-                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                convert = (ri_ptr->img_dim.file_nt_subclass != platnumsubclass) ||
+                convert = !DFKiscopyNT(ri_ptr->img_dim.nt) ||
                           (pixel_mem_size != pixel_disk_size); /* is conversion necessary? */
 
                 /* read chunk in */
@@ -5809,6 +5965,8 @@ GRsetchunkcache(int32 riid,     /* IN: access aid to mess with */
                 int32 maxcache, /* IN: max number of chunks to cache */
                 int32 flags /* IN: flags = 0, HDF_CACHEALL */)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr = NULL; /* ptr to the image to work with */
     int16      special;       /* Special code */
     int        ret_value = SUCCEED;
@@ -5894,6 +6052,8 @@ MODIFICATION
 int
 GR2bmapped(int32 riid, int *tobe_mapped, int *name_generated)
 {
+    H4_API_ENTER;
+
     ri_info_t *ri_ptr;             /* ptr to the image to work with */
     int        should_map = FALSE; /* TRUE if the image should be mapped */
     uint16     img_tag, img_ref;   /* shortcuts image's tag/ref */
@@ -94,6 +94,9 @@ typedef struct tbbt_tree_private {
 
 /* Pointer to the tbbt node free list */
 static TBBT_NODE *tbbt_free_list = NULL;
+#ifdef H4_HAVE_THREADSAFE
+static pthread_mutex_t tbbt_free_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 #define KEYcmp(k1, k2, a)                                                                                    \
     ((NULL != compar) ? (*compar)(k1, k2, a) : memcmp(k1, k2, 0 < (a) ? (a) : (int)strlen(k1)))
@@ -926,11 +929,14 @@ tbbt_get_node(void)
 {
     TBBT_NODE *ret_value = NULL;
 
+    H4_MUTEX_LOCK(&tbbt_free_lock);
     if (tbbt_free_list != NULL) {
         ret_value      = tbbt_free_list;
         tbbt_free_list = tbbt_free_list->Lchild;
     }
-    else {
+    H4_MUTEX_UNLOCK(&tbbt_free_lock);
+
+    if (ret_value == NULL) {
         if (NULL == (ret_value = (TBBT_NODE *)calloc(1, sizeof(TBBT_NODE))))
             goto error;
         if (NULL == (ret_value->priv = (TBBT_NODE_PRIV *)calloc(1, sizeof(TBBT_NODE_PRIV))))
@@ -960,8 +966,10 @@ static void
 tbbt_release_node(TBBT_NODE *nod)
 {
     /* Insert the atom at the beginning of the free list */
+    H4_MUTEX_LOCK(&tbbt_free_lock);
     nod->Lchild    = tbbt_free_list;
     tbbt_free_list = nod;
+    H4_MUTEX_UNLOCK(&tbbt_free_lock);
 } /* end tbbt_release_node() */
 
 /*--------------------------------------------------------------------------
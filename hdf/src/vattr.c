@@ -204,6 +204,8 @@ DESCRIPTION
 int
 VSfindex(int32 vsid, const char *fieldname, int32 *findex)
 {
+    H4_API_ENTER;
+
     vsinstance_t   *vs_inst;
     VDATA          *vs;
     DYN_VWRITELIST *w;
@@ -272,6 +274,8 @@ DESCRIPTION
 int
 VSsetattr(int32 vsid, int32 findex, const char *attrname, int32 datatype, int32 count, const void *values)
 {
+    H4_API_ENTER;
+
     vsinstance_t   *vs_inst, *attr_inst;
     VDATA          *vs, *attr_vs;
     DYN_VWRITELIST *w, *attr_w;
@@ -382,6 +386,8 @@ DESCRIPTION
 int
 VSnattrs(int32 vsid)
 {
+    H4_API_ENTER;
+
     vsinstance_t *vs_inst;
     VDATA        *vs;
     int32         ret_value = SUCCEED;
@@ -419,6 +425,8 @@ DESCRIPTION
 int
 VSfnattrs(int32 vsid, int32 findex)
 {
+    H4_API_ENTER;
+
     vsinstance_t *vs_inst;
     VDATA        *vs;
     int32         ret_value = SUCCEED;
@@ -468,6 +476,8 @@ DESCRIPTION
 int
 VSfindattr(int32 vsid, int32 findex, const char *attrname)
 {
+    H4_API_ENTER;
+
     VDATA        *vs, *attr_vs;
     vsinstance_t *vs_inst, *attr_inst;
     vs_attr_t    *vs_alist;
@@ -555,6 +565,8 @@ DESCRIPTION
 int
 VSattrinfo(int32 vsid, int32 findex, int attrindex, char *name, int32 *datatype, int32 *count, int32 *size)
 {
+    H4_API_ENTER;
+
     VDATA          *vs, *attr_vs;
     vs_attr_t      *vs_alist;
     vsinstance_t   *vs_inst, *attr_inst;
@@ -641,6 +653,8 @@ DESCRIPTION
 int
 VSgetattr(int32 vsid, int32 findex, int attrindex, void *values)
 {
+    H4_API_ENTER;
+
     VDATA        *vs, *attr_vs;
     vs_attr_t    *vs_alist;
     vsinstance_t *vs_inst, *attr_inst;
@@ -724,6 +738,8 @@ DESCRIPTION
 int
 VSisattr(int32 vsid)
 {
+    H4_API_ENTER;
+
     vsinstance_t *vs_inst;
     VDATA        *vs;
     int32         ret_value = FALSE;
@@ -767,6 +783,8 @@ DESCRIPTION
 int
 Vsetattr(int32 vgid, const char *attrname, int32 datatype, int32 count, const void *values)
 {
+    H4_API_ENTER;
+
     VGROUP         *vg;
     VDATA          *vs;
     vginstance_t   *v;
@@ -878,6 +896,8 @@ DESCRIPTION
 int32
 Vgetversion(int32 vgid)
 {
+    H4_API_ENTER;
+
     VGROUP       *vg;
     vginstance_t *v;
     int16         vg_version;
@@ -915,6 +935,8 @@ DESCRIPTION
 int
 Vnattrs(int32 vgid)
 {
+    H4_API_ENTER;
+
     VGROUP       *vg;
     vginstance_t *v;
     int32         ret_value = SUCCEED;
@@ -982,6 +1004,8 @@ DESCRIPTION
 int
 Vnoldattrs(int32 vgid)
 {
+    H4_API_ENTER;
+
     VGROUP       *vg;
     vginstance_t *v;
     int           n_old_attrs = 0;
@@ -1084,6 +1108,8 @@ DESCRIPTION
 int
 Vnattrs2(int32 vgid)
 {
+    H4_API_ENTER;
+
     int   n_new_attrs = 0, n_old_attrs = 0;
     int32 ret_value = SUCCEED;
 
@@ -1120,6 +1146,8 @@ done:
 int
 Vfindattr(int32 vgid, const char *attrname)
 {
+    H4_API_ENTER;
+
     VGROUP       *vg;
     VDATA        *vs;
     vginstance_t *v;
@@ -1195,6 +1223,8 @@ DESCRIPTION
 int
 Vattrinfo(int32 vgid, int attrindex, char *name, int32 *datatype, int32 *count, int32 *size)
 {
+    H4_API_ENTER;
+
     VGROUP         *vg;
     VDATA          *vs;
     DYN_VWRITELIST *w;
@@ -1294,6 +1324,8 @@ int
 Vattrinfo2(int32 vgid, int attrindex, char *name, int32 *datatype, int32 *count, int32 *size, int32 *nfields,
            uint16 *refnum)
 {
+    H4_API_ENTER;
+
     VGROUP         *vg;
     VDATA          *vs;
     DYN_VWRITELIST *w;
@@ -1390,6 +1422,8 @@ DESCRIPTION
 int
 Vgetattr(int32 vgid, int attrindex, void *values)
 {
+    H4_API_ENTER;
+
     VGROUP       *vg;
     VDATA        *vs;
     char          fields[FIELDNAMELENMAX];
@@ -1465,6 +1499,8 @@ DESCRIPTION
 int
 Vgetattr2(int32 vgid, int attrindex, void *values)
 {
+    H4_API_ENTER;
+
     VGROUP       *vg;
     VDATA        *vs;
     char          fields[FIELDNAMELENMAX];
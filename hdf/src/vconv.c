@@ -110,6 +110,8 @@ static void oldunpackvs(VDATA *vs, uint8 buf[], int32 *size);
 int32
 vicheckcompat(HFILEID f)
 {
+    H4_API_ENTER;
+
     int16 foundold, foundnew;
     int32 aid;
 
@@ -170,6 +172,8 @@ vicheckcompat(HFILEID f)
 int32
 vimakecompat(HFILEID f)
 {
+    H4_API_ENTER;
+
     VGROUP  *vg;
     VDATA   *vs;
     uint8   *buf       = NULL; /* to store an old vdata or vgroup descriptor  */
@@ -302,6 +306,7 @@ vimakecompat(HFILEID f)
 int32
 vcheckcompat(char *fs)
 {
+    H4_API_ENTER;
 
     HFILEID f;
     int32   ret;
@@ -330,6 +335,8 @@ vcheckcompat(char *fs)
 int32
 vmakecompat(char *fs)
 {
+    H4_API_ENTER;
+
     HFILEID f;
     int32   ret;
 
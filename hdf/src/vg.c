@@ -43,6 +43,8 @@ EXPORTED ROUTINES
                        the vgroup with the specified class
      VSfindclass    -- looks in the file and returns the ref of the vdata
                        with specified class
+     Vfindmany      -- looks in the file for the vgroups with given names
+     VSfindmany     -- looks in the file for the vdatas with given names
      VSsetblocksize -- sets the block size of the linked-block element.
      VSsetnumblocks -- sets the number of blocks for a linked-block element.
      VSgetblockinfo -- retrieves the block size and the number of blocks
@@ -52,6 +54,10 @@ EXPORTED ROUTINES
 PRIVATE FUNCTIONS
 =================
      matchnocase    -- compares to strings, ignoring case
+     VIfind_name    -- looks up a name or class in the name hash of a file
+     VPname_added   -- adds a name or class to the name hash of a file
+     VPname_removed -- drops the name hash of a file if a key it maps is removed
+     VPfree_names   -- frees the name hash of a file
      vscheckclass   -- checks if a given vdata has the specified class or if
                        it is user-created, which means its class name is not
                        one of the predefined HDF classes.
@@ -65,9 +71,29 @@ PRIVATE data structures in here pertain to vdata in vsdir only.
 
 /* These are used to determine whether a vdata had been created by the
    library internally, that is, not created by user's application */
-#define HDF_NUM_INTERNAL_VDS 8
-const char *HDF_INTERNAL_VDS[] = {DIM_VALS,    DIM_VALS01,      _HDF_ATTRIBUTE, _HDF_SDSVAR,
-                                  _HDF_CRDVAR, "_HDF_CHK_TBL_", RIGATTRNAME,    RIGATTRCLASS};
+#define HDF_NUM_INTERNAL_VDS 9
+const char *HDF_INTERNAL_VDS[] = {DIM_VALS,           DIM_VALS01,      _HDF_ATTRIBUTE, _HDF_SDSVAR,
+                                  _HDF_CRDVAR,        "_HDF_CHK_TBL_", RIGATTRNAME,    RIGATTRCLASS,
+                                  _HDF_VSINDEX_CLASS};
+
+/* Smallest number of buckets of the name hash of a file */
+#define VNAMES_MIN_BUCKETS 64
+
+/* An entry of the name hash of a file */
+typedef struct vname_entry_struct {
+    char                      *key;  /* name or class, stored after the entry */
+    uint32                     hash; /* VIhash_name() of kind and key */
+    vname_kind_t               kind; /* what key is */
+    uint16                     ref;  /* lowest ref of the vgroups or vdatas with that key */
+    struct vname_entry_struct *next; /* next entry of the same bucket */
+} vname_entry_t;
+
+/* The name hash of a file: the refs of its vgroups and vdatas by name
+   and by class, for Vfind, VSfind, Vfindclass and VSfindclass */
+typedef struct vnames_struct {
+    unsigned        nbuckets; /* a power of 2 */
+    vname_entry_t **buckets;
+} vnames_t;
 
 /* Private functions */
 #ifdef VDATA_FIELDS_ALL_UPPER
@@ -122,6 +148,8 @@ RETURNS
 int32
 VSelts(int32 vkey /* IN: vdata key */)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w         = NULL;
     VDATA        *vs        = NULL;
     int32         ret_value = SUCCEED;
@@ -160,6 +188,8 @@ RETURNS
 int32
 VSgetinterlace(int32 vkey /* IN: vdata key */)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w         = NULL;
     VDATA        *vs        = NULL;
     int32         ret_value = SUCCEED;
@@ -199,6 +229,8 @@ int
 VSsetinterlace(int32 vkey, /* IN: vdata key */
                int32 interlace /* IN: interlace for storing records */)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w         = NULL;
     VDATA        *vs        = NULL;
     int           ret_value = SUCCEED;
@@ -253,6 +285,8 @@ int32
 VSgetfields(int32 vkey, /* IN: vdata key */
             char *fields /* OUT: comma separated field name list */)
 {
+    H4_API_ENTER;
+
     int32         i;
     vsinstance_t *w         = NULL;
     VDATA        *vs        = NULL;
@@ -312,6 +346,8 @@ int
 VSfexist(int32 vkey, /* IN: vdata key */
          char *fields /* IN: names of fields to check for */)
 {
+    H4_API_ENTER;
+
     char          **av = NULL;
     char           *s  = NULL;
     DYN_VWRITELIST *w  = NULL;
@@ -388,6 +424,8 @@ int32
 VSsizeof(int32 vkey, /* IN vdata key */
          char *fields /* IN: Name(s) of the fields to check size of */)
 {
+    H4_API_ENTER;
+
     int32         totalsize;
     int32         i, j;
     int32         found;
@@ -461,6 +499,8 @@ RETURNS
 void
 VSdump(int32 vkey /* IN: vdata key */)
 {
+    H4_API_ENTER;
+
     (void)vkey;
 } /* VSdump */
 
@@ -481,6 +521,8 @@ int32
 VSsetname(int32       vkey, /* IN: Vdata key */
           const char *vsname /* IN: name to set for vdata*/)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w        = NULL;
     VDATA        *vs       = NULL;
     int32         curr_len = 0;
@@ -508,12 +550,14 @@ VSsetname(int32       vkey, /* IN: Vdata key */
     curr_len = strnlen(vs->vsname, VSNAMELENMAX + 1);
 
     /* check length of new name against MAX length */
+    VPname_removed(vs->f, VNAME_VSNAME, vs->vsname, vs->oref);
     if ((slen = strlen(vsname)) > VSNAMELENMAX) { /* truncate name */
         strncpy(vs->vsname, vsname, VSNAMELENMAX);
         vs->vsname[VSNAMELENMAX] = '\0';
     }
     else /* copy whole name */
         strcpy(vs->vsname, vsname);
+    VPname_added(vs->f, VNAME_VSNAME, vs->vsname, vs->oref);
 
     vs->marked = TRUE; /* mark vdata as being modified */
 
@@ -541,6 +585,8 @@ int32
 VSsetclass(int32       vkey, /* IN: vdata key */
            const char *vsclass /* IN: class name to set for vdata */)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w  = NULL;
     VDATA        *vs = NULL;
     int32         curr_len;
@@ -568,12 +614,14 @@ VSsetclass(int32       vkey, /* IN: vdata key */
     curr_len = (int)strlen(vs->vsclass);
 
     /* check length of new class name against MAX length */
+    VPname_removed(vs->f, VNAME_VSCLASS, vs->vsclass, vs->oref);
     if ((slen = (int)strlen(vsclass)) > VSNAMELENMAX) {
         strncpy(vs->vsclass, vsclass, VSNAMELENMAX);
         vs->vsclass[VSNAMELENMAX] = '\0';
     }
     else
         strcpy(vs->vsclass, vsclass);
+    VPname_added(vs->f, VNAME_VSCLASS, vs->vsclass, vs->oref);
 
     vs->marked = TRUE; /* mark vdata as being modified */
 
@@ -599,6 +647,8 @@ int32
 VSgetname(int32 vkey, /* IN: vdata key */
           char *vsname /* OUT: vdata name (allocated by user)*/)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w         = NULL;
     VDATA        *vs        = NULL;
     int32         ret_value = SUCCEED;
@@ -642,6 +692,8 @@ int32
 VSgetclass(int32 vkey, /* IN: vdata key */
            char *vsclass /* OUT: class name for vdata (allocated by user) */)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w         = NULL;
     VDATA        *vs        = NULL;
     int32         ret_value = SUCCEED;
@@ -690,6 +742,8 @@ VSinquire(int32  vkey,      /* IN: vdata key */
           int32 *eltsize,   /* OUT: total size of all fields in bytes */
           char  *vsname /* OUT: name of vdata */)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
     int status;
 
@@ -742,6 +796,8 @@ VSlone(HFILEID f,       /* IN: file id */
        int32  *idarray, /* OUT: array to return refs of lone vdatas? */
        int32   asize /* IN: size of 'idarray' */)
 {
+    H4_API_ENTER;
+
     int32  i;
     int32  vgid;
     int32  vsid;
@@ -809,6 +865,8 @@ Vlone(HFILEID f,       /* IN: file id */
       int32  *idarray, /* OUT: array to return refs of lone vgroups? */
       int32   asize /* IN: size of 'idarray' */)
 {
+    H4_API_ENTER;
+
     int32  i;
     int32  vgid;
     int32  vstag;
@@ -860,6 +918,267 @@ done:
     return ret_value;
 } /* Vlone */
 
+/* -----------------------------------------------------------------
+NAME
+   VIhash_name -- (PRIVATE) hashes a key of the name hash of a file
+
+DESCRIPTION
+   FNV-1a hash of the key, seeded with its kind.
+
+RETURNS
+   The hash value.
+-----------------------------------------------------------------------*/
+static uint32
+VIhash_name(vname_kind_t kind, const char *key)
+{
+    uint32 h = 2166136261U ^ (uint32)kind;
+
+    for (; *key != '\0'; key++)
+        h = (h ^ (uint8)*key) * 16777619U;
+    return h;
+} /* VIhash_name */
+
+/* -----------------------------------------------------------------
+NAME
+   VIlookup_name -- (PRIVATE) finds the entry of a key in a name hash
+
+RETURNS
+   The entry, or NULL if the key is not in the hash.
+-----------------------------------------------------------------------*/
+static vname_entry_t *
+VIlookup_name(vnames_t *names, vname_kind_t kind, const char *key, uint32 h)
+{
+    vname_entry_t *e;
+
+    for (e = names->buckets[h & (names->nbuckets - 1)]; e != NULL; e = e->next)
+        if (e->hash == h && e->kind == kind && strcmp(e->key, key) == 0)
+            return e;
+    return NULL;
+} /* VIlookup_name */
+
+/* -----------------------------------------------------------------
+NAME
+   VIadd_name -- (PRIVATE) adds a key to a name hash
+
+DESCRIPTION
+   The hash keeps the lowest ref of the vgroups or vdatas with the same
+   key, the one a walk through the file with Vgetid or VSgetid meets
+   first.  A NULL key is not added.
+
+RETURNS
+   SUCCEED/FAIL
+-----------------------------------------------------------------------*/
+static int
+VIadd_name(vnames_t *names, vname_kind_t kind, const char *key, uint16 ref)
+{
+    vname_entry_t *e;
+    size_t         len;
+    uint32         h;
+
+    if (key == NULL)
+        return SUCCEED;
+
+    h = VIhash_name(kind, key);
+    if ((e = VIlookup_name(names, kind, key, h)) != NULL) {
+        if (ref < e->ref)
+            e->ref = ref;
+        return SUCCEED;
+    }
+
+    len = strlen(key);
+    if (NULL == (e = (vname_entry_t *)malloc(sizeof(vname_entry_t) + len + 1)))
+        return FAIL;
+    e->key = (char *)(e + 1);
+    memcpy(e->key, key, len + 1);
+    e->hash = h;
+    e->kind = kind;
+    e->ref  = ref;
+    e->next = names->buckets[h & (names->nbuckets - 1)];
+
+    names->buckets[h & (names->nbuckets - 1)] = e;
+    return SUCCEED;
+} /* VIadd_name */
+
+/* -----------------------------------------------------------------
+NAME
+   VIdestroy_names -- (PRIVATE) frees a name hash
+
+RETURNS
+   Nothing
+-----------------------------------------------------------------------*/
+static void
+VIdestroy_names(vnames_t *names)
+{
+    vname_entry_t *e, *next;
+    unsigned       i;
+
+    if (names == NULL)
+        return;
+
+    if (names->buckets != NULL)
+        for (i = 0; i < names->nbuckets; i++)
+            for (e = names->buckets[i]; e != NULL; e = next) {
+                next = e->next;
+                free(e);
+            }
+    free(names->buckets);
+    free(names);
+} /* VIdestroy_names */
+
+/* -----------------------------------------------------------------
+NAME
+   VIbuild_names -- (PRIVATE) builds the name hash of a file
+
+DESCRIPTION
+   Reads the header of every vgroup and vdata of the file that has not
+   been read yet, and hashes their names and classes.  Those whose
+   header cannot be read are left out.
+
+RETURNS
+   The hash, or NULL on error.
+-----------------------------------------------------------------------*/
+static vnames_t *
+VIbuild_names(HFILEID f, vfile_t *vf)
+{
+    vnames_t     *names    = NULL;
+    vginstance_t *v        = NULL;
+    vsinstance_t *w        = NULL;
+    void        **t        = NULL;
+    unsigned      nbuckets = VNAMES_MIN_BUCKETS;
+    vnames_t     *ret_value = NULL;
+
+    while (nbuckets < 2 * (unsigned)(vf->vgtabn + vf->vstabn))
+        nbuckets <<= 1;
+
+    if (NULL == (names = (vnames_t *)calloc(1, sizeof(vnames_t))))
+        HGOTO_ERROR(DFE_NOSPACE, NULL);
+    names->nbuckets = nbuckets;
+    if (NULL == (names->buckets = (vname_entry_t **)calloc(nbuckets, sizeof(vname_entry_t *))))
+        HGOTO_ERROR(DFE_NOSPACE, NULL);
+
+    for (t = (void **)tbbtfirst(vf->vgtree->root); t != NULL; t = (void **)tbbtnext((TBBT_NODE *)t)) {
+        v = (vginstance_t *)*t;
+        if (v->vg == NULL && vginst(f, (uint16)v->ref) == NULL)
+            continue;
+        if (VIadd_name(names, VNAME_VGNAME, v->vg->vgname, (uint16)v->ref) == FAIL ||
+            VIadd_name(names, VNAME_VGCLASS, v->vg->vgclass, (uint16)v->ref) == FAIL)
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+    }
+
+    for (t = (void **)tbbtfirst(vf->vstree->root); t != NULL; t = (void **)tbbtnext((TBBT_NODE *)t)) {
+        w = (vsinstance_t *)*t;
+        if (w->vs == NULL && vsinst(f, (uint16)w->ref) == NULL)
+            continue;
+        if (VIadd_name(names, VNAME_VSNAME, w->vs->vsname, (uint16)w->ref) == FAIL ||
+            VIadd_name(names, VNAME_VSCLASS, w->vs->vsclass, (uint16)w->ref) == FAIL)
+            HGOTO_ERROR(DFE_NOSPACE, NULL);
+    }
+
+    /* the headers that could not be read are not errors of the lookup */
+    HEclear();
+
+    ret_value = names;
+
+done:
+    if (ret_value == NULL)
+        VIdestroy_names(names);
+    return ret_value;
+} /* VIbuild_names */
+
+/* -----------------------------------------------------------------
+NAME
+   VIfind_name -- (PRIVATE) looks up a name or class in a file
+
+DESCRIPTION
+   Builds the name hash of the file on its first lookup.
+
+RETURNS
+   The lowest ref of the vgroups or vdatas with that name or class, 0
+   if there is none or on error.
+-----------------------------------------------------------------------*/
+static int32
+VIfind_name(HFILEID f, vname_kind_t kind, const char *key)
+{
+    vfile_t       *vf        = NULL;
+    vname_entry_t *e         = NULL;
+    int32          ret_value = 0;
+
+    if (NULL == (vf = Get_vfile(f)))
+        HGOTO_ERROR(DFE_FNF, 0);
+
+    if (vf->names == NULL && NULL == (vf->names = VIbuild_names(f, vf)))
+        HGOTO_DONE(0);
+
+    if ((e = VIlookup_name(vf->names, kind, key, VIhash_name(kind, key))) != NULL)
+        ret_value = (int32)e->ref;
+
+done:
+    return ret_value;
+} /* VIfind_name */
+
+/* -----------------------------------------------------------------
+NAME
+   VPname_added -- a vgroup or vdata has a new name or class
+
+DESCRIPTION
+   Adds the key to the name hash of the file, if it was built.
+
+RETURNS
+   Nothing
+-----------------------------------------------------------------------*/
+void
+VPname_added(HFILEID f, vname_kind_t kind, const char *key, uint16 ref)
+{
+    vfile_t *vf = NULL;
+
+    if (NULL == (vf = Get_vfile(f)) || vf->names == NULL)
+        return;
+
+    /* out of memory: rebuild it on the next lookup */
+    if (VIadd_name(vf->names, kind, key, ref) == FAIL)
+        VPfree_names(vf);
+} /* VPname_added */
+
+/* -----------------------------------------------------------------
+NAME
+   VPname_removed -- a vgroup or vdata loses its name or class
+
+DESCRIPTION
+   Called before a name or class is changed, or the vgroup or vdata is
+   deleted.  If the hash of the file maps the key to this vgroup or
+   vdata, another one may have the same key: the hash is dropped, to be
+   built again on the next lookup.
+
+RETURNS
+   Nothing
+-----------------------------------------------------------------------*/
+void
+VPname_removed(HFILEID f, vname_kind_t kind, const char *key, uint16 ref)
+{
+    vfile_t       *vf = NULL;
+    vname_entry_t *e  = NULL;
+
+    if (key == NULL || NULL == (vf = Get_vfile(f)) || vf->names == NULL)
+        return;
+
+    if ((e = VIlookup_name(vf->names, kind, key, VIhash_name(kind, key))) != NULL && e->ref == ref)
+        VPfree_names(vf);
+} /* VPname_removed */
+
+/* -----------------------------------------------------------------
+NAME
+   VPfree_names -- frees the name hash of a file
+
+RETURNS
+   Nothing
+-----------------------------------------------------------------------*/
+void
+VPfree_names(vfile_t *vf)
+{
+    VIdestroy_names(vf->names);
+    vf->names = NULL;
+} /* VPfree_names */
+
 /* -----------------------------------------------------------------
 NAME
    Vfind -- looks in the file and returns the ref of
@@ -867,7 +1186,9 @@ NAME
 
 DESCRIPTION
    Finds the vgroup with the specified name and returns the ref of
-   the vgroup if successful.
+   the vgroup if successful.  The first lookup in a file hashes the
+   names and classes of all its vgroups and vdatas; the others use
+   the hash.
 
 RETURNS
    Returns 0 if not found or on error. Otherwise, returns the
@@ -877,30 +1198,15 @@ int32
 Vfind(HFILEID     f, /* IN: file id */
       const char *vgname /* IN: name of vgroup to find */)
 {
-    int32         vgid      = -1;
-    vginstance_t *v         = NULL;
-    VGROUP       *vg        = NULL;
-    int32         ret_value = 0;
+    H4_API_ENTER;
+
+    int32 ret_value = 0;
 
     /* check for null vgroup name */
     if (vgname == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* process through Vgroups in file */
-    while (FAIL != (vgid = Vgetid(f, vgid))) { /* get instance of vgroup */
-        if ((v = vginst(f, (uint16)vgid)) == NULL)
-            HGOTO_DONE(0);
-
-        /* get vgroup itself and check it */
-        vg = v->vg;
-        if (vg == NULL)
-            HGOTO_DONE(0);
-
-        /* compare vgroup name to 'vgname' if it had been set */
-        if (vg->vgname != NULL)
-            if (!strcmp(vgname, vg->vgname))
-                HGOTO_DONE((int32)(vg->oref)); /* found the vgroup */
-    }
+    ret_value = VIfind_name(f, VNAME_VGNAME, vgname);
 
 done:
     return ret_value;
@@ -913,7 +1219,8 @@ NAME
 
 DESCRIPTION
    Finds the vdata with the specified name and returns the ref of
-   the vdata if successful.
+   the vdata if successful.  Like Vfind, it uses the name hash of
+   the file.
 
 RETURNS
    Returns 0 if not found, or on error. Otherwise, returns the vdata's
@@ -923,29 +1230,15 @@ int32
 VSfind(HFILEID     f, /* IN: file id */
        const char *vsname /* IN: name of vdata to find */)
 {
-    int32         vsid      = -1;
-    vsinstance_t *v         = NULL;
-    VDATA        *vs        = NULL;
-    int32         ret_value = 0;
+    H4_API_ENTER;
+
+    int32 ret_value = 0;
 
     /* check for null vdata name */
     if (vsname == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* process through Vdatas in file */
-    while (FAIL != (vsid = VSgetid(f, vsid))) { /* get instance of vdata */
-        if ((v = vsinst(f, (uint16)vsid)) == NULL)
-            HGOTO_DONE(0);
-
-        /* get vdata itself and check it */
-        vs = v->vs;
-        if (vs == NULL)
-            HGOTO_DONE(0);
-
-        /* compare vdata name to 'vsname' if it had been set */
-        if (!strcmp(vsname, vs->vsname))
-            HGOTO_DONE((int32)(vs->oref)); /* found the vdata */
-    }
+    ret_value = VIfind_name(f, VNAME_VSNAME, vsname);
 
 done:
     return ret_value;
@@ -958,7 +1251,8 @@ NAME
 
 DESCRIPTION
    Finds the vgroup with the specified class and returns the ref
-   of the vgroup if successful.
+   of the vgroup if successful.  Like Vfind, it uses the name hash
+   of the file.
 
 RETURNS
    Returns 0 if not found, or error. Otherwise, returns the
@@ -968,32 +1262,15 @@ int32
 Vfindclass(HFILEID     f, /* IN: file id */
            const char *vgclass /* IN: class of vgroup to find */)
 {
-    int32         vgid      = -1;
-    vginstance_t *v         = NULL;
-    VGROUP       *vg        = NULL;
-    int32         ret_value = 0;
+    H4_API_ENTER;
+
+    int32 ret_value = 0;
 
     /* check for null vgroup class */
     if (vgclass == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* process through Vgroups in file */
-    while (FAIL != (vgid = Vgetid(f, vgid))) { /* get instance of vgroup */
-        if ((v = vginst(f, (uint16)vgid)) == NULL)
-            HGOTO_DONE(0);
-
-        /* get vgroup itself and check it */
-        vg = v->vg;
-        if (vg == NULL)
-            HGOTO_DONE(0);
-        /* Shouldn't we move on to the next vgroup instead of getting out?
-           Same question for the above HGOTO_DONE. -BMR 9/12/2011 */
-
-        /* compare vgroup class to 'vgclass' if it had been set */
-        if (vg->vgclass != NULL)
-            if (!strcmp(vgclass, vg->vgclass))
-                HGOTO_DONE((int32)(vg->oref)); /* found the vgroup */
-    }
+    ret_value = VIfind_name(f, VNAME_VGCLASS, vgclass);
 
 done:
     return ret_value;
@@ -1006,7 +1283,8 @@ NAME
 
 DESCRIPTION
    Finds the vdata with the specified class and returns the ref of
-   the vdata if successful.
+   the vdata if successful.  Like Vfind, it uses the name hash of
+   the file.
 
 RETURNS
    Returns 0 if not found, or error. Otherwise, returns the vdata's
@@ -1016,33 +1294,103 @@ int32
 VSfindclass(HFILEID     f, /* IN: file id */
             const char *vsclass /* IN: class of vdata to find */)
 {
-    int32         vsid      = -1;
-    vsinstance_t *v         = NULL;
-    VDATA        *vs        = NULL;
-    int32         ret_value = 0;
+    H4_API_ENTER;
+
+    int32 ret_value = 0;
 
     /* check for null vdata class */
     if (vsclass == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
-    /* process through Vdatas in file */
-    while (FAIL != (vsid = VSgetid(f, vsid))) { /* get instance of vdata */
-        if ((v = vsinst(f, (uint16)vsid)) == NULL)
-            HGOTO_DONE(0); /* error */
+    ret_value = VIfind_name(f, VNAME_VSCLASS, vsclass);
 
-        /* get vdata itself and check it */
-        vs = v->vs;
-        if (vs == NULL)
-            HGOTO_DONE(0);
+done:
+    return ret_value;
+} /* VSfindclass */
 
-        /* compare vdata class to 'vsclass' if it had been set */
-        if (!strcmp(vsclass, vs->vsclass))
-            HGOTO_DONE((int32)(vs->oref)); /* found the vdata */
-    }
+/* -----------------------------------------------------------------
+NAME
+   Vfindmany -- looks in the file for the vgroups with given names
+
+DESCRIPTION
+   Looks up each of the n names in vgnames like Vfind, and puts the
+   ref of the vgroup with that name, or 0 if there is none, into the
+   same entry of refs.
+
+RETURNS
+   Returns the number of names found, FAIL on error.
+-----------------------------------------------------------------------*/
+int32
+Vfindmany(HFILEID           f,         /* IN: file id */
+          int32             n,         /* IN: number of names */
+          const char *const vgnames[], /* IN: names of the vgroups to find */
+          int32             refs[] /* OUT: ref of each vgroup, 0 if not found */)
+{
+    H4_API_ENTER;
+
+    int32 i;
+    int32 ret_value = 0;
+
+    /* clear error stack */
+    HEclear();
+
+    if (n < 0 || (n > 0 && (vgnames == NULL || refs == NULL)))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    for (i = 0; i < n; i++)
+        if (vgnames[i] == NULL)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (Get_vfile(f) == NULL)
+        HGOTO_ERROR(DFE_FNF, FAIL);
+
+    for (i = 0; i < n; i++)
+        if ((refs[i] = VIfind_name(f, VNAME_VGNAME, vgnames[i])) != 0)
+            ret_value++;
 
 done:
     return ret_value;
-} /* VSfindclass */
+} /* Vfindmany */
+
+/* -----------------------------------------------------------------
+NAME
+   VSfindmany -- looks in the file for the vdatas with given names
+
+DESCRIPTION
+   Looks up each of the n names in vsnames like VSfind, and puts the
+   ref of the vdata with that name, or 0 if there is none, into the
+   same entry of refs.
+
+RETURNS
+   Returns the number of names found, FAIL on error.
+-----------------------------------------------------------------------*/
+int32
+VSfindmany(HFILEID           f,         /* IN: file id */
+           int32             n,         /* IN: number of names */
+           const char *const vsnames[], /* IN: names of the vdatas to find */
+           int32             refs[] /* OUT: ref of each vdata, 0 if not found */)
+{
+    H4_API_ENTER;
+
+    int32 i;
+    int32 ret_value = 0;
+
+    /* clear error stack */
+    HEclear();
+
+    if (n < 0 || (n > 0 && (vsnames == NULL || refs == NULL)))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    for (i = 0; i < n; i++)
+        if (vsnames[i] == NULL)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (Get_vfile(f) == NULL)
+        HGOTO_ERROR(DFE_FNF, FAIL);
+
+    for (i = 0; i < n; i++)
+        if ((refs[i] = VIfind_name(f, VNAME_VSNAME, vsnames[i])) != 0)
+            ret_value++;
+
+done:
+    return ret_value;
+} /* VSfindmany */
 
 /* -----------------------------------------------------------------
 NAME
@@ -1054,6 +1402,8 @@ DESCRIPTION
    to be called before the first write to the vdata to change the block
    size from the default value HDF_APPENDABLE_BLOCK_LEN (4096).  Once the
    linked-block element is created, the block size cannot be changed.
+   When it is not set, the blocks are as large as the data the vdata
+   holds when it becomes linked-block, between 4096 bytes and 64 KB.
 
 RETURNS
    Returns SUCCEED/FAIL
@@ -1062,6 +1412,8 @@ int
 VSsetblocksize(int32 vkey,       /* IN: vdata key */
                int32 block_size) /* length to be used for each linked-block */
 {
+    H4_API_ENTER;
+
     vsinstance_t *w         = NULL;
     VDATA        *vs        = NULL;
     int           ret_value = SUCCEED;
@@ -1085,6 +1437,7 @@ VSsetblocksize(int32 vkey,       /* IN: vdata key */
     /* internal routine handles the actual setting */
     if (HLsetblockinfo(vs->aid, block_size, -1) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    vs->blksize_set = 1;
 
 done:
     return ret_value;
@@ -1112,6 +1465,8 @@ int
 VSsetnumblocks(int32 vkey,       /* IN: vdata key */
                int32 num_blocks) /* number of blocks the element can have */
 {
+    H4_API_ENTER;
+
     vsinstance_t *w         = NULL;
     VDATA        *vs        = NULL;
     int           ret_value = SUCCEED;
@@ -1162,6 +1517,8 @@ VSgetblockinfo(int32  vkey,       /* IN: vdata id */
                int32 *block_size, /* OUT: length used for each linked-block */
                int32 *num_blocks) /* OUT: number of blocks the element has */
 {
+    H4_API_ENTER;
+
     vsinstance_t *w         = NULL;
     VDATA        *vs        = NULL;
     int           ret_value = SUCCEED;
@@ -1182,6 +1539,10 @@ VSgetblockinfo(int32  vkey,       /* IN: vdata id */
     if ((vs == NULL) || (vs->otag != VSDESCTAG))
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    /* the records appended so far may make the vdata linked-block */
+    if (VSPflush(vs) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
     /* internal routine handles the actual retrieval */
     if (HLgetblockinfo(vs->aid, block_size, num_blocks) == FAIL)
         HGOTO_ERROR(DFE_INTERNAL, FAIL);
@@ -1202,6 +1563,8 @@ done:
 int
 VSisinternal(const char *classname)
 {
+    H4_API_ENTER;
+
     int i;
     int ret_value = FALSE;
 
@@ -1260,6 +1623,8 @@ VSofclass(int32       id,       /* IN: file id or vgroup id */
           unsigned    n_vds,    /* IN: number of user-created vds to return */
           uint16     *refarray /* IN/OUT: ref array to fill */)
 {
+    H4_API_ENTER;
+
     int ret_value = 0;
 
     /* clear error stack */
@@ -1566,6 +1931,8 @@ VSgetvdatas(int32          id,       /* IN: file id or vgroup id */
             const unsigned n_vds,    /* IN: number of user-created vds to return */
             uint16        *refarray /* IN/OUT: ref array to fill */)
 {
+    H4_API_ENTER;
+
     int32 ret_value = SUCCEED;
 
     /* clear error stack */
@@ -1588,4 +1955,5 @@ done:
 void
 Vsetzap(void)
 {
+    H4_API_ENTER;
 }
@@ -164,6 +164,10 @@ struct vdata_desc {
     vs_attr_t                 *alist;         /* attribute list */
     int16                      version, more; /* version and "more" field */
     int32                      aid;           /* access id - for LINKED blocks */
+    uint8                     *wbuf;          /* records appended but not written yet */
+    int32                      wbuf_len;      /* bytes in wbuf */
+    int32                      wbuf_size;     /* bytes wbuf can hold */
+    int                        blksize_set;   /* =1 if the block size was set with VSsetblocksize */
     struct vs_instance_struct *instance;      /* ptr to the instance struct for this VData */
     struct vdata_desc         *next;          /* pointer to next node (for free list only) */
 };                                            /* VDATA */
@@ -215,8 +219,13 @@ typedef struct vfiledir_struct {
     int32      vstabn; /* # of vs entries in vstab so far */
     TBBT_TREE *vstree; /* Root of VSet B-Tree */
     int        access; /* the number of active pointers to this file's Vstuff */
+
+    struct vnames_struct *names; /* refs by name and class, built by the first Vfind */
 } vfile_t;
 
+/* The keys of the name hash of a file (see Vfind) */
+typedef enum { VNAME_VGNAME = 0, VNAME_VGCLASS, VNAME_VSNAME, VNAME_VSCLASS } vname_kind_t;
+
 /* .................................................................. */
 
 #ifdef __cplusplus
@@ -230,6 +239,10 @@ VDATA *VSIget_vdata_node(void);
 
 void VSIrelease_vdata_node(VDATA *v);
 
+int VSPflush(VDATA *vs);
+
+int VSPdelete_indexes(HFILEID f, uint16 ref);
+
 int VSIgetvdatas(int32 id, const char *vsclass, const unsigned start_vd, const unsigned n_vds,
                  uint16 *refarray);
 
@@ -249,6 +262,12 @@ HDFLIBAPI int VPparse_shutdown(void);
 
 HDFLIBAPI vfile_t *Get_vfile(HFILEID f);
 
+void VPname_added(HFILEID f, vname_kind_t kind, const char *key, uint16 ref);
+
+void VPname_removed(HFILEID f, vname_kind_t kind, const char *key, uint16 ref);
+
+void VPfree_names(vfile_t *vf);
+
 HDFLIBAPI vsinstance_t *vsinst(HFILEID f, uint16 vsid);
 
 HDFLIBAPI vginstance_t *vginst(HFILEID f, uint16 vgid);
@@ -139,8 +139,8 @@ TBBT_TREE *vtree = NULL;
 static int library_terminate = FALSE;
 
 /* Temporary buffer for I/O */
-static uint32 Vgbufsize = 0;
-static uint8 *Vgbuf     = NULL;
+static H4_THREAD_LOCAL uint32 Vgbufsize = 0;
+static H4_THREAD_LOCAL uint8 *Vgbuf     = NULL;
 
 /* Pointers to the VGROUP & vginstance node free lists */
 static VGROUP       *vgroup_free_list     = NULL;
@@ -319,6 +319,8 @@ DESCRIPTION
 
    loads vgtab table with info of all vgroups in file f.
    Will allocate a new vfile_t, then proceed to load vg instances.
+   Only the refs of the vgroups and vdatas are loaded; their headers
+   are read when they are first looked up, by vginst() and vsinst().
 
 RETURNS
    RETURNS FAIL if error or no more file slots available.
@@ -386,10 +388,7 @@ Load_vfile(HFILEID f /* IN: file handle */)
         v->key = (int32)ref; /* set the key for the node */
         v->ref = (unsigned)ref;
 
-        /* get the header information */
-        v->vg = VPgetinfo(f, ref);
-        if (v->vg == NULL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        /* the header is read by vginst() when the vgroup is first used */
 
         /* insert the vg instance in B-tree */
         tbbtdins(vf->vgtree, (void *)v, NULL);
@@ -430,10 +429,7 @@ Load_vfile(HFILEID f /* IN: file handle */)
         w->key = (int32)ref; /* set the key for the node */
         w->ref = (unsigned)ref;
 
-        /* get the header information */
-        w->vs = VSPgetinfo(f, ref);
-        if (w->vs == NULL)
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        /* the header is read by vsinst() when the vdata is first used */
 
         w->nattach   = 0;
         w->nvertices = 0;
@@ -502,6 +498,7 @@ Remove_vfile(HFILEID f /* IN: file handle */)
     /* clear out the tbbt's */
     tbbtdfree(vf->vgtree, vdestroynode, NULL);
     tbbtdfree(vf->vstree, vsdestroynode, NULL);
+    VPfree_names(vf);
 
     /* Find the node in the tree */
     if ((t = (void **)tbbtdfind(vtree, (void *)&f, NULL)) == NULL)
@@ -621,6 +618,7 @@ vfdestroynode(void *n /* IN: vfile_t record to free */)
         /* clear out the tbbt's */
         tbbtdfree(vf->vgtree, vdestroynode, NULL);
         tbbtdfree(vf->vstree, vsdestroynode, NULL);
+        VPfree_names(vf);
 
         free(vf);
     }
@@ -640,6 +638,8 @@ RETURNS
 int
 Vinitialize(HFILEID f /* IN: file handle */)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* clear error stack */
@@ -677,6 +677,8 @@ RETURNS
 int
 Vfinish(HFILEID f /* IN: file handle */)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* clear error stack */
@@ -724,6 +726,10 @@ vginst(HFILEID f, /* IN: file handle */
     t   = (void **)tbbtdfind(vf->vgtree, (void *)&key, NULL);
     if (t != NULL) {
         ret_value = ((vginstance_t *)*t); /* return the actual vginstance_t ptr */
+
+        /* read the header of a vgroup not looked up before */
+        if (ret_value->vg == NULL && (ret_value->vg = VPgetinfo(f, vgid)) == NULL)
+            HGOTO_ERROR(DFE_INTERNAL, NULL);
         goto done;
     }
 
@@ -1015,6 +1021,7 @@ VPgetinfo(HFILEID f, /* IN: file handle */
 
         if ((Vgbuf = (uint8 *)malloc(Vgbufsize)) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, NULL);
+        H4_FREE_AT_THREAD_EXIT(&Vgbuf);
     }
 
     /* Get the raw Vgroup info */
@@ -1068,6 +1075,8 @@ Vattach(HFILEID     f,    /* IN: file handle */
         int32       vgid, /* IN: vgroup id */
         const char *accesstype /* IN: access type */)
 {
+    H4_API_ENTER;
+
     VGROUP       *vg       = NULL;
     vginstance_t *v        = NULL;
     vfile_t      *vf       = NULL;
@@ -1211,6 +1220,8 @@ RETURNS
 int32
 Vdetach(int32 vkey /* IN: vgroup key */)
 {
+    H4_API_ENTER;
+
     VGROUP       *vg = NULL;
     vginstance_t *v  = NULL;
     int32         vgpacksize;
@@ -1253,6 +1264,7 @@ Vdetach(int32 vkey /* IN: vgroup key */)
 
             if ((Vgbuf = (uint8 *)malloc(Vgbufsize)) == NULL)
                 HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            H4_FREE_AT_THREAD_EXIT(&Vgbuf);
         } /* end if */
 
         if (FAIL == vpackvg(vg, Vgbuf, &vgpacksize))
@@ -1320,6 +1332,8 @@ int32
 Vinsert(int32 vkey, /* IN: vgroup key */
         int32 insertkey /* IN: */)
 {
+    H4_API_ENTER;
+
     VGROUP       *vg     = NULL;
     vginstance_t *v      = NULL;
     uint16        newtag = 0;
@@ -1417,6 +1431,8 @@ int32
 Vflocate(int32 vkey, /* IN: vdata key */
          char *field /* IN: field to locate */)
 {
+    H4_API_ENTER;
+
     unsigned      u;
     vginstance_t *v  = NULL;
     VGROUP       *vg = NULL;
@@ -1481,6 +1497,8 @@ Vinqtagref(int32 vkey, /* IN: vgroup key */
            int32 tag,  /* IN: tag to check in vgroup */
            int32 ref /* IN: ref to check in vgroup */)
 {
+    H4_API_ENTER;
+
     unsigned      u;
     uint16        ttag;
     uint16        rref;
@@ -1536,6 +1554,8 @@ Vdeletetagref(int32 vkey, /* IN: vgroup key */
               int32 tag,  /* IN: tag to delete in vgroup */
               int32 ref /* IN: ref to delete in vgroup */)
 {
+    H4_API_ENTER;
+
     unsigned      i, j;             /* loop indices */
     uint16        ttag;             /* tag for comparison */
     uint16        rref;             /* ref for comparison */
@@ -1627,6 +1647,8 @@ RETURNS
 int32
 Vntagrefs(int32 vkey /* IN: vgroup key */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
     int32         ret_value = SUCCEED;
@@ -1669,6 +1691,8 @@ int32
 Vnrefs(int32 vkey, /* IN: vgroup key */
        int32 tag /* IN: tag to find refs for */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v    = NULL;
     VGROUP       *vg   = NULL;
     uint16        ttag = (uint16)tag; /* alias for faster comparison */
@@ -1721,6 +1745,8 @@ Vgettagrefs(int32 vkey,       /* IN: vgroup key */
             int32 refarray[], /* IN/OUT: ref array to fill */
             int32 n /* IN: number of pairs to return */)
 {
+    H4_API_ENTER;
+
     int32         i;
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
@@ -1777,6 +1803,8 @@ Vgettagref(int32  vkey,  /* IN: vgroup key */
            int32 *tag,   /* IN/OUT: tag to return */
            int32 *ref /* IN/OUT: ref to return */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
     int           ret_value = SUCCEED;
@@ -1821,6 +1849,8 @@ RETURNS
 int32
 VQuerytag(int32 vkey /* IN: vgroup key */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
     int32         ret_value = SUCCEED;
@@ -1860,6 +1890,8 @@ RETURN
 int32
 VQueryref(int32 vkey /* IN: vgroup id */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
     int32         ret_value = SUCCEED;
@@ -1908,6 +1940,8 @@ Vaddtagref(int32 vkey, /* IN: vgroup key */
            int32 tag,  /* IN: tag to add */
            int32 ref /* IN: ref to add */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v  = NULL;
     VGROUP       *vg = NULL;
 #ifdef NO_DUPLICATES
@@ -2007,6 +2041,8 @@ int32
 Ventries(HFILEID f, /* IN: file handle */
          int32   vgid /* IN: vgroup id */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v         = NULL;
     int32         ret_value = SUCCEED;
 
@@ -2044,6 +2080,8 @@ int32
 Vsetname(int32       vkey, /* IN: vgroup key */
          const char *vgname /* IN: name to set for vgroup */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v  = NULL;
     VGROUP       *vg = NULL;
     size_t        name_len;
@@ -2070,6 +2108,7 @@ Vsetname(int32       vkey, /* IN: vgroup key */
     name_len = strlen(vgname); /* shortcut of length of the given name */
 
     /* if name exists, release it */
+    VPname_removed(vg->f, VNAME_VGNAME, vg->vgname, vg->oref);
     free(vg->vgname);
 
     /* allocate space for new name */
@@ -2081,6 +2120,7 @@ Vsetname(int32       vkey, /* IN: vgroup key */
 
     /* copy given name after allocation succeeded, with \0 terminated */
     HIstrncpy(vg->vgname, vgname, name_len + 1);
+    VPname_added(vg->f, VNAME_VGNAME, vg->vgname, vg->oref);
 
     vg->marked = TRUE;
 
@@ -2106,6 +2146,8 @@ int32
 Vsetclass(int32       vkey, /* IN: vgroup key */
           const char *vgclass /* IN: class to set for vgroup */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v  = NULL;
     VGROUP       *vg = NULL;
     size_t        classname_len;
@@ -2138,6 +2180,7 @@ Vsetclass(int32       vkey, /* IN: vgroup key */
     classname_len = strlen(vgclass); /* length of the given class name */
 
     /* if name exists, release it */
+    VPname_removed(vg->f, VNAME_VGCLASS, vg->vgclass, vg->oref);
     free(vg->vgclass);
 
     /* allocate space for new name */
@@ -2149,6 +2192,7 @@ Vsetclass(int32       vkey, /* IN: vgroup key */
 
     /* copy given class name after allocation succeeded, with \0 terminated */
     HIstrncpy(vg->vgclass, vgclass, classname_len + 1);
+    VPname_added(vg->f, VNAME_VGCLASS, vg->vgclass, vg->oref);
 
     vg->marked = TRUE;
 
@@ -2172,6 +2216,8 @@ int
 Visvg(int32 vkey, /* IN: vgroup key */
       int32 id /* IN: id of entry in vgroup */)
 {
+    H4_API_ENTER;
+
     unsigned      u;
     uint16        ID;
     vginstance_t *v         = NULL;
@@ -2224,6 +2270,8 @@ int
 Visvs(int32 vkey, /* IN: vgroup key */
       int32 id /* IN: id of entry in vgroup */)
 {
+    H4_API_ENTER;
+
     int           i;
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
@@ -2274,6 +2322,8 @@ int32
 Vgetid(HFILEID f, /* IN: file handle */
        int32   vgid /* IN: vgroup id */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v  = NULL;
     vfile_t      *vf = NULL;
     void        **t  = NULL;
@@ -2348,6 +2398,8 @@ int32
 Vgetnext(int32 vkey, /* IN: vgroup key */
          int32 id /* IN: id of entry in vgroup */)
 {
+    H4_API_ENTER;
+
     unsigned      u;
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
@@ -2419,6 +2471,8 @@ int32
 Vgetnamelen(int32   vkey, /* IN: vgroup key */
             uint16 *name_len /* OUT: length of vgroup's name */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
     int32         ret_value = SUCCEED;
@@ -2477,6 +2531,8 @@ int32
 Vgetclassnamelen(int32   vkey, /* IN: vgroup key */
                  uint16 *classname_len /* OUT: length of vgroup's classname */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
     int32         ret_value = SUCCEED;
@@ -2532,6 +2588,8 @@ int32
 Vgetname(int32 vkey, /* IN: vgroup key */
          char *vgname /* IN/OUT: vgroup name */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
     int32         ret_value = SUCCEED;
@@ -2579,6 +2637,8 @@ int32
 Vgetclass(int32 vkey, /* IN: vgroup key */
           char *vgclass /* IN/OUT: vgroup class */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
     int32         ret_value = SUCCEED;
@@ -2629,6 +2689,8 @@ Vinquire(int32  vkey,     /* IN: vgroup key */
          int32 *nentries, /* IN/OUT: number of entries in vgroup */
          char  *vgname /* IN/OUT: vgroup name */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v         = NULL;
     VGROUP       *vg        = NULL;
     int           ret_value = SUCCEED;
@@ -2692,6 +2754,8 @@ Vopen(char *path,     /* IN: file name */
       int   acc_mode, /* IN: type of file access */
       int16 ndds /* IN: number of DD in a block */)
 {
+    H4_API_ENTER;
+
     HFILEID ret_value = SUCCEED;
 
     /* clear error stack */
@@ -2729,6 +2793,8 @@ RETURNS
 int
 Vclose(HFILEID f /* IN: file handle */)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     if (Vfinish(f) == FAIL)
@@ -2759,9 +2825,12 @@ int32
 Vdelete(int32 f, /* IN: file handle */
         int32 vgid /* IN: vgroup id i.e. ref */)
 {
+    H4_API_ENTER;
+
     void      *v;
     vfile_t   *vf = NULL;
     void     **t  = NULL;
+    VGROUP    *vg = NULL;
     int32      key;
     filerec_t *file_rec  = NULL; /* file record */
     int32      ret_value = SUCCEED;
@@ -2791,6 +2860,12 @@ Vdelete(int32 f, /* IN: file handle */
     if ((t = (void **)tbbtdfind(vf->vgtree, (void *)&key, NULL)) == NULL)
         HGOTO_DONE(FAIL);
 
+    /* the name hash may give its name and class */
+    if ((vg = ((vginstance_t *)*t)->vg) != NULL) {
+        VPname_removed(f, VNAME_VGNAME, vg->vgname, (uint16)vgid);
+        VPname_removed(f, VNAME_VGCLASS, vg->vgclass, (uint16)vgid);
+    }
+
     /* remove vgroup node from TBBT */
     if ((v = tbbtrem((TBBT_NODE **)vf->vgtree, (TBBT_NODE *)t, NULL)) != NULL)
         vdestroynode((void *)v);
@@ -2916,6 +2991,8 @@ done:
 int
 Vgisinternal(int32 vkey /* vgroup's identifier */)
 {
+    H4_API_ENTER;
+
     vginstance_t *v           = NULL;
     VGROUP       *vg          = NULL;
     int           is_internal = FALSE;
@@ -2981,6 +3058,8 @@ done:
 int
 Visinternal(const char *classname /* vgroup's class name */)
 {
+    H4_API_ENTER;
+
     int i;
     int ret_value = FALSE;
 
@@ -3032,6 +3111,8 @@ Vgetvgroups(int32    id,       /* IN: file id or vgroup id */
             unsigned n_vgs,    /* IN: number of user-created vgs to return */
             uint16  *refarray /* IN/OUT: ref array to fill */)
 {
+    H4_API_ENTER;
+
     vginstance_t *vg_inst = NULL;
     int32         vg_ref;
     int           nactual_vgs, user_vgs, ii;
@@ -52,6 +52,8 @@ int32
 VHstoredata(HFILEID f, const char *field, const uint8 *buf, int32 n, int32 datatype, const char *vsname,
             const char *vsclass)
 {
+    H4_API_ENTER;
+
     int32 order = 1;
     int32 ret_value;
 
@@ -88,6 +90,8 @@ int32
 VHstoredatam(HFILEID f, const char *field, const uint8 *buf, int32 n, int32 datatype, const char *vsname,
              const char *vsclass, int32 order)
 {
+    H4_API_ENTER;
+
     int32 ref;
     int32 vs;
     int32 ret_value = SUCCEED;
@@ -150,6 +154,8 @@ done:
 int32
 VHmakegroup(HFILEID f, int32 tagarray[], int32 refarray[], int32 n, const char *vgname, const char *vgclass)
 {
+    H4_API_ENTER;
+
     int32 ref, i;
     int32 vg;
     int32 ret_value = SUCCEED;
@@ -65,12 +65,16 @@ EXPORTED ROUTINES
 static int vunpackvs(VDATA *vs, uint8 buf[], int32 len);
 
 /* Temporary buffer for I/O */
-static uint32 Vhbufsize = 0;
-static uint8 *Vhbuf     = NULL;
+static H4_THREAD_LOCAL uint32 Vhbufsize = 0;
+static H4_THREAD_LOCAL uint8 *Vhbuf     = NULL;
 
 /* Pointers to the VDATA & vsinstance node free lists */
 static VDATA        *vdata_free_list      = NULL;
 static vsinstance_t *vsinstance_free_list = NULL;
+#ifdef H4_HAVE_THREADSAFE
+/* Readers of different files may read vdata headers at the same time */
+static pthread_mutex_t vdata_free_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 /* vpackvs is prototyped in vg.h since vconv.c needs to call it */
 
@@ -94,15 +98,16 @@ VSIget_vdata_node(void)
     HEclear();
 
     /* Grab from free list if possible */
+    H4_MUTEX_LOCK(&vdata_free_lock);
     if (vdata_free_list != NULL) {
         ret_value       = vdata_free_list;
         vdata_free_list = vdata_free_list->next;
     }
-    else /* allocate a new node */
-    {
-        if ((ret_value = (VDATA *)malloc(sizeof(VDATA))) == NULL)
-            HGOTO_ERROR(DFE_NOSPACE, NULL);
-    } /* end else */
+    H4_MUTEX_UNLOCK(&vdata_free_lock);
+
+    /* allocate a new node */
+    if (ret_value == NULL && (ret_value = (VDATA *)malloc(sizeof(VDATA))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, NULL);
 
     /* Initialize to zeros */
     memset(ret_value, 0, sizeof(VDATA));
@@ -126,8 +131,10 @@ void
 VSIrelease_vdata_node(VDATA *vs /* IN: vdata to release */)
 {
     /* Insert the atom at the beginning of the free list */
+    H4_MUTEX_LOCK(&vdata_free_lock);
     vs->next        = vdata_free_list;
     vdata_free_list = vs;
+    H4_MUTEX_UNLOCK(&vdata_free_lock);
 
 } /* end VSIrelease_vdata_node() */
 
@@ -277,6 +284,10 @@ vsinst(HFILEID f, /* IN: File handle */
     /* return the actual vsinstance_t ptr */
     ret_value = ((vsinstance_t *)*t);
 
+    /* read the header of a vdata not looked up before */
+    if (ret_value->vs == NULL && (ret_value->vs = VSPgetinfo(f, vsid)) == NULL)
+        HGOTO_ERROR(DFE_INTERNAL, NULL);
+
 done:
     return ret_value;
 } /* vsinst */
@@ -664,6 +675,7 @@ vsdestroynode(void *n /* IN: Node in TBBT-tree */)
             free(vs->rlist.item);
 
             free(vs->alist);
+            free(vs->wbuf);
 
             VSIrelease_vdata_node(vs);
         }
@@ -715,6 +727,7 @@ VSPgetinfo(HFILEID f, /* IN: file handle */
 
         if ((Vhbuf = (uint8 *)malloc(Vhbufsize)) == NULL)
             HGOTO_ERROR(DFE_NOSPACE, NULL);
+        H4_FREE_AT_THREAD_EXIT(&Vhbuf);
     }
 
     /* get Vdata header from file */
@@ -798,6 +811,8 @@ VSattach(HFILEID     f,    /* IN: file handle */
          int32       vsid, /* IN: vdata id i.e. ref */
          const char *accesstype /* IN: access type */)
 {
+    H4_API_ENTER;
+
     VDATA        *vs = NULL; /* new vdata to be returned */
     vsinstance_t *w  = NULL;
     vfile_t      *vf = NULL;
@@ -863,6 +878,8 @@ VSattach(HFILEID     f,    /* IN: file handle */
 
         /* insert the vs instance in B-tree */
         tbbtdins(vf->vstree, w, NULL);
+        VPname_added(f, VNAME_VSNAME, vs->vsname, vs->oref);
+        VPname_added(f, VNAME_VSCLASS, vs->vsclass, vs->oref);
 
         vs->instance = w;
     }      /* end of case where vsid is -1 */
@@ -905,6 +922,10 @@ VSattach(HFILEID     f,    /* IN: file handle */
             else {
                 vs = w->vs;
 
+                /* the vdata may still be attached for writing */
+                if (VSPflush(vs) == FAIL)
+                    HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
                 vs->access = 'r';
                 vs->aid    = Hstartread(vs->f, VSDATATAG, vs->oref);
                 if (vs->aid == FAIL)
@@ -975,6 +996,8 @@ RETURNS
 int32
 VSdetach(int32 vkey /* IN: vdata key? */)
 {
+    H4_API_ENTER;
+
     int32         i;
     int32         ret;
     int32         vspacksize;
@@ -1021,6 +1044,14 @@ VSdetach(int32 vkey /* IN: vdata key? */)
         if (w->nattach != 0)
             HGOTO_ERROR(DFE_CANTDETACH, FAIL);
 
+        /* write out the records appended last */
+        if (VSPflush(vs) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        free(vs->wbuf);
+        vs->wbuf        = NULL;
+        vs->wbuf_size   = 0;
+        vs->blksize_set = 0;
+
         if (vs->marked) { /* if marked , write out vdata's VSDESC to file */
             size_t need;
 
@@ -1032,6 +1063,7 @@ VSdetach(int32 vkey /* IN: vdata key? */)
 
                 if ((Vhbuf = malloc(Vhbufsize)) == NULL)
                     HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                H4_FREE_AT_THREAD_EXIT(&Vhbuf);
             }
 
             if (FAIL == vpackvs(vs, Vhbuf, &vspacksize))
@@ -1104,6 +1136,8 @@ int32
 VSappendable(int32 vkey, /* IN: vdata key */
              int32 blk /* IN: */)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w         = NULL;
     VDATA        *vs        = NULL;
     int32         ret_value = SUCCEED;
@@ -1152,6 +1186,8 @@ int32
 VSgetid(HFILEID f, /* IN: file handle */
         int32   vsid /* IN: vdata id i.e. ref */)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w  = NULL;
     vfile_t      *vf = NULL;
     void        **t  = NULL;
@@ -1216,6 +1252,8 @@ RETURNS
 int32
 VSQuerytag(int32 vkey /* IN: vdata key */)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w         = NULL;
     VDATA        *vs        = NULL;
     int32         ret_value = SUCCEED;
@@ -1258,6 +1296,8 @@ RETURNS
 int32
 VSQueryref(int32 vkey /* IN: vdata key */)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w         = NULL;
     VDATA        *vs        = NULL;
     int32         ret_value = SUCCEED;
@@ -1340,6 +1380,8 @@ RETURNS
 int32
 VSgetversion(int32 vkey /* IN: vdata key */)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w         = NULL;
     VDATA        *vs        = NULL;
     int32         ret_value = SUCCEED;
@@ -1386,9 +1428,12 @@ int32
 VSdelete(int32 f, /* IN: file handle */
          int32 vsid /* IN: vdata id i.e. ref */)
 {
+    H4_API_ENTER;
+
     void    *v;
     vfile_t *vf = NULL;
     void   **t  = NULL;
+    VDATA   *vs = NULL;
     int32    key;
     int32    ret_value = SUCCEED;
 
@@ -1403,11 +1448,22 @@ VSdelete(int32 f, /* IN: file handle */
     if (NULL == (vf = Get_vfile(f)))
         HGOTO_ERROR(DFE_FNF, FAIL);
 
+    /* the indexes of its fields go with it; they are deleted first, as
+       finding them may read the headers of other vdatas */
+    if (VSPdelete_indexes(f, (uint16)vsid) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
     /* find vdata in TBBT using it's ref */
     key = vsid;
     if ((t = (void **)tbbtdfind(vf->vstree, &key, NULL)) == NULL)
         HGOTO_DONE(FAIL);
 
+    /* the name hash may give its name and class */
+    if ((vs = ((vsinstance_t *)*t)->vs) != NULL) {
+        VPname_removed(f, VNAME_VSNAME, vs->vsname, (uint16)vsid);
+        VPname_removed(f, VNAME_VSCLASS, vs->vsclass, (uint16)vsid);
+    }
+
     /* remove vdata from TBBT */
     v = tbbtrem((TBBT_NODE **)vf->vstree, (TBBT_NODE *)t, NULL);
 
@@ -27,13 +27,13 @@
 
 #define ISCOMMA(c) ((c == ',') ? 1 : 0)
 
-static char *symptr[VSFIELDMAX];                   /* array of ptrs to tokens  ? */
-static char  sym[VSFIELDMAX][FIELDNAMELENMAX + 1]; /* array of tokens ? */
-static int   nsym;                                 /* token index ? */
+static H4_THREAD_LOCAL char *symptr[VSFIELDMAX];                   /* array of ptrs to tokens  ? */
+static H4_THREAD_LOCAL char  sym[VSFIELDMAX][FIELDNAMELENMAX + 1]; /* array of tokens ? */
+static H4_THREAD_LOCAL int   nsym;                                 /* token index ? */
 
 /* Temporary buffer for I/O */
-static uint32 Vpbufsize = 0;
-static uint8 *Vpbuf     = NULL;
+static H4_THREAD_LOCAL uint32 Vpbufsize = 0;
+static H4_THREAD_LOCAL uint8 *Vpbuf     = NULL;
 
 /*******************************************************************************
  NAME
@@ -72,6 +72,7 @@ scanattrs(const char *attrs, int32 *attrc, char ***attrv)
         free(Vpbuf);
         if ((Vpbuf = (uint8 *)malloc(Vpbufsize)) == NULL)
             HRETURN_ERROR(DFE_NOSPACE, FAIL);
+        H4_FREE_AT_THREAD_EXIT(&Vpbuf);
     } /* end if */
 
     strcpy((char *)Vpbuf, attrs);
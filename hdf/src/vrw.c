@@ -20,11 +20,14 @@
 
 LOCAL ROUTINES
  VSPshutdown  --  Free the Vtbuf buffer.
+ VSPflush     --  Write out the records appended to a vdata.
 
 EXPORTED ROUTINES
  VSseek  -- Seeks to an element boundary within a vdata i.e. 2nd element.
  VSread  -- Reads a specified number of elements' worth of data from a vdata.
              Data will be returned to you interlaced in the way you specified.
+ VSreadcolumns -- Reads fields of a range of records, each into a buffer
+             of its own.
  VSwrite -- Writes a specified number of elements' worth of data to a vdata.
              You must specify how your data in your buffer is interlaced.
              Creates an aid, and writes it out if this is the first time.
@@ -40,9 +43,26 @@ EXPORTED ROUTINES
 #ifndef MIN
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #endif /* MIN */
-
-static uint32 Vtbufsize = 0;
-static uint8 *Vtbuf     = NULL;
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif /* MAX */
+
+/* Largest linked block chosen for a vdata appended to (see VSIwrite_out) */
+#define VS_APPEND_BLOCK_MAX (16 * HDF_APPENDABLE_BLOCK_LEN)
+
+static H4_THREAD_LOCAL uint32 Vtbufsize = 0;
+static H4_THREAD_LOCAL uint8 *Vtbuf     = NULL;
+
+/* How VSreadcolumns moves one field from the file into its buffer */
+typedef struct {
+    uint8 *dest;  /* where the next record of the field goes */
+    int32  off;   /* offset of the field in a record */
+    int32  isize; /* size of the field in the file, order included */
+    int32  esize; /* size of the field in memory, order included */
+    int32  order; /* order of the field */
+    int32  type;  /* number type of the field */
+    int    copy;  /* whether converting the field is a plain copy */
+} vs_column_t;
 
 /*******************************************************************************
  NAME
@@ -75,6 +95,138 @@ VSPshutdown(void)
     return ret_value;
 } /* end VSPshutdown() */
 
+/*******************************************************************************
+ NAME
+    VSIwrite_out  --  Write appended records to the file.
+
+ DESCRIPTION
+    Writes 'len' bytes of records at the end of a vdata.  Unless their
+    size was set with VSsetblocksize, the linked blocks the vdata gets
+    when it can no longer grow in place are as large as the data it
+    already holds or as the write, up to VS_APPEND_BLOCK_MAX, so large
+    vdatas get fewer blocks.
+
+ RETURNS
+    Returns SUCCEED/FAIL
+
+*******************************************************************************/
+static int
+VSIwrite_out(VDATA *vs, const uint8 *data, int32 len)
+{
+    int32 block_size;
+    int32 position = 0;
+    int   ret_value = SUCCEED;
+
+    /* the block size is only used if the element becomes linked-block now */
+    if (!vs->blksize_set) {
+        HQueryposition(vs->aid, &position);
+        block_size = MIN(MAX(MAX(len, position), HDF_APPENDABLE_BLOCK_LEN), VS_APPEND_BLOCK_MAX);
+        if (HLsetblockinfo(vs->aid, block_size, -1) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    }
+
+    if (Hwrite(vs->aid, len, data) != len)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+done:
+    return ret_value;
+} /* end VSIwrite_out() */
+
+/*******************************************************************************
+ NAME
+    VSPflush  --  Write out the records appended to a vdata.
+
+ DESCRIPTION
+    VSwrite keeps the records appended to a vdata in a buffer of the
+    vdata, and writes them when the buffer is full.  This writes out the
+    records still in the buffer; it is called before anything else
+    accesses the data of the vdata, and when the vdata is detached.
+
+ RETURNS
+    Returns SUCCEED/FAIL
+
+*******************************************************************************/
+int
+VSPflush(VDATA *vs)
+{
+    int ret_value = SUCCEED;
+
+    if (vs->wbuf_len > 0) {
+        if (VSIwrite_out(vs, vs->wbuf, vs->wbuf_len) == FAIL)
+            HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        vs->wbuf_len = 0;
+    }
+
+done:
+    return ret_value;
+} /* end VSPflush() */
+
+/*******************************************************************************
+ NAME
+    VSIappend  --  Append records to a vdata through its buffer.
+
+ DESCRIPTION
+    Copies 'len' bytes of records, as stored in the file, to the buffer
+    of the vdata, and writes the buffer out each time it is full.  The
+    buffer starts at the linked-block size of the vdata and doubles after
+    each write up to VDATA_BUFFER_MAX, so a vdata appended to one record
+    at a time is written in ever larger pieces that fill whole blocks.
+    Appends as large as the buffer go straight to the file.
+
+ RETURNS
+    Returns SUCCEED/FAIL
+
+*******************************************************************************/
+static int
+VSIappend(VDATA *vs, const uint8 *data, int32 len)
+{
+    int32 n;
+    int   ret_value = SUCCEED;
+
+    if (vs->wbuf == NULL) {
+        if (HLgetblockinfo(vs->aid, &vs->wbuf_size, NULL) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        if (vs->wbuf_size <= 0)
+            vs->wbuf_size = HDF_APPENDABLE_BLOCK_LEN;
+        vs->wbuf_size = MIN(vs->wbuf_size, VDATA_BUFFER_MAX);
+        if ((vs->wbuf = (uint8 *)malloc((size_t)vs->wbuf_size)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        vs->wbuf_len = 0;
+    }
+
+    while (len > 0) {
+        if (vs->wbuf_len == 0 && len >= vs->wbuf_size) {
+            /* whole buffers' worth, no need to copy them */
+            n = len - len % vs->wbuf_size;
+            if (VSIwrite_out(vs, data, n) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        }
+        else {
+            n = MIN(len, vs->wbuf_size - vs->wbuf_len);
+            memcpy(vs->wbuf + vs->wbuf_len, data, (size_t)n);
+            vs->wbuf_len += n;
+
+            if (vs->wbuf_len == vs->wbuf_size) {
+                if (VSPflush(vs) == FAIL)
+                    HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+                /* write larger pieces next time */
+                if (vs->wbuf_size <= VDATA_BUFFER_MAX / 2) {
+                    free(vs->wbuf);
+                    vs->wbuf_size *= 2;
+                    if ((vs->wbuf = (uint8 *)malloc((size_t)vs->wbuf_size)) == NULL)
+                        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                }
+            }
+        }
+        data += n;
+        len -= n;
+    }
+
+done:
+    return ret_value;
+} /* end VSIappend() */
+
 /*******************************************************************************
 NAME
    VSseek
@@ -95,6 +247,8 @@ int32
 VSseek(int32 vkey, /* IN: vdata key */
        int32 eltpos /* IN: element position in vdata */)
 {
+    H4_API_ENTER;
+
     int32         ret;
     int32         offset;
     vsinstance_t *w         = NULL;
@@ -121,6 +275,10 @@ VSseek(int32 vkey, /* IN: vdata key */
     if (vs->wlist.n <= 0)
         HGOTO_ERROR(DFE_BADFIELDS, FAIL);
 
+    /* write out the records appended so far */
+    if (VSPflush(vs) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
     /* calculate offset of element in vdata */
     offset = eltpos * vs->wlist.ivsize;
 
@@ -153,6 +311,8 @@ VSread(int32 vkey,  /* IN: vdata key */
        int32 nelt,  /* IN: number of elements to read */
        int32 interlace /* IN: interlace to return elements in 'buf' */)
 {
+    H4_API_ENTER;
+
     int             isize = 0;
     int             order = 0;
     int             index = 0;
@@ -208,6 +368,10 @@ VSread(int32 vkey,  /* IN: vdata key */
     if (interlace != FULL_INTERLACE && interlace != NO_INTERLACE)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
+    /* write out the records appended so far */
+    if (VSPflush(vs) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
     /* read/write lists */
     w           = &(vs->wlist);
     r           = &(vs->rlist);
@@ -266,6 +430,7 @@ VSread(int32 vkey,  /* IN: vdata key */
             free(Vtbuf);
             if ((Vtbuf = (uint8 *)malloc(Vtbufsize)) == NULL)
                 HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            H4_FREE_AT_THREAD_EXIT(&Vtbuf);
         }
 
         done = 0;
@@ -337,6 +502,7 @@ VSread(int32 vkey,  /* IN: vdata key */
             free(Vtbuf);
             if ((Vtbuf = (uint8 *)malloc(Vtbufsize)) == NULL)
                 HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            H4_FREE_AT_THREAD_EXIT(&Vtbuf);
         }
 
         /* ================ start reading ============================== */
@@ -424,6 +590,202 @@ done:
     return ret_value;
 } /* VSread */
 
+/*******************************************************************************
+NAME
+   VSIunpack_column
+
+DESCRIPTION
+   Converts one field of 'nrecs' records read from a vdata into the next
+   records of its buffer.  'src' points to the field in the first record
+   and 'stride' is the distance between records.  When the field has the
+   same size in the file and in memory, its bytes are gathered first and
+   converted in place with one DFKconvert call, whatever its order.
+
+RETURNS
+   Nothing
+
+*******************************************************************************/
+static void
+VSIunpack_column(vs_column_t *col, uint8 *src, int32 stride, int32 nrecs)
+{
+    int32 i;
+
+    if (col->isize == col->esize) {
+        if (stride == col->isize)
+            memcpy(col->dest, src, (size_t)nrecs * (size_t)col->isize);
+        else
+            for (i = 0; i < nrecs; i++)
+                memcpy(col->dest + (size_t)i * (size_t)col->isize, src + (size_t)i * (size_t)stride,
+                       (size_t)col->isize);
+        if (!col->copy)
+            DFKconvert(col->dest, col->dest, col->type, col->order * nrecs, DFACC_READ, 0, 0);
+    }
+    else
+        for (i = 0; i < col->order; i++)
+            DFKconvert(src + i * (col->isize / col->order), col->dest + i * (col->esize / col->order),
+                       col->type, nrecs, DFACC_READ, stride, col->esize);
+
+    col->dest += (size_t)nrecs * (size_t)col->esize;
+} /* VSIunpack_column */
+
+/*******************************************************************************
+NAME
+   VSreadcolumns
+
+DESCRIPTION
+   Reads 'nrecs' records of a vdata from record 'start' on, and puts
+   each of the 'nfields' fields given by their index in the vdata (see
+   VSfindex) into a buffer of its own: bufs[k] receives field
+   field_idx[k] of every record, one record after the other, and must
+   hold nrecs times the in-memory size of the field.  The fields set
+   with VSsetfields do not matter.
+
+   The conversion of each field is planned once, and the records are
+   read in blocks of at most VDATA_BUFFER_MAX bytes, so the memory used
+   does not grow with 'nrecs'; fields of a vdata stored with
+   NO_INTERLACE are read straight into their buffers.  After the call,
+   the vdata is positioned after the last record read, as VSseek would
+   leave it.
+
+RETURNS
+   RETURNS FAIL if error
+   RETURNS the number of records read (0 or a +ve integer).
+
+*******************************************************************************/
+int32
+VSreadcolumns(int32 vkey,              /* IN: vdata key */
+              int32 nfields,           /* IN: number of fields to read */
+              const int32 field_idx[], /* IN: index in the vdata of each field */
+              void *bufs[],            /* OUT: buffer of each field */
+              int32 start,             /* IN: first record to read */
+              int32 nrecs /* IN: number of records to read */)
+{
+    H4_API_ENTER;
+
+    vs_column_t    *cols = NULL; /* what to do with each field */
+    uint8          *rbuf = NULL; /* records or field values as read */
+    int32           hsize;       /* size of a record in the file */
+    int32           block;       /* number of records read at a time */
+    int32           n;           /* number of records read this time */
+    int32           done;        /* number of records read so far */
+    int32           i, k;
+    DYN_VWRITELIST *w         = NULL;
+    vsinstance_t   *wi        = NULL;
+    VDATA          *vs        = NULL;
+    int32           ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check if vdata is part of vdata group */
+    if (HAatom_group(vkey) != VSIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get vdata instance */
+    if (NULL == (wi = (vsinstance_t *)HAatom_object(vkey)))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+
+    /* get vdata itself and check it */
+    vs = wi->vs;
+    if (vs == NULL || vs->aid == 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* Don't allow reads in 0-field vdatas */
+    if (vs->wlist.n <= 0)
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+
+    /* check if vdata exists in file */
+    if (vexistvs(vs->f, vs->oref) == FAIL)
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+
+    /* check the fields and the records asked for */
+    if (nfields <= 0 || field_idx == NULL || bufs == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    if (start < 0 || nrecs < 0 || start > vs->nvertices || nrecs > vs->nvertices - start)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* write out the records appended so far */
+    if (VSPflush(vs) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+    w     = &(vs->wlist);
+    hsize = (int32)w->ivsize;
+
+    /* plan the conversion of each field */
+    if ((cols = (vs_column_t *)malloc((size_t)nfields * sizeof(vs_column_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (k = 0; k < nfields; k++) {
+        i = field_idx[k];
+        if (i < 0 || i >= w->n || bufs[k] == NULL)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        cols[k].dest  = (uint8 *)bufs[k];
+        cols[k].off   = (int32)w->off[i];
+        cols[k].isize = (int32)w->isize[i];
+        cols[k].esize = (int32)w->esize[i];
+        cols[k].order = (int32)w->order[i];
+        cols[k].type  = (int32)w->type[i];
+        cols[k].copy  = DFKiscopyNT(cols[k].type) && cols[k].isize == cols[k].esize;
+    }
+
+    if (nrecs == 0)
+        HGOTO_DONE(0);
+
+    /* what is read goes through a buffer of at most VDATA_BUFFER_MAX bytes */
+    block = MIN(nrecs, VDATA_BUFFER_MAX / hsize + 1);
+
+    if (vs->interlace == FULL_INTERLACE) {
+        if ((rbuf = (uint8 *)malloc((size_t)block * (size_t)hsize)) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+        if (Hseek(vs->aid, start * hsize, DF_START) == FAIL)
+            HGOTO_ERROR(DFE_BADSEEK, FAIL);
+        for (done = 0; done < nrecs; done += n) {
+            n = MIN(block, nrecs - done);
+            if (Hread(vs->aid, n * hsize, rbuf) != n * hsize)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+            for (k = 0; k < nfields; k++)
+                VSIunpack_column(&cols[k], rbuf + cols[k].off, hsize, n);
+        }
+    }
+    else {
+        /* the values of each field follow each other in the file */
+        for (k = 0; k < nfields; k++) {
+            if (Hseek(vs->aid, cols[k].off * vs->nvertices + start * cols[k].isize, DF_START) == FAIL)
+                HGOTO_ERROR(DFE_BADSEEK, FAIL);
+
+            if (cols[k].isize == cols[k].esize) {
+                if (Hread(vs->aid, nrecs * cols[k].isize, cols[k].dest) != nrecs * cols[k].isize)
+                    HGOTO_ERROR(DFE_READERROR, FAIL);
+                if (!cols[k].copy)
+                    DFKconvert(cols[k].dest, cols[k].dest, cols[k].type, cols[k].order * nrecs, DFACC_READ, 0,
+                               0);
+                cols[k].dest += (size_t)nrecs * (size_t)cols[k].esize;
+            }
+            else {
+                if (rbuf == NULL && (rbuf = (uint8 *)malloc((size_t)block * (size_t)hsize)) == NULL)
+                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                for (done = 0; done < nrecs; done += n) {
+                    n = MIN(block, nrecs - done);
+                    if (Hread(vs->aid, n * cols[k].isize, rbuf) != n * cols[k].isize)
+                        HGOTO_ERROR(DFE_READERROR, FAIL);
+                    VSIunpack_column(&cols[k], rbuf, cols[k].isize, n);
+                }
+            }
+        }
+    }
+
+    /* leave the vdata after the records read */
+    if (Hseek(vs->aid, (start + nrecs) * hsize, DF_START) == FAIL)
+        HGOTO_ERROR(DFE_BADSEEK, FAIL);
+
+    ret_value = nrecs;
+
+done:
+    free(rbuf);
+    free(cols);
+    return ret_value;
+} /* VSreadcolumns */
+
 /*******************************************************************************
 NAME
    VSwrite
@@ -447,6 +809,8 @@ VSwrite(int32       vkey,  /* IN: vdata key */
         int32       nelt,  /* IN: number of elements */
         int32       interlace /* IN: interlace of elements 'buf' */)
 {
+    H4_API_ENTER;
+
     int             isize = 0;
     int             order = 0;
     int             index = 0;
@@ -458,7 +822,7 @@ VSwrite(int32       vkey,  /* IN: vdata key */
     int32           offset;
     int32           position = 0;
     int32           new_size;
-    int32           status;
+    int             append;      /* whether the records are added at the end */
     int32           total_bytes; /* total number of bytes that need to be written out */
     DYN_VWRITELIST *w = NULL;
     int32           int_size;     /* size of "element" as needed by user in memory */
@@ -519,8 +883,20 @@ VSwrite(int32       vkey,  /* IN: vdata key */
      *  AND we are increasing its size
      */
     HQueryposition(vs->aid, &position);
+    position += vs->wbuf_len;
     new_size = (position / (int)vs->wlist.ivsize) + nelt;
 
+    /* records added at the end of an interlaced vdata go through its buffer;
+       the first write of a vdata does not, so vdatas written at once need none */
+    append = (w->n == 1 || vs->interlace == FULL_INTERLACE) && position > 0 &&
+             position == vs->nvertices * hdf_size;
+    if (!append && VSPflush(vs) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+    /* records written over make the indexes of the vdata stale */
+    if (position < vs->nvertices * hdf_size && VSPdelete_indexes(vs->f, vs->oref) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
     /* this should really be cached in the Vdata structure */
     for (int_size = 0, j = 0; j < w->n; j++)
         int_size += w->esize[j];
@@ -576,6 +952,7 @@ VSwrite(int32       vkey,  /* IN: vdata key */
             free(Vtbuf);
             if ((Vtbuf = (uint8 *)malloc(Vtbufsize)) == NULL)
                 HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            H4_FREE_AT_THREAD_EXIT(&Vtbuf);
         }
 
         done = 0;
@@ -615,8 +992,11 @@ VSwrite(int32       vkey,  /* IN: vdata key */
             }
 
             /* write the converted data to the file */
-            status = Hwrite(vs->aid, bytes, (uint8 *)Vtbuf);
-            if (status != bytes)
+            if (append) {
+                if (VSIappend(vs, Vtbuf, bytes) == FAIL)
+                    HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+            }
+            else if (Hwrite(vs->aid, bytes, (uint8 *)Vtbuf) != bytes)
                 HGOTO_ERROR(DFE_WRITEERROR, FAIL);
 
             /* record what we've done and move to next group */
@@ -641,6 +1021,7 @@ VSwrite(int32       vkey,  /* IN: vdata key */
             free(Vtbuf);
             if ((Vtbuf = (uint8 *)malloc(Vtbufsize)) == NULL)
                 HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            H4_FREE_AT_THREAD_EXIT(&Vtbuf);
         }
 
         /* ----------------------------------------------------------------- */
@@ -711,8 +1092,11 @@ VSwrite(int32       vkey,  /* IN: vdata key */
             }
         } /* case (d) */
 
-        status = Hwrite(vs->aid, total_bytes, (uint8 *)Vtbuf);
-        if (status != total_bytes)
+        if (append) {
+            if (VSIappend(vs, Vtbuf, total_bytes) == FAIL)
+                HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+        }
+        else if (Hwrite(vs->aid, total_bytes, (uint8 *)Vtbuf) != total_bytes)
             HGOTO_ERROR(DFE_WRITEERROR, FAIL);
 
     } /* cases a, b, and d */
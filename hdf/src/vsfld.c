@@ -70,6 +70,8 @@ static const SYMDEF rstab[] = {
 int
 VSsetfields(int32 vkey, const char *fields)
 {
+    H4_API_ENTER;
+
     char          **av;
     int32           ac, found;
     int             j, i;
@@ -254,6 +256,8 @@ done:
 int
 VSfdefine(int32 vkey, const char *field, int32 localtype, int32 order)
 {
+    H4_API_ENTER;
+
     char        **av;
     int32         ac;
     int16         isize, replacesym;
@@ -338,6 +342,8 @@ done:
 int32
 VFnfields(int32 vkey)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w;
     VDATA        *vs;
     int32         ret_value = SUCCEED;
@@ -370,6 +376,8 @@ done:
 char *
 VFfieldname(int32 vkey, int32 index)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w;
     VDATA        *vs;
     char         *ret_value = NULL; /* FAIL */
@@ -403,6 +411,8 @@ done:
 int32
 VFfieldtype(int32 vkey, int32 index)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w;
     VDATA        *vs;
     int32         ret_value = SUCCEED;
@@ -437,6 +447,8 @@ done:
 int32
 VFfieldisize(int32 vkey, int32 index)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w;
     VDATA        *vs;
     int32         ret_value = SUCCEED;
@@ -471,6 +483,8 @@ done:
 int32
 VFfieldesize(int32 vkey, int32 index)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w;
     VDATA        *vs;
     int32         ret_value = SUCCEED;
@@ -504,6 +518,8 @@ done:
 int32
 VFfieldorder(int32 vkey, int32 index)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w;
     VDATA        *vs;
     int32         ret_value = SUCCEED;
@@ -558,6 +574,8 @@ FORTRAN
 int
 VSsetexternalfile(int32 vkey, const char *filename, int32 offset)
 {
+    H4_API_ENTER;
+
     int32 ret_value = SUCCEED;
 
     vsinstance_t *w;
@@ -584,6 +602,10 @@ VSsetexternalfile(int32 vkey, const char *filename, int32 offset)
     if (!w->ref)
         HGOTO_ERROR(DFE_NOVS, FAIL);
 
+    /* the records appended so far go to the external file too */
+    if (VSPflush(vs) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
     /* no need to give a length since the element already exists */
     /* The Data portion of a Vdata is always stored in linked blocks. */
     /* So, use the special tag */
@@ -626,6 +648,8 @@ done:
 int
 VSgetexternalfile(int32 vkey, unsigned buf_size, char *ext_filename, int32 *offset)
 {
+    H4_API_ENTER;
+
     vsinstance_t   *w;
     VDATA          *vs;
     sp_info_block_t info_block;
@@ -728,6 +752,8 @@ done:
 int
 VSgetexternalinfo(int32 vkey, unsigned buf_size, char *ext_filename, int32 *offset, int32 *length)
 {
+    H4_API_ENTER;
+
     vsinstance_t *w;
     VDATA        *vs;
     int           actual_fname_len = 0;
@@ -853,6 +879,8 @@ int
 VSfpack(int32 vsid, int packtype, const char *fields_in_buf, void *buf, int bufsz, int n_records,
         const char *fields, void *fldbufpt[])
 {
+    H4_API_ENTER;
+
     int32           ac;
     char          **av, *s;
     uint8          *bufp   = (uint8 *)buf;
@@ -0,0 +1,587 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/***********************************************************************
+*
+* vsindex.c
+* Part of the HDF VSet interface.
+* This module keeps sorted indexes of vdata fields and finds the records
+* whose field value is in a range.
+*
+* The index of a field is a vdata of its own, of class _HDF_VSINDEX_CLASS
+* followed by the ref of the indexed vdata, and named after that class and
+* the field, so that VSfind and VSfindclass find it through the name hash
+* of the file.
+* Its records are the values of the field, as float64, with the number of
+* the record holding them, sorted by value (and by record for equal
+* values).  Being of an internal class, index vdatas are not shown to
+* applications listing the vdatas of a file.
+*
+
+LOCAL ROUTINES
+ VSPdelete_indexes -- Deletes the indexes of a vdata.
+
+EXPORTED ROUTINES
+ VSbuildindex -- Builds the index of a field of a vdata.
+ VSselect     -- Finds the records whose value of a field is in a range.
+
+************************************************************************/
+
+#include <math.h>
+
+#include "hdf_priv.h"
+#include "vg_priv.h"
+
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif /* MIN */
+
+/* Fields of an index vdata */
+#define VSINDEX_VALUE  "VALUE"
+#define VSINDEX_RECORD "RECORD"
+#define VSINDEX_FIELDS VSINDEX_VALUE "," VSINDEX_RECORD
+
+/* Size of an index record in memory, as given to VSwrite */
+#define VSINDEX_RECSIZE (sizeof(float64) + sizeof(int32))
+
+/* Longest name of a field that can be indexed: the name of its index is the
+   class of the indexes of the vdata, whose ref has at most 5 digits, a dot
+   and the name of the field */
+#define VSINDEX_FIELDMAX (VSNAMELENMAX - (sizeof(_HDF_VSINDEX_CLASS) - 1) - 6)
+
+/* Number of records converted or written at a time */
+#define VSINDEX_BLOCK 65536
+
+/* An entry of an index: a value of the field and the record it is in */
+typedef struct {
+    float64 value;
+    int32   rec;
+} vsindex_entry_t;
+
+/*******************************************************************************
+ NAME
+    VSIindex_class  --  Make the class name of the indexes of a vdata.
+
+*******************************************************************************/
+static void
+VSIindex_class(uint16 ref, char vsclass[VSNAMELENMAX + 1])
+{
+    snprintf(vsclass, VSNAMELENMAX + 1, "%s%u", _HDF_VSINDEX_CLASS, (unsigned)ref);
+} /* VSIindex_class */
+
+/*******************************************************************************
+ NAME
+    VSIindex_name  --  Make the name of the index of a field of a vdata.
+
+*******************************************************************************/
+static void
+VSIindex_name(uint16 ref, const char *fieldname, char vsname[VSNAMELENMAX + 1])
+{
+    snprintf(vsname, VSNAMELENMAX + 1, "%s%u.%s", _HDF_VSINDEX_CLASS, (unsigned)ref, fieldname);
+} /* VSIindex_name */
+
+/*******************************************************************************
+ NAME
+    VSIfind_index  --  Find the index of a field of a vdata.
+
+ DESCRIPTION
+    Looks up the index of field 'fieldname' of the vdata with ref 'ref'
+    in file 'f' by its name, or any index of that vdata by its class if
+    'fieldname' is NULL.  Both go through the name hash of the file (see
+    VSfind), so only the first lookup in a file reads the headers of its
+    vdatas.
+
+ RETURNS
+    Returns the ref of the index vdata, 0 if there is none.
+
+*******************************************************************************/
+static int32
+VSIfind_index(HFILEID f, uint16 ref, const char *fieldname)
+{
+    char          vsclass[VSNAMELENMAX + 1];
+    char          vsname[VSNAMELENMAX + 1];
+    vsinstance_t *w    = NULL;
+    int32         iref = 0;
+
+    VSIindex_class(ref, vsclass);
+    if (fieldname == NULL)
+        return VSfindclass(f, vsclass);
+
+    /* an application vdata could have taken the name */
+    VSIindex_name(ref, fieldname, vsname);
+    if ((iref = VSfind(f, vsname)) <= 0 || (w = vsinst(f, (uint16)iref)) == NULL ||
+        strcmp(w->vs->vsclass, vsclass) != 0)
+        return 0;
+    return iref;
+} /* VSIfind_index */
+
+/*******************************************************************************
+ NAME
+    VSIcheck_field  --  Check that a field of a vdata can be indexed.
+
+ DESCRIPTION
+    Finds field 'fieldname' of vdata 'vkey' and checks that it has a
+    single value, of an integer type of at most 32 bits or of a
+    floating-point type, which a float64 holds exactly, and that its
+    name fits in the name of its index, VSINDEX_FIELDMAX characters.
+
+ RETURNS
+    Returns SUCCEED/FAIL
+
+*******************************************************************************/
+static int
+VSIcheck_field(int32 vkey, const char *fieldname, VDATA **vs_out, int32 *findex, int32 *type)
+{
+    vsinstance_t *wi        = NULL;
+    VDATA        *vs        = NULL;
+    int           ret_value = SUCCEED;
+
+    /* check if vdata is part of vdata group */
+    if (HAatom_group(vkey) != VSIDGROUP)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get vdata instance */
+    if (NULL == (wi = (vsinstance_t *)HAatom_object(vkey)))
+        HGOTO_ERROR(DFE_NOVS, FAIL);
+
+    /* get vdata itself and check it */
+    vs = wi->vs;
+    if (vs == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (fieldname == NULL || VSfindex(vkey, fieldname, findex) == FAIL)
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+    if (vs->wlist.order[*findex] != 1 || strlen(fieldname) > VSINDEX_FIELDMAX)
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+
+    *type = (int32)vs->wlist.type[*findex];
+    switch (*type & DFNT_MASK) {
+        case DFNT_INT8:
+        case DFNT_UINT8:
+        case DFNT_INT16:
+        case DFNT_UINT16:
+        case DFNT_INT32:
+        case DFNT_UINT32:
+        case DFNT_FLOAT32:
+        case DFNT_FLOAT64:
+            break;
+        default:
+            HGOTO_ERROR(DFE_BADNUMTYPE, FAIL);
+    }
+
+    *vs_out = vs;
+
+done:
+    return ret_value;
+} /* VSIcheck_field */
+
+/*******************************************************************************
+ NAME
+    VSIread_values  --  Read values of a field as float64.
+
+ DESCRIPTION
+    Reads field 'findex', of number type 'type', of 'n' records from
+    record 'start' on with VSreadcolumns, through 'tmp', and puts them
+    into 'values'.
+
+ RETURNS
+    Returns SUCCEED/FAIL
+
+*******************************************************************************/
+static int
+VSIread_values(int32 vkey, int32 findex, int32 type, int32 start, int32 n, void *tmp, float64 *values)
+{
+    int32 i;
+    int   ret_value = SUCCEED;
+
+    if (VSreadcolumns(vkey, 1, &findex, &tmp, start, n) != n)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+    switch (type & DFNT_MASK) {
+        case DFNT_INT8:
+            for (i = 0; i < n; i++)
+                values[i] = (float64)((int8 *)tmp)[i];
+            break;
+        case DFNT_UINT8:
+            for (i = 0; i < n; i++)
+                values[i] = (float64)((uint8 *)tmp)[i];
+            break;
+        case DFNT_INT16:
+            for (i = 0; i < n; i++)
+                values[i] = (float64)((int16 *)tmp)[i];
+            break;
+        case DFNT_UINT16:
+            for (i = 0; i < n; i++)
+                values[i] = (float64)((uint16 *)tmp)[i];
+            break;
+        case DFNT_INT32:
+            for (i = 0; i < n; i++)
+                values[i] = (float64)((int32 *)tmp)[i];
+            break;
+        case DFNT_UINT32:
+            for (i = 0; i < n; i++)
+                values[i] = (float64)((uint32 *)tmp)[i];
+            break;
+        case DFNT_FLOAT32:
+            for (i = 0; i < n; i++)
+                values[i] = (float64)((float32 *)tmp)[i];
+            break;
+        default:
+            memcpy(values, tmp, (size_t)n * sizeof(float64));
+            break;
+    }
+
+done:
+    return ret_value;
+} /* VSIread_values */
+
+/* Order of the entries of an index: by value, NaNs last, then by record */
+static int
+VSIcompare_entries(const void *a, const void *b)
+{
+    const vsindex_entry_t *x    = (const vsindex_entry_t *)a;
+    const vsindex_entry_t *y    = (const vsindex_entry_t *)b;
+    int                    xnan = isnan(x->value) != 0;
+    int                    ynan = isnan(y->value) != 0;
+
+    if (xnan != ynan)
+        return xnan - ynan;
+    if (x->value < y->value)
+        return -1;
+    if (x->value > y->value)
+        return 1;
+    return (x->rec > y->rec) - (x->rec < y->rec);
+} /* VSIcompare_entries */
+
+/* Order of record numbers */
+static int
+VSIcompare_recs(const void *a, const void *b)
+{
+    int32 x = *(const int32 *)a;
+    int32 y = *(const int32 *)b;
+
+    return (x > y) - (x < y);
+} /* VSIcompare_recs */
+
+/*******************************************************************************
+ NAME
+    VSIsearch_index  --  Binary-search an index.
+
+ DESCRIPTION
+    Finds the first of the 'nrecs' entries of index vdata 'ikey' whose
+    value is not less than 'key', or greater than 'key' if 'after' is
+    TRUE.  Only the entries probed are read.
+
+ RETURNS
+    Returns the number of the entry found, 'nrecs' if there is none;
+    FAIL on error.
+
+*******************************************************************************/
+static int32
+VSIsearch_index(int32 ikey, int32 nrecs, float64 key, int after)
+{
+    float64 value;
+    void   *buf    = &value;
+    int32   vfield = 0; /* VSINDEX_VALUE */
+    int32   lo     = 0;
+    int32   hi     = nrecs;
+    int32   mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (VSreadcolumns(ikey, 1, &vfield, &buf, mid, 1) != 1)
+            return FAIL;
+        /* NaNs, sorted last, compare as greater than any key */
+        if (after ? value <= key : value < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+} /* VSIsearch_index */
+
+/*******************************************************************************
+ NAME
+    VSPdelete_indexes  --  Delete the indexes of a vdata.
+
+ DESCRIPTION
+    Deletes the index vdatas of every field of the vdata with ref 'ref'
+    in file 'f'.  Called when the vdata itself is deleted, and when
+    VSwrite writes over its records.
+
+ RETURNS
+    Returns SUCCEED/FAIL
+
+*******************************************************************************/
+int
+VSPdelete_indexes(HFILEID f, uint16 ref)
+{
+    int32 iref;
+    int   ret_value = SUCCEED;
+
+    while ((iref = VSIfind_index(f, ref, NULL)) > 0)
+        if (VSdelete(f, iref) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    return ret_value;
+} /* VSPdelete_indexes */
+
+/*******************************************************************************
+NAME
+   VSbuildindex
+
+DESCRIPTION
+   Builds a sorted index of field 'fieldname' of vdata 'vkey', which
+   VSselect then searches instead of reading the whole vdata.  The field
+   must have a single value of an integer type of at most 32 bits or of
+   a floating-point type, and its name must be no longer than 45
+   characters.  The file must be open for writing; the vdata may be
+   attached for reading.
+
+   The index is stored in the file, in a vdata of its own, and replaces
+   the index the field had.  It is not updated when records are written:
+   an index whose number of records differs from the vdata's is not
+   used, and VSwrite deletes the indexes of a vdata whose records it
+   writes over, so the index must be built again after records are
+   appended or changed.  Deleting the vdata deletes its indexes.
+
+   The index is sorted in memory, which takes 16 bytes per record of the
+   vdata, 160 MB for 10 million records, besides the buffers of
+   VSINDEX_BLOCK records used to read the field and write the index.
+
+   The vdata is left positioned after its last record.
+
+RETURNS
+   Returns SUCCEED/FAIL
+
+*******************************************************************************/
+int
+VSbuildindex(int32       vkey, /* IN: vdata key */
+             const char *fieldname /* IN: name of the field to index */)
+{
+    H4_API_ENTER;
+
+    char             vsclass[VSNAMELENMAX + 1];
+    char             vsname[VSNAMELENMAX + 1];
+    vsindex_entry_t *ents   = NULL; /* the entries of the index */
+    float64         *values = NULL; /* values of a block of records */
+    uint8           *buf    = NULL; /* field values as read, or index records as written */
+    uint8           *p;
+    int32            ikey = FAIL; /* the index vdata */
+    int32            iref = 0;    /* its ref */
+    int32            oref;        /* ref of the old index */
+    int32            findex, type;
+    int32            nrecs, block, done, n, i;
+    VDATA           *vs        = NULL;
+    int              ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (VSIcheck_field(vkey, fieldname, &vs, &findex, &type) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* the old index goes */
+    if ((oref = VSIfind_index(vs->f, vs->oref, fieldname)) > 0 && VSdelete(vs->f, oref) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    /* an empty vdata needs no index */
+    if ((nrecs = vs->nvertices) == 0)
+        HGOTO_DONE(SUCCEED);
+
+    /* read the values of the field and sort them */
+    block = MIN(nrecs, VSINDEX_BLOCK);
+    if ((size_t)nrecs > SIZE_MAX / sizeof(vsindex_entry_t))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((ents = (vsindex_entry_t *)malloc((size_t)nrecs * sizeof(vsindex_entry_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((values = (float64 *)malloc((size_t)block * sizeof(float64))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if ((buf = (uint8 *)malloc((size_t)block * VSINDEX_RECSIZE)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    for (done = 0; done < nrecs; done += n) {
+        n = MIN(block, nrecs - done);
+        if (VSIread_values(vkey, findex, type, done, n, buf, values) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        for (i = 0; i < n; i++) {
+            ents[done + i].value = values[i];
+            ents[done + i].rec   = done + i;
+        }
+    }
+
+    qsort(ents, (size_t)nrecs, sizeof(vsindex_entry_t), VSIcompare_entries);
+
+    /* write them to a new index vdata */
+    VSIindex_class(vs->oref, vsclass);
+    VSIindex_name(vs->oref, fieldname, vsname);
+    if ((ikey = VSattach(vs->f, -1, "w")) == FAIL)
+        HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+    if ((iref = VSQueryref(ikey)) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (VSsetname(ikey, vsname) == FAIL || VSsetclass(ikey, vsclass) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (VSfdefine(ikey, VSINDEX_VALUE, DFNT_FLOAT64, 1) == FAIL ||
+        VSfdefine(ikey, VSINDEX_RECORD, DFNT_INT32, 1) == FAIL)
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+    if (VSsetfields(ikey, VSINDEX_FIELDS) == FAIL)
+        HGOTO_ERROR(DFE_BADFIELDS, FAIL);
+
+    for (done = 0; done < nrecs; done += n) {
+        n = MIN(block, nrecs - done);
+        for (i = 0, p = buf; i < n; i++, p += VSINDEX_RECSIZE) {
+            memcpy(p, &ents[done + i].value, sizeof(float64));
+            memcpy(p + sizeof(float64), &ents[done + i].rec, sizeof(int32));
+        }
+        if (VSwrite(ikey, buf, n, FULL_INTERLACE) != n)
+            HGOTO_ERROR(DFE_VSWRITE, FAIL);
+    }
+
+    if (VSdetach(ikey) == FAIL)
+        HGOTO_ERROR(DFE_CANTDETACH, FAIL);
+    ikey = FAIL;
+
+done:
+    if (ret_value == FAIL) {
+        /* do not leave a partial index behind */
+        if (ikey != FAIL)
+            VSdetach(ikey);
+        if (iref > 0)
+            VSdelete(vs->f, iref);
+    }
+    free(buf);
+    free(values);
+    free(ents);
+    return ret_value;
+} /* VSbuildindex */
+
+/*******************************************************************************
+NAME
+   VSselect
+
+DESCRIPTION
+   Finds the records of vdata 'vkey' whose value of field 'fieldname' is
+   between 'lo' and 'hi', both included, and puts the numbers of the
+   first 'maxrecs' of them, in increasing order, into 'recnums'.  With
+   'maxrecs' 0, 'recnums' may be NULL and only the records are counted.
+
+   If the field has an index (see VSbuildindex) with as many records as
+   the vdata, it is binary-searched, and only the part of it that
+   matches is read.  Otherwise the values of the field are read as with
+   VSreadcolumns, and the vdata is left positioned after its last
+   record.
+
+   The field must be one VSbuildindex can index, whether it has an
+   index or not.  NaN values are never selected.
+
+RETURNS
+   Returns the number of records whose value is in the range, which may
+   be more than 'maxrecs'; FAIL on error.
+
+*******************************************************************************/
+int32
+VSselect(int32       vkey,      /* IN: vdata key */
+         const char *fieldname, /* IN: name of the field */
+         float64     lo,        /* IN: smallest value selected */
+         float64     hi,        /* IN: largest value selected */
+         int32       recnums[], /* OUT: numbers of the records selected */
+         int32       maxrecs /* IN: size of recnums */)
+{
+    H4_API_ENTER;
+
+    float64 *values = NULL; /* values of a block of records */
+    void    *buf    = NULL; /* field values as read, or the records selected */
+    int32    ikey   = FAIL; /* the index vdata */
+    int32    iref;
+    int32    rfield = 1; /* VSINDEX_RECORD */
+    int32    findex, type;
+    int32    nrecs, block, done, n, i;
+    int32    first, last;
+    int32    count     = 0;
+    VDATA   *vs        = NULL;
+    int32    ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (isnan(lo) || isnan(hi) || maxrecs < 0 || (recnums == NULL && maxrecs > 0))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (VSIcheck_field(vkey, fieldname, &vs, &findex, &type) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if ((nrecs = vs->nvertices) == 0 || lo > hi)
+        HGOTO_DONE(0);
+
+    /* use the index if it is up to date */
+    if ((iref = VSIfind_index(vs->f, vs->oref, fieldname)) > 0) {
+        if ((ikey = VSattach(vs->f, iref, "r")) == FAIL)
+            HGOTO_ERROR(DFE_CANTATTACH, FAIL);
+        if (VSelts(ikey) != nrecs) {
+            VSdetach(ikey);
+            ikey = FAIL;
+        }
+    }
+
+    if (ikey != FAIL) {
+        if ((first = VSIsearch_index(ikey, nrecs, lo, FALSE)) == FAIL ||
+            (last = VSIsearch_index(ikey, nrecs, hi, TRUE)) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        count = last - first;
+
+        if (count > 0 && maxrecs > 0) {
+            /* they are in the order of their values; all are needed to find the first ones */
+            buf = (count > maxrecs) ? malloc((size_t)count * sizeof(int32)) : (void *)recnums;
+            if (buf == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+            if (VSreadcolumns(ikey, 1, &rfield, &buf, first, count) != count)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+            qsort(buf, (size_t)count, sizeof(int32), VSIcompare_recs);
+            if (buf != (void *)recnums) {
+                memcpy(recnums, buf, (size_t)maxrecs * sizeof(int32));
+                free(buf);
+            }
+            buf = NULL;
+        }
+    }
+    else {
+        /* no index: look at every record */
+        block = MIN(nrecs, VSINDEX_BLOCK);
+        if ((values = (float64 *)malloc((size_t)block * sizeof(float64))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if ((buf = malloc((size_t)block * sizeof(float64))) == NULL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+        for (done = 0; done < nrecs; done += n) {
+            n = MIN(block, nrecs - done);
+            if (VSIread_values(vkey, findex, type, done, n, buf, values) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+            for (i = 0; i < n; i++)
+                if (values[i] >= lo && values[i] <= hi) {
+                    if (count < maxrecs)
+                        recnums[count] = done + i;
+                    count++;
+                }
+        }
+    }
+
+    ret_value = count;
+
+done:
+    if (ikey != FAIL)
+        VSdetach(ikey);
+    if (buf != (void *)recnums)
+        free(buf);
+    free(values);
+    return ret_value;
+} /* VSselect */
@@ -95,6 +95,11 @@ set (HDF4_TESTHDF_FILES
     tuservgs.hdf
     tvattr.hdf
     tvpack.hdf
+    tvsappend.hdf
+    tvsindex.hdf
+    tvslazy.hdf
+    tvsfind.hdf
+    tvscolumns.hdf
     tvsempty.hdf
     tvset.hdf
     tvsetext.hdf
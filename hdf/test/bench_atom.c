@@ -0,0 +1,155 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/****************************************************************************
+ * bench_atom.c - times HAatom_object, which resolves the IDs handed out by
+ *      the library, with 10, 1000 and 100000 live atoms in a group.
+ *
+ *      The IDs are resolved in the order they were registered, in a
+ *      random order, and always the same one (the common case of a loop
+ *      reading one data set).  The time of registering and removing all
+ *      the atoms is shown too.
+ *
+ *      This is not run as part of the test suite.
+ *
+ * Usage: bench_atom [nlookups]
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hdf.h"
+#include "atom_priv.h"
+
+#ifdef H4_HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+#define BENCH_GROUP GRIDGROUP
+#define NLOOKUPS    1000000
+
+static const int natoms_cases[] = {10, 1000, 100000};
+
+/* Wall clock time in seconds */
+static double
+now(void)
+{
+#ifdef H4_HAVE_SYS_TIME_H
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1e6;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* Resolve the nlookups IDs of 'order'; returns nanoseconds per lookup */
+static double
+time_lookups(const atom_t *order, long nlookups, const int *objs, int natoms)
+{
+    const int *obj;
+    double     t0, t1;
+    long       i, bad = 0;
+
+    t0 = now();
+    for (i = 0; i < nlookups; i++) {
+        obj = (const int *)HAatom_object(order[i]);
+        bad += (obj < objs || obj >= objs + natoms);
+    }
+    t1 = now();
+
+    if (bad > 0) {
+        fprintf(stderr, "%ld lookups failed\n", bad);
+        exit(EXIT_FAILURE);
+    }
+    return (t1 - t0) * 1e9 / (double)nlookups;
+}
+
+int
+main(int argc, char *argv[])
+{
+    long     nlookups = NLOOKUPS;
+    atom_t  *atoms, *order;
+    int     *objs;
+    unsigned seed = 12345;
+    double   t0, t_reg, t_rem;
+    size_t   c;
+    long     i;
+    int      n;
+
+    if (argc > 1)
+        nlookups = atol(argv[1]);
+    if (nlookups <= 0) {
+        fprintf(stderr, "usage: %s [nlookups]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    atoms = (atom_t *)malloc(100000 * sizeof(atom_t));
+    objs  = (int *)malloc(100000 * sizeof(int));
+    order = (atom_t *)malloc((size_t)nlookups * sizeof(atom_t));
+    if (atoms == NULL || objs == NULL || order == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%ld lookups, ns per lookup; register/remove in ns per atom\n", nlookups);
+    printf("%-8s %10s %10s %10s %10s %10s\n", "atoms", "in order", "random", "same", "register", "remove");
+
+    for (c = 0; c < sizeof(natoms_cases) / sizeof(natoms_cases[0]); c++) {
+        int natoms = natoms_cases[c];
+
+        if (HAinit_group(BENCH_GROUP, 64) == FAIL) {
+            fprintf(stderr, "HAinit_group failed\n");
+            return EXIT_FAILURE;
+        }
+
+        t0 = now();
+        for (n = 0; n < natoms; n++)
+            if ((atoms[n] = HAregister_atom(BENCH_GROUP, &objs[n])) == FAIL) {
+                fprintf(stderr, "HAregister_atom failed\n");
+                return EXIT_FAILURE;
+            }
+        t_reg = (now() - t0) * 1e9 / natoms;
+
+        printf("%-8d", natoms);
+
+        for (i = 0; i < nlookups; i++)
+            order[i] = atoms[i % natoms];
+        printf(" %10.2f", time_lookups(order, nlookups, objs, natoms));
+
+        for (i = 0; i < nlookups; i++) {
+            seed     = seed * 1103515245U + 12345U;
+            order[i] = atoms[(seed >> 8) % (unsigned)natoms];
+        }
+        printf(" %10.2f", time_lookups(order, nlookups, objs, natoms));
+
+        for (i = 0; i < nlookups; i++)
+            order[i] = atoms[natoms / 2];
+        printf(" %10.2f", time_lookups(order, nlookups, objs, natoms));
+
+        t0 = now();
+        for (n = 0; n < natoms; n++)
+            HAremove_atom(atoms[n]);
+        t_rem = (now() - t0) * 1e9 / natoms;
+
+        printf(" %10.1f %10.1f\n", t_reg, t_rem);
+
+        HAdestroy_group(BENCH_GROUP);
+    }
+
+    free(order);
+    free(objs);
+    free(atoms);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,167 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/****************************************************************************
+ * bench_swap.c - times the byte swapping routines DFKsb2b, DFKsb4b and
+ *      DFKsb8b, which convert big-endian data on little-endian hosts.
+ *
+ *      Every item size is timed with each of these source/destination
+ *      strides, given in items (0 is the library's "contiguous"):
+ *          0/0, 1/1, 0/1, in place, 2/1, 1/2 and 2/3
+ *      and compared with a plain byte-by-byte loop doing the same work.
+ *      The contiguous cases, including in place, use the vector kernels
+ *      when the CPU has them; the others use the stride loops.
+ *
+ *      This is not run as part of the test suite.
+ *
+ * Usage: bench_swap [nitems [nrepeat]]
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hdf.h"
+
+#ifdef H4_HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+#define NITEMS  (1024 * 1024)
+#define NREPEAT 20
+
+typedef int (*swap_func_t)(void *s, void *d, uint32 num_elm, uint32 source_stride, uint32 dest_stride);
+
+typedef struct {
+    const char *name;
+    uint32      sstride; /* in items */
+    uint32      dstride;
+    int         in_place;
+} stride_case_t;
+
+static const stride_case_t cases[] = {
+    {"0/0", 0, 0, 0}, {"1/1", 1, 1, 0}, {"0/1", 0, 1, 0}, {"in place", 0, 0, 1},
+    {"2/1", 2, 1, 0}, {"1/2", 1, 2, 0}, {"2/3", 2, 3, 0},
+};
+
+/* Wall clock time in seconds */
+static double
+now(void)
+{
+#ifdef H4_HAVE_SYS_TIME_H
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1e6;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* The byte-by-byte loop the library used for every stride */
+static void
+ref_swap(const uint8 *source, uint8 *dest, uint32 num_elm, uint32 size, uint32 sstride, uint32 dstride)
+{
+    uint8  buf[8];
+    uint32 i, j;
+
+    for (i = 0; i < num_elm; i++) {
+        for (j = 0; j < size; j++)
+            buf[j] = source[size - 1 - j];
+        for (j = 0; j < size; j++)
+            dest[j] = buf[j];
+        source += sstride;
+        dest += dstride;
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const swap_func_t funcs[3] = {DFKsb2b, DFKsb4b, DFKsb8b};
+    uint32                   nitems   = NITEMS;
+    int                      nrepeat  = NREPEAT;
+    uint8                   *src, *dst, *check;
+    size_t                   bufsize;
+    int                      w, r;
+    size_t                   c;
+
+    if (argc > 1)
+        nitems = (uint32)atol(argv[1]);
+    if (argc > 2)
+        nrepeat = atoi(argv[2]);
+    if (nitems == 0 || nrepeat <= 0) {
+        fprintf(stderr, "usage: %s [nitems [nrepeat]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* room for the widest stride: 3 items of 8 bytes */
+    bufsize = (size_t)nitems * 3 * 8;
+    src     = (uint8 *)malloc(bufsize);
+    dst     = (uint8 *)malloc(bufsize);
+    check   = (uint8 *)malloc(bufsize);
+    if (src == NULL || dst == NULL || check == NULL)
+        return EXIT_FAILURE;
+    for (c = 0; c < bufsize; c++)
+        src[c] = (uint8)(c * 31 + 7);
+
+    printf("%lu items, best of %d runs, MB/s of items swapped\n", (unsigned long)nitems, nrepeat);
+    printf("%-6s %-10s %12s %12s %8s\n", "size", "strides", "DFKsb", "byte loop", "speedup");
+
+    for (w = 0; w < 3; w++) {
+        uint32 size = 2U << w;
+
+        for (c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+            uint32 sstride = cases[c].sstride * size;
+            uint32 dstride = cases[c].dstride * size;
+            uint8 *dest    = cases[c].in_place ? src : dst;
+            double best = 0.0, best_ref = 0.0;
+            double mb   = (double)nitems * size / 1e6;
+
+            for (r = 0; r < nrepeat; r++) {
+                double t0, t1, t2;
+
+                t0 = now();
+                funcs[w](src, dest, nitems, sstride, dstride);
+                t1 = now();
+                ref_swap(src, dest, nitems, size, sstride ? sstride : size, dstride ? dstride : size);
+                t2 = now();
+
+                if (r == 0 || t1 - t0 < best)
+                    best = t1 - t0;
+                if (r == 0 || t2 - t1 < best_ref)
+                    best_ref = t2 - t1;
+            }
+
+            /* in place, an even number of swaps leaves the data as it was */
+            if (!cases[c].in_place) {
+                memcpy(check, dst, bufsize);
+                ref_swap(src, dst, nitems, size, sstride ? sstride : size, dstride ? dstride : size);
+                funcs[w](src, check, nitems, sstride, dstride);
+                if (memcmp(check, dst, bufsize) != 0) {
+                    fprintf(stderr, "DFKsb%ub gives wrong results with strides %s\n", (unsigned)size,
+                            cases[c].name);
+                    return EXIT_FAILURE;
+                }
+            }
+
+            printf("%-6u %-10s %12.1f %12.1f %8.2f\n", (unsigned)size, cases[c].name,
+                   best > 0.0 ? mb / best : 0.0, best_ref > 0.0 ? mb / best_ref : 0.0,
+                   best > 0.0 ? best_ref / best : 0.0);
+        }
+    }
+
+    free(src);
+    free(dst);
+    free(check);
+    return EXIT_SUCCESS;
+}
@@ -55,6 +55,47 @@ static const char *test_name[] = {"Big-Endian", "Little-Endian", "Native"};
 /* close enough */
 #define EPS64 ((float64)1.0E-14)
 #define EPS32 ((float32)1.0E-7)
+
+/* Check the byte swapping routines directly: a swap done twice gives the
+   data back even if it swaps the wrong bytes */
+static void
+test_swap(void)
+{
+    static int (*const swap[3])(void *, void *, uint32, uint32, uint32) = {DFKsb2b, DFKsb4b, DFKsb8b};
+    uint8  src[8 * 67 + 1], dst[8 * 67 + 1], expect[8 * 67 + 1];
+    uint32 num, k, size;
+    int    w, off, in_place;
+
+    for (w = 0; w < 3; w++) {
+        size = 2U << w;
+        for (num = 1; num <= 67; num++)
+            for (off = 0; off < 2; off++) /* unaligned buffers too */
+                for (in_place = 0; in_place < 2; in_place++) {
+                    int32 ret;
+
+                    for (k = 0; k < size * num; k++) {
+                        src[off + k]    = (uint8)(k * 7 + num);
+                        expect[off + k] = (uint8)((k - k % size + (size - 1 - k % size)) * 7 + num);
+                    }
+                    if (in_place) {
+                        ret = swap[w](src + off, src + off, num, 0, size);
+                        if (memcmp(src + off, expect + off, size * num)) {
+                            printf("Error swapping %u %u-byte values in place\n", (unsigned)num, (unsigned)size);
+                            num_errs++;
+                        }
+                    }
+                    else {
+                        ret = swap[w](src + off, dst + off, num, size, 0);
+                        if (memcmp(dst + off, expect + off, size * num)) {
+                            printf("Error swapping %u %u-byte values\n", (unsigned)num, (unsigned)size);
+                            num_errs++;
+                        }
+                    }
+                    RESULT("DFKsb");
+                }
+    }
+} /* end test_swap() */
+
 void
 test_conv(void)
 {
@@ -748,4 +789,22 @@ test_conv(void)
         free(dst2_float64);
     } /* end for */
 
+    MESSAGE(5, printf("Testing byte swapping\n"););
+    test_swap();
+
+    /* number types read and written without a conversion buffer */
+    MESSAGE(5, printf("Testing number types that need no conversion\n"););
+    if (!DFKiscopyNT(DFNT_UINT8) || !DFKiscopyNT(DFNT_LCHAR8) || !DFKiscopyNT(DFNT_NFLOAT64) ||
+        DFKiscopyNT(DFNT_CUSTOM)) {
+        printf("Error: DFKiscopyNT is wrong for byte, native or custom types\n");
+        num_errs++;
+    }
+#ifdef H4_WORDS_BIGENDIAN
+    if (!DFKiscopyNT(DFNT_FLOAT32) || DFKiscopyNT(DFNT_LFLOAT32) || DFKiscopyNT(DFNT_LINT16)) {
+#else
+    if (DFKiscopyNT(DFNT_FLOAT32) || !DFKiscopyNT(DFNT_LFLOAT32) || !DFKiscopyNT(DFNT_LINT16)) {
+#endif
+        printf("Error: DFKiscopyNT is wrong for big or little-endian types\n");
+        num_errs++;
+    }
 } /* end test_conv() */
@@ -50,6 +50,89 @@
 static uint8 *outbuf = NULL;
 static uint8 *inbuf  = NULL;
 
+/* Number of tag/ref pairs written by test_dd_lookup, more than the
+   initial size of the DD hash so that it has to grow a few times */
+#define NUM_DD_LOOKUP 3000
+
+/* Exact tag/ref lookups in a file with many DDs, including lookups of
+   elements that were deleted */
+static void
+test_dd_lookup(void)
+{
+    int32  fid;
+    int32  ret;
+    uint16 ref;
+    uint16 find_tag, find_ref;
+    int32  find_off, find_len;
+    int    i;
+
+    MESSAGE(5, printf("Looking up tag/refs in a file with %d DDs\n", NUM_DD_LOOKUP););
+    fid = Hopen(TESTFILE_NAME, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    for (i = 0; i < NUM_DD_LOOKUP; i++) {
+        ref = (uint16)(i / 3 + 1);
+        ret = Hputelement(fid, (uint16)(200 + i % 3), ref, outbuf, (int32)(i % 100 + 1));
+        CHECK_VOID(ret, FAIL, "Hputelement");
+    }
+
+    /* Delete every tenth element of tag 201 */
+    for (i = 1; i < NUM_DD_LOOKUP; i += 30) {
+        ret = Hdeldd(fid, (uint16)201, (uint16)(i / 3 + 1));
+        CHECK_VOID(ret, FAIL, "Hdeldd");
+    }
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    /* Size the DD hash for the file up front */
+    ret = Hsetnddshint(-1);
+    VERIFY_VOID(ret, FAIL, "Hsetnddshint");
+    ret = Hsetnddshint(NUM_DD_LOOKUP);
+    CHECK_VOID(ret, FAIL, "Hsetnddshint");
+
+    fid = Hopen(TESTFILE_NAME, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    ret = Hsetnddshint(0);
+    CHECK_VOID(ret, FAIL, "Hsetnddshint");
+
+    for (i = 0; i < NUM_DD_LOOKUP; i++) {
+        uint16 tag     = (uint16)(200 + i % 3);
+        int    deleted = (i % 30 == 1);
+
+        ref = (uint16)(i / 3 + 1);
+        ret = Hexist(fid, tag, ref);
+        VERIFY_VOID(ret, (deleted ? FAIL : SUCCEED), "Hexist");
+        if (!deleted) {
+            ret = Hlength(fid, tag, ref);
+            VERIFY_VOID(ret, (i % 100 + 1), "Hlength");
+        }
+    }
+
+    /* The special version of a tag (0x4000 bit set) finds the same element */
+    ret = Hexist(fid, (uint16)(200 | 0x4000), 1);
+    VERIFY_VOID(ret, SUCCEED, "Hexist");
+
+    /* Tags that are not in the file */
+    ret = Hexist(fid, (uint16)199, 1);
+    VERIFY_VOID(ret, FAIL, "Hexist");
+    ret = Hexist(fid, (uint16)199, DFREF_WILDCARD);
+    VERIFY_VOID(ret, FAIL, "Hexist");
+
+    /* Wildcard searches still go in DD list order */
+    find_tag = find_ref = 0;
+    ret = Hfind(fid, (uint16)202, DFREF_WILDCARD, &find_tag, &find_ref, &find_off, &find_len, DF_FORWARD);
+    CHECK_VOID(ret, FAIL, "Hfind");
+    VERIFY_VOID(find_ref, 1, "Hfind");
+    ret = Hfind(fid, (uint16)202, DFREF_WILDCARD, &find_tag, &find_ref, &find_off, &find_len, DF_FORWARD);
+    CHECK_VOID(ret, FAIL, "Hfind");
+    VERIFY_VOID(find_ref, 2, "Hfind");
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+}
+
 void
 test_hfile(void)
 {
@@ -210,6 +293,55 @@ test_hfile(void)
     ret = Hclose(fid1);
     CHECK_VOID(ret, FAIL, "Hclose");
 
+    MESSAGE(5, printf("Reading file %s through a memory mapping\n", TESTFILE_NAME););
+    fid = Hopen(TESTFILE_NAME, DFACC_WRITE | DFACC_MMAP, 0);
+    VERIFY_VOID(fid, FAIL, "Hopen");
+
+    fid = Hopen(TESTFILE_NAME, DFACC_READ | DFACC_MMAP, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+
+    ret = Hgetelement(fid, (uint16)102, (uint16)2, inbuf);
+    VERIFY_VOID(ret, BUF_SIZE, "Hgetelement");
+    if (memcmp(inbuf, outbuf, BUF_SIZE) != 0) {
+        fprintf(stderr, "ERROR: wrong data read from the mapped file\n");
+        errors++;
+    }
+
+    aid1 = Hstartread(fid, 100, 4);
+    CHECK_VOID(aid1, FAIL, "Hstartread");
+
+    ret = Hseek(aid1, 1000, DF_START);
+    CHECK_VOID(ret, FAIL, "Hseek");
+
+    ret = Hread(aid1, 1000, inbuf);
+    VERIFY_VOID(ret, 1000, "Hread");
+    if (memcmp(inbuf, outbuf + 1000, 1000) != 0) {
+        fprintf(stderr, "ERROR: wrong data read from the mapped file\n");
+        errors++;
+    }
+
+    ret = Hendaccess(aid1);
+    CHECK_VOID(ret, FAIL, "Hendaccess");
+
+    /* Reopening for write drops the mapping, reads must still work */
+    fid1 = Hopen(TESTFILE_NAME, DFACC_RDWR, 0);
+    CHECK_VOID(fid1, FAIL, "Hopen");
+
+    ret = Hputelement(fid1, (uint16)104, (uint16)5, outbuf, 100);
+    CHECK_VOID(ret, FAIL, "Hputelement");
+
+    ret = Hgetelement(fid, (uint16)104, (uint16)5, inbuf);
+    VERIFY_VOID(ret, 100, "Hgetelement");
+
+    ret = Hgetelement(fid, (uint16)100, (uint16)1, inbuf);
+    VERIFY_VOID(ret, 14, "Hgetelement");
+
+    ret = Hclose(fid1);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
+    ret = Hclose(fid);
+    CHECK_VOID(ret, FAIL, "Hclose");
+
     ret_bool = (int)Hishdf(TESTFILE_NAME);
     CHECK_VOID(ret_bool, FALSE, "Hishdf");
 
@@ -219,6 +351,8 @@ test_hfile(void)
     ret_bool = (int)Hishdf("qqqqqqqq.qqq"); /* I sure hope it isn't there */
     CHECK_VOID(ret, TRUE, "Hishdf");
 
+    test_dd_lookup();
+
     free(outbuf);
     free(inbuf);
 }
@@ -0,0 +1,108 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+   FILE
+   tatom.c
+   Test HDF atom routines: atoms resolve to their objects, removed atoms
+   no longer resolve, not even once their slots are reused, and searches
+   see only the live atoms.
+ */
+
+#include "testhdf.h"
+#include "atom_priv.h"
+
+#define TEST_GROUP GRIDGROUP
+#define NUM_ATOMS  3000 /* more than the slots kept free before reuse */
+
+static int
+find_int(const void *obj, const void *key)
+{
+    return *(const int *)obj == *(const int *)key;
+}
+
+void
+test_atom(void)
+{
+    static int objs[2][NUM_ATOMS];
+    atom_t     atoms[2][NUM_ATOMS];
+    void      *obj;
+    int        key;
+    int        ret;
+    int        i, j;
+
+    MESSAGE(6, printf("Testing atom groups\n"););
+
+    ret = HAinit_group(TEST_GROUP, 64);
+    CHECK_VOID(ret, FAIL, "HAinit_group");
+
+    /* Two rounds: the second one reuses the slots of the first */
+    for (j = 0; j < 2; j++) {
+        MESSAGE(7, printf("Registering %d atoms, round %d\n", NUM_ATOMS, j););
+        for (i = 0; i < NUM_ATOMS; i++) {
+            objs[j][i]  = j * NUM_ATOMS + i;
+            atoms[j][i] = HAregister_atom(TEST_GROUP, &objs[j][i]);
+            CHECK_VOID(atoms[j][i], FAIL, "HAregister_atom");
+            VERIFY_VOID(HAatom_group(atoms[j][i]), TEST_GROUP, "HAatom_group");
+        }
+
+        for (i = 0; i < NUM_ATOMS; i++) {
+            obj = HAatom_object(atoms[j][i]);
+            VERIFY_VOID(obj, &objs[j][i], "HAatom_object");
+        }
+
+        /* The atoms of the first round are all gone */
+        if (j == 1)
+            for (i = 0; i < NUM_ATOMS; i++) {
+                obj = HAatom_object(atoms[0][i]);
+                VERIFY_VOID(obj, NULL, "HAatom_object");
+                obj = HAremove_atom(atoms[0][i]);
+                VERIFY_VOID(obj, NULL, "HAremove_atom");
+            }
+
+        key = j * NUM_ATOMS + NUM_ATOMS / 2;
+        obj = HAsearch_atom(TEST_GROUP, find_int, &key);
+        VERIFY_VOID(obj, &objs[j][NUM_ATOMS / 2], "HAsearch_atom");
+
+        /* Remove every other atom, then the rest */
+        for (i = 0; i < NUM_ATOMS; i += 2) {
+            obj = HAremove_atom(atoms[j][i]);
+            VERIFY_VOID(obj, &objs[j][i], "HAremove_atom");
+        }
+        for (i = 0; i < NUM_ATOMS; i++) {
+            obj = HAatom_object(atoms[j][i]);
+            VERIFY_VOID(obj, (i % 2 ? &objs[j][i] : NULL), "HAatom_object");
+        }
+        key = j * NUM_ATOMS + 2;
+        obj = HAsearch_atom(TEST_GROUP, find_int, &key);
+        VERIFY_VOID(obj, NULL, "HAsearch_atom");
+        for (i = 1; i < NUM_ATOMS; i += 2) {
+            obj = HAremove_atom(atoms[j][i]);
+            VERIFY_VOID(obj, &objs[j][i], "HAremove_atom");
+        }
+    }
+
+    /* A reused slot never gives back an atom of the first round */
+    for (i = 0; i < NUM_ATOMS; i++)
+        for (j = 0; j < NUM_ATOMS; j++)
+            if (atoms[1][i] == atoms[0][j]) {
+                printf("*** atom %ld was given out twice\n", (long)atoms[1][i]);
+                num_errs++;
+                return;
+            }
+
+    /* The errors of the lookups that had to fail are not the test's */
+    HEclear();
+
+    ret = HAdestroy_group(TEST_GROUP);
+    CHECK_VOID(ret, FAIL, "HAdestroy_group");
+} /* end test_atom() */
@@ -129,6 +129,7 @@ main(int argc, char *argv[])
     InitTest("bitvect", test_bitvect, "Bit-Vector routines");
     InitTest("tbbt", test_tbbt, "Threaded Balanced Binary Trees");
 #endif
+    InitTest("atom", test_atom, "Atom groups");
     InitTest("vers", test_vers, "VERSION OF LIBRARY");
     InitTest("hfile", test_hfile, "HFILE");
     InitTest("hfile_atexit", test_hfile_atexit, "HFILE ATEXIT");
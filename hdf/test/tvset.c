@@ -66,6 +66,9 @@ static void  test_getvdatas(void);
 static void  test_blockinfo_oneLB(void);
 static void  test_blockinfo_multLBs(void);
 static void  test_VSofclass(void);
+static void  test_readcolumns(void);
+static void  test_appendbuffer(void);
+static void  test_vsindex(void);
 
 /* write some stuff to the file */
 static int32
@@ -3321,6 +3324,717 @@ test_blockinfo(void)
 
 } /* test_blockinfo */
 
+/*************************** test_readcolumns ***************************
+
+This test routine writes a vdata of four fields of different types and
+orders, stored FULL_INTERLACE and then NO_INTERLACE, with more records
+than VSreadcolumns reads at a time, and reads some of its fields back
+with VSreadcolumns.
+
+***********************************************************************/
+
+#define COLUMNS_FILE "tvscolumns.hdf"
+#define COL_NREC     50000 /* records of 25 bytes, more than VDATA_BUFFER_MAX */
+#define COL_START    1234  /* first record read */
+
+static void
+test_readcolumns(void)
+{
+    int32          fid, vs1;
+    int32          ref[2];
+    int32          interlaces[2] = {FULL_INTERLACE, NO_INTERLACE};
+    int32          field_idx[3];
+    void          *bufs[3];
+    uint8         *recs;
+    uint8         *rec;
+    static float64 times[COL_NREC];
+    static int16   counts[COL_NREC][2];
+    static float32 pos[COL_NREC][3];
+    int32          nrecs = COL_NREC - COL_START - 10;
+    int32          status;
+    int32          i, j, k;
+
+    /* Records as VSwrite takes them, packed in memory */
+    recs = (uint8 *)malloc(COL_NREC * 25);
+    CHECK_ALLOC(recs, "recs", "test_readcolumns");
+    for (i = 0, rec = recs; i < COL_NREC; i++) {
+        float64 t = i * 0.5;
+        uint8   flag = (uint8)(i % 251);
+
+        memcpy(rec, &t, 8);
+        rec += 8;
+        for (j = 0; j < 3; j++) {
+            float32 p = (float32)i + (float32)j * 0.25F;
+
+            memcpy(rec, &p, 4);
+            rec += 4;
+        }
+        *rec++ = flag;
+        for (j = 0; j < 2; j++) {
+            int16 c = (int16)(i * 2 + j);
+
+            memcpy(rec, &c, 2);
+            rec += 2;
+        }
+    }
+
+    fid = Hopen(COLUMNS_FILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK_VOID(status, FAIL, "Vstart");
+
+    for (k = 0; k < 2; k++) {
+        vs1 = VSattach(fid, -1, "w");
+        CHECK_VOID(vs1, FAIL, "VSattach");
+        status = VSsetinterlace(vs1, interlaces[k]);
+        CHECK_VOID(status, FAIL, "VSsetinterlace");
+        status = VSfdefine(vs1, "Time", DFNT_FLOAT64, 1);
+        CHECK_VOID(status, FAIL, "VSfdefine");
+        status = VSfdefine(vs1, "Pos", DFNT_FLOAT32, 3);
+        CHECK_VOID(status, FAIL, "VSfdefine");
+        status = VSfdefine(vs1, "Flag", DFNT_UINT8, 1);
+        CHECK_VOID(status, FAIL, "VSfdefine");
+        status = VSfdefine(vs1, "Count", DFNT_INT16, 2);
+        CHECK_VOID(status, FAIL, "VSfdefine");
+        status = VSsetfields(vs1, "Time,Pos,Flag,Count");
+        CHECK_VOID(status, FAIL, "VSsetfields");
+        status = VSwrite(vs1, recs, COL_NREC, FULL_INTERLACE);
+        VERIFY_VOID(status, COL_NREC, "VSwrite");
+        ref[k] = VSQueryref(vs1);
+        status = VSdetach(vs1);
+        CHECK_VOID(status, FAIL, "VSdetach");
+    }
+
+    for (k = 0; k < 2; k++) {
+        MESSAGE(5, printf("reading columns of a %s vdata\n", k == 0 ? "FULL_INTERLACE" : "NO_INTERLACE"););
+
+        vs1 = VSattach(fid, ref[k], "r");
+        CHECK_VOID(vs1, FAIL, "VSattach");
+
+        /* Count and Time, in another order than in the vdata, and Pos */
+        field_idx[0] = 3;
+        field_idx[1] = 0;
+        field_idx[2] = 1;
+        bufs[0]      = counts;
+        bufs[1]      = times;
+        bufs[2]      = pos;
+        memset(counts, 0, sizeof(counts));
+        memset(times, 0, sizeof(times));
+        memset(pos, 0, sizeof(pos));
+        status = VSreadcolumns(vs1, 3, field_idx, bufs, COL_START, nrecs);
+        VERIFY_VOID(status, nrecs, "VSreadcolumns");
+
+        for (i = 0; i < nrecs; i++) {
+            int32 r = COL_START + i;
+
+            if (times[i] != r * 0.5 || counts[i][0] != (int16)(r * 2) || counts[i][1] != (int16)(r * 2 + 1) ||
+                pos[i][0] != (float32)r || pos[i][2] != (float32)r + 0.5F) {
+                num_errs++;
+                printf(">>> VSreadcolumns read wrong values for record %d\n", (int)r);
+                break;
+            }
+        }
+        if (counts[nrecs][0] != 0 || times[nrecs] != 0.0) {
+            num_errs++;
+            printf(">>> VSreadcolumns read past %d records\n", (int)nrecs);
+        }
+
+        /* The vdata is left after the records read */
+        if (interlaces[k] == FULL_INTERLACE) {
+            status = VSsetfields(vs1, "Flag");
+            CHECK_VOID(status, FAIL, "VSsetfields");
+            status = VSread(vs1, recs, 1, FULL_INTERLACE);
+            VERIFY_VOID(status, 1, "VSread");
+            VERIFY_VOID(recs[0], (COL_START + nrecs) % 251, "VSread");
+        }
+
+        /* Bad field index and records past the end */
+        field_idx[0] = 4;
+        status       = VSreadcolumns(vs1, 1, field_idx, bufs, 0, 1);
+        VERIFY_VOID(status, FAIL, "VSreadcolumns");
+        field_idx[0] = 2;
+        status       = VSreadcolumns(vs1, 1, field_idx, bufs, COL_NREC - 1, 2);
+        VERIFY_VOID(status, FAIL, "VSreadcolumns");
+
+        status = VSdetach(vs1);
+        CHECK_VOID(status, FAIL, "VSdetach");
+    }
+
+    status = Vend(fid);
+    CHECK_VOID(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+    free(recs);
+} /* test_readcolumns */
+
+/*************************** test_appendbuffer ***************************
+
+This test routine writes records to two vdatas of the same file, then
+appends more one at a time to both in turn, so that they become
+linked-block elements, reads some of them back in the middle, and
+checks all of them once the vdatas are detached.  The vdata without a
+block size set gets larger blocks than the default; the other one keeps
+its own.
+
+***********************************************************************/
+
+#define APPEND_FILE "tvsappend.hdf"
+#define APPEND_NREC  20000
+#define APPEND_FIRST 2000 /* records written at once first */
+#define APPEND_BLK   1000 /* block size set for the second vdata */
+
+static void
+test_appendbuffer(void)
+{
+    int32 fid;
+    int32 vs[2];
+    int32 ref[2];
+    int32 rec[2];
+    int32 first[APPEND_FIRST][2];
+    int32 back[20];
+    int32 block_size;
+    int32 status;
+    int32 i, k;
+
+    fid = Hopen(APPEND_FILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK_VOID(status, FAIL, "Vstart");
+
+    for (k = 0; k < 2; k++) {
+        vs[k] = VSattach(fid, -1, "w");
+        CHECK_VOID(vs[k], FAIL, "VSattach");
+        status = VSfdefine(vs[k], "Pair", DFNT_INT32, 2);
+        CHECK_VOID(status, FAIL, "VSfdefine");
+        status = VSsetfields(vs[k], "Pair");
+        CHECK_VOID(status, FAIL, "VSsetfields");
+        ref[k] = VSQueryref(vs[k]);
+    }
+    status = VSsetblocksize(vs[1], APPEND_BLK);
+    CHECK_VOID(status, FAIL, "VSsetblocksize");
+
+    for (k = 0; k < 2; k++) {
+        for (i = 0; i < APPEND_FIRST; i++) {
+            first[i][0] = i;
+            first[i][1] = k * APPEND_NREC + i;
+        }
+        status = VSwrite(vs[k], (uint8 *)first, APPEND_FIRST, FULL_INTERLACE);
+        VERIFY_VOID(status, APPEND_FIRST, "VSwrite");
+    }
+
+    for (i = APPEND_FIRST; i < APPEND_NREC; i++) {
+        for (k = 0; k < 2; k++) {
+            rec[0] = i;
+            rec[1] = k * APPEND_NREC + i;
+            status = VSwrite(vs[k], (uint8 *)rec, 1, FULL_INTERLACE);
+            VERIFY_VOID(status, 1, "VSwrite");
+        }
+
+        /* Read back the first records, then carry on appending */
+        if (i == APPEND_NREC / 2) {
+            VERIFY_VOID(VSelts(vs[0]), i + 1, "VSelts");
+            status = VSseek(vs[0], 0);
+            CHECK_VOID(status, FAIL, "VSseek");
+            status = VSread(vs[0], (uint8 *)back, 10, FULL_INTERLACE);
+            VERIFY_VOID(status, 10, "VSread");
+            VERIFY_VOID(back[18], 9, "VSread");
+            status = VSseek(vs[0], i + 1);
+            CHECK_VOID(status, FAIL, "VSseek");
+        }
+    }
+
+    status = VSgetblockinfo(vs[0], &block_size, NULL);
+    CHECK_VOID(status, FAIL, "VSgetblockinfo");
+    if (block_size <= HDF_APPENDABLE_BLOCK_LEN) {
+        num_errs++;
+        printf(">>> vdata appended to got blocks of %d bytes\n", (int)block_size);
+    }
+    status = VSgetblockinfo(vs[1], &block_size, NULL);
+    CHECK_VOID(status, FAIL, "VSgetblockinfo");
+    VERIFY_VOID(block_size, APPEND_BLK, "VSgetblockinfo");
+
+    for (k = 0; k < 2; k++) {
+        status = VSdetach(vs[k]);
+        CHECK_VOID(status, FAIL, "VSdetach");
+    }
+    status = Vend(fid);
+    CHECK_VOID(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+
+    /* Check every record */
+    fid = Hopen(APPEND_FILE, DFACC_READ, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK_VOID(status, FAIL, "Vstart");
+    for (k = 0; k < 2; k++) {
+        vs[k] = VSattach(fid, ref[k], "r");
+        CHECK_VOID(vs[k], FAIL, "VSattach");
+        VERIFY_VOID(VSelts(vs[k]), APPEND_NREC, "VSelts");
+        status = VSsetfields(vs[k], "Pair");
+        CHECK_VOID(status, FAIL, "VSsetfields");
+        for (i = 0; i < APPEND_NREC; i++) {
+            status = VSread(vs[k], (uint8 *)rec, 1, FULL_INTERLACE);
+            VERIFY_VOID(status, 1, "VSread");
+            if (rec[0] != i || rec[1] != k * APPEND_NREC + i) {
+                num_errs++;
+                printf(">>> record %d of vdata %d is %d %d\n", (int)i, (int)k, (int)rec[0], (int)rec[1]);
+                break;
+            }
+        }
+        status = VSdetach(vs[k]);
+        CHECK_VOID(status, FAIL, "VSdetach");
+    }
+    status = Vend(fid);
+    CHECK_VOID(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+} /* test_appendbuffer */
+
+/*************************** test_vsindex ***************************
+
+This test routine selects records of a vdata by the value of a field,
+first by reading the whole field, then through indexes of two fields,
+and compares what is selected with what a look at every record gives.
+Records appended after an index was built are still selected, and the
+indexes are kept in the file, hidden from the vdatas listed, and deleted
+with their vdata.
+
+***********************************************************************/
+
+#define INDEX_FILE "tvsindex.hdf"
+#define INDEX_NREC 20000
+#define INDEX_MORE 500 /* records appended once the index is built */
+
+/* Check what VSselect gives for one range against the values of every record */
+static void
+check_select(int32 vs, const char *field, const float64 *values, int32 nrecs, float64 lo, float64 hi,
+             int32 maxrecs)
+{
+    static int32 recnums[INDEX_NREC + INDEX_MORE];
+    int32        count = 0;
+    int32        ret;
+    int32        i;
+
+    ret = VSselect(vs, field, lo, hi, recnums, maxrecs);
+    CHECK_VOID(ret, FAIL, "VSselect");
+    for (i = 0; i < nrecs; i++)
+        if (values[i] >= lo && values[i] <= hi) {
+            if (count < maxrecs && count < ret && recnums[count] != i) {
+                num_errs++;
+                printf(">>> VSselect on %s in [%g, %g]: record %d is %d, not %d\n", field, lo, hi,
+                       (int)count, (int)recnums[count], (int)i);
+                return;
+            }
+            count++;
+        }
+    VERIFY_VOID(ret, count, "VSselect");
+} /* check_select */
+
+/* Write records 'from' to 'to' of the Time and Id fields, one at a time */
+static void
+write_index_recs(int32 vs, const float64 *times, const float64 *ids, int32 from, int32 to)
+{
+    uint8 buf[sizeof(float64) + sizeof(int16)];
+    int16 id;
+    int32 status;
+    int32 i;
+
+    for (i = from; i < to; i++) {
+        id = (int16)ids[i];
+        memcpy(buf, &times[i], sizeof(float64));
+        memcpy(buf + sizeof(float64), &id, sizeof(int16));
+        status = VSwrite(vs, buf, 1, FULL_INTERLACE);
+        VERIFY_VOID(status, 1, "VSwrite");
+    }
+} /* write_index_recs */
+
+static void
+test_vsindex(void)
+{
+    static float64 times[INDEX_NREC + INDEX_MORE];
+    static float64 ids[INDEX_NREC + INDEX_MORE];
+    uint8          buf[sizeof(float64) + sizeof(int16)];
+    char           iname[VSNAMELENMAX + 1];
+    int32          fid, vs, ref, iref;
+    int32          nvds;
+    int32          i, k;
+    int32          status;
+
+    MESSAGE(5, printf("Testing VSbuildindex and VSselect\n"););
+
+    fid = Hopen(INDEX_FILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK_VOID(status, FAIL, "Vstart");
+
+    /* Times out of order, and many records with the same id */
+    vs = VSattach(fid, -1, "w");
+    CHECK_VOID(vs, FAIL, "VSattach");
+    ref    = VSQueryref(vs);
+    status = VSfdefine(vs, "Time", DFNT_FLOAT64, 1);
+    CHECK_VOID(status, FAIL, "VSfdefine");
+    status = VSfdefine(vs, "Id", DFNT_INT16, 1);
+    CHECK_VOID(status, FAIL, "VSfdefine");
+    status = VSfdefine(vs, "Pos", DFNT_FLOAT32, 3);
+    CHECK_VOID(status, FAIL, "VSfdefine");
+    status = VSsetfields(vs, "Time,Id");
+    CHECK_VOID(status, FAIL, "VSsetfields");
+    for (i = 0; i < INDEX_NREC + INDEX_MORE; i++) {
+        times[i] = (float64)((i * 7919) % (INDEX_NREC + INDEX_MORE)) * 0.25;
+        ids[i]   = (float64)(i % 97 - 48);
+    }
+    write_index_recs(vs, times, ids, 0, INDEX_NREC);
+    status = VSdetach(vs);
+    CHECK_VOID(status, FAIL, "VSdetach");
+
+    vs = VSattach(fid, ref, "r");
+    CHECK_VOID(vs, FAIL, "VSattach");
+
+    /* Without an index */
+    check_select(vs, "Time", times, INDEX_NREC, 100.0, 200.0, INDEX_NREC);
+    check_select(vs, "Id", ids, INDEX_NREC, -3.0, 2.5, INDEX_NREC);
+
+    /* Fields that cannot be selected on, and bad ranges */
+    status = VSbuildindex(vs, "Pos");
+    VERIFY_VOID(status, FAIL, "VSbuildindex");
+    status = VSbuildindex(vs, "Nothing");
+    VERIFY_VOID(status, FAIL, "VSbuildindex");
+    status = VSselect(vs, "Pos", 0.0, 1.0, NULL, 0);
+    VERIFY_VOID(status, FAIL, "VSselect");
+    status = VSselect(vs, "Time", 0.0, 1.0, NULL, 10);
+    VERIFY_VOID(status, FAIL, "VSselect");
+    status = VSselect(vs, "Time", 10.0, 1.0, NULL, 0);
+    VERIFY_VOID(status, 0, "VSselect");
+
+    /* With the indexes */
+    status = VSbuildindex(vs, "Time");
+    CHECK_VOID(status, FAIL, "VSbuildindex");
+    status = VSbuildindex(vs, "Id");
+    CHECK_VOID(status, FAIL, "VSbuildindex");
+    status = VSbuildindex(vs, "Id"); /* replaces the first one */
+    CHECK_VOID(status, FAIL, "VSbuildindex");
+
+    check_select(vs, "Time", times, INDEX_NREC, 100.0, 200.0, INDEX_NREC);
+    check_select(vs, "Time", times, INDEX_NREC, 100.1, 100.2, INDEX_NREC);
+    check_select(vs, "Time", times, INDEX_NREC, -1e10, 1e10, INDEX_NREC);
+    check_select(vs, "Time", times, INDEX_NREC, 1e10, 2e10, INDEX_NREC);
+    check_select(vs, "Time", times, INDEX_NREC, 0.0, 1000.0, 100);
+    check_select(vs, "Id", ids, INDEX_NREC, -3.0, 2.5, INDEX_NREC);
+    check_select(vs, "Id", ids, INDEX_NREC, 48.0, 48.0, INDEX_NREC);
+    check_select(vs, "Id", ids, INDEX_NREC, 0.0, 0.0, 10);
+    status = VSselect(vs, "Id", -48.0, -48.0, NULL, 0);
+    VERIFY_VOID(status, (INDEX_NREC + 96) / 97, "VSselect");
+
+    status = VSdetach(vs);
+    CHECK_VOID(status, FAIL, "VSdetach");
+
+    /* The indexes are not user vdatas, and are found by name */
+    nvds = VSgetvdatas(fid, 0, 0, NULL);
+    VERIFY_VOID(nvds, 1, "VSgetvdatas");
+    snprintf(iname, sizeof(iname), "%s%d.Time", _HDF_VSINDEX_CLASS, (int)ref);
+    iref = VSfind(fid, iname);
+    CHECK_VOID(iref, 0, "VSfind");
+    VERIFY_VOID((iref != ref), TRUE, "VSfind");
+
+    /* Records appended later are selected too */
+    vs = VSattach(fid, ref, "w");
+    CHECK_VOID(vs, FAIL, "VSattach");
+    status = VSsetfields(vs, "Time,Id");
+    CHECK_VOID(status, FAIL, "VSsetfields");
+    status = VSseek(vs, INDEX_NREC - 1);
+    CHECK_VOID(status, FAIL, "VSseek");
+    status = VSread(vs, buf, 1, FULL_INTERLACE);
+    VERIFY_VOID(status, 1, "VSread");
+    write_index_recs(vs, times, ids, INDEX_NREC, INDEX_NREC + INDEX_MORE);
+    check_select(vs, "Time", times, INDEX_NREC + INDEX_MORE, 100.0, 200.0, INDEX_NREC);
+    status = VSbuildindex(vs, "Time");
+    CHECK_VOID(status, FAIL, "VSbuildindex");
+    check_select(vs, "Time", times, INDEX_NREC + INDEX_MORE, 100.0, 200.0, INDEX_NREC);
+    status = VSdetach(vs);
+    CHECK_VOID(status, FAIL, "VSdetach");
+
+    status = Vend(fid);
+    CHECK_VOID(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+
+    /* The indexes are in the file */
+    fid = Hopen(INDEX_FILE, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK_VOID(status, FAIL, "Vstart");
+    VERIFY_VOID(Hnumber(fid, DFTAG_VH), 3, "Hnumber");
+
+    vs = VSattach(fid, ref, "r");
+    CHECK_VOID(vs, FAIL, "VSattach");
+    for (k = 0; k < 4; k++)
+        check_select(vs, "Time", times, INDEX_NREC + INDEX_MORE, k * 1000.0, k * 1000.0 + 10.0, INDEX_NREC);
+    check_select(vs, "Id", ids, INDEX_NREC + INDEX_MORE, 10.0, 11.0, INDEX_NREC); /* stale index */
+    status = VSdetach(vs);
+    CHECK_VOID(status, FAIL, "VSdetach");
+
+    /* Writing over a record drops the indexes, which would miss it */
+    vs = VSattach(fid, ref, "w");
+    CHECK_VOID(vs, FAIL, "VSattach");
+    status = VSsetfields(vs, "Time,Id");
+    CHECK_VOID(status, FAIL, "VSsetfields");
+    status = VSseek(vs, 7);
+    CHECK_VOID(status, FAIL, "VSseek");
+    times[7] = -5.0;
+    write_index_recs(vs, times, ids, 7, 8);
+    VERIFY_VOID(Hnumber(fid, DFTAG_VH), 1, "Hnumber");
+    status = VSselect(vs, "Time", -10.0, -1.0, NULL, 0);
+    VERIFY_VOID(status, 1, "VSselect");
+    check_select(vs, "Time", times, INDEX_NREC + INDEX_MORE, -10.0, 10.0, INDEX_NREC);
+    status = VSbuildindex(vs, "Time");
+    CHECK_VOID(status, FAIL, "VSbuildindex");
+    check_select(vs, "Time", times, INDEX_NREC + INDEX_MORE, -10.0, 10.0, INDEX_NREC);
+    status = VSdetach(vs);
+    CHECK_VOID(status, FAIL, "VSdetach");
+
+    /* and go with their vdata */
+    status = VSdelete(fid, ref);
+    CHECK_VOID(status, FAIL, "VSdelete");
+    VERIFY_VOID(Hnumber(fid, DFTAG_VH), 0, "Hnumber");
+
+    status = Vend(fid);
+    CHECK_VOID(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+} /* test_vsindex */
+
+/*************************** test_lazyheaders ***************************
+
+This test routine writes vdatas and a vgroup, then adds a vdata header
+that cannot be unpacked.  The headers are only read when the vdatas are
+first used, so the file still opens, the other vdatas and the vgroup
+can be found, read and deleted, and only attaching the damaged vdata
+fails.
+
+***********************************************************************/
+
+#define LAZY_FILE "tvslazy.hdf"
+#define LAZY_NVS  10
+
+static void
+test_lazyheaders(void)
+{
+    char   name[VSNAMELENMAX + 1];
+    uint8  bad[16];
+    uint8 *p;
+    int32  fid, vs, vg;
+    int32  refs[LAZY_NVS];
+    int32  vgref, badref;
+    int32  data[4], back[4];
+    int32  status;
+    int32  i;
+
+    fid = Hopen(LAZY_FILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK_VOID(status, FAIL, "Vstart");
+
+    vg = Vattach(fid, -1, "w");
+    CHECK_VOID(vg, FAIL, "Vattach");
+    status = Vsetname(vg, "Lazy group");
+    CHECK_VOID(status, FAIL, "Vsetname");
+    for (i = 0; i < LAZY_NVS; i++) {
+        data[0] = data[1] = data[2] = data[3] = i;
+        snprintf(name, sizeof(name), "Lazy %d", (int)i);
+        refs[i] = VHstoredata(fid, "Values", (const uint8 *)data, 4, DFNT_INT32, name, "Lazy");
+        CHECK_VOID(refs[i], FAIL, "VHstoredata");
+        status = Vaddtagref(vg, DFTAG_VH, refs[i]);
+        CHECK_VOID(status, FAIL, "Vaddtagref");
+    }
+    vgref  = VQueryref(vg);
+    status = Vdetach(vg);
+    CHECK_VOID(status, FAIL, "Vdetach");
+
+    /* A version 3 header with a negative number of fields */
+    memset(bad, 0, sizeof(bad));
+    p = &bad[8];
+    INT16ENCODE(p, -1);
+    p = &bad[sizeof(bad) - 5];
+    UINT16ENCODE(p, 3);
+    badref = Hnewref(fid);
+    status = Hputelement(fid, DFTAG_VH, (uint16)badref, bad, (int32)sizeof(bad));
+    CHECK_VOID(status, FAIL, "Hputelement");
+
+    status = Vend(fid);
+    CHECK_VOID(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+
+    fid = Hopen(LAZY_FILE, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK_VOID(status, FAIL, "Vstart");
+
+    VERIFY_VOID(VSfind(fid, "Lazy 7"), refs[7], "VSfind");
+    vs = VSattach(fid, refs[LAZY_NVS - 1], "r");
+    CHECK_VOID(vs, FAIL, "VSattach");
+    VERIFY_VOID(VSelts(vs), 4, "VSelts");
+    status = VSsetfields(vs, "Values");
+    CHECK_VOID(status, FAIL, "VSsetfields");
+    status = VSread(vs, (uint8 *)back, 4, FULL_INTERLACE);
+    VERIFY_VOID(status, 4, "VSread");
+    VERIFY_VOID(back[3], LAZY_NVS - 1, "VSread");
+    status = VSdetach(vs);
+    CHECK_VOID(status, FAIL, "VSdetach");
+
+    vs = VSattach(fid, badref, "r");
+    VERIFY_VOID(vs, FAIL, "VSattach");
+
+    vg = Vattach(fid, vgref, "r");
+    CHECK_VOID(vg, FAIL, "Vattach");
+    VERIFY_VOID(Vntagrefs(vg), LAZY_NVS, "Vntagrefs");
+    status = Vgetname(vg, name);
+    CHECK_VOID(status, FAIL, "Vgetname");
+    VERIFY_CHAR_VOID(name, "Lazy group", "Vgetname");
+    status = Vdetach(vg);
+    CHECK_VOID(status, FAIL, "Vdetach");
+
+    /* Vdatas never looked at can be deleted */
+    status = VSdelete(fid, refs[0]);
+    CHECK_VOID(status, FAIL, "VSdelete");
+    VERIFY_VOID(VSfind(fid, "Lazy 0"), 0, "VSfind");
+    VERIFY_VOID(VSfind(fid, "Lazy 1"), refs[1], "VSfind");
+
+    status = Vend(fid);
+    CHECK_VOID(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+} /* test_lazyheaders */
+
+/*************************** test_findnames ***************************
+
+This test routine looks up vgroups and vdatas by name and class, after
+the names change and vgroups and vdatas are added and deleted, and
+several names at once with Vfindmany and VSfindmany.  Of those with the
+same name, the one with the lowest ref is found.
+
+***********************************************************************/
+
+#define FIND_FILE "tvsfind.hdf"
+#define FIND_NVS  50
+
+static void
+test_findnames(void)
+{
+    const char *names[3];
+    char        name[VSNAMELENMAX + 1];
+    int32       fid, vs, vg;
+    int32       refs[FIND_NVS];
+    int32       found[3];
+    int32       vgref, vsref;
+    int32       data = 0;
+    int32       status;
+    int32       i;
+
+    fid = Hopen(FIND_FILE, DFACC_CREATE, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK_VOID(status, FAIL, "Vstart");
+
+    for (i = 0; i < FIND_NVS; i++) {
+        snprintf(name, sizeof(name), "Find %d", (int)i);
+        refs[i] = VHstoredata(fid, "Value", (const uint8 *)&data, 1, DFNT_INT32, name, "Find");
+        CHECK_VOID(refs[i], FAIL, "VHstoredata");
+    }
+    vg = Vattach(fid, -1, "w");
+    CHECK_VOID(vg, FAIL, "Vattach");
+    status = Vsetname(vg, "Find group");
+    CHECK_VOID(status, FAIL, "Vsetname");
+    status = Vsetclass(vg, "Find class");
+    CHECK_VOID(status, FAIL, "Vsetclass");
+    vgref  = VQueryref(vg);
+    status = Vdetach(vg);
+    CHECK_VOID(status, FAIL, "Vdetach");
+
+    status = Vend(fid);
+    CHECK_VOID(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+
+    fid = Hopen(FIND_FILE, DFACC_RDWR, 0);
+    CHECK_VOID(fid, FAIL, "Hopen");
+    status = Vstart(fid);
+    CHECK_VOID(status, FAIL, "Vstart");
+
+    VERIFY_VOID(VSfind(fid, "Find 17"), refs[17], "VSfind");
+    VERIFY_VOID(VSfind(fid, "Find"), 0, "VSfind");
+    VERIFY_VOID(VSfindclass(fid, "Find"), refs[0], "VSfindclass");
+    VERIFY_VOID(Vfind(fid, "Find group"), vgref, "Vfind");
+    VERIFY_VOID(Vfindclass(fid, "Find class"), vgref, "Vfindclass");
+    VERIFY_VOID(Vfind(fid, "Find 17"), 0, "Vfind");
+
+    /* A renamed vdata is found by its new name only */
+    vs = VSattach(fid, refs[17], "w");
+    CHECK_VOID(vs, FAIL, "VSattach");
+    status = VSsetname(vs, "Renamed");
+    CHECK_VOID(status, FAIL, "VSsetname");
+    status = VSdetach(vs);
+    CHECK_VOID(status, FAIL, "VSdetach");
+    VERIFY_VOID(VSfind(fid, "Find 17"), 0, "VSfind");
+    VERIFY_VOID(VSfind(fid, "Renamed"), refs[17], "VSfind");
+
+    /* Of two vdatas with the same name, the one with the lower ref is found */
+    vs = VSattach(fid, refs[30], "w");
+    CHECK_VOID(vs, FAIL, "VSattach");
+    status = VSsetname(vs, "Renamed");
+    CHECK_VOID(status, FAIL, "VSsetname");
+    status = VSdetach(vs);
+    CHECK_VOID(status, FAIL, "VSdetach");
+    VERIFY_VOID(VSfind(fid, "Renamed"), refs[17], "VSfind");
+    status = VSdelete(fid, refs[17]);
+    CHECK_VOID(status, FAIL, "VSdelete");
+    VERIFY_VOID(VSfind(fid, "Renamed"), refs[30], "VSfind");
+
+    /* A new vdata and a new vgroup are found */
+    vsref = VHstoredata(fid, "Value", (const uint8 *)&data, 1, DFNT_INT32, "New", "New class");
+    CHECK_VOID(vsref, FAIL, "VHstoredata");
+    VERIFY_VOID(VSfind(fid, "New"), vsref, "VSfind");
+    VERIFY_VOID(VSfindclass(fid, "New class"), vsref, "VSfindclass");
+    vg = Vattach(fid, -1, "w");
+    CHECK_VOID(vg, FAIL, "Vattach");
+    status = Vsetname(vg, "New group");
+    CHECK_VOID(status, FAIL, "Vsetname");
+    VERIFY_VOID(Vfind(fid, "New group"), VQueryref(vg), "Vfind");
+    status = Vdetach(vg);
+    CHECK_VOID(status, FAIL, "Vdetach");
+
+    /* A deleted vgroup is not found */
+    status = Vdelete(fid, vgref);
+    CHECK_VOID(status, FAIL, "Vdelete");
+    VERIFY_VOID(Vfind(fid, "Find group"), 0, "Vfind");
+    VERIFY_VOID(Vfindclass(fid, "Find class"), 0, "Vfindclass");
+
+    /* Several names at once */
+    names[0] = "Find 3";
+    names[1] = "Missing";
+    names[2] = "New";
+    status   = VSfindmany(fid, 3, names, found);
+    VERIFY_VOID(status, 2, "VSfindmany");
+    VERIFY_VOID(found[0], refs[3], "VSfindmany");
+    VERIFY_VOID(found[1], 0, "VSfindmany");
+    VERIFY_VOID(found[2], vsref, "VSfindmany");
+    names[0] = "New group";
+    status   = Vfindmany(fid, 2, names, found);
+    VERIFY_VOID(status, 1, "Vfindmany");
+    VERIFY_VOID(found[1], 0, "Vfindmany");
+    names[1] = NULL;
+    status   = Vfindmany(fid, 2, names, found);
+    VERIFY_VOID(status, FAIL, "Vfindmany");
+    status = VSfindmany(fid, -1, names, found);
+    VERIFY_VOID(status, FAIL, "VSfindmany");
+
+    status = Vend(fid);
+    CHECK_VOID(status, FAIL, "Vend");
+    status = Hclose(fid);
+    CHECK_VOID(status, FAIL, "Hclose");
+} /* test_findnames */
+
 /* main test driver */
 void
 test_vsets(void)
@@ -3361,6 +4075,21 @@ test_vsets(void)
 
     /* test_extfile - getting external file information */
     test_extfile();
+
+    /* test VSreadcolumns - reading fields into buffers of their own */
+    test_readcolumns();
+
+    /* test appending records one at a time */
+    test_appendbuffer();
+
+    /* test VSbuildindex and VSselect - selecting records by value */
+    test_vsindex();
+
+    /* test reading the headers of vdatas and vgroups on first use */
+    test_lazyheaders();
+
+    /* test Vfind, VSfind and the like, and Vfindmany and VSfindmany */
+    test_findnames();
 } /* test_vsets */
 
 /* TODO:
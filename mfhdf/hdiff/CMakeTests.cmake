@@ -35,6 +35,8 @@ if (HDF4_BUILD_GENERATORS AND NOT ONLY_SHARED_LIBS)
           hdifftst5.hdf
           hdifftst6.hdf
           hdifftst7.hdf
+          hdifftst8.hdf
+          hdifftst9.hdf
   )
   set (last_test "HDIFF-GEN-clearall-objects")
 
@@ -83,6 +85,8 @@ set (HDF4_REFERENCE_TEST_FILES
     hdifftst5.hdf
     hdifftst6.hdf
     hdifftst7.hdf
+    hdifftst8.hdf
+    hdifftst9.hdf
 )
 set (HDF4_REFERENCE_FILES
     hdiff_01.txt
@@ -100,6 +104,11 @@ set (HDF4_REFERENCE_FILES
     hdiff_13.txt
     hdiff_14.txt
     hdiff_15.txt
+    hdiff_16.txt
+    hdiff_17.txt
+    hdiff_18.txt
+    hdiff_19.txt
+    hdiff_20.txt
 )
 
 foreach (h4_file ${HDF4_REFERENCE_TEST_FILES} ${HDF4_REFERENCE_FILES})
@@ -138,6 +147,11 @@ add_test (
         hdiff_13.out
         hdiff_14.out
         hdiff_15.out
+        hdiff_16.out
+        hdiff_17.out
+        hdiff_18.out
+        hdiff_19.out
+        hdiff_20.out
         hdiff_01.out.err
         hdiff_02.out.err
         hdiff_03.out.err
@@ -153,6 +167,11 @@ add_test (
         hdiff_13.out.err
         hdiff_14.out.err
         hdiff_15.out.err
+        hdiff_16.out.err
+        hdiff_17.out.err
+        hdiff_18.out.err
+        hdiff_19.out.err
+        hdiff_20.out.err
 )
 if (NOT "${last_test}" STREQUAL "")
   set_tests_properties (HDIFF-clearall-objects PROPERTIES DEPENDS ${last_test} LABELS ${PROJECT_NAME})
@@ -198,10 +217,25 @@ ADD_H4_TEST (hdiff_11 1 hdifftst1.hdf hdifftst2.hdf)
 ADD_H4_TEST (hdiff_12 1 -d -p 0.05 -v dset3 hdifftst1.hdf hdifftst2.hdf)
 
 # hyperslab reading
-ADD_H4_TEST (hdiff_13 0 hdifftst3.hdf hdifftst4.hdf)
+ADD_H4_TEST (hdiff_13 1 hdifftst3.hdf hdifftst4.hdf)
 
 # lone dim
 ADD_H4_TEST (hdiff_14 1 hdifftst5.hdf hdifftst6.hdf)
 
 # group loop
 ADD_H4_TEST (hdiff_15 0 -b hdifftst7.hdf hdifftst7.hdf)
+
+# small blocks
+ADD_H4_TEST (hdiff_16 1 -M 4096 hdifftst3.hdf hdifftst4.hdf)
+
+# print difference up to count number over several blocks
+ADD_H4_TEST (hdiff_17 1 -d -e 2 -M 8 hdifftst1.hdf hdifftst2.hdf)
+
+# skip equal stored chunks, none in a block with changed chunks, and equal stored data
+ADD_H4_TEST (hdiff_18 1 -b -d -r hdifftst8.hdf hdifftst9.hdf)
+
+# skip equal stored chunks, by blocks of chunks
+ADD_H4_TEST (hdiff_19 1 -b -d -r -M 1600 hdifftst8.hdf hdifftst9.hdf)
+
+# skip equal stored chunks, all of them
+ADD_H4_TEST (hdiff_20 0 -b -d -r hdifftst8.hdf hdifftst8.hdf)
@@ -93,21 +93,26 @@
  * local prototypes
  *-------------------------------------------------------------------------
  */
-static void print_pos(int *ph, uint32 curr_pos, int32 *acc, int32 *pos, int rank, const char *obj1,
-                      const char *obj2);
+static void print_pos(int *ph, uint32 curr_pos, int32 *acc, int32 *pos, int32 *offset, int rank,
+                      const char *obj1, const char *obj2);
 
 /*-------------------------------------------------------------------------
  * Function: array_diff
  *
  * Purpose: compare the 2 buffers BUF1 and BUF2
  *
+ * Comments: the buffers hold a block of DIMS elements at OFFSET in the
+ *  objects, NULL for the origin. PH, if not NULL, says whether the header
+ *  of the differences is still to be printed; it is shared by the blocks
+ *  of an object.
+ *
  *-------------------------------------------------------------------------
  */
 
 uint32
 array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char *name2, int rank,
-           int32 *dims, int32 type, float32 err_limit, float32 err_rel, uint32 max_err_cnt, int32 statistics,
-           void *fill1, void *fill2)
+           int32 *dims, int32 *offset, int32 type, float32 err_limit, float32 err_rel, uint32 max_err_cnt,
+           int32 statistics, void *fill1, void *fill2, int *ph)
 
 {
     uint32   i;
@@ -132,13 +137,16 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
     FILE    *fp = NULL;
     int32    acc[H4_MAX_VAR_DIMS]; /* accumulator position */
     int32    pos[H4_MAX_VAR_DIMS]; /* matrix position */
-    int      ph = 1;               /* print header  */
+    int      ph_all = 1;           /* print header  */
     int      j;
     double   per;
     int      both_zero;
     int      not_comparable;
     uint32   n_diff = 0;
 
+    if (ph == NULL)
+        ph = &ph_all;
+
     acc[rank - 1] = 1;
     for (j = (rank - 2); j >= 0; j--) {
         acc[j] = acc[j + 1] * (int)dims[j + 1];
@@ -253,7 +261,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
 
                     if (not_comparable && !both_zero) /* not comparable */
                     {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(I8FORMATP_NOTCOMP, *i1ptr1, *i1ptr2);
                         n_diff++;
@@ -264,7 +272,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                         if ((float)per > err_rel) {
                         n_diff++;
                         if (n_diff <= max_err_cnt) {
-                            print_pos(&ph, i, acc, pos, rank, name1, name2);
+                            print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                             printf(SPACES);
                             printf(I8FORMATP, *i1ptr1, *i1ptr2, per * 100);
                         }
@@ -274,7 +282,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                 else if (c_diff > (int32)err_limit) {
                     n_diff++;
                     if (n_diff <= max_err_cnt) {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(I8FORMAT, *i1ptr1, *i1ptr2, abs(*i1ptr1 - *i1ptr2));
                     }
@@ -336,7 +344,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
 
                     if (not_comparable && !both_zero) /* not comparable */
                     {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(I16FORMATP_NOTCOMP, *i2ptr1, *i2ptr2);
                         n_diff++;
@@ -347,7 +355,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                         if ((float)per > err_rel) {
                         n_diff++;
                         if (n_diff <= max_err_cnt) {
-                            print_pos(&ph, i, acc, pos, rank, name1, name2);
+                            print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                             printf(SPACES);
                             printf(I16FORMATP, *i2ptr1, *i2ptr2, per * 100);
                         }
@@ -357,7 +365,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                 else if (i2_diff > (int)err_limit) {
                     n_diff++;
                     if (n_diff <= max_err_cnt) {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(I16FORMAT, *i2ptr1, *i2ptr2, abs(*i2ptr1 - *i2ptr2));
                     }
@@ -415,7 +423,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
 
                     if (not_comparable && !both_zero) /* not comparable */
                     {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(IFORMATP_NOTCOMP, *i4ptr1, *i4ptr2);
                         n_diff++;
@@ -426,7 +434,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                         if ((float)per > err_rel) {
                         n_diff++;
                         if (n_diff <= max_err_cnt) {
-                            print_pos(&ph, i, acc, pos, rank, name1, name2);
+                            print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                             printf(SPACES);
                             printf(IFORMATP, *i4ptr1, *i4ptr2, per * 100);
                         }
@@ -436,7 +444,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                 else if (i4_diff > (int32)err_limit) {
                     n_diff++;
                     if (n_diff <= max_err_cnt) {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(IFORMAT, *i4ptr1, *i4ptr2, i4_diff);
                     }
@@ -497,7 +505,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
 
                     if (not_comparable && !both_zero) /* not comparable */
                     {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(FFORMATP_NOTCOMP, (double)*fptr1, (double)*fptr2);
                         n_diff++;
@@ -508,7 +516,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                         if ((float)per > err_rel) {
                         n_diff++;
                         if (n_diff <= max_err_cnt) {
-                            print_pos(&ph, i, acc, pos, rank, name1, name2);
+                            print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                             printf(SPACES);
                             printf(FFORMATP, (double)*fptr1, (double)*fptr2, per * 100);
                         }
@@ -518,7 +526,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                 else if (f_diff > err_limit) {
                     n_diff++;
                     if (n_diff <= max_err_cnt) {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(FFORMAT, (double)*fptr1, (double)*fptr2, fabs(*fptr1 - *fptr2));
                     }
@@ -575,7 +583,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
 
                     if (not_comparable && !both_zero) /* not comparable */
                     {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(FFORMATP_NOTCOMP, *dptr1, *dptr2);
                         n_diff++;
@@ -586,7 +594,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                         if ((float)per > err_rel) {
                         n_diff++;
                         if (n_diff <= max_err_cnt) {
-                            print_pos(&ph, i, acc, pos, rank, name1, name2);
+                            print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                             printf(SPACES);
                             printf(FFORMATP, *dptr1, *dptr2, per * 100);
                         }
@@ -596,7 +604,7 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
                 else if (d_diff > (float64)err_limit) {
                     n_diff++;
                     if (n_diff <= max_err_cnt) {
-                        print_pos(&ph, i, acc, pos, rank, name1, name2);
+                        print_pos(ph, i, acc, pos, offset, rank, name1, name2);
                         printf(SPACES);
                         printf(FFORMAT, *dptr1, *dptr2, fabs(*dptr1 - *dptr2));
                     }
@@ -649,7 +657,8 @@ array_diff(void *buf1, void *buf2, uint32 tot_cnt, const char *name1, const char
  *-------------------------------------------------------------------------
  */
 static void
-print_pos(int *ph, uint32 curr_pos, int32 *acc, int32 *pos, int rank, const char *obj1, const char *obj2)
+print_pos(int *ph, uint32 curr_pos, int32 *acc, int32 *pos, int32 *offset, int rank, const char *obj1,
+          const char *obj2)
 {
     int i;
 
@@ -669,7 +678,7 @@ print_pos(int *ph, uint32 curr_pos, int32 *acc, int32 *pos, int rank, const char
 
     printf("[ ");
     for (i = 0; i < rank; i++) {
-        fprintf(stdout, "%d ", pos[i]);
+        fprintf(stdout, "%d ", pos[i] + (offset != NULL ? offset[i] : 0));
     }
     printf("]");
 }
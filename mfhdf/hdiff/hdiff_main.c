@@ -46,7 +46,7 @@ usage()
 {
 
     fprintf(stdout, "hdiff [-V] [-b] [-g] [-s] [-d] [-D] [-S] [-v var1[,...]] [-u var1[,...]] [-e "
-                    "count] [-t limit] [-p relative] file1 file2\n");
+                    "count] [-t limit] [-p relative] [-M size] [-r] file1 file2\n");
     fprintf(stdout, "  [-V]              Display version of the HDF4 library and exit\n");
     fprintf(stdout, "  [-b]              Verbose mode\n");
     fprintf(stdout, "  [-g]              Compare global attributes only\n");
@@ -59,11 +59,16 @@ usage()
     fprintf(stdout, "  [-e count]        Print difference up to count number for each variable\n");
     fprintf(stdout, "  [-t limit]        Print difference when it is greater than limit\n");
     fprintf(stdout, "  [-p relative]     Print difference when it is greater than a relative limit\n");
+    fprintf(stdout, "  [-M size]         Read SD data up to size bytes at a time (default 1048576);\n");
+    fprintf(stdout, "                    with -r, a block is skipped only when all of its stored\n");
+    fprintf(stdout, "                    chunks are equal; one changed chunk decodes the whole block\n");
+    fprintf(stdout, "  [-r]              Skip SD data whose stored bytes are equal\n");
     fprintf(stdout, "  file1             File name of the first HDF file\n");
     fprintf(stdout, "  file2             File name of the second HDF file\n");
     fprintf(stdout, "\n");
     fprintf(stdout, "The 'count' value must be a positive integer\n");
     fprintf(stdout, "The 'limit' and 'relative' values must be positive numbers\n");
+    fprintf(stdout, "The 'size' value must be a positive integer\n");
     fprintf(stdout, "The -t compare criteria is |a - b| > limit\n");
     fprintf(stdout, "The -p compare criteria is |(b-a)/a| > relative\n");
     fprintf(stdout, "Return codes: 0 (no differences found), 1 (differences found)\n");
@@ -75,21 +80,23 @@ main(int argc, char *argv[])
 {
     static diff_opt_t opt = /* defaults, overridden on command line */
         {
-            0,        /* verbose mode */
-            1,        /* compare global attributes */
-            1,        /* compare SD local attributes */
-            1,        /* compare SD data */
-            1,        /* compare GR data */
-            1,        /* compare Vdata */
-            MAX_DIFF, /* no limit on the difference to be printed */
-            0.0,      /* exact equal */
-            0,        /* if -v specified, number of variables */
-            0,        /* if -v specified, list of variable names */
-            0,        /* if -u specified, number of variables */
-            0,        /* if -u specified, list of variable names */
-            0,        /* if -S specified print statistics */
-            0,        /* -p err_rel */
-            0,        /* error status */
+            0,         /* verbose mode */
+            1,         /* compare global attributes */
+            1,         /* compare SD local attributes */
+            1,         /* compare SD data */
+            1,         /* compare GR data */
+            1,         /* compare Vdata */
+            MAX_DIFF,  /* no limit on the difference to be printed */
+            0.0,       /* exact equal */
+            0,         /* if -v specified, number of variables */
+            0,         /* if -v specified, list of variable names */
+            0,         /* if -u specified, number of variables */
+            0,         /* if -u specified, list of variable names */
+            0,         /* if -S specified print statistics */
+            0,         /* -p err_rel */
+            0,         /* error status */
+            MAX_BLOCK, /* bytes of SD data read at a time */
+            0,         /* if -r specified, skip equal stored chunks */
         };
     int    c;
     uint32 nfound;
@@ -101,7 +108,7 @@ main(int argc, char *argv[])
     if (argc < 2)
         usage();
 
-    while ((c = h4getopt(argc, argv, "VbgsdSDe:t:v:u:p:")) != EOF) {
+    while ((c = h4getopt(argc, argv, "VbgsdSDe:t:v:u:p:M:r")) != EOF) {
         switch (c) {
             case 'V': /* display version of the library */
                 printf("%s, %s\n\n", argv[0], LIBVER_STRING);
@@ -153,6 +160,14 @@ main(int argc, char *argv[])
             case 'p':
                 opt.err_rel = (float32)atof(h4optarg);
                 break;
+            case 'M': /* bytes of SD data read at a time */
+                if (atoi(h4optarg) <= 0)
+                    usage();
+                opt.max_block = (uint32)atoi(h4optarg);
+                break;
+            case 'r': /* skip equal stored chunks */
+                opt.raw = 1;
+                break;
         }
     }
 
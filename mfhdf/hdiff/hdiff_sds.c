@@ -11,7 +11,7 @@
  * help@hdfgroup.org.                                                        *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
-#include <assert.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -19,12 +19,303 @@
 #include "hdiff_list.h"
 #include "hdiff_mattbl.h"
 
-#define H4TOOLS_BUFSIZE    (1024 * 1024)
-#define H4TOOLS_MALLOCSIZE (1024 * 1024)
+/* A block of the two SDSs, read in the background */
+typedef struct {
+    int32  start[H4_MAX_VAR_DIMS]; /* offset of the block */
+    int32  edges[H4_MAX_VAR_DIMS]; /* size of the block */
+    uint32 nelms;                  /* number of elements */
+    void  *buf1;                   /* values of SDS 1 */
+    void  *buf2;                   /* values of SDS 2 */
+    int    status1;                /* status of the read of SDS 1 */
+    int    status2;                /* status of the read of SDS 2 */
+    int    same;                   /* the stored chunks of the block are equal */
+} sds_block_t;
+
+/* The stored data of the two SDSs, compared before they are decoded */
+typedef struct {
+    int   chunked;                        /* the SDSs are chunked */
+    int32 chunk_lengths[H4_MAX_VAR_DIMS]; /* chunk lengths of both SDSs */
+    int   fill_same;                      /* the fill values are equal */
+    int   data_same;                      /* the SDSs are not chunked and their stored data are equal */
+    void *raw1;                           /* stored bytes of a chunk of SDS 1 */
+    void *raw2;                           /* stored bytes of a chunk of SDS 2 */
+    int32 raw_size;                       /* size of raw1 and raw2 */
+} sds_raw_t;
+
+/* stored bytes of SDSs that are not chunked compared at a time */
+#define RAW_PIECE (1024 * 1024)
 
 static uint32 diff_sds_attrs(int32 sds1_id, int32 nattrs1, int32 sds2_id, int32 nattrs2, char *sds1_name,
                              diff_opt_t *opt);
 
+/*-------------------------------------------------------------------------
+ * Function: read_done
+ *
+ * Purpose: record the status of the read of a block
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static void
+read_done(int32 id, int status, void *ctx)
+{
+    (void)id;
+    *(int *)ctx = status;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: same_storage
+ *
+ * Purpose: check that two SDSs of the same number type and dimensions are
+ *  chunked and compressed the same way, so that equal stored chunks or
+ *  data hold equal values
+ *
+ * Return: 1 if they are, 0 otherwise
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+same_storage(int32 sds1_id, int32 sds2_id)
+{
+    HDF_CHUNK_DEF chunk_def1, chunk_def2; /* chunking of the SDSs */
+    int32         flags1, flags2;
+    comp_coder_t  comp_type1, comp_type2; /* compression of the SDSs */
+    comp_info     c_info1, c_info2;
+
+    memset(&chunk_def1, 0, sizeof(chunk_def1));
+    memset(&chunk_def2, 0, sizeof(chunk_def2));
+    if (SDgetchunkinfo(sds1_id, &chunk_def1, &flags1) == FAIL ||
+        SDgetchunkinfo(sds2_id, &chunk_def2, &flags2) == FAIL)
+        return 0;
+    if (flags1 != flags2)
+        return 0;
+    if ((flags1 & HDF_CHUNK) && memcmp(&chunk_def1, &chunk_def2, sizeof(chunk_def1)) != 0)
+        return 0;
+
+    memset(&c_info1, 0, sizeof(c_info1));
+    memset(&c_info2, 0, sizeof(c_info2));
+    if (SDgetcompinfo(sds1_id, &comp_type1, &c_info1) == FAIL ||
+        SDgetcompinfo(sds2_id, &comp_type2, &c_info2) == FAIL)
+        return 0;
+
+    return comp_type1 == comp_type2 && memcmp(&c_info1, &c_info2, sizeof(c_info1)) == 0;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: same_data
+ *
+ * Purpose: compare the stored data of two SDSs that are not chunked, as
+ *  located by SDgetdatainfo, reading them from the files of SD1_ID and
+ *  SD2_ID
+ *
+ * Return: 1 if they are equal, 0 otherwise or if they could not be read
+ *
+ * Comments: the data of external SDSs are not compared. Data never
+ *  written, or not written in full, are equal if the fill values are
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+same_data(int32 sd1_id, int32 sd2_id, int32 sds1_id, int32 sds2_id, sds_raw_t *raw)
+{
+    int32  sd_id[2];                 /* files of the SDSs */
+    int32  sds_id[2];                /* the SDSs */
+    FILE  *fp[2]     = {NULL, NULL}; /* the files, opened to read the stored data */
+    char  *file_name = NULL;
+    int32 *offsets   = NULL; /* offsets of the stored blocks of SDS 1, then of SDS 2 */
+    int32 *lengths   = NULL; /* lengths of the stored blocks of SDS 1, then of SDS 2 */
+    int    nstored   = 0;    /* number of stored blocks of each SDS */
+    int32  done, size;
+    int    len, n, k, i;
+    int    ret = 0;
+
+    if (!raw->fill_same)
+        return 0;
+
+    sd_id[0]  = sd1_id;
+    sd_id[1]  = sd2_id;
+    sds_id[0] = sds1_id;
+    sds_id[1] = sds2_id;
+    for (k = 0; k < 2; k++) {
+        if (SDgetexternalinfo(sds_id[k], 0, NULL, NULL, NULL) != 0)
+            return 0;
+        if ((n = SDgetdatainfo(sds_id[k], NULL, 0, 0, NULL, NULL)) == FAIL || (k > 0 && n != nstored))
+            return 0;
+        nstored = n;
+    }
+    if (nstored == 0)
+        return 1;
+
+    offsets = (int32 *)malloc(2 * (size_t)nstored * sizeof(int32));
+    lengths = (int32 *)malloc(2 * (size_t)nstored * sizeof(int32));
+    if (offsets == NULL || lengths == NULL)
+        goto out;
+    for (k = 0; k < 2; k++)
+        if (SDgetdatainfo(sds_id[k], NULL, 0, (unsigned)nstored, offsets + k * nstored,
+                          lengths + k * nstored) != nstored)
+            goto out;
+    if (memcmp(lengths, lengths + nstored, (size_t)nstored * sizeof(int32)) != 0)
+        goto out;
+
+    for (k = 0; k < 2; k++) {
+        if ((len = SDgetfilename(sd_id[k], NULL)) == FAIL ||
+            (file_name = (char *)malloc((size_t)len + 1)) == NULL)
+            goto out;
+        if (SDgetfilename(sd_id[k], file_name) == FAIL)
+            goto out;
+        fp[k] = fopen(file_name, "rb");
+        free(file_name);
+        file_name = NULL;
+        if (fp[k] == NULL)
+            goto out;
+    }
+
+    if (raw->raw_size < RAW_PIECE) {
+        free(raw->raw1);
+        free(raw->raw2);
+        raw->raw1     = malloc(RAW_PIECE);
+        raw->raw2     = malloc(RAW_PIECE);
+        raw->raw_size = RAW_PIECE;
+        if (raw->raw1 == NULL || raw->raw2 == NULL) {
+            raw->raw_size = 0;
+            goto out;
+        }
+    }
+
+    for (i = 0; i < nstored; i++)
+        for (done = 0; done < lengths[i]; done += size) {
+            size = MIN(lengths[i] - done, raw->raw_size);
+            if (fseek(fp[0], (long)offsets[i] + done, SEEK_SET) != 0 ||
+                fseek(fp[1], (long)offsets[nstored + i] + done, SEEK_SET) != 0 ||
+                fread(raw->raw1, 1, (size_t)size, fp[0]) != (size_t)size ||
+                fread(raw->raw2, 1, (size_t)size, fp[1]) != (size_t)size ||
+                memcmp(raw->raw1, raw->raw2, (size_t)size) != 0)
+                goto out;
+        }
+    ret = 1;
+
+out:
+    for (k = 0; k < 2; k++)
+        if (fp[k] != NULL)
+            fclose(fp[k]);
+    free(file_name);
+    free(offsets);
+    free(lengths);
+
+    return ret;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: same_chunks
+ *
+ * Purpose: compare the stored chunks of both SDSs in the block BLK
+ *
+ * Return: 1 if they are all equal, 0 otherwise or if a chunk could not
+ *  be read
+ *
+ * Comments: chunks never written are equal if the fill values are
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+same_chunks(int32 sds1_id, int32 sds2_id, int32 rank, sds_block_t *blk, sds_raw_t *raw)
+{
+    int32 first[H4_MAX_VAR_DIMS];  /* first chunk of the block, in chunks */
+    int32 last[H4_MAX_VAR_DIMS];   /* last chunk of the block, in chunks */
+    int32 origin[H4_MAX_VAR_DIMS]; /* chunk compared, in chunks */
+    int32 size1, size2;            /* stored sizes of the chunk */
+    int   i;
+
+    for (i = 0; i < rank; i++) {
+        first[i] = origin[i] = blk->start[i] / raw->chunk_lengths[i];
+        last[i]               = (blk->start[i] + blk->edges[i] - 1) / raw->chunk_lengths[i];
+    }
+
+    for (;;) {
+        if ((size1 = SDreadchunk_raw(sds1_id, origin, NULL, NULL, 0, NULL)) == FAIL ||
+            (size2 = SDreadchunk_raw(sds2_id, origin, NULL, NULL, 0, NULL)) == FAIL || size1 != size2)
+            return 0;
+
+        if (size1 == 0) {
+            if (!raw->fill_same)
+                return 0;
+        }
+        else {
+            if (size1 > raw->raw_size) {
+                free(raw->raw1);
+                free(raw->raw2);
+                raw->raw1     = malloc((size_t)size1);
+                raw->raw2     = malloc((size_t)size1);
+                raw->raw_size = size1;
+                if (raw->raw1 == NULL || raw->raw2 == NULL) {
+                    raw->raw_size = 0;
+                    return 0;
+                }
+            }
+            if (SDreadchunk_raw(sds1_id, origin, NULL, NULL, size1, raw->raw1) == FAIL ||
+                SDreadchunk_raw(sds2_id, origin, NULL, NULL, size2, raw->raw2) == FAIL ||
+                memcmp(raw->raw1, raw->raw2, (size_t)size1) != 0)
+                return 0;
+        }
+
+        /* next chunk of the block */
+        for (i = rank; i > 0; --i) {
+            if (++origin[i - 1] <= last[i - 1])
+                break;
+            origin[i - 1] = first[i - 1];
+        }
+        if (i == 0)
+            return 1;
+    }
+}
+
+/*-------------------------------------------------------------------------
+ * Function: read_block
+ *
+ * Purpose: start reading the block of at most SM_SIZE elements at OFFSET
+ *  of both SDSs into BLK
+ *
+ * Return: SUCCEED, or FAIL if a read could not be started
+ *
+ * Comments: the statuses of the reads are in BLK after Hasyncwait. With
+ *  RAW not NULL, the block is not read if its stored chunks, or the
+ *  stored data of the SDSs, are equal
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+read_block(int32 sds1_id, int32 sds2_id, int32 rank, int32 *dimsizes, int32 *offset, int32 *sm_size,
+           sds_raw_t *raw, sds_block_t *blk)
+{
+    int i;
+
+    blk->nelms = 1;
+    for (i = 0; i < rank; i++) {
+        blk->start[i] = offset[i];
+        blk->edges[i] = MIN(dimsizes[i] - offset[i], sm_size[i]);
+        blk->nelms *= (uint32)blk->edges[i];
+    }
+
+    blk->same =
+        (raw != NULL && (raw->chunked ? same_chunks(sds1_id, sds2_id, rank, blk, raw) : raw->data_same));
+    if (blk->same) {
+        blk->status1 = blk->status2 = SUCCEED;
+        return SUCCEED;
+    }
+
+    blk->status1 = blk->status2 = FAIL;
+    if (SDreaddata_async(sds1_id, blk->start, NULL, blk->edges, blk->buf1, read_done, &blk->status1) == FAIL)
+        return FAIL;
+    if (SDreaddata_async(sds2_id, blk->start, NULL, blk->edges, blk->buf2, read_done, &blk->status2) == FAIL)
+        return FAIL;
+
+    return SUCCEED;
+}
+
 /*-------------------------------------------------------------------------
  * Function: diff_sds
  *
@@ -54,26 +345,39 @@ diff_sds(int32 sd1_id, int32 sd2_id, int32 ref1, int32 ref2, diff_opt_t *opt)
         dimsizes2[H4_MAX_VAR_DIMS], /* dimensional size of SDS */
         nattrs2,                    /* number of SDS attributes */
         rank2,                      /* rank of SDS */
-        start[H4_MAX_VAR_DIMS],     /* read start */
-        edges[H4_MAX_VAR_DIMS],     /* read edges */
         numtype,                    /* number type */
-        eltsz;                      /* element size */
-    uint32 nelms;                   /* number of elements */
-    size_t need;                    /* read size needed */
-    char   sds1_name[H4_MAX_NC_NAME];
-    char   sds2_name[H4_MAX_NC_NAME];
-    int    dim_diff = 0; /* dimensions are different */
-    int    empty1_sds;
-    int    empty2_sds;
-    void  *buf1 = NULL;
-    void  *buf2 = NULL;
-    uint32 max_err_cnt;
-    int    i;
-    void  *fill1   = NULL;
-    void  *fill2   = NULL;
-    uint32 nfound  = 0;
-    void  *sm_buf1 = NULL;
-    void  *sm_buf2 = NULL;
+        eltsz,                      /* element size */
+        chunk_flags;                /* chunking of SDS 1 */
+    HDF_CHUNK_DEF chunk_def;        /* chunk lengths of SDS 1 */
+    uint32        nelms;            /* number of elements */
+    char          sds1_name[H4_MAX_NC_NAME];
+    char          sds2_name[H4_MAX_NC_NAME];
+    int           dim_diff = 0; /* dimensions are different */
+    int           empty1_sds;
+    int           empty2_sds;
+    uint32        max_err_cnt;
+    int           i;
+    void         *fill1  = NULL;
+    void         *fill2  = NULL;
+    uint32        nfound = 0;
+    int           exact;                           /* values are compared as bytes */
+    int           ph    = 1;                       /* print header of the differences */
+    sds_raw_t     raw   = {0, {0}, 0, 0, NULL, NULL, 0}; /* stored data, with -r */
+    sds_raw_t    *raw_p = NULL;                          /* raw, if the stored data are compared */
+
+    /* block info */
+    sds_block_t blocks[2] = {{{0}}}; /* block compared and block read ahead */
+    sds_block_t *blk;                /* block compared */
+    sds_block_t *next;               /* block read ahead */
+    int          cur;                /* index of the block compared */
+    uint32       elmtno;             /* counter */
+    int          carry;              /* counter carry value */
+    int32        sm_size[H4_MAX_VAR_DIMS];   /* block size */
+    size_t       max_block;                  /* max. bytes per block */
+    size_t       sm_nbytes;                  /* bytes per block */
+    int32        hs_offset[H4_MAX_VAR_DIMS]; /* offset of the next block */
+    uint32       nblocks  = 0;               /* blocks compared */
+    uint32       nskipped = 0;               /* blocks whose stored data are equal */
 
     /*-------------------------------------------------------------------------
      * object 1
@@ -226,7 +530,9 @@ diff_sds(int32 sd1_id, int32 sd2_id, int32 ref1, int32 ref2, diff_opt_t *opt)
         }
 
         /*-------------------------------------------------------------------------
-         * read
+         * read and compare by blocks of at most opt->max_block bytes, made of
+         * whole chunks when the first SDS is chunked. the next block is read
+         * in the background while a block is compared
          *-------------------------------------------------------------------------
          */
 
@@ -235,146 +541,109 @@ diff_sds(int32 sd1_id, int32 sd2_id, int32 ref1, int32 ref2, diff_opt_t *opt)
             nelms *= dimsizes1[i];
         }
 
-        need = (size_t)(nelms * eltsz); /* bytes needed */
-
-        if (need < H4TOOLS_MALLOCSIZE) {
-            buf1 = (void *)malloc(need);
-            buf2 = (void *)malloc(need);
+        if (SDgetchunkinfo(sds1_id, &chunk_def, &chunk_flags) == FAIL)
+            chunk_flags = HDF_NONE;
+
+        /* the values of exact comparisons can be compared as bytes */
+        exact = (opt->err_limit == 0 && opt->err_rel == 0 && !opt->statistics);
+
+        /* and so can the stored chunks or data, if they are stored the same way */
+        if (opt->raw && exact && same_storage(sds1_id, sds2_id)) {
+            raw.chunked = (chunk_flags & HDF_CHUNK) != 0;
+            for (i = 0; raw.chunked && i < rank1; i++)
+                raw.chunk_lengths[i] = chunk_def.chunk_lengths[i];
+            raw.fill_same = (fill1 == NULL && fill2 == NULL) ||
+                            (fill1 != NULL && fill2 != NULL && memcmp(fill1, fill2, (size_t)eltsz) == 0);
+            raw.data_same = !raw.chunked && same_data(sd1_id, sd2_id, sds1_id, sds2_id, &raw);
+            raw_p         = &raw;
         }
 
-        /*-------------------------------------------------------------------------
-         * read all
-         *-------------------------------------------------------------------------
-         */
+        /* the statistics are of the whole SDS, so are read at once */
+        max_block = opt->statistics ? (size_t)nelms * (size_t)eltsz : (size_t)opt->max_block;
 
-        if (buf1 != NULL && buf2 != NULL) {
+        /* the block takes whole rows of the fastest dimensions first */
+        sm_nbytes = (size_t)eltsz;
+        for (i = rank1; i > 0; --i) {
+            sm_size[i - 1] = (int32)MIN((size_t)dimsizes1[i - 1], MAX(1, max_block / sm_nbytes));
+            if ((chunk_flags & HDF_CHUNK) && sm_size[i - 1] < dimsizes1[i - 1]) {
+                int32 unit = chunk_def.chunk_lengths[i - 1]; /* chunk length of this dimension */
 
-            /* select all */
-            for (i = 0; i < rank1; i++) {
-                edges[i] = dimsizes1[i];
-                start[i] = 0;
+                sm_size[i - 1] = MIN(dimsizes1[i - 1], MAX(unit, sm_size[i - 1] / unit * unit));
             }
+            sm_nbytes *= (size_t)sm_size[i - 1];
+        }
 
-            /* read */
-            if (SDreaddata(sds1_id, start, NULL, edges, buf1) == FAIL) {
-                printf("Could not read SDS <%s>\n", sds1_name);
-                goto out;
-            }
-            /* read */
-            if (SDreaddata(sds2_id, start, NULL, edges, buf2) == FAIL) {
-                printf("Could not read SDS <%s>\n", sds2_name);
+        for (i = 0; i < 2; i++) {
+            blocks[i].buf1 = malloc(sm_nbytes);
+            blocks[i].buf2 = malloc(sm_nbytes);
+            if (blocks[i].buf1 == NULL || blocks[i].buf2 == NULL) {
+                printf("Out of memory!\n");
                 goto out;
             }
+        }
 
-            /*-------------------------------------------------------------------------
-             * comparing
-             *-------------------------------------------------------------------------
-             */
+        if (opt->verbose)
+            printf("Comparing <%s>\n", sds1_name);
 
-            if (opt->verbose)
-                printf("Comparing <%s>\n", sds1_name);
+        /* if the given max_err_cnt is set (i.e. not its default MAX_DIFF),
+           use it, otherwise, use the total number of elements in the dataset */
+        max_err_cnt = (opt->max_err_cnt != MAX_DIFF) ? opt->max_err_cnt : nelms;
 
-            /* if the given max_err_cnt is set (i.e. not its default MAX_DIFF),
-               use it, otherwise, use the total number of elements in the dataset */
-            max_err_cnt = (opt->max_err_cnt != MAX_DIFF) ? opt->max_err_cnt : nelms;
-            nfound      = array_diff(buf1, buf2, nelms, sds1_name, sds2_name, rank1, dimsizes1, dtype1,
-                                     opt->err_limit, opt->err_rel, max_err_cnt, opt->statistics, fill1, fill2);
+        memset(hs_offset, 0, sizeof hs_offset);
+        if (read_block(sds1_id, sds2_id, rank1, dimsizes1, hs_offset, sm_size, raw_p, &blocks[0]) == FAIL) {
+            printf("Could not read SDS <%s>\n", sds1_name);
+            goto out;
         }
 
-        else /* possibly not enough memory, read/compare by hyperslabs */
+        for (elmtno = 0, cur = 0; elmtno < nelms; elmtno += blk->nelms, cur = 1 - cur) {
+            blk = &blocks[cur];
 
-        {
-            size_t p_type_nbytes = eltsz; /*size of type */
-            uint32 p_nelmts      = nelms; /*total selected elmts */
-            uint32 elmtno;                /*counter  */
-            int    carry;                 /*counter carry value */
-
-            /* stripmine info */
-            int32 sm_size[H4_MAX_VAR_DIMS]; /*stripmine size */
-            int32 sm_nbytes;                /*bytes per stripmine */
-
-            /* hyperslab info */
-            int32 hs_offset[H4_MAX_VAR_DIMS]; /*starting offset */
-            int32 hs_size[H4_MAX_VAR_DIMS];   /*size this pass */
-            int32 hs_nelmts;                  /*elements in request */
-
-            /*
-             * determine the strip mine size and allocate a buffer. The strip mine is
-             * a hyperslab whose size is manageable.
-             */
-            sm_nbytes = p_type_nbytes;
+            Hasyncwait();
+            if (blk->status1 == FAIL) {
+                printf("Could not read SDS <%s>\n", sds1_name);
+                goto out;
+            }
+            if (blk->status2 == FAIL) {
+                printf("Could not read SDS <%s>\n", sds2_name);
+                goto out;
+            }
 
-            for (i = rank1; i > 0; --i) {
-                sm_size[i - 1] = MIN(dimsizes1[i - 1], H4TOOLS_BUFSIZE / sm_nbytes);
-                sm_nbytes *= sm_size[i - 1];
-                assert(sm_nbytes > 0);
+            /* calculate the next block offset and start reading it */
+            for (i = rank1, carry = 1; i > 0 && carry; --i) {
+                hs_offset[i - 1] += blk->edges[i - 1];
+                if (hs_offset[i - 1] == dimsizes1[i - 1])
+                    hs_offset[i - 1] = 0;
+                else
+                    carry = 0;
+            } /* i */
+
+            next = &blocks[1 - cur];
+            if (elmtno + blk->nelms < nelms &&
+                read_block(sds1_id, sds2_id, rank1, dimsizes1, hs_offset, sm_size, raw_p, next) == FAIL) {
+                printf("Could not read SDS <%s>\n", sds1_name);
+                goto out;
             }
 
-            sm_buf1 = malloc((size_t)sm_nbytes);
-            sm_buf2 = malloc((size_t)sm_nbytes);
+            /*-------------------------------------------------------------------------
+             * comparing
+             *-------------------------------------------------------------------------
+             */
 
-            /* the stripmine loop */
-            memset(hs_offset, 0, sizeof hs_offset);
+            nblocks++;
+            if (blk->same)
+                nskipped++;
+            if (blk->same || (exact && memcmp(blk->buf1, blk->buf2, (size_t)blk->nelms * (size_t)eltsz) == 0))
+                continue;
 
-            for (elmtno = 0; elmtno < p_nelmts; elmtno += hs_nelmts) {
-                /* calculate the hyperslab size */
-                if (rank1 > 0) {
-                    for (i = 0, hs_nelmts = 1; i < rank1; i++) {
-                        hs_size[i] = MIN(dimsizes1[i] - hs_offset[i], sm_size[i]);
-                        hs_nelmts *= hs_size[i];
-                    }
-                }
-                else {
-                    hs_nelmts = 1;
-                } /* rank */
-
-                /* read */
-                if (SDreaddata(sds1_id, hs_offset, NULL, hs_size, sm_buf1) == FAIL) {
-                    printf("Could not read SDS <%s>\n", sds1_name);
-                    goto out;
-                }
-                /* read */
-                if (SDreaddata(sds2_id, hs_offset, NULL, hs_size, sm_buf2) == FAIL) {
-                    printf("Could not read SDS <%s>\n", sds2_name);
-                    goto out;
-                }
+            /* print the positions of the differences in the SDS, up to max_err_cnt in all */
+            nfound += array_diff(blk->buf1, blk->buf2, blk->nelms, sds1_name, sds2_name, rank1, blk->edges,
+                                 blk->start, dtype1, opt->err_limit, opt->err_rel,
+                                 max_err_cnt - MIN(nfound, max_err_cnt), opt->statistics, fill1, fill2, &ph);
+        } /* elmtno */
 
-                /*-------------------------------------------------------------------------
-                 * comparing
-                 *-------------------------------------------------------------------------
-                 */
-
-                if (opt->verbose)
-                    printf("Comparing <%s>\n", sds1_name);
-
-                /* if the given max_err_cnt is set (i.e. not its default MAX_DIFF),
-                   use it, otherwise, use the total number of elements in the dataset */
-                max_err_cnt = (opt->max_err_cnt != MAX_DIFF) ? opt->max_err_cnt : nelms;
-
-                /* get array differences. in the case of hyperslab read, increment the number of differences
-                   found in each hyperslab and pass the position at the beginning for printing
-                 */
-                nfound =
-                    array_diff(sm_buf1, sm_buf2, hs_nelmts, sds1_name, sds2_name, rank1, dimsizes1, dtype1,
-                               opt->err_limit, opt->err_rel, max_err_cnt, opt->statistics, fill1, fill2);
-
-                /* calculate the next hyperslab offset */
-                for (i = rank1, carry = 1; i > 0 && carry; --i) {
-                    hs_offset[i - 1] += hs_size[i - 1];
-                    if (hs_offset[i - 1] == dimsizes1[i - 1])
-                        hs_offset[i - 1] = 0;
-                    else
-                        carry = 0;
-                } /* i */
-            }     /* elmtno */
-
-            /* free */
-            free(sm_buf1);
-            sm_buf1 = NULL;
-            free(sm_buf2);
-            sm_buf2 = NULL;
-
-        } /* hyperslab read */
+        if (opt->verbose && raw_p != NULL)
+            printf("Skipped %u of %u blocks of <%s> with equal stored %s\n", nskipped, nblocks, sds1_name,
+                   raw.chunked ? "chunks" : "data");
 
     } /* flag to compare SDSs */
 
@@ -392,8 +661,12 @@ do_nothing:
 
     SDendaccess(sds1_id);
     SDendaccess(sds2_id);
-    free(buf1);
-    free(buf2);
+    for (i = 0; i < 2; i++) {
+        free(blocks[i].buf1);
+        free(blocks[i].buf2);
+    }
+    free(raw.raw1);
+    free(raw.raw2);
     free(fill1);
     free(fill2);
 
@@ -403,13 +676,20 @@ out:
 
     opt->err_stat = 1;
 
+    /* the buffers may still be read into */
+    Hasyncwait();
+
     if (sds1_id != -1)
         SDendaccess(sds1_id);
     if (sds2_id != -1)
         SDendaccess(sds2_id);
 
-    free(buf1);
-    free(buf2);
+    for (i = 0; i < 2; i++) {
+        free(blocks[i].buf1);
+        free(blocks[i].buf2);
+    }
+    free(raw.raw1);
+    free(raw.raw2);
     free(fill1);
     free(fill2);
 
@@ -16,6 +16,10 @@
 /* groups */
 #define FILE7_NAME "hdifftst7.hdf"
 
+/* chunks */
+#define FILE8_NAME "hdifftst8.hdf"
+#define FILE9_NAME "hdifftst9.hdf"
+
 #define X_LENGTH       2
 #define Y_LENGTH       3
 #define RANK           2
@@ -49,6 +53,7 @@
  */
 static int do_big_file(void);
 static int do_groups(void);
+static int do_chunks(void);
 
 /*-------------------------------------------------------------------------
  * main
@@ -305,6 +310,13 @@ main(void)
     if (do_groups() == FAIL)
         goto error;
 
+    /*-------------------------------------------------------------------------
+     * chunks
+     *-------------------------------------------------------------------------
+     */
+    if (do_chunks() == FAIL)
+        goto error;
+
     return 0;
 
 error:
@@ -671,3 +683,87 @@ out:
     printf("Error...Exiting...\n");
     return FAIL;
 }
+
+#define CHK_DIM0   40
+#define CHK_DIM1   40
+#define CHK_LENGTH 10
+
+/*-------------------------------------------------------------------------
+ * write 2 files with a compressed, chunked SDS whose values differ in 2
+ * chunks. the chunks of the last rows are not written. the files also
+ * have an equal compressed SDS that is not chunked
+ *-------------------------------------------------------------------------
+ */
+static int
+do_chunks(void)
+{
+    int32         sd_id;   /* SD interface identifier */
+    int32         sds_id;  /* SDS identifier */
+    int32         dims[2]; /* sizes of the SDS dimensions */
+    int32         start[2];
+    int32         edges[2];
+    HDF_CHUNK_DEF chunk_def;
+    int32         data[CHK_DIM0][CHK_DIM1];
+    char         *file_name;
+    int           i, j, n;
+
+    for (n = 0; n < 2; n++) {
+        file_name = (n == 0 ? FILE8_NAME : FILE9_NAME);
+
+        for (j = 0; j < CHK_DIM0; j++)
+            for (i = 0; i < CHK_DIM1; i++)
+                data[j][i] = j * CHK_DIM1 + i;
+        if (n == 1) {
+            data[5][5]   = 0;
+            data[25][13] = 0;
+        }
+
+        if ((sd_id = SDstart(file_name, DFACC_CREATE)) == FAIL)
+            goto error;
+
+        dims[0] = CHK_DIM0;
+        dims[1] = CHK_DIM1;
+        if ((sds_id = SDcreate(sd_id, "chunked", DFNT_INT32, 2, dims)) == FAIL)
+            goto error;
+
+        memset(&chunk_def, 0, sizeof(chunk_def));
+        chunk_def.comp.chunk_lengths[0]    = CHK_LENGTH;
+        chunk_def.comp.chunk_lengths[1]    = CHK_LENGTH;
+        chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+        chunk_def.comp.cinfo.deflate.level = 6;
+        if (SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP) == FAIL)
+            goto error;
+
+        start[0] = start[1] = 0;
+        edges[0]            = CHK_DIM0 - CHK_LENGTH;
+        edges[1]            = CHK_DIM1;
+        if (SDwritedata(sds_id, start, NULL, edges, (void *)data) == FAIL)
+            goto error;
+
+        if (SDendaccess(sds_id) == FAIL)
+            goto error;
+
+        if ((sds_id = SDcreate(sd_id, "compressed", DFNT_INT32, 2, dims)) == FAIL)
+            goto error;
+        if (SDsetcompress(sds_id, COMP_CODE_DEFLATE, &chunk_def.comp.cinfo) == FAIL)
+            goto error;
+        edges[0] = CHK_DIM0;
+        for (i = 0; i < CHK_DIM1; i++)
+            data[5][i] = data[25][i] = 5 * CHK_DIM1 + i;
+        if (SDwritedata(sds_id, start, NULL, edges, (void *)data) == FAIL)
+            goto error;
+
+        if (SDendaccess(sds_id) == FAIL)
+            goto error;
+        if (SDend(sd_id) == FAIL)
+            goto error;
+    }
+
+    return SUCCEED;
+
+error:
+
+    printf("Error...Exiting...\n");
+
+    return FAIL;
+}
@@ -285,6 +285,15 @@ ADD_H4_TEST(GZIP "TEST" ${HREPACK_FILE1} -t "*:GZIP 1")
 #
 ADD_H4_TEST(HYPERSLAB "TEST" ${HREPACK_FILE2})
 
+#-------------------------------------------------------------------------
+# test10a:
+# recompress the chunked SDS of the big file, decoding and encoding the
+# chunks on several threads
+#-------------------------------------------------------------------------
+#
+ADD_H4_TEST(HYPERSLAB_THREADS "TEST" ${HREPACK_FILE2} -j 4 -t "chunked:GZIP 6" -c chunked:64x100)
+ADD_H4_TEST(HYPERSLAB_RECHUNK "TEST" ${HREPACK_FILE2} -j 2 -c chunked:50x30)
+
 #-------------------------------------------------------------------------
 # test11:
 # repack a file with vgroups
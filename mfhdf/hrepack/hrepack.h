@@ -66,6 +66,7 @@ typedef struct {
     int              verbose;   /*verbose mode */
     int              trip;      /*which cycle are we in */
     int              threshold; /*minimum size to compress, in bytes */
+    int              nthreads;  /*threads decoding and encoding chunks, -j */
 } options_t;
 
 #ifdef __cplusplus
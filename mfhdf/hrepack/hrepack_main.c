@@ -13,6 +13,7 @@
 
 #include "hdf.h"
 #include "hfile_priv.h"
+#include "hthread_priv.h"
 #include "mfhdf.h"
 #include "hrepack.h"
 #include "hrepack_parse.h"
@@ -90,6 +91,19 @@ main(int argc, char **argv)
             ++i;
         }
 
+        else if (strcmp(argv[i], "-j") == 0) {
+
+            options.nthreads = parse_number(argv[i + 1]);
+            if (options.nthreads < 1) {
+                printf("Error: Invalid number of threads <%s>\n", argv[i + 1]);
+                goto out;
+            }
+            /* no more than a thread pool of the library runs */
+            if (options.nthreads > HTH_MAX_THREADS)
+                options.nthreads = HTH_MAX_THREADS;
+            ++i;
+        }
+
         else if (strcmp(argv[i], "-f") == 0) {
             if (read_info(argv[++i], &options) < 0)
                 goto out;
@@ -139,7 +153,7 @@ usage(void)
 {
 
     printf("usage: hrepack -i input -o output [-V] [-h] [-v] [-t 'comp_info'] [-c 'chunk_info'] [-f cfile] "
-           "[-m size]\n");
+           "[-m size] [-j n]\n");
     printf("  -i input          input HDF File\n");
     printf("  -o output         output HDF File\n");
     printf("  [-V]              prints version of the HDF4 library and exits\n");
@@ -173,6 +187,8 @@ usage(void)
     printf("\t\t        NONE, to unchunk a previous chunked object\n");
     printf("  [-f cfile]      file with compression information -t and -c\n");
     printf("  [-m size]       do not compress objects smaller than size (bytes)\n");
+    printf("  [-j n]          decode and encode the chunks of each SDS on n threads, at most %d\n",
+           HTH_MAX_THREADS);
     printf("\n");
     printf("Examples:\n");
     printf("\n");
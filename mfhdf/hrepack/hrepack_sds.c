@@ -34,6 +34,127 @@ void print_info(int chunk_flags, HDF_CHUNK_DEF *chunk_def, int comp_type, char *
 int get_print_info(int chunk_flags, HDF_CHUNK_DEF *chunk_def, int comp_type, char *path, char *sds_name,
                    int32 sd_id);
 
+/*-------------------------------------------------------------------------
+ * Function: copy_sds_chunks
+ *
+ * Purpose: copy the chunks of an SDS to a new SDS with the same chunk
+ *  lengths and compression as they are stored, without decompressing and
+ *  compressing them again. Chunks that were never written are copied
+ *  decoded, so that they get the fill value of the input SDS.
+ *
+ * Return: SUCCEED, FAIL
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int
+copy_sds_chunks(int32  sds_id,        /* input SDS */
+                int32  sds_out,       /* output SDS */
+                int32  rank,          /* rank of SDS */
+                int32 *dimsizes,      /* dimensions of SDS */
+                int32 *chunk_lengths, /* chunk lengths of both SDSs */
+                int32  eltsz,         /* element size */
+                char  *path /* path of the SDS, for messages */)
+{
+    int32        origin[H4_MAX_VAR_DIMS];  /* origin of the chunk, in chunks */
+    int32        nchunks[H4_MAX_VAR_DIMS]; /* number of chunks along each dimension */
+    int32        chunk_nbytes = eltsz;     /* bytes of the decoded chunk */
+    int32        size;                     /* bytes of the chunk as stored */
+    comp_coder_t comp_type;                /* compression type of the chunk */
+    void        *buf      = NULL;          /* chunk as stored */
+    int32        buf_size = 0;             /* size of buf */
+    void        *fill_buf = NULL;          /* decoded chunk */
+    int          carry;
+    int          i;
+    int          ret_value = FAIL;
+
+    for (i = 0; i < rank; i++) {
+        origin[i]  = 0;
+        nchunks[i] = (dimsizes[i] + chunk_lengths[i] - 1) / chunk_lengths[i];
+        chunk_nbytes *= chunk_lengths[i];
+        if (nchunks[i] == 0)
+            return SUCCEED;
+    }
+
+    do {
+        if ((size = SDreadchunk_raw(sds_id, origin, &comp_type, NULL, 0, NULL)) == FAIL) {
+            printf("Could not read chunk of SDS <%s>\n", path);
+            goto out;
+        }
+
+        if (size > 0) {
+            if (size > buf_size) {
+                free(buf);
+                if ((buf = malloc((size_t)size)) == NULL) {
+                    printf("Out of memory copying chunks of SDS <%s>\n", path);
+                    buf_size = 0;
+                    goto out;
+                }
+                buf_size = size;
+            }
+            if (SDreadchunk_raw(sds_id, origin, NULL, NULL, buf_size, buf) == FAIL) {
+                printf("Could not read chunk of SDS <%s>\n", path);
+                goto out;
+            }
+            if (SDwritechunk_raw(sds_out, origin, comp_type, size, buf) == FAIL) {
+                printf("Failed to write chunk to new SDS <%s>\n", path);
+                goto out;
+            }
+        }
+        else { /* never written, holds the fill value of the input */
+            if (fill_buf == NULL && (fill_buf = malloc((size_t)chunk_nbytes)) == NULL) {
+                printf("Out of memory copying chunks of SDS <%s>\n", path);
+                goto out;
+            }
+            if (SDreadchunk(sds_id, origin, fill_buf) == FAIL) {
+                printf("Could not read chunk of SDS <%s>\n", path);
+                goto out;
+            }
+            if (SDwritechunk(sds_out, origin, fill_buf) == FAIL) {
+                printf("Failed to write chunk to new SDS <%s>\n", path);
+                goto out;
+            }
+        }
+
+        /* next chunk */
+        for (i = rank, carry = 1; i > 0 && carry; --i) {
+            if (++origin[i - 1] == nchunks[i - 1])
+                origin[i - 1] = 0;
+            else
+                carry = 0;
+        }
+    } while (!carry);
+
+    ret_value = SUCCEED;
+
+out:
+    free(buf);
+    free(fill_buf);
+    return ret_value;
+}
+
+/*-------------------------------------------------------------------------
+ * Function: sm_nchunks
+ *
+ * Purpose: the most chunks of the given lengths a stripmine of sm_size
+ *  touches; 'aligned' says that the stripmines start at chunk boundaries
+ *
+ * Return: number of chunks
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static int32
+sm_nchunks(int32 rank, int32 *sm_size, int32 *chunk_lengths, int aligned)
+{
+    int32 n = 1;
+    int   i;
+
+    for (i = 0; i < rank; i++)
+        n *= (sm_size[i] + chunk_lengths[i] - 1) / chunk_lengths[i] + (aligned ? 0 : 1);
+    return n;
+}
+
 /*-------------------------------------------------------------------------
  * Function: copy_sds
  *
@@ -93,6 +214,9 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
     size_t        need; /* read size needed */
     void         *sm_buf    = NULL;
     int           is_record = 0;
+    int           raw_copy  = 0; /* copy the chunks as they are stored */
+    int           chunked_in;    /* input SDS is chunked */
+    int           chunked_out;   /* output SDS is chunked */
 
     sds_index = SDreftoindex(sd_in, ref);
     sds_id    = SDselect(sd_in, sds_index);
@@ -503,11 +627,72 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
             }
         }
 
+        /*-------------------------------------------------------------------------
+         * chunks that keep their lengths and compression are copied as they
+         * are stored, without decompressing and compressing them again
+         *-------------------------------------------------------------------------
+         */
+
+        if (!is_record && chunk_flags == chunk_flags_in && comp_type == comp_type_in &&
+            (chunk_flags == HDF_CHUNK || chunk_flags == (HDF_CHUNK | HDF_COMP))) {
+            raw_copy = 1;
+            for (i = 0; i < rank; i++)
+                if (chunk_def.chunk_lengths[i] != chunk_def_in.chunk_lengths[i])
+                    raw_copy = 0;
+
+            if (chunk_flags == (HDF_CHUNK | HDF_COMP)) {
+                switch (comp_type) {
+                    case COMP_CODE_RLE:
+                        break;
+                    case COMP_CODE_SKPHUFF:
+                        if (chunk_def.comp.cinfo.skphuff.skp_size != c_info_in.skphuff.skp_size)
+                            raw_copy = 0;
+                        break;
+                    case COMP_CODE_DEFLATE:
+                        if (chunk_def.comp.cinfo.deflate.level != c_info_in.deflate.level)
+                            raw_copy = 0;
+                        break;
+                    case COMP_CODE_SZIP:
+                        if (chunk_def.comp.cinfo.szip.pixels_per_block != c_info_in.szip.pixels_per_block ||
+                            chunk_def.comp.cinfo.szip.options_mask != c_info_in.szip.options_mask)
+                            raw_copy = 0;
+                        break;
+                    default:
+                        raw_copy = 0;
+                }
+            }
+        }
+
+        /*-------------------------------------------------------------------------
+         * with -j, the chunks of the input are decoded and those of the
+         * output encoded on several threads
+         *-------------------------------------------------------------------------
+         */
+
+        chunked_in  = (chunk_flags_in == HDF_CHUNK || chunk_flags_in == (HDF_CHUNK | HDF_COMP));
+        chunked_out = !is_record && (chunk_flags == HDF_CHUNK || chunk_flags == (HDF_CHUNK | HDF_COMP));
+
+        if (!raw_copy && options->nthreads > 1) {
+            if (chunked_in && SDsetreadthreads(sds_id, options->nthreads) == FAIL) {
+                printf("Error: Failed to set read threads for <%s>\n", path);
+                goto out;
+            }
+            if (chunked_out && SDsetwritethreads(sds_out, options->nthreads) == FAIL) {
+                printf("Error: Failed to set write threads for <%s>\n", path);
+                goto out;
+            }
+        }
+
         need = (size_t)(nelms * eltsz); /* bytes needed */
 
-        if (need < H4TOOLS_MALLOCSIZE ||
-            /* for compressed datasets do one operation I/O, but allow hyperslab for chunked */
-            (chunk_flags == HDF_NONE && comp_type > COMP_CODE_NONE)) {
+        if (raw_copy) {
+            if (copy_sds_chunks(sds_id, sds_out, rank, dimsizes, chunk_def.chunk_lengths, eltsz, path) ==
+                FAIL)
+                goto out;
+        }
+        else if (need < H4TOOLS_MALLOCSIZE ||
+                 /* for compressed datasets do one operation I/O, but allow hyperslab for chunked */
+                 (chunk_flags == HDF_NONE && comp_type > COMP_CODE_NONE)) {
             buf = (void *)malloc(need);
         }
 
@@ -537,7 +722,7 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
             }
         }
 
-        else /* possibly not enough memory, read/write by hyperslabs */
+        else if (!raw_copy) /* possibly not enough memory, read/write by hyperslabs */
 
         {
             size_t p_type_nbytes = eltsz; /*size of type */
@@ -548,6 +733,9 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
             /* stripmine info */
             int32 sm_size[H4_MAX_VAR_DIMS]; /*stripmine size */
             int32 sm_nbytes;                /*bytes per stripmine */
+            int32 sm_budget;                /*bytes wanted per stripmine */
+            int32 unit;                     /*input chunk length */
+            int32 sm_chunks;                /*chunks a stripmine touches */
 
             /* hyperslab info */
             int32 hs_offset[H4_MAX_VAR_DIMS]; /*starting offset */
@@ -556,16 +744,41 @@ copy_sds(int32 sd_in, int32 sd_out, int32 tag, /* tag of input SDS */
 
             /*
              * determine the strip mine size and allocate a buffer. The strip mine is
-             * a hyperslab whose size is manageable.
+             * a hyperslab whose size is manageable. For a chunked input it is made of
+             * whole chunks, so that no chunk is decoded twice, and with -j it holds
+             * enough chunks to keep the threads busy.
              */
             sm_nbytes = p_type_nbytes;
+            sm_budget = H4TOOLS_BUFSIZE * MAX(1, options->nthreads);
 
             for (i = rank; i > 0; --i) {
-                sm_size[i - 1] = MIN(dimsizes[i - 1], H4TOOLS_BUFSIZE / sm_nbytes);
+                sm_size[i - 1] = MIN(dimsizes[i - 1], sm_budget / sm_nbytes);
+                if (chunked_in && sm_size[i - 1] < dimsizes[i - 1]) {
+                    unit           = chunk_def_in.chunk_lengths[i - 1];
+                    sm_size[i - 1] = MIN(dimsizes[i - 1], MAX(unit, sm_size[i - 1] / unit * unit));
+                }
                 sm_nbytes *= sm_size[i - 1];
                 assert(sm_nbytes > 0);
             }
 
+            /* let the chunk caches hold the chunks of a stripmine */
+            if (options->nthreads > 1) {
+                if (chunked_in) {
+                    sm_chunks = sm_nchunks(rank, sm_size, chunk_def_in.chunk_lengths, 1);
+                    if (SDsetchunkcache(sds_id, sm_chunks, 0) == FAIL) {
+                        printf("Error: Failed to set chunk cache for <%s>\n", path);
+                        goto out;
+                    }
+                }
+                if (chunked_out) {
+                    sm_chunks = sm_nchunks(rank, sm_size, chunk_def.chunk_lengths, 0);
+                    if (SDsetchunkcache(sds_out, sm_chunks, 0) == FAIL) {
+                        printf("Error: Failed to set chunk cache for <%s>\n", path);
+                        goto out;
+                    }
+                }
+            }
+
             sm_buf = malloc((size_t)sm_nbytes);
 
             /* the stripmine loop */
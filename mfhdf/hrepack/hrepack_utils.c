@@ -53,6 +53,12 @@ is_reserved(char *vgroup_class)
         if ((strncmp(vgroup_class, "_HDF_CHK_TBL_", 13) == 0)) {
             ret = 1;
         }
+
+        /* class (partial) of the indexes of vdata fields, whose class and name
+           hold the ref of the indexed vdata in the input file */
+        if ((strncmp(vgroup_class, _HDF_VSINDEX_CLASS, 13) == 0)) {
+            ret = 1;
+        }
     }
 
     return ret;
@@ -13,6 +13,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "hdf.h"
 #include "mfhdf.h"
@@ -100,6 +101,13 @@ copy_vs(int32 infile_id, int32 outfile_id, int32 tag, /* tag of input VS */
         }
     }
 
+    /* the indexes of vdata fields hold the ref of their vdata in the input file;
+       they are not copied (the vdata is detached at out) */
+    if (strncmp(vdata_class, _HDF_VSINDEX_CLASS, 13) == 0 && is_reserved(vdata_class)) {
+        ret = 0;
+        goto out;
+    }
+
     /* initialize path */
     path = get_path(path_name, vdata_name);
 
@@ -75,6 +75,11 @@
 #define DIM0     10
 #define DIM1     10
 #define ADD_ROWS (1024 * 1024 - 10) / 10
+/* dimensions and chunk lengths of the chunked hyperslab sds */
+#define CDIM0   600
+#define CDIM1   1000
+#define CCHUNK0 64
+#define CCHUNK1 100
 /* Vdata */
 #define N_RECORDS      3 /* number of records the vdata contains */
 #define ORDER_1        3 /* order of first field */
@@ -1975,6 +1980,9 @@ do_file_hyperslab(const char *fname)
     uint8 append_data[DIM1];
     int   i, j, n;
 
+    int32        *chunked_data; /* values of the chunked SDS */
+    HDF_CHUNK_DEF chunk_def;    /* its chunk lengths and compression */
+
     /* Create a file and initiate the SD interface. */
     if ((sd_id = SDstart(fname, DFACC_CREATE)) == FAIL)
         goto error;
@@ -2038,6 +2046,32 @@ do_file_hyperslab(const char *fname)
     /* terminate access */
     if (SDendaccess(sds_id) == FAIL)
         goto error;
+
+    /* a chunked, compressed data set larger than the hyperslab buffer */
+    dims[0] = CDIM0;
+    dims[1] = CDIM1;
+    if ((sds_id = SDcreate(sd_id, "chunked", DFNT_INT32, rank, dims)) == FAIL)
+        goto error;
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = CCHUNK0;
+    chunk_def.comp.chunk_lengths[1]    = CCHUNK1;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 1;
+    if (SDsetchunk(sds_id, chunk_def, HDF_CHUNK | HDF_COMP) == FAIL)
+        goto error;
+    if ((chunked_data = (int32 *)malloc(CDIM0 * CDIM1 * sizeof(int32))) == NULL)
+        goto error;
+    for (j = 0; j < CDIM0; j++)
+        for (i = 0; i < CDIM1; i++)
+            chunked_data[j * CDIM1 + i] = j * CDIM1 + i % 97;
+    start[0] = start[1] = 0;
+    n                   = SDwritedata(sds_id, start, NULL, dims, chunked_data);
+    free(chunked_data);
+    if (n == FAIL)
+        goto error;
+    if (SDendaccess(sds_id) == FAIL)
+        goto error;
+
     if (SDend(sd_id) == FAIL)
         goto error;
 
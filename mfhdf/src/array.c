@@ -426,6 +426,19 @@ NC_incr_array(NC_array *array, uint8_t *tail)
     return array->values;
 }
 
+/*
+ * Get the ii'th handle of an array of handles, without assuming that the
+ * values are aligned for pointers
+ */
+void *
+NC_array_elem(const NC_array *array, unsigned ii)
+{
+    void *elem;
+
+    (void)memcpy(&elem, array->values + (size_t)ii * array->szof, sizeof(elem));
+    return elem;
+}
+
 /*
  * Definitely NOT Bomb proof.
  */
@@ -245,6 +245,8 @@ NC_aput(int cdfid, NC_array **ap, const char *name, nc_type datatype, unsigned c
 int
 ncattput(int cdfid, int varid, const char *name, nc_type datatype, int count, const ncvoid *values)
 {
+    H4_API_ENTER;
+
     NC_array **ap;
 
     cdf_routine_name = "ncattput";
@@ -267,6 +269,8 @@ ncattput(int cdfid, int varid, const char *name, nc_type datatype, int count, co
 int
 ncattname(int cdfid, int varid, int attnum, char *name)
 {
+    H4_API_ENTER;
+
     NC_array **ap;
     NC_attr  **attr;
 
@@ -293,6 +297,8 @@ int
 ncattinq(int cdfid, int varid, const char *name, nc_type *datatypep, int *countp)
 /* name - input, attribute name */
 {
+    H4_API_ENTER;
+
     NC_attr **attr;
 
     cdf_routine_name = "ncattinq";
@@ -311,6 +317,8 @@ ncattinq(int cdfid, int varid, const char *name, nc_type *datatypep, int *countp
 int
 ncattrename(int cdfid, int varid, const char *name, const char *newname)
 {
+    H4_API_ENTER;
+
     NC       *handle;
     NC_attr **attr;
     NC_string *new, *old;
@@ -357,6 +365,8 @@ ncattrename(int cdfid, int varid, const char *name, const char *newname)
 int
 ncattcopy(int incdf, int invar, const char *name, int outcdf, int outname)
 {
+    H4_API_ENTER;
+
     NC_attr  **attr;
     NC_array **ap;
 
@@ -376,6 +386,8 @@ ncattcopy(int incdf, int invar, const char *name, int outcdf, int outname)
 int
 ncattdel(int cdfid, int varid, const char *name)
 {
+    H4_API_ENTER;
+
     NC_array **ap;
     NC_attr  **attr;
     NC_attr   *old = NULL;
@@ -420,6 +432,8 @@ ncattdel(int cdfid, int varid, const char *name)
 int
 ncattget(int cdfid, int varid, const char *name, ncvoid *values)
 {
+    H4_API_ENTER;
+
     NC_attr **attr;
 
     cdf_routine_name = "ncattget";
@@ -46,6 +46,7 @@ NC_free_xcdf(NC *handle)
             HGOTO_FAIL(FAIL);
         if (NC_free_array(handle->vars) == FAIL)
             HGOTO_FAIL(FAIL);
+        NC_free_varhash(handle);
     }
 
 done:
@@ -135,6 +136,8 @@ done:
 int
 HDiscdf(const char *filename)
 {
+    H4_API_ENTER;
+
     int32 magic_num = 0;
     int   ret_value = FALSE;
 
@@ -158,6 +161,8 @@ HDiscdf(const char *filename)
 int
 HDisnetcdf(const char *filename)
 {
+    H4_API_ENTER;
+
     int32 magic_num = 0;
     int   ret_value = FALSE;
 
@@ -181,6 +186,8 @@ HDisnetcdf(const char *filename)
 int
 HDisnetcdf64(const char *filename)
 {
+    H4_API_ENTER;
+
     int32 magic_num = 0;
     int   ret_value = FALSE;
 
@@ -261,6 +268,7 @@ NC_new_cdf(const char *name, int mode)
     cdf->dims      = NULL;
     cdf->attrs     = NULL;
     cdf->vars      = NULL;
+    cdf->varhash   = NULL;
     cdf->begin_rec = 0;
     cdf->recsize   = 0;
     cdf->numrecs   = 0;
@@ -376,6 +384,7 @@ NC_dup_cdf(const char *name, int mode, NC *old)
 {
     NC *cdf       = NULL;
     NC *ret_value = NULL;
+    int pagesize, npages;
 
     cdf = malloc(sizeof(NC));
     if (cdf == NULL) {
@@ -394,6 +403,7 @@ NC_dup_cdf(const char *name, int mode, NC *old)
     cdf->dims      = NULL;
     cdf->attrs     = NULL;
     cdf->vars      = NULL;
+    cdf->varhash   = NULL;
     cdf->begin_rec = 0;
     cdf->recsize   = 0;
     cdf->numrecs   = 0;
@@ -403,6 +413,10 @@ NC_dup_cdf(const char *name, int mode, NC *old)
     if (NCxdrfile_create(cdf->xdrs, name, mode) < 0)
         HGOTO_FAIL(NULL);
 
+    /* Keep the I/O cache settings of the original */
+    if (h4_xdr_getcache(old->xdrs, &pagesize, &npages) == 0)
+        (void)h4_xdr_setcache(cdf->xdrs, pagesize, npages);
+
     old->xdrs->x_op = XDR_DECODE;
     if (!xdr_cdf(old->xdrs, &cdf))
         HGOTO_FAIL(NULL);
@@ -427,6 +441,8 @@ done:
 int
 ncinquire(int cdfid, int *ndimsp, int *nvarsp, int *nattrsp, int *xtendimp)
 {
+    H4_API_ENTER;
+
     NC *handle;
 
     cdf_routine_name = "ncinquire";
@@ -1967,8 +1983,9 @@ done:
 /* -------------------------------------------------------------------
 ** Read or write a CDF structure
 **
-** If we are reading, first try to read the information out of netCDF
-**    object stored explicitly in HDF files as netCDF objects.  If
+** If we are reading, first see if the file has an up to date SD catalog
+**    (see hdf_read_catalog()).  If not, try to read the information out of
+**    netCDF object stored explicitly in HDF files as netCDF objects.  If
 **    that fails try to read SDSs out of the HDF file and interpret
 **    them as netCDF information.
 */
@@ -1990,6 +2007,9 @@ hdf_xdr_cdf(XDR *xdrs, NC **handlep)
             }
             break;
         case XDR_DECODE:
+            /* a valid SD catalog saves reading the metadata piece by piece */
+            if (SUCCEED == hdf_read_catalog(*handlep))
+                break;
             if (FAIL == (status = hdf_read_xdr_cdf(xdrs, handlep))) {
                 status = hdf_read_sds_cdf(xdrs, handlep);
                 if (FAIL == status) {
@@ -2301,6 +2321,583 @@ done:
     return ret_value;
 } /* hdf_close */
 
+/* ------------------------------ SD catalog ------------------------------ */
+/*
+  The SD catalog is one element, DFTAG_SDCAT/SDCAT_REF, holding the
+  dimensions, attributes and variables that opening the file builds, so
+  that the next open can load them with a single read instead of walking
+  the CDF vgroup or every NDG in the file.  It is written when a writable
+  file is closed, if SDsetcatalog() asked for it or the file already had
+  one, and is refreshed on every such close from then on that finds it
+  out of date.
+
+  Everything is big-endian:
+
+      "SDCT" version(2) 0(2) machine(4) ndds(4) checksum(4) numrecs(4) vgid(4)
+      ndims(4) { name size(4) dim00_compat(4) vgid(4) count(4) }
+      attributes
+      nvars(4) { name type(4) rank(4) dimids(4 * rank) vgid(4) data_ref(2)
+                 data_tag(2) ndg_ref(2) 0(2) var_type(4) data_offset(4)
+                 block_size(4) numrecs(4) HDFtype(4) HDFsize(4) is_ragged(4)
+                 reclen(4) attributes }
+
+  where a name is its length(4) followed by its characters, and a list of
+  attributes is nattrs(4) { name type(4) HDFtype(4) size(4) count(4) values }.
+
+  ndds and checksum are those HDdd_checksum() gives for every DD but the
+  catalog's own; the catalog is only used while they still match, that is,
+  while no element of the file has been created, deleted, moved or resized
+  since the catalog was written.  reclen is the length of the data of a
+  record variable, -1 for other variables: records can be appended inside
+  an existing linked block without changing any DD, so it is checked on
+  its own.
+
+  Changes made through the SD interface always rewrite DDs.  An element
+  rewritten in place by another interface, with the same size, such as
+  attribute values written with VSwrite or a vgroup renamed to a name of
+  the same length, goes unnoticed; SDsetcatalog() rebuilds the catalog
+  after such changes.
+*/
+#define SDCAT_REF     ((uint16)1)
+#define SDCAT_VERSION 1
+#define SDCAT_HDRSIZE 28
+
+/* A catalog being encoded */
+typedef struct {
+    uint8 *buf;  /* encoded bytes */
+    size_t len;  /* # of bytes used */
+    size_t size; /* # of bytes allocated */
+} sdcat_buf_t;
+
+/* A catalog being decoded */
+typedef struct {
+    const uint8 *p;   /* next byte to decode */
+    const uint8 *end; /* end of the catalog */
+} sdcat_cur_t;
+
+/* Swap count values of szof bytes each between native and big-endian order */
+static void
+sdcat_swap(uint8 *values, size_t szof, unsigned count)
+{
+#ifdef H4_WORDS_BIGENDIAN
+    (void)values;
+    (void)szof;
+    (void)count;
+#else
+    unsigned i;
+    size_t   j;
+
+    for (i = 0; i < count; i++, values += szof)
+        for (j = 0; j < szof / 2; j++) {
+            uint8 tmp            = values[j];
+            values[j]            = values[szof - 1 - j];
+            values[szof - 1 - j] = tmp;
+        }
+#endif /* H4_WORDS_BIGENDIAN */
+}
+
+/* Append n bytes to the catalog, returning where to put them */
+static uint8 *
+sdcat_reserve(sdcat_buf_t *b, size_t n)
+{
+    uint8 *p;
+
+    if (b->len + n > b->size) {
+        size_t size = (b->size > 0) ? b->size : 1024;
+
+        while (size < b->len + n)
+            size *= 2;
+        if (NULL == (p = realloc(b->buf, size)))
+            return NULL;
+        b->buf  = p;
+        b->size = size;
+    }
+
+    p = b->buf + b->len;
+    b->len += n;
+    return p;
+}
+
+static int
+sdcat_put_u32(sdcat_buf_t *b, uint32 val)
+{
+    uint8 *p;
+
+    if (NULL == (p = sdcat_reserve(b, 4)))
+        return FAIL;
+    UINT32ENCODE(p, val);
+    return SUCCEED;
+}
+
+static int
+sdcat_put_u16(sdcat_buf_t *b, uint16 val)
+{
+    uint8 *p;
+
+    if (NULL == (p = sdcat_reserve(b, 2)))
+        return FAIL;
+    UINT16ENCODE(p, val);
+    return SUCCEED;
+}
+
+static int
+sdcat_put_name(sdcat_buf_t *b, const NC_string *name)
+{
+    uint8 *p;
+
+    if (sdcat_put_u32(b, (uint32)name->len) == FAIL)
+        return FAIL;
+    if (name->len > 0) {
+        if (NULL == (p = sdcat_reserve(b, name->len)))
+            return FAIL;
+        memcpy(p, name->values, name->len);
+    }
+    return SUCCEED;
+}
+
+static int
+sdcat_put_attrs(sdcat_buf_t *b, const NC_array *attrs)
+{
+    unsigned count = (attrs != NULL) ? attrs->count : 0;
+    unsigned i;
+
+    if (sdcat_put_u32(b, (uint32)count) == FAIL)
+        return FAIL;
+
+    for (i = 0; i < count; i++) {
+        NC_attr  *attr   = NC_array_elem(attrs, i);
+        NC_array *data   = attr->data;
+        size_t    nbytes = data->count * data->szof;
+        uint8    *p;
+
+        if (sdcat_put_name(b, attr->name) == FAIL || sdcat_put_u32(b, (uint32)data->type) == FAIL ||
+            sdcat_put_u32(b, (uint32)attr->HDFtype) == FAIL || sdcat_put_u32(b, (uint32)data->szof) == FAIL ||
+            sdcat_put_u32(b, (uint32)data->count) == FAIL)
+            return FAIL;
+        if (nbytes > 0) {
+            if (NULL == (p = sdcat_reserve(b, nbytes)))
+                return FAIL;
+            memcpy(p, data->values, nbytes);
+            sdcat_swap(p, data->szof, data->count);
+        }
+    }
+    return SUCCEED;
+}
+
+static int
+sdcat_get_u32(sdcat_cur_t *c, uint32 *val)
+{
+    if (c->end - c->p < 4)
+        return FAIL;
+    UINT32DECODE(c->p, *val);
+    return SUCCEED;
+}
+
+static int
+sdcat_get_i32(sdcat_cur_t *c, int32 *val)
+{
+    uint32 u;
+
+    if (sdcat_get_u32(c, &u) == FAIL)
+        return FAIL;
+    *val = (int32)u;
+    return SUCCEED;
+}
+
+static int
+sdcat_get_u16(sdcat_cur_t *c, uint16 *val)
+{
+    if (c->end - c->p < 2)
+        return FAIL;
+    UINT16DECODE(c->p, *val);
+    return SUCCEED;
+}
+
+/* Decode a name into a new null-terminated string */
+static char *
+sdcat_get_name(sdcat_cur_t *c)
+{
+    uint32 len;
+    char  *name;
+
+    if (sdcat_get_u32(c, &len) == FAIL || (size_t)(c->end - c->p) < len)
+        return NULL;
+    if (NULL == (name = malloc(len + 1)))
+        return NULL;
+    memcpy(name, c->p, len);
+    name[len] = '\0';
+    c->p += len;
+    return name;
+}
+
+/* Decode a list of attributes, an empty list giving NULL */
+static int
+sdcat_get_attrs(sdcat_cur_t *c, NC_array **attrsp)
+{
+    NC_attr **attrs = NULL;
+    uint32    count;
+    uint32    i, n = 0;
+    int       ret_value = SUCCEED;
+
+    *attrsp = NULL;
+    if (sdcat_get_u32(c, &count) == FAIL || count > (uint32)(c->end - c->p) / 20)
+        HGOTO_DONE(FAIL);
+    if (count == 0)
+        HGOTO_DONE(SUCCEED);
+
+    if (NULL == (attrs = malloc(count * sizeof(NC_attr *))))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    for (n = 0; n < count; n++) {
+        char  *name;
+        int32  type, HDFtype;
+        uint32 szof, nvalues;
+
+        if (NULL == (name = sdcat_get_name(c)))
+            HGOTO_DONE(FAIL);
+        if (sdcat_get_i32(c, &type) == FAIL || sdcat_get_i32(c, &HDFtype) == FAIL ||
+            sdcat_get_u32(c, &szof) == FAIL || sdcat_get_u32(c, &nvalues) == FAIL ||
+            type < NC_BYTE || type > NC_DOUBLE || szof != NC_typelen((nc_type)type) ||
+            nvalues > (uint32)(c->end - c->p) / szof) {
+            free(name);
+            HGOTO_DONE(FAIL);
+        }
+
+        attrs[n] = NC_new_attr(name, (nc_type)type, (unsigned)nvalues, NULL);
+        free(name);
+        if (attrs[n] == NULL)
+            HGOTO_DONE(FAIL);
+        if (nvalues > 0) {
+            memcpy(attrs[n]->data->values, c->p, nvalues * szof);
+            sdcat_swap(attrs[n]->data->values, szof, nvalues);
+            c->p += nvalues * szof;
+        }
+        attrs[n]->HDFtype = HDFtype;
+    }
+
+    if (NULL == (*attrsp = NC_new_array(NC_ATTRIBUTE, count, (uint8_t *)attrs)))
+        HGOTO_DONE(FAIL);
+    n = 0; /* the array owns them now */
+
+done:
+    for (i = 0; i < n; i++)
+        NC_free_attr(attrs[i]);
+    free(attrs);
+
+    return ret_value;
+} /* sdcat_get_attrs */
+
+/* ------------------------- hdf_read_catalog ----------------------------- */
+/*
+  Load the dimensions, attributes and variables of an HDF file from its
+  SD catalog.  Returns FAIL, leaving the handle as it was, if the file has
+  no catalog or if the one it has is out of date, in which case the caller
+  reads the metadata the usual way.
+*/
+int
+hdf_read_catalog(NC *handle)
+{
+    uint8      *buf  = NULL;
+    NC_dim    **dims = NULL;
+    NC_var    **vars = NULL;
+    NC_array   *dim_array = NULL, *attr_array = NULL, *var_array = NULL;
+    sdcat_cur_t cur;
+    int32       len, ndds, cur_ndds, vgid;
+    uint32      checksum, cur_checksum, machine, numrecs, ndims = 0, nvars = 0, i;
+    uint16      version, pad;
+    int         ret_value = SUCCEED;
+
+    if (HDcheck_tagref(handle->hdf_file, DFTAG_SDCAT, SDCAT_REF) != 1)
+        HGOTO_DONE(FAIL);
+
+    /* Whether or not it can be used, keep the catalog up to date from now on */
+    handle->catalog = NC_CATALOG_KEEP;
+
+    if ((len = Hlength(handle->hdf_file, DFTAG_SDCAT, SDCAT_REF)) < SDCAT_HDRSIZE)
+        HGOTO_DONE(FAIL);
+    if (NULL == (buf = malloc((size_t)len)))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if (Hgetelement(handle->hdf_file, DFTAG_SDCAT, SDCAT_REF, buf) != len)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+    /* Check that the catalog is for this library and this file as it is now */
+    cur.p   = buf + 4;
+    cur.end = buf + len;
+    if (memcmp(buf, "SDCT", 4) != 0 || sdcat_get_u16(&cur, &version) == FAIL || version != SDCAT_VERSION ||
+        sdcat_get_u16(&cur, &pad) == FAIL || sdcat_get_u32(&cur, &machine) == FAIL ||
+        machine != (uint32)DF_MT || sdcat_get_i32(&cur, &ndds) == FAIL ||
+        sdcat_get_u32(&cur, &checksum) == FAIL)
+        HGOTO_DONE(FAIL);
+    if (HDdd_checksum(handle->hdf_file, DFTAG_SDCAT, &cur_ndds, &cur_checksum) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (ndds != cur_ndds || checksum != cur_checksum)
+        HGOTO_DONE(FAIL);
+    if (sdcat_get_u32(&cur, &numrecs) == FAIL || sdcat_get_i32(&cur, &vgid) == FAIL)
+        HGOTO_DONE(FAIL);
+
+    /* Dimensions */
+    if (sdcat_get_u32(&cur, &ndims) == FAIL || ndims > (uint32)(cur.end - cur.p) / 20) {
+        ndims = 0;
+        HGOTO_DONE(FAIL);
+    }
+    if (NULL == (dims = calloc(ndims + 1, sizeof(NC_dim *))))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < ndims; i++) {
+        char *name;
+        int32 size, dim00_compat, dim_vgid, count;
+
+        if (NULL == (name = sdcat_get_name(&cur)))
+            HGOTO_DONE(FAIL);
+        if (sdcat_get_i32(&cur, &size) == FAIL || sdcat_get_i32(&cur, &dim00_compat) == FAIL ||
+            sdcat_get_i32(&cur, &dim_vgid) == FAIL || sdcat_get_i32(&cur, &count) == FAIL) {
+            free(name);
+            HGOTO_DONE(FAIL);
+        }
+        dims[i] = NC_new_dim(name, size);
+        free(name);
+        if (dims[i] == NULL)
+            HGOTO_DONE(FAIL);
+        dims[i]->dim00_compat = dim00_compat;
+        dims[i]->vgid         = dim_vgid;
+        dims[i]->count        = count;
+    }
+
+    /* Global attributes */
+    if (sdcat_get_attrs(&cur, &attr_array) == FAIL)
+        HGOTO_DONE(FAIL);
+
+    /* Variables */
+    if (sdcat_get_u32(&cur, &nvars) == FAIL || nvars > (uint32)(cur.end - cur.p) / 60) {
+        nvars = 0;
+        HGOTO_DONE(FAIL);
+    }
+    if (NULL == (vars = calloc(nvars + 1, sizeof(NC_var *))))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < nvars; i++) {
+        NC_var *vp;
+        char   *name;
+        int    *dimids = NULL;
+        int32   type, rank, reclen, val;
+        uint16  data_ref, data_tag, ndg_ref;
+        int32   r;
+
+        if (NULL == (name = sdcat_get_name(&cur)))
+            HGOTO_DONE(FAIL);
+        if (sdcat_get_i32(&cur, &type) == FAIL || sdcat_get_i32(&cur, &rank) == FAIL || rank < 0 ||
+            rank > (cur.end - cur.p) / 4 || NULL == (dimids = malloc(((size_t)rank + 1) * sizeof(int)))) {
+            free(name);
+            HGOTO_DONE(FAIL);
+        }
+        for (r = 0; r < rank; r++) {
+            sdcat_get_i32(&cur, &val); /* can't fail, see above */
+            if (val < 0 || (uint32)val >= ndims)
+                break;
+            dimids[r] = (int)val;
+        }
+        vars[i] = (r == rank) ? NC_new_var(name, (nc_type)type, (int)rank, dimids) : NULL;
+        free(name);
+        free(dimids);
+        if (NULL == (vp = vars[i]))
+            HGOTO_DONE(FAIL);
+
+        vp->cdf = handle;
+        if (sdcat_get_i32(&cur, &vp->vgid) == FAIL || sdcat_get_u16(&cur, &data_ref) == FAIL ||
+            sdcat_get_u16(&cur, &data_tag) == FAIL || sdcat_get_u16(&cur, &ndg_ref) == FAIL ||
+            sdcat_get_u16(&cur, &pad) == FAIL || sdcat_get_i32(&cur, &val) == FAIL)
+            HGOTO_DONE(FAIL);
+        vp->data_ref = data_ref;
+        vp->data_tag = data_tag;
+        vp->ndg_ref  = ndg_ref;
+        vp->var_type = (hdf_vartype_t)val;
+        if (sdcat_get_i32(&cur, &val) == FAIL)
+            HGOTO_DONE(FAIL);
+        vp->data_offset = (int)val;
+        if (sdcat_get_i32(&cur, &vp->block_size) == FAIL || sdcat_get_i32(&cur, &val) == FAIL)
+            HGOTO_DONE(FAIL);
+        vp->numrecs = (int)val;
+        if (sdcat_get_i32(&cur, &vp->HDFtype) == FAIL || sdcat_get_i32(&cur, &vp->HDFsize) == FAIL ||
+            sdcat_get_i32(&cur, &vp->is_ragged) == FAIL || sdcat_get_i32(&cur, &reclen) == FAIL)
+            HGOTO_DONE(FAIL);
+
+        /* Records may have been added without any DD changing */
+        if (reclen != -1 && Hlength(handle->hdf_file, vp->data_tag, vp->data_ref) != reclen)
+            HGOTO_DONE(FAIL);
+
+        if (sdcat_get_attrs(&cur, &vp->attrs) == FAIL)
+            HGOTO_DONE(FAIL);
+    }
+
+    if (cur.p != cur.end)
+        HGOTO_DONE(FAIL);
+
+    /* Hand everything over to the handle */
+    if (ndims > 0) {
+        if (NULL == (dim_array = NC_new_array(NC_DIMENSION, (unsigned)ndims, (uint8_t *)dims)))
+            HGOTO_DONE(FAIL);
+        ndims = 0; /* the array owns them now */
+    }
+    if (nvars > 0) {
+        if (NULL == (var_array = NC_new_array(NC_VARIABLE, (unsigned)nvars, (uint8_t *)vars)))
+            HGOTO_DONE(FAIL);
+        nvars = 0;
+    }
+
+    handle->dims    = dim_array;
+    handle->attrs   = attr_array;
+    handle->vars    = var_array;
+    handle->numrecs = numrecs;
+    handle->vgid    = vgid;
+
+done:
+    if (ret_value == FAIL) {
+        NC_free_array(dim_array);
+        NC_free_array(attr_array);
+        NC_free_array(var_array);
+    }
+    for (i = 0; dims != NULL && i < ndims; i++)
+        if (dims[i] != NULL) {
+            dims[i]->count = 1;
+            NC_free_dim(dims[i]);
+        }
+    for (i = 0; vars != NULL && i < nvars; i++)
+        NC_free_var(vars[i]);
+    free(dims);
+    free(vars);
+    free(buf);
+
+    return ret_value;
+} /* hdf_read_catalog */
+
+/* ------------------------- hdf_write_catalog ---------------------------- */
+/*
+  Bring the SD catalog of an HDF file up to date.  Called when a writable
+  file is closed, after everything else has been written.  If the catalog
+  is not wanted, any catalog the file has is deleted.
+*/
+int
+hdf_write_catalog(NC *handle)
+{
+    NC         *cat = NULL;
+    sdcat_buf_t b   = {NULL, 0, 0};
+    NC_dim     *dim;
+    uint8      *p;
+    int32       ndds;
+    uint32      checksum;
+    unsigned    ndims, nvars, i, r;
+    int         exists;
+    int         ret_value = SUCCEED;
+
+    if ((exists = HDcheck_tagref(handle->hdf_file, DFTAG_SDCAT, SDCAT_REF)) == -1)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (exists == 0 && handle->catalog == NC_CATALOG_NONE)
+        HGOTO_DONE(SUCCEED);
+
+    if (NULL == (cat = calloc(1, sizeof(NC))))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    cat->flags     = NC_NOWRITE;
+    cat->xdrs      = handle->xdrs;
+    cat->file_type = HDF_FILE;
+    cat->hdf_file  = handle->hdf_file;
+    cat->hdf_mode  = handle->hdf_mode;
+    strcpy(cat->path, handle->path);
+
+    /*
+     * If the SD interface changed nothing, a catalog that is still up to
+     * date is kept as it is, rather than rewritten on every close.
+     */
+    if (exists == 1 && handle->catalog == NC_CATALOG_KEEP && !(handle->flags & (NC_HDIRTY | NC_NDIRTY)) &&
+        hdf_read_catalog(cat) == SUCCEED)
+        HGOTO_DONE(SUCCEED);
+
+    /* Whatever the file has is out of date by now */
+    if (exists == 1 && Hdeldd(handle->hdf_file, DFTAG_SDCAT, SDCAT_REF) == FAIL)
+        HGOTO_ERROR(DFE_CANTDELDD, FAIL);
+    if (handle->catalog == NC_CATALOG_NONE)
+        HGOTO_DONE(SUCCEED);
+
+    /*
+     * Read the metadata back the same way opening the file does, so that
+     * the catalog holds exactly what the next open would build.
+     */
+    if (hdf_read_xdr_cdf(cat->xdrs, &cat) == FAIL && hdf_read_sds_cdf(cat->xdrs, &cat) == FAIL)
+        HGOTO_ERROR(DFE_BADNDG, FAIL);
+
+    if (HDdd_checksum(handle->hdf_file, DFTAG_SDCAT, &ndds, &checksum) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+    if (NULL == (p = sdcat_reserve(&b, SDCAT_HDRSIZE)))
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    memcpy(p, "SDCT", 4);
+    p += 4;
+    UINT16ENCODE(p, SDCAT_VERSION);
+    UINT16ENCODE(p, 0);
+    UINT32ENCODE(p, (uint32)DF_MT);
+    INT32ENCODE(p, ndds);
+    UINT32ENCODE(p, checksum);
+    UINT32ENCODE(p, (uint32)cat->numrecs);
+    INT32ENCODE(p, cat->vgid);
+
+    /* Dimensions */
+    ndims = (cat->dims != NULL) ? cat->dims->count : 0;
+    if (sdcat_put_u32(&b, (uint32)ndims) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < ndims; i++) {
+        dim = NC_array_elem(cat->dims, i);
+        if (sdcat_put_name(&b, dim->name) == FAIL || sdcat_put_u32(&b, (uint32)dim->size) == FAIL ||
+            sdcat_put_u32(&b, (uint32)dim->dim00_compat) == FAIL ||
+            sdcat_put_u32(&b, (uint32)dim->vgid) == FAIL || sdcat_put_u32(&b, (uint32)dim->count) == FAIL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    }
+
+    /* Global attributes */
+    if (sdcat_put_attrs(&b, cat->attrs) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* Variables */
+    nvars = (cat->vars != NULL) ? cat->vars->count : 0;
+    if (sdcat_put_u32(&b, (uint32)nvars) == FAIL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < nvars; i++) {
+        NC_var *vp     = NC_array_elem(cat->vars, i);
+        int32   reclen = -1;
+
+        /* Length of the data of a record variable */
+        if (vp->data_ref != 0 && vp->assoc->count > 0 && ndims > 0 &&
+            ((NC_dim *)NC_array_elem(cat->dims, (unsigned)vp->assoc->values[0]))->size == NC_UNLIMITED)
+            reclen = Hlength(handle->hdf_file, vp->data_tag, vp->data_ref);
+
+        if (sdcat_put_name(&b, vp->name) == FAIL || sdcat_put_u32(&b, (uint32)vp->type) == FAIL ||
+            sdcat_put_u32(&b, (uint32)vp->assoc->count) == FAIL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        for (r = 0; r < vp->assoc->count; r++)
+            if (sdcat_put_u32(&b, (uint32)vp->assoc->values[r]) == FAIL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        if (sdcat_put_u32(&b, (uint32)vp->vgid) == FAIL || sdcat_put_u16(&b, vp->data_ref) == FAIL ||
+            sdcat_put_u16(&b, vp->data_tag) == FAIL || sdcat_put_u16(&b, vp->ndg_ref) == FAIL ||
+            sdcat_put_u16(&b, 0) == FAIL || sdcat_put_u32(&b, (uint32)vp->var_type) == FAIL ||
+            sdcat_put_u32(&b, (uint32)vp->data_offset) == FAIL ||
+            sdcat_put_u32(&b, (uint32)vp->block_size) == FAIL ||
+            sdcat_put_u32(&b, (uint32)vp->numrecs) == FAIL ||
+            sdcat_put_u32(&b, (uint32)vp->HDFtype) == FAIL ||
+            sdcat_put_u32(&b, (uint32)vp->HDFsize) == FAIL ||
+            sdcat_put_u32(&b, (uint32)vp->is_ragged) == FAIL || sdcat_put_u32(&b, (uint32)reclen) == FAIL ||
+            sdcat_put_attrs(&b, vp->attrs) == FAIL)
+            HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    }
+
+    if (Hputelement(handle->hdf_file, DFTAG_SDCAT, SDCAT_REF, b.buf, (int32)b.len) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+done:
+    if (cat != NULL) {
+        NC_free_xcdf(cat);
+        free(cat);
+    }
+    free(b.buf);
+
+    return ret_value;
+} /* hdf_write_catalog */
+
 /*******************************************************************************/
 
 /*
@@ -72,6 +72,8 @@ done:
 int
 ncdimdef(int cdfid, const char *name, long size)
 {
+    H4_API_ENTER;
+
     NC      *handle;
     NC_dim  *dim[1];
     NC_dim **dp;
@@ -149,6 +151,8 @@ NC_dimid(NC *handle, char *name)
 int
 ncdimid(int cdfid, const char *name)
 {
+    H4_API_ENTER;
+
     NC      *handle;
     NC_dim **dp;
     size_t   len;
@@ -173,6 +177,8 @@ ncdimid(int cdfid, const char *name)
 int
 ncdiminq(int cdfid, int dimid, char *name, long *sizep)
 {
+    H4_API_ENTER;
+
     NC      *handle;
     NC_dim **dp;
 
@@ -205,6 +211,8 @@ ncdiminq(int cdfid, int dimid, char *name, long *sizep)
 int
 ncdimrename(int cdfid, int dimid, const char *newname)
 {
+    H4_API_ENTER;
+
     NC        *handle;
     NC_dim   **dp;
     NC_string *old, *new;
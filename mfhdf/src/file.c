@@ -298,6 +298,8 @@ int
 nccreate(const char *path, int cmode)
 /* path - file name */
 {
+    H4_API_ENTER;
+
     cdf_routine_name = "nccreate";
 
     if (cmode & NC_CREAT) {
@@ -311,6 +313,8 @@ int
 ncopen(const char *path, int mode)
 /* path - file name */
 {
+    H4_API_ENTER;
+
     cdf_routine_name = "ncopen";
     if (mode & NC_CREAT) {
         NCadvise(NC_EINVAL, "Bad Flag");
@@ -322,6 +326,8 @@ ncopen(const char *path, int mode)
 int
 ncsync(int cdfid)
 {
+    H4_API_ENTER;
+
     NC *handle;
 
     cdf_routine_name = "ncsync";
@@ -380,6 +386,8 @@ ncsync(int cdfid)
 int
 ncabort(int cdfid)
 {
+    H4_API_ENTER;
+
     NC      *handle;
     char     path[FILENAME_MAX + 1];
     unsigned flags;
@@ -461,6 +469,8 @@ ncabort(int cdfid)
 int
 ncnobuf(int cdfid)
 {
+    H4_API_ENTER;
+
     NC *handle;
 
     cdf_routine_name = "ncnobuf";
@@ -543,6 +553,8 @@ NCtempname(const char *proto)
 int
 ncredef(int cdfid)
 {
+    H4_API_ENTER;
+
     NC *handle;
     NC *new;
     int   id;
@@ -861,6 +873,8 @@ done:
 int
 ncendef(int cdfid)
 {
+    H4_API_ENTER;
+
     NC *handle;
 
     cdf_routine_name = "ncendef";
@@ -879,6 +893,8 @@ ncendef(int cdfid)
 int
 ncclose(int cdfid)
 {
+    H4_API_ENTER;
+
     NC *handle;
 
     cdf_routine_name = "ncclose";
@@ -904,9 +920,14 @@ ncclose(int cdfid)
         }
     }
 
-    if (handle->file_type == HDF_FILE)
+    if (handle->file_type == HDF_FILE) {
         hdf_close(handle);
 
+        /* the catalog is only a cache, the file is fine without it */
+        if (handle->flags & NC_RDWR)
+            (void)hdf_write_catalog(handle);
+    }
+
     NC_free_cdf(handle); /* calls fclose */
 
     _cdfs[cdfid] = NULL; /* reset pointer */
@@ -924,6 +945,8 @@ ncclose(int cdfid)
 int
 ncsetfill(int id, int fillmode)
 {
+    H4_API_ENTER;
+
     NC *handle;
     int ret = 0;
 
@@ -978,6 +1001,41 @@ ncsetfill(int id, int fillmode)
     return ret;
 }
 
+/*
+ * Set the size and number of pages of the read/write cache used for a
+ * classic netCDF file. A value of 0 keeps the current setting.
+ *
+ * This has no effect on HDF files, which do their own I/O.
+ */
+int
+ncsetcache(int cdfid, long pagesize, int npages)
+{
+    H4_API_ENTER;
+
+    NC *handle;
+
+    cdf_routine_name = "ncsetcache";
+
+    handle = NC_check_id(cdfid);
+    if (handle == NULL)
+        return -1;
+
+    if (pagesize < 0 || pagesize > INT_MAX || npages < 0) {
+        NCadvise(NC_EINVAL, "Bad cache size");
+        return -1;
+    }
+
+    if (handle->file_type != netCDF_FILE)
+        return 0;
+
+    if (h4_xdr_setcache(handle->xdrs, (int)pagesize, npages) < 0) {
+        nc_serror("ncsetcache");
+        return -1;
+    }
+
+    return 0;
+}
+
 int
 NCxdrfile_sync(XDR *xdrs)
 {
@@ -40,4 +40,4 @@ int ncopts = (NC_FATAL | NC_VERBOSE);
  *    Set to the the name of the current interface routine by the
  * interface routine.
  */
-const char *cdf_routine_name = "netcdf";
+H4_THREAD_LOCAL const char *cdf_routine_name = "netcdf";
@@ -132,8 +132,8 @@ h4_xdr_u_int(XDR *xdrs, unsigned *up)
 bool_t
 h4_xdr_opaque(XDR *xdrs, char *cp, unsigned cnt)
 {
-    unsigned   rndup;
-    static int crud[BYTES_PER_XDR_UNIT];
+    unsigned                   rndup;
+    static H4_THREAD_LOCAL int crud[BYTES_PER_XDR_UNIT];
 
     /*
      * if no data we are done
@@ -316,24 +316,40 @@ h4_xdr_double(XDR *xdrs, double *dp)
 /* I/O Buffer Functionality */
 /****************************/
 
-/* As an optimization, the XDR I/O layer uses a single I/O buffer to
- * speed up nearby reads and writes ("bio" == Buffered I/O).
+/* As an optimization, the XDR I/O layer buffers file I/O through a small
+ * cache of fixed-size pages ("bio" == Buffered I/O).
  *
- * TODO: This is not a very big cache! Bumping it might enhance I/O
- *       performance.
+ * The pages are kept on a least-recently-used list, so access patterns that
+ * alternate between a few regions of the file (e.g., interleaved reads of
+ * two variables) find their pages still resident instead of going back to
+ * the file each time. The page size and the number of pages can be changed
+ * for each stream with h4_xdr_setcache().
  */
 
-/* Size of the I/O buffer in bytes */
+/* Default size of an I/O page in bytes */
 #define BIOBUFSIZ 8192
 
-/* # of valid bytes in the buffer */
-#define CNT(p) ((p)->ptr - (p)->base)
+/* Default number of pages in the I/O cache */
+#define BIONPAGES 8
 
-/* # of unread bytes in buffer */
-#define REM(p) ((p)->cnt - CNT(p))
+/* # of valid bytes in the current page */
+#define CNT(p) ((int)((p)->ptr - (p)->cur->base))
 
-/* Available space for write in buffer */
-#define BREM(p) (BIOBUFSIZ - CNT(p))
+/* # of unread bytes in the current page */
+#define REM(p) ((p)->cur->cnt - CNT(p))
+
+/* Available space for write in the current page */
+#define BREM(p) ((p)->pagesize - CNT(p))
+
+/* A single page of the I/O cache */
+typedef struct biopage {
+    off_t           page;    /* Page number in the file, -1 if unused */
+    int             cnt;     /* Number of valid bytes in the page */
+    int             isdirty; /* Dirty page flag */
+    struct biopage *prev;    /* Next more recently used page */
+    struct biopage *next;    /* Next less recently used page */
+    uint8_t        *base;    /* Page data */
+} biopage;
 
 /* POSIX and I/O buffer info
  *
@@ -343,22 +359,78 @@ h4_xdr_double(XDR *xdrs, double *dp)
  *       HDF4 files are limited to 4 GB.
  */
 typedef struct biobuf {
-    int      fd;              /* POSIX file descriptor */
-    int      mode;            /* File access mode, O_RDONLY, etc */
-    int      isdirty;         /* Dirty buffer flag */
-    off_t    page;            /* Location in the file */
-    int      nread;           /* Number of bytes successfully read */
-    int      nwrote;          /* Number of bytes last written */
-    int      cnt;             /* Number of valid bytes in buffer */
-    uint8_t *ptr;             /* Next byte (pointer into base) */
-    uint8_t  base[BIOBUFSIZ]; /* Data buffer */
+    int      fd;       /* POSIX file descriptor */
+    int      mode;     /* File access mode, O_RDONLY, etc */
+    off_t    fpos;     /* Position of fd in the file, -1 if unknown */
+    int      pagesize; /* Size of each page in bytes */
+    int      npages;   /* Number of pages in the cache */
+    biopage *pages;    /* Page descriptors */
+    uint8_t *data;     /* Storage for all the pages */
+    biopage *mru;      /* Most recently used page */
+    biopage *lru;      /* Least recently used page */
+    biopage *cur;      /* Current page */
+    uint8_t *ptr;      /* Next byte (pointer into cur->base) */
 } biobuf;
 
+/*
+ * Allocate the pages of the cache and link them on the LRU list
+ *
+ * The first page is made the current page and holds page 0 of the file
+ * (nothing is read). All other pages are unused.
+ */
+static int
+bio_alloc_pages(biobuf *biop, int pagesize, int npages)
+{
+    biopage *pages = NULL;
+    uint8_t *data  = NULL;
+    int      i;
+
+    if (NULL == (pages = (biopage *)calloc((size_t)npages, sizeof(biopage))))
+        return -1;
+    if (NULL == (data = (uint8_t *)calloc((size_t)npages, (size_t)pagesize))) {
+        free(pages);
+        return -1;
+    }
+
+    for (i = 0; i < npages; i++) {
+        pages[i].page = -1;
+        pages[i].base = data + (size_t)i * (size_t)pagesize;
+        pages[i].prev = (i > 0) ? &pages[i - 1] : NULL;
+        pages[i].next = (i < npages - 1) ? &pages[i + 1] : NULL;
+    }
+    pages[0].page = 0;
+
+    biop->pagesize = pagesize;
+    biop->npages   = npages;
+    biop->pages    = pages;
+    biop->data     = data;
+    biop->mru      = &pages[0];
+    biop->lru      = &pages[npages - 1];
+    biop->cur      = &pages[0];
+    biop->ptr      = pages[0].base;
+
+    return 0;
+}
+
+/*
+ * Release the pages of the cache
+ */
+static void
+bio_free_pages(biobuf *biop)
+{
+    free(biop->data);
+    free(biop->pages);
+    biop->data  = NULL;
+    biop->pages = NULL;
+    biop->mru = biop->lru = biop->cur = NULL;
+    biop->ptr                         = NULL;
+}
+
 /*
  * Initialize the POSIX/buffer XDR state
  */
 static biobuf *
-bio_get_new(int fd, int fmode)
+bio_get_new(int fd, int fmode, int npages)
 {
     biobuf *biop = NULL;
 
@@ -367,84 +439,173 @@ bio_get_new(int fd, int fmode)
 
     biop->fd   = fd;
     biop->mode = fmode;
-    biop->ptr  = biop->base;
+    biop->fpos = -1;
+
+    if (bio_alloc_pages(biop, BIOBUFSIZ, npages) < 0) {
+        free(biop);
+        return NULL;
+    }
 
     return biop;
 }
 
 /*
- * Read a page from the file into the buffer
+ * Move a page to the most recently used end of the LRU list
+ */
+static void
+bio_touch_page(biobuf *biop, biopage *pg)
+{
+    if (biop->mru == pg)
+        return;
+
+    /* Unlink */
+    pg->prev->next = pg->next;
+    if (pg->next != NULL)
+        pg->next->prev = pg->prev;
+    else
+        biop->lru = pg->prev;
+
+    /* Relink at the head */
+    pg->prev        = NULL;
+    pg->next        = biop->mru;
+    biop->mru->prev = pg;
+    biop->mru       = pg;
+}
+
+/*
+ * Position the file descriptor at the start of a page, if it isn't there
+ * already
  */
 static int
-bio_read_page(biobuf *biop)
+bio_seek_page(biobuf *biop, off_t page)
 {
-    /* Clear out the buffer */
-    memset(biop->base, 0, BIOBUFSIZ);
+    off_t offset = page * (off_t)biop->pagesize;
 
-    if (biop->mode & O_WRONLY) {
-        /* If we're only writing, the buffer is empty */
-        biop->cnt = 0;
-    }
-    else {
-        if (biop->nwrote != BIOBUFSIZ) {
-            /* Last write wasn't a full block, adjust position ahead */
-            if (lseek(biop->fd, biop->page * BIOBUFSIZ, SEEK_SET) == ((off_t)-1))
-                return -1;
+    if (biop->fpos != offset) {
+        if (lseek(biop->fd, offset, SEEK_SET) == ((off_t)-1)) {
+            biop->fpos = -1;
+            return -1;
         }
-
-        /* Read from storage into the buffer */
-        biop->nread = biop->cnt = read(biop->fd, (void *)biop->base, BIOBUFSIZ);
+        biop->fpos = offset;
     }
+    return 0;
+}
+
+/*
+ * Write a page from the cache to the file
+ */
+static int
+bio_write_page(biobuf *biop, biopage *pg)
+{
+    ssize_t nwrote = 0;
 
-    biop->ptr = biop->base;
+    if (((biop->mode & O_WRONLY) || (biop->mode & O_RDWR)) && pg->cnt != 0) {
+        if (bio_seek_page(biop, pg->page) < 0)
+            return -1;
+        nwrote = write(biop->fd, (void *)pg->base, (size_t)pg->cnt);
+        if (nwrote < 0) {
+            biop->fpos = -1;
+            return -1;
+        }
+        biop->fpos += nwrote;
+    }
+    pg->isdirty = 0;
 
-    return biop->cnt;
+    /* at most one page */
+    return (int)nwrote;
 }
 
 /*
- * Write a page from the buffer to the file
+ * Read a page from the file into a page of the cache
  */
 static int
-bio_write_page(biobuf *biop)
+bio_read_page(biobuf *biop, biopage *pg, off_t page)
 {
+    ssize_t nread;
+
+    pg->page = page;
 
-    if (!((biop->mode & O_WRONLY) || (biop->mode & O_RDWR)) || biop->cnt == 0) {
-        biop->nwrote = 0;
+    /* Clear out the page */
+    memset(pg->base, 0, (size_t)biop->pagesize);
+
+    if (biop->mode & O_WRONLY) {
+        /* If we're only writing, the page is empty */
+        pg->cnt = 0;
     }
     else {
-        if (biop->nread != 0) {
-            /* If we read something, we have to adjust position back */
-            if (lseek(biop->fd, biop->page * BIOBUFSIZ, SEEK_SET) == ((off_t)-1))
-                return -1;
+        if (bio_seek_page(biop, page) < 0)
+            return -1;
+
+        /* Read from storage into the page */
+        nread = read(biop->fd, (void *)pg->base, (size_t)biop->pagesize);
+        if (nread < 0) {
+            pg->page   = -1;
+            biop->fpos = -1;
+            return -1;
         }
-        biop->nwrote = write(biop->fd, (void *)biop->base, biop->cnt);
+        pg->cnt = (int)nread; /* at most one page */
+        biop->fpos += nread;
     }
-    biop->isdirty = 0;
 
-    return biop->nwrote;
+    return pg->cnt;
 }
 
 /*
- * Get the next page from the file
+ * Flush all the dirty pages in the cache to the file
+ */
+static int
+bio_flush(biobuf *biop)
+{
+    biopage *pg;
+
+    for (pg = biop->mru; pg != NULL; pg = pg->next)
+        if (pg->isdirty && bio_write_page(biop, pg) < 0)
+            return -1;
+
+    return 0;
+}
+
+/*
+ * Make a page of the file the current page
  *
- * Returns the number of valid bytes in the buffer
+ * The page is served from the cache when resident; otherwise the least
+ * recently used page is flushed (if dirty) and reused to read it in.
+ *
+ * Returns the number of valid bytes in the page
  */
 static int
-bio_get_next_page(biobuf *biop)
+bio_load_page(biobuf *biop, off_t page)
 {
-    /* Flush if dirty */
-    if (biop->isdirty) {
-        if (bio_write_page(biop) < 0)
+    biopage *pg;
+
+    for (pg = biop->mru; pg != NULL; pg = pg->next)
+        if (pg->page == page)
+            break;
+
+    if (pg == NULL) {
+        pg = biop->lru;
+        if (pg->isdirty && bio_write_page(biop, pg) < 0)
+            return -1;
+        if (bio_read_page(biop, pg, page) < 0)
             return -1;
     }
 
-    biop->page++;
+    bio_touch_page(biop, pg);
+    biop->cur = pg;
+    biop->ptr = pg->base;
 
-    /* Read in the next page */
-    if (bio_read_page(biop) < 0)
-        return -1;
+    return pg->cnt;
+}
 
-    return biop->cnt;
+/*
+ * Get the next page from the file
+ *
+ * Returns the number of valid bytes in the buffer
+ */
+static int
+bio_get_next_page(biobuf *biop)
+{
+    return bio_load_page(biop, biop->cur->page + 1);
 }
 
 /*
@@ -453,15 +614,15 @@ bio_get_next_page(biobuf *biop)
 static int
 bio_read(biobuf *biop, unsigned char *ptr, int nbytes)
 {
-    int    ngot = 0;
-    size_t rem;
+    int ngot = 0;
+    int rem;
 
     if (nbytes == 0)
         return 0;
 
     while (nbytes > (rem = REM(biop))) {
         if (rem > 0) {
-            (void)memcpy(ptr, biop->ptr, rem);
+            (void)memcpy(ptr, biop->ptr, (size_t)rem);
             ptr += rem;
             nbytes -= rem;
             ngot += rem;
@@ -483,18 +644,18 @@ bio_read(biobuf *biop, unsigned char *ptr, int nbytes)
 static int
 bio_write(biobuf *biop, unsigned char *ptr, int nbytes)
 {
-    size_t rem;
-    int    nwrote = 0;
-    int    cnt;
+    int rem;
+    int nwrote = 0;
+    int cnt;
 
     if (!((biop->mode & O_WRONLY) || (biop->mode & O_RDWR)))
         return -1;
 
     while (nbytes > (rem = BREM(biop))) {
         if (rem > 0) {
-            (void)memcpy(biop->ptr, ptr, rem);
-            biop->isdirty = !0;
-            biop->cnt     = BIOBUFSIZ;
+            (void)memcpy(biop->ptr, ptr, (size_t)rem);
+            biop->cur->isdirty = !0;
+            biop->cur->cnt     = biop->pagesize;
             ptr += rem;
             nbytes -= rem;
             nwrote += rem;
@@ -505,10 +666,10 @@ bio_write(biobuf *biop, unsigned char *ptr, int nbytes)
 
     /* We know nbytes <= BREM at this point */
     (void)memcpy(biop->ptr, ptr, (size_t)nbytes);
-    biop->isdirty = !0;
+    biop->cur->isdirty = !0;
     biop->ptr += nbytes;
-    if ((cnt = CNT(biop)) > biop->cnt)
-        biop->cnt = cnt;
+    if ((cnt = CNT(biop)) > biop->cur->cnt)
+        biop->cur->cnt = cnt;
     nwrote += nbytes;
 
     return nwrote;
@@ -586,7 +747,7 @@ unsigned
 h4_xdr_getpos(XDR *xdrs)
 {
     biobuf *biop = (biobuf *)xdrs->x_private;
-    return BIOBUFSIZ * biop->page + CNT(biop);
+    return (unsigned)((off_t)biop->pagesize * biop->cur->page + CNT(biop));
 }
 
 bool_t
@@ -597,23 +758,14 @@ h4_xdr_setpos(XDR *xdrs, unsigned pos)
         off_t page;
         int   index;
         int   nread;
-        page  = pos / BIOBUFSIZ;
-        index = pos % BIOBUFSIZ;
-        if (page != biop->page) {
-            if (biop->isdirty) {
-                if (bio_write_page(biop) < 0)
-                    return FALSE;
-            }
-            if (page != biop->page + 1)
-                biop->nwrote = 0; /* force seek in bio_read_page */
-
-            biop->page = page;
-
-            nread = bio_read_page(biop);
+        page  = (off_t)(pos / (unsigned)biop->pagesize);
+        index = (int)(pos % (unsigned)biop->pagesize);
+        if (page != biop->cur->page) {
+            nread = bio_load_page(biop, page);
             if (nread < 0 || ((biop->mode & O_RDONLY) && nread < index))
                 return FALSE;
         }
-        biop->ptr = biop->base + index;
+        biop->ptr = biop->cur->base + index;
         return TRUE;
     }
     else
@@ -633,7 +785,8 @@ h4_xdr_setpos(XDR *xdrs, unsigned pos)
 void
 h4_xdr_setup_nofile(XDR *xdrs, int ncop)
 {
-    biobuf *biop = bio_get_new(-1, 0);
+    /* No I/O is done through this stream, so a single page is plenty */
+    biobuf *biop = bio_get_new(-1, 0, 1);
 
     if (ncop & NC_CREAT)
         xdrs->x_op = XDR_ENCODE;
@@ -653,7 +806,7 @@ h4_xdr_setup_nofile(XDR *xdrs, int ncop)
 int
 h4_xdr_create(XDR *xdrs, int fd, int fmode, enum xdr_op op)
 {
-    biobuf *biop    = bio_get_new(fd, fmode);
+    biobuf *biop    = bio_get_new(fd, fmode, BIONPAGES);
     xdrs->x_op      = op;
     xdrs->x_private = biop;
     if (biop == NULL)
@@ -664,29 +817,105 @@ h4_xdr_create(XDR *xdrs, int fd, int fmode, enum xdr_op op)
         return 0;
 
     /* Else, read the first bufferful */
-    return bio_read_page(biop);
+    return bio_read_page(biop, biop->cur, 0);
 }
 
 /*
- * Flush the I/O buffer to the file
+ * Change the page size and number of pages of the I/O cache
+ *
+ * Dirty pages are flushed and the cache is refilled on demand. A value
+ * of 0 for either parameter keeps the current setting.
  */
 int
-h4_xdr_sync(XDR *xdrs)
+h4_xdr_setcache(XDR *xdrs, int pagesize, int npages)
 {
-    biobuf *biop = (biobuf *)xdrs->x_private;
-    if (biop->isdirty) {
-        /* Flush */
-        if (bio_write_page(biop) < 0)
+    biobuf  *biop = (biobuf *)xdrs->x_private;
+    biobuf   save;
+    unsigned pos;
+
+    if (biop == NULL || pagesize < 0 || npages < 0)
+        return -1;
+
+    if (pagesize == 0)
+        pagesize = biop->pagesize;
+    if (npages == 0)
+        npages = biop->npages;
+
+    if (pagesize == biop->pagesize && npages == biop->npages)
+        return 0;
+
+    /* Write out anything that's dirty before dropping the old pages */
+    if (bio_flush(biop) < 0)
+        return -1;
+
+    pos  = h4_xdr_getpos(xdrs);
+    save = *biop;
+    if (bio_alloc_pages(biop, pagesize, npages) < 0) {
+        *biop = save;
+        return -1;
+    }
+    free(save.data);
+    free(save.pages);
+
+    /* Bring the page holding the current position back in */
+    if (biop->fd != -1) {
+        if (bio_read_page(biop, biop->cur, (off_t)(pos / (unsigned)pagesize)) < 0)
             return -1;
     }
+    else
+        biop->cur->page = pos / (unsigned)pagesize;
+    biop->ptr = biop->cur->base + pos % (unsigned)pagesize;
+
+    return 0;
+}
+
+/*
+ * Get the page size and number of pages of the I/O cache
+ */
+int
+h4_xdr_getcache(XDR *xdrs, int *pagesize, int *npages)
+{
+    biobuf *biop = (biobuf *)xdrs->x_private;
 
-    biop->nwrote = 0; /* Force seek in bio_read_page */
+    if (biop == NULL)
+        return -1;
+
+    if (pagesize != NULL)
+        *pagesize = biop->pagesize;
+    if (npages != NULL)
+        *npages = biop->npages;
+
+    return 0;
+}
+
+/*
+ * Flush the I/O buffer to the file
+ *
+ * All cached pages are dropped so that changes made to the file by others
+ * become visible, and the current page is read in again.
+ */
+int
+h4_xdr_sync(XDR *xdrs)
+{
+    biobuf  *biop = (biobuf *)xdrs->x_private;
+    biopage *pg;
+
+    /* Flush */
+    if (bio_flush(biop) < 0)
+        return -1;
+
+    for (pg = biop->mru; pg != NULL; pg = pg->next)
+        if (pg != biop->cur)
+            pg->page = -1;
+
+    biop->fpos = -1; /* Force seek in bio_read_page */
 
     /* Read it in */
-    if (bio_read_page(biop) < 0)
+    if (bio_read_page(biop, biop->cur, biop->cur->page) < 0)
         return -1;
+    biop->ptr = biop->cur->base;
 
-    return biop->cnt;
+    return biop->cur->cnt;
 }
 
 /*
@@ -700,11 +929,10 @@ h4_xdr_destroy(XDR *xdrs)
     /* Flush */
     biobuf *biop = (biobuf *)xdrs->x_private;
     if (biop != NULL) {
-        if (biop->isdirty) {
-            (void)bio_write_page(biop);
-        }
+        (void)bio_flush(biop);
         if (biop->fd != -1)
             (void)close(biop->fd);
+        bio_free_pages(biop);
         free(biop);
     }
 }
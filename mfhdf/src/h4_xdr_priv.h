@@ -112,6 +112,8 @@ HDFLIBAPI bool_t h4_xdr_double(XDR *, double *);
 /* XDR file manipulation */
 HDFLIBAPI int  h4_xdr_create(XDR *xdrs, int fd, int fmode, enum xdr_op op);
 HDFLIBAPI int  h4_xdr_sync(XDR *xdrs);
+HDFLIBAPI int  h4_xdr_setcache(XDR *xdrs, int pagesize, int npages);
+HDFLIBAPI int  h4_xdr_getcache(XDR *xdrs, int *pagesize, int *npages);
 HDFLIBAPI void h4_xdr_destroy(XDR *);
 
 HDFLIBAPI void h4_xdr_setup_nofile(XDR *xdrs, int ncop);
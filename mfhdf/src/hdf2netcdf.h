@@ -66,6 +66,7 @@
 #define ncattdel    HNAME(ncattdel)
 #define nctypelen   HNAME(nctypelen)
 #define ncsetfill   HNAME(ncsetfill)
+#define ncsetcache  HNAME(ncsetcache)
 #define ncrecinq    HNAME(ncrecinq)
 #define ncrecget    HNAME(ncrecget)
 #define ncrecput    HNAME(ncrecput)
@@ -94,6 +94,8 @@ int
 SDgetdatainfo(int32 sdsid, int32 *chk_coord, unsigned start_block, unsigned info_count, int32 *offsetarray,
               int32 *lengtharray)
 {
+    H4_API_ENTER;
+
     NC     *handle;
     NC_var *var;
     int     count     = FAIL; /* number of data blocks */
@@ -185,6 +187,8 @@ done:
 int
 SDgetattdatainfo(int32 id, int32 attrindex, int32 *offset, int32 *length)
 {
+    H4_API_ENTER;
+
     NC     *handle;
     NC_var *var;
     NC_dim *dim;
@@ -478,6 +482,8 @@ get_attr_tag(char *attr_name, uint16 *attr_tag)
 int
 SDgetoldattdatainfo(int32 dim_id, int32 sdsid, char *attr_name, int32 *offset, int32 *length)
 {
+    H4_API_ENTER;
+
     NC     *handle;
     NC_var *var;
     int32   off, len, dim_att_len = 0, sdsluf_len = 0, offp = 0;
@@ -681,6 +687,8 @@ done:
 int
 SDgetanndatainfo(int32 sdsid, ann_type annot_type, unsigned size, int32 *offsetarray, int32 *lengtharray)
 {
+    H4_API_ENTER;
+
     int32  file_id   = FAIL; /* file */
     int32  an_id     = FAIL; /* AN API */
     int32  ann_id    = FAIL; /* annotation ID */
@@ -77,6 +77,12 @@ HDFLIBAPI int SDgetinfo(int32 sdsid, char *name, int32 *rank, int32 *dimsizes, i
 
 HDFLIBAPI int SDreaddata(int32 sdsid, int32 *start, int32 *stride, int32 *end, void *data);
 
+HDFLIBAPI int SDreaddata_multi(int32 sdsid, int32 nsel, int32 start[], int32 stride[], int32 edge[],
+                               void *data[]);
+
+HDFLIBAPI int SDreaddata_async(int32 sdsid, int32 *start, int32 *stride, int32 *edge, void *data,
+                               hdf_asyncfunc_t callback, void *ctx);
+
 HDFLIBAPI uint16 SDgerefnumber(int32 sdsid);
 
 HDFLIBAPI int32 SDnametoindex(int32 fid, const char *name);
@@ -182,6 +188,8 @@ HDFLIBAPI int SDgetdatasize(int32 sdsid, int32 *comp_size, int32 *uncomp_size);
 
 HDFLIBAPI int SDgetfilename(int32 fid, char *filename);
 
+HDFLIBAPI int SDsetcatalog(int32 fid, int flag);
+
 HDFLIBAPI int SDgetnamelen(int32 sdsid, uint16 *name_len);
 
 /*====================== Chunking Routines ================================*/
@@ -378,6 +386,48 @@ HDFLIBAPI int SDreadchunk(int32  sdsid,  /* IN: sds access id */
                           int32 *origin, /* IN: origin of chunk to read */
                           void  *datap /* IN/OUT: buffer for data */);
 
+/******************************************************************************
+ NAME
+     SDreadchunk_raw   -- read the specified chunk as it is stored
+
+ DESCRIPTION
+     Reads the chunk at 'origin' without decompressing it or converting
+     its number type, into 'datap' which holds 'buf_size' bytes.  The
+     compression type and information of the chunk are returned in
+     'comp_type' and 'c_info' when they are not NULL.  With 'datap' NULL
+     only the size of the chunk is returned.
+
+ RETURNS
+        The number of bytes of the chunk, 0 for a chunk that has never
+        been written, or FAIL
+******************************************************************************/
+HDFLIBAPI int32 SDreadchunk_raw(int32         sdsid,     /* IN: sds access id */
+                                int32        *origin,    /* IN: origin of chunk to read */
+                                comp_coder_t *comp_type, /* OUT: compression type of the chunk */
+                                comp_info    *c_info,    /* OUT: compression info of the chunk */
+                                int32         buf_size,  /* IN: size of 'datap' */
+                                void         *datap /* OUT: buffer for the chunk */);
+
+/******************************************************************************
+ NAME
+     SDwritechunk_raw  -- write the specified chunk as it is to be stored
+
+ DESCRIPTION
+     Writes the 'len' bytes at 'datap' as the chunk at 'origin', without
+     compressing them or converting their number type.  They must be a
+     chunk as read by SDreadchunk_raw from a data set with the same number
+     type, chunk sizes and compression; 'comp_type' must be the
+     compression type of the data set.
+
+ RETURNS
+        SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI int SDwritechunk_raw(int32        sdsid,     /* IN: sds access id */
+                               int32       *origin,    /* IN: origin of chunk to write */
+                               comp_coder_t comp_type, /* IN: compression type of the chunk */
+                               int32        len,       /* IN: size of the chunk */
+                               const void  *datap /* IN: buffer for the chunk */);
+
 /******************************************************************************
 NAME
      SDsetchunkcache -- maximum number of chunks to cache
@@ -426,6 +476,52 @@ HDFLIBAPI int SDsetchunkcache(int32 sdsid,    /* IN: sds access id */
                               int32 maxcache, /* IN: max number of chunks to cache */
                               int32 flags /* IN: flags = 0, HDF_CACHEALL */);
 
+/******************************************************************************
+NAME
+     SDsetreadthreads -- decode the chunks of a data set on several threads
+
+DESCRIPTION
+     Reads of a chunked SDS compressed with deflate decode the chunks they
+     need on 'nthreads' threads, putting them in the chunk cache. 0 or 1
+     decode the chunks one at a time, the default.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI int SDsetreadthreads(int32 sdsid, /* IN: sds access id */
+                               int   nthreads /* IN: number of threads, 0 or 1 for none */);
+
+/******************************************************************************
+NAME
+     SDsetwritethreads -- encode the chunks of a data set on several threads
+
+DESCRIPTION
+     Modified chunks of a chunked SDS compressed with deflate are encoded
+     on 'nthreads' threads, several at a time, when they leave the chunk
+     cache and when the SDS is ended. 0 or 1 encode the chunks one at a
+     time, the default.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI int SDsetwritethreads(int32 sdsid, /* IN: sds access id */
+                                int   nthreads /* IN: number of threads, 0 or 1 for none */);
+
+/******************************************************************************
+NAME
+     SDsetchunkcachebudget -- limit the memory used by all chunk caches of a file
+
+DESCRIPTION
+     Limits the number of bytes held by the chunk caches of all the data
+     sets of the file together, 0 meaning no limit. When the limit is
+     reached the least recently used chunk of any data set is dropped.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+HDFLIBAPI int SDsetchunkcachebudget(int32 fid,  /* IN: file ID */
+                                    int32 bytes /* IN: max bytes of cached chunks, 0 for no limit */);
+
 /*
  ** Public functions for getting raw data information - from mfdatainfo.c
  */
@@ -37,6 +37,12 @@ status = SDgetinfo(sdsid, ...);
 
 status = SDreaddata(sdsid, ...);
 
+        --- read many hyperslabs of a data set at once
+status = SDreaddata_multi(sdsid, nsel, start, stride, edge, data);
+
+        --- read a hyperslab in the background and call back when done
+status = SDreaddata_async(sdsid, start, stride, edge, data, callback, ctx);
+
 status = SDgetrange(sdsid, ...);
 
 status = SDend(fid);
@@ -69,6 +75,22 @@ status = SDget_maxopenfiles(&curr_max, &sys_limit);
     --- return the number of files currently being opened.
 num_files = SDget_numopenfiles();
 
+    --- keep a catalog of the file's metadata, for faster opens.
+status = SDsetcatalog(fid, flag);
+
+    --- limit the memory used by the chunk caches of all data sets.
+status = SDsetchunkcachebudget(fid, bytes);
+
+    --- decode the chunks of a compressed data set on several threads.
+status = SDsetreadthreads(sdsid, nthreads);
+
+    --- encode the chunks of a compressed data set on several threads.
+status = SDsetwritethreads(sdsid, nthreads);
+
+    --- copy chunks without decompressing and compressing them again.
+size   = SDreadchunk_raw(sdsid, origin, &comp_type, &c_info, buf_size, buf);
+status = SDwritechunk_raw(sdsid, origin, comp_type, size, buf);
+
     --- get the number of variables in the file having the given name.
 status = SDgetnumvars_byname(fid,...);
 
@@ -87,6 +109,7 @@ NOTE: This file needs to have the comments cleaned up for most of the
 
 #include "mfhdf.h"
 #include "hfile_priv.h"
+#include "hasync_priv.h"
 #include "mf_priv.h"
 
 #ifdef H4_HAVE_LIBSZ /* we have the szip library */
@@ -254,7 +277,7 @@ SDI_can_clobber(const char *name)
 {
     int         res;
     struct stat buf;
-    FILE       *ff;
+    hdf_file_t  ff;
 
     res = stat(name, &buf);
 
@@ -265,7 +288,7 @@ SDI_can_clobber(const char *name)
 
     ff = HI_OPEN(name, DFACC_RDWR);
 
-    if (ff != NULL) {
+    if (!OPENERR(ff)) {
         /* OK to open for write, so OK to clobber it */
         HI_CLOSE(ff);
         return 1;
@@ -290,6 +313,8 @@ int32
 SDstart(const char *name, /* IN: file name to open */
         int32       HDFmode /* IN: access mode to open file with */)
 {
+    H4_API_ENTER;
+
     int   cdfid     = -1;
     int32 fid       = -1;
     int   NCmode    = -1;
@@ -361,6 +386,8 @@ done:
 int
 SDend(int32 id /* IN: file ID of file to close */)
 {
+    H4_API_ENTER;
+
     int cdfid;
     NC *handle    = NULL;
     int ret_value = SUCCEED;
@@ -428,6 +455,8 @@ SDfileinfo(int32  fid,      /* IN:  file ID */
            int32 *datasets, /* OUT: number of datasets in the file */
            int32 *attrs /* OUT: number of global attributes */)
 {
+    H4_API_ENTER;
+
     NC *handle    = NULL;
     int ret_value = SUCCEED;
 
@@ -478,6 +507,8 @@ int32
 SDselect(int32 fid, /* IN: file ID */
          int32 index /* IN: index of dataset to get ID for */)
 {
+    H4_API_ENTER;
+
     NC   *handle = NULL;
     int32 sdsid; /* the id we're gonna build */
     int32 ret_value = FAIL;
@@ -534,6 +565,8 @@ SDgetinfo(int32  sdsid,    /* IN:  dataset ID */
           int32 *nt,       /* OUT: number type of data */
           int32 *nattrs /* OUT: the number of local attributes */)
 {
+    H4_API_ENTER;
+
     int     i;
     NC     *handle    = NULL;
     NC_var *var       = NULL;
@@ -611,6 +644,8 @@ SDreaddata(int32  sdsid,  /* IN:  dataset ID */
            int32 *end,    /* IN:  number of values to read per dimension */
            void  *data /* OUT: data buffer */)
 {
+    H4_API_ENTER_SHARED;
+
     NC          *handle = NULL;
     NC_dim      *dim    = NULL;
     int          varid  = -1;
@@ -650,6 +685,9 @@ SDreaddata(int32  sdsid,  /* IN:  dataset ID */
         dim = SDIget_dim(handle, sdsid);
     }
 
+    /* Readers of different files run in parallel */
+    H4_API_LOCK_FILE(handle->file_type == HDF_FILE ? handle->hdf_file : FAIL);
+
     if (handle->vars == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
 
@@ -754,7 +792,7 @@ SDreaddata(int32  sdsid,  /* IN:  dataset ID */
 done:
     if (ret_value == FAIL) {
         if (var && var->aid != 0 && var->aid != FAIL) {
-            Hendaccess(var->aid);
+            HPendaccess(var->aid);
             var->aid = FAIL;
         }
     }
@@ -762,244 +800,873 @@ done:
     return ret_value;
 } /* SDreaddata */
 
+/* How SDreaddata_multi reads the selections of a data set that is not
+   chunked: selections whose rows are no more than SD_MULTI_GAP bytes apart
+   are read together, in one piece of whole rows, as long as the piece is no
+   larger than SD_MULTI_WASTE times the data they select, or than
+   SD_MULTI_GAP, and no larger than SD_MULTI_MAX bytes */
+#define SD_MULTI_GAP   65536
+#define SD_MULTI_WASTE 4
+#define SD_MULTI_MAX   (8 * 1024 * 1024)
+
+/* A selection of SDreaddata_multi */
+typedef struct {
+    const int32 *start;  /* first point */
+    const int32 *stride; /* distance between points, NULL for 1 */
+    const int32 *edge;   /* number of points */
+    uint8       *data;   /* where they go */
+    int32        first;  /* first row (index along the first dimension) */
+    int32        last;   /* last row */
+    double       nbytes; /* size of the data selected in the file */
+} sd_sel_t;
+
+/* A chunk that a selection of SDreaddata_multi has points in */
+typedef struct {
+    int32 chunk; /* number of the chunk, in the order of the chunk array */
+    int32 sel;   /* the selection */
+} sd_chunksel_t;
+
 /******************************************************************************
  NAME
-    SDnametoindex -- map a dataset name to an index
+    SDIsel_range -- find the points of a selection that are in a range
 
  DESCRIPTION
-    Given a data set name return the index (not ID) of the
-    first data set whose name matches.
-
-    There can be multiple data sets with the same name.  In
-    such a case, we only ever return the index of the first
-    such dataset.
-    Wildcards are not supported
+    Finds which of the 'edge' points start, start + stride, ... along one
+    dimension are between 'lo' and 'lo' + 'n' - 1.
 
  RETURNS
-        Index of a dataset or FAIL
+    TRUE and the numbers of the first and last of them in 'kmin' and
+    'kmax', or FALSE if there are none.
+******************************************************************************/
+static int
+SDIsel_range(int32 start, int32 stride, int32 edge, int32 lo, int32 n, int32 *kmin, int32 *kmax)
+{
+    int32 hi = lo + n - 1;
+
+    if (hi < start)
+        return FALSE;
+    *kmin = (lo <= start) ? 0 : (lo - start + stride - 1) / stride;
+    *kmax = MIN((hi - start) / stride, edge - 1);
+    return *kmin <= *kmax;
+} /* SDIsel_range */
+
+/******************************************************************************
+ NAME
+    SDIcopy_sel -- copy the points of a selection that are in a box
 
+ DESCRIPTION
+    'box' holds, one row after the other, the values of the box of
+    'rank' dimensions starting at 'bstart', of sizes 'bshape'.  Copies
+    those of the points of 'sel' that are in the box to where they go in
+    the buffer of the selection.  Values are 'szof' bytes long.
 ******************************************************************************/
-int32
-SDnametoindex(int32       fid, /* IN: file ID */
-              const char *name /* IN: name of dataset to search for */)
+static void
+SDIcopy_sel(int rank, const int32 *bstart, const int32 *bshape, const uint8 *box, const sd_sel_t *sel,
+            size_t szof)
 {
-    size_t   len;
-    NC      *handle    = NULL;
-    NC_var **dp        = NULL;
-    int32    ret_value = FAIL;
+    int32  kmin[H4_MAX_VAR_DIMS], kmax[H4_MAX_VAR_DIMS], k[H4_MAX_VAR_DIMS];
+    int32  step[H4_MAX_VAR_DIMS];
+    size_t bsize[H4_MAX_VAR_DIMS], osize[H4_MAX_VAR_DIMS];
+    size_t boff, ooff;
+    int32  n, i;
+    int    last = rank - 1;
+    int    d;
+
+    for (d = 0; d < rank; d++) {
+        step[d] = sel->stride ? sel->stride[d] : 1;
+        if (!SDIsel_range(sel->start[d], step[d], sel->edge[d], bstart[d], bshape[d], &kmin[d], &kmax[d]))
+            return;
+        k[d] = kmin[d];
+    }
+
+    /* number of values between one index and the next, in the box and in the selection */
+    bsize[last] = osize[last] = 1;
+    for (d = last - 1; d >= 0; d--) {
+        bsize[d] = bsize[d + 1] * (size_t)bshape[d + 1];
+        osize[d] = osize[d + 1] * (size_t)sel->edge[d + 1];
+    }
+
+    /* copy the points one row at a time */
+    n = kmax[last] - kmin[last] + 1;
+    for (;;) {
+        boff = ooff = 0;
+        for (d = 0; d < rank; d++) {
+            boff += (size_t)(sel->start[d] + k[d] * step[d] - bstart[d]) * bsize[d];
+            ooff += (size_t)k[d] * osize[d];
+        }
+        if (step[last] == 1)
+            memcpy(sel->data + ooff * szof, box + boff * szof, (size_t)n * szof);
+        else
+            for (i = 0; i < n; i++)
+                memcpy(sel->data + (ooff + (size_t)i) * szof,
+                       box + (boff + (size_t)i * (size_t)step[last]) * szof, szof);
 
-    /* check that fid is valid */
-    handle = SDIhandle_from_id(fid, CDFTYPE);
-    if (handle == NULL) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
+        for (d = last - 1; d >= 0; d--) {
+            if (++k[d] <= kmax[d])
+                break;
+            k[d] = kmin[d];
+        }
+        if (d < 0)
+            break;
     }
+} /* SDIcopy_sel */
 
-    if (handle->vars == NULL) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
+/******************************************************************************
+ NAME
+    SDIread_sel -- read one selection the way SDreaddata does
+******************************************************************************/
+static int
+SDIread_sel(NC *handle, int varid, int rank, const sd_sel_t *sel)
+{
+    long Start[H4_MAX_VAR_DIMS];
+    long Edge[H4_MAX_VAR_DIMS];
+    long Stride[H4_MAX_VAR_DIMS];
+    int  d;
 
-    len = strlen(name);
-    dp  = (NC_var **)handle->vars->values;
-    for (unsigned ii = 0; ii < handle->vars->count; ii++, dp++) {
-        if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, strlen(name)) == 0) {
-            HGOTO_DONE((int32)ii);
-        }
+    for (d = 0; d < rank; d++) {
+        Start[d] = (long)sel->start[d];
+        Edge[d]  = (long)sel->edge[d];
+        if (sel->stride)
+            Stride[d] = (long)sel->stride[d];
     }
 
-    ret_value = FAIL;
+    if (sel->stride == NULL)
+        return NCvario(handle, varid, Start, Edge, sel->data) == -1 ? FAIL : SUCCEED;
+    else
+        return NCgenio(handle, varid, Start, Edge, Stride, NULL, sel->data) == -1 ? FAIL : SUCCEED;
+} /* SDIread_sel */
 
-done:
-    return ret_value;
-} /* SDnametoindex */
+/* Order of the selections of a data set that is not chunked: by rows */
+static int
+SDIcompare_sels(const void *a, const void *b)
+{
+    const sd_sel_t *x = (const sd_sel_t *)a;
+    const sd_sel_t *y = (const sd_sel_t *)b;
+
+    if (x->first != y->first)
+        return (x->first < y->first) ? -1 : 1;
+    return (x->last > y->last) - (x->last < y->last);
+} /* SDIcompare_sels */
+
+/* Order of the chunks to read */
+static int
+SDIcompare_chunksels(const void *a, const void *b)
+{
+    const sd_chunksel_t *x = (const sd_chunksel_t *)a;
+    const sd_chunksel_t *y = (const sd_chunksel_t *)b;
+
+    if (x->chunk != y->chunk)
+        return (x->chunk < y->chunk) ? -1 : 1;
+    return (x->sel > y->sel) - (x->sel < y->sel);
+} /* SDIcompare_chunksels */
 
 /******************************************************************************
  NAME
-    SDgetnumvars_byname -- get the number of variables in the file having
-            the given name.
+    SDIread_rows -- read selections of a data set that is not chunked
 
  DESCRIPTION
-    Given a data set name, retrieve the number of variables in the file having
-    the same name.  Sometime, more than one SDS are named 'name' or a
-    dimension of the SDS 'name' is also named 'name.'  The user can use
-    this function to find out how many of those having the same name.
+    Reads the 'nsel' selections of 'sels', sorted by row, of variable
+    'var', whose element is open, in pieces of whole rows (see
+    SD_MULTI_GAP).  A selection that is too far from the others and
+    would need too large a piece is read by itself, as SDreaddata does.
 
  RETURNS
-        SUCCEED / FAIL
-
+    SUCCEED/FAIL
 ******************************************************************************/
-int
-SDgetnumvars_byname(int32       fid,  /* IN: file ID */
-                    const char *name, /* IN: name of dataset to search for */
-                    int32      *n_vars)
+static int
+SDIread_rows(NC *handle, NC_var *var, int varid, sd_sel_t *sels, int32 nsel)
 {
-    size_t   len;
-    int32    count     = 0;
-    NC      *handle    = NULL;
-    NC_var **dp        = NULL;
-    int      ret_value = SUCCEED;
-
-    /* clear error stack */
-    HEclear();
+    int32  rank    = (int32)var->assoc->count;
+    double rowsize = (double)var->dsizes[0]; /* bytes of a row in the file */
+    int32  bstart[H4_MAX_VAR_DIMS], bshape[H4_MAX_VAR_DIMS];
+    uint8 *raw = NULL;   /* rows as read */
+    uint8 *rows;         /* rows converted */
+    size_t raw_size = 0; /* size of raw */
+    double useful, band, next;
+    int32  nvalues;
+    int32  nbytes;
+    int32  r0, r1;
+    int32  i, j, k;
+    int    d;
+    int    ret_value = SUCCEED;
+
+    for (i = 0; i < nsel; i = j) {
+        /* take in the next selections while reading them together pays */
+        r0     = sels[i].first;
+        r1     = sels[i].last;
+        useful = sels[i].nbytes;
+        for (j = i + 1; j < nsel; j++) {
+            if ((sels[j].first - r1 - 1) * rowsize > SD_MULTI_GAP)
+                break;
+            next = (MAX(r1, sels[j].last) - r0 + 1) * rowsize;
+            if (next > SD_MULTI_MAX || next > MAX(SD_MULTI_GAP, SD_MULTI_WASTE * (useful + sels[j].nbytes)))
+                break;
+            r1 = MAX(r1, sels[j].last);
+            useful += sels[j].nbytes;
+        }
 
-    /* check that fid is valid */
-    handle = SDIhandle_from_id(fid, CDFTYPE);
-    if (handle == NULL) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
+        band = (r1 - r0 + 1) * rowsize;
+        if (band > SD_MULTI_MAX || band > MAX(SD_MULTI_GAP, SD_MULTI_WASTE * useful)) {
+            /* j == i + 1 here */
+            if (SDIread_sel(handle, varid, rank, &sels[i]) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+            continue;
+        }
 
-    if (handle->vars == NULL) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
+        /* read the rows, converting them in place if the sizes allow */
+        nbytes  = (int32)band;
+        nvalues = nbytes / var->HDFsize;
+        if (raw_size < (size_t)nvalues * MAX((size_t)var->HDFsize, var->szof)) {
+            free(raw);
+            raw_size = (size_t)nvalues * MAX((size_t)var->HDFsize, var->szof);
+            if ((raw = (uint8 *)malloc(raw_size)) == NULL)
+                HGOTO_ERROR(DFE_NOSPACE, FAIL);
+        }
+        rows = raw;
+        if (Hseek(var->aid, (int32)(r0 * rowsize) + var->data_offset, DF_START) == FAIL)
+            HGOTO_ERROR(DFE_SEEKERROR, FAIL);
+        if (Hread(var->aid, nbytes, raw) != nbytes)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        if (!DFKiscopyNT(var->HDFtype)) {
+            if ((size_t)var->HDFsize != var->szof) {
+                /* convert into the end of the buffer */
+                rows = raw + raw_size - (size_t)nvalues * var->szof;
+                memmove(raw + raw_size - (size_t)nbytes, raw, (size_t)nbytes);
+                if (DFKconvert(raw + raw_size - (size_t)nbytes, rows, var->HDFtype, nvalues, DFACC_READ, 0,
+                               0) == FAIL)
+                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
+            }
+            else if (DFKconvert(raw, raw, var->HDFtype, nvalues, DFACC_READ, 0, 0) == FAIL)
+                HGOTO_ERROR(DFE_INTERNAL, FAIL);
+        }
 
-    len = strlen(name);
-    dp  = (NC_var **)handle->vars->values;
-    for (unsigned ii = 0; ii < handle->vars->count; ii++, dp++) {
-        if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, strlen(name)) == 0)
-            count++;
+        bstart[0] = r0;
+        bshape[0] = r1 - r0 + 1;
+        for (d = 1; d < rank; d++) {
+            bstart[d] = 0;
+            bshape[d] = (int32)var->shape[d];
+        }
+        for (k = i; k < j; k++)
+            SDIcopy_sel(rank, bstart, bshape, rows, &sels[k], var->szof);
     }
-    *n_vars = count;
 
 done:
+    free(raw);
     return ret_value;
-} /* SDgetnumvars_byname */
+} /* SDIread_rows */
 
 /******************************************************************************
  NAME
-    SDnametoindices -- retrieves a list of variables having the given name.
+    SDIread_chunks -- read selections of a chunked data set
 
  DESCRIPTION
-    Given a data set name, retrieve a list of structures, each of which
-    contains the index of a variable whose name matches the given name, and
-    the type of the variable, which is either data set (IS_SDSVAR) or
-    coordinate variable (IS_CRDVAR,) or (UNKNOWN.)  UNKNOWN is for data
-    created before the fix of a data corruption bug due to the library's
-    inability to distinguish between those two types of variables.  The
-    fix was available starting in HDF4.2r2.
-
-    This API is added to allow the user to examine all the variables having
-    the given name and decide the correct one to gain access on.
+    Finds the chunks that the 'nsel' selections of 'sels' have points in,
+    reads each of them once, in the order of the chunk array, and copies
+    its points to every selection that has some.
 
  RETURNS
-        SUCCEED / FAIL
-
+    SUCCEED/FAIL
 ******************************************************************************/
-int
-SDnametoindices(int32          fid,  /* IN: file ID */
-                const char    *name, /* IN: name of dataset to search for */
-                hdf_varlist_t *var_list)
+static int
+SDIread_chunks(NC_var *var, const int32 *dimsizes, sd_sel_t *sels, int32 nsel)
 {
-    size_t         len;
-    NC            *handle = NULL;
-    NC_var       **dp     = NULL;
-    hdf_varlist_t *varlistp;
-    int32          ret_value = SUCCEED;
+    sp_info_block_t info_block;        /* special info block */
+    sd_chunksel_t  *pairs     = NULL;  /* chunks and the selections with points in them */
+    int32          *cands     = NULL;  /* chunks of a selection along each dimension */
+    uint8          *raw       = NULL;  /* chunk as read */
+    uint8          *chunk     = NULL;  /* chunk converted */
+    size_t          npairs    = 0;     /* number of pairs */
+    size_t          max_pairs = 0;     /* size of pairs */
+    int32           ncand[H4_MAX_VAR_DIMS], cfirst[H4_MAX_VAR_DIMS], c[H4_MAX_VAR_DIMS];
+    int32           nchunks[H4_MAX_VAR_DIMS], cnum[H4_MAX_VAR_DIMS];
+    int32           origin[H4_MAX_VAR_DIMS], bstart[H4_MAX_VAR_DIMS];
+    int32           rank = (int32)var->assoc->count;
+    int32           csize, step, lo, hi, kmin, kmax;
+    int32           i, s, total;
+    size_t          p, q;
+    int             d;
+    int             ret_value = SUCCEED;
 
-    /* clear error stack */
-    HEclear();
+    info_block.cdims = NULL;
+    if (HDget_special_info(var->aid, &info_block) == FAIL || info_block.ndims != rank)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
 
-    /* check that fid is valid */
-    handle = SDIhandle_from_id(fid, CDFTYPE);
-    if (handle == NULL) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
+    csize = 1;
+    for (d = 0; d < rank; d++) {
+        csize *= info_block.cdims[d];
+        nchunks[d] = (dimsizes[d] + info_block.cdims[d] - 1) / info_block.cdims[d];
     }
+    /* chunk numbers, in the order of the chunk array */
+    cnum[rank - 1] = 1;
+    for (d = rank - 2; d >= 0; d--)
+        cnum[d] = cnum[d + 1] * nchunks[d + 1];
 
-    if (handle->vars == NULL) {
-        HGOTO_ERROR(DFE_ARGS, FAIL);
+    total = 0;
+    for (d = 0; d < rank; d++)
+        total += nchunks[d];
+    if ((cands = (int32 *)malloc((size_t)total * sizeof(int32))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* list the chunks each selection has points in */
+    for (s = 0; s < nsel; s++) {
+        for (d = 0, total = 0; d < rank; d++) {
+            step      = sels[s].stride ? sels[s].stride[d] : 1;
+            lo        = sels[s].start[d] / info_block.cdims[d];
+            hi        = (sels[s].start[d] + (sels[s].edge[d] - 1) * step) / info_block.cdims[d];
+            cfirst[d] = total;
+            for (i = lo; i <= hi; i++)
+                if (SDIsel_range(sels[s].start[d], step, sels[s].edge[d], i * info_block.cdims[d],
+                                 info_block.cdims[d], &kmin, &kmax))
+                    cands[total++] = i;
+            ncand[d] = total - cfirst[d];
+            c[d]     = 0;
+        }
+
+        for (;;) {
+            if (npairs == max_pairs) {
+                sd_chunksel_t *tmp;
+
+                max_pairs = MAX(2 * max_pairs, 64);
+                if ((tmp = (sd_chunksel_t *)realloc(pairs, max_pairs * sizeof(sd_chunksel_t))) == NULL)
+                    HGOTO_ERROR(DFE_NOSPACE, FAIL);
+                pairs = tmp;
+            }
+            pairs[npairs].chunk = 0;
+            for (d = 0; d < rank; d++)
+                pairs[npairs].chunk += cands[cfirst[d] + c[d]] * cnum[d];
+            pairs[npairs++].sel = s;
+
+            for (d = rank - 1; d >= 0; d--) {
+                if (++c[d] < ncand[d])
+                    break;
+                c[d] = 0;
+            }
+            if (d < 0)
+                break;
+        }
     }
 
-    len      = strlen(name);
-    dp       = (NC_var **)handle->vars->values;
-    varlistp = var_list;
-    for (unsigned ii = 0; ii < handle->vars->count; ii++, dp++) {
-        if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, strlen(name)) == 0) {
-            varlistp->var_index = (int32)ii;
-            varlistp->var_type  = (*dp)->var_type;
-            varlistp++;
+    qsort(pairs, npairs, sizeof(sd_chunksel_t), SDIcompare_chunksels);
+
+    if ((raw = (uint8 *)malloc((size_t)csize * (size_t)var->HDFsize)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    if (DFKiscopyNT(var->HDFtype))
+        chunk = raw;
+    else if ((chunk = (uint8 *)malloc((size_t)csize * var->szof)) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+
+    /* each chunk is read once, for all the selections in it */
+    for (p = 0; p < npairs; p = q) {
+        for (d = 0; d < rank; d++) {
+            origin[d] = (pairs[p].chunk / cnum[d]) % nchunks[d];
+            bstart[d] = origin[d] * info_block.cdims[d];
         }
+        if (HMCreadChunk(var->aid, origin, raw) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+        if (chunk != raw && DFKconvert(raw, chunk, var->HDFtype, csize, DFACC_READ, 0, 0) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+        for (q = p; q < npairs && pairs[q].chunk == pairs[p].chunk; q++)
+            SDIcopy_sel(rank, bstart, info_block.cdims, chunk, &sels[pairs[q].sel], var->szof);
     }
 
 done:
+    if (chunk != raw)
+        free(chunk);
+    free(raw);
+    free(cands);
+    free(pairs);
+    free(info_block.cdims);
     return ret_value;
-} /* SDnametoindices */
+} /* SDIread_chunks */
 
 /******************************************************************************
  NAME
-    SDgetrange -- simulate a call to DFSDgetrange
+    SDreaddata_multi -- read several selections of a data set
 
  DESCRIPTION
-    If a "valid_range" attribute is provided return its
-    values in pmax and pmin.  Else if both a "valid max"
-    AND a "valid min" exist return their values in pmax and pmin.
-
-    Arrgghh, in HDF it was assumed that the max and min values
-    were of the same data type as the rest of the data.  So
-    the user would know the amount of storage to send to get
-    back the max and min values.  This is not the case with
-    netCDF.  This routine will only work if they are already
-    the same number types.
+    Reads 'nsel' hyperslabs of the data set 'sdsid' at once, each into a
+    buffer of its own.  Selection i starts at start[i * rank] and has
+    edge[i * rank] values along the first dimension, and so on, where
+    'rank' is the rank of the data set; 'stride' is given the same way,
+    or is NULL for selections without stride.  Its values go to data[i],
+    as SDreaddata would put them.
+
+    The data set is looked up and checked once for all the selections.
+    Those of a chunked data set are sorted by chunk, and each chunk that
+    has values of some of them is read and decoded once.  Those of a data
+    set that is not chunked are sorted by row, and selections close to
+    each other are read with one read of the rows they span, when that
+    does not read much more than they select (see SD_MULTI_GAP).
+
+    Only the data sets of HDF files are read this way; the selections of
+    other data sets, and of data sets that have no data yet, are read one
+    after the other with SDreaddata.
 
  RETURNS
-    On error or missing attributes return FAIL else SUCCEED.
-
+    SUCCEED/FAIL
 ******************************************************************************/
 int
-SDgetrange(int32 sdsid, /* IN:  dataset ID */
-           void *pmax,  /* OUT: valid max */
-           void *pmin /* OUT: valid min */)
+SDreaddata_multi(int32 sdsid,    /* IN:  dataset ID */
+                 int32 nsel,     /* IN:  number of selections */
+                 int32 start[],  /* IN:  coords of the starting point of each selection */
+                 int32 stride[], /* IN:  stride of each selection along each dimension, or NULL */
+                 int32 edge[],   /* IN:  number of values of each selection per dimension */
+                 void *data[] /* OUT: data buffer of each selection */)
 {
-    NC       *handle    = NULL;
-    NC_var   *var       = NULL;
-    NC_attr **attr      = NULL;
-    NC_attr **attr1     = NULL;
-    NC_attr **attr2     = NULL;
-    NC_array *array     = NULL;
-    int       ret_value = SUCCEED;
+    H4_API_ENTER_SHARED;
 
-    /* clear error stack */
+    NC          *handle = NULL;
+    NC_var      *var    = NULL;
+    sd_sel_t    *sels   = NULL;
+    int32        dimsizes[H4_MAX_VAR_DIMS];
+    int32        rank;
+    int32        elem_length;
+    int16        special = 0;
+    int32        status;
+    comp_coder_t comp_type = COMP_CODE_INVALID;
+    uint32       comp_config;
+    int          varid;
+    int32        i;
+    int          d;
+    int          ret_value = SUCCEED;
+
+    /* SD API behavior along an unlimited dimension (see SDreaddata) */
+    cdf_routine_name = "SDreaddata_multi";
+
+    /* Clear error stack */
     HEclear();
 
+    /* Validate arguments */
+    if (nsel < 0 || (nsel > 0 && (start == NULL || edge == NULL || data == NULL)))
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
     handle = SDIhandle_from_id(sdsid, SDSTYPE);
-    if (handle == NULL) {
+    if (handle == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
 
+    /* Readers of different files run in parallel */
+    H4_API_LOCK_FILE(handle->file_type == HDF_FILE ? handle->hdf_file : FAIL);
+
+    if (handle->vars == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
     var = SDIget_var(handle, sdsid);
-    if (var == NULL) {
+    if (var == NULL)
         HGOTO_ERROR(DFE_ARGS, FAIL);
-    }
+    varid = (int)sdsid & 0xffff;
+    rank  = (int32)var->assoc->count;
 
-    attr = (NC_attr **)NC_findattr(&(var->attrs), _HDF_ValidRange);
-    if ((attr != NULL) && ((*attr)->data->type == var->type)) {
-        /* BUG: this may be a pointer to a pointer */
-        array = (NC_array *)(*attr)->data;
-        memcpy(pmin, array->values, array->szof);
-        memcpy(pmax, array->values + array->szof, array->szof);
-    }
-    else {
-        attr1 = (NC_attr **)NC_findattr(&(var->attrs), "valid_max");
-        attr2 = (NC_attr **)NC_findattr(&(var->attrs), "valid_min");
+    if (nsel == 0)
+        HGOTO_DONE(SUCCEED);
 
-        if ((attr1 == NULL) || (attr2 == NULL)) {
-            HGOTO_ERROR(DFE_RANGE, FAIL);
+    /* Must have a decoder to read compressed data */
+    if (handle->file_type == HDF_FILE) {
+        status = HCPgetcomptype(handle->hdf_file, var->data_tag, var->data_ref, &comp_type);
+        if (status != FAIL && comp_type != COMP_CODE_NONE && comp_type != COMP_CODE_INVALID) {
+            HCget_config_info(comp_type, &comp_config);
+            if ((comp_config & COMP_DECODER_ENABLED) == 0)
+                HGOTO_ERROR(DFE_BADCODER, FAIL);
         }
+    }
 
-        if (((*attr1)->HDFtype != var->HDFtype) || ((*attr2)->HDFtype != var->HDFtype)) {
-            HGOTO_ERROR(DFE_RANGE, FAIL);
-        }
+    /* Get ready to read */
+    handle->xdrs->x_op = XDR_DECODE;
 
-        NC_copy_arrayvals((char *)pmax, (*attr1)->data);
-        NC_copy_arrayvals((char *)pmin, (*attr2)->data);
-    }
+    /* the records written so far bound an unlimited dimension */
+    for (d = 0; d < rank; d++)
+        dimsizes[d] = (int32)var->shape[d];
+    if (rank > 0 && var->shape[0] == NC_UNLIMITED)
+        dimsizes[0] = (handle->file_type == HDF_FILE) ? (int32)var->numrecs : (int32)handle->numrecs;
 
-done:
-    return ret_value;
-} /* SDgetrange */
+    /* check the selections */
+    if ((sels = (sd_sel_t *)malloc((size_t)nsel * sizeof(sd_sel_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    for (i = 0; i < nsel; i++) {
+        sels[i].start  = start + i * rank;
+        sels[i].stride = stride ? stride + i * rank : NULL;
+        sels[i].edge   = edge + i * rank;
+        sels[i].data   = (uint8 *)data[i];
+        sels[i].nbytes = (double)var->HDFsize;
+        sels[i].first  = 0;
+        sels[i].last   = 0;
+        if (sels[i].data == NULL)
+            HGOTO_ERROR(DFE_ARGS, FAIL);
+        for (d = 0; d < rank; d++) {
+            int32 step = sels[i].stride ? sels[i].stride[d] : 1;
 
-/* -------------------------- CREATION INTERFACE -------------------------- */
-/*
+            if (sels[i].start[d] < 0 || sels[i].edge[d] <= 0 || step <= 0 ||
+                sels[i].start[d] >= dimsizes[d] ||
+                sels[i].edge[d] - 1 > (dimsizes[d] - 1 - sels[i].start[d]) / step)
+                HGOTO_ERROR(DFE_ARGS, FAIL);
+            sels[i].nbytes *= sels[i].edge[d];
+        }
+        if (rank > 0) {
+            sels[i].first = sels[i].start[0];
+            sels[i].last  = sels[i].first + (sels[i].edge[0] - 1) * (sels[i].stride ? sels[i].stride[0] : 1);
+        }
+    }
 
-        --- create a new data set ---
-sdsid   = SDcreate(fid, name, numbertype, rank, dimsizes);
+    /* the data sets that are read differently are read as SDreaddata does */
+    elem_length = 0;
+    if (handle->file_type == HDF_FILE && rank > 0 &&
+        (var->aid != FAIL || hdf_get_vp_aid(handle, var) != FAIL))
+        if (Hinquire(var->aid, NULL, NULL, NULL, &elem_length, NULL, NULL, NULL, &special) == FAIL)
+            HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (elem_length <= 0) {
+        for (i = 0; i < nsel; i++)
+            if (SDIread_sel(handle, varid, rank, &sels[i]) == FAIL)
+                HGOTO_ERROR(DFE_READERROR, FAIL);
+        HGOTO_DONE(SUCCEED);
+    }
+
+    if (special == SPECIAL_CHUNKED) {
+        if (SDIread_chunks(var, dimsizes, sels, nsel) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+    }
+    else {
+        qsort(sels, (size_t)nsel, sizeof(sd_sel_t), SDIcompare_sels);
+        if (SDIread_rows(handle, var, varid, sels, nsel) == FAIL)
+            HGOTO_ERROR(DFE_READERROR, FAIL);
+    }
+
+done:
+    if (ret_value == FAIL) {
+        if (var && var->aid != 0 && var->aid != FAIL) {
+            HPendaccess(var->aid);
+            var->aid = FAIL;
+        }
+    }
+    free(sels);
+
+    return ret_value;
+} /* SDreaddata_multi */
+
+/* Arguments of a read submitted by SDreaddata_async */
+typedef struct sd_async_read_t {
+    int32 sdsid;
+    int32 start[H4_MAX_VAR_DIMS];
+    int32 stride[H4_MAX_VAR_DIMS];
+    int32 edge[H4_MAX_VAR_DIMS];
+    int   has_stride; /* whether stride was given */
+    void *data;
+} sd_async_read_t;
+
+/* Read submitted by SDreaddata_async */
+static int
+SDIread_async(void *args)
+{
+    sd_async_read_t *rd = (sd_async_read_t *)args;
+
+    return SDreaddata(rd->sdsid, rd->start, rd->has_stride ? rd->stride : NULL, rd->edge, rd->data);
+} /* SDIread_async */
+
+/******************************************************************************
+ NAME
+    SDreaddata_async -- read a hyperslab of a data set in the background
+
+ DESCRIPTION
+    Reads like SDreaddata, then calls callback(sdsid, status, ctx) with
+    what SDreaddata returned; when it is FAIL, the error stack holds the
+    errors of the read while the callback runs.  start, stride and edge
+    are copied, but 'data' must stay valid, and the data set accessible,
+    until the callback is called.
+
+    In the thread-safe library the read, with its decompression and
+    number type conversion, and the callback run on an I/O thread, after
+    the reads of the same file submitted before, while the caller goes
+    on; Hasyncwait waits for them.  Otherwise they run before
+    SDreaddata_async returns.
+
+ RETURNS
+    SUCCEED if the read was submitted, FAIL otherwise
+******************************************************************************/
+int
+SDreaddata_async(int32           sdsid,    /* IN:  dataset ID */
+                 int32          *start,    /* IN:  coords of starting point */
+                 int32          *stride,   /* IN:  stride along each dimension, or NULL */
+                 int32          *edge,     /* IN:  number of values to read per dimension */
+                 void           *data,     /* OUT: data buffer */
+                 hdf_asyncfunc_t callback, /* IN:  called when the read is done */
+                 void           *ctx /* IN:  handed to the callback */)
+{
+    H4_API_ENTER_SHARED;
+
+    NC              *handle = NULL;
+    NC_var          *var    = NULL;
+    sd_async_read_t *rd     = NULL;
+    int32            file_id;
+    unsigned         rank;
+    unsigned         d;
+    int              ret_value = SUCCEED;
+
+    /* Clear error stack */
+    HEclear();
+
+    /* Validate arguments */
+    if (start == NULL || edge == NULL || data == NULL || callback == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* Readers of different files run in parallel */
+    file_id = handle->file_type == HDF_FILE ? handle->hdf_file : FAIL;
+    H4_API_LOCK_FILE(file_id);
+
+    if (handle->vars == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    rank = var->assoc->count;
+
+    if ((rd = (sd_async_read_t *)malloc(sizeof(sd_async_read_t))) == NULL)
+        HGOTO_ERROR(DFE_NOSPACE, FAIL);
+    rd->sdsid      = sdsid;
+    rd->has_stride = stride != NULL;
+    rd->data       = data;
+    for (d = 0; d < rank; d++) {
+        rd->start[d]  = start[d];
+        rd->stride[d] = stride != NULL ? stride[d] : 1;
+        rd->edge[d]   = edge[d];
+    }
+
+    /* HASsubmit frees rd */
+    if (HASsubmit(file_id, sdsid, SDIread_async, rd, callback, ctx) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+
+done:
+    return ret_value;
+} /* SDreaddata_async */
+
+/******************************************************************************
+ NAME
+    SDnametoindex -- map a dataset name to an index
+
+ DESCRIPTION
+    Given a data set name return the index (not ID) of the
+    first data set whose name matches.
+
+    There can be multiple data sets with the same name.  In
+    such a case, we only ever return the index of the first
+    such dataset.
+    Wildcards are not supported
+
+ RETURNS
+        Index of a dataset or FAIL
+
+******************************************************************************/
+int32
+SDnametoindex(int32       fid, /* IN: file ID */
+              const char *name /* IN: name of dataset to search for */)
+{
+    H4_API_ENTER;
+
+    NC   *handle    = NULL;
+    int32 ret_value = FAIL;
+
+    /* check that fid is valid */
+    handle = SDIhandle_from_id(fid, CDFTYPE);
+    if (handle == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    if (handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    /* the first variable with that name */
+    ret_value = (int32)NC_findvar(handle, name, -1);
+
+done:
+    return ret_value;
+} /* SDnametoindex */
+
+/******************************************************************************
+ NAME
+    SDgetnumvars_byname -- get the number of variables in the file having
+            the given name.
+
+ DESCRIPTION
+    Given a data set name, retrieve the number of variables in the file having
+    the same name.  Sometime, more than one SDS are named 'name' or a
+    dimension of the SDS 'name' is also named 'name.'  The user can use
+    this function to find out how many of those having the same name.
+
+ RETURNS
+        SUCCEED / FAIL
+
+******************************************************************************/
+int
+SDgetnumvars_byname(int32       fid,  /* IN: file ID */
+                    const char *name, /* IN: name of dataset to search for */
+                    int32      *n_vars)
+{
+    H4_API_ENTER;
+
+    int32 count     = 0;
+    NC   *handle    = NULL;
+    int   ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check that fid is valid */
+    handle = SDIhandle_from_id(fid, CDFTYPE);
+    if (handle == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    if (handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    for (int ii = NC_findvar(handle, name, -1); ii != -1; ii = NC_findvar(handle, name, ii))
+        count++;
+    *n_vars = count;
+
+done:
+    return ret_value;
+} /* SDgetnumvars_byname */
+
+/******************************************************************************
+ NAME
+    SDnametoindices -- retrieves a list of variables having the given name.
+
+ DESCRIPTION
+    Given a data set name, retrieve a list of structures, each of which
+    contains the index of a variable whose name matches the given name, and
+    the type of the variable, which is either data set (IS_SDSVAR) or
+    coordinate variable (IS_CRDVAR,) or (UNKNOWN.)  UNKNOWN is for data
+    created before the fix of a data corruption bug due to the library's
+    inability to distinguish between those two types of variables.  The
+    fix was available starting in HDF4.2r2.
+
+    This API is added to allow the user to examine all the variables having
+    the given name and decide the correct one to gain access on.
+
+ RETURNS
+        SUCCEED / FAIL
+
+******************************************************************************/
+int
+SDnametoindices(int32          fid,  /* IN: file ID */
+                const char    *name, /* IN: name of dataset to search for */
+                hdf_varlist_t *var_list)
+{
+    H4_API_ENTER;
+
+    NC            *handle = NULL;
+    NC_var       **dp     = NULL;
+    hdf_varlist_t *varlistp;
+    int32          ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check that fid is valid */
+    handle = SDIhandle_from_id(fid, CDFTYPE);
+    if (handle == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    if (handle->vars == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    dp       = (NC_var **)handle->vars->values;
+    varlistp = var_list;
+    for (int ii = NC_findvar(handle, name, -1); ii != -1; ii = NC_findvar(handle, name, ii)) {
+        varlistp->var_index = (int32)ii;
+        varlistp->var_type  = dp[ii]->var_type;
+        varlistp++;
+    }
+
+done:
+    return ret_value;
+} /* SDnametoindices */
+
+/******************************************************************************
+ NAME
+    SDgetrange -- simulate a call to DFSDgetrange
+
+ DESCRIPTION
+    If a "valid_range" attribute is provided return its
+    values in pmax and pmin.  Else if both a "valid max"
+    AND a "valid min" exist return their values in pmax and pmin.
+
+    Arrgghh, in HDF it was assumed that the max and min values
+    were of the same data type as the rest of the data.  So
+    the user would know the amount of storage to send to get
+    back the max and min values.  This is not the case with
+    netCDF.  This routine will only work if they are already
+    the same number types.
+
+ RETURNS
+    On error or missing attributes return FAIL else SUCCEED.
+
+******************************************************************************/
+int
+SDgetrange(int32 sdsid, /* IN:  dataset ID */
+           void *pmax,  /* OUT: valid max */
+           void *pmin /* OUT: valid min */)
+{
+    H4_API_ENTER;
+
+    NC       *handle    = NULL;
+    NC_var   *var       = NULL;
+    NC_attr **attr      = NULL;
+    NC_attr **attr1     = NULL;
+    NC_attr **attr2     = NULL;
+    NC_array *array     = NULL;
+    int       ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL) {
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+    }
+
+    attr = (NC_attr **)NC_findattr(&(var->attrs), _HDF_ValidRange);
+    if ((attr != NULL) && ((*attr)->data->type == var->type)) {
+        /* BUG: this may be a pointer to a pointer */
+        array = (NC_array *)(*attr)->data;
+        memcpy(pmin, array->values, array->szof);
+        memcpy(pmax, array->values + array->szof, array->szof);
+    }
+    else {
+        attr1 = (NC_attr **)NC_findattr(&(var->attrs), "valid_max");
+        attr2 = (NC_attr **)NC_findattr(&(var->attrs), "valid_min");
+
+        if ((attr1 == NULL) || (attr2 == NULL)) {
+            HGOTO_ERROR(DFE_RANGE, FAIL);
+        }
+
+        if (((*attr1)->HDFtype != var->HDFtype) || ((*attr2)->HDFtype != var->HDFtype)) {
+            HGOTO_ERROR(DFE_RANGE, FAIL);
+        }
+
+        NC_copy_arrayvals((char *)pmax, (*attr1)->data);
+        NC_copy_arrayvals((char *)pmin, (*attr2)->data);
+    }
+
+done:
+    return ret_value;
+} /* SDgetrange */
+
+/* -------------------------- CREATION INTERFACE -------------------------- */
+/*
+
+        --- create a new data set ---
+sdsid   = SDcreate(fid, name, numbertype, rank, dimsizes);
 
         --- associate a name with a dimension.  If a prev sdsid is ---
         --- provided then it is assumed that the current dimension is the ---
@@ -1053,6 +1720,8 @@ SDcreate(int32       fid,  /* IN: file ID */
          int32       rank, /* IN: rank of dataset */
          int32      *dimsizes /* IN: array of dimension sizes */)
 {
+    H4_API_ENTER;
+
     int     i;
     NC     *handle = NULL;
     NC_var *var    = NULL;
@@ -1224,6 +1893,8 @@ int32
 SDgetdimid(int32 sdsid, /* IN: dataset ID */
            int   number /* IN: index of dimension, in the SDS, ie. <= rank-1 */)
 {
+    H4_API_ENTER;
+
     NC     *handle = NULL;
     NC_var *var    = NULL;
     int32   id;
@@ -1288,6 +1959,8 @@ int
 SDsetdimname(int32       id, /* IN: dataset ID */
              const char *name /* IN: dimension name */)
 {
+    H4_API_ENTER;
+
     NC        *handle = NULL;
     NC_dim    *dim    = NULL;
     NC_dim   **dp     = NULL;
@@ -1365,6 +2038,8 @@ done:
 int
 SDendaccess(int32 id /* IN: dataset ID */)
 {
+    H4_API_ENTER;
+
     NC   *handle;
     int32 ret_value = SUCCEED;
 
@@ -1480,6 +2155,8 @@ SDsetrange(int32 sdsid, /* IN: dataset ID */
            void *pmax,  /* IN: valid max */
            void *pmin /* IN: valid min */)
 {
+    H4_API_ENTER;
+
     NC     *handle = NULL;
     NC_var *var    = NULL;
     uint8   data[80];
@@ -1620,6 +2297,8 @@ SDsetattr(int32       id,    /* IN: object ID */
           int32       count, /* IN: number of attribute values */
           const void *data /* IN: attribute values */)
 {
+    H4_API_ENTER;
+
     NC_array **ap     = NULL;
     NC        *handle = NULL;
     int        sz;
@@ -1698,6 +2377,8 @@ SDattrinfo(int32  id,    /* IN:  object ID */
            int32 *nt,    /* OUT: attribute number type */
            int32 *count /* OUT: number of attribute values */)
 {
+    H4_API_ENTER;
+
     NC_array  *ap        = NULL;
     NC_array **app       = NULL;
     NC_attr  **atp       = NULL;
@@ -1761,6 +2442,8 @@ SDreadattr(int32 id,    /* IN:  object ID */
            int32 index, /* IN:  attribute index */
            void *buf /* OUT: data buffer  */)
 {
+    H4_API_ENTER;
+
     NC_array  *ap        = NULL;
     NC_array **app       = NULL;
     NC_attr  **atp       = NULL;
@@ -1820,6 +2503,8 @@ SDwritedata(int32  sdsid,  /* IN: dataset ID */
             int32 *end,    /* IN: number of values to write per dimension */
             void  *data /* IN: data buffer */)
 {
+    H4_API_ENTER;
+
     int          varid = -1;
     int32        status;
     comp_coder_t comp_type;
@@ -1993,6 +2678,8 @@ SDsetdatastrs(int32       sdsid, /* IN: dataset ID */
               const char *f,     /* IN: format string ("format") */
               const char *c /* IN: coordsys string ("coordsys") */)
 {
+    H4_API_ENTER;
+
     NC     *handle    = NULL;
     NC_var *var       = NULL;
     int     ret_value = SUCCEED;
@@ -2065,6 +2752,8 @@ SDsetcal(int32   sdsid, /* IN: dataset ID */
          float64 ioffe, /* IN: integer offset error */
          int32   nt /* IN: number type of uncalibrated data */)
 {
+    H4_API_ENTER;
+
     NC     *handle    = NULL;
     NC_var *var       = NULL;
     int     ret_value = SUCCEED;
@@ -2129,6 +2818,8 @@ int
 SDsetfillvalue(int32 sdsid, /* IN: dataset ID */
                void *val /* IN: fillvalue */)
 {
+    H4_API_ENTER;
+
     NC     *handle    = NULL;
     NC_var *var       = NULL;
     int     ret_value = SUCCEED;
@@ -2178,6 +2869,8 @@ int
 SDgetfillvalue(int32 sdsid, /* IN:  dataset ID */
                void *val /* OUT: fillvalue */)
 {
+    H4_API_ENTER;
+
     NC       *handle    = NULL;
     NC_var   *var       = NULL;
     NC_attr **attr      = NULL;
@@ -2237,6 +2930,8 @@ SDgetdatastrs(int32 sdsid, /* IN:  dataset ID */
               char *c,     /* OUT: coordsys string ("coordsys") */
               int   len /* IN:  buffer length */)
 {
+    H4_API_ENTER;
+
     NC       *handle    = NULL;
     NC_var   *var       = NULL;
     NC_attr **attr      = NULL;
@@ -2338,6 +3033,8 @@ SDgetcal(int32    sdsid, /* IN:  dataset ID */
          float64 *ioffe, /* OUT: integer offset error */
          int32   *nt /* OUT: number type of uncalibrated data */)
 {
+    H4_API_ENTER;
+
     NC       *handle    = NULL;
     NC_var   *var       = NULL;
     NC_attr **attr      = NULL;
@@ -2418,52 +3115,51 @@ SDIgetcoordvar(NC     *handle, /* IN: file handle */
                int32   id,     /* IN: dimension ID */
                int32   nt /* IN: number type to use if new variable*/)
 {
-    unsigned   len;
     nc_type    nctype;
     int        dimindex;
+    int        ii;
     NC_string *name      = NULL;
-    NC_var   **dp        = NULL;
+    NC_var    *vp        = NULL;
     NC_var    *var       = NULL;
     int32      ret_value = FAIL;
 
     /* look for a variable with the same name */
     name = dim->name;
-    len  = dim->name->len;
-    dp   = (NC_var **)handle->vars->values;
-    for (unsigned ii = 0; ii < handle->vars->count; ii++, dp++) {
-        /* eliminate vars with rank > 1, coord vars only have rank 1 */
-        if ((*dp)->assoc->count == 1)
-            if (len == (*dp)->name->len && strncmp(name->values, (*dp)->name->values, (size_t)len) == 0)
-                /* only proceed if the file is a netCDF file (bugz 1644)
-                or if this variable is a coordinate var or when
-                the status is unknown due to its being created prior to
-                the fix of bugzilla 624 - BMR 05/14/2007 */
-                if ((handle->file_type != HDF_FILE) || (*dp)->var_type == IS_CRDVAR ||
-                    (*dp)->var_type == UNKNOWN) {
-                    /* see if we need to change the number type */
-                    if ((nt != 0) && (nt != (*dp)->type)) {
-                        if (((*dp)->type = hdf_unmap_type((int)nt)) == FAIL) {
-                            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                        }
+    ii   = name->values != NULL ? NC_findvar(handle, name->values, -1) : -1;
+    for (; ii != -1; ii = NC_findvar(handle, name->values, ii)) {
+        vp = NC_array_elem(handle->vars, (unsigned)ii);
 
-                        (*dp)->HDFtype = nt;
-                        (*dp)->cdf     = handle;
-                        /* don't forget to reset the sizes  */
-                        (*dp)->szof = NC_typelen((*dp)->type);
-                        if (FAIL == ((*dp)->HDFsize = DFKNTsize(nt))) {
-                            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                        }
+        /* eliminate vars with rank > 1, coord vars only have rank 1 */
+        if (vp->assoc->count == 1)
+            /* only proceed if the file is a netCDF file (bugz 1644)
+            or if this variable is a coordinate var or when
+            the status is unknown due to its being created prior to
+            the fix of bugzilla 624 - BMR 05/14/2007 */
+            if ((handle->file_type != HDF_FILE) || vp->var_type == IS_CRDVAR || vp->var_type == UNKNOWN) {
+                /* see if we need to change the number type */
+                if ((nt != 0) && (nt != vp->type)) {
+                    if ((vp->type = hdf_unmap_type((int)nt)) == FAIL) {
+                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+                    }
 
-                        /* recompute all of the shape information */
-                        /* BUG: this may be a memory leak ??? */
-                        if (NC_var_shape((*dp), handle->dims) == -1) {
-                            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                        }
+                    vp->HDFtype = nt;
+                    vp->cdf     = handle;
+                    /* don't forget to reset the sizes  */
+                    vp->szof = NC_typelen(vp->type);
+                    if (FAIL == (vp->HDFsize = DFKNTsize(nt))) {
+                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
                     }
 
-                    /* found it? */
-                    HGOTO_DONE((int32)ii);
+                    /* recompute all of the shape information */
+                    /* BUG: this may be a memory leak ??? */
+                    if (NC_var_shape(vp, handle->dims) == -1) {
+                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+                    }
                 }
+
+                /* found it? */
+                HGOTO_DONE((int32)ii);
+            }
     }
 
     /* create a new var with this dim as only coord */
@@ -2532,6 +3228,8 @@ SDsetdimstrs(int32       id, /* IN: dimension ID */
              const char *u,  /* IN: units string ("units") */
              const char *f /* IN: format string ("format") */)
 {
+    H4_API_ENTER;
+
     int     varid     = -1;
     NC     *handle    = NULL;
     NC_dim *dim       = NULL;
@@ -2653,6 +3351,8 @@ SDsetdimscale(int32 id,    /* IN: dimension ID */
               int32 nt,    /* IN: number type of data */
               void *data /* IN: scale values */)
 {
+    H4_API_ENTER;
+
     NC     *handle = NULL;
     NC_dim *dim    = NULL;
     int32   status;
@@ -2727,6 +3427,8 @@ int
 SDgetdimscale(int32 id, /* IN:  dimension ID */
               void *data /* OUT: scale values */)
 {
+    H4_API_ENTER;
+
     NC     *handle = NULL;
     NC_dim *dim    = NULL;
     NC_var *vp     = NULL;
@@ -2822,10 +3524,12 @@ SDdiminfo(int32  id,   /* IN:  dimension ID */
           int32 *nt,   /* OUT: number type of scales */
           int32 *nattr /* OUT: the number of local attributes */)
 {
+    H4_API_ENTER;
+
     NC      *handle = NULL;
     NC_dim  *dim    = NULL;
-    NC_var **dp     = NULL;
-    int      len;
+    NC_var  *vp     = NULL;
+    int      ii;
     int      ret_value = SUCCEED;
 
     /* clear error stack */
@@ -2870,34 +3574,29 @@ SDdiminfo(int32  id,   /* IN:  dimension ID */
     /* In HDF files, number type and attribute info are only stored in the
        coordinate var of the dimension; so, if there is no coord var associated
        with the dimension being inquired, these info will not be available. */
-    if (handle->vars) {
-        len = dim->name->len;
-        dp  = (NC_var **)handle->vars->values;
-        for (int ii = 0; ii < handle->vars->count; ii++, dp++) {
-            /* eliminate vars with rank > 1, coord vars only have rank 1 */
-            if ((*dp)->assoc->count == 1) {
-                /* check if this variable matches the searched name */
-                if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, (*dp)->name->len) == 0) {
-                    if (handle->file_type == HDF_FILE) /* HDF file */
-                    {
-                        /* only proceed if this variable is a coordinate var or
-                        when its status is unknown due to its being created
-                        prior to the fix of bugzilla 624 - BMR - 05/14/2007 */
-                        if ((*dp)->var_type == IS_CRDVAR || (*dp)->var_type == UNKNOWN) {
-                            *nt    = ((*dp)->numrecs ? (*dp)->HDFtype : 0);
-                            *nattr = ((*dp)->attrs ? (*dp)->attrs->count : 0);
-                            HGOTO_DONE(ret_value);
-                        }
-                    }
-                    else /* netCDF file */
-                    {
-                        *nt    = (*dp)->HDFtype;
-                        *nattr = ((*dp)->attrs ? (*dp)->attrs->count : 0);
-                        HGOTO_DONE(ret_value);
-                    }
-                } /* name matched */
-            }     /* rank = 1 */
-        }
+    /* look at the variables that match the searched name */
+    for (ii = NC_findvar(handle, name, -1); ii != -1; ii = NC_findvar(handle, name, ii)) {
+        vp = NC_array_elem(handle->vars, (unsigned)ii);
+        /* eliminate vars with rank > 1, coord vars only have rank 1 */
+        if (vp->assoc->count == 1) {
+            if (handle->file_type == HDF_FILE) /* HDF file */
+            {
+                /* only proceed if this variable is a coordinate var or
+                when its status is unknown due to its being created
+                prior to the fix of bugzilla 624 - BMR - 05/14/2007 */
+                if (vp->var_type == IS_CRDVAR || vp->var_type == UNKNOWN) {
+                    *nt    = (vp->numrecs ? vp->HDFtype : 0);
+                    *nattr = (vp->attrs ? (int32)vp->attrs->count : 0);
+                    HGOTO_DONE(ret_value);
+                }
+            }
+            else /* netCDF file */
+            {
+                *nt    = vp->HDFtype;
+                *nattr = (vp->attrs ? (int32)vp->attrs->count : 0);
+                HGOTO_DONE(ret_value);
+            }
+        } /* rank = 1 */
     }
 done:
     return ret_value;
@@ -2923,13 +3622,15 @@ SDgetdimstrs(int32 id, /* IN:  dataset ID */
              char *f,  /* OUT: format string ("format") */
              int   len /* IN:  buffer length */)
 {
+    H4_API_ENTER;
+
     NC       *handle = NULL;
     NC_var   *var    = NULL;
-    NC_var  **dp     = NULL;
+    NC_var   *vp     = NULL;
     NC_dim   *dim    = NULL;
     NC_attr **attr   = NULL;
     char     *name   = NULL;
-    int32     namelen;
+    int       ii;
     int       ret_value = SUCCEED;
 
     /* clear error stack */
@@ -2955,29 +3656,24 @@ SDgetdimstrs(int32 id, /* IN:  dataset ID */
 
     /* need to get a pointer to the var now */
     var = NULL;
-    if (handle->vars) {
-        name    = dim->name->values;
-        namelen = strlen(name);
-        dp      = (NC_var **)handle->vars->values;
-        for (int i = 0; i < handle->vars->count; i++, dp++) {
-            /* eliminate vars with rank > 1, coord vars only have rank 1 */
-            if ((*dp)->assoc->count == 1) {
-                if (namelen == (*dp)->name->len && strncmp(name, (*dp)->name->values, strlen(name)) == 0) {
-                    /* because a dim was given, make sure that this is a coord var */
-                    /* if it is an SDS, the function will fail */
-                    if ((*dp)->var_type == IS_SDSVAR) {
-                        HGOTO_ERROR(DFE_ARGS, FAIL);
-                    }
-                    /* only proceed if this variable is a coordinate var or when
-                    its status is unknown due to its being created prior to
-                    the fix of bugzilla 624 - BMR - 05/14/2007 */
-                    else
-                    /* i.e., (*dp)->var_type == IS_CRDVAR ||
-                        (*dp)->var_type == UNKNOWN) */
-                    {
-                        var = (*dp);
-                    }
-                }
+    name = dim->name->values;
+    for (ii = NC_findvar(handle, name, -1); ii != -1; ii = NC_findvar(handle, name, ii)) {
+        vp = NC_array_elem(handle->vars, (unsigned)ii);
+        /* eliminate vars with rank > 1, coord vars only have rank 1 */
+        if (vp->assoc->count == 1) {
+            /* because a dim was given, make sure that this is a coord var */
+            /* if it is an SDS, the function will fail */
+            if (vp->var_type == IS_SDSVAR) {
+                HGOTO_ERROR(DFE_ARGS, FAIL);
+            }
+            /* only proceed if this variable is a coordinate var or when
+            its status is unknown due to its being created prior to
+            the fix of bugzilla 624 - BMR - 05/14/2007 */
+            else
+            /* i.e., vp->var_type == IS_CRDVAR ||
+                vp->var_type == UNKNOWN) */
+            {
+                var = vp;
             }
         }
     }
@@ -3075,6 +3771,8 @@ SDsetexternalfile(int32       id,       /* IN: dataset ID */
                   const char *filename, /* IN: name of external file */
                   int32       offset /* IN: offset in external file */)
 {
+    H4_API_ENTER;
+
     NC     *handle       = NULL;
     NC_var *var          = NULL;
     int     extfname_len = 0; /* Length of external file's name */
@@ -3188,6 +3886,8 @@ SDgetexternalinfo(int32    id,           /* IN: dataset ID */
                   int32   *offset,       /* IN: offset in external file */
                   int32   *length /* IN: length of external data */)
 {
+    H4_API_ENTER;
+
     NC     *handle           = NULL;
     NC_var *var              = NULL;
     int32   aid              = FAIL;
@@ -3329,6 +4029,8 @@ SDgetexternalfile(int32  id,           /* IN: dataset ID */
                   char  *ext_filename, /* IN: name of external file */
                   int32 *offset /* IN: offset in external file */)
 {
+    H4_API_ENTER;
+
     NC     *handle     = NULL;
     NC_var *var        = NULL;
     int     actual_len = 0;
@@ -3442,6 +4144,8 @@ SDsetnbitdataset(int32 id,        /* IN: dataset ID */
                  int   sign_ext,  /* IN: Whether to sign extend */
                  int   fill_one /* IN: Whether to fill background w/1's */)
 {
+    H4_API_ENTER;
+
     NC        *handle = NULL;
     NC_var    *var    = NULL;
     model_info m_info; /* modeling information for the HCcreate() call */
@@ -3526,6 +4230,8 @@ done:
 int
 SDsetup_szip_parms(int32 id, NC *handle, comp_info *c_info, int32 *cdims)
 {
+    H4_API_ENTER;
+
     NC_dim *dim = NULL; /* to check if the dimension is unlimited */
     int32   dimindex;   /* to obtain the NC_dim record */
     NC_var *var = NULL;
@@ -3585,6 +4291,8 @@ SDsetcompress(int32        id,        /* IN: dataset ID */
                    perform on the next image */
               comp_info *c_info /* IN: ptr to compression info struct*/)
 {
+    H4_API_ENTER;
+
     NC        *handle;
     NC_var    *var = NULL;
     NC_dim    *dim;      /* to check if the dimension is unlimited */
@@ -3734,6 +4442,8 @@ SDgetcompress(
     comp_info    *c_info /* OUT: ptr to compression information structure for storing the retrieved info */
 )
 {
+    H4_API_ENTER;
+
     int status    = FAIL;
     int ret_value = SUCCEED;
 
@@ -3769,6 +4479,8 @@ SDgetcompinfo(int32         sdsid,     /* IN: dataset ID */
          structure for storing the retrieved info */
 )
 {
+    H4_API_ENTER;
+
     NC     *handle;
     NC_var *var       = NULL;
     int     status    = FAIL;
@@ -3835,6 +4547,8 @@ int
 SDgetcomptype(int32         sdsid, /* IN: dataset ID */
               comp_coder_t *comp_type /* OUT: the type of compression */)
 {
+    H4_API_ENTER;
+
     NC     *handle;
     NC_var *var       = NULL;
     int     status    = FAIL;
@@ -3893,6 +4607,8 @@ SDgetdatasize(int32  sdsid,     /* IN: dataset ID */
               int32 *orig_size) /* OUT: size of original data */
 
 {
+    H4_API_ENTER;
+
     NC     *handle;
     NC_var *var           = NULL;
     int     status        = FAIL;
@@ -3975,6 +4691,8 @@ int32
 SDfindattr(int32       id, /* IN: object ID */
            const char *attrname /* IN: attribute name */)
 {
+    H4_API_ENTER;
+
     NC_array  *ap     = NULL;
     NC_array **app    = NULL;
     NC_attr  **attr   = NULL;
@@ -4030,6 +4748,8 @@ done:
 int32
 SDidtoref(int32 id /* IN: dataset ID */)
 {
+    H4_API_ENTER;
+
     NC     *handle    = NULL;
     NC_var *var       = NULL;
     int32   ret_value = FAIL;
@@ -4072,6 +4792,8 @@ int32
 SDreftoindex(int32 fid, /* IN: file ID */
              int32 ref /* IN: reference number */)
 {
+    H4_API_ENTER;
+
     NC      *handle    = NULL;
     NC_var **dp        = NULL;
     int32    ret_value = FAIL;
@@ -4116,6 +4838,8 @@ done:
 int32
 SDisrecord(int32 id /* IN: dataset ID */)
 {
+    H4_API_ENTER;
+
     NC     *handle;
     NC_var *var       = NULL;
     int32   ret_value = TRUE;
@@ -4165,6 +4889,8 @@ done:
 int
 SDiscoordvar(int32 id /* IN: dataset ID */)
 {
+    H4_API_ENTER;
+
     NC     *handle = NULL;
     NC_var *var    = NULL;
     NC_dim *dim    = NULL;
@@ -4244,6 +4970,8 @@ int
 SDsetaccesstype(int32    id, /* IN: dataset ID */
                 unsigned accesstype /* IN: access type */)
 {
+    H4_API_ENTER;
+
     NC     *handle    = NULL;
     NC_var *var       = NULL;
     int     ret_value = SUCCEED;
@@ -4303,6 +5031,8 @@ int
 SDsetblocksize(int32 sdsid, /* IN: dataset ID */
                int32 block_size /* IN: size of the block in bytes */)
 {
+    H4_API_ENTER;
+
     NC     *handle    = NULL;
     NC_var *var       = NULL;
     int     ret_value = SUCCEED;
@@ -4345,6 +5075,8 @@ int
 SDgetblocksize(int32  sdsid, /* IN: dataset ID */
                int32 *block_size /* OUT: size of the block in bytes */)
 {
+    H4_API_ENTER;
+
     NC     *handle       = NULL;
     NC_var *var          = NULL;
     int32   block_length = -1;
@@ -4414,6 +5146,8 @@ SDsetfillmode(int32 sd_id,  /* IN: HDF file ID, returned from SDstart */
                                    either SD_FILL or SD_NOFILL.
                                    SD_FILL is the default mode. */)
 {
+    H4_API_ENTER;
+
     NC *handle = NULL;
     int cdfid;
     int ret_value = FAIL;
@@ -4451,6 +5185,8 @@ SDsetdimval_comp(int32 dimid,    /* IN: dimension ID, returned from SDgetdimid *
                                     SD_DIMVAL_BW_INCOMP -- incompatible.
                                     (defined in mfhdf.h ) */)
 {
+    H4_API_ENTER;
+
     NC     *handle    = NULL;
     NC_dim *dim       = NULL;
     int     ret_value = SUCCEED;
@@ -4498,6 +5234,8 @@ done:
 int
 SDisdimval_bwcomp(int32 dimid /* IN: dimension ID, returned from SDgetdimid */)
 {
+    H4_API_ENTER;
+
     NC     *handle    = NULL;
     NC_dim *dim       = NULL;
     int     ret_value = FAIL;
@@ -4645,6 +5383,8 @@ SDsetchunk(int32         sdsid,     /* IN: sds access id */
            HDF_CHUNK_DEF chunk_def, /* IN: chunk definition */
            int32         flags /* IN: flags */)
 {
+    H4_API_ENTER;
+
     NC            *handle    = NULL; /* file handle */
     NC_var        *var       = NULL; /* SDS variable */
     NC_attr      **fill_attr = NULL; /* fill value attribute */
@@ -4658,8 +5398,6 @@ SDsetchunk(int32         sdsid,     /* IN: sds access id */
     void          *fill_val     = NULL; /* fill value */
     int32          ndims        = 0;    /* # dimensions i.e. rank */
     uint8          nlevels      = 1;    /* default # levels is 1 */
-    int8           platntsubclass;      /* the machine type of the current platform */
-    int8           outntsubclass;       /* the data's machine type */
     unsigned       convert;             /* whether to convert or not */
     int32          tBuf_size = 0;       /* conversion buffer size */
     void          *tBuf      = NULL;    /* buffer used for conversion */
@@ -4867,20 +5605,7 @@ SDsetchunk(int32         sdsid,     /* IN: sds access id */
     }
 
     /* figure out if fill value has to be converted */
-    if (FAIL == (platntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
-        HGOTO_ERROR(DFE_INTERNAL, FAIL);
-    }
-
-    if (DFKisnativeNT(var->HDFtype)) {
-        if (FAIL == (outntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
-            HGOTO_ERROR(DFE_INTERNAL, FAIL);
-        }
-    }
-    else {
-        outntsubclass = DFKislitendNT(var->HDFtype) ? DFNTF_PC : DFNTF_HDFDEFAULT;
-    }
-
-    convert = (unsigned)(platntsubclass != outntsubclass);
+    convert = (unsigned)!DFKiscopyNT(var->HDFtype);
 
     /* make sure our tmp buffer is big enough to hold fill value */
     if (convert && tBuf_size < fill_val_len) {
@@ -4984,6 +5709,8 @@ SDgetchunkinfo(int32          sdsid,     /* IN: sds access id */
                HDF_CHUNK_DEF *chunk_def, /* IN/OUT: chunk definition */
                int32         *flags /* IN/OUT: flags */)
 {
+    H4_API_ENTER;
+
     NC             *handle = NULL; /* file handle */
     NC_var         *var    = NULL; /* SDS variable */
     sp_info_block_t info_block;    /* special info block */
@@ -5204,14 +5931,14 @@ SDwritechunk(int32       sdsid,  /* IN: access aid to SDS */
              int32      *origin, /* IN: origin of chunk to write */
              const void *datap /* IN: buffer for data */)
 {
-    NC             *handle = NULL;  /* file handle */
-    NC_var         *var    = NULL;  /* SDS variable */
-    int16           special;        /* Special code */
-    int32           csize;          /* physical chunk size */
-    uint32          byte_count;     /* bytes to write */
-    int8            platntsubclass; /* the machine type of the current platform */
-    int8            outntsubclass;  /* the data's machine type */
-    unsigned        convert;        /* whether to convert or not */
+    H4_API_ENTER;
+
+    NC             *handle = NULL; /* file handle */
+    NC_var         *var    = NULL; /* SDS variable */
+    int16           special;       /* Special code */
+    int32           csize;         /* physical chunk size */
+    uint32          byte_count;    /* bytes to write */
+    unsigned        convert;       /* whether to convert or not */
     comp_coder_t    comp_type;
     uint32          comp_config;
     int32           status;
@@ -5282,21 +6009,7 @@ SDwritechunk(int32       sdsid,  /* IN: access aid to SDS */
                 /* figure out if data needs to be converted */
                 byte_count = csize;
 
-                if (FAIL == (platntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
-                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                }
-
-                if (DFKisnativeNT(var->HDFtype)) {
-                    if (FAIL == (outntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
-                        ret_value = FAIL;
-                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                    }
-                }
-                else {
-                    outntsubclass = DFKislitendNT(var->HDFtype) ? DFNTF_PC : DFNTF_HDFDEFAULT;
-                }
-
-                convert = (unsigned)(platntsubclass != outntsubclass);
+                convert = (unsigned)!DFKiscopyNT(var->HDFtype);
 
                 /* make sure our tmp buffer is big enough to hold everything */
                 if (convert && tBuf_size < byte_count) {
@@ -5379,14 +6092,14 @@ SDreadchunk(int32  sdsid,  /* IN: access aid to SDS */
             int32 *origin, /* IN: origin of chunk to write */
             void  *datap /* IN/OUT: buffer for data */)
 {
-    NC             *handle = NULL;  /* file handle */
-    NC_var         *var    = NULL;  /* SDS variable */
-    int16           special;        /* Special code */
-    int32           csize;          /* physical chunk size */
-    uint32          byte_count;     /* bytes to read */
-    int8            platntsubclass; /* the machine type of the current platform */
-    int8            outntsubclass;  /* the data's machine type */
-    unsigned        convert;        /* whether to convert or not */
+    H4_API_ENTER_SHARED;
+
+    NC             *handle = NULL; /* file handle */
+    NC_var         *var    = NULL; /* SDS variable */
+    int16           special;       /* Special code */
+    int32           csize;         /* physical chunk size */
+    uint32          byte_count;    /* bytes to read */
+    unsigned        convert;       /* whether to convert or not */
     comp_coder_t    comp_type;
     uint32          comp_config;
     int32           status;
@@ -5412,6 +6125,9 @@ SDreadchunk(int32  sdsid,  /* IN: access aid to SDS */
         HGOTO_ERROR(DFE_ARGS, FAIL);
     }
 
+    /* Readers of different files run in parallel */
+    H4_API_LOCK_FILE(handle->hdf_file);
+
     /* get variable from id */
     var = SDIget_var(handle, sdsid);
     if (var == NULL) {
@@ -5473,20 +6189,7 @@ SDreadchunk(int32  sdsid,  /* IN: access aid to SDS */
                 /* figure out if data needs to be converted */
                 byte_count = csize;
 
-                if (FAIL == (platntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
-                    HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                }
-
-                if (DFKisnativeNT(var->HDFtype)) {
-                    if (FAIL == (outntsubclass = DFKgetPNSC(var->HDFtype, DF_MT))) {
-                        HGOTO_ERROR(DFE_INTERNAL, FAIL);
-                    }
-                }
-                else {
-                    outntsubclass = DFKislitendNT(var->HDFtype) ? DFNTF_PC : DFNTF_HDFDEFAULT;
-                }
-
-                convert = (unsigned)(platntsubclass != outntsubclass);
+                convert = (unsigned)!DFKiscopyNT(var->HDFtype);
 
                 /* make sure our tmp buffer is big enough to hold everything */
                 if (convert && tBuf_size < byte_count) {
@@ -5548,6 +6251,162 @@ done:
     return ret_value;
 } /* SDreadchunk() */
 
+/******************************************************************************
+ NAME
+     SDreadchunk_raw   -- read the specified chunk as it is stored
+
+ DESCRIPTION
+     Reads the chunk at 'origin' of a chunked SDS exactly as it is stored
+     in the file: compressed if the SDS is compressed, and in the file's
+     number format.  No decoder is needed.  Together with
+     SDwritechunk_raw() this copies chunks between data sets with the same
+     number type, chunk sizes and compression without decompressing and
+     compressing them again.
+
+     'comp_type' and 'c_info', when not NULL, receive the compression of
+     the chunk, COMP_CODE_NONE if it is not compressed.  With 'datap' NULL
+     only the size of the chunk is returned, so that a buffer can be
+     allocated; otherwise 'buf_size' must be at least that size.
+
+     A chunk that has never been written has no bytes; it reads as the
+     fill value.  Its compression is that of the data set.
+
+     NOTE:
+         This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+ RETURNS
+        The number of bytes of the chunk, 0 for a chunk that has never
+        been written, or FAIL
+******************************************************************************/
+int32
+SDreadchunk_raw(int32         sdsid,     /* IN: access aid to SDS */
+                int32        *origin,    /* IN: origin of chunk to read */
+                comp_coder_t *comp_type, /* OUT: compression type of the chunk */
+                comp_info    *c_info,    /* OUT: compression info of the chunk */
+                int32         buf_size,  /* IN: size of 'datap' */
+                void         *datap /* OUT: buffer for the chunk */)
+{
+    H4_API_ENTER_SHARED;
+
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    int32   ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* Check args */
+    if (origin == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get file handle and verify it is an HDF file */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* Readers of different files run in parallel */
+    H4_API_LOCK_FILE(handle->hdf_file);
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* an empty data set has no data element, and no chunks */
+    if (var->data_ref == 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* Need to get access id for the following calls */
+    if (var->aid == FAIL) {
+        var->aid = Hstartread(handle->hdf_file, var->data_tag, var->data_ref);
+        if (var->aid == FAIL) /* catch FAIL from Hstartread */
+            HGOTO_ERROR(DFE_CANTACCESS, FAIL);
+    }
+
+    /* only chunked data sets have chunks */
+    if (Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (special != SPECIAL_CHUNKED)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if ((ret_value = HMCreadChunkRaw(var->aid, origin, comp_type, c_info, buf_size, datap)) == FAIL)
+        HGOTO_ERROR(DFE_READERROR, FAIL);
+
+done:
+    return ret_value;
+} /* SDreadchunk_raw() */
+
+/******************************************************************************
+ NAME
+     SDwritechunk_raw  -- write the specified chunk as it is to be stored
+
+ DESCRIPTION
+     Writes 'len' bytes as the chunk at 'origin' of a chunked SDS without
+     compressing them or converting their number type, so no encoder is
+     needed.  The bytes must be a chunk as returned by SDreadchunk_raw()
+     for a data set with the same number type, chunk sizes and
+     compression, and 'comp_type' must be the compression type of this
+     data set, COMP_CODE_NONE if it is not compressed.  Only the
+     compression type and, for uncompressed chunks, the size are checked.
+
+     The chunk replaces any earlier version of it, including one in the
+     chunk cache.
+
+     NOTE:
+           This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+ RETURNS
+        SUCCEED/FAIL
+******************************************************************************/
+int
+SDwritechunk_raw(int32        sdsid,     /* IN: access aid to SDS */
+                 int32       *origin,    /* IN: origin of chunk to write */
+                 comp_coder_t comp_type, /* IN: compression type of the chunk */
+                 int32        len,       /* IN: size of the chunk */
+                 const void  *datap /* IN: buffer for the chunk */)
+{
+    H4_API_ENTER;
+
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    int     ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* Check args */
+    if (origin == NULL || datap == NULL || len <= 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get file handle and verify it is an HDF file */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* only chunked data sets have chunks */
+    if (Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (special != SPECIAL_CHUNKED)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (HMCwriteChunkRaw(var->aid, origin, comp_type, len, datap) == FAIL)
+        HGOTO_ERROR(DFE_WRITEERROR, FAIL);
+
+done:
+    return ret_value;
+} /* SDwritechunk_raw() */
+
 /******************************************************************************
 NAME
      SDsetchunkcache - maximum number of chunks to cache
@@ -5603,6 +6462,8 @@ SDsetchunkcache(int32 sdsid,    /* IN: access aid to mess with */
                 int32 maxcache, /* IN: max number of chunks to cache */
                 int32 flags /* IN: flags = 0, HDF_CACHEALL */)
 {
+    H4_API_ENTER;
+
     NC     *handle = NULL; /* file handle */
     NC_var *var    = NULL; /* SDS variable */
     int16   special;       /* Special code */
@@ -5651,6 +6512,188 @@ done:
     return ret_value;
 } /* SDsetchunkcache() */
 
+/******************************************************************************
+NAME
+     SDsetreadthreads - decode the chunks of a data set on several threads
+
+DESCRIPTION
+     Reads of a chunked SDS compressed with deflate normally read and
+     decode each chunk when they first need it.  With 'nthreads' greater
+     than 1, a read that needs a chunk that is not in the chunk cache reads
+     the chunks it still needs as they are stored, decodes them on
+     'nthreads' threads, and puts them in the chunk cache.  0 or 1 go back
+     to decoding the chunks one at a time.
+
+     No more chunks are decoded ahead than the chunk cache holds, so
+     'maxcache' (see SDsetchunkcache) should be at least a few times
+     'nthreads'.
+
+     The setting lasts until the SDS is ended.  It has no effect on data
+     sets that are not compressed with deflate, or when the library is
+     built without threads.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+int
+SDsetreadthreads(int32 sdsid, /* IN: dataset ID */
+                 int   nthreads /* IN: number of threads, 0 or 1 for none */)
+{
+    H4_API_ENTER;
+
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    int     ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (nthreads < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get file handle and verify it is an HDF file */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* only chunked data sets are read by chunks */
+    if (Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (special != SPECIAL_CHUNKED)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    ret_value = HMCsetreadthreads(var->aid, nthreads);
+
+done:
+    return ret_value;
+} /* SDsetreadthreads() */
+
+/******************************************************************************
+NAME
+     SDsetwritethreads - encode the chunks of a data set on several threads
+
+DESCRIPTION
+     Writes to a chunked SDS compressed with deflate normally encode and
+     write each modified chunk when it leaves the chunk cache.  With
+     'nthreads' greater than 1, modified chunks are encoded several at a
+     time on 'nthreads' threads and then written in order: all of them
+     when the SDS is ended, and those in the older half of the chunk cache
+     when one has to leave it.  0 or 1 go back to encoding the chunks one
+     at a time.
+
+     The chunks stored are the same as without threads; only where they
+     are placed in the file may differ.  The setting lasts until the SDS
+     is ended.  It has no effect on data sets that are not compressed with
+     deflate, or when the library is built without threads.
+
+     NOTE:
+          This routine directly calls a Special Chunked Element fcn HMCxxx.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+int
+SDsetwritethreads(int32 sdsid, /* IN: dataset ID */
+                  int   nthreads /* IN: number of threads, 0 or 1 for none */)
+{
+    H4_API_ENTER;
+
+    NC     *handle = NULL; /* file handle */
+    NC_var *var    = NULL; /* SDS variable */
+    int16   special;       /* Special code */
+    int     ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (nthreads < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get file handle and verify it is an HDF file */
+    handle = SDIhandle_from_id(sdsid, SDSTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE || handle->vars == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get variable from id */
+    var = SDIget_var(handle, sdsid);
+    if (var == NULL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* Check to see if data aid exists? i.e. may need to create a ref for SDS */
+    if (var->aid == FAIL && hdf_get_vp_aid(handle, var) == FAIL)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* only chunked data sets are written by chunks */
+    if (Hinquire(var->aid, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &special) == FAIL)
+        HGOTO_ERROR(DFE_INTERNAL, FAIL);
+    if (special != SPECIAL_CHUNKED)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    ret_value = HMCsetwritethreads(var->aid, nthreads);
+
+done:
+    return ret_value;
+} /* SDsetwritethreads() */
+
+/******************************************************************************
+NAME
+     SDsetchunkcachebudget - limit the memory used by all chunk caches of a file
+
+DESCRIPTION
+     The chunk caches of all the chunked data sets of a file share one
+     Least Recently Used list of chunks. This routine limits the number of
+     bytes held by all of them together to 'bytes', or removes the limit
+     if 'bytes' is 0 (the default).
+
+     When a data set needs room for a chunk and the limit has been reached,
+     the least recently used chunk of any data set in the file is written
+     out (if modified) and dropped. 'maxcache' (see SDsetchunkcache) still
+     limits the number of chunks each data set can cache.
+
+     This routine calls Hsetchunkcachebudget on the underlying HDF file.
+
+RETURNS
+     SUCCEED/FAIL
+******************************************************************************/
+int
+SDsetchunkcachebudget(int32 fid, /* IN: file ID */
+                      int32 bytes /* IN: max bytes of cached chunks, 0 for no limit */)
+{
+    H4_API_ENTER;
+
+    NC *handle    = NULL; /* file handle */
+    int ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    if (bytes < 0)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    /* get file handle and verify it is an HDF file */
+    handle = SDIhandle_from_id(fid, CDFTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    ret_value = Hsetchunkcachebudget(handle->hdf_file, bytes);
+
+done:
+    return ret_value;
+} /* SDsetchunkcachebudget() */
+
 /******************************************************************************
  NAME
     SDcheckempty -- checks whether an SDS is empty
@@ -5667,6 +6710,8 @@ int32
 SDcheckempty(int32 sdsid, /* IN: dataset ID */
              int  *emptySDS /* TRUE if SDS is empty */)
 {
+    H4_API_ENTER;
+
     NC     *handle    = NULL; /* file record struct */
     NC_var *var       = NULL; /* variable record struct */
     int32   ret_value = SUCCEED;
@@ -5733,6 +6778,8 @@ done:
 hdf_idtype_t
 SDidtype(int32 an_id)
 {
+    H4_API_ENTER;
+
     NC          *handle    = NULL; /* file record struct */
     hdf_idtype_t ret_value = NOT_SDAPI_ID;
 
@@ -5785,6 +6832,8 @@ SDidtype(int32 an_id)
 int
 SDreset_maxopenfiles(int req_max)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* clear error stack */
@@ -5818,6 +6867,8 @@ SDget_maxopenfiles(int *curr_max,  /* OUT: current # of open files allowed */
                    int *sys_limit) /* OUT: max # of open files allowed on
                                a system */
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* clear error stack */
@@ -5854,6 +6905,8 @@ done:
 int
 SDget_numopenfiles(void)
 {
+    H4_API_ENTER;
+
     int ret_value = SUCCEED;
 
     /* clear error stack */
@@ -5881,6 +6934,8 @@ int
 SDgetfilename(int32 fid, /* IN:  file ID */
               char *filename /* OUT: name of the file */)
 {
+    H4_API_ENTER;
+
     NC *handle = NULL;
     int len;
     int ret_value = SUCCEED;
@@ -5904,6 +6959,61 @@ done:
     return ret_value;
 } /* SDgetfilename */
 
+/******************************************************************************
+ NAME
+    SDsetcatalog -- keep an SD catalog in a file
+
+ DESCRIPTION
+    An SD catalog is a single element holding all of the dimensions, data
+    sets and attributes of a file, as SDstart finds them.  When a file has
+    an up to date catalog, SDstart reads it in one go instead of gathering
+    the metadata object by object, which makes opening a file with many
+    data sets much faster.
+
+    If flag is TRUE, a catalog is written when the file is closed with
+    SDend, and it is kept up to date by every later SDend on the file
+    opened for writing.  If flag is FALSE, the file's catalog, if any, is
+    deleted by SDend.  A catalog that is out of date because objects of
+    the file were created, deleted or resized, by the SD interface or
+    another one, is detected and ignored by SDstart.
+
+    Objects rewritten in place with the same size by another interface,
+    e.g. attribute values written again with VSwrite, or a name changed
+    to one of the same length, are not detected.  After such changes, call
+    SDsetcatalog with flag TRUE to have SDend write the catalog again.
+
+    The file must have been opened for writing.
+
+ RETURNS
+    SUCCEED/FAIL
+
+******************************************************************************/
+int
+SDsetcatalog(int32 fid, /* IN: file ID */
+             int   flag /* IN: TRUE to keep a catalog, FALSE to remove it */)
+{
+    H4_API_ENTER;
+
+    NC *handle    = NULL;
+    int ret_value = SUCCEED;
+
+    /* clear error stack */
+    HEclear();
+
+    /* check that fid is valid and get file structure */
+    handle = SDIhandle_from_id(fid, CDFTYPE);
+    if (handle == NULL || handle->file_type != HDF_FILE)
+        HGOTO_ERROR(DFE_ARGS, FAIL);
+
+    if (!(handle->flags & NC_RDWR))
+        HGOTO_ERROR(DFE_BADACC, FAIL);
+
+    handle->catalog = flag ? NC_CATALOG_REBUILD : NC_CATALOG_NONE;
+
+done:
+    return ret_value;
+} /* SDsetcatalog */
+
 /******************************************************************************
  NAME
     SDgetnamelen -- retrieves the length of the name of a file, a dataset,
@@ -5920,6 +7030,8 @@ int
 SDgetnamelen(int32   id, /* IN:  object ID */
              uint16 *name_len /* OUT: buffer for name's length */)
 {
+    H4_API_ENTER;
+
     NC     *handle    = NULL;
     NC_var *var       = NULL;
     NC_dim *dim       = NULL;
@@ -130,6 +130,15 @@ typedef struct {
                         /* NC.dims and NC.vars are NC_array too. */
 } NC_attr;
 
+/* Hash of the variable names of a file, built by the first lookup by name
+   (see NC_findvar); the variables of a bucket are chained in index order */
+typedef struct {
+    unsigned nvars;    /* number of variables hashed */
+    unsigned nbuckets; /* a power of 2 */
+    int     *first;    /* first variable of each bucket, -1 if none */
+    int     *next;     /* next variable of the same bucket, -1 if none */
+} NC_varhash;
+
 typedef struct {
     char          path[FILENAME_MAX + 1];
     unsigned      flags;
@@ -147,8 +156,15 @@ typedef struct {
     int32      vgid;
     int        hdf_mode; /* mode we are attached for */
     hdf_file_t cdf_fp;   /* file pointer used for CDF files */
+    int        catalog;  /* keep an SD catalog in the HDF file (see hdf_write_catalog) */
+    NC_varhash *varhash; /* variables by name, NULL until looked up */
 } NC;
 
+/* Values of NC.catalog */
+#define NC_CATALOG_NONE    0 /* no catalog, the one the file has is deleted */
+#define NC_CATALOG_KEEP    1 /* the catalog is rewritten when it is out of date */
+#define NC_CATALOG_REBUILD 2 /* the catalog is rewritten in any case */
+
 /* NC variable: description and data */
 typedef struct {
     NC_string     *name;    /* name->values shows data set's name */
@@ -199,7 +215,7 @@ typedef struct {
 #define HDF_FILE    1
 #define CDF_FILE    2
 
-HDFLIBAPI const char *cdf_routine_name; /* defined in lerror.c */
+HDFLIBAPI H4_THREAD_LOCAL const char *cdf_routine_name; /* defined in lerror.c */
 
 #define MAGICOFFSET 0 /* Offset where format version number is written */
 
@@ -241,6 +257,7 @@ extern "C" {
 #define NC_xlen_var       HNAME(NC_xlen_var)
 #define NCmemset          HNAME(NCmemset)
 #define NC_arrayfill      HNAME(NC_arrayfill)
+#define NC_array_elem     HNAME(NC_array_elem)
 #define NC_copy_arrayvals HNAME(NC_copy_arrayvals)
 #define NC_free_array     HNAME(NC_free_array)
 #define NC_free_attr      HNAME(NC_free_attr)
@@ -276,6 +293,9 @@ extern "C" {
 #define NC_new_string     HNAME(NC_new_string)
 #define NC_re_string      HNAME(NC_re_string)
 #define NC_hlookupvar     HNAME(NC_hlookupvar)
+#define NC_findvar        HNAME(NC_findvar)
+#define NC_free_varhash   HNAME(NC_free_varhash)
+#define NC_hash_string    HNAME(NC_hash_string)
 #define NC_new_var        HNAME(NC_new_var)
 #define NCvario           HNAME(NCvario)
 #define NCcoordck         HNAME(NCcoordck)
@@ -413,6 +433,7 @@ HDFLIBAPI int  NC_free_string(NC_string *cdfstr);
 HDFLIBAPI int  NC_free_var(NC_var *var);
 
 HDFLIBAPI uint8_t *NC_incr_array(NC_array *array, uint8_t *tail);
+HDFLIBAPI void    *NC_array_elem(const NC_array *array, unsigned ii);
 
 HDFLIBAPI int    NC_dimid(NC *handle, char *name);
 HDFLIBAPI bool_t NCcktype(nc_type datatype);
@@ -442,6 +463,9 @@ HDFLIBAPI NC_iarray *NC_new_iarray(unsigned count, const int values[]);
 HDFLIBAPI NC_string *NC_new_string(unsigned count, const char *str);
 HDFLIBAPI NC_string *NC_re_string(NC_string *old, unsigned count, const char *str);
 HDFLIBAPI NC_var    *NC_hlookupvar(NC *handle, int varid);
+HDFLIBAPI int        NC_findvar(NC *handle, const char *name, int after);
+HDFLIBAPI void       NC_free_varhash(NC *handle);
+HDFLIBAPI uint32     NC_hash_string(unsigned count, const char *str);
 HDFLIBAPI NC_var    *NC_new_var(const char *name, nc_type type, int ndims, const int *dims);
 HDFLIBAPI int        NCvario(NC *handle, int varid, const long *start, const long *edges, void *values);
 HDFLIBAPI bool_t     NCcoordck(NC *handle, NC_var *vp, const long *coords);
@@ -493,6 +517,10 @@ HDFLIBAPI int hdf_cdf_clobber(NC *);
 
 HDFLIBAPI int hdf_close(NC *);
 
+HDFLIBAPI int hdf_read_catalog(NC *);
+
+HDFLIBAPI int hdf_write_catalog(NC *);
+
 HDFLIBAPI int hdf_read_sds_dims(NC *);
 
 HDFLIBAPI int hdf_read_sds_cdf(XDR *, NC **);
@@ -497,10 +497,10 @@ xdr_NCv1data(XDR *xdrs, unsigned long where, nc_type type, uint8_t *values)
  *
  *****************************************************************************/
 
-static int32 tBuf_size    = 0;
-static int32 tValues_size = 0;
-static int8 *tBuf         = NULL;
-static int8 *tValues      = NULL;
+static H4_THREAD_LOCAL int32 tBuf_size    = 0;
+static H4_THREAD_LOCAL int32 tValues_size = 0;
+static H4_THREAD_LOCAL int8 *tBuf         = NULL;
+static H4_THREAD_LOCAL int8 *tValues      = NULL;
 
 /* ------------------------------ SDPfreebuf ------------------------------ */
 /*
@@ -542,6 +542,7 @@ SDIresizebuf(void **buf, int32 *buf_size, int32 size_wanted)
             ret_value = FAIL;
             goto done;
         }
+        H4_FREE_AT_THREAD_EXIT(buf);
     }
 
 done:
@@ -787,11 +788,9 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, unsigned long where, nc_type type, uint3
     int32     new_count; /* computed by dividing number of elements 'count' by 2 since 'count' is too big to
                             allocate temporary buffer */
     int32    bytes_left;
-    int32    elem_length;    /* length of the element pointed to */
-    int8     platntsubclass; /* the machine type of the current platform */
-    int8     outntsubclass;  /* the data's machine type */
-    unsigned convert;        /* whether to convert or not */
-    uint8   *pvalues;        /* pointer to traverse user's buffer "values" */
+    int32    elem_length; /* length of the element pointed to */
+    unsigned convert;     /* whether to convert or not */
+    uint8   *pvalues;     /* pointer to traverse user's buffer "values" */
     int16    isspecial;
     int      ret_value    = SUCCEED;
     int32    alloc_status = FAIL; /* no successful allocation yet */
@@ -852,22 +851,9 @@ hdf_xdr_NCvdata(NC *handle, NC_var *vp, unsigned long where, nc_type type, uint3
     /* Collect all the number-type size information, etc. */
     byte_count = count * vp->HDFsize;
 
-    if (FAIL == (platntsubclass = DFKgetPNSC(vp->HDFtype, DF_MT))) {
-        ret_value = FAIL;
-        goto done;
-    }
-
-    if (DFKisnativeNT(vp->HDFtype)) {
-        if (FAIL == (outntsubclass = DFKgetPNSC(vp->HDFtype, DF_MT))) {
-            ret_value = FAIL;
-            goto done;
-        }
-    }
-    else {
-        outntsubclass = DFKislitendNT(vp->HDFtype) ? DFNTF_PC : DFNTF_HDFDEFAULT;
-    }
-
-    convert = (unsigned)(platntsubclass != outntsubclass);
+    /* data that is stored as it is in memory goes straight between the
+       file and the user's buffer */
+    convert = (unsigned)!DFKiscopyNT(vp->HDFtype);
 
     /* BMR - bug#268: removed the block here that attempted to allocation
     large amount of space and failed.  The allocation is not incorporated
@@ -1398,6 +1384,8 @@ NCvar1io(NC *handle, int varid, const long *coords, uint8_t *value)
 int
 ncvarput1(int cdfid, int varid, const long *coords, const ncvoid *value)
 {
+    H4_API_ENTER;
+
     NC *handle;
 
     cdf_routine_name = "ncvarput1";
@@ -1418,6 +1406,8 @@ ncvarput1(int cdfid, int varid, const long *coords, const ncvoid *value)
 int
 ncvarget1(int cdfid, int varid, const long *coords, ncvoid *value)
 {
+    H4_API_ENTER;
+
     NC *handle;
 
     cdf_routine_name = "ncvarget1";
@@ -1773,6 +1763,8 @@ NCvario(NC *handle, int varid, const long *start, const long *edges, void *value
 int
 ncvarput(int cdfid, int varid, const long *start, const long *edges, ncvoid *values)
 {
+    H4_API_ENTER;
+
     NC *handle;
 
     cdf_routine_name = "ncvarput";
@@ -1852,6 +1844,8 @@ NC_fill_buffer(NC *handle, int varid, const long *edges, void *values)
 int
 ncvarget(int cdfid, int varid, const long *start, const long *edges, ncvoid *values)
 {
+    H4_API_ENTER;
+
     NC *handle;
     int status = 0;
 
@@ -1922,6 +1916,8 @@ NCelemsPerRec(NC_var *vp)
 int
 ncrecinq(int cdfid, int *nrecvars, int *recvarids, long *recsizes)
 {
+    H4_API_ENTER;
+
     NC     *handle;
     int     nrvars;
     NC_var *rvp[H4_MAX_NC_VARS];
@@ -1997,6 +1993,8 @@ NCrecio(NC *handle, long recnum, uint8_t **datap)
 int
 ncrecput(int cdfid, long recnum, ncvoid **datap)
 {
+    H4_API_ENTER;
+
     NC  *handle;
     long unfilled;
 
@@ -2047,6 +2045,8 @@ ncrecput(int cdfid, long recnum, ncvoid **datap)
 int
 ncrecget(int cdfid, long recnum, ncvoid **datap)
 {
+    H4_API_ENTER;
+
     NC *handle;
 
     cdf_routine_name = "ncrecget";
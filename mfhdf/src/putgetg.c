@@ -142,6 +142,8 @@ int
 ncvarputg(int cdfid, int varid, const long *start, const long *count, const long *stride, const long *imap,
           ncvoid *values)
 {
+    H4_API_ENTER;
+
     NC *handle;
 
     cdf_routine_name = "ncvarputg";
@@ -166,6 +168,8 @@ int
 ncvargetg(int cdfid, int varid, const long *start, const long *count, const long *stride, const long *imap,
           ncvoid *values)
 {
+    H4_API_ENTER;
+
     NC *handle;
 
     cdf_routine_name = "ncvargetg";
@@ -185,6 +189,8 @@ ncvargetg(int cdfid, int varid, const long *start, const long *count, const long
 int
 ncvarputs(int cdfid, int varid, const long *start, const long *count, const long *stride, ncvoid *values)
 {
+    H4_API_ENTER;
+
     NC *handle;
 
     cdf_routine_name = "ncvarputs";
@@ -208,6 +214,8 @@ ncvarputs(int cdfid, int varid, const long *start, const long *count, const long
 int
 ncvargets(int cdfid, int varid, const long *start, const long *count, const long *stride, ncvoid *values)
 {
+    H4_API_ENTER;
+
     NC *handle;
 
     cdf_routine_name = "ncvargets";
@@ -16,8 +16,8 @@
 
 #include "nc_priv.h"
 
-static uint32
-compute_hash(unsigned count, const char *str)
+uint32
+NC_hash_string(unsigned count, const char *str)
 {
     uint32 ret = 0;
     uint32 temp;
@@ -39,7 +39,7 @@ compute_hash(unsigned count, const char *str)
         ret += temp;
     } /* end if */
     return ret;
-} /* end compute_hash() */
+} /* end NC_hash_string() */
 
 NC_string *
 NC_new_string(unsigned count, const char *str)
@@ -58,7 +58,7 @@ NC_new_string(unsigned count, const char *str)
         goto alloc_err;
     ret->count = count;
     ret->len   = count;
-    ret->hash  = compute_hash(count, str);
+    ret->hash  = NC_hash_string(count, str);
     if (count != 0) /* allocate */
     {
         memlen      = count + 1;
@@ -112,7 +112,7 @@ NC_re_string(NC_string *old, unsigned count, const char *str)
 
     /* make sure len is always == to the string length */
     old->len  = count;
-    old->hash = compute_hash(count, str);
+    old->hash = NC_hash_string(count, str);
 
     return old;
 }
@@ -144,7 +144,8 @@ xdr_NC_string(XDR *xdrs, NC_string **spp)
             status = h4_xdr_opaque(xdrs, (*spp)->values, (*spp)->count);
 
             /* might be padded */
-            (*spp)->len = strlen((*spp)->values);
+            (*spp)->len  = (unsigned)strlen((*spp)->values);
+            (*spp)->hash = NC_hash_string((*spp)->len, (*spp)->values);
             return status;
         case XDR_ENCODE:
             /* first deal with the length */
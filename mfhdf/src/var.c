@@ -209,10 +209,11 @@ out:
 int
 ncvardef(int cdfid, const char *name, nc_type type, int ndims, const int dims[])
 {
-    NC      *handle;
-    NC_var  *var[1];
-    NC_var **dp;
-    int      len;
+    H4_API_ENTER;
+
+    NC     *handle;
+    NC_var *var[1];
+    int     ii;
 
     cdf_routine_name = "ncvardef";
 
@@ -255,13 +256,9 @@ ncvardef(int cdfid, const char *name, nc_type type, int ndims, const int dims[])
     }
     else {
         /* check for name in use */
-        len = strlen(name);
-        dp  = (NC_var **)handle->vars->values;
-        for (int ii = 0; ii < handle->vars->count; ii++, dp++) {
-            if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, len) == 0) {
-                NCadvise(NC_ENAMEINUSE, "variable \"%s\" in use with index %d", (*dp)->name->values, ii);
-                return -1;
-            }
+        if ((ii = NC_findvar(handle, name, -1)) != -1) {
+            NCadvise(NC_ENAMEINUSE, "variable \"%s\" in use with index %d", name, ii);
+            return -1;
         }
         var[0] = NC_new_var(name, type, ndims, dims);
         if (var[0] == NULL)
@@ -319,12 +316,133 @@ NC_computeshapes(NC *handle)
     return handle->vars->count;
 }
 
+/* Smallest number of buckets of a variable name hash */
+#define NC_VARHASH_MIN 64
+
+/* Bucket of a name hash value */
+static unsigned
+NC_varhash_bucket(const NC_varhash *vh, uint32 hash)
+{
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bU;
+    hash ^= hash >> 16;
+    return hash & (vh->nbuckets - 1);
+}
+
+/*
+ * Free the name hash of the variables of handle, to be built again by the
+ * next lookup; called when a variable is renamed.
+ */
+void
+NC_free_varhash(NC *handle)
+{
+    if (handle->varhash != NULL) {
+        free(handle->varhash->first);
+        free(handle->varhash->next);
+        free(handle->varhash);
+        handle->varhash = NULL;
+    }
+}
+
+/*
+ * Bring the name hash of the variables of handle up to date: variables
+ * are only appended to a file, so those added since it was built are
+ * hashed, and the hash is built again once it is too full.
+ * Returns -1 if out of memory.
+ */
+static int
+NC_hash_vars(NC *handle)
+{
+    NC_varhash *vh    = handle->varhash;
+    unsigned    count = handle->vars != NULL ? handle->vars->count : 0;
+    NC_var     *vp;
+    unsigned    nbuckets;
+    int        *next;
+    int        *p;
+
+    if (vh != NULL && vh->nvars == count)
+        return 0;
+
+    if (vh == NULL || count > vh->nbuckets) {
+        NC_free_varhash(handle);
+        for (nbuckets = NC_VARHASH_MIN; nbuckets < 2 * count; nbuckets <<= 1)
+            ;
+        if ((vh = calloc(1, sizeof(NC_varhash))) == NULL)
+            return -1;
+        handle->varhash = vh;
+        vh->nbuckets    = nbuckets;
+        if ((vh->first = malloc(nbuckets * sizeof(int))) == NULL) {
+            NC_free_varhash(handle);
+            return -1;
+        }
+        memset(vh->first, 0xff, nbuckets * sizeof(int)); /* all -1 */
+    }
+
+    if ((next = realloc(vh->next, (count + 1) * sizeof(int))) == NULL) {
+        NC_free_varhash(handle);
+        return -1;
+    }
+    vh->next = next;
+
+    /* append each new variable to its chain, which stays in index order */
+    for (unsigned ii = vh->nvars; ii < count; ii++) {
+        vp       = NC_array_elem(handle->vars, ii);
+        next[ii] = -1;
+        for (p = &vh->first[NC_varhash_bucket(vh, vp->name->hash)]; *p != -1; p = &next[*p])
+            ;
+        *p = (int)ii;
+    }
+    vh->nvars = count;
+    return 0;
+}
+
+/*
+ * Return the index of the first variable named name after variable after,
+ * from the first variable if after is -1; -1 if there is none.
+ */
+int
+NC_findvar(NC *handle, const char *name, int after)
+{
+    NC_var  *vp;
+    unsigned len;
+    uint32   hash;
+    int      ii;
+
+    if (handle->vars == NULL)
+        return -1;
+
+    len = (unsigned)strlen(name);
+
+    /* no memory for the hash: look at every variable */
+    if (NC_hash_vars(handle) == -1) {
+        for (ii = after + 1; ii < (int)handle->vars->count; ii++) {
+            vp = NC_array_elem(handle->vars, (unsigned)ii);
+            if (len == vp->name->len && strncmp(name, vp->name->values, len) == 0)
+                return ii;
+        }
+        return -1;
+    }
+
+    hash = NC_hash_string(len, name);
+    if (after < 0)
+        ii = handle->varhash->first[NC_varhash_bucket(handle->varhash, hash)];
+    else
+        ii = handle->varhash->next[after];
+    for (; ii != -1; ii = handle->varhash->next[ii]) {
+        vp = NC_array_elem(handle->vars, (unsigned)ii);
+        if (vp->name->hash == hash && len == vp->name->len && strncmp(name, vp->name->values, len) == 0)
+            return ii;
+    }
+    return -1;
+}
+
 int
 ncvarid(int cdfid, const char *name)
 {
-    NC      *handle;
-    NC_var **dp;
-    int      len;
+    H4_API_ENTER;
+
+    NC *handle;
+    int varid;
 
     cdf_routine_name = "ncvarid";
 
@@ -333,13 +451,8 @@ ncvarid(int cdfid, const char *name)
         return -1;
     if (handle->vars == NULL)
         return -1;
-    len = strlen(name);
-    dp  = (NC_var **)handle->vars->values;
-    for (int ii = 0; ii < handle->vars->count; ii++, dp++) {
-        if (len == (*dp)->name->len && strncmp(name, (*dp)->name->values, len) == 0) {
-            return ii;
-        }
-    }
+    if ((varid = NC_findvar(handle, name, -1)) != -1)
+        return varid;
     NCadvise(NC_ENOTVAR, "variable \"%s\" not found", name);
     return -1;
 }
@@ -387,6 +500,8 @@ NC_lookupvar(int cdfid, int varid)
 int
 ncvarinq(int cdfid, int varid, char *name, nc_type *typep, int *ndimsp, int dims[], int *nattrsp)
 {
+    H4_API_ENTER;
+
     NC_var *vp;
 
     cdf_routine_name = "ncvarinq";
@@ -425,9 +540,11 @@ ncvarinq(int cdfid, int varid, char *name, nc_type *typep, int *ndimsp, int dims
 int
 ncvarrename(int cdfid, int varid, const char *newname)
 {
+    H4_API_ENTER;
+
     NC        *handle;
     NC_var   **vpp;
-    int        len;
+    int        ii;
     NC_string *old, *new;
 
     cdf_routine_name = "ncvarrename";
@@ -439,13 +556,9 @@ ncvarrename(int cdfid, int varid, const char *newname)
         return -1;
 
     /* check for name in use */
-    len = strlen(newname);
-    vpp = (NC_var **)handle->vars->values;
-    for (int ii = 0; ii < handle->vars->count; ii++, vpp++) {
-        if (len == (*vpp)->name->len && strncmp(newname, (*vpp)->name->values, len) == 0) {
-            NCadvise(NC_ENAMEINUSE, "variable name \"%s\" in use with index %d", (*vpp)->name->values, ii);
-            return -1;
-        }
+    if ((ii = NC_findvar(handle, newname, -1)) != -1) {
+        NCadvise(NC_ENAMEINUSE, "variable name \"%s\" in use with index %d", newname, ii);
+        return -1;
     }
 
     if (varid == NC_GLOBAL) /* Global is error in this context */
@@ -462,6 +575,9 @@ ncvarrename(int cdfid, int varid, const char *newname)
         return -1;
     }
 
+    /* the name hash is built again on the next lookup */
+    NC_free_varhash(handle);
+
     old = (*vpp)->name;
     if (NC_indefine(cdfid, TRUE)) {
         new = NC_new_string((unsigned)strlen(newname), newname);
@@ -74,6 +74,7 @@ set (HDF4_TESTMFHDF_FILES
     sds_szipped.hdf
     SDSchunkedsziped.hdf
     SDSchunkedsziped3d.hdf
+    SDSfindnames.hdf
     SDSlongname.hdf
     SDSunlimitedsziped.hdf
     test.cdf
@@ -86,6 +87,9 @@ set (HDF4_TESTMFHDF_FILES
     vars_samename.hdf
     tdfanndg.hdf
     tdfansdg.hdf
+    tmultiread.hdf
+    tasync.hdf
+    tasyncgr.hdf
 )
 add_test (
     NAME MFHDF_TEST-clearall-objects
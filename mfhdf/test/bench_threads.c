@@ -0,0 +1,219 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/****************************************************************************
+ * bench_threads.c - times SDreaddata called from 1, 2, 4, 8, 16 and 32
+ *      threads, each thread reading a data set of its own file.
+ *
+ *      Every file holds one nrows x ncols float32 data set, stored
+ *      big-endian so that reading it also converts it on little-endian
+ *      hosts.  Each thread opens its file, reads the whole data set
+ *      nreads times and closes the file.  Readers of different files
+ *      share the API lock of the thread-safe library, so the throughput
+ *      should grow with the number of threads, up to the number of CPUs.
+ *
+ *      The library must be built thread-safe; otherwise only one thread
+ *      is timed.
+ *
+ *      This is not run as part of the test suite.
+ *
+ * Usage: bench_threads [nrows ncols [nreads]]
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mfhdf.h"
+
+#ifdef H4_HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+#ifdef H4_HAVE_THREADSAFE
+#include <pthread.h>
+#endif
+
+#define BENCH_FILE  "bench_threads%d.hdf"
+#define MAX_THREADS 32
+#define NROWS       512
+#define NCOLS       512
+#define NREADS      20
+
+typedef struct {
+    int   id;     /* thread number, also the number of its file */
+    int32 nrows;  /* size of the data set */
+    int32 ncols;
+    int   nreads; /* times the data set is read */
+    int   status; /* SUCCEED/FAIL */
+} reader_t;
+
+/* Wall clock time in seconds */
+static double
+now(void)
+{
+#ifdef H4_HAVE_SYS_TIME_H
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1e6;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* Create file number 'id' with its data set */
+static int
+make_file(int id, int32 nrows, int32 ncols)
+{
+    char     name[32];
+    int32    dims[2]  = {nrows, ncols};
+    int32    start[2] = {0, 0};
+    float32 *data;
+    int32    fid, sds_id;
+    size_t   i;
+    int      ret_value = SUCCEED;
+
+    if ((data = (float32 *)malloc((size_t)nrows * (size_t)ncols * sizeof(float32))) == NULL)
+        return FAIL;
+    for (i = 0; i < (size_t)nrows * (size_t)ncols; i++)
+        data[i] = (float32)(id * 1000 + i % 1000);
+
+    snprintf(name, sizeof(name), BENCH_FILE, id);
+    if ((fid = SDstart(name, DFACC_CREATE)) == FAIL ||
+        (sds_id = SDcreate(fid, "data", DFNT_FLOAT32, 2, dims)) == FAIL ||
+        SDwritedata(sds_id, start, NULL, dims, data) == FAIL || SDendaccess(sds_id) == FAIL ||
+        SDend(fid) == FAIL)
+        ret_value = FAIL;
+
+    free(data);
+    return ret_value;
+}
+
+/* Read the data set of the thread's file nreads times */
+static void *
+reader(void *arg)
+{
+    reader_t *r = (reader_t *)arg;
+    char      name[32];
+    int32     dims[2]  = {r->nrows, r->ncols};
+    int32     start[2] = {0, 0};
+    float32  *data;
+    int32     fid, sds_id;
+    int       i;
+
+    r->status = FAIL;
+    if ((data = (float32 *)malloc((size_t)r->nrows * (size_t)r->ncols * sizeof(float32))) == NULL)
+        return NULL;
+
+    snprintf(name, sizeof(name), BENCH_FILE, r->id);
+    if ((fid = SDstart(name, DFACC_READ)) != FAIL) {
+        if ((sds_id = SDselect(fid, 0)) != FAIL) {
+            for (i = 0; i < r->nreads; i++)
+                if (SDreaddata(sds_id, start, NULL, dims, data) == FAIL)
+                    break;
+            if (i == r->nreads && data[1] == (float32)(r->id * 1000 + 1))
+                r->status = SUCCEED;
+            SDendaccess(sds_id);
+        }
+        SDend(fid);
+    }
+
+    free(data);
+    return NULL;
+}
+
+int
+main(int argc, char *argv[])
+{
+    reader_t readers[MAX_THREADS];
+    int32    nrows   = NROWS;
+    int32    ncols   = NCOLS;
+    int      nreads  = NREADS;
+    int      max_thr = Histhreadsafe() ? MAX_THREADS : 1;
+    double   base    = 0.0;
+    int      nthreads, i;
+
+    if (argc > 2) {
+        nrows = (int32)atol(argv[1]);
+        ncols = (int32)atol(argv[2]);
+    }
+    if (argc > 3)
+        nreads = atoi(argv[3]);
+    if (nrows <= 0 || ncols <= 0 || nreads <= 0) {
+        fprintf(stderr, "usage: %s [nrows ncols [nreads]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < max_thr; i++)
+        if (make_file(i, nrows, ncols) == FAIL) {
+            fprintf(stderr, "cannot create " BENCH_FILE "\n", i);
+            return EXIT_FAILURE;
+        }
+
+    if (max_thr == 1)
+        printf("the library is not thread-safe, timing one thread only\n");
+    printf("%ld x %ld float32, read %d times by each thread from its own file\n", (long)nrows, (long)ncols,
+           nreads);
+    printf("%-8s %10s %12s %8s\n", "threads", "seconds", "MB/s", "speedup");
+
+    for (nthreads = 1; nthreads <= max_thr; nthreads *= 2) {
+        double t0, t1, mb;
+
+        for (i = 0; i < nthreads; i++) {
+            readers[i].id     = i;
+            readers[i].nrows  = nrows;
+            readers[i].ncols  = ncols;
+            readers[i].nreads = nreads;
+            readers[i].status = FAIL;
+        }
+
+        t0 = now();
+#ifdef H4_HAVE_THREADSAFE
+        {
+            pthread_t threads[MAX_THREADS];
+
+            for (i = 0; i < nthreads; i++)
+                if (pthread_create(&threads[i], NULL, reader, &readers[i]) != 0) {
+                    fprintf(stderr, "cannot start thread %d\n", i);
+                    return EXIT_FAILURE;
+                }
+            for (i = 0; i < nthreads; i++)
+                pthread_join(threads[i], NULL);
+        }
+#else
+        reader(&readers[0]);
+#endif
+        t1 = now();
+
+        for (i = 0; i < nthreads; i++)
+            if (readers[i].status == FAIL) {
+                fprintf(stderr, "thread %d failed to read " BENCH_FILE "\n", i, i);
+                return EXIT_FAILURE;
+            }
+
+        mb = (double)nthreads * nreads * nrows * ncols * sizeof(float32) / 1e6;
+        if (nthreads == 1)
+            base = t1 - t0 > 0.0 ? mb / (t1 - t0) : 0.0;
+        printf("%-8d %10.3f %12.1f %8.2f\n", nthreads, t1 - t0, t1 - t0 > 0.0 ? mb / (t1 - t0) : 0.0,
+               base > 0.0 && t1 - t0 > 0.0 ? mb / (t1 - t0) / base : 0.0);
+    }
+
+    for (i = 0; i < max_thr; i++) {
+        char name[32];
+
+        snprintf(name, sizeof(name), BENCH_FILE, i);
+        remove(name);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,251 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/****************************************************************************
+ * bench_xdr_cache.c - times reads of a classic netCDF file through the nc
+ *      API with different settings of the XDR I/O cache (see ncsetcache).
+ *
+ *      The file holds two 2-D float variables. Two access patterns are
+ *      timed:
+ *      + interleaved - reads a row of the first variable, then the same row
+ *        of the second, and so on
+ *      + strided     - reads columns of the first variable with ncvargets,
+ *        touching a different page for every element
+ *
+ *      The "single 8K page" setting reproduces the old behavior of the
+ *      library, which kept exactly one 8 KB buffer per file.
+ *
+ *      This is not run as part of the test suite.
+ *
+ * Usage: bench_xdr_cache [nrows ncols]
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mfhdf.h"
+
+#ifdef H4_HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+#define BENCH_FILE  "bench_xdr_cache.nc"
+#define NROWS       512
+#define NCOLS       512
+#define NSTRIDECOLS 16
+
+/* Classic netCDF header tags */
+#define NC_DIMENSION_TAG 10
+#define NC_VARIABLE_TAG  11
+
+typedef struct {
+    const char *name;
+    long        pagesize;
+    int         npages;
+} cache_setting_t;
+
+static const cache_setting_t settings[] = {
+    {"single 8K page", 8192, 1},
+    {"default", 0, 0},
+    {"32 x 64K pages", 65536, 32},
+    {"16 x 1M pages", 1048576, 16},
+};
+
+/* Wall clock time in seconds */
+static double
+now(void)
+{
+#ifdef H4_HAVE_SYS_TIME_H
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1e6;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* Write a 4-byte big-endian (XDR) integer */
+static void
+put_int(FILE *fp, uint32_t val)
+{
+    unsigned char b[4];
+
+    b[0] = (unsigned char)(val >> 24);
+    b[1] = (unsigned char)(val >> 16);
+    b[2] = (unsigned char)(val >> 8);
+    b[3] = (unsigned char)val;
+    fwrite(b, 1, 4, fp);
+}
+
+/* Write an XDR string padded to a 4-byte boundary */
+static void
+put_name(FILE *fp, const char *name)
+{
+    static const char pad[4] = {0, 0, 0, 0};
+    size_t            len    = strlen(name);
+
+    put_int(fp, (uint32_t)len);
+    fwrite(name, 1, len, fp);
+    fwrite(pad, 1, (4 - len % 4) % 4, fp);
+}
+
+/*
+ * Write a classic netCDF file with two nrows x ncols float variables, "a"
+ * and "b". The nc API can only create HDF files, so the header is written
+ * by hand.
+ */
+static int
+make_file(long nrows, long ncols)
+{
+    FILE    *fp;
+    uint32_t vsize  = (uint32_t)(nrows * ncols * 4);
+    uint32_t header = 4 + 4 + (4 + 4 + 2 * (8 + 4)) + 8 + (4 + 4 + 2 * (8 + 4 + 8 + 8 + 4 + 4 + 4));
+    long     i, v;
+
+    if (NULL == (fp = fopen(BENCH_FILE, "wb")))
+        return -1;
+
+    fwrite("CDF\001", 1, 4, fp);
+    put_int(fp, 0); /* numrecs */
+
+    put_int(fp, NC_DIMENSION_TAG);
+    put_int(fp, 2);
+    put_name(fp, "rows");
+    put_int(fp, (uint32_t)nrows);
+    put_name(fp, "cols");
+    put_int(fp, (uint32_t)ncols);
+
+    put_int(fp, 0); /* no global attributes */
+    put_int(fp, 0);
+
+    put_int(fp, NC_VARIABLE_TAG);
+    put_int(fp, 2);
+    for (v = 0; v < 2; v++) {
+        put_name(fp, v == 0 ? "a" : "b");
+        put_int(fp, 2); /* rank */
+        put_int(fp, 0); /* dimids */
+        put_int(fp, 1);
+        put_int(fp, 0); /* no attributes */
+        put_int(fp, 0);
+        put_int(fp, NC_FLOAT);
+        put_int(fp, vsize);
+        put_int(fp, header + (uint32_t)v * vsize); /* begin */
+    }
+
+    for (v = 0; v < 2; v++) {
+        for (i = 0; i < nrows * ncols; i++) {
+            float    f = (float)(v * nrows * ncols + i);
+            uint32_t u;
+
+            memcpy(&u, &f, sizeof(u));
+            put_int(fp, u);
+        }
+    }
+
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+/* Read row i of "a" then row i of "b", for all rows */
+static int
+read_interleaved(int ncid, long nrows, long ncols, float *buf)
+{
+    long start[2], edges[2];
+    long i;
+
+    edges[0] = 1;
+    edges[1] = ncols;
+    start[1] = 0;
+    for (i = 0; i < nrows; i++) {
+        start[0] = i;
+        if (ncvarget(ncid, 0, start, edges, buf) == -1)
+            return -1;
+        if (ncvarget(ncid, 1, start, edges, buf) == -1)
+            return -1;
+    }
+    return 0;
+}
+
+/* Read the first NSTRIDECOLS columns of "a", one at a time */
+static int
+read_strided(int ncid, long nrows, float *buf)
+{
+    long start[2], edges[2], stride[2];
+    long j;
+
+    start[0]  = 0;
+    edges[0]  = nrows;
+    edges[1]  = 1;
+    stride[0] = 1;
+    stride[1] = 1;
+    for (j = 0; j < NSTRIDECOLS; j++) {
+        start[1] = j;
+        if (ncvargets(ncid, 0, start, edges, stride, buf) == -1)
+            return -1;
+    }
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    long   nrows = NROWS;
+    long   ncols = NCOLS;
+    float *buf;
+    size_t i;
+
+    if (argc == 3) {
+        nrows = atol(argv[1]);
+        ncols = atol(argv[2]);
+    }
+    if (nrows <= 0 || ncols <= 0) {
+        fprintf(stderr, "usage: %s [nrows ncols]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (make_file(nrows, ncols) < 0) {
+        fprintf(stderr, "cannot create %s\n", BENCH_FILE);
+        return EXIT_FAILURE;
+    }
+
+    if (NULL == (buf = (float *)malloc((size_t)(nrows > ncols ? nrows : ncols) * sizeof(float))))
+        return EXIT_FAILURE;
+
+    printf("%ld x %ld floats per variable\n", nrows, ncols);
+    printf("%-20s %14s %14s\n", "cache", "interleaved(s)", "strided(s)");
+
+    for (i = 0; i < sizeof(settings) / sizeof(settings[0]); i++) {
+        double t0, t1, t2;
+        int    ncid;
+
+        if ((ncid = ncopen(BENCH_FILE, NC_NOWRITE)) == -1)
+            return EXIT_FAILURE;
+        if (ncsetcache(ncid, settings[i].pagesize, settings[i].npages) == -1)
+            return EXIT_FAILURE;
+
+        t0 = now();
+        if (read_interleaved(ncid, nrows, ncols, buf) < 0)
+            return EXIT_FAILURE;
+        t1 = now();
+        if (read_strided(ncid, nrows, buf) < 0)
+            return EXIT_FAILURE;
+        t2 = now();
+
+        printf("%-20s %14.4f %14.4f\n", settings[i].name, t1 - t0, t2 - t1);
+        ncclose(ncid);
+    }
+
+    free(buf);
+    remove(BENCH_FILE);
+    return EXIT_SUCCESS;
+}
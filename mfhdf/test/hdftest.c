@@ -64,6 +64,9 @@ extern int test_datasizes();
 extern int test_datainfo();
 extern int test_external();
 extern int test_att_ann_datainfo();
+extern int test_readmulti();
+extern int test_readasync();
+extern int test_threadsafe();
 
 int
 main(void)
@@ -1334,6 +1337,18 @@ main(void)
     status   = test_szip_compression(); /* in tszip.c */
     num_errs = num_errs + status;
 
+    /* Tests reading many hyperslabs at once (in tmultiread.c) */
+    status   = test_readmulti();
+    num_errs = num_errs + status;
+
+    /* Tests reading in the background (in tasync.c) */
+    status   = test_readasync();
+    num_errs = num_errs + status;
+
+    /* Tests calling the library from several threads (in tthreadsafe.c) */
+    status   = test_threadsafe();
+    num_errs = num_errs + status;
+
     /* BMR: This test fails on some systems when the user are logged in
      * as root.  We decided to comment it out until further work can be
      * attempted. (in tsd.c) 11/04/05 */
@@ -0,0 +1,228 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/****************************************************************************
+ * tasync.c - tests SDreaddata_async and GRreadimage_async.
+ * Structure of the file:
+ *    test_readasync - test driver: reads the bands of a chunked,
+ *          compressed data set and of an image in the background, and
+ *          checks the data, that the callbacks of a file come in the
+ *          order the reads were submitted, and that a failed read hands
+ *          its errors to its callback
+ *    read_done - callback of the reads; records what it was given
+ ****************************************************************************/
+
+#include <string.h>
+
+#include "mfhdf.h"
+
+#include "hdftest.h"
+
+#define ASYNC_FILE "tasync.hdf"
+#define GR_FILE    "tasyncgr.hdf"
+#define NROWS      64
+#define NCOLS      50
+#define BAND       4
+#define NBANDS     (NROWS / BAND)
+#define NREADS     (NBANDS + 1) /* the bands and a read out of the data set */
+
+/* What the callback of a read records */
+typedef struct {
+    int32 id;       /* ID it was given */
+    int   status;   /* status of the read */
+    int   error;    /* first error on the stack, DFE_NONE if none */
+    int   position; /* how many callbacks came before */
+    int   waited;   /* what Hasyncwait returned in the callback */
+} read_result_t;
+
+/* Callbacks come one at a time, as all the reads are of the same file */
+static int ndone = 0;
+
+static void
+read_done(int32 id, int status, void *ctx)
+{
+    read_result_t *res = (read_result_t *)ctx;
+
+    res->id       = id;
+    res->status   = status;
+    res->error    = (int)HEvalue(1);
+    res->position = ndone++;
+    res->waited   = Hasyncwait();
+}
+
+extern int
+test_readasync(void)
+{
+    static int32  data[NROWS][NCOLS];
+    static int32  bands[NBANDS][BAND][NCOLS];
+    static uint16 image[NROWS][NCOLS];
+    static uint16 halves[2][NROWS / 2][NCOLS];
+    read_result_t results[NREADS];
+    int32         fid, sds, file_id, grid, riid;
+    int32         dims[2], start[2], edge[2], stride[2];
+    int32         il = MFGR_INTERLACE_PIXEL;
+    HDF_CHUNK_DEF chunk_def;
+    int32         i, j;
+    int           status;
+    int           num_errs = 0; /* number of errors so far */
+
+    TESTING("reading in the background (tasync.c)");
+
+    for (i = 0; i < NROWS; i++)
+        for (j = 0; j < NCOLS; j++) {
+            data[i][j]  = i * 1000 + j;
+            image[i][j] = (uint16)(i * NCOLS + j);
+        }
+
+    fid = SDstart(ASYNC_FILE, DFACC_CREATE);
+    CHECK(fid, FAIL, "test_readasync: SDstart");
+    dims[0] = NROWS;
+    dims[1] = NCOLS;
+    sds     = SDcreate(fid, "data", DFNT_INT32, 2, dims);
+    CHECK(sds, FAIL, "test_readasync: SDcreate");
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = 8;
+    chunk_def.comp.chunk_lengths[1]    = NCOLS;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 1;
+    status                             = SDsetchunk(sds, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "test_readasync: SDsetchunk");
+    start[0] = start[1] = 0;
+    status              = SDwritedata(sds, start, NULL, dims, data);
+    CHECK(status, FAIL, "test_readasync: SDwritedata");
+    status = SDendaccess(sds);
+    CHECK(status, FAIL, "test_readasync: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_readasync: SDend");
+
+    /* Read the bands, then a hyperslab out of the data set */
+    fid = SDstart(ASYNC_FILE, DFACC_READ);
+    CHECK(fid, FAIL, "test_readasync: SDstart");
+    sds = SDselect(fid, 0);
+    CHECK(sds, FAIL, "test_readasync: SDselect");
+
+    memset(results, 0, sizeof(results));
+    ndone     = 0;
+    edge[0]   = BAND;
+    edge[1]   = NCOLS;
+    stride[0] = stride[1] = 1;
+    for (i = 0; i < NBANDS; i++) {
+        start[0] = i * BAND;
+        status   = SDreaddata_async(sds, start, NULL, edge, bands[i], read_done, &results[i]);
+        CHECK(status, FAIL, "test_readasync: SDreaddata_async");
+    }
+
+    /* The stride is checked against the dimensions, with an error on the stack */
+    start[0] = NROWS - 1;
+    status   = SDreaddata_async(sds, start, stride, edge, bands[0], read_done, &results[NBANDS]);
+    CHECK(status, FAIL, "test_readasync: SDreaddata_async");
+
+    /* Bad arguments are caught at once */
+    status = SDreaddata_async(sds, start, NULL, edge, bands[0], NULL, &results[0]);
+    VERIFY(status, FAIL, "test_readasync: SDreaddata_async");
+    status = SDreaddata_async(fid, start, NULL, edge, bands[0], read_done, &results[0]);
+    VERIFY(status, FAIL, "test_readasync: SDreaddata_async");
+
+    status = Hasyncwait();
+    CHECK(status, FAIL, "test_readasync: Hasyncwait");
+    VERIFY(ndone, NREADS, "test_readasync: SDreaddata_async");
+
+    for (i = 0; i < NREADS; i++) {
+        VERIFY(results[i].id, sds, "test_readasync: SDreaddata_async");
+        VERIFY(results[i].position, i, "test_readasync: SDreaddata_async");
+        VERIFY(results[i].waited, (Histhreadsafe() ? FAIL : SUCCEED), "test_readasync: Hasyncwait");
+        if (i < NBANDS) {
+            VERIFY(results[i].status, SUCCEED, "test_readasync: SDreaddata_async");
+            VERIFY(results[i].error, DFE_NONE, "test_readasync: SDreaddata_async");
+        }
+        else {
+            VERIFY(results[i].status, FAIL, "test_readasync: SDreaddata_async");
+            if (results[i].error == DFE_NONE) {
+                fprintf(stderr, "test_readasync: the failed read left no error for its callback\n");
+                num_errs++;
+            }
+        }
+    }
+    if (memcmp(bands, data, sizeof(bands)) != 0) {
+        fprintf(stderr, "test_readasync: SDreaddata_async read wrong values\n");
+        num_errs++;
+    }
+
+    status = SDendaccess(sds);
+    CHECK(status, FAIL, "test_readasync: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_readasync: SDend");
+
+    /* Read the halves of an image, every other column, on one thread */
+    status = Hsetasyncthreads(0);
+    VERIFY(status, FAIL, "test_readasync: Hsetasyncthreads");
+    status = Hsetasyncthreads(1);
+    CHECK(status, FAIL, "test_readasync: Hsetasyncthreads");
+
+    file_id = Hopen(GR_FILE, DFACC_CREATE, 0);
+    CHECK(file_id, FAIL, "test_readasync: Hopen");
+    grid = GRstart(file_id);
+    CHECK(grid, FAIL, "test_readasync: GRstart");
+    dims[0] = NCOLS;
+    dims[1] = NROWS;
+    riid    = GRcreate(grid, "image", 1, DFNT_UINT16, il, dims);
+    CHECK(riid, FAIL, "test_readasync: GRcreate");
+    start[0] = start[1] = 0;
+    status              = GRwriteimage(riid, start, NULL, dims, image);
+    CHECK(status, FAIL, "test_readasync: GRwriteimage");
+
+    memset(results, 0, sizeof(results));
+    memset(halves, 0, sizeof(halves));
+    ndone     = 0;
+    stride[0] = 2;
+    stride[1] = 1;
+    edge[0]   = NCOLS / 2;
+    edge[1]   = NROWS / 2;
+    for (i = 0; i < 2; i++) {
+        start[1] = i * (NROWS / 2);
+        status   = GRreadimage_async(riid, start, stride, edge, halves[i], read_done, &results[i]);
+        CHECK(status, FAIL, "test_readasync: GRreadimage_async");
+    }
+    status = GRreadimage_async(grid, start, stride, edge, halves[0], read_done, &results[0]);
+    VERIFY(status, FAIL, "test_readasync: GRreadimage_async");
+
+    status = Hasyncwait();
+    CHECK(status, FAIL, "test_readasync: Hasyncwait");
+    VERIFY(ndone, 2, "test_readasync: GRreadimage_async");
+    for (i = 0; i < 2; i++) {
+        VERIFY(results[i].id, riid, "test_readasync: GRreadimage_async");
+        VERIFY(results[i].status, SUCCEED, "test_readasync: GRreadimage_async");
+        VERIFY(results[i].position, i, "test_readasync: GRreadimage_async");
+        for (j = 0; j < NROWS / 2 * (NCOLS / 2); j++)
+            if (((uint16 *)halves[i])[j] != image[i * (NROWS / 2) + j / (NCOLS / 2)][j % (NCOLS / 2) * 2]) {
+                fprintf(stderr, "test_readasync: GRreadimage_async read wrong values\n");
+                num_errs++;
+                break;
+            }
+    }
+
+    status = GRendaccess(riid);
+    CHECK(status, FAIL, "test_readasync: GRendaccess");
+    status = GRend(grid);
+    CHECK(status, FAIL, "test_readasync: GRend");
+    status = Hclose(file_id);
+    CHECK(status, FAIL, "test_readasync: Hclose");
+
+    status = Hsetasyncthreads(4);
+    CHECK(status, FAIL, "test_readasync: Hsetasyncthreads");
+
+    if (num_errs == 0)
+        PASSED();
+    else
+        H4_FAILED();
+    return num_errs;
+}
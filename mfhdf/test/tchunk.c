@@ -11,6 +11,7 @@
  * help@hdfgroup.org.                                                        *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "mfhdf.h"
@@ -19,6 +20,21 @@
 
 #define CHKFILE   "chktst.hdf"  /* Chunking test file */
 #define CNBITFILE "chknbit.hdf" /* Chunking w/ NBIT compression */
+#define CBUDFILE  "chkbud.hdf"  /* Chunk cache budget */
+#define CTHRFILE  "chkthr.hdf"  /* Chunks decoded on several threads */
+#define CRAWFILE  "chkraw.hdf"  /* Chunks copied as they are stored */
+
+/* Data sets for the chunk cache budget test */
+#define BUD_DIM   60
+#define BUD_CDIM  10
+#define BUD_CHUNK (BUD_CDIM * BUD_CDIM * (int32)sizeof(int32))
+
+/* Data set for the read threads test; the last planes are not written */
+#define THR_DIM0    20
+#define THR_DIM1    30
+#define THR_DIM2    40
+#define THR_WRITTEN 15
+#define THR_FILL    (-1)
 
 /* Dimensions of slab */
 static int32 edge_dims[3]  = {2, 3, 4}; /* size of slab dims */
@@ -78,6 +94,621 @@ static uint16 u16_data[2][3][4] = {{{0, 1, 2, 3}, {10, 11, 12, 13}, {20, 21, 22,
 static uint8 u8_data[2][3][4] = {{{0, 1, 2, 3}, {10, 11, 12, 13}, {20, 21, 22, 23}},
                                  {{100, 101, 102, 103}, {110, 111, 112, 113}, {120, 121, 122, 123}}};
 
+/* Check both data sets of the chunk cache budget test */
+static int
+check_budget_data(int32 sds[2], int32 delta)
+{
+    int32 start[2], edges[2];
+    int32 col[BUD_DIM];
+    int   i, j, k;
+    int   status;
+    int   num_errs = 0; /* number of errors so far */
+
+    /* read columns of both data sets in turn, so that every read needs
+       chunks of the other data set to be dropped */
+    start[0] = 0;
+    edges[0] = BUD_DIM;
+    edges[1] = 1;
+    for (j = 0; j < BUD_DIM; j++) {
+        start[1] = j;
+        for (k = 0; k < 2; k++) {
+            status = SDreaddata(sds[k], start, NULL, edges, col);
+            CHECK(status, FAIL, "check_budget_data: SDreaddata");
+            for (i = 0; i < BUD_DIM; i++)
+                if (col[i] != (k + 1) * (i * BUD_DIM + j + delta)) {
+                    fprintf(stderr, "check_budget_data: data set %d, [%d][%d] is %d\n", k, i, j, (int)col[i]);
+                    num_errs++;
+                    return num_errs;
+                }
+        }
+    }
+    return num_errs;
+}
+
+/* Chunked data sets written and read through a shared chunk cache budget
+   much smaller than their own caches */
+static int
+test_chunk_budget(void)
+{
+    int32         fid, sds[2];
+    int32         dims[2], start[2], edges[2];
+    int32         row[BUD_DIM];
+    HDF_CHUNK_DEF chunk_def;
+    char          name[16];
+    int           i, j, k;
+    int           status;
+    int           num_errs = 0; /* number of errors so far */
+
+    fid = SDstart(CBUDFILE, DFACC_CREATE);
+    CHECK(fid, FAIL, "test_chunk_budget: SDstart");
+
+    status = SDsetchunkcachebudget(fid, -1);
+    VERIFY(status, FAIL, "test_chunk_budget: SDsetchunkcachebudget");
+
+    /* room for 10 of the 72 chunks */
+    status = SDsetchunkcachebudget(fid, 10 * BUD_CHUNK);
+    CHECK(status, FAIL, "test_chunk_budget: SDsetchunkcachebudget");
+
+    dims[0]                    = BUD_DIM;
+    dims[1]                    = BUD_DIM;
+    chunk_def.chunk_lengths[0] = BUD_CDIM;
+    chunk_def.chunk_lengths[1] = BUD_CDIM;
+    for (k = 0; k < 2; k++) {
+        snprintf(name, sizeof(name), "data%d", k);
+        sds[k] = SDcreate(fid, name, DFNT_INT32, 2, dims);
+        CHECK(sds[k], FAIL, "test_chunk_budget: SDcreate");
+        status = SDsetchunk(sds[k], chunk_def, HDF_CHUNK);
+        CHECK(status, FAIL, "test_chunk_budget: SDsetchunk");
+        status = SDsetchunkcache(sds[k], (BUD_DIM / BUD_CDIM) * (BUD_DIM / BUD_CDIM), 0);
+        CHECK(status, FAIL, "test_chunk_budget: SDsetchunkcache");
+    }
+
+    /* write rows of both data sets in turn; dirty chunks of either one
+       get written out to make room for the other */
+    start[1] = 0;
+    edges[0] = 1;
+    edges[1] = BUD_DIM;
+    for (i = 0; i < BUD_DIM; i++) {
+        start[0] = i;
+        for (k = 0; k < 2; k++) {
+            for (j = 0; j < BUD_DIM; j++)
+                row[j] = (k + 1) * (i * BUD_DIM + j);
+            status = SDwritedata(sds[k], start, NULL, edges, row);
+            CHECK(status, FAIL, "test_chunk_budget: SDwritedata");
+        }
+    }
+    num_errs += check_budget_data(sds, 0);
+
+    /* overwrite the first rows, then shrink the budget while those
+       chunks are dirty: they are written out right away */
+    for (i = 0; i < BUD_CDIM; i++) {
+        start[0] = i;
+        for (k = 0; k < 2; k++) {
+            for (j = 0; j < BUD_DIM; j++)
+                row[j] = (k + 1) * (i * BUD_DIM + j + 1);
+            status = SDwritedata(sds[k], start, NULL, edges, row);
+            CHECK(status, FAIL, "test_chunk_budget: SDwritedata");
+        }
+    }
+    status = SDsetchunkcachebudget(fid, BUD_CHUNK);
+    CHECK(status, FAIL, "test_chunk_budget: SDsetchunkcachebudget");
+    status = SDsetchunkcachebudget(fid, 0);
+    CHECK(status, FAIL, "test_chunk_budget: SDsetchunkcachebudget");
+
+    for (k = 0; k < 2; k++) {
+        status = SDendaccess(sds[k]);
+        CHECK(status, FAIL, "test_chunk_budget: SDendaccess");
+    }
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_chunk_budget: SDend");
+
+    /* reopen with a budget of a single chunk and check the file */
+    fid = SDstart(CBUDFILE, DFACC_READ);
+    CHECK(fid, FAIL, "test_chunk_budget: SDstart");
+    status = SDsetchunkcachebudget(fid, BUD_CHUNK);
+    CHECK(status, FAIL, "test_chunk_budget: SDsetchunkcachebudget");
+    for (k = 0; k < 2; k++) {
+        sds[k] = SDselect(fid, k);
+        CHECK(sds[k], FAIL, "test_chunk_budget: SDselect");
+    }
+
+    /* the first rows were overwritten with values shifted by one */
+    start[1] = 0;
+    edges[0] = 1;
+    edges[1] = BUD_DIM;
+    for (i = 0; i < BUD_CDIM; i++) {
+        start[0] = i;
+        for (k = 0; k < 2; k++) {
+            status = SDreaddata(sds[k], start, NULL, edges, row);
+            CHECK(status, FAIL, "test_chunk_budget: SDreaddata");
+            for (j = 0; j < BUD_DIM; j++)
+                VERIFY(row[j], ((k + 1) * (i * BUD_DIM + j + 1)), "test_chunk_budget: SDreaddata");
+        }
+    }
+
+    for (k = 0; k < 2; k++) {
+        status = SDendaccess(sds[k]);
+        CHECK(status, FAIL, "test_chunk_budget: SDendaccess");
+    }
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_chunk_budget: SDend");
+
+    return num_errs;
+}
+
+/* Value of the read threads test data set at [i][j][k] */
+static int32
+thr_value(int i, int j, int k)
+{
+    return i < THR_WRITTEN ? (i * THR_DIM1 + j) * THR_DIM2 + k : THR_FILL;
+}
+
+/* A deflate compressed data set read with its chunks decoded on several
+   threads, through a hyperslab and then whole */
+static int
+test_chunk_threads(void)
+{
+    int32         fid, sds, sds_plain, sds_contig;
+    int32         dims[3], start[3], edges[3];
+    int32        *data = NULL;
+    int32         fill = THR_FILL;
+    HDF_CHUNK_DEF chunk_def;
+    int           i, j, k, n;
+    int           status;
+    int           num_errs = 0; /* number of errors so far */
+
+    data = (int32 *)malloc(THR_DIM0 * THR_DIM1 * THR_DIM2 * sizeof(int32));
+    CHECK_ALLOC(data, "data", "test_chunk_threads");
+
+    fid = SDstart(CTHRFILE, DFACC_CREATE);
+    CHECK(fid, FAIL, "test_chunk_threads: SDstart");
+
+    dims[0] = THR_DIM0;
+    dims[1] = THR_DIM1;
+    dims[2] = THR_DIM2;
+    sds     = SDcreate(fid, "deflated", DFNT_INT32, 3, dims);
+    CHECK(sds, FAIL, "test_chunk_threads: SDcreate");
+    status = SDsetfillvalue(sds, &fill);
+    CHECK(status, FAIL, "test_chunk_threads: SDsetfillvalue");
+
+    /* 48 chunks of 5x10x10 */
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = 5;
+    chunk_def.comp.chunk_lengths[1]    = 10;
+    chunk_def.comp.chunk_lengths[2]    = 10;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+    status                             = SDsetchunk(sds, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "test_chunk_threads: SDsetchunk");
+
+    for (i = 0, n = 0; i < THR_WRITTEN; i++)
+        for (j = 0; j < THR_DIM1; j++)
+            for (k = 0; k < THR_DIM2; k++)
+                data[n++] = thr_value(i, j, k);
+    start[0] = start[1] = start[2] = 0;
+    edges[0]                       = THR_WRITTEN;
+    edges[1]                       = THR_DIM1;
+    edges[2]                       = THR_DIM2;
+    status                         = SDwritedata(sds, start, NULL, edges, data);
+    CHECK(status, FAIL, "test_chunk_threads: SDwritedata");
+
+    /* neither an uncompressed chunked data set nor a contiguous one is
+       read by threads; only the contiguous one is an error */
+    sds_plain = SDcreate(fid, "plain", DFNT_INT32, 3, dims);
+    CHECK(sds_plain, FAIL, "test_chunk_threads: SDcreate");
+    status = SDsetchunk(sds_plain, chunk_def, HDF_CHUNK);
+    CHECK(status, FAIL, "test_chunk_threads: SDsetchunk");
+    status = SDsetreadthreads(sds_plain, 4);
+    CHECK(status, FAIL, "test_chunk_threads: SDsetreadthreads");
+
+    sds_contig = SDcreate(fid, "contiguous", DFNT_INT32, 3, dims);
+    CHECK(sds_contig, FAIL, "test_chunk_threads: SDcreate");
+    status = SDsetreadthreads(sds_contig, 4);
+    VERIFY(status, FAIL, "test_chunk_threads: SDsetreadthreads");
+
+    status = SDendaccess(sds_contig);
+    CHECK(status, FAIL, "test_chunk_threads: SDendaccess");
+    status = SDendaccess(sds_plain);
+    CHECK(status, FAIL, "test_chunk_threads: SDendaccess");
+    status = SDendaccess(sds);
+    CHECK(status, FAIL, "test_chunk_threads: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_chunk_threads: SDend");
+
+    fid = SDstart(CTHRFILE, DFACC_READ);
+    CHECK(fid, FAIL, "test_chunk_threads: SDstart");
+    sds = SDselect(fid, SDnametoindex(fid, "deflated"));
+    CHECK(sds, FAIL, "test_chunk_threads: SDselect");
+
+    status = SDsetreadthreads(sds, -1);
+    VERIFY(status, FAIL, "test_chunk_threads: SDsetreadthreads");
+    status = SDsetchunkcache(sds, 48, 0);
+    CHECK(status, FAIL, "test_chunk_threads: SDsetchunkcache");
+    status = SDsetreadthreads(sds, 4);
+    CHECK(status, FAIL, "test_chunk_threads: SDsetreadthreads");
+
+    /* a hyperslab across written and unwritten chunks */
+    start[0] = 2;
+    start[1] = 5;
+    start[2] = 7;
+    edges[0] = 16;
+    edges[1] = 20;
+    edges[2] = 25;
+    memset(data, 0, THR_DIM0 * THR_DIM1 * THR_DIM2 * sizeof(int32));
+    status = SDreaddata(sds, start, NULL, edges, data);
+    CHECK(status, FAIL, "test_chunk_threads: SDreaddata");
+    for (i = 0, n = 0; i < edges[0]; i++)
+        for (j = 0; j < edges[1]; j++)
+            for (k = 0; k < edges[2]; k++, n++)
+                if (data[n] != thr_value(i + start[0], j + start[1], k + start[2])) {
+                    fprintf(stderr, "test_chunk_threads: hyperslab [%d][%d][%d] is %d\n", i, j, k,
+                            (int)data[n]);
+                    num_errs++;
+                    goto done;
+                }
+    status = SDendaccess(sds);
+    CHECK(status, FAIL, "test_chunk_threads: SDendaccess");
+
+    /* the whole data set, with an empty cache */
+    sds = SDselect(fid, SDnametoindex(fid, "deflated"));
+    CHECK(sds, FAIL, "test_chunk_threads: SDselect");
+    status = SDsetchunkcache(sds, 48, 0);
+    CHECK(status, FAIL, "test_chunk_threads: SDsetchunkcache");
+    status = SDsetreadthreads(sds, 3);
+    CHECK(status, FAIL, "test_chunk_threads: SDsetreadthreads");
+
+    start[0] = start[1] = start[2] = 0;
+    edges[0]                       = THR_DIM0;
+    edges[1]                       = THR_DIM1;
+    edges[2]                       = THR_DIM2;
+    memset(data, 0, THR_DIM0 * THR_DIM1 * THR_DIM2 * sizeof(int32));
+    status = SDreaddata(sds, start, NULL, edges, data);
+    CHECK(status, FAIL, "test_chunk_threads: SDreaddata");
+    for (i = 0, n = 0; i < THR_DIM0; i++)
+        for (j = 0; j < THR_DIM1; j++)
+            for (k = 0; k < THR_DIM2; k++, n++)
+                if (data[n] != thr_value(i, j, k)) {
+                    fprintf(stderr, "test_chunk_threads: [%d][%d][%d] is %d\n", i, j, k, (int)data[n]);
+                    num_errs++;
+                    goto done;
+                }
+
+done:
+    status = SDendaccess(sds);
+    CHECK(status, FAIL, "test_chunk_threads: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_chunk_threads: SDend");
+    free(data);
+
+    return num_errs;
+}
+
+/* Value of the write threads test data set at [i][j][k]: the first
+   THR_WRITTEN planes, and the chunk at the origin of the other planes */
+static int32
+thrw_value(int i, int j, int k)
+{
+    if (i >= THR_WRITTEN && (j >= 10 || k >= 10))
+        return THR_FILL;
+    return (i * THR_DIM1 + j) * THR_DIM2 + k;
+}
+
+/* A deflate compressed data set written with its chunks encoded on
+   several threads, with a cache too small for a plane so chunks are
+   written out while writing, then rewritten */
+static int
+test_chunk_write_threads(void)
+{
+    int32         fid, sds;
+    int32         dims[3], start[3], edges[3], origin[3];
+    int32        *data = NULL;
+    int32         fill = THR_FILL;
+    int32         comp_size, uncomp_size;
+    HDF_CHUNK_DEF chunk_def;
+    int           i, j, k, n;
+    int           status;
+    int           num_errs = 0; /* number of errors so far */
+
+    data = (int32 *)malloc(THR_DIM0 * THR_DIM1 * THR_DIM2 * sizeof(int32));
+    CHECK_ALLOC(data, "data", "test_chunk_write_threads");
+
+    fid = SDstart(CTHRFILE, DFACC_CREATE);
+    CHECK(fid, FAIL, "test_chunk_write_threads: SDstart");
+
+    dims[0] = THR_DIM0;
+    dims[1] = THR_DIM1;
+    dims[2] = THR_DIM2;
+    sds     = SDcreate(fid, "deflated", DFNT_INT32, 3, dims);
+    CHECK(sds, FAIL, "test_chunk_write_threads: SDcreate");
+    status = SDsetfillvalue(sds, &fill);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDsetfillvalue");
+
+    /* 48 chunks of 5x10x10, 12 of them per plane */
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = 5;
+    chunk_def.comp.chunk_lengths[1]    = 10;
+    chunk_def.comp.chunk_lengths[2]    = 10;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+    status                             = SDsetchunk(sds, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDsetchunk");
+
+    status = SDsetwritethreads(sds, -1);
+    VERIFY(status, FAIL, "test_chunk_write_threads: SDsetwritethreads");
+    status = SDsetchunkcache(sds, 8, 0);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDsetchunkcache");
+    status = SDsetwritethreads(sds, 4);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDsetwritethreads");
+
+    /* a row at a time, leaving the cache all the time */
+    start[2] = 0;
+    edges[0] = 1;
+    edges[1] = 1;
+    edges[2] = THR_DIM2;
+    for (i = 0; i < THR_WRITTEN; i++)
+        for (j = 0; j < THR_DIM1; j++) {
+            for (k = 0; k < THR_DIM2; k++)
+                data[k] = thrw_value(i, j, k);
+            start[0] = i;
+            start[1] = j;
+            status   = SDwritedata(sds, start, NULL, edges, data);
+            CHECK(status, FAIL, "test_chunk_write_threads: SDwritedata");
+        }
+
+    /* and a whole chunk, left in the cache until the end */
+    for (i = 0, n = 0; i < 5; i++)
+        for (j = 0; j < 10; j++)
+            for (k = 0; k < 10; k++)
+                data[n++] = thrw_value(i + THR_WRITTEN, j, k);
+    origin[0] = THR_WRITTEN / 5;
+    origin[1] = origin[2] = 0;
+    status                = SDwritechunk(sds, origin, (VOIDP)data);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDwritechunk");
+
+    status = SDendaccess(sds);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDend");
+
+    /* rewrite the first planes with the same values, replacing chunks
+       that are already in the file */
+    fid = SDstart(CTHRFILE, DFACC_WRITE);
+    CHECK(fid, FAIL, "test_chunk_write_threads: SDstart");
+    sds = SDselect(fid, SDnametoindex(fid, "deflated"));
+    CHECK(sds, FAIL, "test_chunk_write_threads: SDselect");
+    status = SDsetwritethreads(sds, 3);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDsetwritethreads");
+
+    for (i = 0, n = 0; i < 5; i++)
+        for (j = 0; j < THR_DIM1; j++)
+            for (k = 0; k < THR_DIM2; k++)
+                data[n++] = thrw_value(i, j, k);
+    start[0] = start[1] = start[2] = 0;
+    edges[0]                       = 5;
+    edges[1]                       = THR_DIM1;
+    edges[2]                       = THR_DIM2;
+    status                         = SDwritedata(sds, start, NULL, edges, data);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDwritedata");
+
+    status = SDendaccess(sds);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDend");
+
+    /* read it all back without threads */
+    fid = SDstart(CTHRFILE, DFACC_READ);
+    CHECK(fid, FAIL, "test_chunk_write_threads: SDstart");
+    sds = SDselect(fid, SDnametoindex(fid, "deflated"));
+    CHECK(sds, FAIL, "test_chunk_write_threads: SDselect");
+
+    status = SDgetdatasize(sds, &comp_size, &uncomp_size);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDgetdatasize");
+    if (comp_size >= uncomp_size) {
+        fprintf(stderr, "test_chunk_write_threads: %d bytes stored for %d\n", (int)comp_size,
+                (int)uncomp_size);
+        num_errs++;
+    }
+
+    start[0] = start[1] = start[2] = 0;
+    edges[0]                       = THR_DIM0;
+    edges[1]                       = THR_DIM1;
+    edges[2]                       = THR_DIM2;
+    memset(data, 0, THR_DIM0 * THR_DIM1 * THR_DIM2 * sizeof(int32));
+    status = SDreaddata(sds, start, NULL, edges, data);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDreaddata");
+    for (i = 0, n = 0; i < THR_DIM0; i++)
+        for (j = 0; j < THR_DIM1; j++)
+            for (k = 0; k < THR_DIM2; k++, n++)
+                if (data[n] != thrw_value(i, j, k)) {
+                    fprintf(stderr, "test_chunk_write_threads: [%d][%d][%d] is %d\n", i, j, k,
+                            (int)data[n]);
+                    num_errs++;
+                    goto done;
+                }
+
+done:
+    status = SDendaccess(sds);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_chunk_write_threads: SDend");
+    free(data);
+
+    return num_errs;
+}
+
+/* Chunks of a deflate compressed data set copied to another one as they
+   are stored, then read back decoded */
+static int
+test_chunk_raw(void)
+{
+    int32         fid, src, dst, plain, contig;
+    int32         dims[3], start[3], edges[3], origin[3];
+    int32        *data = NULL;
+    uint8        *raw  = NULL;
+    int32         fill = THR_FILL;
+    int32         raw_size, nwritten = 0;
+    comp_coder_t  comp_type;
+    comp_info     c_info;
+    HDF_CHUNK_DEF chunk_def;
+    int           i, j, k, n;
+    int           status;
+    int           num_errs = 0; /* number of errors so far */
+
+    data = (int32 *)malloc(THR_DIM0 * THR_DIM1 * THR_DIM2 * sizeof(int32));
+    CHECK_ALLOC(data, "data", "test_chunk_raw");
+    raw = (uint8 *)malloc(THR_DIM0 * THR_DIM1 * THR_DIM2 * sizeof(int32));
+    CHECK_ALLOC(raw, "raw", "test_chunk_raw");
+
+    fid = SDstart(CRAWFILE, DFACC_CREATE);
+    CHECK(fid, FAIL, "test_chunk_raw: SDstart");
+
+    /* two data sets with the same 5x10x10 deflate chunks */
+    dims[0] = THR_DIM0;
+    dims[1] = THR_DIM1;
+    dims[2] = THR_DIM2;
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = 5;
+    chunk_def.comp.chunk_lengths[1]    = 10;
+    chunk_def.comp.chunk_lengths[2]    = 10;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 6;
+
+    src = SDcreate(fid, "source", DFNT_INT32, 3, dims);
+    CHECK(src, FAIL, "test_chunk_raw: SDcreate");
+    status = SDsetfillvalue(src, &fill);
+    CHECK(status, FAIL, "test_chunk_raw: SDsetfillvalue");
+    status = SDsetchunk(src, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "test_chunk_raw: SDsetchunk");
+
+    dst = SDcreate(fid, "copy", DFNT_INT32, 3, dims);
+    CHECK(dst, FAIL, "test_chunk_raw: SDcreate");
+    status = SDsetfillvalue(dst, &fill);
+    CHECK(status, FAIL, "test_chunk_raw: SDsetfillvalue");
+    status = SDsetchunk(dst, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "test_chunk_raw: SDsetchunk");
+
+    for (i = 0, n = 0; i < THR_WRITTEN; i++)
+        for (j = 0; j < THR_DIM1; j++)
+            for (k = 0; k < THR_DIM2; k++)
+                data[n++] = thr_value(i, j, k);
+    start[0] = start[1] = start[2] = 0;
+    edges[0]                       = THR_WRITTEN;
+    edges[1]                       = THR_DIM1;
+    edges[2]                       = THR_DIM2;
+    status                         = SDwritedata(src, start, NULL, edges, data);
+    CHECK(status, FAIL, "test_chunk_raw: SDwritedata");
+
+    /* a chunk of the copy still in its cache is replaced by the raw one */
+    memset(data, 0, 5 * 10 * 10 * sizeof(int32));
+    origin[0] = origin[1] = origin[2] = 0;
+    status                            = SDwritechunk(dst, origin, (VOIDP)data);
+    CHECK(status, FAIL, "test_chunk_raw: SDwritechunk");
+
+    /* copy every chunk of the source, the last plane of chunks was never
+       written and has no bytes */
+    for (origin[0] = 0; origin[0] < THR_DIM0 / 5; origin[0]++)
+        for (origin[1] = 0; origin[1] < THR_DIM1 / 10; origin[1]++)
+            for (origin[2] = 0; origin[2] < THR_DIM2 / 10; origin[2]++) {
+                raw_size = SDreadchunk_raw(src, origin, &comp_type, &c_info, 0, NULL);
+                CHECK(raw_size, FAIL, "test_chunk_raw: SDreadchunk_raw");
+                VERIFY(comp_type, COMP_CODE_DEFLATE, "test_chunk_raw: SDreadchunk_raw");
+                if (origin[0] == THR_WRITTEN / 5) {
+                    VERIFY(raw_size, 0, "test_chunk_raw: SDreadchunk_raw");
+                    continue;
+                }
+                if (raw_size <= 0 || raw_size >= 5 * 10 * 10 * (int32)sizeof(int32)) {
+                    fprintf(stderr, "test_chunk_raw: chunk of %d bytes\n", (int)raw_size);
+                    num_errs++;
+                    continue;
+                }
+
+                /* too small a buffer */
+                status = SDreadchunk_raw(src, origin, NULL, NULL, raw_size - 1, raw);
+                VERIFY(status, FAIL, "test_chunk_raw: SDreadchunk_raw");
+
+                memset(&c_info, 0, sizeof(c_info));
+                status = SDreadchunk_raw(src, origin, &comp_type, &c_info, raw_size, raw);
+                VERIFY(status, raw_size, "test_chunk_raw: SDreadchunk_raw");
+                VERIFY(c_info.deflate.level, 6, "test_chunk_raw: SDreadchunk_raw");
+
+                status = SDwritechunk_raw(dst, origin, comp_type, raw_size, raw);
+                CHECK(status, FAIL, "test_chunk_raw: SDwritechunk_raw");
+                nwritten++;
+            }
+    VERIFY(nwritten, 36, "test_chunk_raw: SDwritechunk_raw");
+
+    /* the bytes must be encoded as the data set stores them */
+    origin[0] = origin[1] = origin[2] = 0;
+    status                            = SDwritechunk_raw(dst, origin, COMP_CODE_NONE, 16, raw);
+    VERIFY(status, FAIL, "test_chunk_raw: SDwritechunk_raw");
+    origin[0] = THR_DIM0 / 5;
+    status    = SDreadchunk_raw(src, origin, NULL, NULL, 0, NULL);
+    VERIFY(status, FAIL, "test_chunk_raw: SDreadchunk_raw");
+
+    /* chunks that are not compressed are stored whole */
+    plain = SDcreate(fid, "plain", DFNT_INT32, 3, dims);
+    CHECK(plain, FAIL, "test_chunk_raw: SDcreate");
+    status = SDsetchunk(plain, chunk_def, HDF_CHUNK);
+    CHECK(status, FAIL, "test_chunk_raw: SDsetchunk");
+    origin[0] = origin[1] = origin[2] = 0;
+    status                            = SDwritechunk(plain, origin, (VOIDP)data);
+    CHECK(status, FAIL, "test_chunk_raw: SDwritechunk");
+    raw_size = SDreadchunk_raw(plain, origin, &comp_type, NULL, 0, NULL);
+    VERIFY(raw_size, 5 * 10 * 10 * (int32)sizeof(int32), "test_chunk_raw: SDreadchunk_raw");
+    VERIFY(comp_type, COMP_CODE_NONE, "test_chunk_raw: SDreadchunk_raw");
+    status = SDwritechunk_raw(plain, origin, COMP_CODE_NONE, raw_size - 4, raw);
+    VERIFY(status, FAIL, "test_chunk_raw: SDwritechunk_raw");
+
+    /* a contiguous data set has no chunks */
+    contig = SDcreate(fid, "contiguous", DFNT_INT32, 3, dims);
+    CHECK(contig, FAIL, "test_chunk_raw: SDcreate");
+    status = SDreadchunk_raw(contig, origin, NULL, NULL, 0, NULL);
+    VERIFY(status, FAIL, "test_chunk_raw: SDreadchunk_raw");
+
+    status = SDendaccess(contig);
+    CHECK(status, FAIL, "test_chunk_raw: SDendaccess");
+    status = SDendaccess(plain);
+    CHECK(status, FAIL, "test_chunk_raw: SDendaccess");
+    status = SDendaccess(dst);
+    CHECK(status, FAIL, "test_chunk_raw: SDendaccess");
+    status = SDendaccess(src);
+    CHECK(status, FAIL, "test_chunk_raw: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_chunk_raw: SDend");
+
+    /* the copy reads back decoded like the source */
+    fid = SDstart(CRAWFILE, DFACC_READ);
+    CHECK(fid, FAIL, "test_chunk_raw: SDstart");
+    dst = SDselect(fid, SDnametoindex(fid, "copy"));
+    CHECK(dst, FAIL, "test_chunk_raw: SDselect");
+
+    start[0] = start[1] = start[2] = 0;
+    edges[0]                       = THR_DIM0;
+    edges[1]                       = THR_DIM1;
+    edges[2]                       = THR_DIM2;
+    memset(data, 0, THR_DIM0 * THR_DIM1 * THR_DIM2 * sizeof(int32));
+    status = SDreaddata(dst, start, NULL, edges, data);
+    CHECK(status, FAIL, "test_chunk_raw: SDreaddata");
+    for (i = 0, n = 0; i < THR_DIM0; i++)
+        for (j = 0; j < THR_DIM1; j++)
+            for (k = 0; k < THR_DIM2; k++, n++)
+                if (data[n] != thr_value(i, j, k)) {
+                    fprintf(stderr, "test_chunk_raw: [%d][%d][%d] is %d\n", i, j, k, (int)data[n]);
+                    num_errs++;
+                    goto done;
+                }
+
+done:
+    status = SDendaccess(dst);
+    CHECK(status, FAIL, "test_chunk_raw: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_chunk_raw: SDend");
+    free(raw);
+    free(data);
+
+    return num_errs;
+}
+
 extern int
 test_chunk()
 {
@@ -1377,6 +2008,18 @@ test8:
     status = SDend(fchk);
     CHECK(status, FAIL, "Chunk Test 8. SDend");
 
+    /* Chunk caches sharing a memory budget */
+    num_errs += test_chunk_budget();
+
+    /* Chunks decoded on several threads */
+    num_errs += test_chunk_threads();
+
+    /* Chunks encoded on several threads */
+    num_errs += test_chunk_write_threads();
+
+    /* Chunks copied as they are stored */
+    num_errs += test_chunk_raw();
+
     if (num_errs == 0)
         PASSED();
 
@@ -426,6 +426,326 @@ test_fileformat()
     return num_errs;
 }
 
+/********************************************************************
+   Name: test_catalog() - tests the SD catalog (SDsetcatalog)
+
+   Description:
+    The main contents include:
+    - create a file with a fixed-size and a record data set, dimension
+      scales and attributes, and ask for a catalog
+    - verify that the catalog element is there and that the file reads
+      back as it was written
+    - edit a data set name inside the catalog and verify that SDstart
+      uses the catalog
+    - add an element with the H interface and verify that the now out
+      of date catalog is ignored
+    - append records in place and verify that the catalog is not used
+      and that SDend brings it up to date
+    - verify that SDsetcatalog(FALSE) removes the catalog
+
+   Return value:
+    The number of errors occurred in this routine.
+
+*********************************************************************/
+
+#define CAT_FILE   "catalog.hdf"
+#define CAT_DIM0   4
+#define CAT_DIM1   5
+#define CAT_NSDS   2
+#define CAT_NREC   3
+#define CAT_BLOCK  4096
+#define CAT_ATTVAL 1.5
+
+/* Open the catalog test file and check its contents, returning the name
+   of the first data set and the number of records in the second */
+static int
+check_catalog_file(char *name0, int32 *nrecs)
+{
+    int32   fid, sds_id, ndatasets, nattrs, rank, dtype, natts, dim_id;
+    int32   dims[H4_MAX_VAR_DIMS], start[2], edges[2];
+    int32   data[CAT_DIM0][CAT_DIM1];
+    int32   scale[CAT_DIM0];
+    float64 attval;
+    char    name[H4_MAX_NC_NAME];
+    int     i, j;
+    int     status;
+    int     num_errs = 0; /* number of errors so far */
+
+    fid = SDstart(CAT_FILE, DFACC_READ);
+    CHECK(fid, FAIL, "check_catalog_file: SDstart");
+
+    /* SDsetcatalog needs a file opened for writing */
+    status = SDsetcatalog(fid, TRUE);
+    VERIFY(status, FAIL, "check_catalog_file: SDsetcatalog");
+
+    /* 2 data sets and a coordinate variable, 1 global attribute */
+    status = SDfileinfo(fid, &ndatasets, &nattrs);
+    CHECK(status, FAIL, "check_catalog_file: SDfileinfo");
+    VERIFY(ndatasets, (CAT_NSDS + 1), "check_catalog_file: SDfileinfo");
+    VERIFY(nattrs, 1, "check_catalog_file: SDfileinfo");
+
+    status = SDreadattr(fid, 0, &attval);
+    CHECK(status, FAIL, "check_catalog_file: SDreadattr");
+    VERIFY(attval, CAT_ATTVAL, "check_catalog_file: SDreadattr");
+
+    /* The fixed-size data set, its attribute, data and dimension scale */
+    sds_id = SDselect(fid, 0);
+    CHECK(sds_id, FAIL, "check_catalog_file: SDselect");
+    status = SDgetinfo(sds_id, name0, &rank, dims, &dtype, &natts);
+    CHECK(status, FAIL, "check_catalog_file: SDgetinfo");
+    VERIFY(rank, 2, "check_catalog_file: SDgetinfo");
+    VERIFY(dims[0], CAT_DIM0, "check_catalog_file: SDgetinfo");
+    VERIFY(dims[1], CAT_DIM1, "check_catalog_file: SDgetinfo");
+    VERIFY(dtype, DFNT_INT32, "check_catalog_file: SDgetinfo");
+    VERIFY(natts, 1, "check_catalog_file: SDgetinfo");
+
+    start[0] = start[1] = 0;
+    edges[0]            = CAT_DIM0;
+    edges[1]            = CAT_DIM1;
+    status              = SDreaddata(sds_id, start, NULL, edges, data);
+    CHECK(status, FAIL, "check_catalog_file: SDreaddata");
+    for (i = 0; i < CAT_DIM0; i++)
+        for (j = 0; j < CAT_DIM1; j++)
+            VERIFY(data[i][j], (i * CAT_DIM1 + j), "check_catalog_file: SDreaddata");
+
+    dim_id = SDgetdimid(sds_id, 0);
+    CHECK(dim_id, FAIL, "check_catalog_file: SDgetdimid");
+    status = SDgetdimscale(dim_id, scale);
+    CHECK(status, FAIL, "check_catalog_file: SDgetdimscale");
+    for (i = 0; i < CAT_DIM0; i++)
+        VERIFY(scale[i], (10 * i), "check_catalog_file: SDgetdimscale");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "check_catalog_file: SDendaccess");
+
+    /* The record data set */
+    sds_id = SDselect(fid, SDnametoindex(fid, "Records"));
+    CHECK(sds_id, FAIL, "check_catalog_file: SDselect");
+    status = SDgetinfo(sds_id, name, &rank, dims, &dtype, &natts);
+    CHECK(status, FAIL, "check_catalog_file: SDgetinfo");
+    VERIFY(rank, 1, "check_catalog_file: SDgetinfo");
+    VERIFY(dtype, DFNT_INT32, "check_catalog_file: SDgetinfo");
+    VERIFY(SDisrecord(sds_id), TRUE, "check_catalog_file: SDisrecord");
+    *nrecs = dims[0];
+
+    start[0] = 0;
+    edges[0] = dims[0];
+    status   = SDreaddata(sds_id, start, NULL, edges, data);
+    CHECK(status, FAIL, "check_catalog_file: SDreaddata");
+    for (i = 0; i < dims[0]; i++)
+        VERIFY(((int32 *)data)[i], (100 + i), "check_catalog_file: SDreaddata");
+
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "check_catalog_file: SDendaccess");
+
+    status = SDend(fid);
+    CHECK(status, FAIL, "check_catalog_file: SDend");
+
+    return num_errs;
+}
+
+/* Append records to the record data set, from record start to nrecs - 1 */
+static int
+append_records(int32 fid, int32 start0, int32 nrecs)
+{
+    int32 sds_id, start[1], edges[1];
+    int32 recs[CAT_DIM0 * CAT_DIM1];
+    int   i;
+    int   status;
+    int   num_errs = 0; /* number of errors so far */
+
+    for (i = start0; i < nrecs; i++)
+        recs[i - start0] = 100 + i;
+
+    sds_id = SDselect(fid, SDnametoindex(fid, "Records"));
+    CHECK(sds_id, FAIL, "append_records: SDselect");
+    start[0] = start0;
+    edges[0] = nrecs - start0;
+    status   = SDwritedata(sds_id, start, NULL, edges, recs);
+    CHECK(status, FAIL, "append_records: SDwritedata");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "append_records: SDendaccess");
+
+    return num_errs;
+}
+
+static int
+test_catalog()
+{
+    int32   fid, sds_id, dim_id, file_id, aid, len;
+    int32   dims[2], start[2], edges[2];
+    int32   data[CAT_DIM0][CAT_DIM1];
+    int32   scale[CAT_DIM0];
+    int32   nrecs;
+    float64 attval = CAT_ATTVAL;
+    uint8  *buf;
+    char    name0[H4_MAX_NC_NAME];
+    int     i, j;
+    int     status;
+    int     num_errs = 0; /* number of errors so far */
+
+    /* Create the file */
+    fid = SDstart(CAT_FILE, DFACC_CREATE);
+    CHECK(fid, FAIL, "test_catalog: SDstart");
+
+    status = SDsetattr(fid, "version", DFNT_FLOAT64, 1, &attval);
+    CHECK(status, FAIL, "test_catalog: SDsetattr");
+
+    dims[0] = CAT_DIM0;
+    dims[1] = CAT_DIM1;
+    sds_id  = SDcreate(fid, "Temperature", DFNT_INT32, 2, dims);
+    CHECK(sds_id, FAIL, "test_catalog: SDcreate");
+    status = SDsetattr(sds_id, "units", DFNT_CHAR8, 7, "kelvins");
+    CHECK(status, FAIL, "test_catalog: SDsetattr");
+
+    for (i = 0; i < CAT_DIM0; i++) {
+        scale[i] = 10 * i;
+        for (j = 0; j < CAT_DIM1; j++)
+            data[i][j] = i * CAT_DIM1 + j;
+    }
+    start[0] = start[1] = 0;
+    edges[0]            = CAT_DIM0;
+    edges[1]            = CAT_DIM1;
+    status              = SDwritedata(sds_id, start, NULL, edges, data);
+    CHECK(status, FAIL, "test_catalog: SDwritedata");
+
+    dim_id = SDgetdimid(sds_id, 0);
+    CHECK(dim_id, FAIL, "test_catalog: SDgetdimid");
+    status = SDsetdimscale(dim_id, CAT_DIM0, DFNT_INT32, scale);
+    CHECK(status, FAIL, "test_catalog: SDsetdimscale");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_catalog: SDendaccess");
+
+    /* A record data set in blocks large enough for appends to stay in place */
+    dims[0] = SD_UNLIMITED;
+    sds_id  = SDcreate(fid, "Records", DFNT_INT32, 1, dims);
+    CHECK(sds_id, FAIL, "test_catalog: SDcreate");
+    status = SDsetblocksize(sds_id, CAT_BLOCK);
+    CHECK(status, FAIL, "test_catalog: SDsetblocksize");
+    status = SDendaccess(sds_id);
+    CHECK(status, FAIL, "test_catalog: SDendaccess");
+    num_errs += append_records(fid, 0, CAT_NREC);
+
+    status = SDsetcatalog(fid, TRUE);
+    CHECK(status, FAIL, "test_catalog: SDsetcatalog");
+
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_catalog: SDend");
+
+    /* The catalog is there and the file reads back as written */
+    file_id = Hopen(CAT_FILE, DFACC_READ, 0);
+    CHECK(file_id, FAIL, "test_catalog: Hopen");
+    VERIFY(Hexist(file_id, DFTAG_SDCAT, 1), SUCCEED, "test_catalog: Hexist");
+    status = Hclose(file_id);
+    CHECK(status, FAIL, "test_catalog: Hclose");
+
+    num_errs += check_catalog_file(name0, &nrecs);
+    VERIFY(strcmp(name0, "Temperature"), 0, "test_catalog: SDgetinfo");
+    VERIFY(nrecs, CAT_NREC, "test_catalog: SDgetinfo");
+
+    /* Rename the first data set in the catalog only: SDstart must see it */
+    file_id = Hopen(CAT_FILE, DFACC_RDWR, 0);
+    CHECK(file_id, FAIL, "test_catalog: Hopen");
+    len = Hlength(file_id, DFTAG_SDCAT, 1);
+    CHECK(len, FAIL, "test_catalog: Hlength");
+    buf = malloc((size_t)len);
+    CHECK_ALLOC(buf, "buf", "test_catalog");
+    status = Hgetelement(file_id, DFTAG_SDCAT, 1, buf);
+    VERIFY(status, len, "test_catalog: Hgetelement");
+    for (i = 0; i + 11 <= len; i++)
+        if (memcmp(buf + i, "Temperature", 11) == 0) {
+            buf[i + 4] = 'x';
+            break;
+        }
+    aid = Hstartaccess(file_id, DFTAG_SDCAT, 1, DFACC_WRITE);
+    CHECK(aid, FAIL, "test_catalog: Hstartaccess");
+    status = Hwrite(aid, len, buf);
+    VERIFY(status, len, "test_catalog: Hwrite");
+    status = Hendaccess(aid);
+    CHECK(status, FAIL, "test_catalog: Hendaccess");
+    status = Hclose(file_id);
+    CHECK(status, FAIL, "test_catalog: Hclose");
+
+    num_errs += check_catalog_file(name0, &nrecs);
+    VERIFY(strcmp(name0, "Tempxrature"), 0, "test_catalog: SDgetinfo");
+
+    /* Closing a file that was not changed leaves an up to date catalog alone */
+    fid = SDstart(CAT_FILE, DFACC_RDWR);
+    CHECK(fid, FAIL, "test_catalog: SDstart");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_catalog: SDend");
+
+    num_errs += check_catalog_file(name0, &nrecs);
+    VERIFY(strcmp(name0, "Tempxrature"), 0, "test_catalog: SDgetinfo");
+
+    /* Any other change to the file makes the catalog out of date */
+    file_id = Hopen(CAT_FILE, DFACC_RDWR, 0);
+    CHECK(file_id, FAIL, "test_catalog: Hopen");
+    status = Hputelement(file_id, 1000, 1, buf, 16);
+    VERIFY(status, 16, "test_catalog: Hputelement");
+    status = Hclose(file_id);
+    CHECK(status, FAIL, "test_catalog: Hclose");
+    free(buf);
+
+    num_errs += check_catalog_file(name0, &nrecs);
+    VERIFY(strcmp(name0, "Temperature"), 0, "test_catalog: SDgetinfo");
+
+    /* Records appended in place are seen, and SDend refreshes the catalog */
+    fid = SDstart(CAT_FILE, DFACC_RDWR);
+    CHECK(fid, FAIL, "test_catalog: SDstart");
+    num_errs += append_records(fid, CAT_NREC, CAT_NREC + 2);
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_catalog: SDend");
+
+    num_errs += check_catalog_file(name0, &nrecs);
+    VERIFY(nrecs, (CAT_NREC + 2), "test_catalog: SDgetinfo");
+
+    /* Keep a copy of the current catalog */
+    file_id = Hopen(CAT_FILE, DFACC_READ, 0);
+    CHECK(file_id, FAIL, "test_catalog: Hopen");
+    len = Hlength(file_id, DFTAG_SDCAT, 1);
+    CHECK(len, FAIL, "test_catalog: Hlength");
+    buf = malloc((size_t)len);
+    CHECK_ALLOC(buf, "buf", "test_catalog");
+    status = Hgetelement(file_id, DFTAG_SDCAT, 1, buf);
+    VERIFY(status, len, "test_catalog: Hgetelement");
+    status = Hclose(file_id);
+    CHECK(status, FAIL, "test_catalog: Hclose");
+
+    /* Records appended by a writer that does not maintain the catalog */
+    fid = SDstart(CAT_FILE, DFACC_RDWR);
+    CHECK(fid, FAIL, "test_catalog: SDstart");
+    num_errs += append_records(fid, CAT_NREC + 2, CAT_NREC + 3);
+    status = SDsetcatalog(fid, FALSE);
+    CHECK(status, FAIL, "test_catalog: SDsetcatalog");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_catalog: SDend");
+
+    file_id = Hopen(CAT_FILE, DFACC_READ, 0);
+    CHECK(file_id, FAIL, "test_catalog: Hopen");
+    VERIFY(Hexist(file_id, DFTAG_SDCAT, 1), FAIL, "test_catalog: Hexist");
+    status = Hclose(file_id);
+    CHECK(status, FAIL, "test_catalog: Hclose");
+
+    num_errs += check_catalog_file(name0, &nrecs);
+    VERIFY(nrecs, (CAT_NREC + 3), "test_catalog: SDgetinfo");
+
+    /* Put the old catalog back: the records were appended inside the
+       existing linked block, so only the record length check catches it */
+    file_id = Hopen(CAT_FILE, DFACC_RDWR, 0);
+    CHECK(file_id, FAIL, "test_catalog: Hopen");
+    status = Hputelement(file_id, DFTAG_SDCAT, 1, buf, len);
+    VERIFY(status, len, "test_catalog: Hputelement");
+    status = Hclose(file_id);
+    CHECK(status, FAIL, "test_catalog: Hclose");
+    free(buf);
+
+    num_errs += check_catalog_file(name0, &nrecs);
+    VERIFY(nrecs, (CAT_NREC + 3), "test_catalog: SDgetinfo");
+
+    return num_errs;
+}
+
 /* Test driver for testing miscellaneous file related APIs. */
 extern int
 test_files()
@@ -447,6 +767,9 @@ test_files()
     /* Test determining of file format */
     num_errs = num_errs + test_fileformat();
 
+    /* Test the SD catalog */
+    num_errs = num_errs + test_catalog();
+
     if (num_errs == 0)
         PASSED();
     else
@@ -0,0 +1,240 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/****************************************************************************
+ * tmultiread.c - tests SDreaddata_multi.
+ * Structure of the file:
+ *    test_readmulti - test driver: reads the same selections with
+ *          SDreaddata_multi and with SDreaddata, from a contiguous data
+ *          set, a chunked and compressed one, one that was never written
+ *          and one with an unlimited dimension, and checks bad selections
+ *    check_selections - reads selections both ways and compares them
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mfhdf.h"
+
+#include "hdftest.h"
+
+#define MULTI_FILE "tmultiread.hdf"
+#define DIM0       120
+#define DIM1       150
+#define CDIM0      16
+#define CDIM1      25
+#define NRECS      50
+#define MAX_SEL    16
+
+/* Selections along two dimensions: start, stride (0 for none), edge */
+typedef struct {
+    int32 start[2];
+    int32 stride[2];
+    int32 edge[2];
+} selection_t;
+
+/* Points, overlapping and adjacent boxes, strides, and selections far
+   from the others; all fit in a DIM0 x DIM1 data set */
+static const selection_t sels2d[] = {
+    {{5, 7}, {0, 0}, {1, 1}},       {{5, 8}, {0, 0}, {1, 1}},         {{6, 7}, {0, 0}, {3, 4}},
+    {{0, 0}, {0, 0}, {2, DIM1}},    {{100, 140}, {0, 0}, {20, 10}},   {{3, 3}, {0, 0}, {10, 10}},
+    {{10, 1}, {3, 7}, {20, 20}},    {{60, 0}, {0, 0}, {1, DIM1}},     {{61, 149}, {0, 0}, {1, 1}},
+    {{0, 0}, {0, 0}, {DIM0, DIM1}}, {{17, 24}, {0, 0}, {2, 2}},       {{50, 10}, {40, 1}, {2, 3}},
+    {{119, 0}, {0, 0}, {1, 1}},     {{30, 29}, {1, 30}, {30, 5}},     {{4, 9}, {0, 0}, {1, 1}},
+    {{90, 90}, {0, 0}, {1, 1}},
+};
+#define NSEL2D ((int32)(sizeof(sels2d) / sizeof(sels2d[0])))
+
+/* Read 'nsel' selections of 'sds' with SDreaddata_multi and with
+   SDreaddata and compare; 'stride' is whether to pass the strides */
+static int
+check_selections(int32 sds, const char *name, int32 rank, const selection_t *sels, int32 nsel, size_t size,
+                 int stride)
+{
+    int32  start[MAX_SEL * 2], strides[MAX_SEL * 2], edge[MAX_SEL * 2];
+    void  *multi[MAX_SEL];
+    void  *single = NULL;
+    size_t nbytes[MAX_SEL];
+    int32  i, d;
+    int    status;
+    int    num_errs = 0; /* number of errors so far */
+
+    for (i = 0; i < nsel; i++) {
+        nbytes[i] = size;
+        for (d = 0; d < rank; d++) {
+            start[i * rank + d]   = sels[i].start[d];
+            strides[i * rank + d] = sels[i].stride[d] ? sels[i].stride[d] : 1;
+            edge[i * rank + d]    = sels[i].edge[d];
+            nbytes[i] *= (size_t)sels[i].edge[d];
+        }
+        multi[i] = malloc(nbytes[i]);
+        CHECK_ALLOC(multi[i], "multi", "check_selections");
+    }
+
+    status = SDreaddata_multi(sds, nsel, start, stride ? strides : NULL, edge, multi);
+    CHECK(status, FAIL, "check_selections: SDreaddata_multi");
+
+    for (i = 0; i < nsel && status != FAIL; i++) {
+        single = malloc(nbytes[i]);
+        CHECK_ALLOC(single, "single", "check_selections");
+        status = SDreaddata(sds, &start[i * rank], stride ? &strides[i * rank] : NULL, &edge[i * rank], single);
+        CHECK(status, FAIL, "check_selections: SDreaddata");
+        if (memcmp(multi[i], single, nbytes[i]) != 0) {
+            fprintf(stderr, "check_selections: selection %d of %s differs from SDreaddata\n", (int)i, name);
+            num_errs++;
+        }
+        free(single);
+    }
+
+    for (i = 0; i < nsel; i++)
+        free(multi[i]);
+    return num_errs;
+}
+
+extern int
+test_readmulti(void)
+{
+    static float32 fdata[DIM0][DIM1];
+    static int16   sdata[DIM0][DIM1];
+    int32          recs[NRECS];
+    int32          fid, contig, chunked, empty, unlim;
+    int32          dims[2], start[2], edge[2];
+    int32          fill = -7;
+    void          *bufs[2];
+    HDF_CHUNK_DEF  chunk_def;
+    selection_t    rsels[3] = {
+        {{3, 0}, {0, 0}, {5, 0}}, {{0, 0}, {7, 0}, {7, 0}}, {{NRECS - 1, 0}, {0, 0}, {1, 0}}};
+    int32 i, j;
+    int   status;
+    int   num_errs = 0; /* number of errors so far */
+
+    TESTING("reading many selections at once (tmultiread.c)");
+
+    for (i = 0; i < DIM0; i++)
+        for (j = 0; j < DIM1; j++) {
+            fdata[i][j] = (float32)(i * 1000 + j);
+            sdata[i][j] = (int16)((i * DIM1 + j) % 30000);
+        }
+    for (i = 0; i < NRECS; i++)
+        recs[i] = i * 3;
+
+    fid = SDstart(MULTI_FILE, DFACC_CREATE);
+    CHECK(fid, FAIL, "test_readmulti: SDstart");
+
+    dims[0]  = DIM0;
+    dims[1]  = DIM1;
+    start[0] = start[1] = 0;
+
+    /* a big-endian float32 data set, which needs converting on most machines */
+    contig = SDcreate(fid, "contiguous", DFNT_FLOAT32, 2, dims);
+    CHECK(contig, FAIL, "test_readmulti: SDcreate");
+    status = SDwritedata(contig, start, NULL, dims, fdata);
+    CHECK(status, FAIL, "test_readmulti: SDwritedata");
+
+    /* chunks that do not divide the dimensions */
+    memset(&chunk_def, 0, sizeof(chunk_def));
+    chunk_def.comp.chunk_lengths[0]    = CDIM0;
+    chunk_def.comp.chunk_lengths[1]    = CDIM1;
+    chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+    chunk_def.comp.cinfo.deflate.level = 1;
+    chunked                            = SDcreate(fid, "chunked", DFNT_INT16, 2, dims);
+    CHECK(chunked, FAIL, "test_readmulti: SDcreate");
+    status = SDsetchunk(chunked, chunk_def, HDF_CHUNK | HDF_COMP);
+    CHECK(status, FAIL, "test_readmulti: SDsetchunk");
+    status = SDwritedata(chunked, start, NULL, dims, sdata);
+    CHECK(status, FAIL, "test_readmulti: SDwritedata");
+
+    /* never written: reads as its fill value */
+    empty = SDcreate(fid, "empty", DFNT_INT32, 2, dims);
+    CHECK(empty, FAIL, "test_readmulti: SDcreate");
+    status = SDsetfillvalue(empty, &fill);
+    CHECK(status, FAIL, "test_readmulti: SDsetfillvalue");
+
+    dims[0] = SD_UNLIMITED;
+    unlim   = SDcreate(fid, "unlimited", DFNT_INT32, 1, dims);
+    CHECK(unlim, FAIL, "test_readmulti: SDcreate");
+    edge[0] = NRECS;
+    status  = SDwritedata(unlim, start, NULL, edge, recs);
+    CHECK(status, FAIL, "test_readmulti: SDwritedata");
+
+    num_errs += check_selections(contig, "contiguous", 2, sels2d, NSEL2D, sizeof(float32), TRUE);
+    num_errs += check_selections(contig, "contiguous", 2, sels2d, 6, sizeof(float32), FALSE);
+    num_errs += check_selections(chunked, "chunked", 2, sels2d, NSEL2D, sizeof(int16), TRUE);
+    num_errs += check_selections(chunked, "chunked", 2, sels2d, 6, sizeof(int16), FALSE);
+    num_errs += check_selections(empty, "empty", 2, sels2d, 4, sizeof(int32), TRUE);
+    num_errs += check_selections(unlim, "unlimited", 1, rsels, 3, sizeof(int32), TRUE);
+
+    /* selections out of the data set, or past the records written */
+    start[0] = DIM0 - 2;
+    start[1] = 0;
+    edge[0]  = 3;
+    edge[1]  = 1;
+    bufs[0]  = fdata;
+    status   = SDreaddata_multi(contig, 1, start, NULL, edge, bufs);
+    VERIFY(status, FAIL, "test_readmulti: SDreaddata_multi");
+    start[0] = NRECS - 1;
+    edge[0]  = 2;
+    status   = SDreaddata_multi(unlim, 1, start, NULL, edge, bufs);
+    VERIFY(status, FAIL, "test_readmulti: SDreaddata_multi");
+    status = SDreaddata_multi(contig, 0, NULL, NULL, NULL, NULL);
+    VERIFY(status, SUCCEED, "test_readmulti: SDreaddata_multi");
+
+    status = SDendaccess(contig);
+    CHECK(status, FAIL, "test_readmulti: SDendaccess");
+    status = SDendaccess(chunked);
+    CHECK(status, FAIL, "test_readmulti: SDendaccess");
+    status = SDendaccess(empty);
+    CHECK(status, FAIL, "test_readmulti: SDendaccess");
+    status = SDendaccess(unlim);
+    CHECK(status, FAIL, "test_readmulti: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_readmulti: SDend");
+
+    /* again from the file opened for reading */
+    fid = SDstart(MULTI_FILE, DFACC_READ);
+    CHECK(fid, FAIL, "test_readmulti: SDstart");
+    contig = SDselect(fid, 0);
+    CHECK(contig, FAIL, "test_readmulti: SDselect");
+    chunked = SDselect(fid, 1);
+    CHECK(chunked, FAIL, "test_readmulti: SDselect");
+    num_errs += check_selections(contig, "contiguous", 2, sels2d, NSEL2D, sizeof(float32), TRUE);
+    num_errs += check_selections(chunked, "chunked", 2, sels2d, NSEL2D, sizeof(int16), TRUE);
+
+    /* the values themselves */
+    start[0] = 7;
+    start[1] = 9;
+    edge[0]  = 1;
+    edge[1]  = 2;
+    bufs[0]  = &fdata[0][0];
+    bufs[1]  = &sdata[0][0];
+    memset(fdata, 0, sizeof(fdata));
+    memset(sdata, 0, sizeof(sdata));
+    status = SDreaddata_multi(contig, 1, start, NULL, edge, &bufs[0]);
+    CHECK(status, FAIL, "test_readmulti: SDreaddata_multi");
+    status = SDreaddata_multi(chunked, 1, start, NULL, edge, &bufs[1]);
+    CHECK(status, FAIL, "test_readmulti: SDreaddata_multi");
+    VERIFY((int)fdata[0][1], 7010, "test_readmulti: SDreaddata_multi");
+    VERIFY(sdata[0][1], 7 * DIM1 + 10, "test_readmulti: SDreaddata_multi");
+
+    status = SDendaccess(contig);
+    CHECK(status, FAIL, "test_readmulti: SDendaccess");
+    status = SDendaccess(chunked);
+    CHECK(status, FAIL, "test_readmulti: SDendaccess");
+    status = SDend(fid);
+    CHECK(status, FAIL, "test_readmulti: SDend");
+
+    if (num_errs == 0)
+        PASSED();
+    else
+        H4_FAILED();
+    return num_errs;
+}
@@ -99,6 +99,119 @@ test_read_dim()
 
 } /* test_read_dim */
 
+/********************************************************************
+   Name: read_all_vars() - reads every variable in a netCDF file through
+        the nc API and stores the data back to back in a buffer.
+
+   Return value:
+        The number of bytes read, or -1 on failure.
+*********************************************************************/
+static long
+read_all_vars(int ncid, char *buf, long bufsize)
+{
+    long    start[H4_MAX_VAR_DIMS];
+    long    edges[H4_MAX_VAR_DIMS];
+    int     dims[H4_MAX_VAR_DIMS];
+    int     ndims, nvars, natts, recdim;
+    int     varid, i;
+    nc_type datatype;
+    long    nread = 0;
+
+    if (ncinquire(ncid, &ndims, &nvars, &natts, &recdim) == -1)
+        return -1;
+
+    /* Read the variables in reverse order to move around in the file */
+    for (varid = nvars - 1; varid >= 0; varid--) {
+        long nelems = 1;
+
+        if (ncvarinq(ncid, varid, NULL, &datatype, &ndims, dims, &natts) == -1)
+            return -1;
+        for (i = 0; i < ndims; i++) {
+            start[i] = 0;
+            if (ncdiminq(ncid, dims[i], NULL, &edges[i]) == -1)
+                return -1;
+            nelems *= edges[i];
+        }
+        if (nelems == 0)
+            continue;
+        if (nread + nelems * nctypelen(datatype) > bufsize)
+            return -1;
+        if (ncvarget(ncid, varid, start, edges, buf + nread) == -1)
+            return -1;
+        nread += nelems * nctypelen(datatype);
+    }
+    return nread;
+}
+
+/********************************************************************
+   Name: test_read_cache() - tests reading a netCDF file through the nc
+        API with different I/O cache settings.
+
+   Description:
+        Reads all variables of 'test1.nc' with the default cache, then
+        again with a cache of a few tiny pages and with a cache of large
+        pages, and verifies that the same data is returned each time.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+#define CACHE_BUFSIZE 65536
+
+static int
+test_read_cache()
+{
+    int         ncid;
+    int         status;
+    char       *dflt_buf  = NULL;
+    char       *cache_buf = NULL;
+    long        dflt_size, cache_size;
+    int         num_errs = 0; /* number of errors so far */
+    const char *testfile = get_srcdir_filename("test1.nc");
+
+    dflt_buf  = (char *)calloc(CACHE_BUFSIZE, 1);
+    cache_buf = (char *)calloc(CACHE_BUFSIZE, 1);
+    CHECK_ALLOC(dflt_buf, "dflt_buf", "test_read_cache");
+    CHECK_ALLOC(cache_buf, "cache_buf", "test_read_cache");
+
+    ncid = ncopen(testfile, NC_NOWRITE);
+    CHECK(ncid, -1, "ncopen");
+
+    if (ncid != -1) {
+        dflt_size = read_all_vars(ncid, dflt_buf, CACHE_BUFSIZE);
+        CHECK(dflt_size, -1, "read_all_vars");
+
+        /* Two tiny pages, so almost every read misses the cache */
+        status = ncsetcache(ncid, 16, 2);
+        CHECK(status, -1, "ncsetcache");
+        cache_size = read_all_vars(ncid, cache_buf, CACHE_BUFSIZE);
+        VERIFY(cache_size, dflt_size, "read_all_vars");
+        if (cache_size == dflt_size && memcmp(dflt_buf, cache_buf, (size_t)dflt_size) != 0) {
+            fprintf(stderr, "test_read_cache: data differs with a small cache\n");
+            num_errs++;
+        }
+
+        /* Pages larger than the whole file */
+        memset(cache_buf, 0, CACHE_BUFSIZE);
+        status = ncsetcache(ncid, 1024 * 1024, 4);
+        CHECK(status, -1, "ncsetcache");
+        cache_size = read_all_vars(ncid, cache_buf, CACHE_BUFSIZE);
+        VERIFY(cache_size, dflt_size, "read_all_vars");
+        if (cache_size == dflt_size && memcmp(dflt_buf, cache_buf, (size_t)dflt_size) != 0) {
+            fprintf(stderr, "test_read_cache: data differs with a large cache\n");
+            num_errs++;
+        }
+
+        status = ncclose(ncid);
+        CHECK(status, -1, "ncclose");
+    }
+
+    free(dflt_buf);
+    free(cache_buf);
+
+    /* Return the number of errors that's been kept track of so far */
+    return num_errs;
+} /* test_read_cache */
+
 static int16 netcdf_u16[2][3] = {{1, 2, 3}, {4, 5, 6}};
 
 /* Tests reading of netCDF file 'test1.nc' using the SDxxx interface.
@@ -197,6 +310,9 @@ test_netcdf_reading()
     /* Test reading dimension scale - bugzilla 1644 */
     num_errs = num_errs + test_read_dim();
 
+    /* Test reading through the nc API with different cache settings */
+    num_errs = num_errs + test_read_cache();
+
     if (num_errs == 0)
         PASSED();
     return num_errs;
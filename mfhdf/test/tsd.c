@@ -33,8 +33,8 @@ test_sd()
     mode_t mode;
 #endif
 
-    FILE *ff;
-    int   num_errs = 0; /* number of errors so far */
+    hdf_file_t ff;
+    int        num_errs = 0; /* number of errors so far */
 
     /* Output message about test being performed */
     TESTING("SDstart for file with no write permission (tsd.c)");
@@ -63,9 +63,11 @@ test_sd()
     VERIFY(fid, FAIL, "second SDstart");
 
     ff = HI_OPEN(FILE_NAME, DFACC_READ);
-    CHECK(ff, NULL, "fopen");
-
-    if (ff != NULL) {
+    if (OPENERR(ff)) {
+        fprintf(stderr, "HI_OPEN could not open %s for reading\n", FILE_NAME);
+        num_errs++;
+    }
+    else {
         HI_CLOSE(ff);
     }
 
@@ -26,6 +26,8 @@
  *	  test_valid_args - tests that when some invalid arguments were passed
  *		into an API, they can be caught and handled properly.
  *		(bugzilla 150)
+ *	  test_SDSfindnames - tests that data sets are found by name, those
+ *		created after the first lookup included.
  ****************************************************************************/
 
 #include <stdlib.h>
@@ -745,6 +747,108 @@ test_valid_args2()
     return num_errs;
 } /* test_valid_args2 */
 
+/********************************************************************
+   Name: test_SDSfindnames() - tests finding data sets by name
+
+   Description:
+        Creates many data sets, looking some up by name as they are
+        created, so that the names of the data sets are hashed more than
+        once.  Two of the data sets have the same name, and one has a
+        dimension with a scale.  The lookups are checked again once the
+        file is reopened.
+
+   Return value:
+        The number of errors occurred in this routine.
+*********************************************************************/
+#define FIND_FILE "SDSfindnames.hdf"
+#define FIND_NSDS 200
+
+static int
+test_SDSfindnames()
+{
+    char          name[16];
+    int32         sd_id, sds_id, dim_id;
+    int32         dims[1] = {4};
+    hdf_varlist_t vars[2];
+    int32         scale[4] = {1, 2, 3, 4};
+    int32         n_vars, size, nt, nattrs;
+    int32         idx;
+    int           i, pass, status;
+    int           num_errs = 0; /* number of errors so far */
+
+    sd_id = SDstart(FIND_FILE, DFACC_CREATE);
+    CHECK(sd_id, FAIL, "SDstart");
+
+    for (i = 0; i < FIND_NSDS; i++) {
+        snprintf(name, sizeof(name), "ds%d", i);
+        sds_id = SDcreate(sd_id, i == FIND_NSDS / 2 ? "ds0" : name, DFNT_INT32, 1, dims);
+        CHECK(sds_id, FAIL, "SDcreate");
+        if (i == 10) {
+            dim_id = SDgetdimid(sds_id, 0);
+            CHECK(dim_id, FAIL, "SDgetdimid");
+            status = SDsetdimname(dim_id, "scaled");
+            CHECK(status, FAIL, "SDsetdimname");
+            status = SDsetdimscale(dim_id, 4, DFNT_INT32, scale);
+            CHECK(status, FAIL, "SDsetdimscale");
+        }
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+
+        /* look up the data set just created, and one that does not exist yet */
+        idx = SDnametoindex(sd_id, name);
+        if (i != FIND_NSDS / 2 && idx < 0) {
+            fprintf(stderr, "test_SDSfindnames: SDnametoindex did not find %s\n", name);
+            num_errs++;
+        }
+        snprintf(name, sizeof(name), "ds%d", i + 1);
+        idx = SDnametoindex(sd_id, name);
+        VERIFY(idx, FAIL, "SDnametoindex");
+    }
+
+    for (pass = 0; pass < 2; pass++) {
+        /* the data set and the coordinate variable of its dimension come
+           before ds11 */
+        idx = SDnametoindex(sd_id, "ds11");
+        VERIFY(idx, 12, "SDnametoindex");
+        idx = SDnametoindex(sd_id, "ds199");
+        VERIFY(idx, FIND_NSDS, "SDnametoindex");
+        idx = SDnametoindex(sd_id, "ds");
+        VERIFY(idx, FAIL, "SDnametoindex");
+
+        /* the two data sets named ds0 */
+        status = SDgetnumvars_byname(sd_id, "ds0", &n_vars);
+        CHECK(status, FAIL, "SDgetnumvars_byname");
+        VERIFY(n_vars, 2, "SDgetnumvars_byname");
+        idx = SDnametoindex(sd_id, "ds0");
+        VERIFY(idx, 0, "SDnametoindex");
+        status = SDnametoindices(sd_id, "ds0", vars);
+        CHECK(status, FAIL, "SDnametoindices");
+        VERIFY(vars[0].var_index, 0, "SDnametoindices");
+        VERIFY(vars[1].var_index, FIND_NSDS / 2 + 1, "SDnametoindices");
+        VERIFY(vars[1].var_type, IS_SDSVAR, "SDnametoindices");
+
+        /* the scale of the dimension is found through its name */
+        sds_id = SDselect(sd_id, 10);
+        CHECK(sds_id, FAIL, "SDselect");
+        dim_id = SDgetdimid(sds_id, 0);
+        CHECK(dim_id, FAIL, "SDgetdimid");
+        status = SDdiminfo(dim_id, name, &size, &nt, &nattrs);
+        CHECK(status, FAIL, "SDdiminfo");
+        VERIFY(nt, DFNT_INT32, "SDdiminfo");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "SDendaccess");
+
+        status = SDend(sd_id);
+        CHECK(status, FAIL, "SDend");
+        if (pass == 0) {
+            sd_id = SDstart(FIND_FILE, DFACC_READ);
+            CHECK(sd_id, FAIL, "SDstart");
+        }
+    }
+
+    return num_errs;
+} /* test_SDSfindnames */
+
 /* Test driver for testing various SDS' properties. */
 extern int
 test_SDSprops()
@@ -759,6 +863,7 @@ test_SDSprops()
     num_errs = num_errs + test_unlim_inloop();
     num_errs = num_errs + test_valid_args();
     num_errs = num_errs + test_valid_args2();
+    num_errs = num_errs + test_SDSfindnames();
 
     if (num_errs == 0)
         PASSED();
@@ -0,0 +1,339 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright by The HDF Group.                                               *
+ * All rights reserved.                                                      *
+ *                                                                           *
+ * This file is part of HDF.  The full HDF copyright notice, including       *
+ * terms governing use, modification, and redistribution, is contained in    *
+ * the COPYING file, which can be found at the root of the source code       *
+ * distribution tree, or in https://support.hdfgroup.org/ftp/HDF/releases/.  *
+ * If you do not have access to either file, you may request a copy from     *
+ * help@hdfgroup.org.                                                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/****************************************************************************
+ * tthreadsafe.c - tests the thread-safe library mode.
+ * Structure of the file:
+ *    test_threadsafe - test driver; skipped unless the library is built
+ *          with --enable-threadsafe
+ *    thread_body - run by each thread on its own file: writes and reads
+ *          back a big-endian SDS and a vdata, which go through the
+ *          scratch conversion buffers, and checks that the errors of
+ *          the other threads never show up on its error stack
+ *    test_shared_reads - several threads read, in parallel, the data sets
+ *          of two files opened once: a contiguous one and a chunked,
+ *          compressed one; the readers of a file share its SDS id
+ ****************************************************************************/
+
+#include <string.h>
+
+#include "mfhdf.h"
+
+#include "hdftest.h"
+
+#ifdef H4_HAVE_THREADSAFE
+#include <pthread.h>
+
+#define NTHREADS  8
+#define NLOOPS    20
+#define X_LENGTH  30
+#define Y_LENGTH  20
+#define N_RECORDS 30
+#define NREADERS  6
+#define NFILES    2
+
+typedef struct {
+    int id;       /* thread number */
+    int num_errs; /* errors found by the thread */
+} thread_info_t;
+
+typedef struct {
+    int32 sds_id;   /* data set to read */
+    int   which;    /* file it is in */
+    int   num_errs; /* errors found by the thread */
+} reader_info_t;
+
+/* What the data sets of test_shared_reads hold */
+static float64 shared_data[NFILES][Y_LENGTH][X_LENGTH];
+
+/* Write an SDS and a vdata and read them back, NLOOPS times */
+static void *
+thread_body(void *arg)
+{
+    thread_info_t *info = (thread_info_t *)arg;
+    char           file_name[32];
+    int32          dims[2]  = {Y_LENGTH, X_LENGTH};
+    int32          start[2] = {0, 0};
+    float64        data[Y_LENGTH][X_LENGTH], check[Y_LENGTH][X_LENGTH];
+    float32        recs[N_RECORDS][2], check_recs[N_RECORDS][2];
+    int32          fid, sds_id, file_id, vs_id, vs_ref;
+    int            loop, i, j;
+    intn           status;
+    int            num_errs = 0;
+
+    snprintf(file_name, sizeof(file_name), "threadsafe%d.hdf", info->id);
+
+    for (loop = 0; loop < NLOOPS; loop++) {
+        HEclear();
+
+        for (i = 0; i < Y_LENGTH; i++)
+            for (j = 0; j < X_LENGTH; j++)
+                data[i][j] = info->id * 100000.0 + loop * 1000.0 + i * X_LENGTH + j;
+        for (i = 0; i < N_RECORDS; i++) {
+            recs[i][0] = (float32)(info->id * 1000 + loop * 100 + i);
+            recs[i][1] = (float32)-recs[i][0];
+        }
+
+        /* Write the SDS, stored big-endian so that it must be converted */
+        fid = SDstart(file_name, DFACC_CREATE);
+        CHECK(fid, FAIL, "thread_body: SDstart");
+        sds_id = SDcreate(fid, "data", DFNT_FLOAT64, 2, dims);
+        CHECK(sds_id, FAIL, "thread_body: SDcreate");
+        status = SDwritedata(sds_id, start, NULL, dims, data);
+        CHECK(status, FAIL, "thread_body: SDwritedata");
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "thread_body: SDendaccess");
+        status = SDend(fid);
+        CHECK(status, FAIL, "thread_body: SDend");
+
+        /* Add a vdata to the same file */
+        file_id = Hopen(file_name, DFACC_WRITE, 0);
+        CHECK(file_id, FAIL, "thread_body: Hopen");
+        status = Vstart(file_id);
+        CHECK(status, FAIL, "thread_body: Vstart");
+        vs_id = VSattach(file_id, -1, "w");
+        CHECK(vs_id, FAIL, "thread_body: VSattach");
+        status = VSfdefine(vs_id, "PX", DFNT_FLOAT32, 1);
+        CHECK(status, FAIL, "thread_body: VSfdefine");
+        status = VSfdefine(vs_id, "PY", DFNT_FLOAT32, 1);
+        CHECK(status, FAIL, "thread_body: VSfdefine");
+        status = VSsetfields(vs_id, "PX,PY");
+        CHECK(status, FAIL, "thread_body: VSsetfields");
+        status = VSwrite(vs_id, (uint8 *)recs, N_RECORDS, FULL_INTERLACE);
+        VERIFY(status, N_RECORDS, "thread_body: VSwrite");
+        vs_ref = VSQueryref(vs_id);
+        CHECK(vs_ref, FAIL, "thread_body: VSQueryref");
+        status = VSdetach(vs_id);
+        CHECK(status, FAIL, "thread_body: VSdetach");
+        status = Vend(file_id);
+        CHECK(status, FAIL, "thread_body: Vend");
+        status = Hclose(file_id);
+        CHECK(status, FAIL, "thread_body: Hclose");
+
+        /* Read both back */
+        fid = SDstart(file_name, DFACC_READ);
+        CHECK(fid, FAIL, "thread_body: SDstart");
+        sds_id = SDselect(fid, 0);
+        CHECK(sds_id, FAIL, "thread_body: SDselect");
+        memset(check, 0, sizeof(check));
+        status = SDreaddata(sds_id, start, NULL, dims, check);
+        CHECK(status, FAIL, "thread_body: SDreaddata");
+        if (memcmp(check, data, sizeof(data)) != 0) {
+            fprintf(stderr, "thread %d: SDS data read back differs\n", info->id);
+            num_errs++;
+        }
+        status = SDendaccess(sds_id);
+        CHECK(status, FAIL, "thread_body: SDendaccess");
+
+        /* Odd threads fail on purpose; the error must stay on their own stack */
+        if (info->id % 2) {
+            sds_id = SDselect(fid, 99);
+            VERIFY(sds_id, FAIL, "thread_body: SDselect");
+            if (HEvalue(1) == DFE_NONE) {
+                fprintf(stderr, "thread %d: error stack is empty after a failure\n", info->id);
+                num_errs++;
+            }
+        }
+        status = SDend(fid);
+        CHECK(status, FAIL, "thread_body: SDend");
+
+        file_id = Hopen(file_name, DFACC_READ, 0);
+        CHECK(file_id, FAIL, "thread_body: Hopen");
+        status = Vstart(file_id);
+        CHECK(status, FAIL, "thread_body: Vstart");
+        vs_id = VSattach(file_id, vs_ref, "r");
+        CHECK(vs_id, FAIL, "thread_body: VSattach");
+        status = VSsetfields(vs_id, "PX,PY");
+        CHECK(status, FAIL, "thread_body: VSsetfields");
+        memset(check_recs, 0, sizeof(check_recs));
+        status = VSread(vs_id, (uint8 *)check_recs, N_RECORDS, FULL_INTERLACE);
+        VERIFY(status, N_RECORDS, "thread_body: VSread");
+        if (memcmp(check_recs, recs, sizeof(recs)) != 0) {
+            fprintf(stderr, "thread %d: vdata records read back differ\n", info->id);
+            num_errs++;
+        }
+        status = VSdetach(vs_id);
+        CHECK(status, FAIL, "thread_body: VSdetach");
+        status = Vend(file_id);
+        CHECK(status, FAIL, "thread_body: Vend");
+        status = Hclose(file_id);
+        CHECK(status, FAIL, "thread_body: Hclose");
+
+        /* Even threads never fail, whatever the other threads do */
+        if (!(info->id % 2) && HEvalue(1) != DFE_NONE) {
+            fprintf(stderr, "thread %d: error of another thread on the stack\n", info->id);
+            num_errs++;
+        }
+    }
+
+    remove(file_name);
+    info->num_errs = num_errs;
+    return NULL;
+} /* thread_body */
+
+/* Read a data set of test_shared_reads NLOOPS times, whole and in rows */
+static void *
+reader_body(void *arg)
+{
+    reader_info_t *info     = (reader_info_t *)arg;
+    int32          start[2] = {0, 0};
+    int32          edges[2] = {Y_LENGTH, X_LENGTH};
+    float64        check[Y_LENGTH][X_LENGTH];
+    int            loop, i;
+    intn           status;
+    int            num_errs = 0;
+
+    for (loop = 0; loop < NLOOPS; loop++) {
+        memset(check, 0, sizeof(check));
+        if (loop % 2) {
+            status = SDreaddata(info->sds_id, start, NULL, edges, check);
+            CHECK(status, FAIL, "reader_body: SDreaddata");
+        }
+        else {
+            int32 row_start[2] = {0, 0};
+            int32 row_edges[2] = {1, X_LENGTH};
+
+            for (i = 0; i < Y_LENGTH; i++) {
+                row_start[0] = i;
+                status       = SDreaddata(info->sds_id, row_start, NULL, row_edges, check[i]);
+                CHECK(status, FAIL, "reader_body: SDreaddata");
+            }
+        }
+        if (memcmp(check, shared_data[info->which], sizeof(check)) != 0) {
+            fprintf(stderr, "reader of file %d: data read back differs\n", info->which);
+            num_errs++;
+        }
+    }
+
+    info->num_errs = num_errs;
+    return NULL;
+} /* reader_body */
+
+/* Several threads read the same files at once, with the other files being read too */
+static int
+test_shared_reads(void)
+{
+    pthread_t      threads[NREADERS];
+    reader_info_t  info[NREADERS];
+    char           file_name[32];
+    int32          dims[2]  = {Y_LENGTH, X_LENGTH};
+    int32          start[2] = {0, 0};
+    int32          fids[NFILES], sds_ids[NFILES];
+    HDF_CHUNK_DEF  chunk_def;
+    int            f, i, j;
+    intn           status;
+    int            num_errs = 0;
+
+    for (f = 0; f < NFILES; f++) {
+        for (i = 0; i < Y_LENGTH; i++)
+            for (j = 0; j < X_LENGTH; j++)
+                shared_data[f][i][j] = f * 10000.0 + i * X_LENGTH + j;
+
+        snprintf(file_name, sizeof(file_name), "threadsafe_shared%d.hdf", f);
+        fids[f] = SDstart(file_name, DFACC_CREATE);
+        CHECK(fids[f], FAIL, "test_shared_reads: SDstart");
+        sds_ids[f] = SDcreate(fids[f], "data", DFNT_FLOAT64, 2, dims);
+        CHECK(sds_ids[f], FAIL, "test_shared_reads: SDcreate");
+
+        /* The second file holds 4 chunks of 10x15, compressed */
+        if (f == 1) {
+            memset(&chunk_def, 0, sizeof(chunk_def));
+            chunk_def.comp.chunk_lengths[0]    = 10;
+            chunk_def.comp.chunk_lengths[1]    = 15;
+            chunk_def.comp.comp_type           = COMP_CODE_DEFLATE;
+            chunk_def.comp.cinfo.deflate.level = 6;
+            status                             = SDsetchunk(sds_ids[f], chunk_def, HDF_CHUNK | HDF_COMP);
+            CHECK(status, FAIL, "test_shared_reads: SDsetchunk");
+        }
+
+        status = SDwritedata(sds_ids[f], start, NULL, dims, shared_data[f]);
+        CHECK(status, FAIL, "test_shared_reads: SDwritedata");
+        status = SDendaccess(sds_ids[f]);
+        CHECK(status, FAIL, "test_shared_reads: SDendaccess");
+        status = SDend(fids[f]);
+        CHECK(status, FAIL, "test_shared_reads: SDend");
+
+        fids[f] = SDstart(file_name, DFACC_READ);
+        CHECK(fids[f], FAIL, "test_shared_reads: SDstart");
+        sds_ids[f] = SDselect(fids[f], 0);
+        CHECK(sds_ids[f], FAIL, "test_shared_reads: SDselect");
+    }
+
+    for (i = 0; i < NREADERS; i++) {
+        info[i].which    = i % NFILES;
+        info[i].sds_id   = sds_ids[info[i].which];
+        info[i].num_errs = 0;
+        if (pthread_create(&threads[i], NULL, reader_body, &info[i]) != 0) {
+            fprintf(stderr, "test_shared_reads: cannot start thread %d\n", i);
+            return num_errs + 1;
+        }
+    }
+    for (i = 0; i < NREADERS; i++) {
+        pthread_join(threads[i], NULL);
+        num_errs += info[i].num_errs;
+    }
+
+    for (f = 0; f < NFILES; f++) {
+        status = SDendaccess(sds_ids[f]);
+        CHECK(status, FAIL, "test_shared_reads: SDendaccess");
+        status = SDend(fids[f]);
+        CHECK(status, FAIL, "test_shared_reads: SDend");
+        snprintf(file_name, sizeof(file_name), "threadsafe_shared%d.hdf", f);
+        remove(file_name);
+    }
+
+    return num_errs;
+} /* test_shared_reads */
+#endif /* H4_HAVE_THREADSAFE */
+
+/* Test driver for testing the thread-safe library mode */
+extern int
+test_threadsafe()
+{
+    int num_errs = 0;
+
+    /* Output message about test being performed */
+    TESTING("calling the library from several threads (tthreadsafe.c)");
+
+#ifdef H4_HAVE_THREADSAFE
+    {
+        pthread_t     threads[NTHREADS];
+        thread_info_t info[NTHREADS];
+        int           i;
+
+        VERIFY(Histhreadsafe(), TRUE, "test_threadsafe: Histhreadsafe");
+
+        for (i = 0; i < NTHREADS; i++) {
+            info[i].id       = i;
+            info[i].num_errs = 0;
+            if (pthread_create(&threads[i], NULL, thread_body, &info[i]) != 0) {
+                fprintf(stderr, "test_threadsafe: cannot start thread %d\n", i);
+                return num_errs + 1;
+            }
+        }
+        for (i = 0; i < NTHREADS; i++) {
+            pthread_join(threads[i], NULL);
+            num_errs += info[i].num_errs;
+        }
+
+        num_errs += test_shared_reads();
+    }
+
+    if (num_errs == 0)
+        PASSED();
+#else
+    VERIFY(Histhreadsafe(), FALSE, "test_threadsafe: Histhreadsafe");
+    SKIPPED();
+#endif
+
+    return num_errs;
+} /* test_threadsafe */